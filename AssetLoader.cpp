@@ -0,0 +1,505 @@
+//
+//  AssetLoader.cpp
+//
+
+#include "AssetLoader.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+#include "ObjLibrary/Vector3.h"
+#include "ObjLibrary/DisplayList.h"
+#include "ObjLibrary/TextureBmp.h"
+#include "ObjLibrary/CompiledMesh.h"
+#include "ObjLibrary/MeshCache.h"
+#include "ObjLibrary/MeshSimplifier.h"
+#include "ObjLibrary/MtlLibraryManager.h"
+#include "ObjLibrary/TextureManager.h"
+
+#include "ImageCache.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	//
+	//  ModelAsset
+	//
+	//  A record to represent an OBJ model to load.  A model
+	//    with LOD ratios makes its simplified versions after it
+	//    is loaded, and a model that is a simplified version is
+	//    only loaded after that.  A simplified version that
+	//    removed no more triangles than the one before it has no
+	//    file, and is skipped.
+	//
+	struct ModelAsset
+	{
+		string m_filename;
+		vector<double> mv_lod_ratios;
+		bool m_is_lod;
+		bool m_is_skipped;
+		bool m_is_loaded;
+		CompiledMesh m_mesh;
+		unsigned int m_triangle_count;
+		DisplayList m_list;
+		double m_cpu_seconds;
+		double m_upload_seconds;
+	};
+
+	//
+	//  ImageAsset
+	//
+	//  A record to represent a BMP file to decode, either as a
+	//    texture or as an image.
+	//
+	struct ImageAsset
+	{
+		string m_filename;
+		bool m_is_default_parameters;
+		unsigned int m_wrap_s;
+		unsigned int m_wrap_t;
+		unsigned int m_mag_filter;
+		unsigned int m_min_filter;
+		bool m_is_transparent;
+		Vector3 m_transparent_colour;
+		bool m_is_loaded;
+		TextureBmp m_image;
+		double m_cpu_seconds;
+		double m_upload_seconds;
+	};
+
+	vector<ModelAsset> gv_models;
+	vector<ImageAsset> gv_textures;
+	vector<ImageAsset> gv_images;
+	unordered_map<string, unsigned int> g_model_indexes;
+	unordered_map<string, unsigned int> g_texture_indexes;
+	unordered_map<string, unsigned int> g_image_indexes;
+
+	bool g_is_cpu_loaded = false;
+	unsigned int g_thread_count = 1;
+	double g_model_seconds   = 0.0;
+	double g_lod_seconds     = 0.0;
+	double g_texture_seconds = 0.0;
+	double g_upload_seconds  = 0.0;
+
+	double getSecondsSince (chrono::steady_clock::time_point start)
+	{
+		chrono::duration<double> duration = chrono::steady_clock::now() - start;
+		return duration.count();
+	}
+
+	ModelAsset& addModelAsset (const string& filename)
+	{
+		unordered_map<string, unsigned int>::iterator it = g_model_indexes.find(filename);
+		if(it != g_model_indexes.end())
+			return gv_models[it->second];
+
+		g_model_indexes[filename] = (unsigned int)(gv_models.size());
+		gv_models.push_back(ModelAsset());
+		ModelAsset& r_model = gv_models.back();
+		r_model.m_filename       = filename;
+		r_model.m_is_lod         = false;
+		r_model.m_is_skipped     = false;
+		r_model.m_is_loaded      = false;
+		r_model.m_triangle_count = 0;
+		r_model.m_cpu_seconds    = 0.0;
+		r_model.m_upload_seconds = 0.0;
+		return r_model;
+	}
+
+	ImageAsset* addImageAsset (vector<ImageAsset>& rv_assets,
+	                           unordered_map<string, unsigned int>& r_indexes,
+	                           const string& filename)
+	{
+		if(r_indexes.count(filename) != 0)
+			return NULL;
+
+		r_indexes[filename] = (unsigned int)(rv_assets.size());
+		rv_assets.push_back(ImageAsset());
+		ImageAsset& r_asset = rv_assets.back();
+		r_asset.m_filename              = filename;
+		r_asset.m_is_default_parameters = true;
+		r_asset.m_wrap_s                = 0;
+		r_asset.m_wrap_t                = 0;
+		r_asset.m_mag_filter            = 0;
+		r_asset.m_min_filter            = 0;
+		r_asset.m_is_transparent        = false;
+		r_asset.m_is_loaded             = false;
+		r_asset.m_cpu_seconds           = 0.0;
+		r_asset.m_upload_seconds        = 0.0;
+		return &r_asset;
+	}
+
+	//
+	//  loadModel
+	//
+	//  Purpose: To load a model on the current thread.
+	//  Parameter(s):
+	//    <1> r_model: The record for the model
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: The model is loaded through a MeshCache and
+	//               its simplified versions are brought up to
+	//               date.  A simplified version with no file is
+	//               marked as skipped instead.  Only r_model is changed, so different
+	//               models can be loaded on different threads.
+	//
+	void loadModel (ModelAsset& r_model)
+	{
+		UWSIM_PROFILE_ZONE("Load/Model file");
+		if(r_model.m_is_lod && !ifstream(r_model.m_filename))
+		{
+			r_model.m_is_skipped = true;
+			return;
+		}
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		r_model.m_is_loaded = MeshCache::load(r_model.m_filename, r_model.m_mesh);
+		r_model.m_triangle_count = r_model.m_mesh.getIndexCount() / 3;
+		if(r_model.m_is_loaded && !r_model.mv_lod_ratios.empty())
+			MeshSimplifier::updateLods(r_model.m_filename, r_model.mv_lod_ratios);
+		r_model.m_cpu_seconds = getSecondsSince(start);
+	}
+
+	//
+	//  decodeImage
+	//
+	//  Purpose: To decode an image on the current thread.
+	//  Parameter(s):
+	//    <1> r_asset: The record for the image
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: The image is read from its file, and made
+	//               transparent if requested.  Only r_asset is
+	//               changed.
+	//
+	void decodeImage (ImageAsset& r_asset)
+	{
+		UWSIM_PROFILE_ZONE("Load/Image file");
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		TextureBmp image(r_asset.m_filename);
+		if(!image.isBad() && r_asset.m_is_transparent)
+		{
+			// same rounding as TextureManager::load
+			Vector3 transparent_255 = r_asset.m_transparent_colour * 255.0;
+			image = TextureBmp(image, 0, 0, image.getWidth(), image.getHeight(),
+			                   (unsigned char)(transparent_255.x),
+			                   (unsigned char)(transparent_255.y),
+			                   (unsigned char)(transparent_255.z));
+		}
+		r_asset.m_is_loaded = !image.isBad();
+		r_asset.m_image = image;
+		r_asset.m_cpu_seconds = getSecondsSince(start);
+	}
+
+	//
+	//  TimingRow
+	//
+	//  A record to represent one line of the timing report.
+	//
+	struct TimingRow
+	{
+		string m_filename;
+		double m_cpu_seconds;
+		double m_upload_seconds;
+		bool m_is_loaded;
+
+		bool operator< (const TimingRow& other) const
+		{
+			return m_cpu_seconds + m_upload_seconds >
+			       other.m_cpu_seconds + other.m_upload_seconds;
+		}
+	};
+
+}  // end of anonymous namespace
+
+
+
+void AssetLoader :: addModel (const std::string& filename)
+{
+	assert(!isCpuLoaded());
+
+	addModelAsset(filename);
+}
+
+void AssetLoader :: addModelLods (const std::string& filename,
+                                  const std::vector<double>& triangle_ratios)
+{
+	assert(!isCpuLoaded());
+
+	addModelAsset(filename).mv_lod_ratios = triangle_ratios;
+	for(unsigned int i = 0; i < triangle_ratios.size(); i++)
+	{
+		assert(triangle_ratios[i] > 0.0);
+		assert(triangle_ratios[i] <= 1.0);
+		addModelAsset(MeshSimplifier::getLodFileName(filename, triangle_ratios[i])).m_is_lod = true;
+	}
+}
+
+void AssetLoader :: addTexture (const std::string& filename)
+{
+	assert(!isCpuLoaded());
+
+	addImageAsset(gv_textures, g_texture_indexes, filename);
+}
+
+void AssetLoader :: addTexture (const std::string& filename,
+                                unsigned int wrap_s,
+                                unsigned int wrap_t,
+                                unsigned int mag_filter,
+                                unsigned int min_filter,
+                                const ObjLibrary::Vector3& transparent_colour)
+{
+	assert(!isCpuLoaded());
+	assert(transparent_colour.isAllComponentsNonNegative());
+	assert(transparent_colour.isAllComponentsLessThanOrEqual(1.0));
+
+	ImageAsset* p_asset = addImageAsset(gv_textures, g_texture_indexes, filename);
+	if(p_asset != NULL)
+	{
+		p_asset->m_is_default_parameters = false;
+		p_asset->m_wrap_s                = wrap_s;
+		p_asset->m_wrap_t                = wrap_t;
+		p_asset->m_mag_filter            = mag_filter;
+		p_asset->m_min_filter            = min_filter;
+		p_asset->m_is_transparent        = true;
+		p_asset->m_transparent_colour    = transparent_colour;
+	}
+}
+
+void AssetLoader :: addImage (const std::string& filename)
+{
+	assert(!isCpuLoaded());
+
+	addImageAsset(gv_images, g_image_indexes, filename);
+}
+
+bool AssetLoader :: isCpuLoaded ()
+{
+	return g_is_cpu_loaded;
+}
+
+void AssetLoader :: loadCpu (JobSystem& r_job_system)
+{
+	assert(!isCpuLoaded());
+
+	g_thread_count = r_job_system.getThreadCount();
+
+	// the full models, which also make their simplified versions
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<unsigned int> v_jobs;
+	{
+		UWSIM_PROFILE_ZONE("Load/Models");
+		for(unsigned int i = 0; i < gv_models.size(); i++)
+			if(!gv_models[i].m_is_lod)
+				v_jobs.push_back(i);
+		r_job_system.parallelFor((unsigned int)(v_jobs.size()), [&] (unsigned int j)
+		{
+			loadModel(gv_models[v_jobs[j]]);
+		});
+	}
+	g_model_seconds = getSecondsSince(start);
+
+	// the simplified versions, now that their files are current
+	start = chrono::steady_clock::now();
+	{
+		UWSIM_PROFILE_ZONE("Load/Simplified models");
+		v_jobs.clear();
+		for(unsigned int i = 0; i < gv_models.size(); i++)
+			if(gv_models[i].m_is_lod)
+				v_jobs.push_back(i);
+		r_job_system.parallelFor((unsigned int)(v_jobs.size()), [&] (unsigned int j)
+		{
+			loadModel(gv_models[v_jobs[j]]);
+		});
+	}
+	g_lod_seconds = getSecondsSince(start);
+
+	// the materials are known now, so their textures can be added
+	start = chrono::steady_clock::now();
+	{
+		UWSIM_PROFILE_ZONE("Load/Images");
+		vector<string> v_material_textures;
+		MtlLibraryManager::getDisplayTextureNames(v_material_textures);
+		for(unsigned int i = 0; i < v_material_textures.size(); i++)
+			if(!TextureManager::isLoaded(v_material_textures[i]))
+				addImageAsset(gv_textures, g_texture_indexes, v_material_textures[i]);
+
+		unsigned int texture_count = (unsigned int)(gv_textures.size());
+		r_job_system.parallelFor(texture_count + (unsigned int)(gv_images.size()), [&] (unsigned int j)
+		{
+			if(j < texture_count)
+				decodeImage(gv_textures[j]);
+			else
+				decodeImage(gv_images[j - texture_count]);
+		});
+
+		// the images are not uploaded, so they are handed over now
+		for(unsigned int i = 0; i < gv_images.size(); i++)
+		{
+			if(!gv_images[i].m_is_loaded)
+				continue;
+			ImageCache::add(gv_images[i].m_filename, gv_images[i].m_image);
+			gv_images[i].m_image = TextureBmp();
+		}
+	}
+	g_texture_seconds = getSecondsSince(start);
+
+	g_is_cpu_loaded = true;
+	assert(isCpuLoaded());
+}
+
+void AssetLoader :: upload ()
+{
+	assert(isCpuLoaded());
+
+	UWSIM_PROFILE_ZONE("Load/Upload");
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(unsigned int i = 0; i < gv_textures.size(); i++)
+	{
+		ImageAsset& r_texture = gv_textures[i];
+		if(!r_texture.m_is_loaded || TextureManager::isLoaded(r_texture.m_filename))
+			continue;
+
+		chrono::steady_clock::time_point texture_start = chrono::steady_clock::now();
+		if(r_texture.m_is_default_parameters)
+			TextureManager::add(r_texture.m_image, r_texture.m_filename);
+		else
+		{
+			TextureManager::add(r_texture.m_image, r_texture.m_filename,
+			                    r_texture.m_wrap_s, r_texture.m_wrap_t,
+			                    r_texture.m_mag_filter, r_texture.m_min_filter);
+		}
+		r_texture.m_image = TextureBmp();
+		r_texture.m_upload_seconds = getSecondsSince(texture_start);
+	}
+	g_upload_seconds = getSecondsSince(start);
+}
+
+bool AssetLoader :: getModel (const std::string& filename,
+                              ObjLibrary::DisplayList& r_list)
+{
+	unsigned int triangle_count;
+	return getModel(filename, r_list, triangle_count);
+}
+
+bool AssetLoader :: getModel (const std::string& filename,
+                              ObjLibrary::DisplayList& r_list,
+                              unsigned int& r_triangle_count)
+{
+	unordered_map<string, unsigned int>::iterator it = g_model_indexes.find(filename);
+	if(it == g_model_indexes.end() || !isCpuLoaded())
+	{
+		// not loaded in advance
+		CompiledMesh mesh;
+		bool is_loaded = MeshCache::load(filename, mesh);
+		r_list = mesh.getDisplayList();
+		r_triangle_count = mesh.getIndexCount() / 3;
+		return is_loaded;
+	}
+
+	ModelAsset& r_model = gv_models[it->second];
+	if(!r_model.m_list.isReady())
+	{
+		UWSIM_PROFILE_ZONE("Load/Display list");
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		r_model.m_list = r_model.m_mesh.getDisplayList();
+		r_model.m_mesh = CompiledMesh();  // the display list has its own copy
+		r_model.m_upload_seconds = getSecondsSince(start);
+	}
+	r_list = r_model.m_list;
+	r_triangle_count = r_model.m_triangle_count;
+	return r_model.m_is_loaded;
+}
+
+void AssetLoader :: printTimings (std::ostream& r_out)
+{
+	assert(isCpuLoaded());
+
+	vector<TimingRow> v_rows;
+	double cpu_total = 0.0;
+	double upload_total = 0.0;
+	unsigned int model_count = 0;
+	for(unsigned int i = 0; i < gv_models.size(); i++)
+	{
+		if(gv_models[i].m_is_skipped)
+			continue;
+		model_count++;
+		TimingRow row = { gv_models[i].m_filename, gv_models[i].m_cpu_seconds,
+		                  gv_models[i].m_upload_seconds, gv_models[i].m_is_loaded };
+		v_rows.push_back(row);
+	}
+	for(unsigned int i = 0; i < gv_textures.size(); i++)
+	{
+		TimingRow row = { gv_textures[i].m_filename, gv_textures[i].m_cpu_seconds,
+		                  gv_textures[i].m_upload_seconds, gv_textures[i].m_is_loaded };
+		v_rows.push_back(row);
+	}
+	for(unsigned int i = 0; i < gv_images.size(); i++)
+	{
+		TimingRow row = { gv_images[i].m_filename, gv_images[i].m_cpu_seconds,
+		                  0.0, gv_images[i].m_is_loaded };
+		v_rows.push_back(row);
+	}
+	stable_sort(v_rows.begin(), v_rows.end());
+	for(unsigned int i = 0; i < v_rows.size(); i++)
+	{
+		cpu_total    += v_rows[i].m_cpu_seconds;
+		upload_total += v_rows[i].m_upload_seconds;
+	}
+
+	ios::fmtflags old_flags = r_out.flags();
+	streamsize old_precision = r_out.precision();
+	r_out << fixed << setprecision(3);
+
+	r_out << "Loaded " << model_count << " models, " << gv_textures.size() << " textures, and "
+	      << gv_images.size() << " images on " << g_thread_count << " threads" << endl;
+	r_out << "    Models:       " << setw(8) << g_model_seconds   << " s" << endl;
+	r_out << "    Simplified:   " << setw(8) << g_lod_seconds     << " s" << endl;
+	r_out << "    Images:       " << setw(8) << g_texture_seconds << " s" << endl;
+	r_out << "    Upload:       " << setw(8) << g_upload_seconds  << " s (textures only)" << endl;
+	r_out << "    Total CPU:    " << setw(8) << cpu_total    << " s over all threads" << endl;
+	r_out << "    Total upload: " << setw(8) << upload_total << " s" << endl;
+	r_out << "      CPU ms   Upload ms   File" << endl;
+	for(unsigned int i = 0; i < v_rows.size(); i++)
+	{
+		r_out << "    " << setw(8) << v_rows[i].m_cpu_seconds    * 1000.0
+		      << "    " << setw(8) << v_rows[i].m_upload_seconds * 1000.0
+		      << "   " << v_rows[i].m_filename;
+		if(!v_rows[i].m_is_loaded)
+			r_out << " (failed)";
+		r_out << endl;
+	}
+
+	r_out.flags(old_flags);
+	r_out.precision(old_precision);
+}
+
+void AssetLoader :: clear ()
+{
+	gv_models.clear();
+	gv_textures.clear();
+	gv_images.clear();
+	g_model_indexes.clear();
+	g_texture_indexes.clear();
+	g_image_indexes.clear();
+
+	g_is_cpu_loaded   = false;
+	g_thread_count    = 1;
+	g_model_seconds   = 0.0;
+	g_lod_seconds     = 0.0;
+	g_texture_seconds = 0.0;
+	g_upload_seconds  = 0.0;
+	ImageCache::clear();
+
+	assert(!isCpuLoaded());
+}
@@ -0,0 +1,245 @@
+//
+//  AssetLoader.h
+//
+//  A module to load the models and textures for the game in
+//    parallel at startup.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "ObjLibrary/Vector3.h"
+#include "ObjLibrary/DisplayList.h"
+#include "ObjLibrary/TextureBmp.h"
+
+class JobSystem;
+
+
+
+//
+//  AssetLoader
+//
+//  A global service to load the files the game needs at
+//    startup in two phases.  First, the files are added by
+//    name, normally by scanning the map file.  Then loadCpu
+//    parses the OBJ and MTL files and decodes the BMP files on
+//    a JobSystem, and upload adds the textures to OpenGL on
+//    the calling thread.  The display list for each model is
+//    made on the calling thread when it is first requested
+//    with getModel.
+//
+//  loadCpu does not use OpenGL, so it can be run without a
+//    window to measure or check the loading.
+//
+//  A file that was not added, or that could not be loaded in
+//    advance, is loaded when it is requested, so the game
+//    works the same without this module, only slower.
+//
+namespace AssetLoader
+{
+
+//
+//  addModel
+//
+//  Purpose: To add an OBJ model to be loaded.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file, with its path
+//  Precondition(s):
+//    <1> !isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The model in file filename will be loaded
+//               through a MeshCache by loadCpu.  A model that
+//               has already been added is not added again.
+//
+void addModel (const std::string& filename);
+
+//
+//  addModelLods
+//
+//  Purpose: To add an OBJ model and its simplified versions to
+//           be loaded.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file, with its path
+//    <2> triangle_ratios: The fraction of triangles to keep in
+//                         each simplified version
+//  Precondition(s):
+//    <1> !isCpuLoaded()
+//    <2> triangle_ratios[i] > 0.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//    <3> triangle_ratios[i] <= 1.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//  Returns: N/A
+//  Side Effect: The model in file filename is added as by
+//               addModel.  loadCpu will also bring the cache
+//               files made by MeshSimplifier::updateLods up to
+//               date and load them, under the names from
+//               MeshSimplifier::getLodFileName.
+//
+void addModelLods (const std::string& filename,
+                   const std::vector<double>& triangle_ratios);
+
+//
+//  addTexture
+//
+//  Purpose: To add a texture to be loaded.
+//  Parameter(s):
+//    <1> filename: The name of the BMP file, with its path
+//    <2> wrap_s:
+//    <3> wrap_t: The behaviour of the texture outside of the
+//                range [0, 1) along the x-/y-axis
+//    <4> mag_filter: The magnification filter
+//    <5> min_filter: The minification filter
+//    <6> transparent_colour: The transparency colour
+//  Precondition(s):
+//    <1> !isCpuLoaded()
+//    <2> The wrapping modes, filters, and transparent colour
+//        are valid, as for TextureManager::load
+//  Returns: N/A
+//  Side Effect: The image in file filename will be decoded by
+//               loadCpu and added to the TextureManager under
+//               the name filename by upload.  If no wrapping
+//               modes and filters are specified, the
+//               TextureManager defaults are used.  If a
+//               transparent colour is specified, pixels of
+//               that colour become transparent, as for
+//               TextureManager::load.  A texture that has
+//               already been added is not added again.
+//
+void addTexture (const std::string& filename);
+void addTexture (const std::string& filename,
+                 unsigned int wrap_s,
+                 unsigned int wrap_t,
+                 unsigned int mag_filter,
+                 unsigned int min_filter,
+                 const ObjLibrary::Vector3& transparent_colour);
+
+//
+//  addImage
+//
+//  Purpose: To add an image to be decoded but not used as a
+//           texture, such as a heightmap.
+//  Parameter(s):
+//    <1> filename: The name of the BMP file, with its path
+//  Precondition(s):
+//    <1> !isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The image in file filename will be decoded by
+//               loadCpu and added to the ImageCache.
+//
+void addImage (const std::string& filename);
+
+//
+//  isCpuLoaded
+//
+//  Purpose: To determine if the files that were added have
+//           been loaded.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether loadCpu has been called since the last
+//           call to clear.
+//  Side Effect: N/A
+//
+bool isCpuLoaded ();
+
+//
+//  loadCpu
+//
+//  Purpose: To load all the files that were added, without
+//           using OpenGL.
+//  Parameter(s):
+//    <1> r_job_system: The JobSystem to load the files on
+//  Precondition(s):
+//    <1> !isCpuLoaded()
+//    <2> r_job_system is not running a parallelFor
+//  Returns: N/A
+//  Side Effect: The models are loaded through a MeshCache, in
+//               parallel.  Then any simplified versions are
+//               loaded, and then the images and the textures,
+//               including the display textures of the materials
+//               the models use, are decoded, each in parallel.
+//               The time taken for each file and each phase is
+//               recorded.  Errors are written to the standard
+//               error stream.  After this function has been
+//               called, isCpuLoaded will return true.
+//
+void loadCpu (JobSystem& r_job_system);
+
+//
+//  upload
+//
+//  Purpose: To add the textures that were decoded to OpenGL.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isCpuLoaded()
+//    <2> OpenGL is initialized
+//  Returns: N/A
+//  Side Effect: Each texture that was decoded and is not
+//               already in the TextureManager is added to it.
+//               The images are released from memory.
+//
+void upload ();
+
+//
+//  getModel
+//
+//  Purpose: To retrieve the display list for an OBJ model.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file, with its path
+//    <2> r_list: The DisplayList to set
+//    <3> r_triangle_count: The number of triangles in the model
+//  Precondition(s):
+//    <1> ObjStringParsing::isValidFilenameWithPath(filename)
+//    <2> OpenGL is initialized
+//  Returns: Whether the model could be loaded.
+//  Side Effect: r_list is set to the display list for the
+//               model in file filename, and r_triangle_count to
+//               its number of triangles.  If the model was
+//               loaded by loadCpu, the display list is made from
+//               it the first time it is requested and reused
+//               after that.  Otherwise, the model is loaded now
+//               through a MeshCache.  If the model cannot be
+//               loaded, r_list is set to an empty display list.
+//
+bool getModel (const std::string& filename,
+               ObjLibrary::DisplayList& r_list);
+bool getModel (const std::string& filename,
+               ObjLibrary::DisplayList& r_list,
+               unsigned int& r_triangle_count);
+
+//
+//  printTimings
+//
+//  Purpose: To print how long loading each file took.
+//  Parameter(s):
+//    <1> r_out: The stream to print to
+//  Precondition(s):
+//    <1> isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The wall-clock time for each phase and the
+//               time spent loading and uploading each file are
+//               printed to r_out, slowest first.  The time to
+//               make a display list is only included if the
+//               model has been requested with getModel.
+//
+void printTimings (std::ostream& r_out);
+
+//
+//  clear
+//
+//  Purpose: To forget all the files that were added.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: All files, loaded data, and timings are
+//               removed, including the images in the
+//               ImageCache.  Display lists and textures that
+//               are in use elsewhere are not destroyed.  After this
+//               function has been called, isCpuLoaded will
+//               return false.
+//
+void clear ();
+
+}  // end of namespace AssetLoader
@@ -22,3 +22,12 @@ bool isCollision (const FixedEntity& entity1_fixed,
                   const Entity& entity2);
 bool isCollision (const Entity& entity,
                   const Terrain& terrain);
+bool isCollision (const ObjLibrary::Vector3& center,
+                  double radius,
+                  const Entity& entity);
+bool isCollision (const ObjLibrary::Vector3& center,
+                  double radius,
+                  const FixedEntity& entity_fixed);
+bool isCollision (const ObjLibrary::Vector3& center,
+                  double radius,
+                  const Terrain& terrain);
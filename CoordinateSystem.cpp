@@ -6,8 +6,6 @@
 
 #include "CoordinateSystem.h"
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector3.h"
 
 using namespace ObjLibrary;
@@ -70,25 +68,6 @@ const ObjLibrary::Vector3& CoordinateSystem :: getRight () const
 	return right_vec;
 }
 
-void CoordinateSystem :: setupCamera () const
-{
-	Vector3 look_at = m_position + forward_vec;
-	gluLookAt(m_position.x, m_position.y, m_position.z,
-	          look_at.x,    look_at.y,    look_at.z,
-	          up_vec.x,       up_vec.y,       up_vec.z);
-}
-
-void CoordinateSystem :: applyDrawTransformations () const
-{
-	// code for translation will go here
-	glTranslated(m_position.x, m_position.y, m_position.z);
-
-	// code for rotation will go here
-	double a_matrix[16];
-	calculateOrientationMatrix(a_matrix);
-	glMultMatrixd(a_matrix);
-}
-
 void CoordinateSystem :: calculateOrientationMatrix (double a_matrix[]) const
 {
 	a_matrix[ 0] = forward_vec.x;
@@ -109,6 +88,26 @@ void CoordinateSystem :: calculateOrientationMatrix (double a_matrix[]) const
 	a_matrix[15] = 1.0;
 }
 
+CoordinateSystem CoordinateSystem :: getInterpolated (const CoordinateSystem& target,
+                                                      double fraction) const
+{
+	Vector3 position = m_position + (target.m_position - m_position) * fraction;
+
+	// a blend that cancels out keeps the target orientation
+	Vector3 forward = forward_vec + (target.forward_vec - forward_vec) * fraction;
+	if(forward.getNormSquared() < 1.0e-12)
+		return CoordinateSystem(position, target.forward_vec, target.up_vec);
+	forward.normalize();
+
+	Vector3 up = up_vec + (target.up_vec - up_vec) * fraction;
+	up = up.getRejectionNormal(forward);
+	if(up.getNormSquared() < 1.0e-12)
+		return CoordinateSystem(position, target.forward_vec, target.up_vec);
+	up.normalize();
+
+	return CoordinateSystem(position, forward, up);
+}
+
 
 
 void CoordinateSystem :: setPosition (const ObjLibrary::Vector3& position)
@@ -26,6 +26,8 @@ public:
 	void setupCamera () const;  // calls gluLookAt
 	void applyDrawTransformations () const;
 	void calculateOrientationMatrix (double a_matrix[]) const;
+	CoordinateSystem getInterpolated (const CoordinateSystem& target,
+	                                  double fraction) const;
 
 	void setPosition (const ObjLibrary::Vector3& position);
 	void setOrientation (const ObjLibrary::Vector3& local_forward);
@@ -0,0 +1,34 @@
+//
+//  CoordinateSystemDraw.cpp
+//
+//  The CoordinateSystem functions that call OpenGL.
+//
+
+#include "CoordinateSystem.h"
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/Vector3.h"
+
+using namespace ObjLibrary;
+
+
+
+void CoordinateSystem :: setupCamera () const
+{
+	Vector3 look_at = m_position + forward_vec;
+	gluLookAt(m_position.x, m_position.y, m_position.z,
+	          look_at.x,    look_at.y,    look_at.z,
+	          up_vec.x,       up_vec.y,       up_vec.z);
+}
+
+void CoordinateSystem :: applyDrawTransformations () const
+{
+	// code for translation will go here
+	glTranslated(m_position.x, m_position.y, m_position.z);
+
+	// code for rotation will go here
+	double a_matrix[16];
+	calculateOrientationMatrix(a_matrix);
+	glMultMatrixd(a_matrix);
+}
@@ -0,0 +1,32 @@
+//
+//  CullStatistics.h
+//
+//  A module to count the objects drawn and skipped in a frame.
+//
+
+#pragma once
+
+
+
+//
+//  CullStatistics
+//
+//  A record to store how many objects of each kind were drawn
+//    and how many were culled because they were outside the
+//    ViewFrustum in the last call to Map::draw.  A fish school
+//    with no fish left is counted as culled.  Fixed entities
+//    drawn with a low-poly model are also counted in
+//    m_fixed_entities_low_detail.
+//
+struct CullStatistics
+{
+	unsigned int m_fixed_entities_drawn;
+	unsigned int m_fixed_entities_culled;
+	unsigned int m_fixed_entities_low_detail;
+
+	unsigned int m_fish_schools_drawn;
+	unsigned int m_fish_schools_culled;
+
+	unsigned int m_plant_chunks_drawn;
+	unsigned int m_plant_chunks_culled;
+};
@@ -7,8 +7,6 @@
 #include <cassert>
 #include <cmath>
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector3.h"
 #include "ObjLibrary/DisplayList.h"
 
@@ -7,11 +7,7 @@
 #include <cassert>
 #include <string>
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector3.h"
-#include "ObjLibrary/ObjModel.h"
-#include "ObjLibrary/DisplayList.h"
 
 #include "Entity.h"
 
@@ -75,14 +71,13 @@ namespace
 		2.5,	// clownfish        - fast or average?
 	};
 
-
-
-	DisplayList fish_lists[Fish::SPECIES_COUNT];
-
 }  // end of anonymous namespace
 
 
 
+const unsigned int Fish :: NEIGHBOUR_COUNT;
+const unsigned int Fish :: NO_NEIGHBOUR;
+
 double Fish :: getSpeed (unsigned int species)
 {
 	assert(species < SPECIES_COUNT);
@@ -90,16 +85,17 @@ double Fish :: getSpeed (unsigned int species)
 	return FISH_SPEED[species];
 }
 
-double Fish::getMaxAccleration(unsigned int species) {
+double Fish :: getSpeciesRadius (unsigned int species)
+{
 	assert(species < SPECIES_COUNT);
 
-	return FISH_ACCLERATION[species];
+	return FISH_RADIUSES[species];
 }
 
-bool Fish :: isModelsLoaded ()
-{
-	assert(0 < SPECIES_COUNT);
-	return fish_lists[0].isReady();
+double Fish::getMaxAccleration(unsigned int species) {
+	assert(species < SPECIES_COUNT);
+
+	return FISH_ACCLERATION[species];
 }
 
 unsigned int Fish :: getSpeciesForFilename (const std::string& filename)
@@ -112,14 +108,11 @@ unsigned int Fish :: getSpeciesForFilename (const std::string& filename)
 	return SPECIES_COUNT;
 }
 
-void Fish :: loadModels (const std::string& resource_path)
+const std::string& Fish :: getModelFilename (unsigned int species)
 {
-	assert(!isModelsLoaded());
-
-	for(unsigned int i = 0; i < SPECIES_COUNT; i++)
-		fish_lists[i] = ObjModel(resource_path + FISH_FILENAMES[i]).getDisplayList();
+	assert(species < SPECIES_COUNT);
 
-	assert(isModelsLoaded());
+	return FISH_FILENAMES[species];
 }
 
 
@@ -128,6 +121,9 @@ Fish :: Fish ()
 		: Entity(),
 		  m_species(0)
 {
+	for(unsigned int n = 0; n < NEIGHBOUR_COUNT; n++)
+		fishNeighbour[n] = NO_NEIGHBOUR;
+
 	assert(isInvariantTrue());
 }
 
@@ -138,9 +134,11 @@ Fish :: Fish (const ObjLibrary::Vector3& position,
 		         FISH_RADIUSES[species]),
 		  m_species(species)
 {
-	assert(isModelsLoaded());
 	assert(species < SPECIES_COUNT);
 
+	for(unsigned int n = 0; n < NEIGHBOUR_COUNT; n++)
+		fishNeighbour[n] = NO_NEIGHBOUR;
+
 	assert(isInvariantTrue());
 }
 
@@ -151,22 +149,6 @@ unsigned int Fish :: getSpecies () const
 	return m_species;
 }
 
-void Fish :: draw () const
-{
-	assert(isInvariantTrue());
-	assert(isModelsLoaded());
-
-	Vector3 center = getPosition();
-	double  radius = getRadius();
-
-	glPushMatrix();
-		applyDrawTransformations();
-		glScaled(radius, radius, radius);
-		assert(fish_lists[m_species].isReady());
-		fish_lists[m_species].draw();
-	glPopMatrix();
-}
-
 
 
 bool Fish :: isInvariantTrue () const
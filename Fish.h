@@ -33,6 +33,21 @@ public:
 //
 	static const unsigned int SPECIES_COUNT = 9;
 
+//
+//  NEIGHBOUR_COUNT
+//
+//  The number of nearest neighbours tracked for each fish.
+//
+	static const unsigned int NEIGHBOUR_COUNT = 4;
+
+//
+//  NO_NEIGHBOUR
+//
+//  A special value stored in fishNeighbour when there are not
+//    enough other fish in the school to fill every slot.
+//
+	static const unsigned int NO_NEIGHBOUR = 0xFFFFFFFF;
+
 //
 //  getSpeed
 //
@@ -46,6 +61,20 @@ public:
 //
 	static double getSpeed (unsigned int species);
 
+//
+//  getSpeciesRadius
+//
+//  Purpose: To determine the collision radius for a species of
+//           fish.
+//  Parameter(s):
+//    <1> species: The fish species to check
+//  Precondition(s):
+//    <1> species < SPECIES_COUNT
+//  Returns: The radius of fish species species.
+//  Side Effect: N/A
+//
+	static double getSpeciesRadius (unsigned int species);
+
 	static double getMaxAccleration(unsigned int species);
 //
 //  isModelsLoaded
@@ -76,6 +105,22 @@ public:
 	static unsigned int getSpeciesForFilename (
 	                               const std::string& filename);
 
+//
+//  getModelFilename
+//
+//  Purpose: To determine the OBJ model that the specified
+//           species is displayed with.
+//  Parameter(s):
+//    <1> species: The fish species
+//  Precondition(s):
+//    <1> species < SPECIES_COUNT
+//  Returns: The file name of the OBJ model for species, without
+//           a path.
+//  Side Effect: N/A
+//
+	static const std::string& getModelFilename (
+	                                      unsigned int species);
+
 //
 //  loadModels
 //
@@ -95,6 +140,38 @@ public:
 //
 	static void loadModels (const std::string& resource_path);
 
+//
+//  addModelAssets
+//
+//  Purpose: To add the OBJ models for fish to the AssetLoader,
+//           so they can be loaded in advance.
+//  Parameter(s):
+//    <1> resource_path: The file path to prepend to the
+//                       filenames
+//  Precondition(s):
+//    <1> !AssetLoader::isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The models loadModels uses are added to the
+//               AssetLoader.
+//
+	static void addModelAssets (const std::string& resource_path);
+
+//
+//  drawModel
+//
+//  Purpose: To display the OBJ model for a fish species.
+//  Parameter(s):
+//    <1> species: The fish species
+//  Precondition(s):
+//    <1> isModelsLoaded()
+//    <2> species < SPECIES_COUNT
+//  Returns: N/A
+//  Side Effect: The model for fish species species is displayed
+//               with the current transformations and a radius
+//               of 1.0.
+//
+	static void drawModel (unsigned int species);
+
 public:
 //
 //  Default Constructor
@@ -118,9 +195,8 @@ public:
 //    <2> forward: The forward vector for the fish
 //    <3> species: The fish species
 //  Precondition(s):
-//    <1> isModelsLoaded()
-//    <2> forward.isUnit()
-//    <3> species < SPECIES_COUNT
+//    <1> forward.isUnit()
+//    <2> species < SPECIES_COUNT
 //  Returns: N/A
 //  Side Effect: An invalid Fish is constructed at position
 //               center and species species.
@@ -154,7 +230,7 @@ public:
 //
 	void draw () const;
 
-	unsigned int fishNeighbour[4];
+	unsigned int fishNeighbour[NEIGHBOUR_COUNT];
 	unsigned int count;
 private:
 //
@@ -0,0 +1,265 @@
+//
+//  FishArrays.cpp
+//
+
+#include "FishArrays.h"
+
+#include <cassert>
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "Fish.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+
+
+FishArrays :: FishArrays ()
+		// all vectors will be initialized to empty by the default constructor
+		: m_next_id(0)
+{
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned int FishArrays :: getCount () const
+{
+	assert(isInvariantTrue());
+
+	return mv_position_x.size();
+}
+
+Vector3 FishArrays :: getPosition (unsigned int index) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	return Vector3(mv_position_x[index], mv_position_y[index], mv_position_z[index]);
+}
+
+Vector3 FishArrays :: getVelocity (unsigned int index) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	return Vector3(mv_velocity_x[index], mv_velocity_y[index], mv_velocity_z[index]);
+}
+
+Vector3 FishArrays :: getForward (unsigned int index) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	return Vector3(mv_forward_x[index], mv_forward_y[index], mv_forward_z[index]);
+}
+
+unsigned int FishArrays :: getNeighbour (unsigned int index,
+                                         unsigned int slot) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+	assert(slot < Fish::NEIGHBOUR_COUNT);
+
+	return mv_neighbours[index * Fish::NEIGHBOUR_COUNT + slot];
+}
+
+unsigned int FishArrays :: getId (unsigned int index) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	return mv_id[index];
+}
+
+unsigned int FishArrays :: findId (unsigned int id) const
+{
+	assert(isInvariantTrue());
+
+	for(unsigned int i = 0; i < mv_id.size(); i++)
+		if(mv_id[i] == id)
+			return i;
+	return NO_FISH;
+}
+
+
+
+void FishArrays :: setVelocity (unsigned int index,
+                                const ObjLibrary::Vector3& velocity)
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	mv_velocity_x[index] = (FishScalar)(velocity.x);
+	mv_velocity_y[index] = (FishScalar)(velocity.y);
+	mv_velocity_z[index] = (FishScalar)(velocity.z);
+
+	assert(isInvariantTrue());
+}
+
+bool FishArrays :: bounce (unsigned int index,
+                           const ObjLibrary::Vector3& normal)
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	Vector3 velocity = getVelocity(index);
+	if(velocity.isSameHemisphere(normal))
+		return false;
+
+	Vector3 projection = velocity.getProjection(normal);
+	Vector3  rejection = velocity.getRejection (normal);
+	setVelocity(index, rejection - projection);
+
+	assert(isInvariantTrue());
+	return true;
+}
+
+void FishArrays :: add (const ObjLibrary::Vector3& position,
+                        const ObjLibrary::Vector3& velocity,
+                        const ObjLibrary::Vector3& forward)
+{
+	assert(isInvariantTrue());
+	assert(forward.isUnit());
+
+	mv_position_x.push_back((FishScalar)(position.x));
+	mv_position_y.push_back((FishScalar)(position.y));
+	mv_position_z.push_back((FishScalar)(position.z));
+	mv_velocity_x.push_back((FishScalar)(velocity.x));
+	mv_velocity_y.push_back((FishScalar)(velocity.y));
+	mv_velocity_z.push_back((FishScalar)(velocity.z));
+	mv_forward_x .push_back((FishScalar)(forward.x));
+	mv_forward_y .push_back((FishScalar)(forward.y));
+	mv_forward_z .push_back((FishScalar)(forward.z));
+	for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+		mv_neighbours.push_back(Fish::NO_NEIGHBOUR);
+	mv_previous_position_x.push_back(mv_position_x.back());
+	mv_previous_position_y.push_back(mv_position_y.back());
+	mv_previous_position_z.push_back(mv_position_z.back());
+	mv_previous_forward_x .push_back(mv_forward_x .back());
+	mv_previous_forward_y .push_back(mv_forward_y .back());
+	mv_previous_forward_z .push_back(mv_forward_z .back());
+	mv_id.push_back(m_next_id);
+	m_next_id++;
+
+	assert(isInvariantTrue());
+}
+
+void FishArrays :: remove (unsigned int index)
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	unsigned int last = getCount() - 1;
+
+	mv_position_x[index] = mv_position_x[last];
+	mv_position_y[index] = mv_position_y[last];
+	mv_position_z[index] = mv_position_z[last];
+	mv_velocity_x[index] = mv_velocity_x[last];
+	mv_velocity_y[index] = mv_velocity_y[last];
+	mv_velocity_z[index] = mv_velocity_z[last];
+	mv_forward_x [index] = mv_forward_x [last];
+	mv_forward_y [index] = mv_forward_y [last];
+	mv_forward_z [index] = mv_forward_z [last];
+	for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+		mv_neighbours[index * Fish::NEIGHBOUR_COUNT + n] = mv_neighbours[last * Fish::NEIGHBOUR_COUNT + n];
+	mv_previous_position_x[index] = mv_previous_position_x[last];
+	mv_previous_position_y[index] = mv_previous_position_y[last];
+	mv_previous_position_z[index] = mv_previous_position_z[last];
+	mv_previous_forward_x [index] = mv_previous_forward_x [last];
+	mv_previous_forward_y [index] = mv_previous_forward_y [last];
+	mv_previous_forward_z [index] = mv_previous_forward_z [last];
+	mv_id[index] = mv_id[last];
+
+	mv_position_x.pop_back();
+	mv_position_y.pop_back();
+	mv_position_z.pop_back();
+	mv_velocity_x.pop_back();
+	mv_velocity_y.pop_back();
+	mv_velocity_z.pop_back();
+	mv_forward_x .pop_back();
+	mv_forward_y .pop_back();
+	mv_forward_z .pop_back();
+	mv_neighbours.resize(last * Fish::NEIGHBOUR_COUNT);
+	mv_previous_position_x.pop_back();
+	mv_previous_position_y.pop_back();
+	mv_previous_position_z.pop_back();
+	mv_previous_forward_x .pop_back();
+	mv_previous_forward_y .pop_back();
+	mv_previous_forward_z .pop_back();
+	mv_id.pop_back();
+
+	assert(isInvariantTrue());
+}
+
+void FishArrays :: storePrevious ()
+{
+	assert(isInvariantTrue());
+
+	mv_previous_position_x = mv_position_x;
+	mv_previous_position_y = mv_position_y;
+	mv_previous_position_z = mv_position_z;
+	mv_previous_forward_x  = mv_forward_x;
+	mv_previous_forward_y  = mv_forward_y;
+	mv_previous_forward_z  = mv_forward_z;
+
+	assert(isInvariantTrue());
+}
+
+void FishArrays :: reserve (unsigned int count)
+{
+	assert(isInvariantTrue());
+
+	mv_position_x.reserve(count);
+	mv_position_y.reserve(count);
+	mv_position_z.reserve(count);
+	mv_velocity_x.reserve(count);
+	mv_velocity_y.reserve(count);
+	mv_velocity_z.reserve(count);
+	mv_forward_x .reserve(count);
+	mv_forward_y .reserve(count);
+	mv_forward_z .reserve(count);
+	mv_neighbours.reserve(count * Fish::NEIGHBOUR_COUNT);
+	mv_previous_position_x.reserve(count);
+	mv_previous_position_y.reserve(count);
+	mv_previous_position_z.reserve(count);
+	mv_previous_forward_x .reserve(count);
+	mv_previous_forward_y .reserve(count);
+	mv_previous_forward_z .reserve(count);
+	mv_id.reserve(count);
+
+	assert(isInvariantTrue());
+}
+
+
+
+bool FishArrays :: isInvariantTrue () const
+{
+	unsigned int count = mv_position_x.size();
+	if(mv_position_y.size() != count ||
+	   mv_position_z.size() != count ||
+	   mv_velocity_x.size() != count ||
+	   mv_velocity_y.size() != count ||
+	   mv_velocity_z.size() != count ||
+	   mv_forward_x .size() != count ||
+	   mv_forward_y .size() != count ||
+	   mv_forward_z .size() != count ||
+	   mv_previous_position_x.size() != count ||
+	   mv_previous_position_y.size() != count ||
+	   mv_previous_position_z.size() != count ||
+	   mv_previous_forward_x .size() != count ||
+	   mv_previous_forward_y .size() != count ||
+	   mv_previous_forward_z .size() != count ||
+	   mv_id.size() != count)
+	{
+		return false;
+	}
+	if(mv_neighbours.size() != count * Fish::NEIGHBOUR_COUNT)
+		return false;
+	for(unsigned int i = 0; i < count; i++)
+		if(mv_id[i] >= m_next_id)
+			return false;
+	return true;
+}
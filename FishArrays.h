@@ -0,0 +1,284 @@
+//
+//  FishArrays.h
+//
+//  A module to store the state of the fish in a school as a
+//    structure of arrays.
+//
+//  The scalar type used for fish positions and velocities is
+//    FishScalar.  It is double by default.  To use float
+//    instead, which halves the memory used and doubles the
+//    number of fish processed per SIMD instruction, define the
+//    macro UWSIM_FISH_FLOAT for the whole project.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "Fish.h"
+
+
+
+#ifdef UWSIM_FISH_FLOAT
+	typedef float FishScalar;
+#else
+	typedef double FishScalar;
+#endif
+
+
+
+//
+//  FishArrays
+//
+//  A record to store the fish in a school.  Each component of
+//    each per-fish vector is stored in its own contiguous
+//    array so that batched kernels (see FishKernels.h) can load
+//    several fish into a SIMD register at once.  The nearest
+//    neighbours of fish i are stored in mv_neighbours, starting
+//    at index i * Fish::NEIGHBOUR_COUNT.
+//
+//  The positions and forward vectors from before the current
+//    update are also kept, in the mv_previous_ arrays, so that
+//    the fish can be drawn between two updates.  They are set by
+//    storePrevious and are moved with the current values when a
+//    fish is removed, so the indexes always match.
+//
+//  Each fish also has an id, in mv_id, that does not change
+//    when other fish are removed.  Its index may change, so
+//    anything that needs to follow one fish across updates
+//    should keep the id instead.  Ids are not reused.
+//
+//  The arrays are public so that the kernels can access them
+//    directly, but they should only be resized using the
+//    member functions here.
+//
+//  Class Invariant:
+//    <1> All the position, velocity, and forward arrays have
+//        the same size, including the previous ones
+//    <2> mv_neighbours.size() ==
+//                   mv_position_x.size() * Fish::NEIGHBOUR_COUNT
+//    <3> mv_id.size() == mv_position_x.size()
+//    <4> mv_id[i] < m_next_id
+//        WHERE 0 <= i < mv_id.size()
+//
+struct FishArrays
+{
+//
+//  NO_FISH
+//
+//  A special value returned by findId when no fish has the
+//    requested id.
+//
+	static const unsigned int NO_FISH = 0xFFFFFFFF;
+
+//
+//  Default Constructor
+//
+//  Purpose: To construct a FishArrays containing no fish.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: An empty FishArrays is constructed.
+//
+	FishArrays ();
+
+//
+//  getCount
+//
+//  Purpose: To determine the number of fish stored.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of fish.
+//  Side Effect: N/A
+//
+	unsigned int getCount () const;
+
+//
+//  getPosition
+//  getVelocity
+//  getForward
+//
+//  Purpose: To retrieve a vector for the specified fish.
+//  Parameter(s):
+//    <1> index: Which fish
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: The position, velocity, or forward vector for fish
+//           index.
+//  Side Effect: N/A
+//
+	ObjLibrary::Vector3 getPosition (unsigned int index) const;
+	ObjLibrary::Vector3 getVelocity (unsigned int index) const;
+	ObjLibrary::Vector3 getForward  (unsigned int index) const;
+
+//
+//  getNeighbour
+//
+//  Purpose: To retrieve one of the nearest neighbours of the
+//           specified fish.
+//  Parameter(s):
+//    <1> index: Which fish
+//    <2> slot: Which neighbour
+//  Precondition(s):
+//    <1> index < getCount()
+//    <2> slot < Fish::NEIGHBOUR_COUNT
+//  Returns: The index of the neighbour, or Fish::NO_NEIGHBOUR.
+//  Side Effect: N/A
+//
+	unsigned int getNeighbour (unsigned int index,
+	                           unsigned int slot) const;
+
+//
+//  getId
+//
+//  Purpose: To retrieve the id of the specified fish.
+//  Parameter(s):
+//    <1> index: Which fish
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: The id of fish index.
+//  Side Effect: N/A
+//
+	unsigned int getId (unsigned int index) const;
+
+//
+//  findId
+//
+//  Purpose: To determine which fish has the specified id.
+//  Parameter(s):
+//    <1> id: The id to look for
+//  Precondition(s): N/A
+//  Returns: The index of the fish with id id, or NO_FISH if
+//           there is no such fish.
+//  Side Effect: N/A
+//
+	unsigned int findId (unsigned int id) const;
+
+//
+//  setVelocity
+//
+//  Purpose: To change the velocity of the specified fish.
+//  Parameter(s):
+//    <1> index: Which fish
+//    <2> velocity: The new velocity
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: N/A
+//  Side Effect: The velocity of fish index is set to velocity.
+//
+	void setVelocity (unsigned int index,
+	                  const ObjLibrary::Vector3& velocity);
+
+//
+//  bounce
+//
+//  Purpose: To make the specified fish bounce elastically off a
+//           surface, in the same way as Entity::bounce.
+//  Parameter(s):
+//    <1> index: Which fish
+//    <2> normal: The surface normal
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: Whether the fish bounced.
+//  Side Effect: If the fish is moving into the surface, the
+//               component of its velocity along normal is
+//               reversed.
+//
+	bool bounce (unsigned int index,
+	             const ObjLibrary::Vector3& normal);
+
+//
+//  add
+//
+//  Purpose: To add a fish.
+//  Parameter(s):
+//    <1> position: The position of the new fish
+//    <2> velocity: The velocity of the new fish
+//    <3> forward: The forward vector for the new fish
+//  Precondition(s):
+//    <1> forward.isUnit()
+//  Returns: N/A
+//  Side Effect: A fish is added at index getCount() - 1.  It
+//               has no neighbours and a new id.  Its previous
+//               position and forward vector are the same as its
+//               current ones.
+//
+	void add (const ObjLibrary::Vector3& position,
+	          const ObjLibrary::Vector3& velocity,
+	          const ObjLibrary::Vector3& forward);
+
+//
+//  remove
+//
+//  Purpose: To remove a fish.
+//  Parameter(s):
+//    <1> index: Which fish
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: N/A
+//  Side Effect: The last fish is moved into position index and
+//               the count is reduced by 1.  Neighbour indexes
+//               for other fish are not updated.  The previous
+//               values and the id are moved the same way.
+//
+	void remove (unsigned int index);
+
+//
+//  storePrevious
+//
+//  Purpose: To remember the current position and forward vector
+//           of every fish.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The previous position and forward arrays are
+//               set to the current ones.
+//
+	void storePrevious ();
+
+//
+//  reserve
+//
+//  Purpose: To reserve memory for the specified number of fish.
+//  Parameter(s):
+//    <1> count: The number of fish
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: Enough memory for count fish is allocated.
+//
+	void reserve (unsigned int count);
+
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+	std::vector<FishScalar> mv_position_x;
+	std::vector<FishScalar> mv_position_y;
+	std::vector<FishScalar> mv_position_z;
+	std::vector<FishScalar> mv_velocity_x;
+	std::vector<FishScalar> mv_velocity_y;
+	std::vector<FishScalar> mv_velocity_z;
+	std::vector<FishScalar> mv_forward_x;
+	std::vector<FishScalar> mv_forward_y;
+	std::vector<FishScalar> mv_forward_z;
+	std::vector<unsigned int> mv_neighbours;
+
+	std::vector<FishScalar> mv_previous_position_x;
+	std::vector<FishScalar> mv_previous_position_y;
+	std::vector<FishScalar> mv_previous_position_z;
+	std::vector<FishScalar> mv_previous_forward_x;
+	std::vector<FishScalar> mv_previous_forward_y;
+	std::vector<FishScalar> mv_previous_forward_z;
+
+	std::vector<unsigned int> mv_id;
+	unsigned int m_next_id;
+};
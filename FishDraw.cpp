@@ -0,0 +1,77 @@
+//
+//  FishDraw.cpp
+//
+//  The Fish functions that load the fish models and draw them.
+//
+
+#include "Fish.h"
+
+#include <cassert>
+#include <string>
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/Vector3.h"
+#include "ObjLibrary/DisplayList.h"
+
+#include "AssetLoader.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	DisplayList fish_lists[Fish::SPECIES_COUNT];
+
+}  // end of anonymous namespace
+
+
+
+bool Fish :: isModelsLoaded ()
+{
+	assert(0 < SPECIES_COUNT);
+	return fish_lists[0].isReady();
+}
+
+void Fish :: loadModels (const std::string& resource_path)
+{
+	assert(!isModelsLoaded());
+
+	for(unsigned int i = 0; i < SPECIES_COUNT; i++)
+		AssetLoader::getModel(resource_path + getModelFilename(i), fish_lists[i]);
+
+	assert(isModelsLoaded());
+}
+
+void Fish :: addModelAssets (const std::string& resource_path)
+{
+	assert(!AssetLoader::isCpuLoaded());
+
+	for(unsigned int i = 0; i < SPECIES_COUNT; i++)
+		AssetLoader::addModel(resource_path + getModelFilename(i));
+}
+
+void Fish :: drawModel (unsigned int species)
+{
+	assert(isModelsLoaded());
+	assert(species < SPECIES_COUNT);
+
+	assert(fish_lists[species].isReady());
+	fish_lists[species].draw();
+}
+
+
+
+void Fish :: draw () const
+{
+	assert(isInvariantTrue());
+	assert(isModelsLoaded());
+
+	Vector3 center = getPosition();
+	double  radius = getRadius();
+
+	glPushMatrix();
+		applyDrawTransformations();
+		glScaled(radius, radius, radius);
+		drawModel(m_species);
+	glPopMatrix();
+}
@@ -0,0 +1,439 @@
+//
+//  FishKernels.cpp
+//
+
+#include "FishKernels.h"
+
+#include <cassert>
+#include <cstddef>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "Simd.h"
+#include "Fish.h"
+#include "FishArrays.h"
+
+using namespace ObjLibrary;
+using namespace Simd;
+namespace
+{
+	const FishScalar GRAVITY_Y = -9.8f;  // must match Entity.cpp
+	const FishScalar SEPARATION_WEIGHT = 3.0f;
+
+	bool is_simd_enabled = true;
+
+
+
+	//
+	//  truncate
+	//
+	//  Purpose: To reduce the norm of a batch of vectors to at
+	//           most the specified value, in the same way as
+	//           Vector3::truncate.
+	//  Parameter(s):
+	//    <1> r_x
+	//    <2> r_y
+	//    <3> r_z: The vector components
+	//    <4> max_norm: The maximum norm
+	//  Precondition(s):
+	//    <1> max_norm >= 0.0
+	//  Returns: N/A
+	//  Side Effect: Each vector longer than max_norm is scaled
+	//               to have norm max_norm.
+	//
+	template <class LANE>
+	inline void truncate (typename LANE::Value& r_x,
+	                      typename LANE::Value& r_y,
+	                      typename LANE::Value& r_z,
+	                      FishScalar max_norm)
+	{
+		typedef typename LANE::Value Value;
+
+		Value norm_squared = r_x * r_x + r_y * r_y + r_z * r_z;
+		Value max = LANE::set(max_norm);
+		Value scale = LANE::select(LANE::greater(norm_squared, max * max),
+		                           max / LANE::sqrt(norm_squared),
+		                           LANE::set(1));
+		r_x = r_x * scale;
+		r_y = r_y * scale;
+		r_z = r_z * scale;
+	}
+
+	//
+	//  runKernel
+	//
+	//  Purpose: To run a kernel over every fish.
+	//  Parameter(s):
+	//    <1> r_fish: The fish to update, or to read from if
+	//                FISH_ARRAYS is const
+	//    <2> kernel: The kernel to run
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: kernel.run is called for blocks of fish of
+	//               the SIMD width while there are enough fish
+	//               left, and then for each remaining fish one
+	//               at a time.
+	//
+	template <class FISH_ARRAYS, class KERNEL>
+	void runKernel (FISH_ARRAYS& r_fish,
+	                const KERNEL& kernel)
+	{
+		typedef LaneBest<FishScalar> Wide;
+		typedef LaneScalar<FishScalar> Narrow;
+
+		unsigned int count = r_fish.getCount();
+		unsigned int i = 0;
+		if(is_simd_enabled && isAvailable())
+		{
+			for( ; i + Wide::WIDTH <= count; i += Wide::WIDTH)
+				kernel.template run<Wide>(r_fish, i);
+		}
+		for( ; i < count; i++)
+			kernel.template run<Narrow>(r_fish, i);
+	}
+
+
+
+	struct SteerKernel
+	{
+		FishScalar m_target_x;
+		FishScalar m_target_y;
+		FishScalar m_target_z;
+		FishScalar m_max_speed;
+		FishScalar m_max_change;
+		FishScalar m_separation_distance_inverse;
+		FishScalar m_separation_cutoff;
+
+		template <class LANE>
+		void run (FishArrays& r_fish,
+		          unsigned int i) const
+		{
+			typedef typename LANE::Value Value;
+			static const unsigned int WIDTH = LANE::WIDTH;
+
+			unsigned int count = r_fish.getCount();
+			const FishScalar* a_position_x = r_fish.mv_position_x.data();
+			const FishScalar* a_position_y = r_fish.mv_position_y.data();
+			const FishScalar* a_position_z = r_fish.mv_position_z.data();
+
+			Value position_x = LANE::load(a_position_x + i);
+			Value position_y = LANE::load(a_position_y + i);
+			Value position_z = LANE::load(a_position_z + i);
+			Value velocity_x = LANE::load(r_fish.mv_velocity_x.data() + i);
+			Value velocity_y = LANE::load(r_fish.mv_velocity_y.data() + i);
+			Value velocity_z = LANE::load(r_fish.mv_velocity_z.data() + i);
+
+			// seek target
+			Value seek_x = LANE::set(m_target_x) - position_x;
+			Value seek_y = LANE::set(m_target_y) - position_y;
+			Value seek_z = LANE::set(m_target_z) - position_z;
+			truncate<LANE>(seek_x, seek_y, seek_z, m_max_speed);
+
+			//
+			//  Separation from neighbours.  Missing neighbours
+			//    are replaced by the fish itself, which gives an
+			//    offset of 0 and so no force.
+			//
+
+			Value zero      = LANE::set(0);
+			Value one       = LANE::set(1);
+			Value max_speed = LANE::set(m_max_speed);
+			Value inverse   = LANE::set(m_separation_distance_inverse);
+			Value cutoff    = LANE::set(m_separation_cutoff);
+			Value separation_x = zero;
+			Value separation_y = zero;
+			Value separation_z = zero;
+			for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+			{
+				// gathered directly into registers; storing the
+				//  positions to an array and loading them as one
+				//  vector stalls on store forwarding
+				unsigned int a_other[WIDTH];
+				for(unsigned int l = 0; l < WIDTH; l++)
+				{
+					a_other[l] = r_fish.mv_neighbours[(i + l) * Fish::NEIGHBOUR_COUNT + n];
+					if(a_other[l] >= count)
+						a_other[l] = i + l;
+				}
+
+				Value offset_x = position_x - LANE::gather(a_position_x, a_other);
+				Value offset_y = position_y - LANE::gather(a_position_y, a_other);
+				Value offset_z = position_z - LANE::gather(a_position_z, a_other);
+				Value distance = LANE::sqrt(offset_x * offset_x +
+				                            offset_y * offset_y +
+				                            offset_z * offset_z);
+				Value closeness = one - distance * inverse;
+				Value magnitude = LANE::select(LANE::greater(distance, cutoff),
+				                               zero,
+				                               closeness * closeness * max_speed);
+				separation_x = separation_x + offset_x * magnitude;
+				separation_y = separation_y + offset_y * magnitude;
+				separation_z = separation_z + offset_z * magnitude;
+			}
+
+			// combine and accelerate
+			Value weight = LANE::set(SEPARATION_WEIGHT);
+			Value desired_x = seek_x + weight * separation_x;
+			Value desired_y = seek_y + weight * separation_y;
+			Value desired_z = seek_z + weight * separation_z;
+			truncate<LANE>(desired_x, desired_y, desired_z, m_max_speed);
+
+			Value change_x = desired_x - velocity_x;
+			Value change_y = desired_y - velocity_y;
+			Value change_z = desired_z - velocity_z;
+			truncate<LANE>(change_x, change_y, change_z, m_max_change);
+
+			LANE::store(r_fish.mv_velocity_x.data() + i, velocity_x + change_x);
+			LANE::store(r_fish.mv_velocity_y.data() + i, velocity_y + change_y);
+			LANE::store(r_fish.mv_velocity_z.data() + i, velocity_z + change_z);
+		}
+	};
+
+	struct GravityKernel
+	{
+		FishScalar m_delta_velocity_y;
+
+		template <class LANE>
+		void run (FishArrays& r_fish,
+		          unsigned int i) const
+		{
+			typedef typename LANE::Value Value;
+
+			Value position_y = LANE::load(r_fish.mv_position_y.data() + i);
+			Value velocity_y = LANE::load(r_fish.mv_velocity_y.data() + i);
+			Value zero       = LANE::set(0);
+			Value delta      = LANE::select(LANE::greater(position_y, zero),
+			                                LANE::set(m_delta_velocity_y),
+			                                zero);
+			LANE::store(r_fish.mv_velocity_y.data() + i, velocity_y + delta);
+		}
+	};
+
+	struct MoveKernel
+	{
+		FishScalar m_delta_time;
+
+		template <class LANE>
+		void run (FishArrays& r_fish,
+		          unsigned int i) const
+		{
+			typedef typename LANE::Value Value;
+
+			Value delta_time = LANE::set(m_delta_time);
+			FishScalar* a_position_x = r_fish.mv_position_x.data();
+			FishScalar* a_position_y = r_fish.mv_position_y.data();
+			FishScalar* a_position_z = r_fish.mv_position_z.data();
+			LANE::store(a_position_x + i, LANE::load(a_position_x + i) +
+			            LANE::load(r_fish.mv_velocity_x.data() + i) * delta_time);
+			LANE::store(a_position_y + i, LANE::load(a_position_y + i) +
+			            LANE::load(r_fish.mv_velocity_y.data() + i) * delta_time);
+			LANE::store(a_position_z + i, LANE::load(a_position_z + i) +
+			            LANE::load(r_fish.mv_velocity_z.data() + i) * delta_time);
+		}
+	};
+
+	struct ForwardKernel
+	{
+		template <class LANE>
+		void run (FishArrays& r_fish,
+		          unsigned int i) const
+		{
+			typedef typename LANE::Value Value;
+
+			Value velocity_x = LANE::load(r_fish.mv_velocity_x.data() + i);
+			Value velocity_y = LANE::load(r_fish.mv_velocity_y.data() + i);
+			Value velocity_z = LANE::load(r_fish.mv_velocity_z.data() + i);
+			Value norm_squared = velocity_x * velocity_x +
+			                     velocity_y * velocity_y +
+			                     velocity_z * velocity_z;
+			Value inverse = LANE::set(1) / LANE::sqrt(norm_squared);
+			typename LANE::Mask is_moving = LANE::greater(norm_squared, LANE::set(0));
+
+			FishScalar* a_forward_x = r_fish.mv_forward_x.data();
+			FishScalar* a_forward_y = r_fish.mv_forward_y.data();
+			FishScalar* a_forward_z = r_fish.mv_forward_z.data();
+			LANE::store(a_forward_x + i, LANE::select(is_moving, velocity_x * inverse, LANE::load(a_forward_x + i)));
+			LANE::store(a_forward_y + i, LANE::select(is_moving, velocity_y * inverse, LANE::load(a_forward_y + i)));
+			LANE::store(a_forward_z + i, LANE::select(is_moving, velocity_z * inverse, LANE::load(a_forward_z + i)));
+		}
+	};
+
+	struct InstanceMatrixKernel
+	{
+		FishScalar m_scale;
+		FishScalar m_alpha;
+		float* mpa_matrices;
+
+		template <class LANE>
+		void run (const FishArrays& fish,
+		          unsigned int i) const
+		{
+			typedef typename LANE::Value Value;
+			static const unsigned int WIDTH = LANE::WIDTH;
+
+			Value zero = LANE::set(0);
+			Value one  = LANE::set(1);
+
+			// blend from the previous update to the current one
+			Value alpha = LANE::set(m_alpha);
+			Value current_x = LANE::load(fish.mv_forward_x.data() + i);
+			Value current_y = LANE::load(fish.mv_forward_y.data() + i);
+			Value current_z = LANE::load(fish.mv_forward_z.data() + i);
+			Value previous_x = LANE::load(fish.mv_previous_forward_x.data() + i);
+			Value previous_y = LANE::load(fish.mv_previous_forward_y.data() + i);
+			Value previous_z = LANE::load(fish.mv_previous_forward_z.data() + i);
+			Value forward_x = previous_x + (current_x - previous_x) * alpha;
+			Value forward_y = previous_y + (current_y - previous_y) * alpha;
+			Value forward_z = previous_z + (current_z - previous_z) * alpha;
+			Value norm_squared = forward_x * forward_x +
+			                     forward_y * forward_y +
+			                     forward_z * forward_z;
+
+			// a fish that turned right around has no forward
+			//  vector half way, so use the current one
+			typename LANE::Mask is_blended = LANE::greater(norm_squared, LANE::set(1.0e-6f));
+			forward_x = LANE::select(is_blended, forward_x, current_x);
+			forward_y = LANE::select(is_blended, forward_y, current_y);
+			forward_z = LANE::select(is_blended, forward_z, current_z);
+
+			// same normalization as FishSchool::getFish
+			Value inverse = one / LANE::sqrt(forward_x * forward_x +
+			                                 forward_y * forward_y +
+			                                 forward_z * forward_z);
+			forward_x = forward_x * inverse;
+			forward_y = forward_y * inverse;
+			forward_z = forward_z * inverse;
+
+			// CoordinateSystem::calculateUpVector rotates forward
+			//  by 90 degrees around forward x (0, 1, 0), which
+			//  simplifies to this; a vertical fish gets +X
+			Value horizontal_squared = forward_x * forward_x + forward_z * forward_z;
+			typename LANE::Mask is_tilted = LANE::greater(horizontal_squared, zero);
+			Value horizontal = LANE::sqrt(horizontal_squared);
+			Value ratio = LANE::select(is_tilted, forward_y / horizontal, zero);
+			Value up_x = LANE::select(is_tilted, zero - forward_x * ratio, one);
+			Value up_y = horizontal;
+			Value up_z = zero - forward_z * ratio;
+
+			Value right_x = forward_y * up_z - forward_z * up_y;
+			Value right_y = forward_z * up_x - forward_x * up_z;
+			Value right_z = forward_x * up_y - forward_y * up_x;
+
+			Value scale = LANE::set(m_scale);
+			FishScalar aa_columns[12][WIDTH];
+			LANE::store(aa_columns[ 0], forward_x * scale);
+			LANE::store(aa_columns[ 1], forward_y * scale);
+			LANE::store(aa_columns[ 2], forward_z * scale);
+			LANE::store(aa_columns[ 3], up_x * scale);
+			LANE::store(aa_columns[ 4], up_y * scale);
+			LANE::store(aa_columns[ 5], up_z * scale);
+			LANE::store(aa_columns[ 6], right_x * scale);
+			LANE::store(aa_columns[ 7], right_y * scale);
+			LANE::store(aa_columns[ 8], right_z * scale);
+			Value position_x = LANE::load(fish.mv_previous_position_x.data() + i);
+			Value position_y = LANE::load(fish.mv_previous_position_y.data() + i);
+			Value position_z = LANE::load(fish.mv_previous_position_z.data() + i);
+			position_x = position_x + (LANE::load(fish.mv_position_x.data() + i) - position_x) * alpha;
+			position_y = position_y + (LANE::load(fish.mv_position_y.data() + i) - position_y) * alpha;
+			position_z = position_z + (LANE::load(fish.mv_position_z.data() + i) - position_z) * alpha;
+			LANE::store(aa_columns[ 9], position_x);
+			LANE::store(aa_columns[10], position_y);
+			LANE::store(aa_columns[11], position_z);
+
+			// transpose into one matrix per fish
+			for(unsigned int l = 0; l < WIDTH; l++)
+			{
+				float* a_matrix = mpa_matrices + (size_t)(i + l) * FishKernels::MATRIX_SIZE;
+				for(unsigned int c = 0; c < 4; c++)
+				{
+					a_matrix[c * 4 + 0] = (float)(aa_columns[c * 3 + 0][l]);
+					a_matrix[c * 4 + 1] = (float)(aa_columns[c * 3 + 1][l]);
+					a_matrix[c * 4 + 2] = (float)(aa_columns[c * 3 + 2][l]);
+					a_matrix[c * 4 + 3] = 0.0f;
+				}
+				a_matrix[15] = 1.0f;
+			}
+		}
+	};
+
+}  // end of anonymous namespace
+
+
+
+bool FishKernels :: isSimdEnabled ()
+{
+	return is_simd_enabled && isAvailable();
+}
+
+void FishKernels :: setSimdEnabled (bool is_enabled)
+{
+	is_simd_enabled = is_enabled;
+}
+
+
+
+void FishKernels :: steerAll (FishArrays& r_fish,
+                              const ObjLibrary::Vector3& target,
+                              double max_speed,
+                              double max_acceleration,
+                              double separation_distance,
+                              double separation_cutoff,
+                              float delta_time)
+{
+	assert(max_speed >= 0.0);
+	assert(max_acceleration >= 0.0);
+	assert(separation_distance > 0.0);
+	assert(delta_time >= 0.0);
+
+	SteerKernel kernel;
+	kernel.m_target_x   = (FishScalar)(target.x);
+	kernel.m_target_y   = (FishScalar)(target.y);
+	kernel.m_target_z   = (FishScalar)(target.z);
+	kernel.m_max_speed  = (FishScalar)(max_speed);
+	kernel.m_max_change = (FishScalar)(max_acceleration * delta_time);
+	kernel.m_separation_distance_inverse = (FishScalar)(1.0 / separation_distance);
+	kernel.m_separation_cutoff           = (FishScalar)(separation_cutoff);
+	runKernel(r_fish, kernel);
+}
+
+void FishKernels :: applyGravityAll (FishArrays& r_fish,
+                                     float delta_time)
+{
+	assert(delta_time >= 0.0);
+
+	GravityKernel kernel;
+	kernel.m_delta_velocity_y = GRAVITY_Y * delta_time;
+	runKernel(r_fish, kernel);
+}
+
+void FishKernels :: moveAllByVelocity (FishArrays& r_fish,
+                                       float delta_time)
+{
+	assert(delta_time >= 0.0);
+
+	MoveKernel kernel;
+	kernel.m_delta_time = delta_time;
+	runKernel(r_fish, kernel);
+}
+
+void FishKernels :: updateForwardAll (FishArrays& r_fish)
+{
+	ForwardKernel kernel;
+	runKernel(r_fish, kernel);
+}
+
+void FishKernels :: packInstanceMatricesAll (const FishArrays& fish,
+                                             double scale,
+                                             float alpha,
+                                             float* pa_matrices)
+{
+	assert(fish.getCount() == 0 || pa_matrices != NULL);
+	assert(alpha >= 0.0f);
+	assert(alpha <= 1.0f);
+
+	InstanceMatrixKernel kernel;
+	kernel.m_scale      = (FishScalar)(scale);
+	kernel.m_alpha      = (FishScalar)(alpha);
+	kernel.mpa_matrices = pa_matrices;
+	runKernel(fish, kernel);
+}
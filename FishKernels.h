@@ -0,0 +1,185 @@
+//
+//  FishKernels.h
+//
+//  A module to update all the fish in a school at once.
+//
+//  Each function here processes every fish stored in a
+//    FishArrays.  When SIMD is enabled (the default), several
+//    fish are processed per instruction using the widest
+//    instruction set in Simd.h, and any leftover fish are
+//    processed one at a time.  The results are the same either
+//    way except for floating-point rounding.
+//
+
+#pragma once
+
+#include "ObjLibrary/Vector3.h"
+
+struct FishArrays;
+
+
+
+namespace FishKernels
+{
+
+//
+//  MATRIX_SIZE
+//
+//  The number of floats in one instance matrix written by
+//    packInstanceMatricesAll.
+//
+const unsigned int MATRIX_SIZE = 16;
+
+//
+//  isSimdEnabled
+//
+//  Purpose: To determine if the kernels will use SIMD
+//           instructions.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether SIMD is enabled.  This is always false if
+//           no SIMD instruction set was compiled in.
+//  Side Effect: N/A
+//
+bool isSimdEnabled ();
+
+//
+//  setSimdEnabled
+//
+//  Purpose: To change whether the kernels use SIMD
+//           instructions.
+//  Parameter(s):
+//    <1> is_enabled: Whether SIMD should be used
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: If is_enabled is true and a SIMD instruction
+//               set was compiled in, the kernels will use SIMD.
+//               Otherwise, they will process one fish at a time.
+//
+void setSimdEnabled (bool is_enabled);
+
+//
+//  steerAll
+//
+//  Purpose: To update the velocity of every fish to seek a
+//           target while staying away from its neighbours.
+//  Parameter(s):
+//    <1> r_fish: The fish to update
+//    <2> target: The position to seek
+//    <3> max_speed: The maximum fish speed
+//    <4> max_acceleration: The maximum fish acceleration
+//    <5> separation_distance: The distance at which the
+//                             separation force falls to 0
+//    <6> separation_cutoff: Neighbours farther away than this
+//                           are ignored
+//    <7> delta_time: The duration of the update
+//  Precondition(s):
+//    <1> max_speed >= 0.0
+//    <2> max_acceleration >= 0.0
+//    <3> separation_distance > 0.0
+//    <4> delta_time >= 0.0
+//  Returns: N/A
+//  Side Effect: For each fish, the desired velocity is the
+//               offset to target, truncated to max_speed, plus
+//               3 times the separation force from its
+//               neighbours, all truncated to max_speed.  The
+//               velocity is then changed towards the desired
+//               velocity by at most max_acceleration *
+//               delta_time.  The neighbour arrays must be
+//               current.
+//
+void steerAll (FishArrays& r_fish,
+               const ObjLibrary::Vector3& target,
+               double max_speed,
+               double max_acceleration,
+               double separation_distance,
+               double separation_cutoff,
+               float delta_time);
+
+//
+//  applyGravityAll
+//
+//  Purpose: To apply gravity to every fish that is above the
+//           water.
+//  Parameter(s):
+//    <1> r_fish: The fish to update
+//    <2> delta_time: The duration to apply gravity for
+//  Precondition(s):
+//    <1> delta_time >= 0.0
+//  Returns: N/A
+//  Side Effect: Each fish with a positive y coordinate is
+//               accelerated downward for delta_time.
+//
+void applyGravityAll (FishArrays& r_fish,
+                      float delta_time);
+
+//
+//  moveAllByVelocity
+//
+//  Purpose: To move every fish according to its velocity.
+//  Parameter(s):
+//    <1> r_fish: The fish to update
+//    <2> delta_time: The duration to move for
+//  Precondition(s):
+//    <1> delta_time >= 0.0
+//  Returns: N/A
+//  Side Effect: The position of each fish is updated for moving
+//               at its current velocity for delta_time.
+//
+void moveAllByVelocity (FishArrays& r_fish,
+                        float delta_time);
+
+//
+//  updateForwardAll
+//
+//  Purpose: To point every fish in the direction it is moving.
+//  Parameter(s):
+//    <1> r_fish: The fish to update
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The forward vector of each fish is set to its
+//               normalized velocity.  Fish that are not moving
+//               keep their current forward vector.
+//
+void updateForwardAll (FishArrays& r_fish);
+
+//
+//  packInstanceMatricesAll
+//
+//  Purpose: To calculate the model matrix used to display every
+//           fish.
+//  Parameter(s):
+//    <1> fish: The fish to display
+//    <2> scale: The size to display the fish at
+//    <3> alpha: How far to display the fish between their
+//               previous and current states
+//    <4> pa_matrices: The array to write the matrices to
+//  Precondition(s):
+//    <1> fish.getCount() == 0 || pa_matrices != NULL
+//    <2> pa_matrices has room for fish.getCount() *
+//        MATRIX_SIZE floats
+//    <3> alpha >= 0.0f
+//    <4> alpha <= 1.0f
+//  Returns: N/A
+//  Side Effect: For each fish i, a column-major matrix suitable
+//               for glLoadMatrixf or glMultMatrixf is written
+//               starting at pa_matrices[i * MATRIX_SIZE].  The
+//               matrix is the same as the one produced by
+//               FishSchool::getFish(i).applyDrawTransformations
+//               followed by glScaled(scale, scale, scale),
+//               except for floating-point rounding.  The up
+//               vector is calculated from the forward vector
+//               directly instead of by a general rotation.
+//               The position and forward vector are blended
+//               linearly by alpha from the values saved by
+//               FishArrays::storePrevious, so an alpha of 1.0f
+//               gives the current state.
+//
+void packInstanceMatricesAll (const FishArrays& fish,
+                              double scale,
+                              float alpha,
+                              float* pa_matrices);
+
+
+
+}  // end of namespace FishKernels
@@ -0,0 +1,112 @@
+//
+//  FishRenderer.cpp
+//
+
+#include "FishRenderer.h"
+
+#include <cassert>
+#include <vector>
+
+#include "GetGlut.h"
+
+#include "Fish.h"
+#include "FishSchool.h"
+#include "FishKernels.h"
+
+using namespace std;
+namespace
+{
+	//
+	//  multiplyMatrices
+	//
+	//  Purpose: To multiply two column-major 4x4 matrices whose
+	//           bottom rows are (0, 0, 0, 1).
+	//  Parameter(s):
+	//    <1> a_left
+	//    <2> a_right: The matrices to multiply
+	//    <3> a_result: The array to write the product to
+	//  Precondition(s):
+	//    <1> a_result is not a_left or a_right
+	//  Returns: N/A
+	//  Side Effect: a_result is set to a_left * a_right.
+	//
+	void multiplyMatrices (const float a_left[],
+	                       const float a_right[],
+	                       float a_result[])
+	{
+		assert(a_result != a_left);
+		assert(a_result != a_right);
+
+		for(unsigned int c = 0; c < 4; c++)
+		{
+			const float* a_column = a_right + c * 4;
+			for(unsigned int r = 0; r < 3; r++)
+				a_result[c * 4 + r] = a_left[ 0 + r] * a_column[0] +
+				                      a_left[ 4 + r] * a_column[1] +
+				                      a_left[ 8 + r] * a_column[2] +
+				                      a_left[12 + r] * a_column[3];
+			a_result[c * 4 + 3] = a_column[3];
+		}
+	}
+
+}  // end of anonymous namespace
+
+
+
+FishRenderer :: FishRenderer ()
+{
+}
+
+
+
+unsigned int FishRenderer :: getInstanceCount (unsigned int species) const
+{
+	assert(species < Fish::SPECIES_COUNT);
+
+	return mav_matrices[species].size() / FishKernels::MATRIX_SIZE;
+}
+
+const std::vector<float>& FishRenderer :: getInstanceMatrices (unsigned int species) const
+{
+	assert(species < Fish::SPECIES_COUNT);
+
+	return mav_matrices[species];
+}
+
+void FishRenderer :: clear ()
+{
+	for(unsigned int s = 0; s < Fish::SPECIES_COUNT; s++)
+		mav_matrices[s].clear();
+}
+
+void FishRenderer :: addSchool (const FishSchool& school,
+                                float alpha)
+{
+	assert(school.getSpecies() < Fish::SPECIES_COUNT);
+	assert(alpha >= 0.0f);
+	assert(alpha <= 1.0f);
+
+	school.appendInstanceMatrices(mav_matrices[school.getSpecies()], alpha);
+}
+
+void FishRenderer :: draw () const
+{
+	assert(Fish::isModelsLoaded());
+
+	float a_camera[FishKernels::MATRIX_SIZE];
+	glGetFloatv(GL_MODELVIEW_MATRIX, a_camera);
+
+	for(unsigned int s = 0; s < Fish::SPECIES_COUNT; s++)
+	{
+		const vector<float>& v_matrices = mav_matrices[s];
+		for(unsigned int i = 0; i < v_matrices.size(); i += FishKernels::MATRIX_SIZE)
+		{
+			float a_modelview[FishKernels::MATRIX_SIZE];
+			multiplyMatrices(a_camera, v_matrices.data() + i, a_modelview);
+			glLoadMatrixf(a_modelview);
+			Fish::drawModel(s);
+		}
+	}
+
+	glLoadMatrixf(a_camera);
+}
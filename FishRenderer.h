@@ -0,0 +1,128 @@
+//
+//  FishRenderer.h
+//
+//  A module to display many fish with few state changes.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "Fish.h"
+
+class FishSchool;
+
+
+
+//
+//  FishRenderer
+//
+//  A class to collect the fish to display in a frame and then
+//    display them grouped by species.  The model matrix of each
+//    fish is built directly from the fish arrays by
+//    FishKernels::packInstanceMatricesAll, so no Fish objects
+//    are created, and the matrices for each species are stored
+//    in one contiguous instance buffer.
+//
+//  OpenGL 1.1 has no instanced draw call, so draw combines each
+//    instance matrix with the camera matrix on the CPU and
+//    replaces the modelview matrix once per fish instead of
+//    pushing, translating, rotating, scaling, and popping it.
+//    The instance buffers are laid out so that they could be
+//    uploaded unchanged as per-instance attributes on a newer
+//    OpenGL version.
+//
+class FishRenderer
+{
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To create a FishRenderer with no fish.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A FishRenderer is created with empty instance
+//               buffers.
+//
+	FishRenderer ();
+
+//
+//  getInstanceCount
+//
+//  Purpose: To determine how many fish of a species will be
+//           displayed.
+//  Parameter(s):
+//    <1> species: The fish species
+//  Precondition(s):
+//    <1> species < Fish::SPECIES_COUNT
+//  Returns: The number of fish of species species added since
+//           the last call to clear.
+//  Side Effect: N/A
+//
+	unsigned int getInstanceCount (unsigned int species) const;
+
+//
+//  getInstanceMatrices
+//
+//  Purpose: To retrieve the instance buffer for a species.
+//  Parameter(s):
+//    <1> species: The fish species
+//  Precondition(s):
+//    <1> species < Fish::SPECIES_COUNT
+//  Returns: The model matrices of the fish of species species,
+//           FishKernels::MATRIX_SIZE floats per fish, in the
+//           order they were added.
+//  Side Effect: N/A
+//
+	const std::vector<float>& getInstanceMatrices (unsigned int species) const;
+
+//
+//  clear
+//
+//  Purpose: To remove all fish from this FishRenderer.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: All instance buffers are emptied.  Their memory
+//               is kept for the next frame.
+//
+	void clear ();
+
+//
+//  addSchool
+//
+//  Purpose: To add all the fish in a school to be displayed.
+//  Parameter(s):
+//    <1> school: The school to add
+//    <2> alpha: How far to display the fish between the
+//               previous and current updates
+//  Precondition(s):
+//    <1> alpha >= 0.0f
+//    <2> alpha <= 1.0f
+//  Returns: N/A
+//  Side Effect: The model matrix for each fish in school is
+//               appended to the instance buffer for its
+//               species.
+//
+	void addSchool (const FishSchool& school,
+	                float alpha);
+
+//
+//  draw
+//
+//  Purpose: To display the fish in this FishRenderer.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> Fish::isModelsLoaded()
+//  Returns: N/A
+//  Side Effect: Every fish added since the last call to clear
+//               is displayed, one species at a time.  The
+//               modelview matrix is the same afterwards as it
+//               was before.
+//
+	void draw () const;
+
+private:
+	std::vector<float> mav_matrices[Fish::SPECIES_COUNT];
+};
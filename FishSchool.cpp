@@ -4,15 +4,18 @@
 
 #include "FishSchool.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <vector>
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector3.h"
 
 #include "Entity.h"
 #include "Fish.h"
+#include "FishArrays.h"
+#include "FishKernels.h"
+#include "RandomStream.h"
 #include "Terrain.h"
 #include "FixedEntity.h"
 #include "Collision.h"
@@ -25,27 +28,32 @@ using namespace ObjLibrary;
 FishSchool :: FishSchool ()
 		: Entity(Vector3::ZERO, 1.0),
 		  m_species(0)
-		// mv_fish will be initialized to empty by the default constructor
+		// m_fish will be initialized to empty by the default constructor
+		// m_aggregates will be initialized below
+		// m_random will be initialized by the default constructor
 {
+	m_aggregates.m_count = 0;
+	updateAggregates();
+
 	assert(isInvariantTrue());
 	explore_area_center = Vector3(0.0,0.0,0.0);
 	maximum_explore_distance = 1.0;
 	flock_leader.setPosition(Vector3(0.0, 0.0, 0.0));
 	current_explore_target = Vector3(0.0, 0.0, 0.0);
-	counter = (rand() % (60 - 0)) + 0;
-	
-	
+	m_previous_leader_position = Vector3(0.0, 0.0, 0.0);
 }
 
 FishSchool :: FishSchool (const ObjLibrary::Vector3& school_center,
                           double school_radius,
                           unsigned int fish_count,
-                          unsigned int fish_species, double maximum_explore_area)
+                          unsigned int fish_species, double maximum_explore_area,
+                          const RandomStream& random)
 		: Entity(school_center, school_radius),
-		  m_species(fish_species)
-		// mv_fish will be initialized below
+		  m_species(fish_species),
+		  // m_fish will be initialized below
+		  // m_aggregates will be initialized below
+		  m_random(random)
 {
-	assert(Fish::isModelsLoaded());
 	assert(school_radius > 0.0);
 	assert(fish_species < Fish::SPECIES_COUNT);
 
@@ -54,23 +62,26 @@ FishSchool :: FishSchool (const ObjLibrary::Vector3& school_center,
 
 	flock_leader.setPosition(school_center);
 	current_explore_target = school_center;
+	m_previous_leader_position = school_center;
 
 	
 
 	double speed = Fish::getSpeed(fish_species);
 
+	m_fish.reserve(fish_count);
 	for(unsigned int i = 0; i < fish_count; i++)
 	{
-		Vector3 position = school_center + Vector3::getRandomSphereVector() * school_radius;
-		Vector3 forward  = Vector3::getRandomUnitVector();
-		Fish fish(position, forward, fish_species);
-		fish.setVelocity(forward * speed);
-		mv_fish.push_back(fish);
+		Vector3 position = school_center + m_random.getSphereVector() * school_radius;
+		Vector3 forward  = m_random.getUnitVector();
+		m_fish.add(position, forward * speed, forward);
 	}
 
 
 	
-	assert(mv_fish.size() == fish_count);
+	assert(m_fish.getCount() == fish_count);
+
+	m_aggregates.m_count = fish_count;
+	updateAggregates();
 
 	assert(isInvariantTrue());
 }
@@ -88,55 +99,51 @@ unsigned int FishSchool :: getCount () const
 {
 	assert(isInvariantTrue());
 
-	return mv_fish.size();
+	return m_fish.getCount();
 }
 
-void FishSchool :: draw () const
+const SchoolAggregates& FishSchool :: getAggregates () const
 {
 	assert(isInvariantTrue());
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-		mv_fish[i].draw();
+	return m_aggregates;
 }
 
-void FishSchool :: drawAllCoordinateSystems (double length) const
+void FishSchool :: appendInstanceMatrices (std::vector<float>& r_matrices,
+                                          float alpha) const
 {
 	assert(isInvariantTrue());
-	assert(length > 0.0);
+	assert(alpha >= 0.0f);
+	assert(alpha <= 1.0f);
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-	{
-		glPushMatrix();
-			mv_fish[i].applyDrawTransformations();
-			glBegin(GL_LINES);
-				glColor3d(1.0, 0.0, 0.0);
-				glVertex3d(0.0, 0.0, 0.0);
-				glVertex3d(length, 0.0, 0.0);
-				glColor3d(0.0, 1.0, 0.0);
-				glVertex3d(0.0, 0.0, 0.0);
-				glVertex3d(0.0, length, 0.0);
-				glColor3d(0.0, 0.0, 1.0);
-				glVertex3d(0.0, 0.0, 0.0);
-				glVertex3d(0.0, 0.0, length);
-			glEnd();
-		glPopMatrix();
-	}
+	if(m_fish.getCount() == 0)
+		return;
+
+	size_t start = r_matrices.size();
+	r_matrices.resize(start + m_fish.getCount() * FishKernels::MATRIX_SIZE);
+	FishKernels::packInstanceMatricesAll(m_fish,
+	                                     Fish::getSpeciesRadius(m_species),
+	                                     alpha,
+	                                     r_matrices.data() + start);
 }
 
-void FishSchool :: drawAllCollisionSpheres () const
+void FishSchool :: storePreviousState ()
 {
 	assert(isInvariantTrue());
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-	{
-		double radius = mv_fish[i].getRadius();
-		glPushMatrix();
-			mv_fish[i].applyDrawTransformations();
-			glScaled(radius, radius, radius);
-			glutWireIcosahedron();
-			//glutWireSphere(1.0, 8, 6);
-		glPopMatrix();
-	}
+	m_fish.storePrevious();
+	m_previous_leader_position = flock_leader.getPosition();
+
+	assert(isInvariantTrue());
+}
+
+Vector3 FishSchool :: getLeaderRenderPosition (float alpha) const
+{
+	assert(alpha >= 0.0f);
+	assert(alpha <= 1.0f);
+
+	return m_previous_leader_position +
+	       (flock_leader.getPosition() - m_previous_leader_position) * alpha;
 }
 
 
@@ -146,8 +153,7 @@ void FishSchool :: moveAllByVelocity (float delta_time)
 	assert(isInvariantTrue());
 	assert(delta_time >= 0.0);
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-		mv_fish[i].moveByVelocity(delta_time);
+	FishKernels::moveAllByVelocity(m_fish, delta_time);
 
 	flock_leader.moveByVelocity(delta_time);
 	//drawLine();
@@ -160,9 +166,7 @@ void FishSchool :: applyGravityAll (float delta_time)
 	assert(isInvariantTrue());
 	assert(delta_time >= 0.0);
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-		if(mv_fish[i].getPosition().y > 0)
-			mv_fish[i].applyGravity(delta_time);
+	FishKernels::applyGravityAll(m_fish, delta_time);
 
 	assert(isInvariantTrue());
 }
@@ -171,14 +175,14 @@ void FishSchool :: bounceAllInwards ()
 {
 	assert(isInvariantTrue());
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
+	for(unsigned int i = 0; i < m_fish.getCount(); i++)
 	{
-		Vector3 fish_pos = mv_fish[i].getPosition();
+		Vector3 fish_pos = m_fish.getPosition(i);
 		if(fish_pos.isDistanceGreaterThan(getPosition(), getRadius()))
 		{
 			Vector3 normal = getPosition() - fish_pos;
 			normal.normalize();
-			mv_fish[i].bounce(normal);
+			m_fish.bounce(i, normal);
 		}
 	}
 
@@ -189,14 +193,51 @@ void FishSchool :: checkCollisionAll (const Terrain& terrain)
 {
 	assert(isInvariantTrue());
 
-	// no school-level check
+	// school-level check: is the whole school above the highest point?
+	if(m_aggregates.m_count == 0 ||
+	   m_aggregates.m_box_min.y >= terrain.getMaxHeight())
+	{
+		return;
+	}
+
+	unsigned int fish_count = m_fish.getCount();
+	mv_terrain_heights.resize(fish_count);
+	terrain.getHeights(fish_count, &m_fish.mv_position_x[0], &m_fish.mv_position_z[0],
+	                   &mv_terrain_heights[0]);
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-		if(isCollision(mv_fish[i], terrain))
+	// same test as isCollision(position, radius, terrain)
+	double radius = Fish::getSpeciesRadius(m_species);
+	mv_terrain_hits.clear();
+	mv_terrain_hit_x.clear();
+	mv_terrain_hit_z.clear();
+	for(unsigned int i = 0; i < fish_count; i++)
+	{
+		if(mv_terrain_heights[i] + radius > m_fish.mv_position_y[i])
 		{
-			Vector3 surface_normal = terrain.getSurfaceNormal(mv_fish[i].getPosition());
-			mv_fish[i].bounce(surface_normal);
+			mv_terrain_hits.push_back(i);
+			mv_terrain_hit_x.push_back(m_fish.mv_position_x[i]);
+			mv_terrain_hit_z.push_back(m_fish.mv_position_z[i]);
 		}
+	}
+
+	unsigned int hit_count = mv_terrain_hits.size();
+	if(hit_count == 0)
+		return;
+
+	mv_terrain_normal_x.resize(hit_count);
+	mv_terrain_normal_y.resize(hit_count);
+	mv_terrain_normal_z.resize(hit_count);
+	terrain.getSurfaceNormals(hit_count, &mv_terrain_hit_x[0], &mv_terrain_hit_z[0],
+	                          &mv_terrain_normal_x[0],
+	                          &mv_terrain_normal_y[0],
+	                          &mv_terrain_normal_z[0]);
+	for(unsigned int h = 0; h < hit_count; h++)
+	{
+		Vector3 surface_normal(mv_terrain_normal_x[h],
+		                       mv_terrain_normal_y[h],
+		                       mv_terrain_normal_z[h]);
+		m_fish.bounce(mv_terrain_hits[h], surface_normal);
+	}
 
 	assert(isInvariantTrue());
 }
@@ -207,13 +248,14 @@ void FishSchool :: checkCollisionAll (const FixedEntity& entity)
 
 	if(isCollision(*this, entity))
 	{
-		for(unsigned int i = 0; i < mv_fish.size(); i++)
+		double radius = Fish::getSpeciesRadius(m_species);
+		for(unsigned int i = 0; i < m_fish.getCount(); i++)
 		{
-			Fish& r_fish = mv_fish[i];
-			if(isCollision(entity, r_fish))
+			Vector3 position = m_fish.getPosition(i);
+			if(isCollision(position, radius, entity))
 			{
-				Vector3 surface_normal = entity.getSurfaceNormal(r_fish.getPosition());
-				r_fish.bounce(surface_normal);
+				Vector3 surface_normal = entity.getSurfaceNormal(position);
+				m_fish.bounce(i, surface_normal);
 			}
 		}
 	}
@@ -228,14 +270,15 @@ unsigned int FishSchool :: checkPlayerCaughtFish (const Entity& player)
 	unsigned int caught_count = 0;
 	if(isCollision(*this, player))
 	{
-		for(unsigned int i = 0; i < mv_fish.size(); i++)
-			if(isCollision(player, mv_fish[i]))
+		double radius = Fish::getSpeciesRadius(m_species);
+		for(unsigned int i = 0; i < m_fish.getCount(); i++)
+			if(isCollision(m_fish.getPosition(i), radius, player))
 			{
 				caught_count++;
 
-				// remove fish from vector
-				mv_fish[i] = mv_fish.back();
-				mv_fish.pop_back();
+				// remove fish from arrays
+				removeFromAggregates(i);
+				m_fish.remove(i);
 				i--;  // don't skip new fish in this spot
 
 
@@ -250,25 +293,197 @@ void FishSchool :: updateOrientationAll ()
 {
 	assert(isInvariantTrue());
 
-	for(unsigned int i = 0; i < mv_fish.size(); i++)
-		mv_fish[i].setOrientation(mv_fish[i].getVelocity().getNormalized());
+	FishKernels::updateForwardAll(m_fish);
+
+	assert(isInvariantTrue());
+}
+
+void FishSchool :: updateAggregates ()
+{
+	assert(m_aggregates.m_count == m_fish.getCount());
+
+	unsigned int fish_count = m_fish.getCount();
+	SchoolAggregates& r_agg = m_aggregates;
+	Vector3 previous_centroid = getPosition();
+
+	if(fish_count == 0)
+	{
+		r_agg.m_position_sum = Vector3::ZERO;
+		r_agg.m_centroid     = previous_centroid;
+		r_agg.m_radius       = 0.0;
+		r_agg.m_box_min      = previous_centroid;
+		r_agg.m_box_max      = previous_centroid;
+		r_agg.m_heading_sum  = Vector3::ZERO;
+		r_agg.m_mean_heading = Vector3::ZERO;
+		r_agg.m_speed_sum    = 0.0;
+		r_agg.m_speed_min    = 0.0;
+		r_agg.m_speed_max    = 0.0;
+		r_agg.m_speed_mean   = 0.0;
+		setRadius(0.0);
+		assert(isInvariantTrue());
+		return;
+	}
+
+	const FishScalar* a_position_x = m_fish.mv_position_x.data();
+	const FishScalar* a_position_y = m_fish.mv_position_y.data();
+	const FishScalar* a_position_z = m_fish.mv_position_z.data();
+	const FishScalar* a_velocity_x = m_fish.mv_velocity_x.data();
+	const FishScalar* a_velocity_y = m_fish.mv_velocity_y.data();
+	const FishScalar* a_velocity_z = m_fish.mv_velocity_z.data();
+	const FishScalar* a_forward_x  = m_fish.mv_forward_x.data();
+	const FishScalar* a_forward_y  = m_fish.mv_forward_y.data();
+	const FishScalar* a_forward_z  = m_fish.mv_forward_z.data();
+
+	Vector3 position_sum(0.0, 0.0, 0.0);
+	Vector3 heading_sum(0.0, 0.0, 0.0);
+	Vector3 box_min(a_position_x[0], a_position_y[0], a_position_z[0]);
+	Vector3 box_max = box_min;
+	double max_distance_squared = 0.0;
+	double speed_sum = 0.0;
+	double speed_min = 1.0e40;
+	double speed_max = 0.0;
+
+	for(unsigned int i = 0; i < fish_count; i++)
+	{
+		double x = a_position_x[i];
+		double y = a_position_y[i];
+		double z = a_position_z[i];
+		position_sum.x += x;
+		position_sum.y += y;
+		position_sum.z += z;
+		if(x < box_min.x) box_min.x = x;
+		if(y < box_min.y) box_min.y = y;
+		if(z < box_min.z) box_min.z = z;
+		if(x > box_max.x) box_max.x = x;
+		if(y > box_max.y) box_max.y = y;
+		if(z > box_max.z) box_max.z = z;
+
+		double dx = x - previous_centroid.x;
+		double dy = y - previous_centroid.y;
+		double dz = z - previous_centroid.z;
+		double distance_squared = dx * dx + dy * dy + dz * dz;
+		if(distance_squared > max_distance_squared)
+			max_distance_squared = distance_squared;
+
+		double vx = a_velocity_x[i];
+		double vy = a_velocity_y[i];
+		double vz = a_velocity_z[i];
+		double speed = sqrt(vx * vx + vy * vy + vz * vz);
+		speed_sum += speed;
+		if(speed < speed_min) speed_min = speed;
+		if(speed > speed_max) speed_max = speed;
+
+		heading_sum.x += a_forward_x[i];
+		heading_sum.y += a_forward_y[i];
+		heading_sum.z += a_forward_z[i];
+	}
+
+	Vector3 centroid = position_sum / fish_count;
+	double fish_radius = Fish::getSpeciesRadius(m_species);
+
+	// sphere about the previous centroid, moved to the new one
+	double radius = sqrt(max_distance_squared) + centroid.getDistance(previous_centroid);
+
+	// the farthest corner of the box is never closer than the farthest fish
+	Vector3 to_corner(max(centroid.x - box_min.x, box_max.x - centroid.x),
+	                  max(centroid.y - box_min.y, box_max.y - centroid.y),
+	                  max(centroid.z - box_min.z, box_max.z - centroid.z));
+	double corner_distance = to_corner.getNorm();
+	if(corner_distance < radius)
+		radius = corner_distance;
+
+	r_agg.m_position_sum = position_sum;
+	r_agg.m_centroid     = centroid;
+	r_agg.m_radius       = radius + fish_radius;
+	r_agg.m_box_min      = box_min - Vector3(fish_radius, fish_radius, fish_radius);
+	r_agg.m_box_max      = box_max + Vector3(fish_radius, fish_radius, fish_radius);
+	r_agg.m_heading_sum  = heading_sum;
+	r_agg.m_mean_heading = heading_sum.isZero() ? Vector3::ZERO : heading_sum.getNormalized();
+	r_agg.m_speed_sum    = speed_sum;
+	r_agg.m_speed_min    = speed_min;
+	r_agg.m_speed_max    = speed_max;
+	r_agg.m_speed_mean   = speed_sum / fish_count;
+
+	setPosition(r_agg.m_centroid);
+	setRadius(r_agg.m_radius);
 
 	assert(isInvariantTrue());
 }
 
 
 
+void FishSchool :: removeFromAggregates (unsigned int index)
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	SchoolAggregates& r_agg = m_aggregates;
+	assert(r_agg.m_count > 0);
+	r_agg.m_count--;
+	if(r_agg.m_count == 0)
+	{
+		r_agg.m_position_sum = Vector3::ZERO;
+		r_agg.m_heading_sum  = Vector3::ZERO;
+		r_agg.m_mean_heading = Vector3::ZERO;
+		r_agg.m_speed_sum    = 0.0;
+		r_agg.m_speed_mean   = 0.0;
+		return;
+	}
+
+	Vector3 velocity = m_fish.getVelocity(index);
+	Vector3 previous_centroid = r_agg.m_centroid;
+
+	r_agg.m_position_sum -= m_fish.getPosition(index);
+	r_agg.m_centroid      = r_agg.m_position_sum / r_agg.m_count;
+	r_agg.m_radius       += r_agg.m_centroid.getDistance(previous_centroid);
+
+	r_agg.m_heading_sum  -= m_fish.getForward(index);
+	r_agg.m_mean_heading  = r_agg.m_heading_sum.isZero() ? Vector3::ZERO : r_agg.m_heading_sum.getNormalized();
+
+	r_agg.m_speed_sum    -= velocity.getNorm();
+	r_agg.m_speed_mean    = r_agg.m_speed_sum / r_agg.m_count;
+
+	setPosition(r_agg.m_centroid);
+	setRadius(r_agg.m_radius);
+}
+
 bool FishSchool :: isInvariantTrue () const
 {
 	if(m_species >= Fish::SPECIES_COUNT)
 		return false;
+	if(m_aggregates.m_count != m_fish.getCount())
+		return false;
 	return true;
 }
 
 
-Fish& FishSchool::getFish(unsigned int index)
+Fish FishSchool :: getFish (unsigned int index) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	Fish fish(m_fish.getPosition(index),
+	          m_fish.getForward(index).getNormalized(),
+	          m_species);
+	fish.setVelocity(m_fish.getVelocity(index));
+	for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+		fish.fishNeighbour[n] = m_fish.getNeighbour(index, n);
+	return fish;
+}
+
+unsigned int FishSchool :: getFishId (unsigned int index) const
+{
+	assert(isInvariantTrue());
+	assert(index < getCount());
+
+	return m_fish.getId(index);
+}
+
+unsigned int FishSchool :: findFish (unsigned int fish_id) const
 {
-	return mv_fish[index];
+	assert(isInvariantTrue());
+
+	return m_fish.findId(fish_id);
 }
 
 void FishSchool::AIUpdateFlockLeader(float delta_time) {
@@ -287,7 +502,7 @@ void FishSchool::AIUpdateFlockLeader(float delta_time) {
 	if (horizontal_distance < newDistance) {
 	
 		// get a new target make a function to do that and update current target
-		Vector3 chosen = this->getPosition() + Vector3::getRandomSphereVector() * this->getRadius();
+		Vector3 chosen = this->getPosition() + m_random.getSphereVector() * this->getRadius();
 
 		this->current_explore_target = chosen;
 
@@ -309,275 +524,94 @@ void FishSchool::AIUpdateFlockLeader(float delta_time) {
 	Vector3 newVelocity = flock_leader.getVelocity() + S;
 
 	flock_leader.setVelocity(newVelocity);
-
-	AIUpdateFishSchool(delta_time);
 	
 
 }
 
 
 
-
-void FishSchool::drawLine()
+void FishSchool :: calculateNearestNeighbour ()
 {
-	//cout << "called";
-	Vector3 leaderPosition = flock_leader.getPosition();
-	Vector3 current_explore_target = this->current_explore_target;
-	//cout << "this is leader position  :" << leaderPosition << " this is currentn explore target :" << this->current_explore_target;
-	
-	glColor3d(1.0, 0.0, 0.0);
-	glPushMatrix();
-	glBegin(GL_LINES);
-	
-	glVertex3d(leaderPosition.x,leaderPosition.y,leaderPosition.z);
-	glVertex3d(current_explore_target.x,current_explore_target.y,current_explore_target.z);
-	
-	glEnd();
-	glPopMatrix();
-
-	glColor3d(1.0, 1.0, 0.0);
-	glPushMatrix();
-	glTranslated(leaderPosition.x, leaderPosition.y, leaderPosition.z);
-	glutWireSphere(0.1, 10, 10);
-	glEnd();
-	glPopMatrix();
-
-	glColor3d(1.0, 0.0, 1.0);
-	glPushMatrix();
-	glTranslated(current_explore_target.x, current_explore_target.y, current_explore_target.z);
-	glutWireSphere(0.1, 10, 10);
-	glEnd();
-	glPopMatrix();
-
-}
-
+	assert(isInvariantTrue());
 
-void FishSchool::calculateNearestNeighbour() {
-	
-	if (mv_fish.size() == 0) {
+	unsigned int fish_count = m_fish.getCount();
+	if(fish_count == 0)
 		return;
-	}
-
-	
-	unsigned int fishSchoolSize = this->getCount();
-	
-	double tempArray[4];
-	unsigned int neighbourArray[4];
-
-	for (int i = 0; i < 4; i++) {
-		tempArray[i] = 1000.0;
-		neighbourArray[i] = 0;
-	}
-
-	
-
-	for (int i = counter; i < fishSchoolSize; i+=60) {
-
-		Vector3 fishPosition = mv_fish[i].getPosition();
-
-		for (int k = 0; k < fishSchoolSize; k++) {
-			if (k == i) {
-				continue;
-			}
-			else {
-				Vector3 fishPosition2 = mv_fish[k].getPosition();
-
-				double distance = fishPosition.getDistanceXY(fishPosition2);
-
-				for (int j = 0; j < 4; j++) {
 
-					if (distance < tempArray[j]) {
-						tempArray[j] = distance;
-						neighbourArray[j] = k;
-						
-						break;
-					}
-				}
-			}
-			
-		}
-
-		for (int j = 0; j < 4; j++) {
-			mv_fish[i].fishNeighbour[j] = neighbourArray[j];
-		}
+	mv_neighbour_positions.resize(fish_count);
+	for(unsigned int i = 0; i < fish_count; i++)
+		mv_neighbour_positions[i] = m_fish.getPosition(i);
+	m_neighbour_grid.rebuild(mv_neighbour_positions);
 
-		
-	}
-	counter++;
-	if (counter >= 60) {
-		counter = 0;
+	for(unsigned int i = 0; i < fish_count; i++)
+	{
+		unsigned int* a_neighbours = &m_fish.mv_neighbours[i * Fish::NEIGHBOUR_COUNT];
+		unsigned int found = m_neighbour_grid.findNearest(mv_neighbour_positions[i], i,
+		                                                  Fish::NEIGHBOUR_COUNT,
+		                                                  a_neighbours);
+		for(unsigned int n = found; n < Fish::NEIGHBOUR_COUNT; n++)
+			a_neighbours[n] = Fish::NO_NEIGHBOUR;
 	}
 
+	assert(isInvariantTrue());
 }
 
-void FishSchool::drawLinesToNeighbour() {
+void FishSchool :: calculateNearestNeighbourBruteForce ()
+{
+	assert(isInvariantTrue());
 
-	if (this->getCount() == 0) {
-		return;
-	}
+	unsigned int fish_count = m_fish.getCount();
+	for(unsigned int i = 0; i < fish_count; i++)
+	{
+		unsigned int* a_neighbours = &m_fish.mv_neighbours[i * Fish::NEIGHBOUR_COUNT];
+		Vector3 position = m_fish.getPosition(i);
 
-	unsigned int fishIndex = 0;
+		double a_distance_squared[Fish::NEIGHBOUR_COUNT];
+		unsigned int found = 0;
 
-	
-	Vector3 fishPosition1 = mv_fish[0].getPosition();
-	
-	for (int i = 0; i < 4; i++) {
-		
-		unsigned int fish2Index = mv_fish[0].fishNeighbour[i];
-		if (fish2Index  < this->getCount())
+		for(unsigned int k = 0; k < fish_count; k++)
 		{
-			
-			Vector3 fishPosition2 = mv_fish[fish2Index].getPosition();
-			/*cout << "fish index 2: " << fish2Index;*/
-			//cout << "this is pos1 :" << fishPosition1 << " this is pos 2: " << fishPosition2;
-			glColor3d(0.0, 0.0, 0.0);
-			glPushMatrix();
-			glBegin(GL_LINES);
-
-			glVertex3d(fishPosition1.x, fishPosition1.y, fishPosition1.z);
-			glVertex3d(fishPosition2.x, fishPosition2.y, fishPosition2.z);
-
-			glEnd();
-			glPopMatrix();
-
-		}
-
-
-		glColor3d(0.0, 1.0, 1.0);
-		glPushMatrix();
-		glBegin(GL_LINES);
+			if(k == i)
+				continue;
 
-		glVertex3d(fishPosition1.x, fishPosition1.y, fishPosition1.z);
-		glVertex3d(flock_leader.getPosition().x,flock_leader.getPosition().y,flock_leader.getPosition().z);
+			double distance_squared = position.getDistanceSquared(m_fish.getPosition(k));
+			if(found == Fish::NEIGHBOUR_COUNT &&
+			   distance_squared >= a_distance_squared[Fish::NEIGHBOUR_COUNT - 1])
+				continue;
 
-		glEnd();
-		glPopMatrix(); 
+			// insertion sort into the nearest list
+			unsigned int slot = (found < Fish::NEIGHBOUR_COUNT) ? found : Fish::NEIGHBOUR_COUNT - 1;
+			while(slot > 0 && a_distance_squared[slot - 1] > distance_squared)
+			{
+				a_distance_squared[slot] = a_distance_squared[slot - 1];
+				a_neighbours[slot]       = a_neighbours[slot - 1];
+				slot--;
+			}
+			a_distance_squared[slot] = distance_squared;
+			a_neighbours[slot]       = k;
+			if(found < Fish::NEIGHBOUR_COUNT)
+				found++;
 		}
-		
-
-}
-
-
-Vector3 FishSchool::getDesiredVelocityForFish(unsigned int i) {
-
-	Vector3 leaderPosition = flock_leader.getPosition();
-
-	
-	unsigned int m_species = this->getSpecies();
-	double max_speed = Fish::getSpeed(m_species);
-
-	Vector3 R =  leaderPosition - mv_fish[i].getPosition();
-
-	Vector3 D = R.getTruncated(max_speed);
-	return D;
-}
-
-void FishSchool::AIUpdateForFish(float delta_time, unsigned int i) {
-
-	unsigned int m_species = this->getSpecies();
-	double max_acc = Fish::getMaxAccleration(m_species);
-	double max_speed = Fish::getSpeed(m_species);
-
-	Vector3 steering_force = addSeperationForce(i);
-
-	Vector3 D = getDesiredVelocityForFish(i) + (3.0 * steering_force);
-	D.truncate(max_speed);
-
-	Vector3 S = D - mv_fish[i].getVelocity();
-
-	S.truncate(max_acc * delta_time);
-
-	Vector3 newVelocity = mv_fish[i].getVelocity() + S ;
-
-
-	mv_fish[i].setVelocity(newVelocity);
-
-	changeBoundingSphere();
-
-}
-
-void FishSchool::AIUpdateFishSchool(float delta_time) {
-
-	for (int i = 0; i < mv_fish.size(); i++) {
-
-		AIUpdateForFish(delta_time, i);
 
+		for(unsigned int n = found; n < Fish::NEIGHBOUR_COUNT; n++)
+			a_neighbours[n] = Fish::NO_NEIGHBOUR;
 	}
 
+	assert(isInvariantTrue());
 }
 
 
-Vector3 FishSchool :: calculateSeperationForce(unsigned int fishIndex, unsigned int neighbourIndex) {
+void FishSchool::AIUpdateFishSchool(float delta_time) {
 
 	unsigned int m_species = this->getSpecies();
+	double max_acc = Fish::getMaxAccleration(m_species);
 	double max_speed = Fish::getSpeed(m_species);
-	
-	Vector3 fishPosition1 = mv_fish[fishIndex].getPosition();
-	Vector3 fishPosition2 = mv_fish[neighbourIndex].getPosition();
-
-	double distance = fishPosition1.getDistance(fishPosition2);
-
-	
-	double maximum_seperation_distance = mv_fish[fishIndex].getRadius() * 4.0;
-
-	if (distance > maximum_explore_distance) {
-		Vector3 seperation_force (0.0, 0.0, 0.0);
-		return seperation_force;
-	}
-
-	Vector3 difference = fishPosition1 - fishPosition2;
-	difference.getNormalizedSafe();
+	double maximum_seperation_distance = Fish::getSpeciesRadius(m_species) * 4.0;
 
-	double closeness = 1.0 - (distance / maximum_seperation_distance);
+	FishKernels::steerAll(m_fish, flock_leader.getPosition(),
+	                      max_speed, max_acc,
+	                      maximum_seperation_distance, maximum_explore_distance,
+	                      delta_time);
 
-	double magnitude = closeness * closeness * max_speed;
-
-	return (difference * magnitude); // seperation force
-}
-
-Vector3 FishSchool::addSeperationForce(unsigned int fishIndex) {
-
-	Vector3 seperationForce(0.0, 0.0, 0.0);
-
-	for (int i = 0; i < 4; i++) {
-		unsigned int neighbourIndex = mv_fish[fishIndex].fishNeighbour[i];
-		if (neighbourIndex < this->getCount()) {
-			
-			Vector3 tempSeperationForce = calculateSeperationForce(fishIndex, neighbourIndex);
-
-			seperationForce += tempSeperationForce;
-		}
-
-	}
-
-	//cout << seperationForce;
-
-	return seperationForce;
 }
 
-
-void FishSchool::changeBoundingSphere()
-{
-	Vector3 position(0.0, 0.0, 0.0);
-
-	for (int i = 0; i < mv_fish.size(); i++) {
-		Vector3 fishPosition = mv_fish[i].getPosition();
-
-		position += fishPosition;
-	}
-
-	position = position / mv_fish.size();
-	this->setPosition(position);
-	
-	double max_distance = 0;
-
-	for (int i = 0; i < mv_fish.size(); i++) {
-		double distance = position.getDistance(mv_fish[i].getPosition());
-
-		if (distance > max_distance) {
-			max_distance = distance;
-		}
-	}
-
-	this->setRadius(max_distance);
-}
\ No newline at end of file
@@ -12,6 +12,10 @@
 
 #include "Entity.h"
 #include "Fish.h"
+#include "FishArrays.h"
+#include "RandomStream.h"
+#include "SchoolAggregates.h"
+#include "SpatialHashGrid.h"
 
 class Terrain;
 class FixedEntity;
@@ -21,9 +25,12 @@ class FixedEntity;
 //  FishSchool
 //
 //  A class to represent a school of fish.
+//  The position and radius of a FishSchool are those of the
+//    bounding sphere in its aggregates.
 //
 //  Class Invariant:
 //    <1> m_species < Fish::SPECIES_COUNT
+//    <2> m_aggregates.m_count == m_fish.getCount()
 //
 class FishSchool : public Entity
 {
@@ -51,21 +58,27 @@ public:
 //    <2> school_radius: The radius of the school
 //    <3> fish_count: The number of fish in the school
 //    <4> fish_species: The fish species
+//    <5> maximum_explore_area: How far the flock leader may
+//                              wander from school_center
+//    <6> random: The random number stream for this school
 //  Precondition(s):
-//    <1> Fish::isModelsLoaded()
-//    <2> school_radius > 0.0
-//    <3> fish_species < Fish::SPECIES_COUNT
+//    <1> school_radius > 0.0
+//    <2> fish_species < Fish::SPECIES_COUNT
 //  Returns: N/A
 //  Side Effect: A FishSchool is constructed at position
 //               school_center, containing fish_count fish of
 //               species fish_species in a sphere of radius
-//               school_radius.
+//               school_radius.  All random choices for the
+//               school, including the starting fish positions,
+//               are taken from a copy of random, so the school
+//               does not depend on rand() or on other schools.
 //
 	FishSchool (const ObjLibrary::Vector3& school_center,
 	            double school_radius,
 	            unsigned int fish_count,
 	            unsigned int fish_species,
-		double maximum_explore_area);
+		double maximum_explore_area,
+	            const RandomStream& random);
 
 //
 //  getSpecies
@@ -91,6 +104,20 @@ public:
 //
 	unsigned int getCount () const;
 
+//
+//  getAggregates
+//
+//  Purpose: To retrieve the summary values for the fish in
+//           this FishSchool.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The aggregates calculated by the last call to
+//           updateAggregates, adjusted for any fish removed
+//           since then.
+//  Side Effect: N/A
+//
+	const SchoolAggregates& getAggregates () const;
+
 //
 //  draw
 //
@@ -102,6 +129,60 @@ public:
 //
 	void draw () const;
 
+//
+//  appendInstanceMatrices
+//
+//  Purpose: To add the model matrices for displaying the fish
+//           in this FishSchool to a list.
+//  Parameter(s):
+//    <1> r_matrices: The list to add to
+//    <2> alpha: How far to display the fish between the
+//               previous and current updates
+//  Precondition(s):
+//    <1> alpha >= 0.0f
+//    <2> alpha <= 1.0f
+//  Returns: N/A
+//  Side Effect: FishKernels::MATRIX_SIZE floats are appended to
+//               r_matrices for each fish, as calculated by
+//               FishKernels::packInstanceMatricesAll with the
+//               species radius as the scale.
+//
+	void appendInstanceMatrices (std::vector<float>& r_matrices,
+	                             float alpha) const;
+
+//
+//  storePreviousState
+//
+//  Purpose: To remember the current state of this FishSchool
+//           so that it can be displayed between this update
+//           and the next one.  This function should be called
+//           once per tick, before anything moves.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The current position and forward vector of
+//               every fish and the current flock leader
+//               position are saved as the previous state.
+//
+	void storePreviousState ();
+
+//
+//  getLeaderRenderPosition
+//
+//  Purpose: To determine where to display the flock leader.
+//  Parameter(s):
+//    <1> alpha: How far to display the flock leader between
+//               the previous and current updates
+//  Precondition(s):
+//    <1> alpha >= 0.0f
+//    <2> alpha <= 1.0f
+//  Returns: The flock leader position blended linearly from
+//           the one saved by storePreviousState to the current
+//           one.
+//  Side Effect: N/A
+//
+	ObjLibrary::Vector3 getLeaderRenderPosition (float alpha) const;
+
 //
 //  drawAllCoordinateSystems
 //
@@ -185,14 +266,16 @@ public:
 //
 //  Purpose: To handle collisions between all fish in this
 //           FishSchool and the specified Terrain.
-//            Heirarchical collision checking is NOT used.
 //  Parameter(s):
 //    <1> terrain: The Terrain to check for collisions
 //  Precondition(s): N/A
 //  Returns: N/A
 //  Side Effect: Each fish in this FishSchool is checked for a
 //               collision with terrain.  Each fish that
-//               collides with terrain bounces off it.
+//               collides with terrain bounces off it.  The
+//               terrain heights for all the fish are found with
+//               one batched call, and the surface normals for
+//               the colliding fish with another.
 //
 	void checkCollisionAll (const Terrain& terrain);
 
@@ -225,7 +308,8 @@ public:
 //  Side Effect: This FishSchool is checked for a collision with
 //               player.  If there is one, each fish in this
 //               FishSchool is also checked for a collision.
-//               Each fish that collides with player is removed.
+//               Each fish that collides with player is removed
+//               and the aggregates are adjusted to match.
 //
 	unsigned int checkPlayerCaughtFish (const Entity& player);
 
@@ -243,8 +327,73 @@ public:
 //
 	void updateOrientationAll ();
 
+//
+//  updateAggregates
+//
+//  Purpose: To recalculate the summary values for the fish in
+//           this FishSchool.  This function should be called
+//           once per tick, after the fish have moved.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The centroid, bounding sphere, bounding box,
+//               mean heading, and speed statistics are
+//               calculated in a single pass over the fish.  The
+//               bounding sphere radius is measured from the
+//               previous centroid and then increased by how far
+//               the centroid moved, so it is slightly larger
+//               than the tightest sphere about the centroid.
+//               This FishSchool is moved to the new centroid
+//               and its radius set to the bounding sphere
+//               radius.
+//
+	void updateAggregates ();
+
 
-	Fish& getFish(unsigned int index);
+//
+//  getFish
+//
+//  Purpose: To retrieve a copy of the specified fish.
+//  Parameter(s):
+//    <1> index: Which fish
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: A Fish with the position, orientation, velocity,
+//           and neighbours of fish index.  The fish in this
+//           FishSchool are stored as arrays, so changing the
+//           returned Fish has no effect on this FishSchool.
+//  Side Effect: N/A
+//
+	Fish getFish (unsigned int index) const;
+
+//
+//  getFishId
+//
+//  Purpose: To retrieve the id of the specified fish.  Unlike
+//           its index, the id of a fish does not change when
+//           other fish are caught.
+//  Parameter(s):
+//    <1> index: Which fish
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: The id of fish index.
+//  Side Effect: N/A
+//
+	unsigned int getFishId (unsigned int index) const;
+
+//
+//  findFish
+//
+//  Purpose: To determine the current index of the fish with
+//           the specified id.
+//  Parameter(s):
+//    <1> fish_id: The id of the fish
+//  Precondition(s): N/A
+//  Returns: The index of the fish, or FishArrays::NO_FISH if
+//           it has been caught.
+//  Side Effect: N/A
+//
+	unsigned int findFish (unsigned int fish_id) const;
 
 	ObjLibrary::Vector3 explore_area_center;
 	double maximum_explore_distance;
@@ -253,28 +402,83 @@ public:
 	ObjLibrary::Vector3 current_explore_target; 
 
 	void AIUpdateFlockLeader(float delta_time);
-	void drawLine();
+	void drawLine(float alpha);
 
+//
+//  calculateNearestNeighbour
+//
+//  Purpose: To find the nearest neighbours of every fish in
+//           this FishSchool.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The spatial hash grid for this FishSchool is
+//               rebuilt from the current fish positions.  Then
+//               the neighbours of every fish are set to the
+//               indexes of the Fish::NEIGHBOUR_COUNT nearest
+//               other fish, using 3D distance.  Unused slots
+//               are set to Fish::NO_NEIGHBOUR.  This takes
+//               close to O(N) time.
+//
 	void calculateNearestNeighbour();
 
-	ObjLibrary::DisplayList m_line_list;
+//
+//  calculateNearestNeighbourBruteForce
+//
+//  Purpose: To find the nearest neighbours of every fish in
+//           this FishSchool by checking every pair of fish.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The neighbours are set the same way as by
+//               calculateNearestNeighbour, but in O(N^2) time.
+//               This function is intended as a reference for
+//               testing and benchmarking.
+//
+	void calculateNearestNeighbourBruteForce();
 
 	void drawLinesToNeighbour();
 	void updateFishAI();
-	unsigned int counter;
-	ObjLibrary::Vector3 getDesiredVelocityForFish(unsigned int i);
-
-	void AIUpdateForFish(float delta_time, unsigned int i);
 
+//
+//  AIUpdateFishSchool
+//
+//  Purpose: To steer every fish in this FishSchool towards the
+//           flock leader while keeping it away from its
+//           neighbours.
+//  Parameter(s):
+//    <1> delta_time: The duration of the update
+//  Precondition(s):
+//    <1> delta_time >= 0.0
+//  Returns: N/A
+//  Side Effect: The velocity of each fish is updated using
+//               FishKernels::steerAll.  The neighbours must
+//               have been calculated since the fish last moved.
+//
 	void AIUpdateFishSchool(float delta_time);
 
-	ObjLibrary::Vector3 calculateSeperationForce(unsigned int fishIndex, unsigned int neighbourIndex);
-
-	ObjLibrary ::Vector3 addSeperationForce(unsigned int fishIndex);
-
-	void changeBoundingSphere();
-
 private:
+//
+//  removeFromAggregates
+//
+//  Purpose: To adjust the aggregates for a fish that is about
+//           to be removed.
+//  Parameter(s):
+//    <1> index: Which fish
+//  Precondition(s):
+//    <1> index < getCount()
+//  Returns: N/A
+//  Side Effect: The count, sums, and averages in m_aggregates
+//               are updated to exclude fish index.  The bounding
+//               sphere radius is increased by how far the
+//               centroid moved, and the bounding box and speed
+//               limits are left unchanged, so they remain
+//               conservative.  This FishSchool is moved to the
+//               new centroid.  m_aggregates.m_count will be one
+//               less than getCount() until the fish is removed.
+//
+	void removeFromAggregates (unsigned int index);
+
 //
 //  isInvariantTrue
 //
@@ -290,7 +494,21 @@ private:
 
 private:
 	unsigned int m_species;
-	std::vector<Fish> mv_fish;
+	FishArrays m_fish;
+	SchoolAggregates m_aggregates;
+	RandomStream m_random;
+	SpatialHashGrid m_neighbour_grid;
+	std::vector<ObjLibrary::Vector3> mv_neighbour_positions;
+	ObjLibrary::Vector3 m_previous_leader_position;
+
+	// scratch space for checkCollisionAll(Terrain)
+	std::vector<FishScalar> mv_terrain_heights;
+	std::vector<unsigned int> mv_terrain_hits;
+	std::vector<FishScalar> mv_terrain_hit_x;
+	std::vector<FishScalar> mv_terrain_hit_z;
+	std::vector<FishScalar> mv_terrain_normal_x;
+	std::vector<FishScalar> mv_terrain_normal_y;
+	std::vector<FishScalar> mv_terrain_normal_z;
 };
 
 
@@ -0,0 +1,149 @@
+//
+//  FishSchoolDraw.cpp
+//
+//  The FishSchool functions that draw with OpenGL.
+//
+
+#include "FishSchool.h"
+
+#include <cassert>
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/Vector3.h"
+
+#include "Fish.h"
+
+using namespace ObjLibrary;
+
+
+
+void FishSchool :: draw () const
+{
+	assert(isInvariantTrue());
+
+	for(unsigned int i = 0; i < m_fish.getCount(); i++)
+		getFish(i).draw();
+}
+
+void FishSchool :: drawAllCoordinateSystems (double length) const
+{
+	assert(isInvariantTrue());
+	assert(length > 0.0);
+
+	for(unsigned int i = 0; i < m_fish.getCount(); i++)
+	{
+		glPushMatrix();
+			getFish(i).applyDrawTransformations();
+			glBegin(GL_LINES);
+				glColor3d(1.0, 0.0, 0.0);
+				glVertex3d(0.0, 0.0, 0.0);
+				glVertex3d(length, 0.0, 0.0);
+				glColor3d(0.0, 1.0, 0.0);
+				glVertex3d(0.0, 0.0, 0.0);
+				glVertex3d(0.0, length, 0.0);
+				glColor3d(0.0, 0.0, 1.0);
+				glVertex3d(0.0, 0.0, 0.0);
+				glVertex3d(0.0, 0.0, length);
+			glEnd();
+		glPopMatrix();
+	}
+}
+
+void FishSchool :: drawAllCollisionSpheres () const
+{
+	assert(isInvariantTrue());
+
+	double radius = Fish::getSpeciesRadius(m_species);
+	for(unsigned int i = 0; i < m_fish.getCount(); i++)
+	{
+		glPushMatrix();
+			getFish(i).applyDrawTransformations();
+			glScaled(radius, radius, radius);
+			glutWireIcosahedron();
+			//glutWireSphere(1.0, 8, 6);
+		glPopMatrix();
+	}
+}
+
+
+
+void FishSchool::drawLine(float alpha)
+{
+	//cout << "called";
+	Vector3 leaderPosition = getLeaderRenderPosition(alpha);
+	Vector3 current_explore_target = this->current_explore_target;
+	//cout << "this is leader position  :" << leaderPosition << " this is currentn explore target :" << this->current_explore_target;
+	
+	glColor3d(1.0, 0.0, 0.0);
+	glPushMatrix();
+	glBegin(GL_LINES);
+	
+	glVertex3d(leaderPosition.x,leaderPosition.y,leaderPosition.z);
+	glVertex3d(current_explore_target.x,current_explore_target.y,current_explore_target.z);
+	
+	glEnd();
+	glPopMatrix();
+
+	glColor3d(1.0, 1.0, 0.0);
+	glPushMatrix();
+	glTranslated(leaderPosition.x, leaderPosition.y, leaderPosition.z);
+	glutWireSphere(0.1, 10, 10);
+	glEnd();
+	glPopMatrix();
+
+	glColor3d(1.0, 0.0, 1.0);
+	glPushMatrix();
+	glTranslated(current_explore_target.x, current_explore_target.y, current_explore_target.z);
+	glutWireSphere(0.1, 10, 10);
+	glEnd();
+	glPopMatrix();
+
+}
+
+void FishSchool::drawLinesToNeighbour() {
+
+	if (this->getCount() == 0) {
+		return;
+	}
+
+	unsigned int fishIndex = 0;
+
+	
+	Vector3 fishPosition1 = m_fish.getPosition(0);
+	
+	for (int i = 0; i < Fish::NEIGHBOUR_COUNT; i++) {
+		
+		unsigned int fish2Index = m_fish.getNeighbour(0, i);
+		if (fish2Index  < this->getCount())
+		{
+			
+			Vector3 fishPosition2 = m_fish.getPosition(fish2Index);
+			/*cout << "fish index 2: " << fish2Index;*/
+			//cout << "this is pos1 :" << fishPosition1 << " this is pos 2: " << fishPosition2;
+			glColor3d(0.0, 0.0, 0.0);
+			glPushMatrix();
+			glBegin(GL_LINES);
+
+			glVertex3d(fishPosition1.x, fishPosition1.y, fishPosition1.z);
+			glVertex3d(fishPosition2.x, fishPosition2.y, fishPosition2.z);
+
+			glEnd();
+			glPopMatrix();
+
+		}
+
+
+		glColor3d(0.0, 1.0, 1.0);
+		glPushMatrix();
+		glBegin(GL_LINES);
+
+		glVertex3d(fishPosition1.x, fishPosition1.y, fishPosition1.z);
+		glVertex3d(flock_leader.getPosition().x,flock_leader.getPosition().y,flock_leader.getPosition().z);
+
+		glEnd();
+		glPopMatrix(); 
+		}
+		
+
+}
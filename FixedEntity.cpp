@@ -6,26 +6,23 @@
 
 #include <cassert>
 #include <cmath>
-
-#include "GetGlut.h"
+#include <vector>
 
 #include "ObjLibrary/Vector3.h"
 #include "ObjLibrary/DisplayList.h"
 
+#include "RandomStream.h"
 #include "SurfaceNormal.h"
 
 using namespace std;
 using namespace ObjLibrary;
-namespace
-{
-	const double NORMAL_LENGTH = 0.5;
-}
 
 
 
 FixedEntity :: FixedEntity ()
 		: Entity(),
-		// m_display_list will be initialized by its own default constructor
+		// mv_lod_lists will be initialized by its own default constructor
+		// mv_lod_switch_distances will be initialized by its own default constructor
 		// m_normals_list will be initialized by its own default constructor
 		  m_is_sphere(true)
 		// m_end1 will be initialized by its own default constructor
@@ -35,40 +32,36 @@ FixedEntity :: FixedEntity ()
 }
 
 FixedEntity :: FixedEntity (const ObjLibrary::Vector3& center,
-                            double radius,
-                            const ObjLibrary::DisplayList& display_list)
+                            double radius)
 		: Entity(center, radius),
-		  m_display_list(display_list),
-		// m_normals_list will be initialized by initNormalsList
+		// mv_lod_lists will be initialized by its own default constructor
+		// mv_lod_switch_distances will be initialized by its own default constructor
+		// m_normals_list will be initialized by its own default constructor
 		  m_is_sphere(true)
 		// m_end1 will be initialized by its own default constructor
 		// m_end2 will be initialized by its own default constructor
 {
 	assert(radius >= 0.0);
-	assert(display_list.isReady());
-
-	initSurfaceNormalsList();
 
+	assert(!isDrawable());
 	assert(isInvariantTrue());
 }
 
 FixedEntity :: FixedEntity (const ObjLibrary::Vector3& end1,
                             const ObjLibrary::Vector3& end2,
-                            double radius,
-                            const ObjLibrary::DisplayList& display_list)
+                            double radius)
 		: Entity((end1 + end2) * 0.5, radius),
-		  m_display_list(display_list),
-		// m_normals_list will be initialized by initNormalsList
+		// mv_lod_lists will be initialized by its own default constructor
+		// mv_lod_switch_distances will be initialized by its own default constructor
+		// m_normals_list will be initialized by its own default constructor
 		  m_is_sphere(false),
 		  m_end1(end1),
 		  m_end2(end2)
 {
 	assert(end1 != end2);
 	assert(radius >= 0.0);
-	assert(display_list.isReady());
-
-	initSurfaceNormalsList();
 
+	assert(!isDrawable());
 	assert(isInvariantTrue());
 }
 
@@ -132,83 +125,55 @@ ObjLibrary::Vector3 FixedEntity :: getSurfaceNormal (const ObjLibrary::Vector3&
 		return getSurfaceNormalOrientedCylinder(query_pos, getEnd1(), getEnd2());
 }
 
+double FixedEntity :: getBoundingRadius () const
+{
+	if(isSphere())
+		return getRadius();
+
+	double half_length = getLength() * 0.5;
+	double radius      = getRadius();
+	return sqrt(half_length * half_length + radius * radius);
+}
+
 bool FixedEntity :: isDrawable () const
 {
 	assert(isInvariantTrue());
 
-	assert(m_display_list.isReady() == m_surface_normals_list.isReady());
-	return m_display_list.isReady();
+	assert(mv_lod_lists.empty() != m_surface_normals_list.isReady());
+	return !mv_lod_lists.empty();
 }
 
-void FixedEntity :: draw () const
+unsigned int FixedEntity :: getLodCount () const
 {
 	assert(isInvariantTrue());
-	assert(isDrawable());
-
-	static const double RADIANS_TO_DEGREES = 180.0 / 3.1415926535897932384626433832795;
 
-	if(m_display_list.isReady())
-	{
-		Vector3 center = getPosition();
-		double  radius = getRadius();
-
-		if(isSphere())
-		{
-			glPushMatrix();
-				glTranslated(center.x, center.y, center.z);
-				glScaled(radius, radius, radius);
-				m_display_list.draw();
-			glPopMatrix();
-		}
-		else
-		{
-			Vector3 direction = getDirection();
-			double  length    = getLength();
-
-			assert(!direction.isZero());
-			Vector3 axis = Vector3::UNIT_X_PLUS.crossProduct(direction);
-			axis.normalizeSafe();
-			double radians = Vector3::UNIT_X_PLUS.getAngleSafe(direction);
-			double degrees = radians * RADIANS_TO_DEGREES;
-
-			glPushMatrix();
-				glTranslated(center.x, center.y, center.z);
-				glRotated(degrees, axis.x, axis.y, axis.z);
-				glScaled(length * 0.5, radius, radius);
-				m_display_list.draw();
-			glPopMatrix();
-		}
-	}
+	return mv_lod_lists.size();
 }
 
-void FixedEntity :: drawSurfaceNormals () const
+double FixedEntity :: getLodSwitchDistance (unsigned int lod) const
 {
 	assert(isInvariantTrue());
-	assert(isDrawable());
+	assert(lod < getLodCount());
 
-	m_surface_normals_list.draw();
+	return mv_lod_switch_distances[lod];
 }
 
-
-	
-void FixedEntity :: initSurfaceNormalsList ()
+void FixedEntity :: addLod (const ObjLibrary::DisplayList& display_list,
+                            double switch_distance)
 {
-	m_surface_normals_list.begin();
-	glColor3d(1.0, 1.0, 0.0);  // yellow
-		glBegin(GL_LINES);
-			for(unsigned int i = 0; i < 100; i++)
-			{
-				Vector3 query_pos = getRandomSurfacePoint();
-				Vector3 normal    = getSurfaceNormal(query_pos);
-				Vector3 end_at    = query_pos + normal * NORMAL_LENGTH;
-				glVertex3d(query_pos.x, query_pos.y, query_pos.z);
-				glVertex3d(   end_at.x,    end_at.y,    end_at.z);
-			}
-		glEnd();
-	m_surface_normals_list.end();
+	assert(isDrawable());
+	assert(display_list.isReady());
+	assert(switch_distance > getLodSwitchDistance(getLodCount() - 1));
+
+	mv_lod_lists.push_back(display_list);
+	mv_lod_switch_distances.push_back(switch_distance);
+
+	assert(isInvariantTrue());
 }
 
-ObjLibrary::Vector3 FixedEntity :: getRandomSurfacePoint () const
+
+	
+ObjLibrary::Vector3 FixedEntity :: getRandomSurfacePoint (RandomStream& r_random) const
 {
 	static const double RADIANS_TO_DEGREES = 180.0 / 3.1415926535897932384626433832795;
 
@@ -217,7 +182,7 @@ ObjLibrary::Vector3 FixedEntity :: getRandomSurfacePoint () const
 
 	if(isSphere())
 	{
-		Vector3 direction = Vector3::getRandomUnitVector();
+		Vector3 direction = r_random.getUnitVector();
 		return center + direction * radius;
 	}
 	else
@@ -227,9 +192,8 @@ ObjLibrary::Vector3 FixedEntity :: getRandomSurfacePoint () const
 		//return center + direction * radius * 2.0;
 
 		// generate cylinder aligned with the X-axis
-		//  -> for X, we generate 3 random numbers and throw 2 away
-		Vector3 unrotated = Vector3::getRandomUnitVectorYZ() * radius;
-		unrotated.x = getLength() * Vector3::getRandomInRange(-0.5, 0.5).x;
+		Vector3 unrotated = r_random.getUnitVectorYZ() * radius;
+		unrotated.x = getLength() * (r_random.getDouble() - 0.5);
 
 		// calculate rotation values
 		Vector3 cylinder_direction = getDirection();
@@ -247,13 +211,23 @@ ObjLibrary::Vector3 FixedEntity :: getRandomSurfacePoint () const
 
 bool FixedEntity :: isInvariantTrue () const
 {
-	if(m_is_sphere)
-		return true;
+	if(!m_is_sphere)
+	{
+		if(m_end1 == m_end2)
+			return false;
+		if(getPosition() != (m_end1 + m_end2) * 0.5)
+			return false;
+	}
 
-	if(m_end1 == m_end2)
+	if(mv_lod_switch_distances.size() != mv_lod_lists.size())
 		return false;
-	if(getPosition() != (m_end1 + m_end2) * 0.5)
+	if(!mv_lod_switch_distances.empty() && mv_lod_switch_distances[0] != 0.0)
 		return false;
+	for(unsigned int i = 1; i < mv_lod_switch_distances.size(); i++)
+	{
+		if(mv_lod_switch_distances[i - 1] >= mv_lod_switch_distances[i])
+			return false;
+	}
 	return true;
 }
 
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Entity.h"
 
 #include "ObjLibrary/Vector3.h"
@@ -13,6 +15,8 @@
 
 #include "CoordinateSystem.h"
 
+class RandomStream;
+
 
 
 //
@@ -22,9 +26,22 @@
 //    entity that never changes.  An FixedEntity can be a sphere
 //    or an oriented cylinder.
 //
+//  A FixedEntity can be displayed at several levels of detail
+//    (LODs).  Level 0 is the model it was constructed with, and
+//    each further level is a cheaper model used when the camera
+//    is at least that level's switch distance away.  The level
+//    to use is chosen by chooseLod, as described for
+//    LevelOfDetail::chooseLod.
+//
 //  Class Invariant:
 //    <1> m_is_sphere || m_end1 != m_end2
 //    <2> m_is_sphere || getPosition() == (m_end1 + m_end2) * 0.5
+//    <3> mv_lod_switch_distances.size() == mv_lod_lists.size()
+//    <4> mv_lod_switch_distances.empty() ||
+//                            mv_lod_switch_distances[0] == 0.0
+//    <5> mv_lod_switch_distances[i] <
+//                                mv_lod_switch_distances[i + 1]
+//        WHERE 0 <= i < mv_lod_switch_distances.size() - 1
 //
 class FixedEntity : public Entity
 {
@@ -63,6 +80,24 @@ public:
 	             double radius,
 	             const ObjLibrary::DisplayList& display_list);
 
+//
+//  Sphere Constructor
+//
+//  Purpose: To construct an spherical FixedEntity that is only
+//           used for collisions.
+//  Parameter(s):
+//    <1> center: The center of the sphere
+//    <2> radius: The radius of the sphere
+//  Precondition(s):
+//    <1> radius >= 0.0
+//  Returns: N/A
+//  Side Effect: A spherical FixedEntity with radius radius is
+//               constructed at position center.  It will not be
+//               displayed, and no OpenGL functions are called.
+//
+	FixedEntity (const ObjLibrary::Vector3& center,
+	             double radius);
+
 //
 //  Cylinder Constructor
 //
@@ -88,6 +123,28 @@ public:
 	             double radius,
 	             const ObjLibrary::DisplayList& display_list);
 
+//
+//  Cylinder Constructor
+//
+//  Purpose: To construct an cylindrical FixedEntity that is
+//           only used for collisions.
+//  Parameter(s):
+//    <1> end1: The center of one end of the cylinder
+//    <2> end2: The center of the other end of the cylinder
+//    <3> radius: The radius of the cylinder
+//  Precondition(s):
+//    <1> end1 != end2
+//    <2> radius >= 0.0
+//  Returns: N/A
+//  Side Effect: A cylindrical FixedEntity with radius radius is
+//               constructed stretching between positions end1
+//               and end2.  It will not be displayed, and no
+//               OpenGL functions are called.
+//
+	FixedEntity (const ObjLibrary::Vector3& end1,
+	             const ObjLibrary::Vector3& end2,
+	             double radius);
+
 //
 //  isSphere
 //
@@ -184,6 +241,21 @@ public:
 	ObjLibrary::Vector3 getSurfaceNormal (
 	                const ObjLibrary::Vector3& query_pos) const;
 
+//
+//  getBoundingRadius
+//
+//  Purpose: To determine the radius of the smallest sphere
+//           around the position of this FixedEntity that
+//           contains it.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The radius of a sphere centered on getPosition()
+//           that contains this FixedEntity.  For a sphere, this
+//           is the same as getRadius().
+//  Side Effect: N/A
+//
+	double getBoundingRadius () const;
+
 //
 //  isDrawable
 //
@@ -195,6 +267,55 @@ public:
 //
 	bool isDrawable () const;
 
+//
+//  getLodCount
+//
+//  Purpose: To determine how many levels of detail this
+//           FixedEntity has.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of levels of detail.  This is 0 if this
+//           FixedEntity is not drawable.
+//  Side Effect: N/A
+//
+	unsigned int getLodCount () const;
+
+//
+//  getLodSwitchDistance
+//
+//  Purpose: To determine the distance at which the specified
+//           level of detail is used.
+//  Parameter(s):
+//    <1> lod: The level of detail
+//  Precondition(s):
+//    <1> lod < getLodCount()
+//  Returns: The distance from the position of this FixedEntity
+//           beyond which level lod replaces level lod - 1.  For
+//           level 0, this is 0.0.
+//  Side Effect: N/A
+//
+	double getLodSwitchDistance (unsigned int lod) const;
+
+//
+//  chooseLod
+//
+//  Purpose: To determine which level of detail to display this
+//           FixedEntity at.
+//  Parameter(s):
+//    <1> camera_position: The position of the camera
+//    <2> current_lod: The level of detail used last frame
+//  Precondition(s):
+//    <1> isDrawable()
+//    <2> current_lod < getLodCount()
+//  Returns: The level of detail to use.  This is current_lod
+//           unless camera_position is more than
+//           LevelOfDetail::HYSTERESIS past the switch distance
+//           of a coarser or finer level.
+//  Side Effect: N/A
+//
+	unsigned int chooseLod (const ObjLibrary::Vector3& camera_position,
+	                        unsigned int current_lod) const;
+
 //
 //  draw
 //
@@ -203,11 +324,28 @@ public:
 //  Precondition(s):
 //    <1> isDrawable()
 //  Returns: N/A
-//  Side Effect: This FixedEntity is displayed.  If no DisplayList
-//               has been set, there is no effect.
+//  Side Effect: This FixedEntity is displayed at full detail.
+//               If no DisplayList has been set, there is no
+//               effect.
 //
 	void draw () const;
 
+//
+//  draw
+//
+//  Purpose: To display this FixedEntity at the specified level
+//           of detail.
+//  Parameter(s):
+//    <1> lod: The level of detail
+//  Precondition(s):
+//    <1> isDrawable()
+//    <2> lod < getLodCount()
+//  Returns: N/A
+//  Side Effect: This FixedEntity is displayed using the model
+//               for level lod.
+//
+	void draw (unsigned int lod) const;
+
 //
 //  drawSurfaceNormals
 //
@@ -222,6 +360,27 @@ public:
 //
 	void drawSurfaceNormals () const;
 
+//
+//  addLod
+//
+//  Purpose: To add a coarser level of detail to this
+//           FixedEntity.
+//  Parameter(s):
+//    <1> display_list: The DisplayList to use for the new level
+//    <2> switch_distance: The distance beyond which the new
+//                         level is used
+//  Precondition(s):
+//    <1> isDrawable()
+//    <2> display_list.isReady()
+//    <3> switch_distance >
+//                     getLodSwitchDistance(getLodCount() - 1)
+//  Returns: N/A
+//  Side Effect: A level of detail is added after the existing
+//               ones.
+//
+	void addLod (const ObjLibrary::DisplayList& display_list,
+	             double switch_distance);
+
 private:
 //
 //  initSurfaceNormalsList
@@ -242,14 +401,16 @@ private:
 //
 //  Purpose: To calculate a random point on the surface of this
 //           FixedEntity.
-//  Parameter(s): N/A
+//  Parameter(s):
+//    <1> r_random: The random number stream to use
 //  Precondition(s): N/A
 //  Returns: A random position in world coordinates that lies on
 //           the surface of this FoxedEntity.  This function
 //           works for spheres and cylinders.
-//  Side Effect: N/A
+//  Side Effect: r_random is advanced.
 //
-	ObjLibrary::Vector3 getRandomSurfacePoint () const;
+	ObjLibrary::Vector3 getRandomSurfacePoint (
+	                             RandomStream& r_random) const;
 
 //
 //  isInvariantTrue
@@ -266,7 +427,8 @@ private:
 
 private:
 
-	ObjLibrary::DisplayList m_display_list;
+	std::vector<ObjLibrary::DisplayList> mv_lod_lists;  // [0] is full detail
+	std::vector<double> mv_lod_switch_distances;
 	ObjLibrary::DisplayList m_surface_normals_list;
 	bool m_is_sphere;
 	ObjLibrary::Vector3 m_end1;
@@ -0,0 +1,301 @@
+//
+//  FixedEntityBvh.cpp
+//
+
+#include "FixedEntityBvh.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "FixedEntity.h"
+#include "ViewFrustum.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	// a median split halves each range, so the depth is at most
+	//  log2(UINT_MAX / LEAF_SIZE) + 1 and this is never exceeded
+	const unsigned int QUERY_STACK_SIZE = 64;
+
+	double getAxis (const Vector3& v, unsigned int axis)
+	{
+		assert(axis < 3);
+
+		switch(axis)
+		{
+		case 0:  return v.x;
+		case 1:  return v.y;
+		default: return v.z;
+		}
+	}
+
+	Vector3 componentMin (const Vector3& a, const Vector3& b)
+	{
+		return Vector3(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z));
+	}
+
+	Vector3 componentMax (const Vector3& a, const Vector3& b)
+	{
+		return Vector3(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z));
+	}
+
+	//
+	//  isSphereOverlappingBox
+	//
+	//  Purpose: To determine if a sphere intersects an
+	//           axis-aligned box.
+	//  Parameter(s):
+	//    <1> center: The center of the sphere
+	//    <2> radius: The radius of the sphere
+	//    <3> box_min
+	//    <4> box_max: The corners of the box
+	//  Precondition(s): N/A
+	//  Returns: Whether any point in the sphere is in the box.
+	//           Touching counts as intersecting, so that this
+	//           test never rejects a pair that isCollision would
+	//           accept.
+	//  Side Effect: N/A
+	//
+	bool isSphereOverlappingBox (const Vector3& center,
+	                             double radius,
+	                             const Vector3& box_min,
+	                             const Vector3& box_max)
+	{
+		Vector3 closest = componentMax(box_min, componentMin(center, box_max));
+		return center.getDistanceSquared(closest) <= radius * radius;
+	}
+
+}  // end of anonymous namespace
+
+
+
+const unsigned int FixedEntityBvh :: LEAF_SIZE;
+
+
+
+FixedEntityBvh :: FixedEntityBvh ()
+		: mv_nodes(),
+		  mv_entity_indexes(),
+		  mv_box_min(),
+		  mv_box_max()
+{
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned int FixedEntityBvh :: getCount () const
+{
+	assert(isInvariantTrue());
+
+	return mv_entity_indexes.size();
+}
+
+unsigned int FixedEntityBvh :: getNodeCount () const
+{
+	assert(isInvariantTrue());
+
+	return mv_nodes.size();
+}
+
+void FixedEntityBvh :: query (const Vector3& center,
+                              double radius,
+                              std::vector<unsigned int>& r_indexes) const
+{
+	assert(isInvariantTrue());
+	assert(radius >= 0.0);
+
+	r_indexes.clear();
+	if(mv_nodes.empty())
+		return;
+
+	unsigned int a_stack[QUERY_STACK_SIZE];
+	unsigned int stack_size = 0;
+	a_stack[stack_size++] = 0;
+
+	while(stack_size > 0)
+	{
+		const Node& node = mv_nodes[a_stack[--stack_size]];
+		if(!isSphereOverlappingBox(center, radius, node.m_box_min, node.m_box_max))
+			continue;
+
+		if(node.m_leaf_count > 0)
+		{
+			// check each entity in the leaf against its own box
+			for(unsigned int i = 0; i < node.m_leaf_count; i++)
+			{
+				unsigned int entity = mv_entity_indexes[node.m_right_or_first + i];
+				if(isSphereOverlappingBox(center, radius, mv_box_min[entity], mv_box_max[entity]))
+					r_indexes.push_back(entity);
+			}
+		}
+		else
+		{
+			assert(stack_size + 2 <= QUERY_STACK_SIZE);
+			unsigned int node_index = (unsigned int)(&node - &mv_nodes[0]);
+			a_stack[stack_size++] = node.m_right_or_first;
+			a_stack[stack_size++] = node_index + 1;
+		}
+	}
+
+	// callers bounce in the same order as a linear scan would
+	sort(r_indexes.begin(), r_indexes.end());
+}
+
+void FixedEntityBvh :: query (const ViewFrustum& frustum,
+                              std::vector<unsigned int>& r_indexes) const
+{
+	assert(isInvariantTrue());
+
+	r_indexes.clear();
+	if(mv_nodes.empty())
+		return;
+
+	unsigned int a_stack[QUERY_STACK_SIZE];
+	unsigned int stack_size = 0;
+	a_stack[stack_size++] = 0;
+
+	while(stack_size > 0)
+	{
+		const Node& node = mv_nodes[a_stack[--stack_size]];
+		if(!frustum.isBoxVisible(node.m_box_min, node.m_box_max))
+			continue;
+
+		if(node.m_leaf_count > 0)
+		{
+			for(unsigned int i = 0; i < node.m_leaf_count; i++)
+			{
+				unsigned int entity = mv_entity_indexes[node.m_right_or_first + i];
+				if(frustum.isBoxVisible(mv_box_min[entity], mv_box_max[entity]))
+					r_indexes.push_back(entity);
+			}
+		}
+		else
+		{
+			assert(stack_size + 2 <= QUERY_STACK_SIZE);
+			unsigned int node_index = (unsigned int)(&node - &mv_nodes[0]);
+			a_stack[stack_size++] = node.m_right_or_first;
+			a_stack[stack_size++] = node_index + 1;
+		}
+	}
+
+	// draw in file order so the picture does not depend on the tree
+	sort(r_indexes.begin(), r_indexes.end());
+}
+
+void FixedEntityBvh :: build (const std::vector<FixedEntity>& fixed_entities)
+{
+	assert(isInvariantTrue());
+
+	unsigned int count = fixed_entities.size();
+
+	mv_nodes.clear();
+	mv_entity_indexes.resize(count);
+	mv_box_min.resize(count);
+	mv_box_max.resize(count);
+
+	for(unsigned int i = 0; i < count; i++)
+	{
+		const FixedEntity& entity = fixed_entities[i];
+		double radius = entity.getRadius();
+		mv_entity_indexes[i] = i;
+
+		if(entity.isCylinder())
+		{
+			// the caps are discs, so along each axis they extend
+			//  radius * sin(angle to axis) past the end points
+			Vector3 direction = entity.getDirection();
+			Vector3 extent(radius * sqrt(max(0.0, 1.0 - direction.x * direction.x)),
+			               radius * sqrt(max(0.0, 1.0 - direction.y * direction.y)),
+			               radius * sqrt(max(0.0, 1.0 - direction.z * direction.z)));
+			mv_box_min[i] = componentMin(entity.getEnd1(), entity.getEnd2()) - extent;
+			mv_box_max[i] = componentMax(entity.getEnd1(), entity.getEnd2()) + extent;
+		}
+		else
+		{
+			Vector3 extent(radius, radius, radius);
+			mv_box_min[i] = entity.getPosition() - extent;
+			mv_box_max[i] = entity.getPosition() + extent;
+		}
+	}
+
+	if(count > 0)
+		buildNode(0, count);
+
+	assert(isInvariantTrue());
+}
+
+
+
+void FixedEntityBvh :: buildNode (unsigned int begin, unsigned int end)
+{
+	assert(begin < end);
+	assert(end <= mv_entity_indexes.size());
+
+	unsigned int node_index = mv_nodes.size();
+	mv_nodes.push_back(Node());
+
+	// bounds of the boxes and of their centers
+	Vector3 box_min    = mv_box_min[mv_entity_indexes[begin]];
+	Vector3 box_max    = mv_box_max[mv_entity_indexes[begin]];
+	Vector3 center_min = (box_min + box_max) * 0.5;
+	Vector3 center_max = center_min;
+	for(unsigned int i = begin + 1; i < end; i++)
+	{
+		unsigned int entity = mv_entity_indexes[i];
+		Vector3 center = (mv_box_min[entity] + mv_box_max[entity]) * 0.5;
+		box_min    = componentMin(box_min,    mv_box_min[entity]);
+		box_max    = componentMax(box_max,    mv_box_max[entity]);
+		center_min = componentMin(center_min, center);
+		center_max = componentMax(center_max, center);
+	}
+	mv_nodes[node_index].m_box_min = box_min;
+	mv_nodes[node_index].m_box_max = box_max;
+
+	if(end - begin <= LEAF_SIZE)
+	{
+		mv_nodes[node_index].m_right_or_first = begin;
+		mv_nodes[node_index].m_leaf_count     = end - begin;
+		return;
+	}
+
+	// split at the median center along the longest axis
+	Vector3 spread = center_max - center_min;
+	unsigned int axis = 0;
+	if(spread.y > getAxis(spread, axis))
+		axis = 1;
+	if(spread.z > getAxis(spread, axis))
+		axis = 2;
+
+	unsigned int middle = begin + (end - begin) / 2;
+	nth_element(mv_entity_indexes.begin() + begin,
+	            mv_entity_indexes.begin() + middle,
+	            mv_entity_indexes.begin() + end,
+	            [&] (unsigned int a, unsigned int b)
+	            {
+	                return getAxis(mv_box_min[a] + mv_box_max[a], axis) <
+	                       getAxis(mv_box_min[b] + mv_box_max[b], axis);
+	            });
+
+	// left child is always the next node
+	buildNode(begin, middle);
+	mv_nodes[node_index].m_right_or_first = mv_nodes.size();
+	mv_nodes[node_index].m_leaf_count     = 0;
+	buildNode(middle, end);
+}
+
+bool FixedEntityBvh :: isInvariantTrue () const
+{
+	if(mv_nodes.empty() != mv_entity_indexes.empty())
+		return false;
+	if(mv_box_min.size() != mv_entity_indexes.size())
+		return false;
+	if(mv_box_max.size() != mv_entity_indexes.size())
+		return false;
+	return true;
+}
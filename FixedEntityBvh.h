@@ -0,0 +1,204 @@
+//
+//  FixedEntityBvh.h
+//
+//  A module to find the fixed entities near a sphere quickly.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+class FixedEntity;
+class ViewFrustum;
+
+
+
+//
+//  FixedEntityBvh
+//
+//  A class to represent a bounding volume hierarchy over a list
+//    of fixed entities.  The hierarchy is built once, after the
+//    map is loaded, and is then used as the collision broadphase
+//    so that only the fixed entities whose bounding boxes
+//    overlap a query sphere are passed on to isCollision.  A
+//    query visits O(log n) nodes plus the nodes that actually
+//    overlap the sphere.  The same boxes are used to find the
+//    fixed entities inside a ViewFrustum before drawing.
+//
+//  The nodes are stored in a single array in depth-first order,
+//    so the left child of a node always follows it directly.
+//    Each leaf refers to a run of at most LEAF_SIZE entries in
+//    mv_entity_indexes.
+//
+//  A FixedEntityBvh stores indexes into the list it was built
+//    from, so that list must not change until the hierarchy is
+//    built again.
+//
+//  Class Invariant:
+//    <1> mv_nodes.empty() == mv_entity_indexes.empty()
+//    <2> mv_box_min.size() == mv_entity_indexes.size()
+//    <3> mv_box_max.size() == mv_entity_indexes.size()
+//
+class FixedEntityBvh
+{
+public:
+//
+//  LEAF_SIZE
+//
+//  The maximum number of fixed entities in a leaf node.
+//
+	static const unsigned int LEAF_SIZE = 4;
+
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To create an empty FixedEntityBvh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A FixedEntityBvh containing no fixed entities
+//               is created.
+//
+	FixedEntityBvh ();
+
+//
+//  getCount
+//
+//  Purpose: To determine how many fixed entities are in this
+//           FixedEntityBvh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of fixed entities.
+//  Side Effect: N/A
+//
+	unsigned int getCount () const;
+
+//
+//  getNodeCount
+//
+//  Purpose: To determine how many nodes are in this
+//           FixedEntityBvh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of nodes, including leaves.
+//  Side Effect: N/A
+//
+	unsigned int getNodeCount () const;
+
+//
+//  query
+//
+//  Purpose: To find the fixed entities that may intersect a
+//           sphere.
+//  Parameter(s):
+//    <1> center: The center of the sphere
+//    <2> radius: The radius of the sphere
+//    <3> r_indexes: A vector to fill with the indexes
+//  Precondition(s):
+//    <1> radius >= 0.0
+//  Returns: N/A
+//  Side Effect: r_indexes is cleared and then filled with the
+//               index of every fixed entity whose bounding box
+//               intersects the sphere, in increasing order.
+//               Every fixed entity that the sphere collides
+//               with is included, but some that it does not
+//               collide with may be too.
+//
+	void query (const ObjLibrary::Vector3& center,
+	            double radius,
+	            std::vector<unsigned int>& r_indexes) const;
+
+//
+//  query
+//
+//  Purpose: To find the fixed entities that may be visible.
+//  Parameter(s):
+//    <1> frustum: The volume that can be seen
+//    <2> r_indexes: A vector to fill with the indexes
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: r_indexes is cleared and then filled with the
+//               index of every fixed entity whose bounding box
+//               is not outside frustum, in increasing order.
+//               Subtrees entirely outside frustum are skipped
+//               without looking at their entities.
+//
+	void query (const ViewFrustum& frustum,
+	            std::vector<unsigned int>& r_indexes) const;
+
+//
+//  build
+//
+//  Purpose: To build this FixedEntityBvh over a list of fixed
+//           entities.
+//  Parameter(s):
+//    <1> fixed_entities: The fixed entities
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: Any existing hierarchy is discarded and a new
+//               one is built.  The indexes returned by query
+//               refer to fixed_entities.
+//
+	void build (const std::vector<FixedEntity>& fixed_entities);
+
+private:
+//
+//  Node
+//
+//  A record to represent one node in the hierarchy.  For an
+//    inner node, the left child is the next node and
+//    m_right_or_first is the index of the right child.  For a
+//    leaf, m_right_or_first is the first entry in
+//    mv_entity_indexes and m_leaf_count is the number of
+//    entries.  m_leaf_count is 0 for inner nodes.
+//
+	struct Node
+	{
+		ObjLibrary::Vector3 m_box_min;
+		ObjLibrary::Vector3 m_box_max;
+		unsigned int m_right_or_first;
+		unsigned int m_leaf_count;
+	};
+
+//
+//  buildNode
+//
+//  Purpose: To build the subtree for a range of entries.
+//  Parameter(s):
+//    <1> begin: The first entry in the range
+//    <2> end: One past the last entry in the range
+//  Precondition(s):
+//    <1> begin < end
+//    <2> end <= mv_entity_indexes.size()
+//  Returns: N/A
+//  Side Effect: The nodes for the subtree are appended to
+//               mv_nodes, and the entries in the range are
+//               reordered so that each leaf refers to a
+//               contiguous run.
+//
+	void buildNode (unsigned int begin, unsigned int end);
+
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+private:
+	std::vector<Node> mv_nodes;
+
+	// fixed entity indexes, in leaf order
+	std::vector<unsigned int> mv_entity_indexes;
+
+	// bounding box of each fixed entity, by fixed entity index
+	std::vector<ObjLibrary::Vector3> mv_box_min;
+	std::vector<ObjLibrary::Vector3> mv_box_max;
+};
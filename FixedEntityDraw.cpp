@@ -0,0 +1,169 @@
+//
+//  FixedEntityDraw.cpp
+//
+//  The FixedEntity functions that use display lists.
+//
+
+#include "FixedEntity.h"
+
+#include <cassert>
+#include <vector>
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/Vector3.h"
+#include "ObjLibrary/DisplayList.h"
+
+#include "LevelOfDetail.h"
+#include "RandomStream.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	const double NORMAL_LENGTH = 0.5;
+	const unsigned long long SURFACE_NORMALS_SEED = 0x5eed;
+}
+
+
+
+FixedEntity :: FixedEntity (const ObjLibrary::Vector3& center,
+                            double radius,
+                            const ObjLibrary::DisplayList& display_list)
+		: Entity(center, radius),
+		// mv_lod_lists will be initialized below
+		// mv_lod_switch_distances will be initialized below
+		// m_normals_list will be initialized by initNormalsList
+		  m_is_sphere(true)
+		// m_end1 will be initialized by its own default constructor
+		// m_end2 will be initialized by its own default constructor
+{
+	assert(radius >= 0.0);
+	assert(display_list.isReady());
+
+	mv_lod_lists.push_back(display_list);
+	mv_lod_switch_distances.push_back(0.0);
+	initSurfaceNormalsList();
+
+	assert(isInvariantTrue());
+}
+
+FixedEntity :: FixedEntity (const ObjLibrary::Vector3& end1,
+                            const ObjLibrary::Vector3& end2,
+                            double radius,
+                            const ObjLibrary::DisplayList& display_list)
+		: Entity((end1 + end2) * 0.5, radius),
+		// mv_lod_lists will be initialized below
+		// mv_lod_switch_distances will be initialized below
+		// m_normals_list will be initialized by initNormalsList
+		  m_is_sphere(false),
+		  m_end1(end1),
+		  m_end2(end2)
+{
+	assert(end1 != end2);
+	assert(radius >= 0.0);
+	assert(display_list.isReady());
+
+	mv_lod_lists.push_back(display_list);
+	mv_lod_switch_distances.push_back(0.0);
+	initSurfaceNormalsList();
+
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned int FixedEntity :: chooseLod (const ObjLibrary::Vector3& camera_position,
+                                       unsigned int current_lod) const
+{
+	assert(isInvariantTrue());
+	assert(isDrawable());
+	assert(current_lod < getLodCount());
+
+	double distance = camera_position.getDistance(getPosition());
+	unsigned int lod = LevelOfDetail::chooseLod(distance, current_lod, mv_lod_switch_distances);
+
+	assert(lod < getLodCount());
+	return lod;
+}
+
+void FixedEntity :: draw () const
+{
+	assert(isInvariantTrue());
+	assert(isDrawable());
+
+	draw(0);
+}
+
+void FixedEntity :: draw (unsigned int lod) const
+{
+	assert(isInvariantTrue());
+	assert(isDrawable());
+	assert(lod < getLodCount());
+
+	static const double RADIANS_TO_DEGREES = 180.0 / 3.1415926535897932384626433832795;
+
+	const DisplayList& display_list = mv_lod_lists[lod];
+	if(display_list.isReady())
+	{
+		Vector3 center = getPosition();
+		double  radius = getRadius();
+
+		if(isSphere())
+		{
+			glPushMatrix();
+				glTranslated(center.x, center.y, center.z);
+				glScaled(radius, radius, radius);
+				display_list.draw();
+			glPopMatrix();
+		}
+		else
+		{
+			Vector3 direction = getDirection();
+			double  length    = getLength();
+
+			assert(!direction.isZero());
+			Vector3 axis = Vector3::UNIT_X_PLUS.crossProduct(direction);
+			axis.normalizeSafe();
+			double radians = Vector3::UNIT_X_PLUS.getAngleSafe(direction);
+			double degrees = radians * RADIANS_TO_DEGREES;
+
+			glPushMatrix();
+				glTranslated(center.x, center.y, center.z);
+				glRotated(degrees, axis.x, axis.y, axis.z);
+				glScaled(length * 0.5, radius, radius);
+				display_list.draw();
+			glPopMatrix();
+		}
+	}
+}
+
+void FixedEntity :: drawSurfaceNormals () const
+{
+	assert(isInvariantTrue());
+	assert(isDrawable());
+
+	m_surface_normals_list.draw();
+}
+
+
+
+void FixedEntity :: initSurfaceNormalsList ()
+{
+	// same points every run; this is only for display
+	RandomStream random(SURFACE_NORMALS_SEED, 0);
+
+	m_surface_normals_list.begin();
+	glColor3d(1.0, 1.0, 0.0);  // yellow
+		glBegin(GL_LINES);
+			for(unsigned int i = 0; i < 100; i++)
+			{
+				Vector3 query_pos = getRandomSurfacePoint(random);
+				Vector3 normal    = getSurfaceNormal(query_pos);
+				Vector3 end_at    = query_pos + normal * NORMAL_LENGTH;
+				glVertex3d(query_pos.x, query_pos.y, query_pos.z);
+				glVertex3d(   end_at.x,    end_at.y,    end_at.z);
+			}
+		glEnd();
+	m_surface_normals_list.end();
+}
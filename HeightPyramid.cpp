@@ -0,0 +1,448 @@
+//
+//  HeightPyramid.cpp
+//
+
+#include "HeightPyramid.h"
+
+#include <cassert>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "Heightmap.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	//
+	//  clipToSlab
+	//
+	//  Purpose: To clip a parameter range to where a moving point
+	//           is between two values on one axis.
+	//  Parameter(s):
+	//    <1> start: The position at t = 0
+	//    <2> direction: The change in position from t = 0 to
+	//                   t = 1
+	//    <3> low
+	//    <4> high: The slab
+	//    <5> r_t0
+	//    <6> r_t1: The parameter range to clip
+	//  Precondition(s):
+	//    <1> low <= high
+	//  Returns: Whether any of the range is left.
+	//  Side Effect: r_t0 and r_t1 are narrowed to the part of
+	//               the range where the position is in
+	//               [low, high].
+	//
+	bool clipToSlab (double start, double direction,
+	                 double low, double high,
+	                 double& r_t0, double& r_t1)
+	{
+		assert(low <= high);
+
+		if(direction == 0.0)
+			return start >= low && start <= high;
+
+		double t_low  = (low  - start) / direction;
+		double t_high = (high - start) / direction;
+		if(t_low > t_high)
+			swap(t_low, t_high);
+
+		r_t0 = max(r_t0, t_low);
+		r_t1 = min(r_t1, t_high);
+		return r_t0 <= r_t1;
+	}
+
+	// the cell containing a coordinate, clamped to the heightmap
+	unsigned int toCell (float coordinate, unsigned int size_cells)
+	{
+		assert(size_cells >= 1);
+
+		if(coordinate <= 0.0f)
+			return 0;
+		unsigned int cell = (unsigned int)(coordinate);
+		if(cell >= size_cells)
+			cell = size_cells - 1;
+		return cell;
+	}
+
+	//
+	//  findHitOnFlat
+	//
+	//  Purpose: To find where part of a segment first reaches a
+	//           flat horizontal surface.
+	//  Parameter(s):
+	//    <1> start_y: The segment height at t = 0
+	//    <2> direction_y: The change in height from t = 0 to
+	//                     t = 1
+	//    <3> height: The surface height
+	//    <4> t0
+	//    <5> t1: The part of the segment to check
+	//    <6> r_best: The earliest hit found so far
+	//  Precondition(s):
+	//    <1> t0 <= t1
+	//  Returns: N/A
+	//  Side Effect: If the segment reaches the surface between
+	//               t0 and t1 and before r_best, r_best is set to
+	//               the first place it does.
+	//
+	void findHitOnFlat (double start_y, double direction_y,
+	                    double height,
+	                    double t0, double t1,
+	                    double& r_best)
+	{
+		assert(t0 <= t1);
+
+		double gap0 = start_y + direction_y * t0 - height;
+		double gap1 = start_y + direction_y * t1 - height;
+
+		double hit;
+		if(gap0 <= 0.0)
+			hit = t0;
+		else if(gap1 <= 0.0)
+			hit = t0 + (t1 - t0) * gap0 / (gap0 - gap1);
+		else
+			return;
+
+		if(hit < r_best)
+			r_best = hit;
+	}
+
+}  // end of anonymous namespace
+
+
+
+const double HeightPyramid :: NO_HIT = 2.0;
+
+
+
+HeightPyramid :: HeightPyramid ()
+		: m_heightmap()
+		// mv_levels will be initialized in build
+{
+	build();
+
+	assert(isInvariantTrue());
+}
+
+HeightPyramid :: HeightPyramid (const Heightmap& heightmap)
+		: m_heightmap(heightmap)
+		// mv_levels will be initialized in build
+{
+	assert(heightmap.getSizeCellsX() >= 1);
+	assert(heightmap.getSizeCellsZ() >= 1);
+
+	build();
+
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned int HeightPyramid :: getLevelCount () const
+{
+	assert(isInvariantTrue());
+
+	return mv_levels.size();
+}
+
+float HeightPyramid :: getMinHeight (float x0, float z0,
+                                     float x1, float z1) const
+{
+	assert(isInvariantTrue());
+
+	unsigned int size_x = m_heightmap.getSizeCellsX();
+	unsigned int size_z = m_heightmap.getSizeCellsZ();
+
+	float range_min =  FLT_MAX;
+	float range_max = -FLT_MAX;
+	getRangeInRegion(mv_levels.size() - 1, 0, 0,
+	                 toCell(min(x0, x1), size_x), toCell(min(z0, z1), size_z),
+	                 toCell(max(x0, x1), size_x), toCell(max(z0, z1), size_z),
+	                 range_min, range_max);
+	return range_min;
+}
+
+float HeightPyramid :: getMaxHeight (float x0, float z0,
+                                     float x1, float z1) const
+{
+	assert(isInvariantTrue());
+
+	unsigned int size_x = m_heightmap.getSizeCellsX();
+	unsigned int size_z = m_heightmap.getSizeCellsZ();
+
+	float range_min =  FLT_MAX;
+	float range_max = -FLT_MAX;
+	getRangeInRegion(mv_levels.size() - 1, 0, 0,
+	                 toCell(min(x0, x1), size_x), toCell(min(z0, z1), size_z),
+	                 toCell(max(x0, x1), size_x), toCell(max(z0, z1), size_z),
+	                 range_min, range_max);
+	return range_max;
+}
+
+double HeightPyramid :: getSegmentHit (const Vector3& start,
+                                       const Vector3& end,
+                                       float outside_height) const
+{
+	assert(isInvariantTrue());
+
+	Segment segment;
+	segment.m_start     = start;
+	segment.m_direction = end - start;
+
+	double best = NO_HIT;
+	findHitInNode(mv_levels.size() - 1, 0, 0, segment, best);
+
+	// the parts of the segment beyond the edges
+	double t0 = 0.0;
+	double t1 = 1.0;
+	if(clipToSlab(start.x, segment.m_direction.x, 0.0, m_heightmap.getSizeCellsX(), t0, t1) &&
+	   clipToSlab(start.z, segment.m_direction.z, 0.0, m_heightmap.getSizeCellsZ(), t0, t1))
+	{
+		if(t0 > 0.0)
+			findHitOnFlat(start.y, segment.m_direction.y, outside_height, 0.0, t0, best);
+		if(t1 < 1.0)
+			findHitOnFlat(start.y, segment.m_direction.y, outside_height, t1, 1.0, best);
+	}
+	else
+		findHitOnFlat(start.y, segment.m_direction.y, outside_height, 0.0, 1.0, best);
+
+	return best;
+}
+
+
+
+void HeightPyramid :: build ()
+{
+	unsigned int size_x = m_heightmap.getSizeCellsX();
+	unsigned int size_z = m_heightmap.getSizeCellsZ();
+
+	mv_levels.clear();
+	mv_levels.push_back(Level());
+	Level& r_cells = mv_levels.back();
+	r_cells.m_size_x = size_x;
+	r_cells.m_size_z = size_z;
+	r_cells.mv_min.resize(size_x * size_z);
+	r_cells.mv_max.resize(size_x * size_z);
+	for(unsigned int i = 0; i < size_x; i++)
+		for(unsigned int k = 0; k < size_z; k++)
+		{
+			float height00 = m_heightmap.getHeight(i,     k);
+			float height10 = m_heightmap.getHeight(i + 1, k);
+			float height01 = m_heightmap.getHeight(i,     k + 1);
+			float height11 = m_heightmap.getHeight(i + 1, k + 1);
+			r_cells.mv_min[i * size_z + k] = min(min(height00, height10), min(height01, height11));
+			r_cells.mv_max[i * size_z + k] = max(max(height00, height10), max(height01, height11));
+		}
+
+	while(mv_levels.back().m_size_x > 1 || mv_levels.back().m_size_z > 1)
+	{
+		unsigned int below = mv_levels.size() - 1;
+		mv_levels.push_back(Level());
+
+		// push_back may have moved the levels
+		const Level& child = mv_levels[below];
+		Level& r_parent = mv_levels.back();
+		r_parent.m_size_x = (child.m_size_x + 1) / 2;
+		r_parent.m_size_z = (child.m_size_z + 1) / 2;
+		r_parent.mv_min.assign(r_parent.m_size_x * r_parent.m_size_z,  FLT_MAX);
+		r_parent.mv_max.assign(r_parent.m_size_x * r_parent.m_size_z, -FLT_MAX);
+
+		for(unsigned int ci = 0; ci < child.m_size_x; ci++)
+			for(unsigned int ck = 0; ck < child.m_size_z; ck++)
+			{
+				unsigned int child_index  = ci * child.m_size_z + ck;
+				unsigned int parent_index = (ci / 2) * r_parent.m_size_z + (ck / 2);
+				r_parent.mv_min[parent_index] = min(r_parent.mv_min[parent_index], child.mv_min[child_index]);
+				r_parent.mv_max[parent_index] = max(r_parent.mv_max[parent_index], child.mv_max[child_index]);
+			}
+	}
+}
+
+void HeightPyramid :: getRangeInRegion (unsigned int level,
+                                        unsigned int i,
+                                        unsigned int k,
+                                        unsigned int cell_x0,
+                                        unsigned int cell_z0,
+                                        unsigned int cell_x1,
+                                        unsigned int cell_z1,
+                                        float& r_min,
+                                        float& r_max) const
+{
+	assert(level < mv_levels.size());
+
+	const Level& node_level = mv_levels[level];
+	assert(i < node_level.m_size_x);
+	assert(k < node_level.m_size_z);
+
+	// cells covered by this node, inclusive
+	unsigned int node_x0 = i << level;
+	unsigned int node_z0 = k << level;
+	unsigned int node_x1 = min(((i + 1) << level), m_heightmap.getSizeCellsX()) - 1;
+	unsigned int node_z1 = min(((k + 1) << level), m_heightmap.getSizeCellsZ()) - 1;
+
+	if(node_x1 < cell_x0 || node_x0 > cell_x1 ||
+	   node_z1 < cell_z0 || node_z0 > cell_z1)
+	{
+		return;
+	}
+
+	bool is_inside = node_x0 >= cell_x0 && node_x1 <= cell_x1 &&
+	                 node_z0 >= cell_z0 && node_z1 <= cell_z1;
+	if(is_inside || level == 0)
+	{
+		unsigned int index = i * node_level.m_size_z + k;
+		r_min = min(r_min, node_level.mv_min[index]);
+		r_max = max(r_max, node_level.mv_max[index]);
+		return;
+	}
+
+	const Level& child_level = mv_levels[level - 1];
+	for(unsigned int ci = i * 2; ci < i * 2 + 2 && ci < child_level.m_size_x; ci++)
+		for(unsigned int ck = k * 2; ck < k * 2 + 2 && ck < child_level.m_size_z; ck++)
+			getRangeInRegion(level - 1, ci, ck,
+			                 cell_x0, cell_z0, cell_x1, cell_z1,
+			                 r_min, r_max);
+}
+
+void HeightPyramid :: findHitInNode (unsigned int level,
+                                     unsigned int i,
+                                     unsigned int k,
+                                     const Segment& segment,
+                                     double& r_best) const
+{
+	assert(level < mv_levels.size());
+
+	const Level& node_level = mv_levels[level];
+	assert(i < node_level.m_size_x);
+	assert(k < node_level.m_size_z);
+
+	double node_x0 = i << level;
+	double node_z0 = k << level;
+	double node_x1 = min(((i + 1) << level), m_heightmap.getSizeCellsX());
+	double node_z1 = min(((k + 1) << level), m_heightmap.getSizeCellsZ());
+
+	// the part of the segment over this node, and before the best hit
+	double t0 = 0.0;
+	double t1 = min(1.0, r_best);
+	if(!clipToSlab(segment.m_start.x, segment.m_direction.x, node_x0, node_x1, t0, t1))
+		return;
+	if(!clipToSlab(segment.m_start.z, segment.m_direction.z, node_z0, node_z1, t0, t1))
+		return;
+
+	// the segment is straight, so its lowest point is at an end
+	double y0 = segment.m_start.y + segment.m_direction.y * t0;
+	double y1 = segment.m_start.y + segment.m_direction.y * t1;
+	if(min(y0, y1) > node_level.mv_max[i * node_level.m_size_z + k])
+		return;
+
+	if(level == 0)
+	{
+		findHitInCell(i, k, segment, t0, t1, r_best);
+		return;
+	}
+
+	// visit the nearer children first so later ones are pruned by r_best
+	const Level& child_level = mv_levels[level - 1];
+	for(unsigned int a = 0; a < 2; a++)
+	{
+		unsigned int ci = i * 2 + ((segment.m_direction.x < 0.0) ? 1 - a : a);
+		if(ci >= child_level.m_size_x)
+			continue;
+		for(unsigned int b = 0; b < 2; b++)
+		{
+			unsigned int ck = k * 2 + ((segment.m_direction.z < 0.0) ? 1 - b : b);
+			if(ck >= child_level.m_size_z)
+				continue;
+			findHitInNode(level - 1, ci, ck, segment, r_best);
+		}
+	}
+}
+
+void HeightPyramid :: findHitInCell (unsigned int i,
+                                     unsigned int k,
+                                     const Segment& segment,
+                                     double t0,
+                                     double t1,
+                                     double& r_best) const
+{
+	assert(t0 <= t1);
+
+	double height00 = m_heightmap.getHeight(i,     k);
+	double height10 = m_heightmap.getHeight(i + 1, k);
+	double height01 = m_heightmap.getHeight(i,     k + 1);
+	double height11 = m_heightmap.getHeight(i + 1, k + 1);
+
+	// position within the cell is (u0 + du * t, w0 + dw * t)
+	double u0 = segment.m_start.x - i;
+	double w0 = segment.m_start.z - k;
+	double du = segment.m_direction.x;
+	double dw = segment.m_direction.z;
+
+	// split where the segment crosses the diagonal u == w
+	double a_bounds[3] = { t0, t1, t1 };
+	unsigned int part_count = 1;
+	if(du != dw)
+	{
+		double t_diagonal = (w0 - u0) / (du - dw);
+		if(t_diagonal > t0 && t_diagonal < t1)
+		{
+			a_bounds[1] = t_diagonal;
+			part_count = 2;
+		}
+	}
+
+	for(unsigned int p = 0; p < part_count; p++)
+	{
+		double a = a_bounds[p];
+		double b = a_bounds[p + 1];
+
+		// each part is over one flat triangle, so the gap between
+		//  the segment and the surface changes linearly
+		double middle = (a + b) * 0.5;
+		bool is_pink = (u0 + du * middle) > (w0 + dw * middle);
+
+		double a_gap[2];
+		double a_t[2] = { a, b };
+		for(unsigned int e = 0; e < 2; e++)
+		{
+			double u = u0 + du * a_t[e];
+			double w = w0 + dw * a_t[e];
+			double surface;
+			if(is_pink)
+				surface = (1.0 - u) * height00 + w * height11 + (u - w) * height10;
+			else
+				surface = (1.0 - w) * height00 + u * height11 + (w - u) * height01;
+			a_gap[e] = segment.m_start.y + segment.m_direction.y * a_t[e] - surface;
+		}
+
+		double hit;
+		if(a_gap[0] <= 0.0)
+			hit = a;
+		else if(a_gap[1] <= 0.0)
+			hit = a + (b - a) * a_gap[0] / (a_gap[0] - a_gap[1]);
+		else
+			continue;
+
+		if(hit < r_best)
+			r_best = hit;
+		return;
+	}
+}
+
+bool HeightPyramid :: isInvariantTrue () const
+{
+	if(mv_levels.size() < 1)
+		return false;
+	if(mv_levels[0].m_size_x != m_heightmap.getSizeCellsX())
+		return false;
+	if(mv_levels[0].m_size_z != m_heightmap.getSizeCellsZ())
+		return false;
+	if(mv_levels.back().m_size_x != 1 || mv_levels.back().m_size_z != 1)
+		return false;
+	return true;
+}
@@ -0,0 +1,282 @@
+//
+//  HeightPyramid.h
+//
+//  A module to answer height range and line-of-sight queries
+//    over a Heightmap.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "Heightmap.h"
+
+
+
+//
+//  HeightPyramid
+//
+//  A class to represent a min/max mip pyramid over a Heightmap.
+//    Level 0 stores the lowest and highest corner of every
+//    heightmap cell, and each higher level combines 2 x 2 nodes
+//    from the level below, up to a single root node covering
+//    the whole heightmap.  Because each heightmap triangle is
+//    flat, the highest point of a cell is always one of its
+//    corners, so the stored ranges are exact bounds on the
+//    surface.
+//
+//  All positions are in heightmap coordinates, as used by
+//    Heightmap::getHeight: X and Z are measured in cells and Y
+//    is the raw height.  Terrain converts to and from world
+//    coordinates.
+//
+//  Segment queries descend only into the nodes whose height
+//    range reaches the segment, so a segment over open water
+//    costs O(log n) and one near the surface costs O(log n)
+//    plus the number of cells it skims.
+//
+//  Class Invariant:
+//    <1> mv_levels.size() >= 1
+//    <2> mv_levels[0].m_size_x ==
+//                          m_heightmap.getSizeCellsX()
+//    <3> mv_levels[0].m_size_z ==
+//                          m_heightmap.getSizeCellsZ()
+//    <4> mv_levels.back() has exactly 1 node
+//
+class HeightPyramid
+{
+public:
+//
+//  NO_HIT
+//
+//  A special value returned by getSegmentHit when the segment
+//    does not touch the surface.  It is greater than 1.0, so it
+//    can be compared with hit fractions directly.
+//
+	static const double NO_HIT;
+
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To create a HeightPyramid for a default Heightmap.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A HeightPyramid is created for a flat 1 x 1
+//               Heightmap.
+//
+	HeightPyramid ();
+
+//
+//  Constructor
+//
+//  Purpose: To create a HeightPyramid for the specified
+//           Heightmap.
+//  Parameter(s):
+//    <1> heightmap: The Heightmap
+//  Precondition(s):
+//    <1> heightmap.getSizeCellsX() >= 1
+//    <2> heightmap.getSizeCellsZ() >= 1
+//  Returns: N/A
+//  Side Effect: A HeightPyramid is built over heightmap.  The
+//               height buffer is shared with heightmap, not
+//               copied.
+//
+	HeightPyramid (const Heightmap& heightmap);
+
+//
+//  getLevelCount
+//
+//  Purpose: To determine how many levels are in this
+//           HeightPyramid.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of levels, including the per-cell level
+//           and the root.
+//  Side Effect: N/A
+//
+	unsigned int getLevelCount () const;
+
+//
+//  getMinHeight
+//  getMaxHeight
+//
+//  Purpose: To determine the lowest or highest surface height
+//           over a rectangular region.
+//  Parameter(s):
+//    <1> x0
+//    <2> z0
+//    <3> x1
+//    <4> z1: The corners of the region
+//  Precondition(s): N/A
+//  Returns: The lowest or highest corner height of the
+//           heightmap cells that overlap the region.  The
+//           region is clamped to the heightmap.  The result is
+//           a bound on the surface in the region, and is exact
+//           when the region covers whole cells.
+//  Side Effect: N/A
+//
+	float getMinHeight (float x0, float z0,
+	                    float x1, float z1) const;
+	float getMaxHeight (float x0, float z0,
+	                    float x1, float z1) const;
+
+//
+//  getSegmentHit
+//
+//  Purpose: To determine where a line segment first touches the
+//           surface.
+//  Parameter(s):
+//    <1> start
+//    <2> end: The end points of the segment
+//    <3> outside_height: The height of the flat surface to use
+//                        beyond the edges of the heightmap
+//  Precondition(s): N/A
+//  Returns: The fraction of the way from start to end at which
+//           the segment first reaches or goes below the surface,
+//           or NO_HIT if it never does.
+//  Side Effect: N/A
+//
+	double getSegmentHit (const ObjLibrary::Vector3& start,
+	                      const ObjLibrary::Vector3& end,
+	                      float outside_height) const;
+
+private:
+//
+//  Level
+//
+//  A record to represent one level of the pyramid.  The nodes
+//    are stored X-major, and node (i, k) of level L covers the
+//    cells with X in [i * 2^L, (i + 1) * 2^L) and Z in
+//    [k * 2^L, (k + 1) * 2^L), clipped to the heightmap.
+//
+	struct Level
+	{
+		unsigned int m_size_x;
+		unsigned int m_size_z;
+		std::vector<float> mv_min;
+		std::vector<float> mv_max;
+	};
+
+//
+//  Segment
+//
+//  A record to represent a segment being tested, with
+//    m_direction == end - start.
+//
+	struct Segment
+	{
+		ObjLibrary::Vector3 m_start;
+		ObjLibrary::Vector3 m_direction;
+	};
+
+//
+//  build
+//
+//  Purpose: To build the levels of this HeightPyramid.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: mv_levels is filled from m_heightmap.
+//
+	void build ();
+
+//
+//  getRangeInRegion
+//
+//  Purpose: To find the height range of the nodes in a subtree
+//           that overlap a region of cells.
+//  Parameter(s):
+//    <1> level
+//    <2> i
+//    <3> k: The root of the subtree
+//    <4> cell_x0
+//    <5> cell_z0
+//    <6> cell_x1
+//    <7> cell_z1: The region, as an inclusive range of cells
+//    <8> r_min
+//    <9> r_max: The range found so far
+//  Precondition(s):
+//    <1> level < mv_levels.size()
+//  Returns: N/A
+//  Side Effect: r_min and r_max are widened to include every
+//               cell in the region under node (i, k).
+//
+	void getRangeInRegion (unsigned int level,
+	                       unsigned int i,
+	                       unsigned int k,
+	                       unsigned int cell_x0,
+	                       unsigned int cell_z0,
+	                       unsigned int cell_x1,
+	                       unsigned int cell_z1,
+	                       float& r_min,
+	                       float& r_max) const;
+
+//
+//  findHitInNode
+//
+//  Purpose: To find the first place a segment touches the
+//           surface inside a subtree.
+//  Parameter(s):
+//    <1> level
+//    <2> i
+//    <3> k: The root of the subtree
+//    <4> segment: The segment
+//    <5> r_best: The earliest hit found so far
+//  Precondition(s):
+//    <1> level < mv_levels.size()
+//  Returns: N/A
+//  Side Effect: If the segment touches the surface under node
+//               (i, k) before r_best, r_best is set to the
+//               fraction at which it first does.
+//
+	void findHitInNode (unsigned int level,
+	                    unsigned int i,
+	                    unsigned int k,
+	                    const Segment& segment,
+	                    double& r_best) const;
+
+//
+//  findHitInCell
+//
+//  Purpose: To find the first place a segment touches the two
+//           triangles of a heightmap cell.
+//  Parameter(s):
+//    <1> i
+//    <2> k: The cell
+//    <3> segment: The segment
+//    <4> t0
+//    <5> t1: The part of the segment inside the cell
+//    <6> r_best: The earliest hit found so far
+//  Precondition(s):
+//    <1> t0 <= t1
+//  Returns: N/A
+//  Side Effect: If the segment touches the surface in cell
+//               (i, k) before r_best, r_best is set to the
+//               fraction at which it first does.
+//
+	void findHitInCell (unsigned int i,
+	                    unsigned int k,
+	                    const Segment& segment,
+	                    double t0,
+	                    double t1,
+	                    double& r_best) const;
+
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+private:
+	Heightmap m_heightmap;
+	std::vector<Level> mv_levels;  // [0] is one node per cell
+};
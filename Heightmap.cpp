@@ -6,15 +6,59 @@
 
 #include <string>
 #include <cassert>
-#include "GetGlut.h"
+#include <memory>
+#include <vector>
 
 #include "ObjLibrary/Vector3.h"
 #include "ObjLibrary/TextureBmp.h"
-#include "ObjLibrary/TextureManager.h"
 #include "ObjLibrary/DisplayList.h"
 
+#include "Simd.h"
+
 using namespace std;
 using namespace ObjLibrary;
+using namespace Simd;
+namespace
+{
+	// side length of a square tile when UWSIM_HEIGHTMAP_TILED is
+	//  defined; 8 x 8 floats is 256 bytes, or 4 cache lines
+	const unsigned int TILE_SIZE = 8;
+
+}  // end of anonymous namespace
+
+
+
+inline unsigned int Heightmap :: getIndex (unsigned int i,
+                                           unsigned int k) const
+{
+	assert(isInside(i, k));
+
+#ifdef UWSIM_HEIGHTMAP_TILED
+	unsigned int tile = (i / TILE_SIZE) * index_stride + (k / TILE_SIZE);
+	return (tile * TILE_SIZE + i % TILE_SIZE) * TILE_SIZE + k % TILE_SIZE;
+#else
+	return i * index_stride + k;
+#endif
+}
+
+shared_ptr<vector<float> > Heightmap :: allocateHeights ()
+{
+	unsigned int size_vertices_x = size_cells_x + 1;
+	unsigned int size_vertices_z = size_cells_z + 1;
+
+#ifdef UWSIM_HEIGHTMAP_TILED
+	// the edge tiles are padded out to full tiles
+	unsigned int tile_count_x = (size_vertices_x + TILE_SIZE - 1) / TILE_SIZE;
+	unsigned int tile_count_z = (size_vertices_z + TILE_SIZE - 1) / TILE_SIZE;
+	index_stride = tile_count_z;
+	unsigned int element_count = tile_count_x * tile_count_z * TILE_SIZE * TILE_SIZE;
+#else
+	index_stride = size_vertices_z;
+	unsigned int element_count = size_vertices_x * size_vertices_z;
+#endif
+
+	return shared_ptr<vector<float> >(new vector<float>(element_count, 0.0f));
+}
 
 
 
@@ -22,7 +66,7 @@ Heightmap :: Heightmap ()
 {
 	size_cells_x = 1;
 	size_cells_z = 1;
-	heights.assign(size_cells_x + 1, vector<float>(size_cells_z + 1, 0.0f));
+	heights = allocateHeights();
 }
 
 Heightmap :: Heightmap (unsigned int size_cells_x_in,
@@ -30,32 +74,34 @@ Heightmap :: Heightmap (unsigned int size_cells_x_in,
 {
 	size_cells_x = size_cells_x_in;
 	size_cells_z = size_cells_z_in;
-	heights.assign(size_cells_x + 1, vector<float>(size_cells_z + 1, 0.0f));
+	shared_ptr<vector<float> > p_heights = allocateHeights();
 
 	for(unsigned int i = 0; i <= size_cells_x; i++)  // x
 	{
 		for(unsigned int k = 0; k <= size_cells_z; k++)  // z
 		{
-			heights[i][k] = (i % 2) * 0.5f -
-			                 k * k  * 0.05f;
+			(*p_heights)[getIndex(i, k)] = (i % 2) * 0.5f -
+			                                k * k  * 0.05f;
 		}
 	}
+	heights = p_heights;
 }
 
 Heightmap :: Heightmap (const ObjLibrary::TextureBmp& heights_image)
 {
 	size_cells_x = heights_image.getWidth() - 1;
 	size_cells_z = heights_image.getHeight() - 1;
-	heights.assign(size_cells_x + 1, vector<float>(size_cells_z + 1, 0.0f));
+	shared_ptr<vector<float> > p_heights = allocateHeights();
 
 	for(unsigned int i = 0; i <= size_cells_x; i++)  // x
 	{
 		for(unsigned int k = 0; k <= size_cells_z; k++)  // z
 		{
             unsigned char red = heights_image.getRed(i, k);
-            heights[i][k] = red / 255.0f;
+            (*p_heights)[getIndex(i, k)] = red / 255.0f;
 		}
 	}
+	heights = p_heights;
 }
 
 unsigned int Heightmap :: getSizeCellsX () const
@@ -94,15 +140,20 @@ bool Heightmap :: isInside (float x, float z) const
 float Heightmap :: getHeight (unsigned int x_query,
                               unsigned int z_query) const
 {
-	return heights[x_query][z_query];
+	return (*heights)[getIndex(x_query, z_query)];
 }
 
 float Heightmap :: getHeight (float x, float z) const
 {
 	assert(isInside(x, z));
 
+	// stay in the last cell on the far edges
 	unsigned int i0 = (unsigned int)(x);
 	unsigned int k0 = (unsigned int)(z);
+	if(i0 >= size_cells_x)
+		i0 = size_cells_x - 1;
+	if(k0 >= size_cells_z)
+		k0 = size_cells_z - 1;
 	unsigned int i1 = i0 + 1;
 	unsigned int k1 = k0 + 1;
 	float i_frac = x - i0;
@@ -138,12 +189,37 @@ float Heightmap :: getHeight (float x, float z) const
 	}
 }
 
+float Heightmap :: getMaxHeight () const
+{
+	float max_height = getHeight(0u, 0u);
+	for(unsigned int i = 0; i <= size_cells_x; i++)  // x
+		for(unsigned int k = 0; k <= size_cells_z; k++)  // z
+			if(getHeight(i, k) > max_height)
+				max_height = getHeight(i, k);
+	return max_height;
+}
+
+size_t Heightmap :: getHeightBytes () const
+{
+	return heights->capacity() * sizeof(float);
+}
+
+bool Heightmap :: isSharingHeights (const Heightmap& other) const
+{
+	return heights == other.heights;
+}
+
 ObjLibrary::Vector3 Heightmap::getSurfaceNormal (float x, float z) const
 {
 	assert(isInside(x, z));
 
+	// stay in the last cell on the far edges
 	unsigned int i0 = (unsigned int)(x);
 	unsigned int k0 = (unsigned int)(z);
+	if(i0 >= size_cells_x)
+		i0 = size_cells_x - 1;
+	if(k0 >= size_cells_z)
+		k0 = size_cells_z - 1;
 	unsigned int i1 = i0 + 1;
 	unsigned int k1 = k0 + 1;
 	float i_frac = x - i0;
@@ -189,38 +265,132 @@ ObjLibrary::Vector3 Heightmap::getSurfaceNormal (float x, float z) const
 	}
 }
 
-void Heightmap :: draw () const
+unsigned int Heightmap :: getTriangleCount () const
 {
-	display_list.draw();
+	return size_cells_x * size_cells_z * 2;
 }
 
-void Heightmap :: initDisplayList (const std::string& texture_filename,
-                                   float texture_offset_u,
-                                   float texture_offset_v,
-                                   float texture_repeat_u,
-                                   float texture_repeat_v)
+unsigned int Heightmap :: getTriangleIndex (float x, float z) const
 {
-	TextureManager::activate(texture_filename);
-	display_list.begin();
-		glEnable(GL_TEXTURE_2D);
-		TextureManager::activate(texture_filename);
-		glColor3d(1.0, 1.0, 1.0);
-		for(unsigned int i0 = 0; i0 < size_cells_x; i0++)  // x
-		{
-			unsigned int i1 = i0 + 1;
-			float tex_i0 = texture_repeat_u * (float)(i0) / size_cells_x + texture_offset_u;
-			float tex_i1 = texture_repeat_u * (float)(i1) / size_cells_x + texture_offset_u;
-			glBegin(GL_TRIANGLE_STRIP);
-				for(unsigned int k = 0; k <= size_cells_z; k++)  // z
-				{
-					float tex_k = texture_repeat_v * (float)(k) / size_cells_z + texture_offset_v;
-					glTexCoord2d(tex_i1, tex_k);
-					glVertex3d(i1, heights[i1][k], k);
-					glTexCoord2d(tex_i0, tex_k);
-					glVertex3d(i0, heights[i0][k], k);
-				}
-			glEnd();
-		}
-		glDisable(GL_TEXTURE_2D);
-	display_list.end();
+	assert(isInside(x, z));
+
+	// stay in the last cell on the far edges
+	unsigned int i0 = (unsigned int)(x);
+	unsigned int k0 = (unsigned int)(z);
+	if(i0 >= size_cells_x)
+		i0 = size_cells_x - 1;
+	if(k0 >= size_cells_z)
+		k0 = size_cells_z - 1;
+	float i_frac = x - i0;
+	float k_frac = z - k0;
+
+	unsigned int cell = i0 * size_cells_z + k0;
+	if(i_frac > k_frac)
+		return cell * 2;      // pink triangle
+	else
+		return cell * 2 + 1;  // green triangle
+}
+
+void Heightmap :: getHeights (unsigned int count,
+                              const float* pa_x,
+                              const float* pa_z,
+                              float* pa_heights) const
+{
+	assert(count == 0 || pa_x != NULL);
+	assert(count == 0 || pa_z != NULL);
+	assert(count == 0 || pa_heights != NULL);
+
+	typedef LaneBest<float> Wide;
+	typedef LaneScalar<float> Narrow;
+
+	unsigned int i = 0;
+	if(isAvailable())
+	{
+		for( ; i + Wide::WIDTH <= count; i += Wide::WIDTH)
+			getHeightsBlock<Wide>(pa_x + i, pa_z + i, pa_heights + i);
+	}
+	for( ; i < count; i++)
+		getHeightsBlock<Narrow>(pa_x + i, pa_z + i, pa_heights + i);
+}
+
+template <class LANE>
+void Heightmap :: loadCorners (const float* pa_x,
+                               const float* pa_z,
+                               typename LANE::Value& r_i_frac,
+                               typename LANE::Value& r_k_frac,
+                               typename LANE::Value& r_height00,
+                               typename LANE::Value& r_height11,
+                               typename LANE::Value& r_height10,
+                               typename LANE::Value& r_height01) const
+{
+	typedef typename LANE::Value Value;
+	const unsigned int WIDTH = LANE::WIDTH;
+
+	Value x = LANE::max(LANE::set(0.0f), LANE::min(LANE::load(pa_x), LANE::set((float)(size_cells_x))));
+	Value z = LANE::max(LANE::set(0.0f), LANE::min(LANE::load(pa_z), LANE::set((float)(size_cells_z))));
+
+	// neither instruction set has a gather, so the corners are
+	//  looked up one lane at a time
+	float a_x[WIDTH];
+	float a_z[WIDTH];
+	LANE::store(a_x, x);
+	LANE::store(a_z, z);
+
+	const float* p_heights = &(*heights)[0];
+	float a_i0[WIDTH];
+	float a_k0[WIDTH];
+	float a_height00[WIDTH];
+	float a_height11[WIDTH];
+	float a_height10[WIDTH];
+	float a_height01[WIDTH];
+	for(unsigned int l = 0; l < WIDTH; l++)
+	{
+		// stay in the last cell on the far edges
+		unsigned int i0 = (unsigned int)(a_x[l]);
+		unsigned int k0 = (unsigned int)(a_z[l]);
+		if(i0 >= size_cells_x)
+			i0 = size_cells_x - 1;
+		if(k0 >= size_cells_z)
+			k0 = size_cells_z - 1;
+
+		a_i0[l] = (float)(i0);
+		a_k0[l] = (float)(k0);
+		a_height00[l] = p_heights[getIndex(i0,     k0    )];
+		a_height11[l] = p_heights[getIndex(i0 + 1, k0 + 1)];
+		a_height10[l] = p_heights[getIndex(i0 + 1, k0    )];
+		a_height01[l] = p_heights[getIndex(i0,     k0 + 1)];
+	}
+
+	r_i_frac   = x - LANE::load(a_i0);
+	r_k_frac   = z - LANE::load(a_k0);
+	r_height00 = LANE::load(a_height00);
+	r_height11 = LANE::load(a_height11);
+	r_height10 = LANE::load(a_height10);
+	r_height01 = LANE::load(a_height01);
+}
+
+template <class LANE>
+void Heightmap :: getHeightsBlock (const float* pa_x,
+                                   const float* pa_z,
+                                   float* pa_heights) const
+{
+	typedef typename LANE::Value Value;
+	typedef typename LANE::Mask Mask;
+
+	Value i_frac, k_frac;
+	Value height00, height11, height10, height01;
+	loadCorners<LANE>(pa_x, pa_z, i_frac, k_frac,
+	                  height00, height11, height10, height01);
+
+	// same weights as getHeight, chosen per lane
+	Value one = LANE::set(1.0f);
+	Mask is_pink = LANE::greater(i_frac, k_frac);
+	Value weight00  = LANE::select(is_pink, one - i_frac, one - k_frac);
+	Value weight11  = LANE::select(is_pink, k_frac, i_frac);
+	Value weight_mid = one - weight00 - weight11;
+	Value height_mid = LANE::select(is_pink, height10, height01);
+
+	LANE::store(pa_heights, weight00 * height00 +
+	                        weight11 * height11 +
+	                        weight_mid * height_mid);
 }
@@ -1,9 +1,19 @@
 //
 //  Heightmap.h
 //
+//  The heights are stored in one contiguous buffer, by default
+//    with X-major rows.  Define UWSIM_HEIGHTMAP_TILED to store
+//    them in 8 x 8 tiles instead, so that the four corners of a
+//    cell are usually in the same cache line.
+//
+//  The buffer is never changed after construction, so copies of
+//    a Heightmap share it.
+//
 
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,7 +39,23 @@ public:
 	float getHeight (unsigned int x_query,
 	                 unsigned int z_query) const;
 	float getHeight (float x, float z) const;
+	float getMaxHeight () const;
+	size_t getHeightBytes () const;
+	bool isSharingHeights (const Heightmap& other) const;
 	ObjLibrary::Vector3 getSurfaceNormal (float x, float z) const;
+
+	// triangles are numbered 2 per cell with the cells in X-major
+	//  order, and the pink triangle (x_frac > z_frac) first
+	unsigned int getTriangleCount () const;
+	unsigned int getTriangleIndex (float x, float z) const;
+
+	// batched version of getHeight; the positions are clamped to
+	//  the heightmap edges
+	void getHeights (unsigned int count,
+	                 const float* pa_x,
+	                 const float* pa_z,
+	                 float* pa_heights) const;
+
 	void draw () const;
 
 	void initDisplayList (const std::string& texture_filename,
@@ -38,10 +64,32 @@ public:
 	                      float texture_repeat_u,
 	                      float texture_repeat_v);
 
+private:
+	unsigned int getIndex (unsigned int i,
+	                       unsigned int k) const;
+	std::shared_ptr<std::vector<float> > allocateHeights ();
+
+	// loads the cell fractions and corner heights for one block
+	//  of LANE::WIDTH positions
+	template <class LANE>
+	void loadCorners (const float* pa_x,
+	                  const float* pa_z,
+	                  typename LANE::Value& r_i_frac,
+	                  typename LANE::Value& r_k_frac,
+	                  typename LANE::Value& r_height00,
+	                  typename LANE::Value& r_height11,
+	                  typename LANE::Value& r_height10,
+	                  typename LANE::Value& r_height01) const;
+	template <class LANE>
+	void getHeightsBlock (const float* pa_x,
+	                      const float* pa_z,
+	                      float* pa_heights) const;
+
 private:
 	unsigned int size_cells_x;
 	unsigned int size_cells_z;
-	std::vector<std::vector<float> > heights;
+	unsigned int index_stride;  // vertices per row, or tiles per row if tiled
+	std::shared_ptr<const std::vector<float> > heights;
 	ObjLibrary::DisplayList display_list;
 };
 
@@ -0,0 +1,58 @@
+//
+//  HeightmapDraw.cpp
+//
+//  The Heightmap functions that use display lists.
+//
+
+#include "Heightmap.h"
+
+#include <string>
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/TextureManager.h"
+#include "ObjLibrary/Texture.h"
+#include "ObjLibrary/DisplayList.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+
+
+void Heightmap :: draw () const
+{
+	display_list.draw();
+}
+
+void Heightmap :: initDisplayList (const std::string& texture_filename,
+                                   float texture_offset_u,
+                                   float texture_offset_v,
+                                   float texture_repeat_u,
+                                   float texture_repeat_v)
+{
+	// look the texture up once and keep the reference
+	const Texture& texture = TextureManager::get(texture_filename);
+	texture.activate();
+	display_list.begin();
+		glEnable(GL_TEXTURE_2D);
+		texture.activate();
+		glColor3d(1.0, 1.0, 1.0);
+		for(unsigned int i0 = 0; i0 < size_cells_x; i0++)  // x
+		{
+			unsigned int i1 = i0 + 1;
+			float tex_i0 = texture_repeat_u * (float)(i0) / size_cells_x + texture_offset_u;
+			float tex_i1 = texture_repeat_u * (float)(i1) / size_cells_x + texture_offset_u;
+			glBegin(GL_TRIANGLE_STRIP);
+				for(unsigned int k = 0; k <= size_cells_z; k++)  // z
+				{
+					float tex_k = texture_repeat_v * (float)(k) / size_cells_z + texture_offset_v;
+					glTexCoord2d(tex_i1, tex_k);
+					glVertex3d(i1, getHeight(i1, k), k);
+					glTexCoord2d(tex_i0, tex_k);
+					glVertex3d(i0, getHeight(i0, k), k);
+				}
+			glEnd();
+		}
+		glDisable(GL_TEXTURE_2D);
+	display_list.end();
+}
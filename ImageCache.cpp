@@ -0,0 +1,39 @@
+//
+//  ImageCache.cpp
+//
+
+#include "ImageCache.h"
+
+#include <string>
+#include <unordered_map>
+
+#include "ObjLibrary/TextureBmp.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	unordered_map<string, TextureBmp> g_images;
+
+}  // end of anonymous namespace
+
+
+
+void ImageCache :: add (const std::string& filename,
+                        const ObjLibrary::TextureBmp& image)
+{
+	g_images[filename] = image;
+}
+
+ObjLibrary::TextureBmp ImageCache :: get (const std::string& filename)
+{
+	unordered_map<string, TextureBmp>::const_iterator it = g_images.find(filename);
+	if(it != g_images.end())
+		return it->second;
+	return TextureBmp(filename);
+}
+
+void ImageCache :: clear ()
+{
+	g_images.clear();
+}
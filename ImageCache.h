@@ -0,0 +1,71 @@
+//
+//  ImageCache.h
+//
+//  A module to keep images that were decoded in advance.
+//
+
+#pragma once
+
+#include <string>
+
+#include "ObjLibrary/TextureBmp.h"
+
+
+
+//
+//  ImageCache
+//
+//  A global store for BMP images that are used as data instead
+//    of as textures, such as the heightmaps for the terrain.
+//    The AssetLoader decodes these images in parallel at
+//    startup and adds them here, and the simulation retrieves
+//    them by file name.  An image that was not added is read
+//    from its file when it is requested.
+//
+//  This module does not use OpenGL, so the simulation can use
+//    it without a renderer.
+//
+namespace ImageCache
+{
+
+//
+//  add
+//
+//  Purpose: To add a decoded image.
+//  Parameter(s):
+//    <1> filename: The name of the BMP file, with its path
+//    <2> image: The image decoded from file filename
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A copy of image is stored, to be returned by
+//               get for filename.  Any image already stored
+//               for filename is replaced.
+//
+void add (const std::string& filename,
+          const ObjLibrary::TextureBmp& image);
+
+//
+//  get
+//
+//  Purpose: To retrieve an image.
+//  Parameter(s):
+//    <1> filename: The name of the BMP file, with its path
+//  Precondition(s): N/A
+//  Returns: The image in file filename.  If it was added, that
+//           copy is returned.  Otherwise, it is loaded now.
+//  Side Effect: N/A
+//
+ObjLibrary::TextureBmp get (const std::string& filename);
+
+//
+//  clear
+//
+//  Purpose: To remove all the images that were added.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: All stored images are removed.
+//
+void clear ();
+
+}  // end of namespace ImageCache
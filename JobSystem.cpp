@@ -0,0 +1,276 @@
+//
+//  JobSystem.cpp
+//
+
+#include "JobSystem.h"
+
+#include <cassert>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "Profiler.h"
+
+using namespace std;
+namespace
+{
+	// split each loop into about this many tasks per thread so
+	//  that threads that finish early have something to steal
+	const unsigned int TASKS_PER_THREAD = 4;
+
+	unsigned int resolveThreadCount (unsigned int thread_count)
+	{
+		if(thread_count == 0)
+		{
+			thread_count = thread::hardware_concurrency();
+			if(thread_count == 0)
+				thread_count = 1;
+		}
+		return thread_count;
+	}
+
+}  // end of anonymous namespace
+
+
+
+JobSystem& JobSystem :: getShared ()
+{
+	// created on first use, so it is ready for any static object
+	static JobSystem shared;
+	return shared;
+}
+
+
+
+JobSystem :: JobSystem ()
+		: m_thread_count(1),
+		  // mv_threads will be initialized to empty by the default constructor
+		  // mv_queues will be initialized in startWorkers
+		  mp_body(NULL),
+		  m_tasks_remaining(0),
+		  m_generation(0),
+		  m_is_stopping(false)
+{
+	startWorkers(1);
+
+	assert(isInvariantTrue());
+}
+
+JobSystem :: JobSystem (unsigned int thread_count)
+		: m_thread_count(1),
+		  // mv_threads will be initialized in startWorkers
+		  // mv_queues will be initialized in startWorkers
+		  mp_body(NULL),
+		  m_tasks_remaining(0),
+		  m_generation(0),
+		  m_is_stopping(false)
+{
+	startWorkers(resolveThreadCount(thread_count));
+
+	assert(isInvariantTrue());
+}
+
+JobSystem :: ~JobSystem ()
+{
+	stopWorkers();
+}
+
+
+
+unsigned int JobSystem :: getThreadCount () const
+{
+	assert(isInvariantTrue());
+
+	return m_thread_count;
+}
+
+void JobSystem :: setThreadCount (unsigned int thread_count)
+{
+	assert(isInvariantTrue());
+	assert(mp_body == NULL);
+
+	thread_count = resolveThreadCount(thread_count);
+	if(thread_count != m_thread_count)
+	{
+		stopWorkers();
+		startWorkers(thread_count);
+	}
+
+	assert(isInvariantTrue());
+}
+
+void JobSystem :: parallelFor (unsigned int count,
+                               const std::function<void (unsigned int)>& body)
+{
+	assert(isInvariantTrue());
+	assert(mp_body == NULL);
+
+	if(m_thread_count == 1 || count <= 1)
+	{
+		for(unsigned int i = 0; i < count; i++)
+			body(i);
+		return;
+	}
+
+	unsigned int task_count = m_thread_count * TASKS_PER_THREAD;
+	if(task_count > count)
+		task_count = count;
+
+	mp_body = &body;
+	m_tasks_remaining.store(task_count);
+
+	// deal tasks out to the queues in turn
+	for(unsigned int t = 0; t < task_count; t++)
+	{
+		Task task;
+		task.m_begin = (unsigned int)((unsigned long long)(count) *  t      / task_count);
+		task.m_end   = (unsigned int)((unsigned long long)(count) * (t + 1) / task_count);
+
+		TaskQueue& r_queue = *mv_queues[t % m_thread_count];
+		lock_guard<mutex> lock(r_queue.m_mutex);
+		r_queue.m_tasks.push_back(task);
+	}
+
+	{
+		lock_guard<mutex> lock(m_wake_mutex);
+		m_generation++;
+	}
+	m_wake_condition.notify_all();
+
+	runTasks(0);
+
+	{
+		unique_lock<mutex> lock(m_done_mutex);
+		while(m_tasks_remaining.load() != 0)
+			m_done_condition.wait(lock);
+	}
+	mp_body = NULL;
+
+	assert(isInvariantTrue());
+}
+
+
+
+void JobSystem :: startWorkers (unsigned int thread_count)
+{
+	assert(thread_count >= 1);
+	assert(mv_threads.empty());
+
+	m_thread_count = thread_count;
+	m_is_stopping = false;
+
+	mv_queues.clear();
+	for(unsigned int i = 0; i < thread_count; i++)
+		mv_queues.push_back(unique_ptr<TaskQueue>(new TaskQueue()));
+
+	// queue 0 belongs to the thread calling parallelFor
+	for(unsigned int i = 1; i < thread_count; i++)
+		mv_threads.push_back(thread(&JobSystem::workerMain, this, i));
+}
+
+void JobSystem :: stopWorkers ()
+{
+	{
+		lock_guard<mutex> lock(m_wake_mutex);
+		m_is_stopping = true;
+	}
+	m_wake_condition.notify_all();
+
+	for(unsigned int i = 0; i < mv_threads.size(); i++)
+		mv_threads[i].join();
+	mv_threads.clear();
+}
+
+void JobSystem :: workerMain (unsigned int queue_index)
+{
+	Profiler::setThreadName("Worker " + to_string(queue_index));
+
+	unsigned int seen_generation = 0;
+	{
+		lock_guard<mutex> lock(m_wake_mutex);
+		seen_generation = m_generation;
+	}
+
+	while(true)
+	{
+		{
+			unique_lock<mutex> lock(m_wake_mutex);
+			while(!m_is_stopping && m_generation == seen_generation)
+				m_wake_condition.wait(lock);
+			if(m_is_stopping)
+				return;
+			seen_generation = m_generation;
+		}
+
+		runTasks(queue_index);
+	}
+}
+
+void JobSystem :: runTasks (unsigned int queue_index)
+{
+	Task task;
+	while(takeTask(queue_index, task))
+	{
+		const std::function<void (unsigned int)>& body = *mp_body;
+		for(unsigned int i = task.m_begin; i < task.m_end; i++)
+			body(i);
+
+		if(m_tasks_remaining.fetch_sub(1) == 1)
+		{
+			// last task: wake the thread in parallelFor
+			lock_guard<mutex> lock(m_done_mutex);
+			m_done_condition.notify_one();
+		}
+	}
+}
+
+bool JobSystem :: takeTask (unsigned int queue_index,
+                            Task& r_task)
+{
+	assert(queue_index < mv_queues.size());
+
+	// own queue first, newest task
+	{
+		TaskQueue& r_queue = *mv_queues[queue_index];
+		lock_guard<mutex> lock(r_queue.m_mutex);
+		if(!r_queue.m_tasks.empty())
+		{
+			r_task = r_queue.m_tasks.back();
+			r_queue.m_tasks.pop_back();
+			return true;
+		}
+	}
+
+	// then steal the oldest task from another queue
+	unsigned int queue_count = mv_queues.size();
+	for(unsigned int offset = 1; offset < queue_count; offset++)
+	{
+		TaskQueue& r_victim = *mv_queues[(queue_index + offset) % queue_count];
+		lock_guard<mutex> lock(r_victim.m_mutex);
+		if(!r_victim.m_tasks.empty())
+		{
+			r_task = r_victim.m_tasks.front();
+			r_victim.m_tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem :: isInvariantTrue () const
+{
+	if(m_thread_count < 1)
+		return false;
+	if(mv_threads.size() != m_thread_count - 1)
+		return false;
+	if(mv_queues.size() != m_thread_count)
+		return false;
+	return true;
+}
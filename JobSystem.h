@@ -0,0 +1,272 @@
+//
+//  JobSystem.h
+//
+//  A module to run independent jobs on a pool of threads.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+//
+//  JobSystem
+//
+//  A class to run loops in parallel on a work-stealing thread
+//    pool.  The thread calling parallelFor takes part in the
+//    work, so a JobSystem with N threads starts N - 1 workers.
+//    With 1 thread, no workers are started and every loop runs
+//    on the calling thread in order.
+//
+//  Each call to parallelFor splits its index range into tasks,
+//    which are dealt out to one queue per thread.  A thread
+//    takes tasks from the back of its own queue and, when that
+//    is empty, steals from the front of the other queues.
+//    parallelFor returns only when every task is finished, so
+//    each call acts as a barrier.
+//
+//  parallelFor must not be called from inside a parallelFor
+//    body, and only one thread may call it at a time.
+//
+//  Class Invariant:
+//    <1> m_thread_count >= 1
+//    <2> mv_threads.size() == m_thread_count - 1
+//    <3> mv_queues.size() == m_thread_count
+//
+class JobSystem
+{
+public:
+//
+//  getShared
+//
+//  Purpose: To retrieve the JobSystem shared by the game
+//           systems that run every tick.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The shared JobSystem.  It starts with 1 thread and
+//           is created the first time this function is
+//           called.
+//  Side Effect: N/A
+//
+	static JobSystem& getShared ();
+
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To construct a JobSystem with 1 thread.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A JobSystem that runs all work on the calling
+//               thread is constructed.
+//
+	JobSystem ();
+
+//
+//  Constructor
+//
+//  Purpose: To construct a JobSystem with the specified number
+//           of threads.
+//  Parameter(s):
+//    <1> thread_count: The number of threads, including the
+//                      calling thread, or 0 to use one thread
+//                      per hardware core
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A JobSystem is constructed and its worker
+//               threads are started.
+//
+	explicit JobSystem (unsigned int thread_count);
+
+//
+//  Destructor
+//
+//  Purpose: To safely destroy this JobSystem.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The worker threads are stopped and joined.
+//
+	~JobSystem ();
+
+//
+//  getThreadCount
+//
+//  Purpose: To determine the number of threads used by this
+//           JobSystem.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of threads, including the calling
+//           thread.  This value is always at least 1.
+//  Side Effect: N/A
+//
+	unsigned int getThreadCount () const;
+
+//
+//  setThreadCount
+//
+//  Purpose: To change the number of threads used by this
+//           JobSystem.
+//  Parameter(s):
+//    <1> thread_count: The number of threads, including the
+//                      calling thread, or 0 to use one thread
+//                      per hardware core
+//  Precondition(s):
+//    <1> No parallelFor is running
+//  Returns: N/A
+//  Side Effect: The current worker threads are stopped and new
+//               ones are started.
+//
+	void setThreadCount (unsigned int thread_count);
+
+//
+//  parallelFor
+//
+//  Purpose: To call a function once for every index in a range,
+//           spread across the threads of this JobSystem.
+//  Parameter(s):
+//    <1> count: The number of indexes
+//    <2> body: The function to call for each index in
+//              [0, count)
+//  Precondition(s):
+//    <1> Not called from inside another parallelFor
+//  Returns: N/A
+//  Side Effect: body is called exactly once for each index.
+//               Calls for different indexes may run at the same
+//               time and in any order, so they must not depend
+//               on each other.  This function returns after
+//               every call has finished.
+//
+	void parallelFor (unsigned int count,
+	                  const std::function<void (unsigned int)>& body);
+
+private:
+//
+//  Copy Constructor
+//  Assignment Operator
+//
+//  These functions have intentionally not been implemented.
+//    A JobSystem owns threads and cannot be copied.
+//
+	JobSystem (const JobSystem& original);
+	JobSystem& operator= (const JobSystem& original);
+
+//
+//  Task
+//
+//  A record to represent a block of indexes to run.
+//
+	struct Task
+	{
+		unsigned int m_begin;
+		unsigned int m_end;
+	};
+
+//
+//  TaskQueue
+//
+//  A record to represent the tasks assigned to one thread.
+//
+	struct TaskQueue
+	{
+		std::mutex m_mutex;
+		std::deque<Task> m_tasks;
+	};
+
+//
+//  startWorkers
+//  stopWorkers
+//
+//  Purpose: To start or stop the worker threads.
+//  Parameter(s):
+//    <1> thread_count: The total number of threads wanted
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: startWorkers creates the queues and starts
+//               thread_count - 1 workers.  stopWorkers tells
+//               the workers to exit and joins them.
+//
+	void startWorkers (unsigned int thread_count);
+	void stopWorkers ();
+
+//
+//  workerMain
+//
+//  Purpose: To run the main loop for a worker thread.
+//  Parameter(s):
+//    <1> queue_index: The queue owned by this worker
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The worker sleeps until parallelFor posts new
+//               tasks, runs tasks until none are left, and
+//               repeats until the JobSystem is stopped.
+//
+	void workerMain (unsigned int queue_index);
+
+//
+//  runTasks
+//
+//  Purpose: To run tasks until there are none left to take.
+//  Parameter(s):
+//    <1> queue_index: The queue owned by the calling thread
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: Tasks are taken from the back of queue
+//               queue_index, or stolen from the front of the
+//               other queues, and run.  When the last task is
+//               finished, the thread waiting in parallelFor is
+//               woken.
+//
+	void runTasks (unsigned int queue_index);
+
+//
+//  takeTask
+//
+//  Purpose: To take a task to run.
+//  Parameter(s):
+//    <1> queue_index: The queue owned by the calling thread
+//    <2> r_task: A reference to set to the task taken
+//  Precondition(s): N/A
+//  Returns: Whether a task was taken.
+//  Side Effect: If a task is available, it is removed from its
+//               queue and stored in r_task.
+//
+	bool takeTask (unsigned int queue_index,
+	               Task& r_task);
+
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+private:
+	unsigned int m_thread_count;
+	std::vector<std::thread> mv_threads;
+	std::vector<std::unique_ptr<TaskQueue> > mv_queues;
+
+	const std::function<void (unsigned int)>* mp_body;
+	std::atomic<unsigned int> m_tasks_remaining;
+
+	std::mutex m_wake_mutex;
+	std::condition_variable m_wake_condition;
+	unsigned int m_generation;
+	bool m_is_stopping;
+
+	std::mutex m_done_mutex;
+	std::condition_variable m_done_condition;
+};
@@ -0,0 +1,236 @@
+//
+//  LevelOfDetail.cpp
+//
+
+#include "LevelOfDetail.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+
+#include "ObjLibrary/DisplayList.h"
+#include "ObjLibrary/MeshSimplifier.h"
+
+#include "AssetLoader.h"
+#include "FixedEntity.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	//
+	//  getLowPolyDisplayList
+	//
+	//  Purpose: To find the DisplayList for the low-poly version
+	//           of a model, loading it if needed.
+	//  Parameter(s):
+	//    <1> r_lists: The DisplayListMap to look in
+	//    <2> resource_path: The directory containing the model
+	//    <3> model_name: The file name of the full-detail model
+	//  Precondition(s): N/A
+	//  Returns: The DisplayList for the low-poly model, or a
+	//           DisplayList that is not ready if there is no
+	//           low-poly model.
+	//  Side Effect: If the low-poly model has not been looked for
+	//               before, it is loaded and added to r_lists.  A
+	//               model that does not exist is added as a
+	//               DisplayList that is not ready, so the file is
+	//               only looked for once.
+	//
+	const DisplayList& getLowPolyDisplayList (LevelOfDetail::DisplayListMap& r_lists,
+	                                          const string& resource_path,
+	                                          const string& model_name)
+	{
+		static const DisplayList NO_LIST;
+
+		string low_poly_name = LevelOfDetail::getLowPolyModelName(model_name);
+		if(low_poly_name == "")
+			return NO_LIST;
+
+		if(r_lists.count(low_poly_name) == 0)
+		{
+			// key is not in map
+			DisplayList& r_list = r_lists[low_poly_name];
+			if(ifstream(resource_path + low_poly_name))
+			{
+				DisplayList list;
+				if(AssetLoader::getModel(resource_path + low_poly_name, list))
+					r_list = list;
+			}
+		}
+		assert(r_lists.count(low_poly_name) != 0);
+
+		return r_lists[low_poly_name];
+	}
+
+	//
+	//  loadSimplifiedDisplayLists
+	//
+	//  Purpose: To create the DisplayLists for the simplified
+	//           levels of detail of a model.
+	//  Parameter(s):
+	//    <1> r_lists: The DisplayListMap to add to
+	//    <2> resource_path: The directory containing the model
+	//    <3> model_name: The file name of the full-detail model
+	//    <4> triangle_count: The number of triangles in the
+	//                        full-detail model
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: If model_name has no low-poly version, the
+	//               simplified levels are loaded or made as
+	//               described for LevelOfDetail::getModel and
+	//               added to r_lists.
+	//
+	void loadSimplifiedDisplayLists (LevelOfDetail::DisplayListMap& r_lists,
+	                                 const string& resource_path,
+	                                 const string& model_name,
+	                                 unsigned int triangle_count)
+	{
+		if(LevelOfDetail::getLowPolyModelName(model_name) == "")
+			return;
+		if(getLowPolyDisplayList(r_lists, resource_path, model_name).isReady())
+			return;
+
+		vector<double> ratios = LevelOfDetail::getSimplifiedRatios();
+		if(!MeshSimplifier::updateLods(resource_path + model_name, ratios))
+			return;
+
+		unsigned int previous_count = triangle_count;
+		for(unsigned int i = 0; i < ratios.size(); i++)
+		{
+			string lod_name = MeshSimplifier::getLodFileName(model_name, ratios[i]);
+			DisplayList& r_list = r_lists[lod_name];
+			if(!ifstream(resource_path + lod_name))
+				continue;  // removed no more triangles, so not written
+
+			DisplayList lod_list;
+			unsigned int count;
+			if(!AssetLoader::getModel(resource_path + lod_name, lod_list, count))
+				continue;
+			if(LevelOfDetail::isSimplifiedWorthUsing(count, previous_count))
+			{
+				r_list = lod_list;
+				previous_count = count;
+			}
+		}
+	}
+
+}  // end of anonymous namespace
+
+
+
+string LevelOfDetail :: getLowPolyModelName (const string& model_name)
+{
+	static const string EXTENSION = ".obj";
+
+	if(model_name.size() <= EXTENSION.size())
+		return "";
+	size_t base_length = model_name.size() - EXTENSION.size();
+	if(model_name.compare(base_length, EXTENSION.size(), EXTENSION) != 0)
+		return "";
+
+	string base = model_name.substr(0, base_length);
+	if(base.size() >= LOW_POLY_SUFFIX.size() &&
+	   base.compare(base.size() - LOW_POLY_SUFFIX.size(), LOW_POLY_SUFFIX.size(), LOW_POLY_SUFFIX) == 0)
+	{
+		return "";
+	}
+	return base + LOW_POLY_SUFFIX + EXTENSION;
+}
+
+vector<double> LevelOfDetail :: getSimplifiedRatios ()
+{
+	return vector<double>(SIMPLIFIED_RATIOS, SIMPLIFIED_RATIOS + SIMPLIFIED_COUNT);
+}
+
+bool LevelOfDetail :: isSimplifiedWorthUsing (unsigned int triangle_count,
+                                              unsigned int previous_count)
+{
+	return triangle_count <= previous_count * SIMPLIFIED_MAX_KEPT;
+}
+
+unsigned int LevelOfDetail :: chooseLod (double distance,
+                                         unsigned int current_lod,
+                                         const vector<double>& v_switch_distances)
+{
+	assert(distance >= 0.0);
+	assert(current_lod < v_switch_distances.size());
+	assert(v_switch_distances[0] == 0.0);
+
+	unsigned int lod = current_lod;
+	while(lod + 1 < v_switch_distances.size() &&
+	      distance > v_switch_distances[lod + 1] * (1.0 + HYSTERESIS))
+	{
+		lod++;
+	}
+	while(lod > 0 &&
+	      distance < v_switch_distances[lod] * (1.0 - HYSTERESIS))
+	{
+		lod--;
+	}
+
+	assert(lod < v_switch_distances.size());
+	return lod;
+}
+
+void LevelOfDetail :: addAssets (const string& resource_path,
+                                 const string& model_name)
+{
+	assert(!AssetLoader::isCpuLoaded());
+
+	AssetLoader::addModel(resource_path + model_name);
+
+	string low_poly_name = getLowPolyModelName(model_name);
+	if(low_poly_name == "")
+		return;
+	if(ifstream(resource_path + low_poly_name))
+		AssetLoader::addModel(resource_path + low_poly_name);
+	else
+		AssetLoader::addModelLods(resource_path + model_name, getSimplifiedRatios());
+}
+
+const DisplayList& LevelOfDetail :: getModel (DisplayListMap& r_lists,
+                                              const string& resource_path,
+                                              const string& model_name)
+{
+	static const DisplayList NO_LIST;
+
+	DisplayListMap::const_iterator it = r_lists.find(model_name);
+	if(it != r_lists.end())
+		return it->second;
+
+	DisplayList list;
+	unsigned int triangle_count;
+	if(!AssetLoader::getModel(resource_path + model_name, list, triangle_count))
+		return NO_LIST;
+
+	r_lists[model_name] = list;
+	loadSimplifiedDisplayLists(r_lists, resource_path, model_name, triangle_count);
+	assert(r_lists.count(model_name) != 0);
+	return r_lists[model_name];
+}
+
+void LevelOfDetail :: addLods (FixedEntity& r_entity,
+                               DisplayListMap& r_lists,
+                               const string& resource_path,
+                               const string& model_name)
+{
+	assert(r_entity.getLodCount() == 1);
+
+	double radius = r_entity.getBoundingRadius();
+	const DisplayList& low_poly_list = getLowPolyDisplayList(r_lists, resource_path, model_name);
+	if(low_poly_list.isReady())
+	{
+		r_entity.addLod(low_poly_list, radius * LOW_POLY_SWITCH_DISTANCE_PER_RADIUS);
+		return;
+	}
+
+	for(unsigned int i = 0; i < SIMPLIFIED_COUNT; i++)
+	{
+		DisplayListMap::const_iterator it = r_lists.find(MeshSimplifier::getLodFileName(model_name, SIMPLIFIED_RATIOS[i]));
+		if(it != r_lists.end() && it->second.isReady())
+			r_entity.addLod(it->second, radius * SIMPLIFIED_SWITCH_DISTANCES_PER_RADIUS[i]);
+	}
+}
@@ -0,0 +1,246 @@
+//
+//  LevelOfDetail.h
+//
+//  A module to choose and load the levels of detail for the
+//    fixed entities on the map.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "ObjLibrary/DisplayList.h"
+
+class FixedEntity;
+
+
+
+//
+//  LevelOfDetail
+//
+//  A group of functions for the levels of detail (LODs) of the
+//    fixed entities.  Level 0 of an entity is its full model.
+//    If the model has a low-poly version, named as by
+//    getLowPolyModelName, that is the only other level.
+//    Otherwise, the levels are made with a MeshSimplifier, and
+//    only kept if they remove enough triangles to be worth a
+//    switch.
+//
+//  The switch distances are multiples of the bounding radius
+//    of an entity, which keeps a switch at the same size on
+//    screen for big and small entities.
+//
+//  The functions that choose levels and name files do not use
+//    OpenGL, so they can be tested without a window.
+//
+namespace LevelOfDetail
+{
+
+//
+//  DisplayListMap
+//
+//  A type to represent an unordered mapping of DisplayLists
+//    using OBJ model file names as key values.
+//
+//  When you need a display list, first check if it is in
+//    the mapping.  If not, load the model and add the
+//    display list to the mapping.  Then, in either case,
+//    use the display list from the mapping.
+//
+using DisplayListMap = std::unordered_map<std::string, ObjLibrary::DisplayList>;
+
+//
+//  HYSTERESIS
+//
+//  How far past a switch distance the camera must move before
+//    chooseLod changes level, as a fraction of the switch
+//    distance.  This keeps an entity near a threshold from
+//    flickering between models.
+//
+const double HYSTERESIS = 0.1;
+
+//
+//  LOW_POLY_SUFFIX
+//
+//  The text added before the ".obj" of a model file name to
+//    get the name of a cheaper version of the same model.
+//
+const std::string LOW_POLY_SUFFIX = "-lowpoly";
+
+//
+//  LOW_POLY_SWITCH_DISTANCE_PER_RADIUS
+//
+//  The distance at which a fixed entity switches to its
+//    low-poly model, as a multiple of its bounding radius.
+//
+const double LOW_POLY_SWITCH_DISTANCE_PER_RADIUS = 16.0;
+
+//
+//  SIMPLIFIED_COUNT
+//  SIMPLIFIED_RATIOS
+//  SIMPLIFIED_SWITCH_DISTANCES_PER_RADIUS
+//
+//  The levels of detail made with a MeshSimplifier for a
+//    model that has no low-poly version.  Each level keeps
+//    the fraction of triangles in SIMPLIFIED_RATIOS and is
+//    used from the matching multiple of the bounding radius
+//    onwards.
+//
+const unsigned int SIMPLIFIED_COUNT = 2;
+const double SIMPLIFIED_RATIOS[SIMPLIFIED_COUNT] = {	0.5, 0.25	};
+const double SIMPLIFIED_SWITCH_DISTANCES_PER_RADIUS[SIMPLIFIED_COUNT] = {	8.0, 16.0	};
+
+//
+//  SIMPLIFIED_MAX_KEPT
+//
+//  The largest fraction of the triangles of the previous
+//    level that a simplified level may have and still be
+//    used.  A level that the simplifier could barely reduce
+//    would only cost a switch without saving anything.
+//
+const double SIMPLIFIED_MAX_KEPT = 0.9;
+
+//
+//  getLowPolyModelName
+//
+//  Purpose: To determine the file name of the low-poly version
+//           of a model.
+//  Parameter(s):
+//    <1> model_name: The file name of the model
+//  Precondition(s): N/A
+//  Returns: model_name with LOW_POLY_SUFFIX inserted before the
+//           ".obj" extension, or "" if model_name does not end
+//           in ".obj" or is already a low-poly model.
+//  Side Effect: N/A
+//
+std::string getLowPolyModelName (const std::string& model_name);
+
+//
+//  getSimplifiedRatios
+//
+//  Purpose: To retrieve the fractions of triangles kept by the
+//           simplified levels of detail.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The SIMPLIFIED_COUNT values of SIMPLIFIED_RATIOS,
+//           in the form MeshSimplifier and the AssetLoader use.
+//  Side Effect: N/A
+//
+std::vector<double> getSimplifiedRatios ();
+
+//
+//  isSimplifiedWorthUsing
+//
+//  Purpose: To determine if a simplified level of detail
+//           removes enough triangles to be used.
+//  Parameter(s):
+//    <1> triangle_count: The number of triangles in the
+//                        simplified level
+//    <2> previous_count: The number of triangles in the level
+//                        before it
+//  Precondition(s): N/A
+//  Returns: Whether triangle_count is at most
+//           SIMPLIFIED_MAX_KEPT of previous_count.
+//  Side Effect: N/A
+//
+bool isSimplifiedWorthUsing (unsigned int triangle_count,
+                             unsigned int previous_count);
+
+//
+//  chooseLod
+//
+//  Purpose: To determine which level of detail to display an
+//           entity at.
+//  Parameter(s):
+//    <1> distance: The distance from the camera to the entity
+//    <2> current_lod: The level of detail used last frame
+//    <3> v_switch_distances: The distance beyond which each
+//                            level replaces the one before it
+//  Precondition(s):
+//    <1> distance >= 0.0
+//    <2> current_lod < v_switch_distances.size()
+//    <3> v_switch_distances[0] == 0.0
+//    <4> v_switch_distances[i] < v_switch_distances[i + 1]
+//        WHERE 0 <= i < v_switch_distances.size() - 1
+//  Returns: The level of detail to use.  This is current_lod
+//           unless distance is more than HYSTERESIS past the
+//           switch distance of a coarser or finer level, in
+//           which case it may move several levels at once.
+//  Side Effect: N/A
+//
+unsigned int chooseLod (double distance,
+                        unsigned int current_lod,
+                        const std::vector<double>& v_switch_distances);
+
+//
+//  addAssets
+//
+//  Purpose: To add the models for a fixed entity to the
+//           AssetLoader.
+//  Parameter(s):
+//    <1> resource_path: The directory containing the model
+//    <2> model_name: The file name of the full-detail model
+//  Precondition(s):
+//    <1> !AssetLoader::isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The model is added to the AssetLoader, along
+//               with its low-poly version if there is one and
+//               its simplified levels if not, matching what
+//               getModel and addLods will use.
+//
+void addAssets (const std::string& resource_path,
+                const std::string& model_name);
+
+//
+//  getModel
+//
+//  Purpose: To find the DisplayList for the full-detail model
+//           of a fixed entity, loading it and its levels of
+//           detail if needed.
+//  Parameter(s):
+//    <1> r_lists: The DisplayListMap to look in
+//    <2> resource_path: The directory containing the model
+//    <3> model_name: The file name of the full-detail model
+//  Precondition(s): N/A
+//  Returns: The DisplayList for the model, or a DisplayList
+//           that is not ready if it could not be loaded.
+//  Side Effect: If model_name is not in r_lists, it is loaded
+//               through the AssetLoader.  If it has no
+//               low-poly version, the simplified levels are
+//               loaded from the files named by
+//               MeshSimplifier::getLodFileName, or made and
+//               saved there if needed.  The levels that are
+//               worth using are added to r_lists under those
+//               names, and the rest are added as DisplayLists
+//               that are not ready.  A model that could not be
+//               loaded is not added.
+//
+const ObjLibrary::DisplayList& getModel (DisplayListMap& r_lists,
+                                         const std::string& resource_path,
+                                         const std::string& model_name);
+
+//
+//  addLods
+//
+//  Purpose: To add the levels of detail for a model to a fixed
+//           entity.
+//  Parameter(s):
+//    <1> r_entity: The FixedEntity to add to
+//    <2> r_lists: The DisplayListMap to look in
+//    <3> resource_path: The directory containing the model
+//    <4> model_name: The file name of the full-detail model
+//  Precondition(s):
+//    <1> r_entity.getLodCount() == 1
+//  Returns: N/A
+//  Side Effect: If model_name has a low-poly version, it is
+//               added to r_entity.  Otherwise, any simplified
+//               levels in r_lists are added.
+//
+void addLods (FixedEntity& r_entity,
+              DisplayListMap& r_lists,
+              const std::string& resource_path,
+              const std::string& model_name);
+
+}  // end of namespace LevelOfDetail
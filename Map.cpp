@@ -13,101 +13,75 @@
 #include <vector>
 #include <unordered_map>
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector2.h"
 #include "ObjLibrary/Vector3.h"
-#include "ObjLibrary/ObjModel.h"
-#include "ObjLibrary/DisplayList.h"
-#include "ObjLibrary/TextureManager.h"
 
 #include "TimeManager.h"
 #include "Terrain.h"
 #include "CoordinateSystem.h"
 #include "Entity.h"
 #include "FixedEntity.h"
+#include "FixedEntityBvh.h"
+#include "ViewFrustum.h"
+#include "CullStatistics.h"
 #include "Fish.h"
 #include "FishSchool.h"
 #include "Collision.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include <tuple>
 
 using namespace std;
 using namespace ObjLibrary;
 namespace
 {
-	DisplayList skybox_list;
-	DisplayList surface_list;
+	const double PLAYER_RADIUS = 0.2;
+	const double PLAYER_DRAG   = 0.6;
 
-	//
-	//  DisplayListMap
-	//
-	//  A type to represent an unordered mapping of DisplayLists
-	//    using OBJ model file names as key values.
-	//
-	//  When you need a display list, first check if it is in
-	//    the mapping.  If not, load the model and add the
-	//    display list to the mapping.  Then, in either case,
-	//    use the display list from the mapping.
-	//
-	using DisplayListMap = std::unordered_map<std::string, DisplayList>;
+	// stream numbers for the random number streams made from the world seed
+	const unsigned long long RANDOM_STREAM_AUTOPILOT = 1;
+	const unsigned long long RANDOM_STREAM_SCHOOL_0  = 0x10000;
 
-	DisplayListMap sphere_lists;
-	DisplayListMap cylinder_lists;
+}  // end of anonymous namespace
 
-	const double MAX_DEPTH = 30.0;
 
-	const double PLAYER_RADIUS = 0.2;
-	const double PLAYER_DRAG   = 0.6;
 
-}  // end of anonymous namespace
+const std::string Map :: UNDERWATER_TEXTURE  = "dirt2.bmp";
+const std::string Map :: ABOVE_WATER_TEXTURE = "grass1.bmp";
 
 
 
-bool Map :: isModelsLoaded ()
+unsigned int Map :: getThreadCount ()
 {
-	return skybox_list.isReady();
+	return JobSystem::getShared().getThreadCount();
 }
 
-void Map :: loadModels (const std::string& resource_path)
+void Map :: setThreadCount (unsigned int thread_count)
 {
-	assert(!isModelsLoaded());
-
-	skybox_list  = ObjModel(resource_path + "Skybox.obj").getDisplayList();
-	surface_list = ObjModel(resource_path + "surface.obj").getDisplayList();
-
-	TextureManager::load(resource_path + "anemone.bmp",
-	                     GL_CLAMP, GL_CLAMP,
-	                     GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST,
-	                     Vector3(0.0, 0.0, 0.0));
-
-	assert(!Terrain::isPlantLoaded());
-	Terrain::loadPlant(resource_path);
-	assert(Terrain::isPlantLoaded());
-
-	assert(!Fish::isModelsLoaded());
-	Fish::loadModels(resource_path);
-	assert(Fish::isModelsLoaded());
-
-	assert(isModelsLoaded());
+	JobSystem::getShared().setThreadCount(thread_count);
 }
 
-
-
 Map :: Map ()
 		: m_player(Vector3::ZERO, PLAYER_RADIUS),
-		  m_fish_caught_count(0)
+		  m_fish_caught_count(0),
+		  m_world_seed(0),
+		  m_autopilot_random(0, RANDOM_STREAM_AUTOPILOT),
+		  m_render_alpha(1.0f),
+		  m_cull_statistics()
 {
 	resetPlayer();
 }
 
 Map :: Map (const std::string& resource_path,
-            const std::string& filename)
+            const std::string& filename,
+            unsigned long long world_seed)
 		: m_player(Vector3::ZERO, PLAYER_RADIUS),
-		  m_fish_caught_count(0)
+		  m_fish_caught_count(0),
+		  m_world_seed(world_seed),
+		  m_autopilot_random(world_seed, RANDOM_STREAM_AUTOPILOT),
+		  m_render_alpha(1.0f),
+		  m_cull_statistics()
 {
-	assert(isModelsLoaded());
-	assert(Fish::isModelsLoaded());
-
 	loadEntities(resource_path, filename);
 
 	// to generate screenshot4B
@@ -129,6 +103,14 @@ const CoordinateSystem& Map :: getPlayerCoords () const
 	return m_player;
 }
 
+CoordinateSystem Map :: getPlayerRenderCoords (float alpha) const
+{
+	assert(alpha >= 0.0f);
+	assert(alpha <= 1.0f);
+
+	return m_player_previous.getInterpolated(m_player, alpha);
+}
+
 unsigned int Map :: getFishCaughtCount () const
 {
 	return m_fish_caught_count;
@@ -149,6 +131,16 @@ double Map :: getSeafloorDepth () const
 	return m_terrain.getHeight(m_player.getPosition());
 }
 
+size_t Map :: getTerrainHeightBytes () const
+{
+	return m_terrain.getHeightBytes();
+}
+
+size_t Map :: getTerrainNormalCacheBytes () const
+{
+	return m_terrain.getNormalCacheBytes();
+}
+
 unsigned int Map :: getFixedEntityCount () const
 {
 	return mv_fixed_entities.size();
@@ -159,6 +151,39 @@ unsigned int Map :: getFishSchoolCount () const
 	return mv_fish_schools.size();
 }
 
+void Map :: findVisibleFixedEntities (const ViewFrustum& frustum,
+                                      std::vector<unsigned int>& r_indexes) const
+{
+	m_fixed_entity_bvh.query(frustum, r_indexes);
+}
+
+void Map :: findVisibleFishSchools (const ViewFrustum& frustum,
+                                    std::vector<unsigned int>& r_indexes) const
+{
+	r_indexes.clear();
+	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
+	{
+		// the school sphere contains every fish
+		const FishSchool& school = mv_fish_schools[i];
+		if(school.getCount() > 0 &&
+		   frustum.isSphereVisible(school.getPosition(), school.getRadius()))
+		{
+			r_indexes.push_back(i);
+		}
+	}
+}
+
+void Map :: findVisiblePlantChunks (const ViewFrustum& frustum,
+                                    std::vector<unsigned int>& r_chunks) const
+{
+	m_terrain.findVisiblePlantChunks(frustum, r_chunks);
+}
+
+const CullStatistics& Map :: getCullStatistics () const
+{
+	return m_cull_statistics;
+}
+
 unsigned int Map :: findNearestFixedEntity (const Vector3& search_from) const
 {
 	unsigned int nearest_entity = NOT_FOUND;
@@ -186,8 +211,9 @@ unsigned int Map :: findNearestSchool (const Vector3& search_from) const
 	double nearest_distance = 1.0e40;
 	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
 	{
-		if (mv_fish_schools[i].getCount() > 0) {
-			double current_distance = search_from.getDistance(mv_fish_schools[i].getPosition());
+		const SchoolAggregates& aggregates = mv_fish_schools[i].getAggregates();
+		if (aggregates.m_count > 0) {
+			double current_distance = search_from.getDistance(aggregates.m_centroid);
 			if (current_distance < nearest_distance)
 			{
 				nearest_school = i;
@@ -203,92 +229,17 @@ unsigned int Map :: findNearestSchool (const Vector3& search_from) const
 	return  nearest_school;
 }
 
-void Map :: updateFog () const
+void Map :: storePreviousState ()
 {
-	double player_y = m_player.getPosition().y;
-	if(!isCameraUnderwater())
-		player_y = 0.0;
-
-	double depth_fraction = -player_y / MAX_DEPTH;
-	double green = 0.75 - 0.7 * depth_fraction;
-	double blue  = 1.0  - 0.5 * depth_fraction * depth_fraction;
-
-	float fog_color[4] = {	0.0f, (float)(green), (float)(blue), 0.0f	};
-	glFogfv(GL_FOG_COLOR, fog_color);
-	glClearColor(fog_color[0], fog_color[1], fog_color[2], fog_color[3]);
-}
-
-void Map :: draw () const
-{
-	glLoadIdentity();
-	m_player.setupCamera();
-	// camera is now set up - any drawing before here will display incorrectly
-
-	// draw skybox - must be first of 3D drawing
-	if(!isCameraUnderwater())
-		drawSkybox();
-
-	// display positive X, Y, and Z axes near origin
-	//drawAxes();
-
-	m_terrain.draw(isCameraUnderwater());
-	drawEntites();
-
-	// must be last of 3D drawing
-	drawSurface();
-}
-
-void Map :: drawTerrainSurfaceNormals () const
-{
-	m_terrain.drawSurfaceNormals();
-}
-
-void Map :: drawFixedEntitySurfaceNormals (unsigned int fixed_entity_index) const
-{
-	assert(fixed_entity_index < getFixedEntityCount());
-
-	mv_fixed_entities[fixed_entity_index].drawSurfaceNormals();
-}
-
-void Map :: drawFishSchoolSphere (unsigned int fish_school_index) const
-{
-	assert(fish_school_index < getFishSchoolCount());
-
-	const FishSchool& school = mv_fish_schools[fish_school_index];
-	Vector3 position = school.getPosition();
-	double  radius   = school.getRadius();
-
-	if(isCollision(m_player, school))
-		glColor3d(1.0, 1.0, 1.0);
-	else
-		glColor3d(1.0, 0.0, 1.0);
-
-	glPushMatrix();
-		glTranslated(position.x, position.y, position.z);
-		glutWireSphere(radius, 12, 8);
-	glPopMatrix();
-}
-
-void Map :: drawFishCoords (unsigned int fish_school_index) const
-{
-	assert(fish_school_index < getFishSchoolCount());
-
-	mv_fish_schools[fish_school_index].drawAllCoordinateSystems(0.5);
-}
-
-void Map :: drawFishSpheres (unsigned int fish_school_index) const
-{
-	assert(fish_school_index < getFishSchoolCount());
-
-	glColor3d(0.0, 1.0, 1.0);
-	mv_fish_schools[fish_school_index].drawAllCollisionSpheres();
+	m_player_previous = m_player;
+	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
+		mv_fish_schools[i].storePreviousState();
 }
 
-
-
 void Map :: resetPlayer ()
 {
 	m_player.setCoordinateSystem(m_player_start);
+	m_player_previous = m_player;  // do not draw the jump
 }
 
 void Map :: addPlayerVelocity (const ObjLibrary::Vector3& delta)
@@ -323,62 +274,95 @@ void Map :: updatePhysicsAll (float delta_time)
 {
 	assert(delta_time >= 0.0f);
 
-	// apply gravity and drag
+	UWSIM_PROFILE_ZONE("Physics");
 
-	if(isPlayerUnderwater())
-	{
-		// underwater: apply drag
-		double factor = pow(PLAYER_DRAG, delta_time);
-		m_player.setVelocity(m_player.getVelocity() * factor);
-	}
-	else
 	{
-		// above water: apply gravity
-		m_player.applyGravity(delta_time);
-	}
+		UWSIM_PROFILE_ZONE("Physics/Player");
 
-	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-		mv_fish_schools[i].applyGravityAll(delta_time);
+		// apply gravity and drag
 
-	// check collisions
+		if(isPlayerUnderwater())
+		{
+			// underwater: apply drag
+			double factor = pow(PLAYER_DRAG, delta_time);
+			m_player.setVelocity(m_player.getVelocity() * factor);
+		}
+		else
+		{
+			// above water: apply gravity
+			m_player.applyGravity(delta_time);
+		}
 
-	// player and fish vs. heightmap
-	if(isCollision(m_player, m_terrain))
-	{
-		Vector3 surface_normal = m_terrain.getSurfaceNormal(getPlayerPosition());
-		m_player.bounce(surface_normal);
-	}
-	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-		mv_fish_schools[i].checkCollisionAll(m_terrain);
+		// check collisions
 
-	// player and fish vs. fixed entities
-	for(unsigned int i = 0; i < mv_fixed_entities.size(); i++)
-	{
-		const FixedEntity& entity = mv_fixed_entities[i];
-		if(isCollision(m_player, entity))
+		// player vs. heightmap
+		if(isCollision(m_player, m_terrain))
 		{
-			Vector3 surface_normal = entity.getSurfaceNormal(getPlayerPosition());
+			Vector3 surface_normal = m_terrain.getSurfaceNormal(getPlayerPosition());
 			m_player.bounce(surface_normal);
 		}
 
-		for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-			mv_fish_schools[i].checkCollisionAll(entity);
+		// player vs. fixed entities
+		vector<unsigned int> v_nearby;
+		m_fixed_entity_bvh.query(getPlayerPosition(), m_player.getRadius(), v_nearby);
+		for(unsigned int i = 0; i < v_nearby.size(); i++)
+		{
+			const FixedEntity& entity = mv_fixed_entities[v_nearby[i]];
+			if(isCollision(m_player, entity))
+			{
+				Vector3 surface_normal = entity.getSurfaceNormal(getPlayerPosition());
+				m_player.bounce(surface_normal);
+			}
+		}
 	}
 
-	for (int i = 0; i < mv_fish_schools.size(); i++) {
-		mv_fish_schools[i].calculateNearestNeighbour();
-	}
+	//
+	//  Each school only reads the player, the terrain, and the
+	//    fixed entities, so the schools can be updated in
+	//    parallel.  Each parallelFor is a barrier, so every
+	//    stage sees the same state as the serial order did.
+	//
+
+	unsigned int school_count = mv_fish_schools.size();
+	vector<unsigned int> v_fresh_caught(school_count, 0);
+	JobSystem::getShared().parallelFor(school_count, [&] (unsigned int s)
+	{
+		FishSchool& r_school = mv_fish_schools[s];
 
-	// fish vs. school bounding sphere
-	/*for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-		mv_fish_schools[i].bounceAllInwards();*/
+		{
+			UWSIM_PROFILE_ZONE("Physics/Gravity");
+			r_school.applyGravityAll(delta_time);
+		}
 
-	// player vs. fish
-	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
+		// fish vs. heightmap
+		{
+			UWSIM_PROFILE_ZONE("Physics/Terrain collision");
+			r_school.checkCollisionAll(m_terrain);
+		}
+
+		// fish vs. fixed entities, only those near the school
+		{
+			UWSIM_PROFILE_ZONE("Physics/Fixed collision");
+			vector<unsigned int> v_school_nearby;
+			m_fixed_entity_bvh.query(r_school.getPosition(), r_school.getRadius(), v_school_nearby);
+			for(unsigned int i = 0; i < v_school_nearby.size(); i++)
+				r_school.checkCollisionAll(mv_fixed_entities[v_school_nearby[i]]);
+		}
+
+		// fish vs. school bounding sphere
+		//r_school.bounceAllInwards();
+
+		// player vs. fish
+		{
+			UWSIM_PROFILE_ZONE("Physics/Catch");
+			v_fresh_caught[s] = r_school.checkPlayerCaughtFish(m_player);
+		}
+	});
+
+	for(unsigned int i = 0; i < school_count; i++)
 	{
-		unsigned int fresh_caught = mv_fish_schools[i].checkPlayerCaughtFish(m_player);
+		unsigned int fresh_caught = v_fresh_caught[i];
 		if (fresh_caught > 0) {
-			cout << "it cauhg";
 			turnOnAutoPilot();
 			//runAutoPilot(delta_time);
 		}
@@ -389,30 +373,42 @@ void Map :: updatePhysicsAll (float delta_time)
 
 	m_player.moveByVelocity(delta_time);
 
-	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-		mv_fish_schools[i].moveAllByVelocity(delta_time);
-
-	/*for (unsigned int i = 0; i < mv_fish_schools.size(); i++) {
-		mv_fish_schools[i].drawLine();
-	}*/
-
-
-
-	// cleanup
+	JobSystem::getShared().parallelFor(school_count, [&] (unsigned int s)
+	{
+		FishSchool& r_school = mv_fish_schools[s];
 
-	for (int i = 0; i < mv_fish_schools.size(); i++) {
-		mv_fish_schools[i].AIUpdateFlockLeader(delta_time);
+		{
+			UWSIM_PROFILE_ZONE("Physics/Move");
+			r_school.moveAllByVelocity(delta_time);
+			//r_school.drawLine();
 
-	}
+			// school centroids and bounds for the AI and next tick's broadphase
+			r_school.updateAggregates();
+		}
 
-	for (int i = 0; i < mv_fish_schools.size(); i++) {
-		mv_fish_schools[i].calculateNearestNeighbour();
-	}
+		// neighbours are found after fish are caught and moved so
+		//  the indexes are valid for the AI update
+		{
+			UWSIM_PROFILE_ZONE("Physics/Neighbour search");
+			r_school.calculateNearestNeighbour();
+		}
+	});
 
-	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-		mv_fish_schools[i].updateOrientationAll();
+	JobSystem::getShared().parallelFor(school_count, [&] (unsigned int s)
+	{
+		FishSchool& r_school = mv_fish_schools[s];
 
+		{
+			UWSIM_PROFILE_ZONE("Physics/AI");
+			r_school.AIUpdateFlockLeader(delta_time);
+			r_school.AIUpdateFishSchool(delta_time);
+		}
 
+		{
+			UWSIM_PROFILE_ZONE("Physics/Orientation");
+			r_school.updateOrientationAll();
+		}
+	});
 }
 
 
@@ -424,9 +420,6 @@ void Map :: updatePhysicsAll (float delta_time)
 void Map :: loadEntities (const std::string& resource_path,
                           const std::string& filename)
 {
-	assert(isModelsLoaded());
-	assert(Fish::isModelsLoaded());
-
 	ifstream fin(resource_path + filename);
 
 	// read first line
@@ -464,6 +457,12 @@ void Map :: loadEntities (const std::string& resource_path,
 		// read next line
 		std::getline(fin, line);
 	}
+
+	// the fixed entities never move, so the broadphase is built once
+	m_fixed_entity_bvh.build(mv_fixed_entities);
+
+	// every fixed entity starts at full detail
+	mv_fixed_entity_lods.assign(mv_fixed_entities.size(), 0);
 }
 
 void Map :: readTerrain (const std::string& resource_path,
@@ -499,7 +498,7 @@ void Map :: readTerrain (const std::string& resource_path,
 	ss >> texture_name;
 
 	m_terrain = Terrain(resource_path, texture_name,
-	                    "dirt2.bmp", "grass1.bmp",
+	                    UNDERWATER_TEXTURE, ABOVE_WATER_TEXTURE,
 	                    offset, size);
 }
 
@@ -555,21 +554,9 @@ void Map :: readSphere (const std::string& resource_path,
 	string model_name;
 	ss >> model_name;
 
-	if(sphere_lists.count(model_name) == 0)
-	{
-		// key is not in map
-		ObjModel model(resource_path + model_name);
-		if(model.isLoadedSuccessfully())
-			sphere_lists[model_name] = model.getDisplayList();
-		else
-		{
-			cerr << "Error: Could not load model \"" << model_name << "\"" << endl;
-			exit(1);
-		}
-	}
-	assert(sphere_lists.count(model_name) != 0);
-
-	mv_fixed_entities.push_back(FixedEntity(center, radius, sphere_lists[model_name]));
+	// the model is added by initDisplayLists
+	mv_fixed_entities.push_back(FixedEntity(center, radius));
+	mv_fixed_entity_models.push_back(model_name);
 }
 
 void Map :: readCylinder (const std::string& resource_path,
@@ -597,21 +584,9 @@ void Map :: readCylinder (const std::string& resource_path,
 	string model_name;
 	ss >> model_name;
 
-	if(cylinder_lists.count(model_name) == 0)
-	{
-		// key is not in map
-		ObjModel model(resource_path + model_name);
-		if(model.isLoadedSuccessfully())
-			cylinder_lists[model_name] = model.getDisplayList();
-		else
-		{
-			cerr << "Error: Could not load model \"" << model_name << "\"" << endl;
-			exit(1);
-		}
-	}
-	assert(cylinder_lists.count(model_name) != 0);
-
-	mv_fixed_entities.push_back(FixedEntity(end1, end2, radius, cylinder_lists[model_name]));
+	// the model is added by initDisplayLists
+	mv_fixed_entities.push_back(FixedEntity(end1, end2, radius));
+	mv_fixed_entity_models.push_back(model_name);
 }
 
 void Map :: readSchool (const std::string& resource_path,
@@ -658,64 +633,10 @@ void Map :: readSchool (const std::string& resource_path,
 		exit(1);
 	}
 
-	mv_fish_schools.push_back(FishSchool(center, radius, count, species, explore_max_distance));
-}
-
-
-
-//
-//  Helper functions for displaying map
-//
-
-void Map :: drawAxes () const
-{
-	glBegin(GL_LINES);
-		glColor3d(1.0, 0.0, 0.0);
-		glVertex3d(0.0, 0.0, 0.0);
-		glVertex3d(2.0, 0.0, 0.0);
-		glColor3d(0.0, 1.0, 0.0);
-		glVertex3d(0.0, 0.0, 0.0);
-		glVertex3d(0.0, 2.0, 0.0);
-		glColor3d(0.0, 0.0, 1.0);
-		glVertex3d(0.0, 0.0, 0.0);
-		glVertex3d(0.0, 0.0, 2.0);
-	glEnd();
-}
-
-void Map :: drawSkybox () const
-{
-	glPushMatrix();
-		glTranslated(m_player.getPosition().x,
-		             m_player.getPosition().y,
-		             m_player.getPosition().z);
-		glDisable(GL_FOG);
-		glDepthMask(GL_FALSE);
-		skybox_list.draw();
-		glDepthMask(GL_TRUE);
-		glEnable(GL_FOG);
-	glPopMatrix();
+	RandomStream random(m_world_seed, RANDOM_STREAM_SCHOOL_0 + mv_fish_schools.size());
+	mv_fish_schools.push_back(FishSchool(center, radius, count, species, explore_max_distance, random));
 }
 
-void Map :: drawEntites () const
-{
-	for(unsigned int i = 0; i < mv_fixed_entities.size(); i++)
-		mv_fixed_entities[i].draw();
-
-	for(unsigned int i = 0; i < mv_fish_schools.size(); i++)
-		mv_fish_schools[i].draw();
-}
-
-void Map :: drawSurface () const
-{
-	if(isCameraUnderwater())
-		surface_list.draw();
-	else
-	{
-		glDisable(GL_FOG);
-		surface_list.draw();
-		glEnable(GL_FOG);
-	}
-}
 
 
 bool Map::getAutoPilotValue() {
@@ -730,12 +651,25 @@ void Map::runAutoPilot(float delta_time) {
 	bool temp = true;
 	
 	unsigned int nearestFishSchool = m_player.fishSchoolIndex;
-	unsigned int randomN = m_player.fishIndex;
-	
-	Fish& target_fish = mv_fish_schools[nearestFishSchool].getFish(randomN);
+	unsigned int randomN = mv_fish_schools[nearestFishSchool].findFish(m_player.fishId);
+
+	if (randomN == FishArrays::NO_FISH)
+	{
+		// target fish was caught, so chase another one
+		chooseAutoPilotTarget();
+		nearestFishSchool = m_player.fishSchoolIndex;
+		randomN = mv_fish_schools[nearestFishSchool].findFish(m_player.fishId);
+		if (randomN == FishArrays::NO_FISH)
+			return;  // nearest school is empty
+	}
+
+	Fish target_fish = mv_fish_schools[nearestFishSchool].getFish(randomN);
 	/*cout << "this is target fish :"<< target_fish.getSpecies()<<"\n";*/
 
-	m_player.AI_Update(target_fish, delta_time);
+	bool is_path_clear = m_terrain.isSegmentClear(getPlayerPosition(),
+	                                              target_fish.getPosition(),
+	                                              m_player.getRadius());
+	m_player.AI_Update(target_fish, delta_time, is_path_clear);
 
 	
 
@@ -747,8 +681,12 @@ void Map::runAutoPilot(float delta_time) {
 
 void Map::turnOnAutoPilot() {
 
+	chooseAutoPilotTarget();
+	m_player.turnOnAutoPilot();
+}
+
+void Map::chooseAutoPilotTarget() {
 
-	bool temp = true;
 	//double nearest_distance = 
 
 
@@ -759,14 +697,13 @@ void Map::turnOnAutoPilot() {
 
 	unsigned int schoolSize = mv_fish_schools[nearestFishSchool].getCount();
 
-	double random01 = rand() / (RAND_MAX + 1.0);
-	unsigned int randomN = (unsigned int)(random01 * schoolSize);
-
 	m_player.fishSchoolIndex = nearestFishSchool;
-	m_player.fishIndex = randomN;
-
-	
-	m_player.turnOnAutoPilot();
+	m_player.fishId = FishArrays::NO_FISH;
+	if (schoolSize > 0)
+	{
+		unsigned int randomN = m_autopilot_random.getUnsigned(schoolSize);
+		m_player.fishId = mv_fish_schools[nearestFishSchool].getFishId(randomN);
+	}
 }
 
 void Map::turnOffAutoPilot() {
@@ -780,19 +717,6 @@ string Map::getAutoPilotState() {
 }
 
 
-void Map::drawLine(unsigned int school) {
-	mv_fish_schools[school].drawLine();
-
-}
-
 void Map::changePosition(unsigned int school) {
 	mv_fish_schools[school].current_explore_target = m_player.getPosition();
 }
-
-void Map::drawNeighbour() {
-	for (int i = 0; i < mv_fish_schools.size(); i++) {
-		/*mv_fish_schools[i].calculateNearestNeighbour();*/
-
-		mv_fish_schools[i].drawLinesToNeighbour();
-	}
-}
\ No newline at end of file
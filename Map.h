@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <climits>
 #include <string>
 #include <vector>
 
@@ -17,10 +18,14 @@
 #include "Terrain.h"
 
 #include "CoordinateSystem.h"
+#include "CullStatistics.h"
+#include "ViewFrustum.h"
 #include "Entity.h"
 #include "FixedEntity.h"
+#include "FixedEntityBvh.h"
 #include "FishSchool.h"
 #include "Player.h"
+#include "RandomStream.h"
 
 #include <tuple>
 
@@ -31,6 +36,13 @@
 //
 //  A class to represent the current game map.
 //
+//  Loading and updating a Map does not use OpenGL, so it can
+//    be used for simulation only, for example to run the game
+//    without a window.  It cannot be drawn until
+//    initDisplayLists is called.  The functions that use OpenGL
+//    are in MapDraw.cpp, so a simulation-only program does not
+//    need to link them.
+//
 class Map
 {
 public:
@@ -75,32 +87,120 @@ public:
 //
 	static void loadModels (const std::string& resource_path);
 
+//
+//  addAssets
+//
+//  Purpose: To add the files needed for a map to the
+//           AssetLoader, so they can be loaded in advance.
+//           This includes the general OBJ models and the files
+//           used by the terrain, plants, and fish.
+//  Parameter(s):
+//    <1> resource_path: The file path to prepend to the
+//                       filenames
+//    <2> filename: The name of the map file
+//  Precondition(s):
+//    <1> !AssetLoader::isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The map file is scanned for the models and
+//               images it refers to, and they are added to the
+//               AssetLoader along with the files that
+//               loadModels uses.  No map is created.
+//
+	static void addAssets (const std::string& resource_path,
+	                       const std::string& filename);
+
+//
+//  getThreadCount
+//
+//  Purpose: To determine the number of threads used to update
+//           the fish schools.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of threads, including the main thread.
+//           This value is always at least 1.
+//  Side Effect: N/A
+//
+	static unsigned int getThreadCount ();
+
+//
+//  setThreadCount
+//
+//  Purpose: To change the number of threads used to update the
+//           fish schools.  The results of updatePhysicsAll do
+//           not depend on the number of threads.
+//  Parameter(s):
+//    <1> thread_count: The number of threads, including the
+//                      main thread, or 0 to use one thread per
+//                      hardware core
+//  Precondition(s):
+//    <1> updatePhysicsAll is not running
+//  Returns: N/A
+//  Side Effect: The thread pool is restarted with thread_count
+//               threads.  With 1 thread, all updates run on the
+//               calling thread.
+//
+	static void setThreadCount (unsigned int thread_count);
+
 public:
 	Map ();
 	Map (const std::string& resource_path,
-	     const std::string& filename);
+	     const std::string& filename,
+	     unsigned long long world_seed);
+
+//
+//  initDisplayLists
+//
+//  Purpose: To create the display lists needed to draw this
+//           Map.
+//  Parameter(s):
+//    <1> resource_path: The file path to prepend to the
+//                       filenames
+//  Precondition(s):
+//    <1> isModelsLoaded()
+//    <2> This Map was loaded from a file and initDisplayLists
+//        has not been called for it
+//  Returns: N/A
+//  Side Effect: The terrain display lists are created, and the
+//               model and levels of detail for each fixed
+//               entity are loaded.  This Map can now be drawn.
+//               If a model cannot be loaded, an error message is
+//               printed and the program is terminated.
+//
+	void initDisplayLists (const std::string& resource_path);
 
 	const ObjLibrary::Vector3& getPlayerPosition () const;
 	const CoordinateSystem& getPlayerCoords () const;
+	CoordinateSystem getPlayerRenderCoords (float alpha) const;
 	unsigned int getFishCaughtCount () const;
 	bool isPlayerUnderwater () const;
 	bool isCameraUnderwater () const;
 
 	double getSeafloorDepth () const;
+	size_t getTerrainHeightBytes () const;
+	size_t getTerrainNormalCacheBytes () const;
 
 	unsigned int getFixedEntityCount () const;
 	unsigned int getFishSchoolCount () const;
 	unsigned int findNearestFixedEntity (const ObjLibrary::Vector3& search_from) const;
 	unsigned int findNearestSchool (const ObjLibrary::Vector3& search_from) const;
+	void findVisibleFixedEntities (const ViewFrustum& frustum,
+	                               std::vector<unsigned int>& r_indexes) const;
+	void findVisibleFishSchools (const ViewFrustum& frustum,
+	                             std::vector<unsigned int>& r_indexes) const;
+	void findVisiblePlantChunks (const ViewFrustum& frustum,
+	                             std::vector<unsigned int>& r_chunks) const;
+	const CullStatistics& getCullStatistics () const;
 
 	void updateFog () const;
-	void draw () const;
+	void draw (const ViewFrustum& frustum,
+	           float alpha);  // also updates cull statistics and LODs
 	void drawTerrainSurfaceNormals () const;
 	void drawFixedEntitySurfaceNormals (unsigned int fixed_entity_index) const;
 	void drawFishSchoolSphere (unsigned int fish_school_index) const;
 	void drawFishCoords (unsigned int fish_school_index) const;
 	void drawFishSpheres (unsigned int fish_school_index) const;
 	     
+	void storePreviousState ();  // call once per update, before anything moves
 	void resetPlayer ();
 	void addPlayerVelocity (const ObjLibrary::Vector3& delta);
 	void rotatePlayerAroundForward (double radians);
@@ -122,6 +222,17 @@ public:
 	void changePosition(unsigned int school);
 	void drawNeighbour();
 
+private:
+//
+//  UNDERWATER_TEXTURE
+//  ABOVE_WATER_TEXTURE
+//
+//  The textures drawn on the terrain below and above the
+//    water surface.
+//
+	static const std::string UNDERWATER_TEXTURE;
+	static const std::string ABOVE_WATER_TEXTURE;
+
 private:
 	void loadEntities (const std::string& resource_path,
 	                   const std::string& filename);
@@ -136,19 +247,39 @@ private:
 	void readSchool (const std::string& resource_path,
 	                 const std::string& line);
 
+	void chooseAutoPilotTarget ();
+
 	void drawAxes () const;
 	void drawSkybox () const;
-	void drawEntites () const;
+	void drawEntites ();  // draws the entities found visible by draw
 	void drawSurface () const;
 	
 
 private:
 	CoordinateSystem m_player_start;
 	Player m_player;
+	CoordinateSystem m_player_previous;
 	unsigned int m_fish_caught_count;
+	unsigned long long m_world_seed;
+	RandomStream m_autopilot_random;
 
 	Terrain m_terrain;
 	std::vector<FixedEntity> mv_fixed_entities;
+	std::vector<std::string> mv_fixed_entity_models;  // by fixed entity
+	FixedEntityBvh m_fixed_entity_bvh;
 	std::vector<FishSchool> mv_fish_schools;
+
+	// how far between the previous and current updates to draw; set by draw
+	float m_render_alpha;
+	CoordinateSystem m_player_render;
+
+	// level of detail last drawn, by fixed entity; chosen by draw
+	std::vector<unsigned int> mv_fixed_entity_lods;
+
+	// reused by draw to avoid allocating every frame
+	std::vector<unsigned int> mv_visible_fixed_entities;
+	std::vector<unsigned int> mv_visible_fish_schools;
+	std::vector<unsigned int> mv_visible_plant_chunks;
+	CullStatistics m_cull_statistics;
 };
 
@@ -0,0 +1,378 @@
+//
+//  MapDraw.cpp
+//
+//  The Map functions that load models and use OpenGL.
+//
+
+#include "Map.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/Vector3.h"
+#include "ObjLibrary/DisplayList.h"
+#include "ObjLibrary/TextureManager.h"
+
+#include "AssetLoader.h"
+#include "Terrain.h"
+#include "FixedEntity.h"
+#include "LevelOfDetail.h"
+#include "ViewFrustum.h"
+#include "Fish.h"
+#include "FishSchool.h"
+#include "FishRenderer.h"
+#include "Collision.h"
+#include "Profiler.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	DisplayList skybox_list;
+	DisplayList surface_list;
+
+	// the full-detail models and levels of detail for each shape
+	LevelOfDetail::DisplayListMap sphere_lists;
+	LevelOfDetail::DisplayListMap cylinder_lists;
+
+	// reused by every frame to avoid allocating
+	FishRenderer fish_renderer;
+
+	const double MAX_DEPTH = 30.0;
+
+}  // end of anonymous namespace
+
+
+
+bool Map :: isModelsLoaded ()
+{
+	return skybox_list.isReady();
+}
+
+void Map :: loadModels (const std::string& resource_path)
+{
+	assert(!isModelsLoaded());
+
+	AssetLoader::getModel(resource_path + "Skybox.obj", skybox_list);
+	AssetLoader::getModel(resource_path + "surface.obj", surface_list);
+
+	// the AssetLoader may have uploaded the texture already
+	if(!TextureManager::isLoaded(resource_path + "anemone.bmp"))
+	{
+		TextureManager::load(resource_path + "anemone.bmp",
+		                     GL_CLAMP, GL_CLAMP,
+		                     GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST,
+		                     Vector3(0.0, 0.0, 0.0));
+	}
+
+	assert(!Terrain::isPlantLoaded());
+	Terrain::loadPlant(resource_path);
+	assert(Terrain::isPlantLoaded());
+
+	assert(!Fish::isModelsLoaded());
+	Fish::loadModels(resource_path);
+	assert(Fish::isModelsLoaded());
+
+	assert(isModelsLoaded());
+}
+
+void Map :: addAssets (const std::string& resource_path,
+                       const std::string& filename)
+{
+	assert(!AssetLoader::isCpuLoaded());
+
+	AssetLoader::addModel(resource_path + "Skybox.obj");
+	AssetLoader::addModel(resource_path + "surface.obj");
+	AssetLoader::addTexture(resource_path + "anemone.bmp",
+	                        GL_CLAMP, GL_CLAMP,
+	                        GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST,
+	                        Vector3(0.0, 0.0, 0.0));
+	Terrain::addPlantAssets(resource_path);
+	Fish::addModelAssets(resource_path);
+
+	// only the file names are needed, so the lines are not checked
+	ifstream fin(resource_path + filename);
+	string line;
+	while(std::getline(fin, line))
+	{
+		istringstream ss(line);
+		char type;
+		if(!(ss >> type))
+			continue;
+
+		Vector3 position;
+		Vector3 other;
+		double radius;
+		string name;
+		switch(type)
+		{
+		case 't':
+			ss >> position >> other >> name;
+			AssetLoader::addImage(resource_path + name);
+			AssetLoader::addTexture(resource_path + UNDERWATER_TEXTURE);
+			AssetLoader::addTexture(resource_path + ABOVE_WATER_TEXTURE);
+			break;
+		case 's':
+			ss >> position >> radius >> name;
+			LevelOfDetail::addAssets(resource_path, name);
+			break;
+		case 'c':
+			ss >> position >> other >> radius >> name;
+			LevelOfDetail::addAssets(resource_path, name);
+			break;
+		}
+	}
+}
+
+
+
+void Map :: initDisplayLists (const std::string& resource_path)
+{
+	assert(isModelsLoaded());
+	assert(mv_fixed_entity_models.size() == mv_fixed_entities.size());
+
+	m_terrain.initDisplayLists();
+
+	// the fixed entities were loaded without models
+	for(unsigned int i = 0; i < mv_fixed_entities.size(); i++)
+	{
+		const FixedEntity& old_entity = mv_fixed_entities[i];
+		const string& model_name = mv_fixed_entity_models[i];
+		assert(!old_entity.isDrawable());
+
+		LevelOfDetail::DisplayListMap& r_lists = old_entity.isSphere() ? sphere_lists : cylinder_lists;
+		const DisplayList& list = LevelOfDetail::getModel(r_lists, resource_path, model_name);
+		if(!list.isReady())
+		{
+			cerr << "Error: Could not load model \"" << model_name << "\"" << endl;
+			exit(1);
+		}
+
+		FixedEntity entity;
+		if(old_entity.isSphere())
+			entity = FixedEntity(old_entity.getPosition(), old_entity.getRadius(), list);
+		else
+			entity = FixedEntity(old_entity.getEnd1(), old_entity.getEnd2(), old_entity.getRadius(), list);
+		LevelOfDetail::addLods(entity, r_lists, resource_path, model_name);
+		mv_fixed_entities[i] = entity;
+	}
+}
+
+
+
+void Map :: updateFog () const
+{
+	double player_y = m_player.getPosition().y;
+	if(!isCameraUnderwater())
+		player_y = 0.0;
+
+	double depth_fraction = -player_y / MAX_DEPTH;
+	double green = 0.75 - 0.7 * depth_fraction;
+	double blue  = 1.0  - 0.5 * depth_fraction * depth_fraction;
+
+	float fog_color[4] = {	0.0f, (float)(green), (float)(blue), 0.0f	};
+	glFogfv(GL_FOG_COLOR, fog_color);
+	glClearColor(fog_color[0], fog_color[1], fog_color[2], fog_color[3]);
+}
+
+void Map :: draw (const ViewFrustum& frustum,
+                  float alpha)
+{
+	assert(isModelsLoaded());
+	assert(alpha >= 0.0f);
+	assert(alpha <= 1.0f);
+
+	UWSIM_PROFILE_ZONE("Draw");
+
+	// everything moving is drawn between the last two updates;
+	//  culling still uses the current bounds, which are close
+	m_render_alpha  = alpha;
+	m_player_render = getPlayerRenderCoords(alpha);
+
+	// decide what to draw before making any OpenGL calls
+	{
+		UWSIM_PROFILE_ZONE("Draw/Cull");
+		findVisibleFixedEntities(frustum, mv_visible_fixed_entities);
+		findVisibleFishSchools  (frustum, mv_visible_fish_schools);
+		findVisiblePlantChunks  (frustum, mv_visible_plant_chunks);
+	}
+
+	// choose the level of detail for each fixed entity that will be drawn
+	unsigned int low_detail_count = 0;
+	{
+		UWSIM_PROFILE_ZONE("Draw/LOD");
+		for(unsigned int i = 0; i < mv_visible_fixed_entities.size(); i++)
+		{
+			unsigned int index = mv_visible_fixed_entities[i];
+			assert(index < mv_fixed_entity_lods.size());
+			mv_fixed_entity_lods[index] = mv_fixed_entities[index].chooseLod(m_player_render.getPosition(),
+			                                                                  mv_fixed_entity_lods[index]);
+			if(mv_fixed_entity_lods[index] > 0)
+				low_detail_count++;
+		}
+	}
+
+	m_cull_statistics.m_fixed_entities_drawn  = mv_visible_fixed_entities.size();
+	m_cull_statistics.m_fixed_entities_low_detail = low_detail_count;
+	m_cull_statistics.m_fixed_entities_culled = mv_fixed_entities.size() - mv_visible_fixed_entities.size();
+	m_cull_statistics.m_fish_schools_drawn    = mv_visible_fish_schools.size();
+	m_cull_statistics.m_fish_schools_culled   = mv_fish_schools.size() - mv_visible_fish_schools.size();
+	m_cull_statistics.m_plant_chunks_drawn    = mv_visible_plant_chunks.size();
+	m_cull_statistics.m_plant_chunks_culled   = m_terrain.getPlantChunkCount() - mv_visible_plant_chunks.size();
+
+	glLoadIdentity();
+	m_player_render.setupCamera();
+	// camera is now set up - any drawing before here will display incorrectly
+
+	// draw skybox - must be first of 3D drawing
+	if(!isCameraUnderwater())
+	{
+		UWSIM_PROFILE_ZONE("Draw/Skybox");
+		drawSkybox();
+	}
+
+	// display positive X, Y, and Z axes near origin
+	//drawAxes();
+
+	{
+		UWSIM_PROFILE_ZONE("Draw/Terrain");
+		m_terrain.draw(isCameraUnderwater(), mv_visible_plant_chunks);
+	}
+	drawEntites();
+
+	// must be last of 3D drawing
+	{
+		UWSIM_PROFILE_ZONE("Draw/Surface");
+		drawSurface();
+	}
+}
+
+void Map :: drawTerrainSurfaceNormals () const
+{
+	m_terrain.drawSurfaceNormals();
+}
+
+void Map :: drawFixedEntitySurfaceNormals (unsigned int fixed_entity_index) const
+{
+	assert(fixed_entity_index < getFixedEntityCount());
+
+	mv_fixed_entities[fixed_entity_index].drawSurfaceNormals();
+}
+
+void Map :: drawFishSchoolSphere (unsigned int fish_school_index) const
+{
+	assert(fish_school_index < getFishSchoolCount());
+
+	const FishSchool& school = mv_fish_schools[fish_school_index];
+	Vector3 position = school.getPosition();
+	double  radius   = school.getRadius();
+
+	if(isCollision(m_player, school))
+		glColor3d(1.0, 1.0, 1.0);
+	else
+		glColor3d(1.0, 0.0, 1.0);
+
+	glPushMatrix();
+		glTranslated(position.x, position.y, position.z);
+		glutWireSphere(radius, 12, 8);
+	glPopMatrix();
+}
+
+void Map :: drawFishCoords (unsigned int fish_school_index) const
+{
+	assert(fish_school_index < getFishSchoolCount());
+
+	mv_fish_schools[fish_school_index].drawAllCoordinateSystems(0.5);
+}
+
+void Map :: drawFishSpheres (unsigned int fish_school_index) const
+{
+	assert(fish_school_index < getFishSchoolCount());
+
+	glColor3d(0.0, 1.0, 1.0);
+	mv_fish_schools[fish_school_index].drawAllCollisionSpheres();
+}
+
+
+
+//
+//  Helper functions for displaying map
+//
+
+void Map :: drawAxes () const
+{
+	glBegin(GL_LINES);
+		glColor3d(1.0, 0.0, 0.0);
+		glVertex3d(0.0, 0.0, 0.0);
+		glVertex3d(2.0, 0.0, 0.0);
+		glColor3d(0.0, 1.0, 0.0);
+		glVertex3d(0.0, 0.0, 0.0);
+		glVertex3d(0.0, 2.0, 0.0);
+		glColor3d(0.0, 0.0, 1.0);
+		glVertex3d(0.0, 0.0, 0.0);
+		glVertex3d(0.0, 0.0, 2.0);
+	glEnd();
+}
+
+void Map :: drawSkybox () const
+{
+	glPushMatrix();
+		glTranslated(m_player_render.getPosition().x,
+		             m_player_render.getPosition().y,
+		             m_player_render.getPosition().z);
+		glDisable(GL_FOG);
+		glDepthMask(GL_FALSE);
+		skybox_list.draw();
+		glDepthMask(GL_TRUE);
+		glEnable(GL_FOG);
+	glPopMatrix();
+}
+
+void Map :: drawEntites ()
+{
+	{
+		UWSIM_PROFILE_ZONE("Draw/Fixed entities");
+		for(unsigned int i = 0; i < mv_visible_fixed_entities.size(); i++)
+		{
+			unsigned int index = mv_visible_fixed_entities[i];
+			mv_fixed_entities[index].draw(mv_fixed_entity_lods[index]);
+		}
+	}
+
+	UWSIM_PROFILE_ZONE("Draw/Fish");
+	fish_renderer.clear();
+	for(unsigned int i = 0; i < mv_visible_fish_schools.size(); i++)
+		fish_renderer.addSchool(mv_fish_schools[mv_visible_fish_schools[i]], m_render_alpha);
+	fish_renderer.draw();
+}
+
+void Map :: drawSurface () const
+{
+	if(isCameraUnderwater())
+		surface_list.draw();
+	else
+	{
+		glDisable(GL_FOG);
+		surface_list.draw();
+		glEnable(GL_FOG);
+	}
+}
+
+void Map::drawLine(unsigned int school) {
+	mv_fish_schools[school].drawLine(m_render_alpha);
+
+}
+
+void Map::drawNeighbour() {
+	for (int i = 0; i < mv_fish_schools.size(); i++) {
+		/*mv_fish_schools[i].calculateNearestNeighbour();*/
+
+		mv_fish_schools[i].drawLinesToNeighbour();
+	}
+}
@@ -0,0 +1,414 @@
+//
+//  CompiledMesh.cpp
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#include <cassert>
+#include <cstddef>	// for NULL
+#include <cstring>	// for memcpy, memcmp
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define GL_SILENCE_DEPRECATION
+#include "../GetGlut.h"
+
+#include "DisplayList.h"
+#include "Material.h"
+#include "CompiledMesh.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+
+
+const unsigned int CompiledMesh :: FLOATS_PER_VERTEX;
+const unsigned int CompiledMesh :: POSITION_OFFSET;
+const unsigned int CompiledMesh :: NORMAL_OFFSET;
+const unsigned int CompiledMesh :: TEXTURE_COORDINATE_OFFSET;
+const unsigned int CompiledMesh :: MAX_VERTEX_COUNT_16;
+
+
+
+CompiledMesh :: CompiledMesh ()
+		: mv_vertex_data(),
+		  mv_indexes_16(),
+		  mv_indexes_32(),
+		  mv_ranges(),
+		  m_vertex_lookup(),
+		  m_is_finished(false)
+{
+	assert(invariant());
+}
+
+
+
+bool CompiledMesh :: isFinished () const
+{
+	return m_is_finished;
+}
+
+unsigned int CompiledMesh :: getVertexCount () const
+{
+	return (unsigned int)(mv_vertex_data.size() / FLOATS_PER_VERTEX);
+}
+
+unsigned int CompiledMesh :: getIndexCount () const
+{
+	return (unsigned int)(mv_indexes_16.size() + mv_indexes_32.size());
+}
+
+double CompiledMesh :: getDeduplicationRatio () const
+{
+	if(getVertexCount() == 0)
+		return 1.0;
+	return (double)(getIndexCount()) / getVertexCount();
+}
+
+bool CompiledMesh :: isIndex16Bit () const
+{
+	assert(isFinished());
+
+	return getVertexCount() <= MAX_VERTEX_COUNT_16;
+}
+
+const float* CompiledMesh :: getVertexData () const
+{
+	if(mv_vertex_data.empty())
+		return NULL;
+	return mv_vertex_data.data();
+}
+
+const void* CompiledMesh :: getIndexData () const
+{
+	assert(isFinished());
+
+	if(!mv_indexes_16.empty())
+		return mv_indexes_16.data();
+	if(!mv_indexes_32.empty())
+		return mv_indexes_32.data();
+	return NULL;
+}
+
+unsigned int CompiledMesh :: getIndex (unsigned int index) const
+{
+	assert(index < getIndexCount());
+
+	if(!mv_indexes_16.empty())
+		return mv_indexes_16[index];
+	else
+		return mv_indexes_32[index];
+}
+
+size_t CompiledMesh :: getByteCount () const
+{
+	assert(isFinished());
+
+	return mv_vertex_data.size() * sizeof(float) +
+	       mv_indexes_16.size()  * sizeof(unsigned short) +
+	       mv_indexes_32.size()  * sizeof(unsigned int);
+}
+
+unsigned int CompiledMesh :: getRangeCount () const
+{
+	return (unsigned int)(mv_ranges.size());
+}
+
+unsigned int CompiledMesh :: getRangeFirstIndex (unsigned int range) const
+{
+	assert(range < getRangeCount());
+
+	return mv_ranges[range].m_first_index;
+}
+
+unsigned int CompiledMesh :: getRangeIndexCount (unsigned int range) const
+{
+	assert(range < getRangeCount());
+
+	return mv_ranges[range].m_index_count;
+}
+
+const string& CompiledMesh :: getRangeMaterialName (unsigned int range) const
+{
+	assert(range < getRangeCount());
+
+	return mv_ranges[range].m_material_name;
+}
+
+const Material* CompiledMesh :: getRangeMaterial (unsigned int range) const
+{
+	assert(range < getRangeCount());
+
+	return mv_ranges[range].mp_material;
+}
+
+
+
+#ifndef OBJ_LIBRARY_SHADER_DISPLAY
+
+void CompiledMesh :: draw () const
+{
+	assert(isFinished());
+	assert(!Material::isMaterialActive());
+
+	enableArrays();
+	for(unsigned int r = 0; r < getRangeCount(); r++)
+	{
+		const Material* p_material = mv_ranges[r].mp_material;
+		if(p_material == NULL)
+			drawRange(r);
+		else
+		{
+			p_material->activate();
+			drawRange(r);
+			Material::deactivate();
+
+			if(p_material->isSeperateSpecular())
+			{
+				p_material->activateSeperateSpecular();
+				drawRange(r);
+				Material::deactivate();
+			}
+		}
+	}
+	disableArrays();
+
+	assert(!Material::isMaterialActive());
+}
+
+void CompiledMesh :: drawMaterialNone () const
+{
+	assert(isFinished());
+
+	enableArrays();
+	for(unsigned int r = 0; r < getRangeCount(); r++)
+		drawRange(r);
+	disableArrays();
+}
+
+DisplayList CompiledMesh :: getDisplayList () const
+{
+	assert(isFinished());
+	assert(!Material::isMaterialActive());
+
+	// the client arrays are read when the list is compiled
+	DisplayList list;
+	list.begin();
+		draw();
+	list.end();
+
+	assert(!Material::isMaterialActive());
+	return list;
+}
+
+#endif  // OBJ_LIBRARY_SHADER_DISPLAY is not defined
+
+
+
+void CompiledMesh :: beginRange (const string& material_name,
+                                 const Material* p_material)
+{
+	assert(!isFinished());
+
+	Range range;
+	range.m_material_name = material_name;
+	range.mp_material     = p_material;
+	range.m_first_index   = getIndexCount();
+	range.m_index_count   = 0;
+	mv_ranges.push_back(range);
+
+	assert(invariant());
+}
+
+void CompiledMesh :: addVertex (const float a_vertex[])
+{
+	assert(!isFinished());
+	assert(getRangeCount() > 0);
+	assert(a_vertex != NULL);
+
+	VertexKey key;
+	memcpy(key.ma_data, a_vertex, sizeof(key.ma_data));
+
+	unordered_map<VertexKey, unsigned int, VertexKeyHash>::iterator it = m_vertex_lookup.find(key);
+	unsigned int vertex;
+	if(it != m_vertex_lookup.end())
+		vertex = it->second;
+	else
+	{
+		vertex = getVertexCount();
+		m_vertex_lookup[key] = vertex;
+		mv_vertex_data.insert(mv_vertex_data.end(), a_vertex, a_vertex + FLOATS_PER_VERTEX);
+	}
+
+	mv_indexes_32.push_back(vertex);
+	mv_ranges.back().m_index_count++;
+
+	assert(invariant());
+}
+
+void CompiledMesh :: finish ()
+{
+	assert(!isFinished());
+
+	// drop ranges with nothing to draw
+	unsigned int kept = 0;
+	for(unsigned int r = 0; r < getRangeCount(); r++)
+	{
+		assert(mv_ranges[r].m_index_count % 3 == 0);
+		if(mv_ranges[r].m_index_count > 0)
+		{
+			if(kept != r)
+				mv_ranges[kept] = mv_ranges[r];
+			kept++;
+		}
+	}
+	mv_ranges.resize(kept);
+
+	if(getVertexCount() <= MAX_VERTEX_COUNT_16)
+	{
+		mv_indexes_16.assign(mv_indexes_32.begin(), mv_indexes_32.end());
+		vector<unsigned int>().swap(mv_indexes_32);
+	}
+
+	unordered_map<VertexKey, unsigned int, VertexKeyHash>().swap(m_vertex_lookup);
+	m_is_finished = true;
+
+	assert(invariant());
+}
+
+void CompiledMesh :: setArrays (const float a_vertex_data[],
+                                unsigned int vertex_count,
+                                const void* a_index_data,
+                                unsigned int index_count)
+{
+	assert(!isFinished());
+	assert(getRangeCount() == 0);
+	assert(getVertexCount() == 0);
+	assert(a_vertex_data != NULL || vertex_count == 0);
+	assert(a_index_data != NULL || index_count == 0);
+	assert(index_count % 3 == 0);
+
+	mv_vertex_data.assign(a_vertex_data, a_vertex_data + vertex_count * FLOATS_PER_VERTEX);
+	mv_indexes_16.clear();
+	mv_indexes_32.clear();
+	if(vertex_count <= MAX_VERTEX_COUNT_16)
+	{
+		const unsigned short* a_indexes = (const unsigned short*)(a_index_data);
+		mv_indexes_16.assign(a_indexes, a_indexes + index_count);
+	}
+	else
+	{
+		const unsigned int* a_indexes = (const unsigned int*)(a_index_data);
+		mv_indexes_32.assign(a_indexes, a_indexes + index_count);
+	}
+
+	unordered_map<VertexKey, unsigned int, VertexKeyHash>().swap(m_vertex_lookup);
+	m_is_finished = true;
+
+	assert(invariant());
+}
+
+void CompiledMesh :: addRange (const string& material_name,
+                               const Material* p_material,
+                               unsigned int first_index,
+                               unsigned int index_count)
+{
+	assert(isFinished());
+	assert(index_count > 0);
+	assert(index_count % 3 == 0);
+	assert(first_index + index_count <= getIndexCount());
+
+	Range range;
+	range.m_material_name = material_name;
+	range.mp_material     = p_material;
+	range.m_first_index   = first_index;
+	range.m_index_count   = index_count;
+	mv_ranges.push_back(range);
+
+	assert(invariant());
+}
+
+
+
+void CompiledMesh :: drawRange (unsigned int range) const
+{
+	assert(isFinished());
+	assert(range < getRangeCount());
+
+	const Range& r = mv_ranges[range];
+	if(!mv_indexes_16.empty())
+	{
+		glDrawElements(GL_TRIANGLES, r.m_index_count, GL_UNSIGNED_SHORT,
+		               mv_indexes_16.data() + r.m_first_index);
+	}
+	else
+	{
+		glDrawElements(GL_TRIANGLES, r.m_index_count, GL_UNSIGNED_INT,
+		               mv_indexes_32.data() + r.m_first_index);
+	}
+}
+
+void CompiledMesh :: enableArrays () const
+{
+	static const GLsizei STRIDE = FLOATS_PER_VERTEX * sizeof(float);
+
+	const float* a_data = getVertexData();
+	if(a_data == NULL)
+		return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer  (3, GL_FLOAT, STRIDE, a_data + POSITION_OFFSET);
+	glNormalPointer  (   GL_FLOAT, STRIDE, a_data + NORMAL_OFFSET);
+	glTexCoordPointer(2, GL_FLOAT, STRIDE, a_data + TEXTURE_COORDINATE_OFFSET);
+}
+
+void CompiledMesh :: disableArrays ()
+{
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+bool CompiledMesh :: invariant () const
+{
+	if(mv_vertex_data.size() % FLOATS_PER_VERTEX != 0) return false;
+	if(!mv_indexes_16.empty() && !mv_indexes_32.empty()) return false;
+	if(m_is_finished && !m_vertex_lookup.empty()) return false;
+	return true;
+}
+
+
+
+bool CompiledMesh :: VertexKey :: operator== (const VertexKey& other) const
+{
+	return memcmp(ma_data, other.ma_data, sizeof(ma_data)) == 0;
+}
+
+size_t CompiledMesh :: VertexKeyHash :: operator() (const VertexKey& key) const
+{
+	// FNV-1a over the bits of each float
+	size_t hash = (size_t)(2166136261u);
+	for(unsigned int i = 0; i < FLOATS_PER_VERTEX; i++)
+	{
+		unsigned int bits;
+		memcpy(&bits, &key.ma_data[i], sizeof(bits));
+		hash = (hash ^ bits) * (size_t)(16777619u);
+	}
+	return hash;
+}
@@ -0,0 +1,523 @@
+//
+//  CompiledMesh.h
+//
+//  A class to represent the triangles of a model packed into
+//    vertex and index arrays.
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#ifndef OBJ_LIBRARY_COMPILED_MESH_H
+#define OBJ_LIBRARY_COMPILED_MESH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "DisplayList.h"
+
+
+
+namespace ObjLibrary
+{
+
+class Material;
+
+
+
+//
+//  CompiledMesh
+//
+//  A class to represent the triangles of a model in the form
+//    used by OpenGL vertex arrays.  A CompiledMesh contains a
+//    single array of interleaved float vertexes, an array of
+//    triangle indexes into it, and a list of ranges of indexes
+//    that are each displayed with one material.
+//
+//  Each vertex is stored as FLOATS_PER_VERTEX floats: the
+//    position, then the normal, then the texture coordinates.
+//    Identical vertexes are only stored once, even if they are
+//    used by different ranges.  If there are few enough
+//    vertexes, the indexes are stored as 16-bit values;
+//    otherwise, they are stored as 32-bit values.
+//
+//  A CompiledMesh is built in two stages.  First, the ranges
+//    and triangle vertexes are added with beginRange and
+//    addVertex.  Then, finish is called to choose the index
+//    size and discard the building data.  Neither stage
+//    requires an OpenGL context, so a CompiledMesh can be built
+//    and checked without one.  Only the drawing functions use
+//    OpenGL, and they only use features from OpenGL 1.1.
+//
+//  Class Invariant:
+//    <1> mv_vertex_data.size() % FLOATS_PER_VERTEX == 0
+//    <2> mv_indexes_16.empty() || mv_indexes_32.empty()
+//    <3> !m_is_finished || m_vertex_lookup.empty()
+//
+class CompiledMesh
+{
+public:
+//
+//  FLOATS_PER_VERTEX
+//
+//  The number of floats used to store each vertex.
+//
+	static const unsigned int FLOATS_PER_VERTEX = 8;
+
+//
+//  POSITION_OFFSET
+//  NORMAL_OFFSET
+//  TEXTURE_COORDINATE_OFFSET
+//
+//  The position of each part of a vertex, in floats from the
+//    start of the vertex.
+//
+	static const unsigned int POSITION_OFFSET           = 0;
+	static const unsigned int NORMAL_OFFSET             = 3;
+	static const unsigned int TEXTURE_COORDINATE_OFFSET = 6;
+
+//
+//  MAX_VERTEX_COUNT_16
+//
+//  The largest number of vertexes for which 16-bit indexes are
+//    used.
+//
+	static const unsigned int MAX_VERTEX_COUNT_16 = 0x10000;
+
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To create a new empty CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A new CompiledMesh is created with no ranges
+//               and no vertexes.  It is not finished.
+//
+	CompiledMesh ();
+
+//
+//  isFinished
+//
+//  Purpose: To determine if this CompiledMesh has been
+//           finished.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether finish() has been called.
+//  Side Effect: N/A
+//
+	bool isFinished () const;
+
+//
+//  getVertexCount
+//
+//  Purpose: To determine the number of unique vertexes in this
+//           CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of vertexes stored.
+//  Side Effect: N/A
+//
+	unsigned int getVertexCount () const;
+
+//
+//  getIndexCount
+//
+//  Purpose: To determine the number of indexes in this
+//           CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of indexes stored.  This is 3 times the
+//           number of triangles, and is the number of vertexes
+//           that would be needed without de-duplication.
+//  Side Effect: N/A
+//
+	unsigned int getIndexCount () const;
+
+//
+//  getDeduplicationRatio
+//
+//  Purpose: To determine how much de-duplication reduced the
+//           number of vertexes stored.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: getIndexCount() / getVertexCount(), or 1.0 if there
+//           are no vertexes.
+//  Side Effect: N/A
+//
+	double getDeduplicationRatio () const;
+
+//
+//  isIndex16Bit
+//
+//  Purpose: To determine if the indexes are stored as 16-bit
+//           values.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isFinished()
+//  Returns: Whether the indexes are stored as unsigned shorts.
+//           If not, they are stored as unsigned ints.
+//  Side Effect: N/A
+//
+	bool isIndex16Bit () const;
+
+//
+//  getVertexData
+//
+//  Purpose: To retrieve the interleaved vertex array.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: A pointer to getVertexCount() * FLOATS_PER_VERTEX
+//           floats, or NULL if there are no vertexes.
+//  Side Effect: N/A
+//
+	const float* getVertexData () const;
+
+//
+//  getIndexData
+//
+//  Purpose: To retrieve the index array.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isFinished()
+//  Returns: A pointer to getIndexCount() unsigned shorts if
+//           isIndex16Bit() and unsigned ints otherwise, or NULL
+//           if there are no indexes.
+//  Side Effect: N/A
+//
+	const void* getIndexData () const;
+
+//
+//  getIndex
+//
+//  Purpose: To retrieve one index.
+//  Parameter(s):
+//    <1> index: Which index
+//  Precondition(s):
+//    <1> index < getIndexCount()
+//  Returns: The vertex that index index refers to.
+//  Side Effect: N/A
+//
+	unsigned int getIndex (unsigned int index) const;
+
+//
+//  getByteCount
+//
+//  Purpose: To determine the memory used by the vertex and
+//           index arrays.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isFinished()
+//  Returns: The number of bytes in the arrays.
+//  Side Effect: N/A
+//
+	size_t getByteCount () const;
+
+//
+//  getRangeCount
+//
+//  Purpose: To determine the number of material ranges in this
+//           CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of ranges.
+//  Side Effect: N/A
+//
+	unsigned int getRangeCount () const;
+
+//
+//  getRangeFirstIndex
+//  getRangeIndexCount
+//
+//  Purpose: To determine which indexes are in a material range.
+//  Parameter(s):
+//    <1> range: Which range
+//  Precondition(s):
+//    <1> range < getRangeCount()
+//  Returns: The first index in range range, or the number of
+//           indexes in it.
+//  Side Effect: N/A
+//
+	unsigned int getRangeFirstIndex (unsigned int range) const;
+	unsigned int getRangeIndexCount (unsigned int range) const;
+
+//
+//  getRangeMaterialName
+//  getRangeMaterial
+//
+//  Purpose: To determine the material used for a range.
+//  Parameter(s):
+//    <1> range: Which range
+//  Precondition(s):
+//    <1> range < getRangeCount()
+//  Returns: The name of the material for range range, or a
+//           pointer to it.  If there is no material, the name
+//           is the empty string and the pointer is NULL.
+//  Side Effect: N/A
+//
+	const std::string& getRangeMaterialName (unsigned int range) const;
+	const Material* getRangeMaterial (unsigned int range) const;
+
+#ifndef OBJ_LIBRARY_SHADER_DISPLAY
+//
+//  draw
+//
+//  Purpose: To display this CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isFinished()
+//    <2> !Material::isMaterialActive()
+//  Returns: N/A
+//  Side Effect: Each range of this CompiledMesh is displayed
+//               with its material, in the same way that
+//               ObjModel::draw displays each mesh.  The vertex,
+//               normal, and texture coordinate client arrays
+//               are enabled while drawing and disabled again
+//               afterwards.
+//
+	void draw () const;
+
+//
+//  drawMaterialNone
+//
+//  Purpose: To display this CompiledMesh without materials.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isFinished()
+//  Returns: N/A
+//  Side Effect: All ranges of this CompiledMesh are displayed
+//               with the current OpenGL state.
+//
+	void drawMaterialNone () const;
+
+//
+//  getDisplayList
+//
+//  Purpose: To generate a DisplayList for this CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isFinished()
+//    <2> !Material::isMaterialActive()
+//  Returns: A DisplayList that displays this CompiledMesh as
+//           draw() does.
+//  Side Effect: N/A
+//
+	DisplayList getDisplayList () const;
+#endif  // OBJ_LIBRARY_SHADER_DISPLAY is not defined
+
+//
+//  beginRange
+//
+//  Purpose: To start a new material range.
+//  Parameter(s):
+//    <1> material_name: The name of the material
+//    <2> p_material: A pointer to the material, or NULL
+//  Precondition(s):
+//    <1> !isFinished()
+//  Returns: N/A
+//  Side Effect: A new range is started.  Vertexes added after
+//               this will be displayed with the material.
+//
+	void beginRange (const std::string& material_name,
+	                 const Material* p_material);
+
+//
+//  addVertex
+//
+//  Purpose: To add a triangle corner to the current range.
+//  Parameter(s):
+//    <1> a_vertex: The vertex data, in the layout described
+//                  by the *_OFFSET constants
+//  Precondition(s):
+//    <1> !isFinished()
+//    <2> getRangeCount() > 0
+//    <3> a_vertex != NULL
+//  Returns: N/A
+//  Side Effect: An index is added to the current range.  If an
+//               identical vertex is already stored, the index
+//               refers to it.  Otherwise, the vertex is added.
+//               Every 3 calls form a triangle.
+//
+	void addVertex (const float a_vertex[]);
+
+//
+//  finish
+//
+//  Purpose: To complete building this CompiledMesh.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> !isFinished()
+//    <2> Every range has a multiple of 3 indexes
+//  Returns: N/A
+//  Side Effect: Ranges with no indexes are removed, the indexes
+//               are converted to 16 bits if possible, and the
+//               de-duplication table is discarded.  This
+//               CompiledMesh is marked as finished.
+//
+	void finish ();
+
+//
+//  setArrays
+//
+//  Purpose: To set the vertexes and indexes of this
+//           CompiledMesh from arrays that have already been
+//           compiled, such as ones read from a cache file.
+//  Parameter(s):
+//    <1> a_vertex_data: The interleaved vertexes
+//    <2> vertex_count: The number of vertexes in a_vertex_data
+//    <3> a_index_data: The indexes, as unsigned shorts if
+//                      vertex_count <= MAX_VERTEX_COUNT_16 and
+//                      as unsigned ints otherwise
+//    <4> index_count: The number of indexes in a_index_data
+//  Precondition(s):
+//    <1> !isFinished()
+//    <2> getRangeCount() == 0
+//    <3> getVertexCount() == 0
+//    <4> a_vertex_data != NULL || vertex_count == 0
+//    <5> a_index_data != NULL || index_count == 0
+//    <6> index_count % 3 == 0
+//    <7> Every index is less than vertex_count
+//  Returns: N/A
+//  Side Effect: The arrays are copied into this CompiledMesh
+//               with one allocation each, and it is marked as
+//               finished.  No de-duplication is done.  The
+//               ranges must then be added with addRange.
+//
+	void setArrays (const float a_vertex_data[],
+	                unsigned int vertex_count,
+	                const void* a_index_data,
+	                unsigned int index_count);
+
+//
+//  addRange
+//
+//  Purpose: To add a material range to a CompiledMesh whose
+//           arrays were set with setArrays.
+//  Parameter(s):
+//    <1> material_name: The name of the material
+//    <2> p_material: A pointer to the material, or NULL
+//    <3> first_index: The first index in the range
+//    <4> index_count: The number of indexes in the range
+//  Precondition(s):
+//    <1> isFinished()
+//    <2> index_count > 0
+//    <3> index_count % 3 == 0
+//    <4> first_index + index_count <= getIndexCount()
+//  Returns: N/A
+//  Side Effect: A range is added.  It is displayed with the
+//               material after any existing ranges.
+//
+	void addRange (const std::string& material_name,
+	               const Material* p_material,
+	               unsigned int first_index,
+	               unsigned int index_count);
+
+private:
+//
+//  drawRange
+//
+//  Purpose: To issue the draw call for one range.
+//  Parameter(s):
+//    <1> range: Which range
+//  Precondition(s):
+//    <1> isFinished()
+//    <2> range < getRangeCount()
+//    <3> The client arrays are set up
+//  Returns: N/A
+//  Side Effect: The triangles in range range are displayed.
+//
+	void drawRange (unsigned int range) const;
+
+//
+//  enableArrays
+//  disableArrays
+//
+//  Purpose: To set up or tear down the OpenGL client arrays.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The vertex, normal, and texture coordinate
+//               client arrays are enabled and pointed at
+//               mv_vertex_data, or disabled.
+//
+	void enableArrays () const;
+	static void disableArrays ();
+
+//
+//  invariant
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool invariant () const;
+
+private:
+	//
+	//  Range
+	//
+	//  A record to represent a run of indexes that are
+	//    displayed with one material.
+	//
+	struct Range
+	{
+		std::string m_material_name;
+		const Material* mp_material;
+		unsigned int m_first_index;
+		unsigned int m_index_count;
+	};
+
+	//
+	//  VertexKey
+	//
+	//  A record to compare vertexes during de-duplication.
+	//    Vertexes are equal if their floats are bitwise equal.
+	//
+	struct VertexKey
+	{
+		float ma_data[FLOATS_PER_VERTEX];
+
+		bool operator== (const VertexKey& other) const;
+	};
+
+	//
+	//  VertexKeyHash
+	//
+	//  A function object to hash a VertexKey.
+	//
+	struct VertexKeyHash
+	{
+		size_t operator() (const VertexKey& key) const;
+	};
+
+private:
+	std::vector<float> mv_vertex_data;
+	std::vector<unsigned short> mv_indexes_16;
+	std::vector<unsigned int> mv_indexes_32;
+	std::vector<Range> mv_ranges;
+	std::unordered_map<VertexKey, unsigned int, VertexKeyHash> m_vertex_lookup;
+	bool m_is_finished;
+};
+
+
+
+}  // end of namespace ObjLibrary
+
+#endif
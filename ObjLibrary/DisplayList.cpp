@@ -1,6 +1,8 @@
 //
 //  DisplayList.cpp
 //
+//  The functions that call OpenGL are in DisplayListDraw.cpp.
+//
 //  This file is part of the ObjLibrary, by Richard Hamilton,
 //    which is copyright Hamilton 2009-2024.
 // 
@@ -20,8 +22,6 @@
 #include <cassert>
 #include <cstddef>	// for NULL
 
-#define GL_SILENCE_DEPRECATION
-#include "../GetGlut.h"
 #include "DisplayList.h"
 
 using namespace ObjLibrary;
@@ -32,15 +32,6 @@ namespace
 
 
 
-bool DisplayList :: isGlutInitialized ()
-{
-#ifdef GLUT_INIT_STATE
-	return glutGet(GLUT_INIT_STATE) == 1;
-#else
-	return true;
-#endif
-}
-
 bool DisplayList :: isDisabledForExit ()
 {
 	return g_is_disabled_for_exit;
@@ -115,15 +106,6 @@ bool DisplayList :: isReady() const
 	return (mp_data != NULL && mp_data->m_usages > 0);
 }
 
-void DisplayList :: draw () const
-{
-	assert(isGlutInitialized());
-	assert(!isDisabledForExit());
-	assert(isReady());
-
-	glCallList(mp_data->m_list_id);
-}
-
 
 
 void DisplayList :: makeEmpty ()
@@ -131,7 +113,7 @@ void DisplayList :: makeEmpty ()
 	switch(getState())
 	{
 	case PARTIAL:
-		end();
+		mp_data->mp_end_list(*this);
 		break;
 	case READY:
 		assert(mp_data->m_usages > 0);
@@ -139,7 +121,7 @@ void DisplayList :: makeEmpty ()
 		if(mp_data->m_usages == 0)
 		{
 			if(!isDisabledForExit())
-				glDeleteLists(mp_data->m_list_id, 1);
+				mp_data->mp_delete_list(mp_data->m_list_id);
 			delete mp_data;
 		}
 		mp_data = NULL;
@@ -149,40 +131,6 @@ void DisplayList :: makeEmpty ()
 	assert(isEmpty());
 }
 
-void DisplayList :: begin ()
-{
-	assert(isGlutInitialized());
-	assert(!isDisabledForExit());
-	assert(!isPartial());
-
-	if(getState() == READY)
-		makeEmpty();
-
-	assert(isEmpty());
-
-	mp_data = new InnerData();
-	mp_data->m_usages = 0;
-	mp_data->m_list_id = glGenLists(1);
-
-	glNewList(mp_data->m_list_id, GL_COMPILE);
-
-	assert(getState() == PARTIAL);
-}
-
-void DisplayList :: end ()
-{
-	assert(isGlutInitialized());
-	assert(!isDisabledForExit());
-	assert(isPartial());
-
-	glEndList();
-
-	assert(mp_data->m_usages == 0);
-	mp_data->m_usages = 1;
-
-	assert(isReady());
-}
-
 
 
 void DisplayList :: copy (const DisplayList& original)
@@ -353,12 +353,17 @@ private:
 	//    display list.  The list id and a usage count are
 	//    stored.  A special value of 0 usages is used to
 	//    indicate that the display list is only partially
-	//    specified.
+	//    specified.  The functions to finish and to delete
+	//    the list are set by begin(), so that code that only
+	//    copies and destroys DisplayLists does not need to
+	//    link with OpenGL.
 	//
 	struct InnerData
 	{
 		unsigned int m_list_id;
 		unsigned int m_usages;
+		void (*mp_end_list)(DisplayList& r_list);
+		void (*mp_delete_list)(unsigned int list_id);
 	};
 
 private:
@@ -0,0 +1,99 @@
+//
+//  DisplayListDraw.cpp
+//
+//  The DisplayList functions that call OpenGL.
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#include <cassert>
+#include <cstddef>	// for NULL
+
+#define GL_SILENCE_DEPRECATION
+#include "../GetGlut.h"
+#include "DisplayList.h"
+
+using namespace ObjLibrary;
+namespace
+{
+	void endList (DisplayList& r_list)
+	{
+		r_list.end();
+	}
+
+	void deleteList (unsigned int list_id)
+	{
+		glDeleteLists(list_id, 1);
+	}
+}
+
+
+
+bool DisplayList :: isGlutInitialized ()
+{
+#ifdef GLUT_INIT_STATE
+	return glutGet(GLUT_INIT_STATE) == 1;
+#else
+	return true;
+#endif
+}
+
+
+
+void DisplayList :: draw () const
+{
+	assert(isGlutInitialized());
+	assert(!isDisabledForExit());
+	assert(isReady());
+
+	glCallList(mp_data->m_list_id);
+}
+
+void DisplayList :: begin ()
+{
+	assert(isGlutInitialized());
+	assert(!isDisabledForExit());
+	assert(!isPartial());
+
+	if(getState() == READY)
+		makeEmpty();
+
+	assert(isEmpty());
+
+	mp_data = new InnerData();
+	mp_data->m_usages = 0;
+	mp_data->m_list_id = glGenLists(1);
+	mp_data->mp_end_list    = endList;
+	mp_data->mp_delete_list = deleteList;
+
+	glNewList(mp_data->m_list_id, GL_COMPILE);
+
+	assert(getState() == PARTIAL);
+}
+
+void DisplayList :: end ()
+{
+	assert(isGlutInitialized());
+	assert(!isDisabledForExit());
+	assert(isPartial());
+
+	glEndList();
+
+	assert(mp_data->m_usages == 0);
+	mp_data->m_usages = 1;
+
+	assert(isReady());
+}
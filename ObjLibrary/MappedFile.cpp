@@ -0,0 +1,265 @@
+//
+//  MappedFile.cpp
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#include <cassert>
+#include <cstddef>	// for NULL
+#include <string>
+#include <vector>
+#include <fstream>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else	// Posix
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#include "MappedFile.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	//
+	//  mapFile
+	//
+	//  Purpose: To map the contents of the specified file into
+	//           memory.
+	//  Parameter(s):
+	//    <1> filename: The name of the file
+	//    <2> r_size: The size of the file
+	//  Precondition(s): N/A
+	//  Returns: A pointer to the start of the mapping, or NULL
+	//           if the file could not be mapped.  Empty files
+	//           are never mapped.
+	//  Side Effect: If the file is mapped, r_size is set to its
+	//               size.  No file handles are left open either
+	//               way.
+	//
+	void* mapFile (const string& filename, size_t& r_size)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if(file == INVALID_HANDLE_VALUE)
+			return NULL;
+
+		void* p_view = NULL;
+		LARGE_INTEGER size;
+		if(GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+		   (unsigned long long)(size.QuadPart) <= (size_t)(-1))
+		{
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if(mapping != NULL)
+			{
+				// the view keeps the mapping alive after its handle is closed
+				p_view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+				if(p_view != NULL)
+					r_size = (size_t)(size.QuadPart);
+			}
+		}
+		CloseHandle(file);
+		return p_view;
+#else	// Posix
+		int file = ::open(filename.c_str(), O_RDONLY);
+		if(file < 0)
+			return NULL;
+
+		void* p_view = NULL;
+		struct stat status;
+		if(fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+		{
+			p_view = mmap(NULL, (size_t)(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if(p_view == MAP_FAILED)
+				p_view = NULL;
+			else
+			{
+				r_size = (size_t)(status.st_size);
+				madvise(p_view, r_size, MADV_SEQUENTIAL);
+			}
+		}
+		::close(file);
+		return p_view;
+#endif
+	}
+
+	//
+	//  unmapFile
+	//
+	//  Purpose: To release a mapping made by mapFile.
+	//  Parameter(s):
+	//    <1> p_view: The start of the mapping
+	//    <2> size: The size of the mapping
+	//  Precondition(s):
+	//    <1> p_view != NULL
+	//  Returns: N/A
+	//  Side Effect: The mapping is released.
+	//
+	void unmapFile (void* p_view, size_t size)
+	{
+		assert(p_view != NULL);
+
+#ifdef _WIN32
+		UnmapViewOfFile(p_view);
+#else	// Posix
+		munmap(p_view, size);
+#endif
+	}
+
+}  // end of anonymous namespace
+
+
+
+MappedFile :: MappedFile ()
+		: ma_data(NULL),
+		  m_size(0),
+		  m_is_open(false),
+		  mp_mapping(NULL),
+		  mv_buffer()
+{
+	assert(invariant());
+}
+
+MappedFile :: MappedFile (const string& filename)
+		: ma_data(NULL),
+		  m_size(0),
+		  m_is_open(false),
+		  mp_mapping(NULL),
+		  mv_buffer()
+{
+	open(filename);
+
+	assert(invariant());
+}
+
+MappedFile :: ~MappedFile ()
+{
+	close();
+}
+
+
+
+bool MappedFile :: isOpen () const
+{
+	return m_is_open;
+}
+
+bool MappedFile :: isMapped () const
+{
+	return mp_mapping != NULL;
+}
+
+const char* MappedFile :: getData () const
+{
+	assert(isOpen());
+
+	return ma_data;
+}
+
+size_t MappedFile :: getSize () const
+{
+	assert(isOpen());
+
+	return m_size;
+}
+
+
+
+bool MappedFile :: open (const string& filename)
+{
+	close();
+	assert(!isOpen());
+
+	size_t size = 0;
+	void* p_view = mapFile(filename, size);
+	if(p_view != NULL)
+	{
+		mp_mapping = p_view;
+		ma_data    = (const char*)(p_view);
+		m_size     = size;
+		m_is_open  = true;
+	}
+	else
+		readIntoBuffer(filename);
+
+	assert(invariant());
+	return isOpen();
+}
+
+void MappedFile :: close ()
+{
+	if(mp_mapping != NULL)
+		unmapFile(mp_mapping, m_size);
+	mp_mapping = NULL;
+	vector<char>().swap(mv_buffer);
+	ma_data   = NULL;
+	m_size    = 0;
+	m_is_open = false;
+
+	assert(invariant());
+}
+
+
+
+bool MappedFile :: readIntoBuffer (const string& filename)
+{
+	assert(!isOpen());
+
+	ifstream input_file(filename.c_str(), ios::in | ios::binary);
+	if(!input_file.is_open())
+		return false;
+
+	input_file.seekg(0, ios::end);
+	streamoff size = input_file.tellg();
+	input_file.seekg(0, ios::beg);
+
+	if(size > 0)
+	{
+		mv_buffer.resize((size_t)(size));
+		input_file.read(mv_buffer.data(), size);
+		mv_buffer.resize((size_t)(input_file.gcount()));
+	}
+	else if(size < 0)
+	{
+		// not seekable, so read it a piece at a time
+		input_file.clear();
+		char a_piece[4096];
+		while(input_file.read(a_piece, sizeof(a_piece)) || input_file.gcount() > 0)
+			mv_buffer.insert(mv_buffer.end(), a_piece, a_piece + input_file.gcount());
+	}
+
+	ma_data   = mv_buffer.empty() ? NULL : mv_buffer.data();
+	m_size    = mv_buffer.size();
+	m_is_open = true;
+
+	assert(invariant());
+	return true;
+}
+
+bool MappedFile :: invariant () const
+{
+	if(ma_data == NULL && m_size != 0) return false;
+	if(mp_mapping != NULL && !mv_buffer.empty()) return false;
+	return true;
+}
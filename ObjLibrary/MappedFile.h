@@ -0,0 +1,217 @@
+//
+//  MappedFile.h
+//
+//  A class to give read-only access to the contents of a file
+//    in memory.
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#ifndef OBJ_LIBRARY_MAPPED_FILE_H
+#define OBJ_LIBRARY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+
+namespace ObjLibrary
+{
+
+//
+//  MappedFile
+//
+//  A class to represent the contents of a file mapped into
+//    memory, so that they can be parsed in place without being
+//    copied into strings.  The file is mapped with
+//    MapViewOfFile on Windows and mmap elsewhere.  If the file
+//    cannot be mapped (e.g. because it is empty or on a device
+//    that does not support mapping), it is read into a buffer
+//    instead, so the contents are available either way.
+//
+//  The contents are not null-terminated, and must not be
+//    changed.  A MappedFile cannot be copied.
+//
+//  Class Invariant:
+//    <1> ma_data != NULL || m_size == 0
+//    <2> mp_mapping == NULL || mv_buffer.empty()
+//
+class MappedFile
+{
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To create a new MappedFile with no file open.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A new MappedFile is created.  It is not open.
+//
+	MappedFile ();
+
+//
+//  Constructor
+//
+//  Purpose: To create a new MappedFile for the specified file.
+//  Parameter(s):
+//    <1> filename: The name of the file to open
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A new MappedFile is created and file filename
+//               is opened, as if by the open function.
+//
+	MappedFile (const std::string& filename);
+
+//
+//  Destructor
+//
+//  Purpose: To safely destroy this MappedFile.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: Any file that is open is closed.
+//
+	~MappedFile ();
+
+//
+//  isOpen
+//
+//  Purpose: To determine if this MappedFile has a file open.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether a file is open.
+//  Side Effect: N/A
+//
+	bool isOpen () const;
+
+//
+//  isMapped
+//
+//  Purpose: To determine if the contents of this MappedFile
+//           are mapped from the file, as opposed to being
+//           copied into a buffer.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the file contents are memory-mapped.
+//  Side Effect: N/A
+//
+	bool isMapped () const;
+
+//
+//  getData
+//
+//  Purpose: To retrieve the contents of the file.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isOpen()
+//  Returns: A pointer to the first byte of the file.  If the
+//           file is empty, NULL is returned.
+//  Side Effect: N/A
+//
+	const char* getData () const;
+
+//
+//  getSize
+//
+//  Purpose: To determine the size of the file.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isOpen()
+//  Returns: The number of bytes in the file.
+//  Side Effect: N/A
+//
+	size_t getSize () const;
+
+//
+//  open
+//
+//  Purpose: To open the specified file.
+//  Parameter(s):
+//    <1> filename: The name of the file to open
+//  Precondition(s): N/A
+//  Returns: Whether the file could be opened.
+//  Side Effect: Any file that is open is closed.  Then file
+//               filename is opened and its contents are made
+//               available.  If the file cannot be opened, this
+//               MappedFile is left closed.
+//
+	bool open (const std::string& filename);
+
+//
+//  close
+//
+//  Purpose: To close the file for this MappedFile.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: Any file that is open is closed, and pointers
+//               returned by getData become invalid.
+//
+	void close ();
+
+private:
+//
+//  Copy Constructor
+//  Assignment Operator
+//
+//  These functions are private and not implemented, so a
+//    MappedFile cannot be copied.
+//
+	MappedFile (const MappedFile& original);
+	MappedFile& operator= (const MappedFile& original);
+
+//
+//  readIntoBuffer
+//
+//  Purpose: To read the specified file into the buffer for
+//           this MappedFile.
+//  Parameter(s):
+//    <1> filename: The name of the file to read
+//  Precondition(s):
+//    <1> !isOpen()
+//  Returns: Whether the file could be read.
+//  Side Effect: The contents of file filename are copied into
+//               the buffer and this MappedFile is opened with
+//               them.
+//
+	bool readIntoBuffer (const std::string& filename);
+
+//
+//  invariant
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool invariant () const;
+
+private:
+	const char* ma_data;
+	size_t m_size;
+	bool m_is_open;
+	void* mp_mapping;
+	std::vector<char> mv_buffer;
+};
+
+
+
+}  // end of namespace ObjLibrary
+
+#endif
@@ -0,0 +1,639 @@
+//
+//  MeshCache.cpp
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#include <cassert>
+#include <cstddef>	// for NULL
+#include <cstdio>	// for remove
+#include <cstring>	// for memcpy
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "ObjStringParsing.h"
+#include "MappedFile.h"
+#include "Material.h"
+#include "MtlLibrary.h"
+#include "MtlLibraryManager.h"
+#include "ObjModel.h"
+#include "CompiledMesh.h"
+#include "MeshCache.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	const string OBJ_EXTENSION   = ".obj";
+	const string CACHE_EXTENSION = ".objb";
+
+	//
+	//  MAGIC
+	//  BYTE_ORDER_MARK
+	//
+	//  The values that every cache file starts with.  A file
+	//    written in a different byte order will not have
+	//    BYTE_ORDER_MARK in the right place.
+	//
+	const char MAGIC[4] = {	'O', 'B', 'J', 'B'	};
+	const unsigned int BYTE_ORDER_MARK = 0x01020304;
+
+	//
+	//  FileHeader
+	//
+	//  A record to represent the start of a cache file.  It is
+	//    followed by:
+	//    <1> m_range_count RangeRecords
+	//    <2> m_library_count StringRecords for the material
+	//        library names
+	//    <3> m_vertex_count * CompiledMesh::FLOATS_PER_VERTEX
+	//        floats
+	//    <4> m_index_count indexes, as unsigned shorts if
+	//        m_vertex_count <= CompiledMesh::MAX_VERTEX_COUNT_16
+	//        and as unsigned ints otherwise
+	//    <5> m_string_byte_count characters, starting with the
+	//        m_source_name_length characters of the OBJ file
+	//        name
+	//  Every part is a multiple of 4 bytes long except the
+	//    last two, so the floats are aligned.
+	//
+	struct FileHeader
+	{
+		char ma_magic[4];
+		unsigned int m_version;
+		unsigned int m_byte_order;
+		unsigned int m_source_name_length;
+		unsigned long long m_source_size;
+		long long m_source_time;
+		unsigned long long m_source_hash;
+		unsigned int m_vertex_count;
+		unsigned int m_index_count;
+		unsigned int m_range_count;
+		unsigned int m_library_count;
+		unsigned int m_string_byte_count;
+		unsigned int m_padding;
+	};
+	static_assert(sizeof(FileHeader) == 64, "FileHeader must not contain padding");
+
+	//
+	//  StringRecord
+	//
+	//  A record to represent a string in the string section of
+	//    a cache file.
+	//
+	struct StringRecord
+	{
+		unsigned int m_offset;
+		unsigned int m_length;
+	};
+
+	//
+	//  RangeRecord
+	//
+	//  A record to represent a material range in a cache file.
+	//
+	struct RangeRecord
+	{
+		unsigned int m_first_index;
+		unsigned int m_index_count;
+		StringRecord m_material_name;
+	};
+
+	//
+	//  SourceKey
+	//
+	//  A record to represent what an OBJ file is identified by
+	//    in its cache file.
+	//
+	struct SourceKey
+	{
+		unsigned long long m_size;
+		long long m_time;
+	};
+
+	// models may be loaded on more than one thread at once
+	atomic<unsigned int> cache_hit_count(0);
+	atomic<unsigned int> cache_miss_count(0);
+
+
+
+	//
+	//  getSourceKey
+	//
+	//  Purpose: To determine the size and modification time of
+	//           a file.
+	//  Parameter(s):
+	//    <1> filename: The name of the file
+	//    <2> r_key: The SourceKey to set
+	//  Precondition(s): N/A
+	//  Returns: Whether the file exists.
+	//  Side Effect: If the file exists, r_key is set to its size
+	//               and modification time.
+	//
+	bool getSourceKey (const string& filename, SourceKey& r_key)
+	{
+		struct stat info;
+		if(stat(filename.c_str(), &info) != 0)
+			return false;
+		r_key.m_size = (unsigned long long)(info.st_size);
+		r_key.m_time = (long long)(info.st_mtime);
+		return true;
+	}
+
+	//
+	//  getContentHash
+	//
+	//  Purpose: To calculate a hash of the contents of a file.
+	//  Parameter(s):
+	//    <1> filename: The name of the file
+	//  Precondition(s): N/A
+	//  Returns: The 64-bit FNV-1a hash of the contents of file
+	//           filename.  If the file cannot be opened, 0 is
+	//           returned.
+	//  Side Effect: N/A
+	//
+	unsigned long long getContentHash (const string& filename)
+	{
+		MappedFile file;
+		if(!file.open(filename))
+			return 0;
+
+		unsigned long long hash = 14695981039346656037ull;
+		const unsigned char* a_data = (const unsigned char*)(file.getData());
+		for(size_t i = 0; i < file.getSize(); i++)
+			hash = (hash ^ a_data[i]) * 1099511628211ull;
+		return hash;
+	}
+
+	//
+	//  getIndexBytes
+	//
+	//  Purpose: To determine the number of bytes used by an
+	//           array of a given number of indexes in a cache
+	//           file.
+	//  Parameter(s):
+	//    <1> vertex_count: The number of vertexes
+	//    <2> index_count: The number of indexes
+	//  Precondition(s): N/A
+	//  Returns: The size of the index array.
+	//  Side Effect: N/A
+	//
+	size_t getIndexBytes (unsigned int vertex_count, unsigned int index_count)
+	{
+		if(vertex_count <= CompiledMesh::MAX_VERTEX_COUNT_16)
+			return index_count * sizeof(unsigned short);
+		else
+			return index_count * sizeof(unsigned int);
+	}
+
+	//
+	//  isStringInSection
+	//
+	//  Purpose: To determine if a StringRecord refers to
+	//           characters inside the string section.
+	//  Parameter(s):
+	//    <1> record: The StringRecord
+	//    <2> string_byte_count: The size of the string section
+	//  Precondition(s): N/A
+	//  Returns: Whether all of record is in the string section.
+	//  Side Effect: N/A
+	//
+	bool isStringInSection (const StringRecord& record, unsigned int string_byte_count)
+	{
+		return record.m_offset <= string_byte_count &&
+		       record.m_length <= string_byte_count - record.m_offset;
+	}
+
+	//
+	//  readHeader
+	//
+	//  Purpose: To check that a mapped file is a complete cache
+	//           file for the specified OBJ file.
+	//  Parameter(s):
+	//    <1> file: The mapped cache file
+	//    <2> filename: The name of the OBJ file
+	//    <3> r_header: The FileHeader to set
+	//  Precondition(s):
+	//    <1> file.isOpen()
+	//  Returns: Whether file is a cache file from this version
+	//           for an OBJ file named filename, with every part
+	//           present.  The source key is not checked.
+	//  Side Effect: If true is returned, r_header is set to the
+	//               header of the cache file.
+	//
+	bool readHeader (const MappedFile& file,
+	                 const string& filename,
+	                 FileHeader& r_header)
+	{
+		assert(file.isOpen());
+
+		if(file.getSize() < sizeof(FileHeader))
+			return false;
+		memcpy(&r_header, file.getData(), sizeof(FileHeader));
+
+		if(memcmp(r_header.ma_magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		   r_header.m_version    != MeshCache::VERSION ||
+		   r_header.m_byte_order != BYTE_ORDER_MARK)
+		{
+			return false;
+		}
+		if(r_header.m_index_count % 3 != 0 ||
+		   r_header.m_vertex_count > 0xFFFFFFFFu / CompiledMesh::FLOATS_PER_VERTEX)
+		{
+			return false;
+		}
+
+		unsigned long long expected_size = sizeof(FileHeader) +
+		                                   (unsigned long long)(r_header.m_range_count)   * sizeof(RangeRecord) +
+		                                   (unsigned long long)(r_header.m_library_count) * sizeof(StringRecord) +
+		                                   (unsigned long long)(r_header.m_vertex_count)  * CompiledMesh::FLOATS_PER_VERTEX * sizeof(float) +
+		                                   getIndexBytes(r_header.m_vertex_count, r_header.m_index_count) +
+		                                   r_header.m_string_byte_count;
+		if(expected_size != file.getSize())
+			return false;
+
+		if(r_header.m_source_name_length != filename.size() ||
+		   r_header.m_source_name_length > r_header.m_string_byte_count)
+		{
+			return false;
+		}
+		const char* a_strings = file.getData() + file.getSize() - r_header.m_string_byte_count;
+		return filename.compare(0, string::npos, a_strings, r_header.m_source_name_length) == 0;
+	}
+
+	//
+	//  findMaterial
+	//
+	//  Purpose: To find a material in a list of material
+	//           libraries.
+	//  Parameter(s):
+	//    <1> v_libraries: The material libraries
+	//    <2> material_name: The name of the material
+	//  Precondition(s): N/A
+	//  Returns: A pointer to the material in the last library
+	//           that has one named material_name, or NULL if
+	//           there is no such material.  This is the same
+	//           material that ObjModel chooses.
+	//  Side Effect: N/A
+	//
+	const Material* findMaterial (const vector<MtlLibrary*>& v_libraries,
+	                              const string& material_name)
+	{
+		if(material_name == "")
+			return NULL;
+
+		const Material* p_material = NULL;
+		for(unsigned int i = 0; i < v_libraries.size(); i++)
+		{
+			unsigned int index = v_libraries[i]->getMaterialIndex(material_name);
+			if(index != MtlLibrary::NO_SUCH_MATERIAL)
+				p_material = v_libraries[i]->getMaterial(index);
+		}
+		return p_material;
+	}
+
+	//
+	//  readMesh
+	//
+	//  Purpose: To copy the mesh out of a cache file.
+	//  Parameter(s):
+	//    <1> file: The mapped cache file
+	//    <2> header: The header of the cache file
+	//    <3> r_mesh: The CompiledMesh to set
+	//    <4> r_logstream: The stream to write errors to
+	//  Precondition(s):
+	//    <1> readHeader(file, <filename>, header)
+	//  Returns: Whether the cache file contained a valid mesh.
+	//  Side Effect: If true is returned, r_mesh is set to the
+	//               mesh in the cache file and its material
+	//               libraries are loaded.  Otherwise, r_mesh is
+	//               unchanged.
+	//
+	bool readMesh (const MappedFile& file,
+	               const FileHeader& header,
+	               CompiledMesh& r_mesh,
+	               ostream& r_logstream)
+	{
+		const char* a_current = file.getData() + sizeof(FileHeader);
+		const char* a_ranges = a_current;
+		a_current += header.m_range_count * sizeof(RangeRecord);
+		const char* a_libraries = a_current;
+		a_current += header.m_library_count * sizeof(StringRecord);
+		const float* a_vertex_data = (const float*)(a_current);
+		a_current += header.m_vertex_count * CompiledMesh::FLOATS_PER_VERTEX * sizeof(float);
+		const void* a_index_data = a_current;
+		const char* a_strings = file.getData() + file.getSize() - header.m_string_byte_count;
+
+		// check everything before using any of it
+		vector<RangeRecord> v_ranges(header.m_range_count);
+		if(!v_ranges.empty())
+			memcpy(v_ranges.data(), a_ranges, v_ranges.size() * sizeof(RangeRecord));
+		for(unsigned int r = 0; r < v_ranges.size(); r++)
+		{
+			if(v_ranges[r].m_index_count == 0 ||
+			   v_ranges[r].m_index_count % 3 != 0 ||
+			   v_ranges[r].m_first_index > header.m_index_count ||
+			   v_ranges[r].m_index_count > header.m_index_count - v_ranges[r].m_first_index ||
+			   !isStringInSection(v_ranges[r].m_material_name, header.m_string_byte_count))
+			{
+				return false;
+			}
+		}
+
+		vector<StringRecord> v_libraries(header.m_library_count);
+		if(!v_libraries.empty())
+			memcpy(v_libraries.data(), a_libraries, v_libraries.size() * sizeof(StringRecord));
+		for(unsigned int i = 0; i < v_libraries.size(); i++)
+			if(!isStringInSection(v_libraries[i], header.m_string_byte_count))
+				return false;
+
+		if(header.m_vertex_count <= CompiledMesh::MAX_VERTEX_COUNT_16)
+		{
+			const unsigned short* a_indexes = (const unsigned short*)(a_index_data);
+			for(unsigned int i = 0; i < header.m_index_count; i++)
+				if(a_indexes[i] >= header.m_vertex_count)
+					return false;
+		}
+		else
+		{
+			const unsigned int* a_indexes = (const unsigned int*)(a_index_data);
+			for(unsigned int i = 0; i < header.m_index_count; i++)
+				if(a_indexes[i] >= header.m_vertex_count)
+					return false;
+		}
+
+		// the cache file is good, so load the mesh
+		vector<MtlLibrary*> v_mtl_libraries(v_libraries.size());
+		for(unsigned int i = 0; i < v_libraries.size(); i++)
+		{
+			string library_name(a_strings + v_libraries[i].m_offset, v_libraries[i].m_length);
+			v_mtl_libraries[i] = &(MtlLibraryManager::get(library_name, r_logstream));
+		}
+
+		r_mesh = CompiledMesh();
+		r_mesh.setArrays(header.m_vertex_count == 0 ? NULL : a_vertex_data, header.m_vertex_count,
+		                 header.m_index_count  == 0 ? NULL : a_index_data,  header.m_index_count);
+		for(unsigned int r = 0; r < v_ranges.size(); r++)
+		{
+			string material_name(a_strings + v_ranges[r].m_material_name.m_offset,
+			                     v_ranges[r].m_material_name.m_length);
+			r_mesh.addRange(material_name, findMaterial(v_mtl_libraries, material_name),
+			                v_ranges[r].m_first_index, v_ranges[r].m_index_count);
+		}
+		return true;
+	}
+
+	//
+	//  addString
+	//
+	//  Purpose: To add a string to the string section being
+	//           built for a cache file.
+	//  Parameter(s):
+	//    <1> r_strings: The string section
+	//    <2> str: The string to add
+	//  Precondition(s): N/A
+	//  Returns: A StringRecord for str.
+	//  Side Effect: str is added to the end of r_strings.
+	//
+	StringRecord addString (string& r_strings, const string& str)
+	{
+		StringRecord record;
+		record.m_offset = (unsigned int)(r_strings.size());
+		record.m_length = (unsigned int)(str.size());
+		r_strings += str;
+		return record;
+	}
+
+	//
+	//  writeCache
+	//
+	//  Purpose: To write a cache file.
+	//  Parameter(s):
+	//    <1> cache_filename: The name of the cache file
+	//    <2> filename: The name of the OBJ file
+	//    <3> key: The size and time of the OBJ file
+	//    <4> hash: The content hash of the OBJ file
+	//    <5> mesh: The compiled mesh for the OBJ file
+	//    <6> v_library_names: The names of the material
+	//                         libraries for the OBJ file,
+	//                         including their paths
+	//  Precondition(s):
+	//    <1> mesh.isFinished()
+	//  Returns: Whether the cache file could be written.
+	//  Side Effect: File cache_filename is replaced with a cache
+	//               file for mesh.  If it cannot be written
+	//               completely, it is removed.
+	//
+	bool writeCache (const string& cache_filename,
+	                 const string& filename,
+	                 const SourceKey& key,
+	                 unsigned long long hash,
+	                 const CompiledMesh& mesh,
+	                 const vector<string>& v_library_names)
+	{
+		assert(mesh.isFinished());
+
+		string strings = filename;
+
+		vector<RangeRecord> v_ranges(mesh.getRangeCount());
+		for(unsigned int r = 0; r < mesh.getRangeCount(); r++)
+		{
+			v_ranges[r].m_first_index   = mesh.getRangeFirstIndex(r);
+			v_ranges[r].m_index_count   = mesh.getRangeIndexCount(r);
+			v_ranges[r].m_material_name = addString(strings, mesh.getRangeMaterialName(r));
+		}
+
+		vector<StringRecord> v_libraries(v_library_names.size());
+		for(unsigned int i = 0; i < v_library_names.size(); i++)
+			v_libraries[i] = addString(strings, v_library_names[i]);
+
+		FileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.ma_magic, MAGIC, sizeof(MAGIC));
+		header.m_version            = MeshCache::VERSION;
+		header.m_byte_order         = BYTE_ORDER_MARK;
+		header.m_source_name_length = (unsigned int)(filename.size());
+		header.m_source_size        = key.m_size;
+		header.m_source_time        = key.m_time;
+		header.m_source_hash        = hash;
+		header.m_vertex_count       = mesh.getVertexCount();
+		header.m_index_count        = mesh.getIndexCount();
+		header.m_range_count        = (unsigned int)(v_ranges.size());
+		header.m_library_count      = (unsigned int)(v_libraries.size());
+		header.m_string_byte_count  = (unsigned int)(strings.size());
+
+		ofstream output_file(cache_filename.c_str(), ios::out | ios::binary | ios::trunc);
+		if(!output_file.is_open())
+			return false;
+
+		output_file.write((const char*)(&header), sizeof(header));
+		if(!v_ranges.empty())
+			output_file.write((const char*)(v_ranges.data()), v_ranges.size() * sizeof(RangeRecord));
+		if(!v_libraries.empty())
+			output_file.write((const char*)(v_libraries.data()), v_libraries.size() * sizeof(StringRecord));
+		if(mesh.getVertexCount() > 0)
+			output_file.write((const char*)(mesh.getVertexData()), mesh.getVertexCount() * CompiledMesh::FLOATS_PER_VERTEX * sizeof(float));
+		if(mesh.getIndexCount() > 0)
+			output_file.write((const char*)(mesh.getIndexData()), getIndexBytes(mesh.getVertexCount(), mesh.getIndexCount()));
+		output_file.write(strings.data(), strings.size());
+		output_file.close();
+
+		if(!output_file)
+		{
+			remove(cache_filename.c_str());
+			return false;
+		}
+		return true;
+	}
+
+}  // end of anonymous namespace
+
+
+
+string MeshCache :: getCacheFileName (const string& filename)
+{
+	if(filename.size() >= OBJ_EXTENSION.size() &&
+	   filename.compare(filename.size() - OBJ_EXTENSION.size(), OBJ_EXTENSION.size(), OBJ_EXTENSION) == 0)
+	{
+		return filename.substr(0, filename.size() - OBJ_EXTENSION.size()) + CACHE_EXTENSION;
+	}
+	return filename + CACHE_EXTENSION;
+}
+
+bool MeshCache :: isCacheCurrent (const string& filename)
+{
+	SourceKey key;
+	if(!getSourceKey(filename, key))
+		return false;
+
+	MappedFile cache_file;
+	FileHeader header;
+	if(!cache_file.open(getCacheFileName(filename)) ||
+	   !readHeader(cache_file, filename, header))
+	{
+		return false;
+	}
+
+	if(header.m_source_size == key.m_size && header.m_source_time == key.m_time)
+		return true;
+	return header.m_source_size == key.m_size &&
+	       header.m_source_hash == getContentHash(filename);
+}
+
+bool MeshCache :: load (const string& filename,
+                        CompiledMesh& r_mesh)
+{
+	assert(ObjStringParsing::isValidFilenameWithPath(filename));
+
+	return load(filename, r_mesh, cerr);
+}
+
+bool MeshCache :: load (const string& filename,
+                        CompiledMesh& r_mesh,
+                        ostream& r_logstream)
+{
+	assert(ObjStringParsing::isValidFilenameWithPath(filename));
+
+	string cache_filename = getCacheFileName(filename);
+
+	SourceKey key;
+	bool is_source_found = getSourceKey(filename, key);
+	unsigned long long hash = 0;
+	bool is_hash_known = false;
+
+	if(is_source_found)
+	{
+		MappedFile cache_file;
+		FileHeader header;
+		if(cache_file.open(cache_filename) &&
+		   readHeader(cache_file, filename, header))
+		{
+			bool is_current = false;
+			if(header.m_source_size == key.m_size && header.m_source_time == key.m_time)
+				is_current = true;
+			else if(header.m_source_size == key.m_size)
+			{
+				// touched but maybe not changed, e.g. by a checkout
+				hash = getContentHash(filename);
+				is_hash_known = true;
+				is_current = (header.m_source_hash == hash);
+			}
+
+			if(is_current && readMesh(cache_file, header, r_mesh, r_logstream))
+			{
+				cache_hit_count++;
+				if(header.m_source_time != key.m_time)
+				{
+					// record the new time so the hash is not needed next time
+					vector<string> v_library_names(header.m_library_count);
+					const char* a_strings = cache_file.getData() + cache_file.getSize() - header.m_string_byte_count;
+					const StringRecord* a_libraries = (const StringRecord*)(cache_file.getData() + sizeof(FileHeader) + header.m_range_count * sizeof(RangeRecord));
+					for(unsigned int i = 0; i < v_library_names.size(); i++)
+						v_library_names[i].assign(a_strings + a_libraries[i].m_offset, a_libraries[i].m_length);
+					cache_file.close();
+					writeCache(cache_filename, filename, key, hash, r_mesh, v_library_names);
+				}
+				return true;
+			}
+		}
+	}
+
+	// no usable cache file, so load the OBJ file
+	cache_miss_count++;
+	ObjModel model;
+	model.load(filename, r_logstream);
+	if(!model.isLoadedSuccessfully())
+	{
+		r_mesh = CompiledMesh();
+		r_mesh.finish();
+		return false;
+	}
+	r_mesh = model.getCompiledMesh();
+
+	if(is_source_found)
+	{
+		vector<string> v_library_names(model.getMaterialLibraryCount());
+		for(unsigned int i = 0; i < v_library_names.size(); i++)
+			v_library_names[i] = model.getMaterialLibraryNameWithPath(i);
+
+		if(!is_hash_known)
+			hash = getContentHash(filename);
+		if(!writeCache(cache_filename, filename, key, hash, r_mesh, v_library_names))
+			r_logstream << "Warning: Could not write cache file \"" << cache_filename << "\"" << endl;
+	}
+	return true;
+}
+
+unsigned int MeshCache :: getCacheHitCount ()
+{
+	return cache_hit_count;
+}
+
+unsigned int MeshCache :: getCacheMissCount ()
+{
+	return cache_miss_count;
+}
+
+void MeshCache :: resetCounts ()
+{
+	cache_hit_count  = 0;
+	cache_miss_count = 0;
+}
@@ -0,0 +1,172 @@
+//
+//  MeshCache.h
+//
+//  A global service to load CompiledMeshes through binary
+//    cache files.
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#ifndef OBJ_LIBRARY_MESH_CACHE_H
+#define OBJ_LIBRARY_MESH_CACHE_H
+
+#include <string>
+#include <iostream>
+
+
+
+namespace ObjLibrary
+{
+
+class CompiledMesh;
+
+
+
+//
+//  MeshCache
+//
+//  A global service to load the CompiledMesh for an OBJ file
+//    without parsing it every time.  The first time a model is
+//    loaded, it is compiled from the OBJ file and written to a
+//    cache file next to it, named by getCacheFileName.  After
+//    that, the cache file is memory-mapped and its arrays are
+//    copied straight into the CompiledMesh.
+//
+//  A cache file records the name, size, modification time, and
+//    a hash of the contents of the OBJ file it was made from.
+//    If the name does not match, or if the size or time does
+//    not match and neither does the hash, the cache file is
+//    stale and is rebuilt.  The material libraries are stored
+//    by name, so changing a MTL file does not make a cache
+//    stale.
+//
+//  Cache files are in the native byte order and are not meant
+//    to be moved between computers.  A cache file from an
+//    incompatible version of this library is treated as stale.
+//
+//  Different models may be loaded on different threads at the
+//    same time, but the same model must not be.
+//
+namespace MeshCache
+{
+
+//
+//  VERSION
+//
+//  The version of the cache file format.  This must be changed
+//    whenever the format or the way models are compiled
+//    changes, so that old cache files are rebuilt.
+//
+const unsigned int VERSION = 1;
+
+//
+//  getCacheFileName
+//
+//  Purpose: To determine the name of the cache file for an OBJ
+//           file.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file
+//  Precondition(s): N/A
+//  Returns: The name of the cache file.  This is filename with
+//           ".obj" replaced by ".objb", or with ".objb" added
+//           if it does not end in ".obj".  The path is
+//           unchanged.
+//  Side Effect: N/A
+//
+std::string getCacheFileName (const std::string& filename);
+
+//
+//  isCacheCurrent
+//
+//  Purpose: To determine if the cache file for an OBJ file can
+//           be used.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file
+//  Precondition(s): N/A
+//  Returns: Whether the cache file for filename exists, is from
+//           this version, and matches filename.
+//  Side Effect: N/A
+//
+bool isCacheCurrent (const std::string& filename);
+
+//
+//  load
+//
+//  Purpose: To load the CompiledMesh for an OBJ file, using its
+//           cache file if possible.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file
+//    <2> r_mesh: The CompiledMesh to load into
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> ObjStringParsing::isValidFilenameWithPath(filename)
+//  Returns: Whether the model could be loaded.
+//  Side Effect: r_mesh is replaced with the model in file
+//               filename, compiled as by
+//               ObjModel::getCompiledMesh.  If the cache file
+//               is current, it is used and the OBJ file is not
+//               parsed.  Otherwise, the OBJ file is loaded and
+//               the cache file is written again.  If a cache
+//               file cannot be written, the model is still
+//               loaded.  If the model cannot be loaded, r_mesh
+//               is replaced with an empty, finished
+//               CompiledMesh.  In all cases, the material
+//               libraries for the model are loaded with
+//               MtlLibraryManager.  If r_logstream is not
+//               specified, errors are written to the standard
+//               error stream.
+//
+bool load (const std::string& filename,
+           CompiledMesh& r_mesh);
+bool load (const std::string& filename,
+           CompiledMesh& r_mesh,
+           std::ostream& r_logstream);
+
+//
+//  getCacheHitCount
+//  getCacheMissCount
+//
+//  Purpose: To determine how many models have been loaded from
+//           cache files, and how many had to be compiled from
+//           their OBJ files.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of cache files used, or the number that
+//           were missing or stale.
+//  Side Effect: N/A
+//
+unsigned int getCacheHitCount ();
+unsigned int getCacheMissCount ();
+
+//
+//  resetCounts
+//
+//  Purpose: To reset the cache hit and miss counts.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The cache hit count and the cache miss count
+//               are set to 0.
+//
+void resetCounts ();
+
+}  // end of namespace MeshCache
+
+
+
+}  // end of namespace ObjLibrary
+
+#endif
@@ -0,0 +1,1226 @@
+//
+//  MeshSimplifier.cpp
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "Vector2.h"
+#include "Vector3.h"
+#include "ObjModel.h"
+#include "MeshSimplifier.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	const unsigned int NONE = 0xFFFFFFFF;
+
+	//
+	//  BOUNDARY_WEIGHT
+	//
+	//  The weight of the planes that hold boundary edges in
+	//    place, relative to the square of the edge length.
+	//
+	const double BOUNDARY_WEIGHT = 10.0;
+
+	//
+	//  CREASE_COSINE
+	//
+	//  The largest cosine between the normals of two triangles
+	//    for the edge between them to be treated as a crease.
+	//    A crease gets the same planes as a boundary edge, so
+	//    sharp features such as the tip of a thin fin are not
+	//    removed just because both sides are flat.
+	//
+	const double CREASE_COSINE = 0.5;
+
+	//
+	//  ATTRIBUTE_WEIGHT
+	//
+	//  The weight of the change in texture coordinates and
+	//    normals caused by a collapse, relative to the square
+	//    of the model radius.
+	//
+	const double ATTRIBUTE_WEIGHT = 0.01;
+
+	//
+	//  FLIP_LIMIT
+	//
+	//  The smallest cosine allowed between the normal of a
+	//    triangle before and after a collapse, and between its
+	//    normal in the original model and after a collapse.
+	//
+	const double FLIP_LIMIT = 0.2;
+
+	//
+	//  MAX_ERROR
+	//
+	//  The largest average distance a collapse may move the
+	//    surface by, relative to the model radius.  Cheaper
+	//    models are not worth it if they no longer look like the
+	//    original, so simplification stops here even if the
+	//    target triangle count has not been reached.
+	//
+	const double MAX_ERROR = 0.03;
+
+	const string LOD_SUFFIX = "-lod";
+	const string OBJ_EXTENSION = ".obj";
+
+	//
+	//  STAMP_START
+	//  STAMP_RATIOS
+	//
+	//  The text of the first line of a cache file, before and
+	//    after the simplifier version.  The rest of the line
+	//    lists the ratios the file is the simplified model for.
+	//    There is more than one if the lower ratios could not
+	//    remove any more triangles.
+	//
+	const string STAMP_START  = "# MeshSimplifier version";
+	const string STAMP_RATIOS = "for ratios";
+
+
+
+	//
+	//  Quadric
+	//
+	//  A record to represent a symmetric 4x4 error matrix, stored
+	//    as its upper triangle.  The error for a point p is
+	//    [p 1] * A * [p 1]^T.  m_area is the total weight of the
+	//    planes added, so the error divided by it is the mean
+	//    squared distance from the planes.
+	//
+	struct Quadric
+	{
+		double ma_values[10];
+		double m_area;
+	};
+
+	Quadric getZeroQuadric ()
+	{
+		Quadric quadric;
+		for(unsigned int i = 0; i < 10; i++)
+			quadric.ma_values[i] = 0.0;
+		quadric.m_area = 0.0;
+		return quadric;
+	}
+
+	void addPlane (Quadric& r_quadric,
+	               const Vector3& normal,
+	               double distance,
+	               double weight)
+	{
+		double a = normal.x;
+		double b = normal.y;
+		double c = normal.z;
+		double d = distance;
+		double* p = r_quadric.ma_values;
+		p[0] += weight * a * a;  p[1] += weight * a * b;  p[2] += weight * a * c;  p[3] += weight * a * d;
+		                         p[4] += weight * b * b;  p[5] += weight * b * c;  p[6] += weight * b * d;
+		                                                  p[7] += weight * c * c;  p[8] += weight * c * d;
+		                                                                           p[9] += weight * d * d;
+	}
+
+	void addQuadric (Quadric& r_quadric, const Quadric& other)
+	{
+		for(unsigned int i = 0; i < 10; i++)
+			r_quadric.ma_values[i] += other.ma_values[i];
+		r_quadric.m_area += other.m_area;
+	}
+
+	double getError (const Quadric& quadric, const Vector3& point)
+	{
+		const double* p = quadric.ma_values;
+		double x = point.x;
+		double y = point.y;
+		double z = point.z;
+		double error = p[0] * x * x + 2.0 * p[1] * x * y + 2.0 * p[2] * x * z + 2.0 * p[3] * x
+		             + p[4] * y * y + 2.0 * p[5] * y * z + 2.0 * p[6] * y
+		             + p[7] * z * z + 2.0 * p[8] * z
+		             + p[9];
+		if(error < 0.0)
+			return 0.0;  // rounding error
+		return error;
+	}
+
+
+
+	//
+	//  Candidate
+	//
+	//  A record to represent a possible collapse of one position
+	//    onto another.  A candidate is out of date if the version
+	//    of either position has changed since it was made.
+	//    m_distance is the average distance the collapse moves
+	//    the surface.
+	//
+	struct Candidate
+	{
+		double m_cost;
+		double m_distance;
+		unsigned int m_from;
+		unsigned int m_to;
+		unsigned int m_from_version;
+		unsigned int m_to_version;
+
+		bool operator> (const Candidate& other) const
+		{
+			return m_cost > other.m_cost;
+		}
+	};
+
+	unsigned long long getEdgeKey (unsigned int a, unsigned int b)
+	{
+		if(a > b)
+			swap(a, b);
+		return ((unsigned long long)(a) << 32) | b;
+	}
+
+	bool getModifiedTime (const string& filename, time_t& r_time)
+	{
+		struct stat info;
+		if(stat(filename.c_str(), &info) != 0)
+			return false;
+		r_time = info.st_mtime;
+		return true;
+	}
+
+	//
+	//  readStampRatios
+	//
+	//  Purpose: To read which ratios a cache file was made for.
+	//  Parameter(s):
+	//    <1> lod_filename: The name of the cache file
+	//    <2> source_time: When the original model was changed
+	//    <3> r_ratios: A vector to fill with the ratios
+	//  Precondition(s): N/A
+	//  Returns: Whether the cache file exists, is not older than
+	//           the original model, and was made by this version
+	//           of the simplifier.
+	//  Side Effect: If true is returned, r_ratios is set to the
+	//               ratios in the first line of the cache file.
+	//
+	bool readStampRatios (const string& lod_filename,
+	                      time_t source_time,
+	                      vector<double>& r_ratios)
+	{
+		time_t lod_time;
+		if(!getModifiedTime(lod_filename, lod_time) || lod_time < source_time)
+			return false;
+
+		ifstream input(lod_filename.c_str());
+		string line;
+		if(!getline(input, line) || line.compare(0, STAMP_START.size(), STAMP_START) != 0)
+			return false;
+
+		stringstream ss(line.substr(STAMP_START.size()));
+		unsigned int version;
+		string word1;
+		string word2;
+		ss >> version >> word1 >> word2;
+		if(!ss || version != MeshSimplifier::VERSION || word1 + " " + word2 != STAMP_RATIOS)
+			return false;
+
+		r_ratios.clear();
+		double ratio;
+		while(ss >> ratio)
+			r_ratios.push_back(ratio);
+		return !r_ratios.empty();
+	}
+
+	//
+	//  findLodFileName
+	//
+	//  Purpose: To determine which cache file holds the
+	//           simplified model for a ratio.
+	//  Parameter(s):
+	//    <1> filename: The name of the OBJ file for the original
+	//                  model
+	//    <2> source_time: When the original model was changed
+	//    <3> triangle_ratio: The ratio to look for
+	//    <4> triangle_ratios: All the ratios being made
+	//  Precondition(s):
+	//    <1> triangle_ratio > 0.0
+	//    <2> triangle_ratio <= 1.0
+	//  Returns: The name of the up-to-date cache file whose
+	//           stamp lists triangle_ratio, or "" if there is
+	//           none.  This is the cache file for triangle_ratio
+	//           itself, unless that level removed no triangles
+	//           and was left out.  Then it is the file for one of
+	//           the higher ratios in triangle_ratios.
+	//  Side Effect: N/A
+	//
+	string findLodFileName (const string& filename,
+	                        time_t source_time,
+	                        double triangle_ratio,
+	                        const vector<double>& triangle_ratios)
+	{
+		string lod_filename = MeshSimplifier::getLodFileName(filename, triangle_ratio);
+		vector<double> stamp_ratios;
+		if(readStampRatios(lod_filename, source_time, stamp_ratios))
+		{
+			if(find(stamp_ratios.begin(), stamp_ratios.end(), triangle_ratio) != stamp_ratios.end())
+				return lod_filename;
+			return "";
+		}
+		time_t lod_time;
+		if(getModifiedTime(lod_filename, lod_time))
+			return "";  // stale file that must be replaced
+
+		for(unsigned int i = 0; i < triangle_ratios.size(); i++)
+		{
+			if(triangle_ratios[i] <= triangle_ratio)
+				continue;
+			string other_filename = MeshSimplifier::getLodFileName(filename, triangle_ratios[i]);
+			if(readStampRatios(other_filename, source_time, stamp_ratios) &&
+			   find(stamp_ratios.begin(), stamp_ratios.end(), triangle_ratio) != stamp_ratios.end())
+			{
+				return other_filename;
+			}
+		}
+		return "";
+	}
+
+	//
+	//  saveLods
+	//
+	//  Purpose: To write the cache files for the simplified
+	//           versions of a model.
+	//  Parameter(s):
+	//    <1> lods: The simplified models
+	//    <2> triangle_ratios: The ratio each model was made for
+	//  Precondition(s):
+	//    <1> lods.size() == triangle_ratios.size()
+	//    <2> The models were made by one call to
+	//        MeshSimplifier::getSimplified
+	//  Returns: N/A
+	//  Side Effect: Each model that has fewer triangles than the
+	//               one for the next higher ratio is saved to
+	//               its cache file.  The first line of the file
+	//               is a stamp with the simplifier version, its
+	//               own ratio, and the ratios of any lower levels
+	//               that removed no more triangles.  The cache
+	//               files for those levels are deleted, so a
+	//               stale copy is never loaded.
+	//
+	void saveLods (const vector<ObjModel>& lods,
+	               const vector<double>& triangle_ratios)
+	{
+		assert(lods.size() == triangle_ratios.size());
+
+		vector<pair<double, unsigned int> > order;
+		for(unsigned int i = 0; i < triangle_ratios.size(); i++)
+			order.push_back(make_pair(triangle_ratios[i], i));
+		sort(order.begin(), order.end(), greater<pair<double, unsigned int> >());
+
+		// which saved model each level uses
+		vector<unsigned int> saved_as(lods.size(), NONE);
+		unsigned int previous = NONE;
+		for(unsigned int i = 0; i < order.size(); i++)
+		{
+			unsigned int index = order[i].second;
+			if(previous != NONE &&
+			   MeshSimplifier::getTriangleCount(lods[index]) >= MeshSimplifier::getTriangleCount(lods[previous]))
+			{
+				saved_as[index] = previous;
+				remove(lods[index].getFileNameWithPath().c_str());
+			}
+			else
+			{
+				saved_as[index] = index;
+				previous = index;
+			}
+		}
+
+		for(unsigned int i = 0; i < order.size(); i++)
+		{
+			unsigned int index = order[i].second;
+			if(saved_as[index] != index)
+				continue;
+
+			ofstream output_file(lods[index].getFileNameWithPath().c_str());
+			if(!output_file.is_open())
+			{
+				cerr << "Error: Cannot write to file \"" << lods[index].getFileNameWithPath() << "\" - ABORTING" << endl;
+				continue;
+			}
+			output_file.precision(17);
+			output_file << STAMP_START << " " << MeshSimplifier::VERSION << " " << STAMP_RATIOS;
+			for(unsigned int j = 0; j < order.size(); j++)
+				if(saved_as[order[j].second] == index)
+					output_file << " " << order[j].first;
+			output_file << endl;
+			lods[index].save(output_file);
+		}
+	}
+
+}  // end of anonymous namespace
+
+
+
+//
+//  MeshSimplifier::State
+//
+//  The changing mesh during simplification.  Positions are
+//    never moved; a collapse removes a position and points the
+//    triangles that used it at the wedges of a neighbour.
+//
+struct MeshSimplifier :: State
+{
+	const vector<Vector3>& mv_positions;
+	const vector<Wedge>& mv_wedges;
+
+	vector<Vector3> mv_wedge_normals;
+	vector<Vector2> mv_wedge_texture_coordinates;
+
+	vector<Quadric> mv_quadrics;             // by position
+	vector<unsigned int> mv_versions;        // by position
+	vector<bool> mv_is_position_removed;
+	vector<bool> mv_is_boundary;
+	vector<unsigned char> mv_box_sides;      // by position, a bit for each side it is on
+	vector<vector<unsigned int> > mvv_position_triangles;
+	unordered_set<unsigned long long> m_boundary_edges;
+
+	vector<Triangle> mv_triangles;
+	vector<Vector3> mv_original_normals;     // by triangle
+	vector<bool> mv_is_triangle_removed;
+	unsigned int m_triangle_count;
+
+	double m_attribute_scale;
+	double m_max_distance;
+	priority_queue<Candidate, vector<Candidate>, greater<Candidate> > m_candidates;
+
+	State (const vector<Vector3>& positions,
+	       const vector<Wedge>& wedges)
+			: mv_positions(positions),
+			  mv_wedges(wedges),
+			  m_triangle_count(0),
+			  m_attribute_scale(0.0),
+			  m_max_distance(0.0)
+	{
+	}
+
+	unsigned int getPosition (unsigned int triangle, unsigned int corner) const
+	{
+		assert(triangle < mv_triangles.size());
+		assert(corner < 3);
+
+		return mv_wedges[mv_triangles[triangle].ma_wedges[corner]].m_position;
+	}
+
+	unsigned int findCorner (unsigned int triangle, unsigned int position) const
+	{
+		for(unsigned int c = 0; c < 3; c++)
+			if(getPosition(triangle, c) == position)
+				return c;
+		return NONE;
+	}
+
+	Vector3 getNormal (unsigned int triangle,
+	                   unsigned int moved,
+	                   unsigned int moved_to) const
+	{
+		Vector3 a_corners[3];
+		for(unsigned int c = 0; c < 3; c++)
+		{
+			unsigned int position = getPosition(triangle, c);
+			if(position == moved)
+				position = moved_to;
+			a_corners[c] = mv_positions[position];
+		}
+		return (a_corners[1] - a_corners[0]).crossProduct(a_corners[2] - a_corners[0]);
+	}
+
+	double getArea (unsigned int position) const
+	{
+		double area = 0.0;
+		const vector<unsigned int>& triangles = mvv_position_triangles[position];
+		for(unsigned int i = 0; i < triangles.size(); i++)
+			if(!mv_is_triangle_removed[triangles[i]])
+				area += getNormal(triangles[i], NONE, NONE).getNorm() * 0.5;
+		return area;
+	}
+
+	void getNeighbours (unsigned int position, vector<unsigned int>& r_neighbours) const
+	{
+		r_neighbours.clear();
+		const vector<unsigned int>& triangles = mvv_position_triangles[position];
+		for(unsigned int i = 0; i < triangles.size(); i++)
+		{
+			if(mv_is_triangle_removed[triangles[i]])
+				continue;
+			for(unsigned int c = 0; c < 3; c++)
+			{
+				unsigned int other = getPosition(triangles[i], c);
+				if(other != position)
+					r_neighbours.push_back(other);
+			}
+		}
+		sort(r_neighbours.begin(), r_neighbours.end());
+		r_neighbours.erase(unique(r_neighbours.begin(), r_neighbours.end()), r_neighbours.end());
+	}
+
+	double getAttributeDifference (unsigned int wedge1, unsigned int wedge2) const
+	{
+		return mv_wedge_normals[wedge1].getDistanceSquared(mv_wedge_normals[wedge2]) +
+		       mv_wedge_texture_coordinates[wedge1].getDistanceSquared(mv_wedge_texture_coordinates[wedge2]);
+	}
+
+	double getCost (unsigned int from, unsigned int to) const
+	{
+		Quadric quadric = mv_quadrics[from];
+		addQuadric(quadric, mv_quadrics[to]);
+		double cost = getError(quadric, mv_positions[to]);
+
+		// the triangles around from take the attributes of to
+		double attribute_difference = 0.0;
+		const vector<unsigned int>& triangles = mvv_position_triangles[from];
+		for(unsigned int i = 0; i < triangles.size(); i++)
+		{
+			unsigned int t = triangles[i];
+			if(mv_is_triangle_removed[t])
+				continue;
+			unsigned int corner_to = findCorner(t, to);
+			if(corner_to == NONE)
+				continue;
+			unsigned int corner_from = findCorner(t, from);
+			assert(corner_from != NONE);
+			attribute_difference += getAttributeDifference(mv_triangles[t].ma_wedges[corner_from],
+			                                                mv_triangles[t].ma_wedges[corner_to]);
+		}
+		if(attribute_difference > 0.0)
+			cost += m_attribute_scale * getArea(from) * attribute_difference;
+
+		return cost;
+	}
+
+	void addCandidate (unsigned int from, unsigned int to)
+	{
+		Quadric quadric = mv_quadrics[from];
+		addQuadric(quadric, mv_quadrics[to]);
+
+		Candidate candidate;
+		candidate.m_cost         = getCost(from, to);
+		candidate.m_distance     = 0.0;
+		if(quadric.m_area > 0.0)
+			candidate.m_distance = sqrt(getError(quadric, mv_positions[to]) / quadric.m_area);
+		candidate.m_from         = from;
+		candidate.m_to           = to;
+		candidate.m_from_version = mv_versions[from];
+		candidate.m_to_version   = mv_versions[to];
+		m_candidates.push(candidate);
+	}
+
+	bool isCurrent (const Candidate& candidate) const
+	{
+		return !mv_is_position_removed[candidate.m_from] &&
+		       !mv_is_position_removed[candidate.m_to] &&
+		       candidate.m_from_version == mv_versions[candidate.m_from] &&
+		       candidate.m_to_version   == mv_versions[candidate.m_to];
+	}
+
+	bool isCollapseValid (unsigned int from,
+	                      unsigned int to,
+	                      vector<pair<unsigned int, unsigned int> >& r_wedge_map) const
+	{
+		// a boundary position may only slide along the boundary
+		if(mv_is_boundary[from] && m_boundary_edges.count(getEdgeKey(from, to)) == 0)
+			return false;
+
+		// a position on the bounding box may only slide along it
+		if((mv_box_sides[from] & ~mv_box_sides[to]) != 0)
+			return false;
+
+		// each wedge at from must go to exactly one wedge at to
+		r_wedge_map.clear();
+		unsigned int edge_triangle_count = 0;
+		const vector<unsigned int>& triangles = mvv_position_triangles[from];
+		for(unsigned int i = 0; i < triangles.size(); i++)
+		{
+			unsigned int t = triangles[i];
+			if(mv_is_triangle_removed[t])
+				continue;
+			unsigned int corner_to = findCorner(t, to);
+			if(corner_to == NONE)
+				continue;
+			edge_triangle_count++;
+
+			unsigned int wedge_from = mv_triangles[t].ma_wedges[findCorner(t, from)];
+			unsigned int wedge_to   = mv_triangles[t].ma_wedges[corner_to];
+			bool is_found = false;
+			for(unsigned int m = 0; m < r_wedge_map.size(); m++)
+			{
+				if(r_wedge_map[m].first == wedge_from)
+				{
+					if(r_wedge_map[m].second != wedge_to)
+						return false;  // seam crosses the edge
+					is_found = true;
+				}
+				else if(r_wedge_map[m].second == wedge_to)
+					return false;  // would join two sides of a seam
+			}
+			if(!is_found)
+				r_wedge_map.push_back(make_pair(wedge_from, wedge_to));
+		}
+		if(edge_triangle_count == 0)
+			return false;  // not an edge any more
+
+		for(unsigned int i = 0; i < triangles.size(); i++)
+		{
+			unsigned int t = triangles[i];
+			if(mv_is_triangle_removed[t])
+				continue;
+			unsigned int wedge_from = mv_triangles[t].ma_wedges[findCorner(t, from)];
+			bool is_found = false;
+			for(unsigned int m = 0; m < r_wedge_map.size(); m++)
+				if(r_wedge_map[m].first == wedge_from)
+					is_found = true;
+			if(!is_found)
+				return false;  // wedge does not reach to, so seam would tear
+		}
+
+		// the link condition keeps the surface manifold
+		vector<unsigned int> from_neighbours;
+		vector<unsigned int> to_neighbours;
+		getNeighbours(from, from_neighbours);
+		getNeighbours(to,   to_neighbours);
+		vector<unsigned int> shared;
+		set_intersection(from_neighbours.begin(), from_neighbours.end(),
+		                 to_neighbours.begin(),   to_neighbours.end(),
+		                 back_inserter(shared));
+		if(shared.size() != edge_triangle_count)
+			return false;
+
+		// the remaining triangles must not flip or collapse
+		for(unsigned int i = 0; i < triangles.size(); i++)
+		{
+			unsigned int t = triangles[i];
+			if(mv_is_triangle_removed[t] || findCorner(t, to) != NONE)
+				continue;
+			Vector3 before = getNormal(t, NONE, NONE);
+			Vector3 after  = getNormal(t, from, to);
+			double before_norm = before.getNorm();
+			double after_norm  = after.getNorm();
+			if(after_norm <= 0.0)
+				return false;
+			if(before.dotProduct(after) < FLIP_LIMIT * before_norm * after_norm)
+				return false;
+			// small turns must not add up to a flip either
+			const Vector3& original = mv_original_normals[t];
+			if(original.dotProduct(after) < FLIP_LIMIT * original.getNorm() * after_norm)
+				return false;
+		}
+
+		return true;
+	}
+
+	void collapse (unsigned int from,
+	               unsigned int to,
+	               const vector<pair<unsigned int, unsigned int> >& wedge_map)
+	{
+		vector<unsigned int> from_neighbours;
+		getNeighbours(from, from_neighbours);
+
+		vector<unsigned int>& r_to_triangles = mvv_position_triangles[to];
+		const vector<unsigned int>& from_triangles = mvv_position_triangles[from];
+		for(unsigned int i = 0; i < from_triangles.size(); i++)
+		{
+			unsigned int t = from_triangles[i];
+			if(mv_is_triangle_removed[t])
+				continue;
+			if(findCorner(t, to) != NONE)
+			{
+				mv_is_triangle_removed[t] = true;
+				assert(m_triangle_count > 0);
+				m_triangle_count--;
+			}
+			else
+			{
+				unsigned int& r_wedge = mv_triangles[t].ma_wedges[findCorner(t, from)];
+				for(unsigned int m = 0; m < wedge_map.size(); m++)
+					if(wedge_map[m].first == r_wedge)
+					{
+						r_wedge = wedge_map[m].second;
+						break;
+					}
+				assert(mv_wedges[r_wedge].m_position == to);
+				r_to_triangles.push_back(t);
+			}
+		}
+
+		// drop the triangles that were removed
+		unsigned int kept = 0;
+		for(unsigned int i = 0; i < r_to_triangles.size(); i++)
+			if(!mv_is_triangle_removed[r_to_triangles[i]])
+				r_to_triangles[kept++] = r_to_triangles[i];
+		r_to_triangles.resize(kept);
+
+		// move the boundary edges from from to to
+		if(mv_is_boundary[from])
+		{
+			for(unsigned int i = 0; i < from_neighbours.size(); i++)
+			{
+				unsigned int other = from_neighbours[i];
+				if(m_boundary_edges.erase(getEdgeKey(from, other)) > 0 && other != to)
+					m_boundary_edges.insert(getEdgeKey(to, other));
+			}
+			mv_is_boundary[to] = true;
+		}
+
+		addQuadric(mv_quadrics[to], mv_quadrics[from]);
+		mv_is_position_removed[from] = true;
+		mvv_position_triangles[from].clear();
+		mv_versions[from]++;
+		mv_versions[to]++;
+
+		vector<unsigned int> to_neighbours;
+		getNeighbours(to, to_neighbours);
+		for(unsigned int i = 0; i < to_neighbours.size(); i++)
+		{
+			addCandidate(to, to_neighbours[i]);
+			addCandidate(to_neighbours[i], to);
+		}
+	}
+};
+
+
+
+string MeshSimplifier :: getLodFileName (const string& filename,
+                                         double triangle_ratio)
+{
+	assert(triangle_ratio > 0.0);
+	assert(triangle_ratio <= 1.0);
+
+	string base = filename;
+	if(base.size() >= OBJ_EXTENSION.size() &&
+	   base.compare(base.size() - OBJ_EXTENSION.size(), OBJ_EXTENSION.size(), OBJ_EXTENSION) == 0)
+	{
+		base.resize(base.size() - OBJ_EXTENSION.size());
+	}
+
+	unsigned int percent = (unsigned int)(std::floor(triangle_ratio * 100.0 + 0.5));
+	if(percent < 1)
+		percent = 1;
+
+	stringstream ss;
+	ss << base << LOD_SUFFIX << percent << OBJ_EXTENSION;
+	return ss.str();
+}
+
+vector<ObjModel> MeshSimplifier :: loadLods (const string& filename,
+                                             const vector<double>& triangle_ratios)
+{
+	time_t source_time;
+	if(!getModifiedTime(filename, source_time))
+		return vector<ObjModel>();
+
+	vector<ObjModel> lods(triangle_ratios.size());
+	bool is_all_loaded = true;
+	for(unsigned int i = 0; i < triangle_ratios.size(); i++)
+	{
+		assert(triangle_ratios[i] > 0.0);
+		assert(triangle_ratios[i] <= 1.0);
+
+		string lod_filename = findLodFileName(filename, source_time, triangle_ratios[i], triangle_ratios);
+		if(lod_filename == "")
+		{
+			is_all_loaded = false;
+			break;
+		}
+		lods[i].load(lod_filename);
+		if(!lods[i].isLoadedSuccessfully())
+		{
+			is_all_loaded = false;
+			break;
+		}
+	}
+
+	if(!is_all_loaded)
+	{
+		// the levels depend on each other, so they are all remade
+		ObjModel source(filename);
+		if(!source.isLoadedSuccessfully())
+			return vector<ObjModel>();
+
+		lods = MeshSimplifier(source).getSimplified(triangle_ratios);
+		saveLods(lods, triangle_ratios);
+	}
+
+	return lods;
+}
+
+bool MeshSimplifier :: updateLods (const string& filename,
+                                   const vector<double>& triangle_ratios)
+{
+	time_t source_time;
+	if(!getModifiedTime(filename, source_time))
+		return false;
+
+	bool is_all_current = true;
+	for(unsigned int i = 0; i < triangle_ratios.size(); i++)
+	{
+		assert(triangle_ratios[i] > 0.0);
+		assert(triangle_ratios[i] <= 1.0);
+
+		if(findLodFileName(filename, source_time, triangle_ratios[i], triangle_ratios) == "")
+			is_all_current = false;
+	}
+
+	if(!is_all_current)
+	{
+		ObjModel source(filename);
+		if(!source.isLoadedSuccessfully())
+			return false;
+
+		saveLods(MeshSimplifier(source).getSimplified(triangle_ratios), triangle_ratios);
+	}
+	return true;
+}
+
+
+unsigned int MeshSimplifier :: getTriangleCount (const ObjModel& model)
+{
+	unsigned int count = 0;
+	for(unsigned int m = 0; m < model.getMeshCount(); m++)
+		for(unsigned int f = 0; f < model.getFaceCount(m); f++)
+		{
+			unsigned int vertex_count = model.getFaceVertexCount(m, f);
+			if(vertex_count >= 3)
+				count += vertex_count - 2;
+		}
+	return count;
+}
+
+
+
+MeshSimplifier :: MeshSimplifier (const ObjModel& model)
+		: m_model(model),
+		  mv_positions(),
+		  mv_position_wedge_counts(),
+		  mv_wedges(),
+		  mv_triangles()
+{
+	// merge positions that are exactly equal
+	map<tuple<double, double, double>, unsigned int> position_lookup;
+	vector<unsigned int> vertex_positions(model.getVertexCount());
+	for(unsigned int v = 0; v < model.getVertexCount(); v++)
+	{
+		const Vector3& position = model.getVertexPosition(v);
+		tuple<double, double, double> key(position.x, position.y, position.z);
+		map<tuple<double, double, double>, unsigned int>::iterator it = position_lookup.find(key);
+		if(it != position_lookup.end())
+			vertex_positions[v] = it->second;
+		else
+		{
+			vertex_positions[v] = (unsigned int)(mv_positions.size());
+			position_lookup[key] = vertex_positions[v];
+			mv_positions.push_back(position);
+		}
+	}
+	mv_position_wedge_counts.assign(mv_positions.size(), 0);
+
+	// some exporters write a new normal for every corner, so
+	//  attributes are compared by value, not by index
+	map<pair<double, double>, unsigned int> texture_coordinate_lookup;
+	vector<unsigned int> texture_coordinate_ids(model.getTextureCoordinateCount());
+	for(unsigned int t = 0; t < model.getTextureCoordinateCount(); t++)
+	{
+		const Vector2& texture_coordinate = model.getTextureCoordinate(t);
+		pair<double, double> key(texture_coordinate.x, texture_coordinate.y);
+		if(texture_coordinate_lookup.count(key) == 0)
+			texture_coordinate_lookup[key] = t;
+		texture_coordinate_ids[t] = texture_coordinate_lookup[key];
+	}
+
+	map<tuple<double, double, double>, unsigned int> normal_lookup;
+	vector<unsigned int> normal_ids(model.getNormalCount());
+	for(unsigned int n = 0; n < model.getNormalCount(); n++)
+	{
+		const Vector3& normal = model.getNormalVector(n);
+		tuple<double, double, double> key(normal.x, normal.y, normal.z);
+		if(normal_lookup.count(key) == 0)
+			normal_lookup[key] = n;
+		normal_ids[n] = normal_lookup[key];
+	}
+
+	map<tuple<unsigned int, unsigned int, unsigned int>, unsigned int> wedge_lookup;
+	for(unsigned int m = 0; m < model.getMeshCount(); m++)
+		for(unsigned int f = 0; f < model.getFaceCount(m); f++)
+		{
+			unsigned int vertex_count = model.getFaceVertexCount(m, f);
+			vector<unsigned int> face_wedges(vertex_count);
+			for(unsigned int v = 0; v < vertex_count; v++)
+			{
+				Wedge wedge;
+				wedge.m_position            = vertex_positions[model.getFaceVertexIndex(m, f, v)];
+				wedge.m_texture_coordinates = model.getFaceVertexTextureCoordinates(m, f, v);
+				wedge.m_normal              = model.getFaceVertexNormal(m, f, v);
+				if(wedge.m_texture_coordinates < texture_coordinate_ids.size())
+					wedge.m_texture_coordinates = texture_coordinate_ids[wedge.m_texture_coordinates];
+				if(wedge.m_normal < normal_ids.size())
+					wedge.m_normal = normal_ids[wedge.m_normal];
+
+				tuple<unsigned int, unsigned int, unsigned int> key(wedge.m_position,
+				                                                    wedge.m_texture_coordinates,
+				                                                    wedge.m_normal);
+				map<tuple<unsigned int, unsigned int, unsigned int>, unsigned int>::iterator it = wedge_lookup.find(key);
+				if(it != wedge_lookup.end())
+					face_wedges[v] = it->second;
+				else
+				{
+					face_wedges[v] = (unsigned int)(mv_wedges.size());
+					wedge_lookup[key] = face_wedges[v];
+					mv_wedges.push_back(wedge);
+					mv_position_wedge_counts[wedge.m_position]++;
+				}
+			}
+
+			// same fan as getCompiledMesh
+			for(unsigned int c = 2; c < vertex_count; c++)
+			{
+				Triangle triangle;
+				triangle.ma_wedges[0] = face_wedges[0];
+				triangle.ma_wedges[1] = face_wedges[c - 1];
+				triangle.ma_wedges[2] = face_wedges[c];
+				triangle.m_mesh = m;
+
+				unsigned int p0 = mv_wedges[triangle.ma_wedges[0]].m_position;
+				unsigned int p1 = mv_wedges[triangle.ma_wedges[1]].m_position;
+				unsigned int p2 = mv_wedges[triangle.ma_wedges[2]].m_position;
+				if(p0 != p1 && p1 != p2 && p2 != p0)
+					mv_triangles.push_back(triangle);
+			}
+		}
+
+	assert(invariant());
+}
+
+
+
+unsigned int MeshSimplifier :: getTriangleCount () const
+{
+	return (unsigned int)(mv_triangles.size());
+}
+
+unsigned int MeshSimplifier :: getPositionCount () const
+{
+	return (unsigned int)(mv_positions.size());
+}
+
+unsigned int MeshSimplifier :: getSeamPositionCount () const
+{
+	unsigned int count = 0;
+	for(unsigned int p = 0; p < mv_position_wedge_counts.size(); p++)
+		if(mv_position_wedge_counts[p] > 1)
+			count++;
+	return count;
+}
+
+ObjModel MeshSimplifier :: getSimplified (double triangle_ratio) const
+{
+	assert(triangle_ratio > 0.0);
+	assert(triangle_ratio <= 1.0);
+
+	return getSimplified(vector<double>(1, triangle_ratio))[0];
+}
+
+vector<ObjModel> MeshSimplifier :: getSimplified (const vector<double>& triangle_ratios) const
+{
+	// make the biggest version first and continue from it
+	vector<pair<double, unsigned int> > order;
+	for(unsigned int i = 0; i < triangle_ratios.size(); i++)
+	{
+		assert(triangle_ratios[i] > 0.0);
+		assert(triangle_ratios[i] <= 1.0);
+		order.push_back(make_pair(triangle_ratios[i], i));
+	}
+	sort(order.begin(), order.end(), greater<pair<double, unsigned int> >());
+
+	string filename = m_model.getFileNameWithPath();
+	State state(mv_positions, mv_wedges);
+	initState(state);
+
+	vector<ObjModel> models(triangle_ratios.size());
+	for(unsigned int i = 0; i < order.size(); i++)
+	{
+		double ratio = order[i].first;
+		unsigned int target_count = (unsigned int)(std::floor(ratio * getTriangleCount() + 1.0e-6));
+		collapseTo(state, target_count);
+		models[order[i].second] = makeModel(state, getLodFileName(filename, ratio));
+	}
+	return models;
+}
+
+
+
+void MeshSimplifier :: initState (State& r_state) const
+{
+	unsigned int position_count = getPositionCount();
+	unsigned int triangle_count = getTriangleCount();
+
+	r_state.mv_wedge_normals            .resize(mv_wedges.size());
+	r_state.mv_wedge_texture_coordinates.resize(mv_wedges.size());
+	for(unsigned int w = 0; w < mv_wedges.size(); w++)
+	{
+		if(mv_wedges[w].m_normal != ObjModel::NO_NORMAL)
+			r_state.mv_wedge_normals[w] = m_model.getNormalVector(mv_wedges[w].m_normal);
+		if(mv_wedges[w].m_texture_coordinates != ObjModel::NO_TEXTURE_COORDINATES)
+			r_state.mv_wedge_texture_coordinates[w] = m_model.getTextureCoordinate(mv_wedges[w].m_texture_coordinates);
+	}
+
+	r_state.mv_quadrics           .assign(position_count, getZeroQuadric());
+	r_state.mv_versions           .assign(position_count, 0);
+	r_state.mv_is_position_removed.assign(position_count, false);
+	r_state.mv_is_boundary        .assign(position_count, false);
+	r_state.mvv_position_triangles.assign(position_count, vector<unsigned int>());
+	r_state.m_boundary_edges.clear();
+	r_state.mv_triangles = mv_triangles;
+	r_state.mv_original_normals.resize(triangle_count);
+	for(unsigned int t = 0; t < triangle_count; t++)
+		r_state.mv_original_normals[t] = r_state.getNormal(t, NONE, NONE);
+	r_state.mv_is_triangle_removed.assign(triangle_count, false);
+	r_state.m_triangle_count = triangle_count;
+
+	// model size, to make attribute changes comparable to distances
+	Vector3 box_min = mv_positions.empty() ? Vector3::ZERO : mv_positions[0];
+	Vector3 box_max = box_min;
+	for(unsigned int p = 0; p < position_count; p++)
+	{
+		box_min = Vector3(min(box_min.x, mv_positions[p].x), min(box_min.y, mv_positions[p].y), min(box_min.z, mv_positions[p].z));
+		box_max = Vector3(max(box_max.x, mv_positions[p].x), max(box_max.y, mv_positions[p].y), max(box_max.z, mv_positions[p].z));
+	}
+	r_state.mv_box_sides.assign(position_count, 0);
+	for(unsigned int p = 0; p < position_count; p++)
+	{
+		const Vector3& position = mv_positions[p];
+		r_state.mv_box_sides[p] = (position.x == box_min.x ? 0x01 : 0) | (position.x == box_max.x ? 0x02 : 0) |
+		                          (position.y == box_min.y ? 0x04 : 0) | (position.y == box_max.y ? 0x08 : 0) |
+		                          (position.z == box_min.z ? 0x10 : 0) | (position.z == box_max.z ? 0x20 : 0);
+	}
+	double radius = box_min.getDistance(box_max) * 0.5;
+	r_state.m_attribute_scale = ATTRIBUTE_WEIGHT * radius * radius;
+	r_state.m_max_distance    = MAX_ERROR * radius;
+
+	// which meshes use each edge
+	struct EdgeUse
+	{
+		unsigned int m_count;
+		unsigned int m_mesh;
+		bool m_is_mixed;
+		unsigned int ma_triangles[2];
+	};
+	unordered_map<unsigned long long, EdgeUse> edge_uses;
+	for(unsigned int t = 0; t < triangle_count; t++)
+	{
+		for(unsigned int c = 0; c < 3; c++)
+		{
+			r_state.mvv_position_triangles[r_state.getPosition(t, c)].push_back(t);
+
+			unsigned long long key = getEdgeKey(r_state.getPosition(t, c), r_state.getPosition(t, (c + 1) % 3));
+			unordered_map<unsigned long long, EdgeUse>::iterator it = edge_uses.find(key);
+			if(it == edge_uses.end())
+			{
+				EdgeUse use;
+				use.m_count    = 1;
+				use.m_mesh     = mv_triangles[t].m_mesh;
+				use.m_is_mixed = false;
+				use.ma_triangles[0] = t;
+				use.ma_triangles[1] = NONE;
+				edge_uses[key] = use;
+			}
+			else
+			{
+				if(it->second.m_count == 1)
+					it->second.ma_triangles[1] = t;
+				it->second.m_count++;
+				if(it->second.m_mesh != mv_triangles[t].m_mesh)
+					it->second.m_is_mixed = true;
+			}
+		}
+	}
+
+	// a plane for each triangle, and a wall along each boundary
+	//  edge and crease
+	for(unsigned int t = 0; t < triangle_count; t++)
+	{
+		Vector3 normal = r_state.getNormal(t, NONE, NONE);
+		double  norm   = normal.getNorm();
+		if(norm <= 0.0)
+			continue;
+		normal /= norm;
+		double area = norm * 0.5;
+
+		for(unsigned int c = 0; c < 3; c++)
+		{
+			unsigned int position = r_state.getPosition(t, c);
+			addPlane(r_state.mv_quadrics[position], normal, -normal.dotProduct(mv_positions[position]), area);
+			r_state.mv_quadrics[position].m_area += area;
+		}
+
+		for(unsigned int c = 0; c < 3; c++)
+		{
+			unsigned int a = r_state.getPosition(t, c);
+			unsigned int b = r_state.getPosition(t, (c + 1) % 3);
+			unsigned long long key = getEdgeKey(a, b);
+			const EdgeUse& use = edge_uses[key];
+			bool is_boundary = (use.m_count != 2 || use.m_is_mixed);
+			if(!is_boundary)
+			{
+				unsigned int other = (use.ma_triangles[0] == t) ? use.ma_triangles[1] : use.ma_triangles[0];
+				Vector3 other_normal = r_state.getNormal(other, NONE, NONE);
+				double  other_norm   = other_normal.getNorm();
+				if(other_norm > 0.0 && normal.dotProduct(other_normal) > CREASE_COSINE * other_norm)
+					continue;  // smooth edge
+			}
+
+			Vector3 edge = mv_positions[b] - mv_positions[a];
+			Vector3 wall = edge.crossProduct(normal);
+			if(wall.isZero())
+				continue;
+			wall.normalize();
+			double weight = BOUNDARY_WEIGHT * edge.getNormSquared();
+			double distance = -wall.dotProduct(mv_positions[a]);
+			addPlane(r_state.mv_quadrics[a], wall, distance, weight);
+			addPlane(r_state.mv_quadrics[b], wall, distance, weight);
+			r_state.mv_quadrics[a].m_area += weight;
+			r_state.mv_quadrics[b].m_area += weight;
+			if(is_boundary)
+			{
+				r_state.mv_is_boundary[a] = true;
+				r_state.mv_is_boundary[b] = true;
+				r_state.m_boundary_edges.insert(key);
+			}
+		}
+	}
+
+	for(unordered_map<unsigned long long, EdgeUse>::const_iterator it = edge_uses.begin();
+	    it != edge_uses.end(); ++it)
+	{
+		unsigned int a = (unsigned int)(it->first >> 32);
+		unsigned int b = (unsigned int)(it->first & 0xFFFFFFFF);
+		r_state.addCandidate(a, b);
+		r_state.addCandidate(b, a);
+	}
+}
+
+void MeshSimplifier :: collapseTo (State& r_state,
+                                   unsigned int target_count) const
+{
+	vector<pair<unsigned int, unsigned int> > wedge_map;
+	while(r_state.m_triangle_count > target_count && !r_state.m_candidates.empty())
+	{
+		Candidate candidate = r_state.m_candidates.top();
+		r_state.m_candidates.pop();
+
+		if(!r_state.isCurrent(candidate))
+			continue;
+		if(candidate.m_distance > r_state.m_max_distance)
+			continue;  // a cheaper collapse may still be allowed
+		if(!r_state.isCollapseValid(candidate.m_from, candidate.m_to, wedge_map))
+			continue;
+		r_state.collapse(candidate.m_from, candidate.m_to, wedge_map);
+	}
+}
+
+ObjModel MeshSimplifier :: makeModel (const State& state,
+                                      const string& filename) const
+{
+	ObjModel model;
+	model.setFileNameWithPath(filename);
+	for(unsigned int i = 0; i < m_model.getMaterialLibraryCount(); i++)
+		model.addMaterialLibrary(m_model.getMaterialLibraryName(i));
+
+	vector<unsigned int> mesh_map(m_model.getMeshCount(), NONE);
+	vector<unsigned int> position_map(mv_positions.size(), NONE);
+	vector<unsigned int> texture_coordinate_map(m_model.getTextureCoordinateCount(), NONE);
+	vector<unsigned int> normal_map(m_model.getNormalCount(), NONE);
+
+	for(unsigned int t = 0; t < state.mv_triangles.size(); t++)
+	{
+		if(state.mv_is_triangle_removed[t])
+			continue;
+
+		const Triangle& triangle = state.mv_triangles[t];
+		unsigned int& r_mesh = mesh_map[triangle.m_mesh];
+		if(r_mesh == NONE)
+		{
+			r_mesh = model.addMesh();
+			if(m_model.isMeshMaterial(triangle.m_mesh))
+				model.setMeshMaterial(r_mesh, m_model.getMeshMaterialName(triangle.m_mesh));
+		}
+
+		unsigned int face = model.addFace(r_mesh);
+		for(unsigned int c = 0; c < 3; c++)
+		{
+			const Wedge& wedge = mv_wedges[triangle.ma_wedges[c]];
+
+			unsigned int& r_position = position_map[wedge.m_position];
+			if(r_position == NONE)
+				r_position = model.addVertex(mv_positions[wedge.m_position]);
+
+			unsigned int texture_coordinates = ObjModel::NO_TEXTURE_COORDINATES;
+			if(wedge.m_texture_coordinates != ObjModel::NO_TEXTURE_COORDINATES)
+			{
+				unsigned int& r_mapped = texture_coordinate_map[wedge.m_texture_coordinates];
+				if(r_mapped == NONE)
+					r_mapped = model.addTextureCoordinate(m_model.getTextureCoordinate(wedge.m_texture_coordinates));
+				texture_coordinates = r_mapped;
+			}
+
+			unsigned int normal = ObjModel::NO_NORMAL;
+			if(wedge.m_normal != ObjModel::NO_NORMAL)
+			{
+				unsigned int& r_mapped = normal_map[wedge.m_normal];
+				if(r_mapped == NONE)
+					r_mapped = model.addNormal(m_model.getNormalVector(wedge.m_normal));
+				normal = r_mapped;
+			}
+
+			model.addFaceVertex(r_mesh, face, r_position, texture_coordinates, normal);
+		}
+	}
+
+	model.validate(false);
+	return model;
+}
+
+bool MeshSimplifier :: invariant () const
+{
+	if(mv_position_wedge_counts.size() != mv_positions.size()) return false;
+	for(unsigned int w = 0; w < mv_wedges.size(); w++)
+		if(mv_wedges[w].m_position >= mv_positions.size()) return false;
+	return true;
+}
@@ -0,0 +1,398 @@
+//
+//  MeshSimplifier.h
+//
+//  A class to reduce the number of triangles in a model.
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#ifndef OBJ_LIBRARY_MESH_SIMPLIFIER_H
+#define OBJ_LIBRARY_MESH_SIMPLIFIER_H
+
+#include <string>
+#include <vector>
+
+#include "Vector3.h"
+#include "ObjModel.h"
+
+
+
+namespace ObjLibrary
+{
+
+//
+//  MeshSimplifier
+//
+//  A class to produce simplified versions of the faces of an
+//    ObjModel, for use as levels of detail.  The model is
+//    simplified by repeatedly collapsing the edge that changes
+//    the surface least, as measured by quadric error metrics
+//    (Garland and Heckbert, 1997).  Each collapse moves one
+//    vertex onto a neighbour, so the remaining vertexes keep
+//    their original positions, texture coordinates, and
+//    normals.
+//
+//  The positions of the model are merged if they are exactly
+//    equal, and a vertex is then split into one "wedge" for
+//    each combination of texture coordinates and normal used
+//    with it.  A vertex with more than one wedge lies on a
+//    seam.  A seam vertex is only collapsed if each of its
+//    wedges can be moved to a different wedge of the vertex it
+//    collapses onto, so texture and normal seams stay closed.
+//    Open edges and edges between meshes with different
+//    materials are kept in place by extra boundary planes, and
+//    vertexes on them may only slide along them.  Likewise, a
+//    vertex on a side of the bounding box may only collapse
+//    onto another vertex on that side, so the simplified
+//    models have the same bounding box.  A collapse is also
+//    rejected if it would flip a triangle or make the surface
+//    non-manifold.
+//
+//  Only faces are simplified.  Point sets and polylines are
+//    not included in the simplified models.
+//
+//  Simplified models can be cached on disk as OBJ files next
+//    to the original model, named by getLodFileName, so that
+//    they only need to be made once.  The first line of each
+//    cache file records the simplifier VERSION and the ratios
+//    it was made for, and a file that does not match is made
+//    again.  A level that removes no triangles beyond the level
+//    before it is not written; the file for the level before
+//    it lists both ratios instead.
+//
+//  Class Invariant:
+//    <1> mv_position_wedge_counts.size() == mv_positions.size()
+//    <2> mv_wedges[i].m_position < mv_positions.size()
+//        WHERE 0 <= i < mv_wedges.size()
+//
+class MeshSimplifier
+{
+public:
+//
+//  VERSION
+//
+//  The version of the simplification algorithm.  This must be
+//    changed whenever the simplified models would change, so
+//    that old cache files are made again.
+//
+	static const unsigned int VERSION = 3;
+
+public:
+//
+//  getLodFileName
+//
+//  Purpose: To determine the name of the file that a simplified
+//           version of a model is cached in.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file for the original
+//                  model
+//    <2> triangle_ratio: The fraction of triangles kept
+//  Precondition(s):
+//    <1> triangle_ratio > 0.0
+//    <2> triangle_ratio <= 1.0
+//  Returns: The name of the cache file.  This is filename with
+//           "-lod" and the percentage of triangles kept added
+//           before the ".obj", e.g. "rock-lod25.obj" for
+//           "rock.obj" and 0.25.  The path is unchanged.
+//  Side Effect: N/A
+//
+	static std::string getLodFileName (const std::string& filename,
+	                                   double triangle_ratio);
+
+//
+//  loadLods
+//
+//  Purpose: To load the simplified versions of a model from
+//           its cache files, creating any that are missing.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file for the original
+//                  model
+//    <2> triangle_ratios: The fraction of triangles to keep in
+//                         each simplified version
+//  Precondition(s):
+//    <1> ObjStringParsing::isValidFilenameWithPath(filename)
+//    <2> triangle_ratios[i] > 0.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//    <3> triangle_ratios[i] <= 1.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//  Returns: The simplified models, in the same order as
+//           triangle_ratios.  A level that was not written
+//           because it removed no more triangles is the same
+//           as the level before it.  If the original model
+//           cannot be loaded, an empty vector is returned.
+//  Side Effect: If every level has an up-to-date cache file,
+//               they are loaded instead of simplifying the
+//               model again.  A cache file is up to date if it
+//               is not older than filename and its first line
+//               matches VERSION and lists the ratio.  Otherwise,
+//               all the levels are made and saved again.  If a
+//               cache file cannot be written, the simplified
+//               model is still returned.
+//
+	static std::vector<ObjModel> loadLods (
+	                 const std::string& filename,
+	                 const std::vector<double>& triangle_ratios);
+
+//
+//  updateLods
+//
+//  Purpose: To make sure that the cache files for the
+//           simplified versions of a model are up to date,
+//           without loading the ones that are.
+//  Parameter(s):
+//    <1> filename: The name of the OBJ file for the original
+//                  model
+//    <2> triangle_ratios: The fraction of triangles to keep in
+//                         each simplified version
+//  Precondition(s):
+//    <1> ObjStringParsing::isValidFilenameWithPath(filename)
+//    <2> triangle_ratios[i] > 0.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//    <3> triangle_ratios[i] <= 1.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//  Returns: Whether the cache files are up to date.  This is
+//           false if the original model cannot be loaded when
+//           it is needed.
+//  Side Effect: If any level does not have an up-to-date cache
+//               file, as described for loadLods, all the levels
+//               are made and saved again.  A level that removes
+//               no triangles beyond the level before it is not
+//               written, and its old cache file is deleted.  If
+//               every level is up to date, the original model
+//               is not loaded.
+//
+	static bool updateLods (const std::string& filename,
+	                        const std::vector<double>& triangle_ratios);
+
+//
+//  getTriangleCount
+//
+//  Purpose: To determine the number of triangles in the faces
+//           of a model.
+//  Parameter(s):
+//    <1> model: The model to count the triangles of
+//  Precondition(s): N/A
+//  Returns: The number of triangles the faces of model would be
+//           split into.  Point sets and polylines are not
+//           counted.
+//  Side Effect: N/A
+//
+	static unsigned int getTriangleCount (const ObjModel& model);
+
+public:
+//
+//  Constructor
+//
+//  Purpose: To create a MeshSimplifier for the specified model.
+//  Parameter(s):
+//    <1> model: The model to simplify
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A MeshSimplifier is created for the faces of
+//               model.  Faces with more than 3 vertexes are
+//               split into triangles.
+//
+	MeshSimplifier (const ObjModel& model);
+
+//
+//  getTriangleCount
+//
+//  Purpose: To determine the number of triangles in the
+//           original model.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of triangles before simplification.
+//  Side Effect: N/A
+//
+	unsigned int getTriangleCount () const;
+
+//
+//  getPositionCount
+//
+//  Purpose: To determine the number of distinct vertex
+//           positions in the original model.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of positions after exactly equal
+//           positions are merged.
+//  Side Effect: N/A
+//
+	unsigned int getPositionCount () const;
+
+//
+//  getSeamPositionCount
+//
+//  Purpose: To determine the number of vertex positions in the
+//           original model that lie on a texture coordinate or
+//           normal seam.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of positions with more than one wedge.
+//  Side Effect: N/A
+//
+	unsigned int getSeamPositionCount () const;
+
+//
+//  getSimplified
+//
+//  Purpose: To create a simplified version of the model.
+//  Parameter(s):
+//    <1> triangle_ratio: The fraction of triangles to keep
+//  Precondition(s):
+//    <1> triangle_ratio > 0.0
+//    <2> triangle_ratio <= 1.0
+//  Returns: A model with at most triangle_ratio *
+//           getTriangleCount() triangles, or as few as could be
+//           reached without breaking seams, boundaries, or the
+//           surface, or moving the surface too far from the
+//           original.  It uses the same material libraries and
+//           materials as the original model, and is named with
+//           getLodFileName.
+//  Side Effect: N/A
+//
+	ObjModel getSimplified (double triangle_ratio) const;
+
+//
+//  getSimplified
+//
+//  Purpose: To create several simplified versions of the model.
+//  Parameter(s):
+//    <1> triangle_ratios: The fraction of triangles to keep in
+//                         each version
+//  Precondition(s):
+//    <1> triangle_ratios[i] > 0.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//    <2> triangle_ratios[i] <= 1.0
+//        WHERE 0 <= i < triangle_ratios.size()
+//  Returns: The simplified models, in the same order as
+//           triangle_ratios.  They are produced by one pass of
+//           collapses, so each one is a simplification of any
+//           version with a higher ratio.  Each model is named
+//           with getLodFileName, so saving it writes its cache
+//           file.
+//  Side Effect: N/A
+//
+	std::vector<ObjModel> getSimplified (
+	                const std::vector<double>& triangle_ratios) const;
+
+private:
+//
+//  Wedge
+//
+//  A record to represent one combination of a position,
+//    texture coordinates, and normal used by the model.  The
+//    texture coordinates and normal are indexes into the
+//    original model, and may be NO_TEXTURE_COORDINATES or
+//    NO_NORMAL.
+//
+	struct Wedge
+	{
+		unsigned int m_position;
+		unsigned int m_texture_coordinates;
+		unsigned int m_normal;
+	};
+
+//
+//  Triangle
+//
+//  A record to represent a triangle in the original model.
+//
+	struct Triangle
+	{
+		unsigned int ma_wedges[3];
+		unsigned int m_mesh;
+	};
+
+//
+//  State
+//
+//  A record to represent the changing mesh during
+//    simplification.  It is only defined in MeshSimplifier.cpp.
+//
+	struct State;
+
+//
+//  initState
+//
+//  Purpose: To prepare the simplification state for the
+//           original model.
+//  Parameter(s):
+//    <1> r_state: The state to prepare
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: r_state is set to the original model, with the
+//               quadric for each position and a candidate
+//               collapse for each edge.
+//
+	void initState (State& r_state) const;
+
+//
+//  collapseTo
+//
+//  Purpose: To collapse edges until there are few enough
+//           triangles left.
+//  Parameter(s):
+//    <1> r_state: The simplification state
+//    <2> target_count: The number of triangles to stop at
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The cheapest valid collapses in r_state are
+//               performed until at most target_count triangles
+//               remain or no valid collapses remain.
+//
+	void collapseTo (State& r_state,
+	                 unsigned int target_count) const;
+
+//
+//  makeModel
+//
+//  Purpose: To create an ObjModel from the simplification
+//           state.
+//  Parameter(s):
+//    <1> state: The simplification state
+//    <2> filename: The file name and path to give the model
+//  Precondition(s): N/A
+//  Returns: An ObjModel containing the triangles remaining in
+//           state.
+//  Side Effect: N/A
+//
+	ObjModel makeModel (const State& state,
+	                    const std::string& filename) const;
+
+//
+//  invariant
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool invariant () const;
+
+private:
+	ObjModel m_model;
+	std::vector<Vector3> mv_positions;
+	std::vector<unsigned int> mv_position_wedge_counts;
+	std::vector<Wedge> mv_wedges;
+	std::vector<Triangle> mv_triangles;
+};
+
+
+
+}  // end of namespace ObjLibrary
+
+#endif
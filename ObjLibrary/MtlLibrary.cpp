@@ -305,6 +305,24 @@ const Material* MtlLibrary :: getMaterial (const string& name) const
 		return mvp_materials[index];
 }
 
+void MtlLibrary :: getDisplayTextureNames (vector<string>& r_names) const
+{
+	// same order as Material::loadDisplayTextures
+	for(unsigned int i = 0; i < (unsigned int)(mvp_materials.size()); i++)
+	{
+		const Material& material = *(mvp_materials[i]);
+		const string& texture_path = material.getTexturePath();
+		if(material.isDiffuseMap())
+			r_names.push_back(texture_path + material.getDiffuseMapFilename());
+		else if(material.isAmbientMap())
+			r_names.push_back(texture_path + material.getAmbientMapFilename());
+		else if(material.isSpecularMap())
+			r_names.push_back(texture_path + material.getSpecularMapFilename());
+		else if(material.isEmissionMap())
+			r_names.push_back(texture_path + material.getEmissionMapFilename());
+	}
+}
+
 
 
 #ifndef OBJ_LIBRARY_SHADER_DISPLAY
@@ -382,6 +382,24 @@ public:
 	Material* getMaterial (const std::string& name);
 	const Material* getMaterial (const std::string& name) const;
 
+//
+//  getDisplayTextureNames
+//
+//  Purpose: To determine which texture files the Materials in
+//           this MtlLibrary will use for display.
+//  Parameter(s):
+//    <1> r_names: The vector to add the texture names to
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: For each Material that has a texture map, the
+//               name, with the texture path, of the texture it
+//               tries first for display is added to r_names.
+//               This is the diffuse map if there is one, and
+//               otherwise the ambient, specular, or emission
+//               map, in that order.  No texture is loaded.
+//
+	void getDisplayTextureNames (std::vector<std::string>& r_names) const;
+
 #ifndef OBJ_LIBRARY_SHADER_DISPLAY
 //
 //  activateMaterial
@@ -20,8 +20,10 @@
 #include <cassert>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 #include "ObjStringParsing.h"
 #include "MtlLibrary.h"
@@ -35,12 +37,66 @@ namespace
 {
 	std::vector<MtlLibrary*> g_mtl_libraries;
 	MtlLibrary g_empty;
+
+	// the MtlLibraries, by lowercase name with path
+	std::unordered_map<std::string, MtlLibrary*> g_mtl_library_names;
+
+	// guards g_mtl_libraries and g_mtl_library_names, but not
+	//  the MtlLibraries in them
+	std::mutex g_mtl_libraries_mutex;
+
+	//
+	//  findLibrary
+	//
+	//  Purpose: To find the loaded material library with the
+	//           specified name.
+	//  Parameter(s):
+	//    <1> lower: The name of the material library, in
+	//               lowercase
+	//  Precondition(s):
+	//    <1> g_mtl_libraries_mutex is locked
+	//  Returns: The MtlLibrary with name lower, or NULL if
+	//           there is no such MtlLibrary.
+	//  Side Effect: N/A
+	//
+	MtlLibrary* findLibrary (const string& lower)
+	{
+		unordered_map<string, MtlLibrary*>::const_iterator it = g_mtl_library_names.find(lower);
+		if(it == g_mtl_library_names.end())
+			return NULL;
+		return it->second;
+	}
+
+	//
+	//  addLibrary
+	//
+	//  Purpose: To add a copy of a material library.
+	//  Parameter(s):
+	//    <1> mtl_library: The material library
+	//  Precondition(s):
+	//    <1> g_mtl_libraries_mutex is locked
+	//    <2> findLibrary(mtl_library.getFileNameWithPathLowercase())
+	//        == NULL
+	//  Returns: The copy of mtl_library that was added.
+	//  Side Effect: A copy of mtl_library is added to
+	//               g_mtl_libraries and g_mtl_library_names.
+	//
+	MtlLibrary& addLibrary (const MtlLibrary& mtl_library)
+	{
+		assert(findLibrary(mtl_library.getFileNameWithPathLowercase()) == NULL);
+
+		MtlLibrary* p_library = new MtlLibrary(mtl_library);
+		g_mtl_libraries.push_back(p_library);
+		g_mtl_library_names[p_library->getFileNameWithPathLowercase()] = p_library;
+		return *p_library;
+	}
 }
 
 
 
 unsigned int MtlLibraryManager :: getCount ()
 {
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
 	return (unsigned int)(g_mtl_libraries.size());
 }
 
@@ -48,6 +104,7 @@ MtlLibrary& MtlLibraryManager :: get (unsigned int index)
 {
 	assert(index < getCount());
 
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
 	return *(g_mtl_libraries[index]);
 }
 
@@ -62,10 +119,8 @@ bool MtlLibraryManager :: isLoaded (const std::string& name)
 {
 	string lower = toLowercase(name);
 
-	for(unsigned int i = 0; i < (unsigned int)(g_mtl_libraries.size()); i++)
-		if(g_mtl_libraries[i]->getFileNameWithPathLowercase() == lower)
-			return true;
-	return false;
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
+	return findLibrary(lower) != NULL;
 }
 
 MtlLibrary& MtlLibraryManager :: get (const char* a_name)
@@ -113,15 +168,24 @@ MtlLibrary& MtlLibraryManager :: get (const string& name, const string& logfile)
 MtlLibrary& MtlLibraryManager :: get (const string& name, ostream& r_logstream)
 {
 	string lower = toLowercase(name);
+	{
+		lock_guard<mutex> lock(g_mtl_libraries_mutex);
+		MtlLibrary* p_library = findLibrary(lower);
+		if(p_library != NULL)
+			return *p_library;
+	}
+
+	if(!endsWith(lower, ".mtl"))
+		return g_empty;
 
-	for(unsigned int i = 0; i < (unsigned int)(g_mtl_libraries.size()); i++)
-		if(g_mtl_libraries[i]->getFileNameWithPathLowercase() == lower)
-			return *(g_mtl_libraries[i]);
+	// parse without the lock so other libraries can load meanwhile
+	MtlLibrary mtl_library(name, r_logstream);
 
-	if(endsWith(lower, ".mtl"))
-		return add(MtlLibrary(name, r_logstream));
-	else
-		return g_empty;
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
+	MtlLibrary* p_library = findLibrary(lower);
+	if(p_library != NULL)
+		return *p_library;  // another thread loaded it first
+	return addLibrary(mtl_library);
 }
 
 bool MtlLibraryManager :: isMaterial (const char* a_name, const char* a_material)
@@ -230,17 +294,17 @@ MtlLibrary& MtlLibraryManager :: add (const MtlLibrary& mtl_library)
 {
 	assert(!isLoaded(mtl_library.getFileNameWithPathLowercase()));
 
-	unsigned int index = (unsigned int)(g_mtl_libraries.size());
-	g_mtl_libraries.push_back(new MtlLibrary(mtl_library));
-
-	return *(g_mtl_libraries[index]);
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
+	return addLibrary(mtl_library);
 }
 
 void MtlLibraryManager :: unloadAll ()
 {
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
 	for(unsigned int i = 0; i < (unsigned int)(g_mtl_libraries.size()); i++)
 		delete g_mtl_libraries[i];
 	g_mtl_libraries.clear();
+	g_mtl_library_names.clear();
 }
 
 void MtlLibraryManager :: loadDisplayTextures ()
@@ -258,3 +322,10 @@ void MtlLibraryManager :: loadAllTextures ()
 	for(unsigned int i = 0; i < (unsigned int)(g_mtl_libraries.size()); i++)
 		g_mtl_libraries[i]->loadAllTextures();
 }
+
+void MtlLibraryManager :: getDisplayTextureNames (vector<string>& r_names)
+{
+	lock_guard<mutex> lock(g_mtl_libraries_mutex);
+	for(unsigned int i = 0; i < (unsigned int)(g_mtl_libraries.size()); i++)
+		g_mtl_libraries[i]->getDisplayTextureNames(r_names);
+}
@@ -22,6 +22,9 @@
 #ifndef OBJ_LIBRARY_MTL_LIBRARY_MANAGER_H
 #define OBJ_LIBRARY_MTL_LIBRARY_MANAGER_H
 
+#include <string>
+#include <vector>
+#include <iostream>
 
 
 namespace ObjLibrary
@@ -37,6 +40,18 @@ class Material;
 //
 //  A global service to handle MtlLibraries.
 //
+//  The functions that find, load, and add MtlLibraries may be
+//    called from more than one thread at once, so models can be
+//    loaded in parallel.  If two threads load the same MTL file
+//    at the same time, both parse it and only one copy is kept.
+//    The functions that load textures use OpenGL and must only
+//    be called from the thread with the OpenGL context.
+//
+//  The MtlLibraries are indexed by their lowercase names in a
+//    hash table, so finding one by name takes constant time on
+//    average.  A MtlLibrary in the manager must therefore not be
+//    renamed or loaded from a different file.
+//
 namespace MtlLibraryManager
 {
 
@@ -365,6 +380,25 @@ void loadDisplayTextures ();
 //
 void loadAllTextures ();
 
+//
+//  getDisplayTextureNames
+//
+//  Purpose: To determine which texture files are used when
+//           displaying the Materials in the material library
+//           manager.
+//  Parameter(s):
+//    <1> r_names: The vector to add the texture names to
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The names of the textures that each MtlLibrary
+//               tries first for display are added to r_names,
+//               as by MtlLibrary::getDisplayTextureNames.  A
+//               name may be added more than once.  No texture
+//               is loaded, so this can be used to decode the
+//               textures before loadDisplayTextures is called.
+//
+void getDisplayTextureNames (std::vector<std::string>& r_names);
+
 
 
 };	// end of namespace MtlLibraryManager
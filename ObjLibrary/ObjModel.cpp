@@ -19,7 +19,7 @@
 
 #include <cassert>
 #include <cctype>
-#include <cstdlib>	// for atoi
+#include <cstring>	// for memchr
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -36,7 +36,9 @@
 #endif
 
 #include "ObjStringParsing.h"
+#include "MappedFile.h"
 #include "DisplayList.h"
+#include "CompiledMesh.h"
 #include "Material.h"
 #include "MtlLibrary.h"
 #include "MtlLibraryManager.h"
@@ -82,6 +84,102 @@ namespace
 		const bool DEBUGGING_VERTEX_BUFFER = false;
 		const bool DEBUGGING_FACE_SHADERS  = false;
 	#endif
+
+	//
+	//  isSpaceAt
+	//
+	//  Purpose: To determine if there is a whitespace character
+	//           at the specified position in a line.
+	//  Parameter(s):
+	//    <1> a_current: The position to check
+	//    <2> a_end: One past the end of the line
+	//  Precondition(s):
+	//    <1> a_current <= a_end
+	//  Returns: Whether a_current is before a_end and is a
+	//           whitespace character.  The end of the line is
+	//           treated like the null terminator of a string.
+	//  Side Effect: N/A
+	//
+	inline bool isSpaceAt (const char* a_current, const char* a_end)
+	{
+		assert(a_current <= a_end);
+
+		return a_current < a_end && isWhitespace(*a_current);
+	}
+
+	//
+	//  isKeyword
+	//
+	//  Purpose: To determine if a line starts with the specified
+	//           keyword followed by whitespace.
+	//  Parameter(s):
+	//    <1> a_line: The start of the line
+	//    <2> a_end: One past the end of the line
+	//    <3> a_keyword: The keyword
+	//  Precondition(s):
+	//    <1> a_line <= a_end
+	//    <2> a_keyword != NULL
+	//  Returns: Whether the line starts with a_keyword and a
+	//           whitespace character.
+	//  Side Effect: N/A
+	//
+	inline bool isKeyword (const char* a_line, const char* a_end,
+	                       const char* a_keyword)
+	{
+		assert(a_line <= a_end);
+		assert(a_keyword != NULL);
+
+		const char* p = a_line;
+		for(; *a_keyword != '\0'; a_keyword++, p++)
+			if(p >= a_end || *p != *a_keyword)
+				return false;
+		return isSpaceAt(p, a_end);
+	}
+
+	//
+	//  countAttributeLines
+	//
+	//  Purpose: To count the vertex, texture coordinate, and
+	//           normal lines in the contents of an OBJ file.
+	//  Parameter(s):
+	//    <1> a_file: The start of the file contents
+	//    <2> a_file_end: One past the end of the file contents
+	//    <3> r_vertex_count: The number of vertex lines
+	//    <4> r_texture_coordinate_count: The number of texture
+	//                                    coordinate lines
+	//    <5> r_normal_count: The number of normal lines
+	//  Precondition(s):
+	//    <1> a_file <= a_file_end
+	//  Returns: N/A
+	//  Side Effect: The counts are set.  They are an upper
+	//               bound, as some of the lines may be invalid.
+	//
+	void countAttributeLines (const char* a_file,
+	                          const char* a_file_end,
+	                          size_t& r_vertex_count,
+	                          size_t& r_texture_coordinate_count,
+	                          size_t& r_normal_count)
+	{
+		assert(a_file <= a_file_end);
+
+		r_vertex_count             = 0;
+		r_texture_coordinate_count = 0;
+		r_normal_count             = 0;
+		for(const char* a_line = a_file; a_line < a_file_end; )
+		{
+			if(isKeyword(a_line, a_file_end, "v"))
+				r_vertex_count++;
+			else if(isKeyword(a_line, a_file_end, "vt"))
+				r_texture_coordinate_count++;
+			else if(isKeyword(a_line, a_file_end, "vn"))
+				r_normal_count++;
+
+			const char* a_newline = (const char*)(memchr(a_line, '\n', a_file_end - a_line));
+			if(a_newline == NULL)
+				break;
+			a_line = a_newline + 1;
+		}
+	}
 }
 
 
@@ -487,7 +585,7 @@ unsigned int ObjModel :: getPointSetCount (unsigned int mesh) const
 {
 	assert(mesh < getMeshCount());
 
-	return (unsigned int)(mv_meshes[mesh].mv_point_sets.size());
+	return mv_meshes[mesh].m_point_sets.getCount();
 }
 
 unsigned int ObjModel :: getPointSetVertexCount (unsigned int mesh, unsigned int point_set) const
@@ -495,7 +593,7 @@ unsigned int ObjModel :: getPointSetVertexCount (unsigned int mesh, unsigned int
 	assert(mesh < getMeshCount());
 	assert(point_set < getPointSetCount(mesh));
 
-	return (unsigned int)(mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes.size());
+	return mv_meshes[mesh].m_point_sets.getSize(point_set);
 }
 
 unsigned int ObjModel :: getPointSetVertexIndex (unsigned int mesh, unsigned int point_set, unsigned int vertex) const
@@ -504,14 +602,14 @@ unsigned int ObjModel :: getPointSetVertexIndex (unsigned int mesh, unsigned int
 	assert(point_set < getPointSetCount(mesh));
 	assert(vertex < getPointSetVertexCount(mesh, point_set));
 
-	return mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes[vertex];
+	return mv_meshes[mesh].m_point_sets.getList(point_set)[vertex];
 }
 
 unsigned int ObjModel :: getPolylineCount (unsigned int mesh) const
 {
 	assert(mesh < getMeshCount());
 
-	return (unsigned int)(mv_meshes[mesh].mv_polylines.size());
+	return mv_meshes[mesh].m_polylines.getCount();
 }
 
 unsigned int ObjModel :: getPolylineVertexCount (unsigned int mesh, unsigned int polyline) const
@@ -519,7 +617,7 @@ unsigned int ObjModel :: getPolylineVertexCount (unsigned int mesh, unsigned int
 	assert(mesh < getMeshCount());
 	assert(polyline < getPolylineCount(mesh));
 
-	return (unsigned int)(mv_meshes[mesh].mv_polylines[polyline].mv_vertexes.size());
+	return mv_meshes[mesh].m_polylines.getSize(polyline);
 }
 
 unsigned int ObjModel :: getPolylineVertexIndex (unsigned int mesh, unsigned int polyline, unsigned int vertex) const
@@ -528,7 +626,7 @@ unsigned int ObjModel :: getPolylineVertexIndex (unsigned int mesh, unsigned int
 	assert(polyline < getPolylineCount(mesh));
 	assert(vertex < getPolylineVertexCount(mesh, polyline));
 
-	return mv_meshes[mesh].mv_polylines[polyline].mv_vertexes[vertex].m_vertex;
+	return mv_meshes[mesh].m_polylines.getList(polyline)[vertex].m_vertex;
 }
 
 unsigned int ObjModel :: getPolylineVertexTextureCoordinates (unsigned int mesh, unsigned int polyline, unsigned int vertex) const
@@ -537,7 +635,7 @@ unsigned int ObjModel :: getPolylineVertexTextureCoordinates (unsigned int mesh,
 	assert(polyline < getPolylineCount(mesh));
 	assert(vertex < getPolylineVertexCount(mesh, polyline));
 
-	return mv_meshes[mesh].mv_polylines[polyline].mv_vertexes[vertex].m_texture_coordinate;
+	return mv_meshes[mesh].m_polylines.getList(polyline)[vertex].m_texture_coordinate;
 }
 
 bool ObjModel :: isPolylineTextureCoordinatesAny (unsigned int mesh, unsigned int polyline) const
@@ -545,9 +643,10 @@ bool ObjModel :: isPolylineTextureCoordinatesAny (unsigned int mesh, unsigned in
 	assert(mesh < getMeshCount());
 	assert(polyline < getPolylineCount(mesh));
 
-	const vector<PolylineVertex>& v_vertexes = mv_meshes[mesh].mv_polylines[polyline].mv_vertexes;
-	for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
-		if(v_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
+	const PolylineVertex* a_vertexes = mv_meshes[mesh].m_polylines.getList(polyline);
+	unsigned int vertex_count = mv_meshes[mesh].m_polylines.getSize(polyline);
+	for(unsigned int i = 0; i < vertex_count; i++)
+		if(a_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
 			return true;
 	return false;
 }
@@ -556,7 +655,7 @@ unsigned int ObjModel :: getFaceCount (unsigned int mesh) const
 {
 	assert(mesh < getMeshCount());
 
-	return (unsigned int)(mv_meshes[mesh].mv_faces.size());
+	return mv_meshes[mesh].m_faces.getCount();
 }
 
 unsigned int ObjModel :: getFaceVertexCount (unsigned int mesh, unsigned int face) const
@@ -564,7 +663,7 @@ unsigned int ObjModel :: getFaceVertexCount (unsigned int mesh, unsigned int fac
 	assert(mesh < getMeshCount());
 	assert(face < getFaceCount(mesh));
 
-	return (unsigned int)(mv_meshes[mesh].mv_faces[face].mv_vertexes.size());
+	return mv_meshes[mesh].m_faces.getSize(face);
 }
 
 unsigned int ObjModel :: getFaceVertexIndex (unsigned int mesh, unsigned int face, unsigned int vertex) const
@@ -573,7 +672,7 @@ unsigned int ObjModel :: getFaceVertexIndex (unsigned int mesh, unsigned int fac
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	return mv_meshes[mesh].mv_faces[face].mv_vertexes[vertex].m_vertex;
+	return mv_meshes[mesh].m_faces.getList(face)[vertex].m_vertex;
 }
 
 unsigned int ObjModel :: getFaceVertexTextureCoordinates (unsigned int mesh, unsigned int face, unsigned int vertex) const
@@ -582,7 +681,7 @@ unsigned int ObjModel :: getFaceVertexTextureCoordinates (unsigned int mesh, uns
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	return mv_meshes[mesh].mv_faces[face].mv_vertexes[vertex].m_texture_coordinate;
+	return mv_meshes[mesh].m_faces.getList(face)[vertex].m_texture_coordinate;
 }
 
 unsigned int ObjModel :: getFaceVertexNormal (unsigned int mesh, unsigned int face, unsigned int vertex) const
@@ -591,7 +690,7 @@ unsigned int ObjModel :: getFaceVertexNormal (unsigned int mesh, unsigned int fa
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	return mv_meshes[mesh].mv_faces[face].mv_vertexes[vertex].m_normal;
+	return mv_meshes[mesh].m_faces.getList(face)[vertex].m_normal;
 }
 
 bool ObjModel :: isFaceTextureCoordinatesAny (unsigned int mesh, unsigned int face) const
@@ -599,9 +698,10 @@ bool ObjModel :: isFaceTextureCoordinatesAny (unsigned int mesh, unsigned int fa
 	assert(mesh < getMeshCount());
 	assert(face < getFaceCount(mesh));
 
-	const vector<FaceVertex>& v_vertexes = mv_meshes[mesh].mv_faces[face].mv_vertexes;
-	for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
-		if(v_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
+	const FaceVertex* a_vertexes = mv_meshes[mesh].m_faces.getList(face);
+	unsigned int vertex_count = mv_meshes[mesh].m_faces.getSize(face);
+	for(unsigned int i = 0; i < vertex_count; i++)
+		if(a_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
 			return true;
 	return false;
 }
@@ -611,9 +711,10 @@ bool ObjModel :: isFaceNormalAny (unsigned int mesh, unsigned int face) const
 	assert(mesh < getMeshCount());
 	assert(face < getFaceCount(mesh));
 
-	const vector<FaceVertex>& v_vertexes = mv_meshes[mesh].mv_faces[face].mv_vertexes;
-	for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
-		if(v_vertexes[i].m_normal != NO_NORMAL)
+	const FaceVertex* a_vertexes = mv_meshes[mesh].m_faces.getList(face);
+	unsigned int vertex_count = mv_meshes[mesh].m_faces.getSize(face);
+	for(unsigned int i = 0; i < vertex_count; i++)
+		if(a_vertexes[i].m_normal != NO_NORMAL)
 			return true;
 	return false;
 }
@@ -629,14 +730,11 @@ bool ObjModel :: isMeshTextureCoordinatesAny (unsigned int mesh) const
 {
 	assert(mesh < getMeshCount());
 
-	const vector<Face>& v_faces = mv_meshes[mesh].mv_faces;
-	for(unsigned int f = 0; f < (unsigned int)(v_faces.size()); f++)
-	{
-		const vector<FaceVertex>& v_vertexes = v_faces[f].mv_vertexes;
-		for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
-			if(v_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
-				return true;
-	}
+	// the faces are stored one after another
+	const vector<FaceVertex>& v_vertexes = mv_meshes[mesh].m_faces.mv_elements;
+	for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
+		if(v_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
+			return true;
 	return false;
 }
 
@@ -644,14 +742,11 @@ bool ObjModel :: isMeshNormalAny (unsigned int mesh) const
 {
 	assert(mesh < getMeshCount());
 
-	const vector<Face>& v_faces = mv_meshes[mesh].mv_faces;
-	for(unsigned int f = 0; f < (unsigned int)(v_faces.size()); f++)
-	{
-		const vector<FaceVertex>& v_vertexes = v_faces[f].mv_vertexes;
-		for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
-			if(v_vertexes[i].m_normal != NO_NORMAL)
-				return true;
-	}
+	// the faces are stored one after another
+	const vector<FaceVertex>& v_vertexes = mv_meshes[mesh].m_faces.mv_elements;
+	for(unsigned int i = 0; i < (unsigned int)(v_vertexes.size()); i++)
+		if(v_vertexes[i].m_normal != NO_NORMAL)
+			return true;
 	return false;
 }
 
@@ -659,18 +754,14 @@ unsigned int ObjModel :: getMeshPointCountTotal (unsigned int mesh) const
 {
 	assert(mesh < getMeshCount());
 
-	unsigned int total = 0;
-	const vector<PointSet>& v_point_sets = mv_meshes[mesh].mv_point_sets;
-	for(unsigned int i = 0; i < (unsigned int)(v_point_sets.size()); i++)
-		total += (unsigned int)(v_point_sets[i].mv_vertexes.size());
-	return total;
+	return mv_meshes[mesh].m_point_sets.getSizeTotal();
 }
 
 unsigned int ObjModel :: getPointSetCountTotal () const
 {
 	unsigned int total = 0;
 	for(unsigned int i = 0; i < (unsigned int)(mv_meshes.size()); i++)
-		total += (unsigned int)(mv_meshes[i].mv_point_sets.size());
+		total += mv_meshes[i].m_point_sets.getCount();
 	return total;
 }
 
@@ -678,7 +769,7 @@ unsigned int ObjModel :: getPolylineCountTotal () const
 {
 	unsigned int total = 0;
 	for(unsigned int i = 0; i < (unsigned int)(mv_meshes.size()); i++)
-		total += (unsigned int)(mv_meshes[i].mv_polylines.size());
+		total += mv_meshes[i].m_polylines.getCount();
 	return total;
 }
 
@@ -686,7 +777,7 @@ unsigned int ObjModel :: getFaceCountTotal () const
 {
 	unsigned int total = 0;
 	for(unsigned int i = 0; i < (unsigned int)(mv_meshes.size()); i++)
-		total += (unsigned int)(mv_meshes[i].mv_faces.size());
+		total += mv_meshes[i].m_faces.getCount();
 	return total;
 }
 
@@ -896,6 +987,70 @@ void ObjModel :: printBadMaterials (ostream& r_logstream) const
 		}
 }
 
+CompiledMesh ObjModel :: getCompiledMesh () const
+{
+	assert(isValid());
+
+	// OpenGL starts with these as the current normal and texture coordinates
+	float a_current[CompiledMesh::FLOATS_PER_VERTEX] =
+	{
+		0.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f,
+		0.0f, 0.0f,
+	};
+
+	CompiledMesh compiled;
+	vector<float> v_face;
+	for(unsigned int m = 0; m < getMeshCount(); m++)
+	{
+		compiled.beginRange(mv_meshes[m].m_material_name, mv_meshes[m].mp_material);
+
+		for(unsigned int f = 0; f < getFaceCount(m); f++)
+		{
+			const FaceVertex* a_face = mv_meshes[m].m_faces.getList(f);
+
+			v_face.clear();
+			for(unsigned int v = 0; v < mv_meshes[m].m_faces.getSize(f); v++)
+			{
+				unsigned int vertex              = a_face[v].m_vertex;
+				unsigned int texture_coordinates = a_face[v].m_texture_coordinate;
+				unsigned int normal              = a_face[v].m_normal;
+
+				if(normal != NO_NORMAL)
+				{
+					a_current[CompiledMesh::NORMAL_OFFSET + 0] = (float)(mv_normals[normal].x);
+					a_current[CompiledMesh::NORMAL_OFFSET + 1] = (float)(mv_normals[normal].y);
+					a_current[CompiledMesh::NORMAL_OFFSET + 2] = (float)(mv_normals[normal].z);
+				}
+
+				if(texture_coordinates != NO_TEXTURE_COORDINATES)
+				{
+					// flip texture coordinates to match Maya <|>
+					a_current[CompiledMesh::TEXTURE_COORDINATE_OFFSET + 0] = (float)(      mv_texture_coordinates[texture_coordinates].x);
+					a_current[CompiledMesh::TEXTURE_COORDINATE_OFFSET + 1] = (float)(1.0 - mv_texture_coordinates[texture_coordinates].y);
+				}
+
+				a_current[CompiledMesh::POSITION_OFFSET + 0] = (float)(mv_vertexes[vertex].x);
+				a_current[CompiledMesh::POSITION_OFFSET + 1] = (float)(mv_vertexes[vertex].y);
+				a_current[CompiledMesh::POSITION_OFFSET + 2] = (float)(mv_vertexes[vertex].z);
+				v_face.insert(v_face.end(), a_current, a_current + CompiledMesh::FLOATS_PER_VERTEX);
+			}
+
+			// triangle fan around the first vertex
+			unsigned int corner_count = (unsigned int)(v_face.size() / CompiledMesh::FLOATS_PER_VERTEX);
+			for(unsigned int c = 2; c < corner_count; c++)
+			{
+				compiled.addVertex(&v_face[0]);
+				compiled.addVertex(&v_face[(c - 1) * CompiledMesh::FLOATS_PER_VERTEX]);
+				compiled.addVertex(&v_face[ c      * CompiledMesh::FLOATS_PER_VERTEX]);
+			}
+		}
+	}
+	compiled.finish();
+
+	return compiled;
+}
+
 
 
 #ifndef OBJ_LIBRARY_SHADER_DISPLAY
@@ -1184,7 +1339,7 @@ void ObjModel :: drawWireframe (double red, double green, double blue) const
 			glBegin(GL_LINE_LOOP);
 				for(unsigned int v = 0; v < getFaceVertexCount(m, f); v++)
 				{
-					unsigned int vertex = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_vertex;
+					unsigned int vertex = mv_meshes[m].m_faces.getList(f)[v].m_vertex;
 					glVertex3dv(mv_vertexes[vertex].getAsArray());
 				}
 			glEnd();
@@ -1298,8 +1453,8 @@ void ObjModel :: drawVertexNormals (double length, double red, double green, dou
 			for(unsigned int f = 0; f < getFaceCount(m); f++)
 				for(unsigned int v = 0; v < getFaceVertexCount(m, f); v++)
 				{
-					unsigned int vertex = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_vertex;
-					unsigned int normal = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_normal;
+					unsigned int vertex = mv_meshes[m].m_faces.getList(f)[v].m_vertex;
+					unsigned int normal = mv_meshes[m].m_faces.getList(f)[v].m_normal;
 
 					if(normal != NO_NORMAL)
 					{
@@ -1374,8 +1529,8 @@ void ObjModel :: drawFaceNormals (double length, double red, double green, doubl
 
 				for(unsigned int v = 0; v < getFaceVertexCount(m, f); v++)
 				{
-					unsigned int vertex = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_vertex;
-					unsigned int normal = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_normal;
+					unsigned int vertex = mv_meshes[m].m_faces.getList(f)[v].m_vertex;
+					unsigned int normal = mv_meshes[m].m_faces.getList(f)[v].m_normal;
 
 					assert(vertex < getVertexCount());
 					center += mv_vertexes[vertex];
@@ -1575,12 +1730,12 @@ ModelWithShader ObjModel :: getModelWithShader (bool is_texture_coordinates,
 		// add point sets
 		if(getPointSetCount(m) > 0)
 		{
-			assert(!mv_meshes[m].mv_point_sets.empty());
+			assert(mv_meshes[m].m_point_sets.getCount() > 0);
 			result.addMesh(material_index, getPointSetMeshWithShader(m));
 		}
 
 		// add polylines
-		for(unsigned int l = 0; l < (unsigned int)(mv_meshes[m].mv_polylines.size()); l++)
+		for(unsigned int l = 0; l < mv_meshes[m].m_polylines.getCount(); l++)
 		{
 			bool is_polyline_texture_coordinates = is_texture_coordinates;
 			if(!isPolylineTextureCoordinatesAny(m, l))
@@ -1592,7 +1747,7 @@ ModelWithShader ObjModel :: getModelWithShader (bool is_texture_coordinates,
 		// add faces
 		if(getFaceCount(m) > 0)
 		{
-			assert(!mv_meshes[m].mv_faces.empty());
+			assert(mv_meshes[m].m_faces.getCount() > 0);
 
 			bool is_mesh_texture_coordinates = is_texture_coordinates;
 			if(!isMeshTextureCoordinatesAny(m))
@@ -1653,6 +1808,12 @@ void ObjModel :: save (const string& filename, ostream& r_logstream) const
 		return;
 	}
 
+	save(output_file);
+	output_file.close();
+}
+
+void ObjModel :: save (ostream& r_out) const
+{
 	//
 	//  Format of file:
 	//
@@ -1673,29 +1834,29 @@ void ObjModel :: save (const string& filename, ostream& r_logstream) const
 	//    sections are seperated by 1 blank line.
 	//
 
-	output_file << "#" << endl;
-	output_file << "#  " << getFileNameWithPath() << endl;
-	output_file << "#" << endl;
+	r_out << "#" << endl;
+	r_out << "#  " << getFileNameWithPath() << endl;
+	r_out << "#" << endl;
 	if(mv_vertexes.size() > 0)
-		output_file << "#  " << getVertexCount() << " vertexes" << endl;
+		r_out << "#  " << getVertexCount() << " vertexes" << endl;
 	if(mv_texture_coordinates.size() > 0)
-		output_file << "#  " << getTextureCoordinateCount() << " texture coordinate pairs" << endl;
+		r_out << "#  " << getTextureCoordinateCount() << " texture coordinate pairs" << endl;
 	if(mv_normals.size() > 0)
-		output_file << "#  " << getNormalCount() << " vertex normals" << endl;
+		r_out << "#  " << getNormalCount() << " vertex normals" << endl;
 	if(mv_meshes.size() > 0)
 	{
-		output_file << "#  " << getMeshCount() << " meshes" << endl;
+		r_out << "#  " << getMeshCount() << " meshes" << endl;
 		if(getPointSetCountTotal() > 0)
-			output_file << "#     " << getPointSetCountTotal() << " point sets" << endl;
+			r_out << "#     " << getPointSetCountTotal() << " point sets" << endl;
 		if(getPolylineCountTotal() > 0)
-			output_file << "#     " << getPolylineCountTotal() << " polylines" << endl;
+			r_out << "#     " << getPolylineCountTotal() << " polylines" << endl;
 		if(getFaceCountTotal() > 0)
-			output_file << "#     " << getFaceCountTotal() << " faces" << endl;
+			r_out << "#     " << getFaceCountTotal() << " faces" << endl;
 	}
 	if(isAllTriangles())
-		output_file << "#  All faces are triangulated" << endl;
-	output_file << "#" << endl;
-	output_file << endl;
+		r_out << "#  All faces are triangulated" << endl;
+	r_out << "#" << endl;
+	r_out << endl;
 
 	if(DEBUGGING_SAVE)
 		cout << "Wrote file header" << endl;
@@ -1703,25 +1864,25 @@ void ObjModel :: save (const string& filename, ostream& r_logstream) const
 	if(mv_material_libraries.size() > 0)
 	{
 		unsigned int library_count = (unsigned int)(mv_material_libraries.size());
-		output_file << "# " << library_count << " material libraries" << endl;
-		output_file << "mtllib";
+		r_out << "# " << library_count << " material libraries" << endl;
+		r_out << "mtllib";
 		for(unsigned int m = 0; m < library_count; m++)
-			output_file << " " << mv_material_libraries[m].m_file_name;
-		output_file << endl;  // ends previous line
-		output_file << endl;
+			r_out << " " << mv_material_libraries[m].m_file_name;
+		r_out << endl;  // ends previous line
+		r_out << endl;
 
 		if(DEBUGGING_SAVE)
 			cout << "Wrote material libraries" << endl;
 	}
-	output_file << endl;
-	output_file << endl;
+	r_out << endl;
+	r_out << endl;
 
 	if(mv_vertexes.size() > 0)
 	{
-		output_file << "# " << getVertexCount() << " vertexes" << endl;
+		r_out << "# " << getVertexCount() << " vertexes" << endl;
 		for(unsigned int v = 0; v < (unsigned int)(mv_vertexes.size()); v++)
-			output_file << "v " << mv_vertexes[v].x << " " << mv_vertexes[v].y << " " << mv_vertexes[v].z << endl;
-		output_file << endl;
+			r_out << "v " << mv_vertexes[v].x << " " << mv_vertexes[v].y << " " << mv_vertexes[v].z << endl;
+		r_out << endl;
 
 		if(DEBUGGING_SAVE)
 			cout << "Wrote vertexes" << endl;
@@ -1729,10 +1890,10 @@ void ObjModel :: save (const string& filename, ostream& r_logstream) const
 
 	if(mv_texture_coordinates.size() > 0)
 	{
-		output_file << "# " << getTextureCoordinateCount() << " texture coordinate pairs" << endl;
+		r_out << "# " << getTextureCoordinateCount() << " texture coordinate pairs" << endl;
 		for(unsigned int t = 0; t < (unsigned int)(mv_texture_coordinates.size()); t++)
-			output_file << "vt " << mv_texture_coordinates[t].x << " " << mv_texture_coordinates[t].y << endl;
-		output_file << endl;
+			r_out << "vt " << mv_texture_coordinates[t].x << " " << mv_texture_coordinates[t].y << endl;
+		r_out << endl;
 
 		if(DEBUGGING_SAVE)
 			cout << "Wrote texture coordinates" << endl;
@@ -1740,10 +1901,10 @@ void ObjModel :: save (const string& filename, ostream& r_logstream) const
 
 	if(mv_normals.size() > 0)
 	{
-		output_file << "# " << getNormalCount() << " vertex normals" << endl;
+		r_out << "# " << getNormalCount() << " vertex normals" << endl;
 		for(unsigned int n = 0; n < (unsigned int)(mv_normals.size()); n++)
-			output_file << "vn " << mv_normals[n].x << " " << mv_normals[n].y << " " << mv_normals[n].z << endl;
-		output_file << endl;
+			r_out << "vn " << mv_normals[n].x << " " << mv_normals[n].y << " " << mv_normals[n].z << endl;
+		r_out << endl;
 
 		if(DEBUGGING_SAVE)
 			cout << "Wrote normals" << endl;
@@ -1753,101 +1914,99 @@ void ObjModel :: save (const string& filename, ostream& r_logstream) const
 	   mv_texture_coordinates.size() > 0 ||
 	   mv_normals.size() > 0)
 	{
-		output_file << endl;
-		output_file << endl;
+		r_out << endl;
+		r_out << endl;
 	}
 
 	if(mv_meshes.size() > 0)
 	{
-		output_file << "# " << getMeshCount() << " meshes" << endl;
-		output_file << endl;
+		r_out << "# " << getMeshCount() << " meshes" << endl;
+		r_out << endl;
 
 		for(unsigned int m = 0; m < (unsigned int)(mv_meshes.size()); m++)
 		{
 			if(isMeshMaterial(m))
-				output_file << "usemtl " << mv_meshes[m].m_material_name << endl;
+				r_out << "usemtl " << mv_meshes[m].m_material_name << endl;
 
-			if(mv_meshes[m].mv_point_sets.size() > 0)
+			if(mv_meshes[m].m_point_sets.getCount() > 0)
 			{
-				output_file << "# " << getPointSetCount(m) << " faces" << endl;
-				for(unsigned int p = 0; p < (unsigned int)(mv_meshes[m].mv_point_sets.size()); p++)
+				r_out << "# " << getPointSetCount(m) << " faces" << endl;
+				for(unsigned int p = 0; p < mv_meshes[m].m_point_sets.getCount(); p++)
 				{
-					output_file << "p";
-					for(unsigned int i = 0; i < (unsigned int)(mv_meshes[m].mv_point_sets[p].mv_vertexes.size()); i++)
-						output_file << " " << (mv_meshes[m].mv_point_sets[p].mv_vertexes[i] + 1);
-					output_file << endl;
+					r_out << "p";
+					for(unsigned int i = 0; i < mv_meshes[m].m_point_sets.getSize(p); i++)
+						r_out << " " << (mv_meshes[m].m_point_sets.getList(p)[i] + 1);
+					r_out << endl;
 				}
-				output_file << endl;
+				r_out << endl;
 
 				if(DEBUGGING_SAVE)
 					cout << "Wrote point sets for mesh " << m << endl;
 			}
 
-			if(mv_meshes[m].mv_polylines.size() > 0)
+			if(mv_meshes[m].m_polylines.getCount() > 0)
 			{
-				output_file << "# " << getPolylineCount(m) << " faces" << endl;
-				for(unsigned int l = 0; l < (unsigned int)(mv_meshes[m].mv_polylines.size()); l++)
+				r_out << "# " << getPolylineCount(m) << " faces" << endl;
+				for(unsigned int l = 0; l < mv_meshes[m].m_polylines.getCount(); l++)
 				{
-					output_file << "l";
-					for(unsigned int i = 0; i < (unsigned int)(mv_meshes[m].mv_polylines[l].mv_vertexes.size()); i++)
+					r_out << "l";
+					for(unsigned int i = 0; i < mv_meshes[m].m_polylines.getSize(l); i++)
 					{
-						output_file << " " << (mv_meshes[m].mv_polylines[l].mv_vertexes[i].m_vertex + 1);
+						r_out << " " << (mv_meshes[m].m_polylines.getList(l)[i].m_vertex + 1);
 
-						if(mv_meshes[m].mv_polylines[l].mv_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
-							output_file << "/" << (mv_meshes[m].mv_polylines[l].mv_vertexes[i].m_texture_coordinate + 1);
+						if(mv_meshes[m].m_polylines.getList(l)[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
+							r_out << "/" << (mv_meshes[m].m_polylines.getList(l)[i].m_texture_coordinate + 1);
 					}
-					output_file << endl;
+					r_out << endl;
 				}
-				output_file << endl;
+				r_out << endl;
 
 				if(DEBUGGING_SAVE)
 					cout << "Wrote polylines for mesh " << m << endl;
 			}
 
-			if(mv_meshes[m].mv_faces.size() > 0)
+			if(mv_meshes[m].m_faces.getCount() > 0)
 			{
-				output_file << "# " << getFaceCount(m) << " faces" << endl;
-				for(unsigned int f = 0; f < (unsigned int)(mv_meshes[m].mv_faces.size()); f++)
+				r_out << "# " << getFaceCount(m) << " faces" << endl;
+				for(unsigned int f = 0; f < mv_meshes[m].m_faces.getCount(); f++)
 				{
-					output_file << "f";
-					for(unsigned int i = 0; i < (unsigned int)(mv_meshes[m].mv_faces[f].mv_vertexes.size()); i++)
+					r_out << "f";
+					for(unsigned int i = 0; i < mv_meshes[m].m_faces.getSize(f); i++)
 					{
-						output_file << " " << (mv_meshes[m].mv_faces[f].mv_vertexes[i].m_vertex + 1);
+						r_out << " " << (mv_meshes[m].m_faces.getList(f)[i].m_vertex + 1);
 
-						if(mv_meshes[m].mv_faces[f].mv_vertexes[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
+						if(mv_meshes[m].m_faces.getList(f)[i].m_texture_coordinate != NO_TEXTURE_COORDINATES)
 						{
-							output_file << "/" << (mv_meshes[m].mv_faces[f].mv_vertexes[i].m_texture_coordinate + 1);
+							r_out << "/" << (mv_meshes[m].m_faces.getList(f)[i].m_texture_coordinate + 1);
 
-							if(mv_meshes[m].mv_faces[f].mv_vertexes[i].m_normal != NO_NORMAL)
-								output_file << "/" << (mv_meshes[m].mv_faces[f].mv_vertexes[i].m_normal + 1);
+							if(mv_meshes[m].m_faces.getList(f)[i].m_normal != NO_NORMAL)
+								r_out << "/" << (mv_meshes[m].m_faces.getList(f)[i].m_normal + 1);
 						}
-						else if(mv_meshes[m].mv_faces[f].mv_vertexes[i].m_normal != NO_NORMAL)
-							output_file << "//" << (mv_meshes[m].mv_faces[f].mv_vertexes[i].m_normal + 1);
+						else if(mv_meshes[m].m_faces.getList(f)[i].m_normal != NO_NORMAL)
+							r_out << "//" << (mv_meshes[m].m_faces.getList(f)[i].m_normal + 1);
 
 					}
-					output_file << endl;
+					r_out << endl;
 				}
-				output_file << endl;
+				r_out << endl;
 
 				if(DEBUGGING_SAVE)
 					cout << "Wrote faces for mesh " << m << endl;
 			}
 		}
-		output_file << endl;
-		output_file << endl;
-		output_file << endl;
+		r_out << endl;
+		r_out << endl;
+		r_out << endl;
 
 		if(DEBUGGING_SAVE)
 			cout << "Wrote all meshes" << endl;
 	}
 
-	output_file << "# End of " << getFileNameWithPath() << endl;
-	output_file << endl;
+	r_out << "# End of " << getFileNameWithPath() << endl;
+	r_out << endl;
 
 	if(DEBUGGING_SAVE)
 		cout << "Wrote footer" << endl;
-
-	output_file.close();
 }
 
 
@@ -1893,7 +2052,7 @@ void ObjModel :: load (const string& filename, ostream& r_logstream)
 {
 	assert(ObjStringParsing::isValidFilenameWithPath(filename));
 
-	ifstream input_file;
+	MappedFile input_file;
 	unsigned int line_count;
 
 	if(DEBUGGING_LOAD)
@@ -1906,11 +2065,9 @@ void ObjModel :: load (const string& filename, ostream& r_logstream)
 
 	setFileNameWithPath(filename);
 
-	input_file.open(filename.c_str(), ios::in);
-	if(!input_file.is_open())
+	if(!input_file.open(filename))
 	{
 		r_logstream << "Error: File \"" << filename << "\" does not exist" << endl;
-		input_file.close();
 
 		m_file_load_success = false;
 
@@ -1923,68 +2080,78 @@ void ObjModel :: load (const string& filename, ostream& r_logstream)
 	//
 	//  http://www.martinreddy.net/gfx/3d/OBJ.spec
 	//
+	//  The file is parsed where it is mapped, so each line is a
+	//    range of characters that is not null-terminated.  This
+	//    avoids copying every line into strings, which used to
+	//    take most of the loading time for big models.
+	//
+
+	const char* a_file     = input_file.getData();
+	const char* a_file_end = a_file + input_file.getSize();
+
+	size_t vertex_count;
+	size_t texture_coordinate_count;
+	size_t normal_count;
+	countAttributeLines(a_file, a_file_end, vertex_count, texture_coordinate_count, normal_count);
+	mv_vertexes           .reserve(vertex_count);
+	mv_texture_coordinates.reserve(texture_coordinate_count);
+	mv_normals            .reserve(normal_count);
 
 	line_count = 0;
-	while(true)	// drops out at EOF below
+	const char* a_next_line = a_file;
+	while(a_next_line < a_file_end)	// the last line may not end with a newline
 	{
-		string line;
-		size_t line_length;
-		bool valid;
+		const char* a_line = a_next_line;
+		const char* a_line_end = (const char*)(memchr(a_line, '\n', a_file_end - a_line));
+		if(a_line_end == NULL)
+			a_line_end = a_file_end;
+		a_next_line = a_line_end + 1;
 
-		getline(input_file, line);
-		if(line == "" && input_file.eof())
-			break;	// drop out if no more lines (but include last line)
+		size_t line_length = a_line_end - a_line;
+		bool valid;
 
-		line_length = line.length();
 		line_count++;
 
-		if(line_length < 1 || line[0] == '#' || line[0] == '\r' || line[0] == '\n')
+		if(line_length < 1 || a_line[0] == '#' || a_line[0] == '\r')
 			continue;	// skip blank lines and comments
 
 		valid = true;
-		if(line_length < 1)
-			valid = false;
-		else
+		if(isKeyword(a_line, a_line_end, "mtllib"))
+			valid = readMaterialLibrary(a_line + 7, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "usemtl"))
+			valid = readMaterial(a_line + 7, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "v"))
+			valid = readVertex(a_line + 2, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "vt"))
+			valid = readTextureCoordinates(a_line + 3, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "vn"))
+			valid = readNormal(a_line + 3, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "p"))
+			valid = readPointSet(a_line + 2, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "l"))
+			valid = readPolyline(a_line + 2, a_line_end, r_logstream);
+		else if(isKeyword(a_line, a_line_end, "f"))
+			valid = readFace(a_line + 2, a_line_end, r_logstream);
+		else if(a_line[0] == 'g' && (line_length == 1 || isSpaceAt(a_line + 1, a_line_end)))
 		{
-			line = whitespaceToSpaces(line);
-
-			if(startsWith(line, "mtllib "))
-				valid = readMaterialLibrary(line.substr(7), r_logstream);
-			else if(startsWith(line, "usemtl "))
-				valid = readMaterial(line.substr(7), r_logstream);
-			else if(startsWith(line, "v "))
-				valid = readVertex(line.substr(2), r_logstream);
-			else if(startsWith(line, "vt "))
-				valid = readTextureCoordinates(line.substr(3), r_logstream);
-			else if(startsWith(line, "vn "))
-				valid = readNormal(line.substr(3), r_logstream);
-			else if(startsWith(line, "p "))
-				valid = readPointSet(line.substr(2), r_logstream);
-			else if(startsWith(line, "l "))
-				valid = readPolyline(line.substr(2), r_logstream);
-			else if(startsWith(line, "f "))
-				valid = readFace(line.substr(2), r_logstream);
-			else if(line[0] == 'g' && (line.length() == 1 || isspace(line[1])))
-			{
-				if(DEBUGGING_LOAD)
-					r_logstream << "In file \"" << filename << "\": ignoring groupings \"" << line.substr(1) << "\"" << endl;
-			}
-			else if(line[0] == 's' && (line.length() == 1 || isspace(line[1])))
-			{
-				if(DEBUGGING_LOAD)
-					r_logstream << "In file \"" << filename << "\": ignoring smoothing group \"" << line.substr(1) << "\"" << endl;
-			}
-			else if(line[0] == 'o' && (line.length() == 1 || isspace(line[1])))
-			{
-				if(DEBUGGING_LOAD)
-					r_logstream << "In file \"" << filename << "\": ignoring object name \"" << line.substr(1) << "\"" << endl;
-			}
-			else
-				valid = false;
+			if(DEBUGGING_LOAD)
+				r_logstream << "In file \"" << filename << "\": ignoring groupings \"" << whitespaceToSpaces(string(a_line + 1, a_line_end)) << "\"" << endl;
+		}
+		else if(a_line[0] == 's' && (line_length == 1 || isSpaceAt(a_line + 1, a_line_end)))
+		{
+			if(DEBUGGING_LOAD)
+				r_logstream << "In file \"" << filename << "\": ignoring smoothing group \"" << whitespaceToSpaces(string(a_line + 1, a_line_end)) << "\"" << endl;
+		}
+		else if(a_line[0] == 'o' && (line_length == 1 || isSpaceAt(a_line + 1, a_line_end)))
+		{
+			if(DEBUGGING_LOAD)
+				r_logstream << "In file \"" << filename << "\": ignoring object name \"" << whitespaceToSpaces(string(a_line + 1, a_line_end)) << "\"" << endl;
 		}
+		else
+			valid = false;
 
 		if(!valid)
-			r_logstream << "Line " << setw(6) << line_count << " of file \"" << filename << "\" is invalid: \"" << line << "\"" << endl;
+			r_logstream << "Line " << setw(6) << line_count << " of file \"" << filename << "\" is invalid: \"" << whitespaceToSpaces(string(a_line, a_line_end)) << "\"" << endl;
 	}
 
 	input_file.close();
@@ -2247,7 +2414,7 @@ void ObjModel :: setPointSetVertexIndex (unsigned int mesh, unsigned int point_s
 	assert(point_set < getPointSetCount(mesh));
 	assert(vertex < getPointSetVertexCount(mesh, point_set));
 
-	mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes[vertex] = index;
+	mv_meshes[mesh].m_point_sets.getList(point_set)[vertex] = index;
 	if(index >= getVertexCount())
 		m_valid = false;
 
@@ -2260,7 +2427,7 @@ void ObjModel :: setPolylineVertexIndex (unsigned int mesh, unsigned int polylin
 	assert(polyline < getPolylineCount(mesh));
 	assert(vertex < getPolylineVertexCount(mesh, polyline));
 
-	mv_meshes[mesh].mv_polylines[polyline].mv_vertexes[vertex].m_vertex = index;
+	mv_meshes[mesh].m_polylines.getList(polyline)[vertex].m_vertex = index;
 	if(index >= getVertexCount())
 		m_valid = false;
 
@@ -2273,7 +2440,7 @@ void ObjModel :: setPolylineVertexTextureCoordinates (unsigned int mesh, unsigne
 	assert(polyline < getPolylineCount(mesh));
 	assert(vertex < getPolylineVertexCount(mesh, polyline));
 
-	mv_meshes[mesh].mv_polylines[polyline].mv_vertexes[vertex].m_texture_coordinate = index;
+	mv_meshes[mesh].m_polylines.getList(polyline)[vertex].m_texture_coordinate = index;
 	if(index >= getTextureCoordinateCount() && index != NO_TEXTURE_COORDINATES)
 		m_valid = false;
 
@@ -2286,7 +2453,7 @@ void ObjModel :: setFaceVertexIndex (unsigned int mesh, unsigned int face, unsig
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	mv_meshes[mesh].mv_faces[face].mv_vertexes[vertex].m_vertex = index;
+	mv_meshes[mesh].m_faces.getList(face)[vertex].m_vertex = index;
 	if(index >= getVertexCount())
 		m_valid = false;
 
@@ -2299,7 +2466,7 @@ void ObjModel :: setFaceVertexTextureCoordinates (unsigned int mesh, unsigned in
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	mv_meshes[mesh].mv_faces[face].mv_vertexes[vertex].m_texture_coordinate = index;
+	mv_meshes[mesh].m_faces.getList(face)[vertex].m_texture_coordinate = index;
 	if(index >= getTextureCoordinateCount() && index != NO_TEXTURE_COORDINATES)
 		m_valid = false;
 
@@ -2312,7 +2479,7 @@ void ObjModel :: setFaceVertexNormal (unsigned int mesh, unsigned int face, unsi
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	mv_meshes[mesh].mv_faces[face].mv_vertexes[vertex].m_normal = index;
+	mv_meshes[mesh].m_faces.getList(face)[vertex].m_normal = index;
 	if(index >= getVertexCount() && index != NO_NORMAL)
 		m_valid = false;
 
@@ -2435,8 +2602,7 @@ unsigned int ObjModel :: addPointSet (unsigned int mesh)
 {
 	assert(mesh < getMeshCount());
 
-	unsigned int id = (unsigned int)(mv_meshes[mesh].mv_point_sets.size());
-	mv_meshes[mesh].mv_point_sets.push_back(PointSet());
+	unsigned int id = mv_meshes[mesh].m_point_sets.add();
 	m_valid = false;
 
 	if(DEBUGGING_EDITING)
@@ -2451,8 +2617,7 @@ unsigned int ObjModel :: addPointSetVertex (unsigned int mesh, unsigned int poin
 	assert(mesh < getMeshCount());
 	assert(point_set < getPointSetCount(mesh));
 
-	unsigned int id = (unsigned int)(mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes.size());
-	mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes.push_back(vertex);
+	unsigned int id = mv_meshes[mesh].m_point_sets.addElement(point_set, vertex);
 
 	if(vertex >= getVertexCount())
 		m_valid = false;
@@ -2468,8 +2633,7 @@ unsigned int ObjModel :: addPolyline (unsigned int mesh)
 {
 	assert(mesh < getMeshCount());
 
-	unsigned int id = (unsigned int)(mv_meshes[mesh].mv_polylines.size());
-	mv_meshes[mesh].mv_polylines.push_back(Polyline());
+	unsigned int id = mv_meshes[mesh].m_polylines.add();
 	m_valid = false;
 
 	if(DEBUGGING_EDITING)
@@ -2484,8 +2648,7 @@ unsigned int ObjModel :: addPolylineVertex (unsigned int mesh, unsigned int poly
 	assert(mesh < getMeshCount());
 	assert(polyline < getPolylineCount(mesh));
 
-	unsigned int id = (unsigned int)(mv_meshes[mesh].mv_polylines[polyline].mv_vertexes.size());
-	mv_meshes[mesh].mv_polylines[polyline].mv_vertexes.push_back(PolylineVertex(vertex, texture_coordinates));
+	unsigned int id = mv_meshes[mesh].m_polylines.addElement(polyline, PolylineVertex(vertex, texture_coordinates));
 
 	if(vertex >= getVertexCount())
 		m_valid = false;
@@ -2510,8 +2673,7 @@ unsigned int ObjModel :: addFace (unsigned int mesh)
 {
 	assert(mesh < getMeshCount());
 
-	unsigned int id = (unsigned int)(mv_meshes[mesh].mv_faces.size());
-	mv_meshes[mesh].mv_faces.push_back(Face());
+	unsigned int id = mv_meshes[mesh].m_faces.add();
 	m_valid = false;
 
 	if(DEBUGGING_EDITING)
@@ -2526,8 +2688,7 @@ unsigned int ObjModel :: addFaceVertex (unsigned int mesh, unsigned int face, un
 	assert(mesh < getMeshCount());
 	assert(face < getFaceCount(mesh));
 
-	unsigned int id = (unsigned int)(mv_meshes[mesh].mv_faces[face].mv_vertexes.size());
-	mv_meshes[mesh].mv_faces[face].mv_vertexes.push_back(FaceVertex(vertex, texture_coordinates, normal));
+	unsigned int id = mv_meshes[mesh].m_faces.addElement(face, FaceVertex(vertex, texture_coordinates, normal));
 
 	if(vertex >= getVertexCount())
 		m_valid = false;
@@ -2606,13 +2767,7 @@ void ObjModel :: removePointSet (unsigned int mesh,
 	assert(mesh < getMeshCount());
 	assert(point_set < getPointSetCount(mesh));
 
-	unsigned int point_set_count = (unsigned int)(mv_meshes[mesh].mv_point_sets.size());
-	for(unsigned int i = point_set + 1; i < point_set_count; i++)
-	{
-		assert(i >= 1);
-		mv_meshes[mesh].mv_point_sets[i - 1] = mv_meshes[mesh].mv_point_sets[i];
-	}
-	mv_meshes[mesh].mv_point_sets.pop_back();
+	mv_meshes[mesh].m_point_sets.remove(point_set);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2627,7 +2782,7 @@ void ObjModel :: removePointSetAll (unsigned int mesh)
 {
 	assert(mesh < getMeshCount());
 
-	mv_meshes[mesh].mv_point_sets.clear();
+	mv_meshes[mesh].m_point_sets.clear();
 
 	if(DEBUGGING_EDITING)
 		cout << "    Removed mesh #" << (mesh + 1) << ", all point sets" << endl;
@@ -2643,14 +2798,7 @@ void ObjModel :: removePointSetVertex (unsigned int mesh,
 	assert(point_set < getPointSetCount(mesh));
 	assert(vertex < getPolylineVertexCount(mesh, point_set));
 
-	vector<unsigned int>& rv_vertexes = mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes;
-	unsigned int vertex_count = (unsigned int)(rv_vertexes.size());
-	for(unsigned int i = vertex + 1; i < vertex_count; i++)
-	{
-		assert(i >= 1);
-		rv_vertexes[i - 1] = rv_vertexes[i];
-	}
-	rv_vertexes.pop_back();
+	mv_meshes[mesh].m_point_sets.removeElement(point_set, vertex);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2668,7 +2816,7 @@ void ObjModel :: removePointSetVertexAll (unsigned int mesh,
 	assert(mesh < getMeshCount());
 	assert(point_set < getPointSetCount(mesh));
 
-	mv_meshes[mesh].mv_point_sets[point_set].mv_vertexes.clear();
+	mv_meshes[mesh].m_point_sets.removeElementAll(point_set);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2685,13 +2833,7 @@ void ObjModel :: removePolyline (unsigned int mesh,
 	assert(mesh < getMeshCount());
 	assert(polyline < getPolylineCount(mesh));
 
-	unsigned int polyline_count = (unsigned int)(mv_meshes[mesh].mv_polylines.size());
-	for(unsigned int i = polyline + 1; i < polyline_count; i++)
-	{
-		assert(i >= 1);
-		mv_meshes[mesh].mv_polylines[i - 1] = mv_meshes[mesh].mv_polylines[i];
-	}
-	mv_meshes[mesh].mv_polylines.pop_back();
+	mv_meshes[mesh].m_polylines.remove(polyline);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2706,7 +2848,7 @@ void ObjModel :: removePolylineAll (unsigned int mesh)
 {
 	assert(mesh < getMeshCount());
 
-	mv_meshes[mesh].mv_polylines.clear();
+	mv_meshes[mesh].m_polylines.clear();
 
 	if(DEBUGGING_EDITING)
 		cout << "    Removed mesh #" << (mesh + 1) << ", all polylines" << endl;
@@ -2722,14 +2864,7 @@ void ObjModel :: removePolylineVertex (unsigned int mesh,
 	assert(polyline < getPolylineCount(mesh));
 	assert(vertex < getPolylineVertexCount(mesh, polyline));
 
-	vector<PolylineVertex>& rv_vertexes = mv_meshes[mesh].mv_polylines[polyline].mv_vertexes;
-	unsigned int vertex_count = (unsigned int)(rv_vertexes.size());
-	for(unsigned int i = vertex + 1; i < vertex_count; i++)
-	{
-		assert(i >= 1);
-		rv_vertexes[i - 1] = rv_vertexes[i];
-	}
-	rv_vertexes.pop_back();
+	mv_meshes[mesh].m_polylines.removeElement(polyline, vertex);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2747,7 +2882,7 @@ void ObjModel :: removePolylineVertexAll (unsigned int mesh,
 	assert(mesh < getMeshCount());
 	assert(polyline < getPolylineCount(mesh));
 
-	mv_meshes[mesh].mv_polylines[polyline].mv_vertexes.clear();
+	mv_meshes[mesh].m_polylines.removeElementAll(polyline);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2764,14 +2899,7 @@ void ObjModel :: removeFace (unsigned int mesh,
 	assert(mesh < getMeshCount());
 	assert(face < getFaceCount(mesh));
 
-	vector<Face>& rv_faces = mv_meshes[mesh].mv_faces;
-	unsigned int face_count = (unsigned int)(rv_faces.size());
-	for(unsigned int i = face + 1; i < face_count; i++)
-	{
-		assert(i >= 1);
-		rv_faces[i - 1] = rv_faces[i];
-	}
-	rv_faces.pop_back();
+	mv_meshes[mesh].m_faces.remove(face);
 
 	if(DEBUGGING_EDITING)
 	{
@@ -2786,7 +2914,7 @@ void ObjModel :: removeFaceAll (unsigned int mesh)
 {
 	assert(mesh < getMeshCount());
 
-	mv_meshes[mesh].mv_faces.clear();
+	mv_meshes[mesh].m_faces.clear();
 	mv_meshes[mesh].m_all_triangles = true;
 
 	if(DEBUGGING_EDITING)
@@ -2803,14 +2931,7 @@ void ObjModel :: removeFaceVertex (unsigned int mesh,
 	assert(face < getFaceCount(mesh));
 	assert(vertex < getFaceVertexCount(mesh, face));
 
-	vector<FaceVertex>& rv_vertexes = mv_meshes[mesh].mv_faces[face].mv_vertexes;
-	unsigned int vertex_count = (unsigned int)(rv_vertexes.size());
-	for(unsigned int i = vertex + 1; i < vertex_count; i++)
-	{
-		assert(i >= 1);
-		rv_vertexes[i - 1] = rv_vertexes[i];
-	}
-	rv_vertexes.pop_back();
+	mv_meshes[mesh].m_faces.removeElement(face, vertex);
 	m_valid = false;
 
 	if(DEBUGGING_EDITING)
@@ -2829,7 +2950,7 @@ void ObjModel :: removeFaceVertexAll (unsigned int mesh,
 	assert(mesh < getMeshCount());
 	assert(face < getFaceCount(mesh));
 
-	mv_meshes[mesh].mv_faces[face].mv_vertexes.clear();
+	mv_meshes[mesh].m_faces.removeElementAll(face);
 	m_valid = false;
 
 	if(DEBUGGING_EDITING)
@@ -2878,9 +2999,9 @@ void ObjModel :: validate (bool is_print_invalid)
 			return;
 		}
 */
-		for(unsigned int p = 0; p < (unsigned int)(mv_meshes[m].mv_point_sets.size()); p++)
+		for(unsigned int p = 0; p < mv_meshes[m].m_point_sets.getCount(); p++)
 		{
-			unsigned int point_set_vertex_count = (unsigned int)(mv_meshes[m].mv_point_sets[p].mv_vertexes.size());
+			unsigned int point_set_vertex_count = mv_meshes[m].m_point_sets.getSize(p);
 			if(point_set_vertex_count < 1)
 			{
 				if(is_print_invalid || DEBUGGING_VALIDATE)
@@ -2894,7 +3015,7 @@ void ObjModel :: validate (bool is_print_invalid)
 
 			for(unsigned int v = 0; v < point_set_vertex_count; v++)
 			{
-				unsigned int vertex = mv_meshes[m].mv_point_sets[p].mv_vertexes[v];
+				unsigned int vertex = mv_meshes[m].m_point_sets.getList(p)[v];
 
 				if(vertex >= getVertexCount())
 				{
@@ -2909,9 +3030,9 @@ void ObjModel :: validate (bool is_print_invalid)
 			}
 		}
 
-		for(unsigned int l = 0; l < (unsigned int)(mv_meshes[m].mv_polylines.size()); l++)
+		for(unsigned int l = 0; l < mv_meshes[m].m_polylines.getCount(); l++)
 		{
-			unsigned int polyline_vertex_count = (unsigned int)(mv_meshes[m].mv_polylines[l].mv_vertexes.size());
+			unsigned int polyline_vertex_count = mv_meshes[m].m_polylines.getSize(l);
 			if(polyline_vertex_count < 2)
 			{
 				if(is_print_invalid || DEBUGGING_VALIDATE)
@@ -2925,8 +3046,8 @@ void ObjModel :: validate (bool is_print_invalid)
 
 			for(unsigned int v = 0; v < polyline_vertex_count; v++)
 			{
-				unsigned int vertex = mv_meshes[m].mv_polylines[l].mv_vertexes[v].m_vertex;
-				unsigned int texture_coordinates = mv_meshes[m].mv_polylines[l].mv_vertexes[v].m_texture_coordinate;
+				unsigned int vertex = mv_meshes[m].m_polylines.getList(l)[v].m_vertex;
+				unsigned int texture_coordinates = mv_meshes[m].m_polylines.getList(l)[v].m_texture_coordinate;
 
 				if(is_print_invalid || vertex >= getVertexCount())
 				{
@@ -2953,9 +3074,9 @@ void ObjModel :: validate (bool is_print_invalid)
 		}
 
 		mv_meshes[m].m_all_triangles = true;
-		for(unsigned int f = 0; f < (unsigned int)(mv_meshes[m].mv_faces.size()); f++)
+		for(unsigned int f = 0; f < mv_meshes[m].m_faces.getCount(); f++)
 		{
-			unsigned int face_vertex_count = (unsigned int)(mv_meshes[m].mv_faces[f].mv_vertexes.size());
+			unsigned int face_vertex_count = mv_meshes[m].m_faces.getSize(f);
 			if(face_vertex_count < 3)
 			{
 				if(is_print_invalid || DEBUGGING_VALIDATE)
@@ -2971,9 +3092,9 @@ void ObjModel :: validate (bool is_print_invalid)
 
 			for(unsigned int v = 0; v < face_vertex_count; v++)
 			{
-				unsigned int vertex              = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_vertex;
-				unsigned int texture_coordinates = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_texture_coordinate;
-				unsigned int normal              = mv_meshes[m].mv_faces[f].mv_vertexes[v].m_normal;
+				unsigned int vertex              = mv_meshes[m].m_faces.getList(f)[v].m_vertex;
+				unsigned int texture_coordinates = mv_meshes[m].m_faces.getList(f)[v].m_texture_coordinate;
+				unsigned int normal              = mv_meshes[m].m_faces.getList(f)[v].m_normal;
 
 				if(vertex >= getVertexCount())
 				{
@@ -3009,6 +3130,9 @@ void ObjModel :: validate (bool is_print_invalid)
 				}
 			}
 		}
+
+		// stop storing face offsets if the faces are all triangles again
+		mv_meshes[m].m_faces.makeUniform();
 	}
 
 	assert(invariant());
@@ -3081,7 +3205,7 @@ void ObjModel :: drawPointSets (unsigned int mesh) const
 			for(unsigned int p = 0; p < getPointSetCount(mesh); p++)
 				for(unsigned int v = 0; v < getPointSetVertexCount(mesh, p); v++)
 				{
-					unsigned int vertex = mv_meshes[mesh].mv_point_sets[p].mv_vertexes[v];
+					unsigned int vertex = mv_meshes[mesh].m_point_sets.getList(p)[v];
 
 					glVertex3dv(mv_vertexes[vertex].getAsArray());
 				}
@@ -3099,8 +3223,8 @@ void ObjModel :: drawPolylines (unsigned int mesh) const
 		glBegin(GL_LINE_STRIP);
 			for(unsigned int v = 0; v < getPolylineVertexCount(mesh, l); v++)
 			{
-				unsigned int vertex              = mv_meshes[mesh].mv_polylines[l].mv_vertexes[v].m_vertex;
-				unsigned int texture_coordinates = mv_meshes[mesh].mv_polylines[l].mv_vertexes[v].m_texture_coordinate;
+				unsigned int vertex              = mv_meshes[mesh].m_polylines.getList(l)[v].m_vertex;
+				unsigned int texture_coordinates = mv_meshes[mesh].m_polylines.getList(l)[v].m_texture_coordinate;
 
 				if(texture_coordinates != NO_TEXTURE_COORDINATES)
 				{
@@ -3134,9 +3258,9 @@ void ObjModel :: drawFaces (unsigned int mesh) const
 
 		for(unsigned int v = 0; v < getFaceVertexCount(mesh, f); v++)
 		{
-			unsigned int vertex              = mv_meshes[mesh].mv_faces[f].mv_vertexes[v].m_vertex;
-			unsigned int texture_coordinates = mv_meshes[mesh].mv_faces[f].mv_vertexes[v].m_texture_coordinate;
-			unsigned int normal              = mv_meshes[mesh].mv_faces[f].mv_vertexes[v].m_normal;
+			unsigned int vertex              = mv_meshes[mesh].m_faces.getList(f)[v].m_vertex;
+			unsigned int texture_coordinates = mv_meshes[mesh].m_faces.getList(f)[v].m_texture_coordinate;
+			unsigned int normal              = mv_meshes[mesh].m_faces.getList(f)[v].m_normal;
 
 			if(normal != NO_NORMAL)
 				glNormal3dv(mv_normals[normal].getAsArray());
@@ -3293,14 +3417,14 @@ ObjVbo<float> ObjModel :: createPointSetVboVertexOnly (unsigned int mesh) const
 	PositionOnly* d_vertexes        = new PositionOnly[point_count_total];
 
 	unsigned int next_point = 0;
-	for(unsigned int p = 0; p < (unsigned int)(mv_meshes[mesh].mv_point_sets.size()); p++)
+	for(unsigned int p = 0; p < mv_meshes[mesh].m_point_sets.getCount(); p++)
 	{
-		const vector<unsigned int>& v_vertex_ids = mv_meshes[mesh].mv_point_sets[p].mv_vertexes;
-		for(unsigned int i = 0; i < (unsigned int)(v_vertex_ids.size()); i++)
+		const unsigned int* a_vertex_ids = mv_meshes[mesh].m_point_sets.getList(p);
+		unsigned int        vertex_count = mv_meshes[mesh].m_point_sets.getSize(p);
+		for(unsigned int i = 0; i < vertex_count; i++)
 		{
-			assert(i < (unsigned int)(v_vertex_ids.size()));
-			assert(v_vertex_ids[i] < (unsigned int)(mv_vertexes.size()));
-			const Vector3& vertex = mv_vertexes[v_vertex_ids[i]];
+			assert(a_vertex_ids[i] < (unsigned int)(mv_vertexes.size()));
+			const Vector3& vertex = mv_vertexes[a_vertex_ids[i]];
 
 			assert(next_point < point_count_total);
 			d_vertexes[next_point].m_x = (float)(vertex.x);
@@ -3332,15 +3456,14 @@ ObjVbo<float> ObjModel :: createPolylineVboVertexOnly (unsigned int mesh,
 
 	using namespace VertexDataFormat;
 
-	const vector<PolylineVertex>& v_vertex_ids = mv_meshes[mesh].mv_polylines[polyline].mv_vertexes;
-	unsigned int                  vertex_count = (unsigned int)(v_vertex_ids.size());
+	const PolylineVertex*         a_vertex_ids = mv_meshes[mesh].m_polylines.getList(polyline);
+	unsigned int                  vertex_count = mv_meshes[mesh].m_polylines.getSize(polyline);
 	PositionOnly*                 d_vertexes   = new PositionOnly[vertex_count];
 
-	for(unsigned int i = 0; i < (unsigned int)(v_vertex_ids.size()); i++)
+	for(unsigned int i = 0; i < vertex_count; i++)
 	{
-		assert(i < (unsigned int)(v_vertex_ids.size()));
-		assert(v_vertex_ids[i].m_vertex < (unsigned int)(mv_vertexes.size()));
-		const Vector3& vertex = mv_vertexes[v_vertex_ids[i].m_vertex];
+		assert(a_vertex_ids[i].m_vertex < (unsigned int)(mv_vertexes.size()));
+		const Vector3& vertex = mv_vertexes[a_vertex_ids[i].m_vertex];
 
 		d_vertexes[i].m_x = (float)(vertex.x);
 		d_vertexes[i].m_y = (float)(vertex.y);
@@ -3365,23 +3488,22 @@ ObjVbo<float> ObjModel :: createPolylineVboVertexTextureCoordinate (unsigned int
 
 	using namespace VertexDataFormat;
 
-	const vector<PolylineVertex>& v_vertex_ids = mv_meshes[mesh].mv_polylines[polyline].mv_vertexes;
-	unsigned int                  vertex_count = (unsigned int)(v_vertex_ids.size());
+	const PolylineVertex*         a_vertex_ids = mv_meshes[mesh].m_polylines.getList(polyline);
+	unsigned int                  vertex_count = mv_meshes[mesh].m_polylines.getSize(polyline);
 	PositionTextureCoordinate*    d_vertexes   = new PositionTextureCoordinate[vertex_count];
 
-	for(unsigned int i = 0; i < (unsigned int)(v_vertex_ids.size()); i++)
+	for(unsigned int i = 0; i < vertex_count; i++)
 	{
-		assert(i < (unsigned int)(v_vertex_ids.size()));
-		assert(v_vertex_ids[i].m_vertex < (unsigned int)(mv_vertexes.size()));
-		const Vector3& vertex = mv_vertexes[v_vertex_ids[i].m_vertex];
+		assert(a_vertex_ids[i].m_vertex < (unsigned int)(mv_vertexes.size()));
+		const Vector3& vertex = mv_vertexes[a_vertex_ids[i].m_vertex];
 
 		d_vertexes[i].m_x = (float)(vertex.x);
 		d_vertexes[i].m_y = (float)(vertex.y);
 		d_vertexes[i].m_z = (float)(vertex.z);
 
-		if(v_vertex_ids[i].m_texture_coordinate < (unsigned int)(mv_texture_coordinates.size()))
+		if(a_vertex_ids[i].m_texture_coordinate < (unsigned int)(mv_texture_coordinates.size()))
 		{
-			const Vector2& texture_coordinate = mv_texture_coordinates[v_vertex_ids[i].m_texture_coordinate];
+			const Vector2& texture_coordinate = mv_texture_coordinates[a_vertex_ids[i].m_texture_coordinate];
 
 			// flip texture coordinates to match Maya <|>
 			d_vertexes[i].m_s =        (float)(texture_coordinate.x);
@@ -3675,7 +3797,7 @@ ObjVbo<unsigned int> ObjModel :: createIndexVboForFaces (unsigned int mesh,
 	assert((unsigned int)(vv_arrangement.size()) == getVertexCount());
 
 	assert(mesh < (unsigned int)(mv_meshes.size()));
-	const vector<Face>& v_faces = mv_meshes[mesh].mv_faces;
+	const ElementLists<FaceVertex>& faces = mv_meshes[mesh].m_faces;
 
 	// number all the vertex-with-datas, based on where they will be in the VBO
 	vector<unsigned int> v_start;
@@ -3702,9 +3824,9 @@ ObjVbo<unsigned int> ObjModel :: createIndexVboForFaces (unsigned int mesh,
 
 	// calculate the number of triangles needed (non-triangle faces will be triangulated)
 	unsigned int vertex_count_total = 0;
-	for(unsigned int f = 0; f < (unsigned int)(v_faces.size()); f++)
+	for(unsigned int f = 0; f < faces.getCount(); f++)
 	{
-		unsigned int face_vertex_count = (unsigned int)(v_faces[f].mv_vertexes.size());
+		unsigned int face_vertex_count = faces.getSize(f);
 		assert(face_vertex_count >= 3);
 
 		unsigned int triangle_count = face_vertex_count - 2;
@@ -3716,13 +3838,14 @@ ObjVbo<unsigned int> ObjModel :: createIndexVboForFaces (unsigned int mesh,
 	unsigned int* d_indexes = new unsigned int[vertex_count_total];
 
 	unsigned int next_index = 0;
-	for(unsigned int f = 0; f < (unsigned int)(v_faces.size()); f++)
+	for(unsigned int f = 0; f < faces.getCount(); f++)
 	{
-		const vector<FaceVertex>& v_vertex_ids = v_faces[f].mv_vertexes;
-		assert(v_vertex_ids.size() >= 3);
+		const FaceVertex* a_vertex_ids      = faces.getList(f);
+		unsigned int      face_vertex_count = faces.getSize(f);
+		assert(face_vertex_count >= 3);
 
 		// double loop to triangulate faces
-		for(unsigned int t = 2; t < (unsigned int)(v_vertex_ids.size()); t++)  // per triangle
+		for(unsigned int t = 2; t < face_vertex_count; t++)  // per triangle
 			for(unsigned int i = 0; i < 3; i++)  // 3 vertexes in each triangle
 			{
 				//
@@ -3738,8 +3861,8 @@ ObjVbo<unsigned int> ObjModel :: createIndexVboForFaces (unsigned int mesh,
 
 				unsigned int face_vertex_index = (i == 0) ? 0 : (t - 2 + i);
 
-				assert(face_vertex_index < (unsigned int)(v_vertex_ids.size()));
-				const FaceVertex& face_vertex = v_vertex_ids[face_vertex_index];
+				assert(face_vertex_index < face_vertex_count);
+				const FaceVertex& face_vertex = a_vertex_ids[face_vertex_index];
 
 				bool is_found = false;
 
@@ -3820,15 +3943,15 @@ void ObjModel :: calculateVertexArrangement (unsigned int mesh,
 
 	rvv_arrangement.resize((unsigned int)(mv_vertexes.size()));
 
-	const vector<Face>& v_faces = mv_meshes[mesh].mv_faces;
-	for(unsigned int f = 0; f < (unsigned int)(v_faces.size()); f++)
+	const ElementLists<FaceVertex>& faces = mv_meshes[mesh].m_faces;
+	for(unsigned int f = 0; f < faces.getCount(); f++)
 	{
-		const vector<FaceVertex>& v_vertex_ids = v_faces[f].mv_vertexes;
+		const FaceVertex* a_vertex_ids      = faces.getList(f);
+		unsigned int      face_vertex_count = faces.getSize(f);
 
-		for(unsigned int i = 0; i < (unsigned int)(v_vertex_ids.size()); i++)
+		for(unsigned int i = 0; i < face_vertex_count; i++)
 		{
-			assert(i < (unsigned int)(v_vertex_ids.size()));
-			const FaceVertex& face_vertex = v_vertex_ids[i];
+			const FaceVertex& face_vertex = a_vertex_ids[i];
 
 			bool is_duplicate = false;
 
@@ -3910,25 +4033,27 @@ unsigned int ObjModel :: getVertexArrangementTotalCount (const VertexArrangement
 
 
 
-bool ObjModel :: readMaterialLibrary (const string& str, ostream& r_logstream)
+bool ObjModel :: readMaterialLibrary (const char* a_str, const char* a_end, ostream& r_logstream)
 {
-	string::size_type start_index;
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
 
-	if(isspace(str[0]))
-		start_index = nextToken(str, 0);
+	const char* a_start;
+
+	if(isSpaceAt(a_str, a_end))
+		a_start = nextToken(a_str, a_end);
 	else
-		start_index = 0;
+		a_start = a_str;
 
-	for(string::size_type token_index = start_index; token_index != string::npos; token_index = nextToken(str, token_index))
+	for(const char* a_token = a_start; a_token != NULL; a_token = nextToken(a_token, a_end))
 	{
-		string library;
-
-		size_t token_length = getTokenLength(str, token_index);
+		size_t token_length = getTokenLength(a_token, a_end);
 
 		if(token_length == 0)
 			return false;
 
-		library = str.substr(token_index, token_length);
+		string library(a_token, token_length);
 
 		//
 		//  Should we add on the current file path? <|>
@@ -3953,115 +4078,133 @@ bool ObjModel :: readMaterialLibrary (const string& str, ostream& r_logstream)
 	return true;
 }
 
-bool ObjModel :: readMaterial (const string& str, ostream& r_logstream)
+bool ObjModel :: readMaterial (const char* a_str, const char* a_end, ostream& r_logstream)
 {
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	string material;
 	unsigned int mesh_index;
 
-	size_t length;
-	size_t start_index;
-	size_t end_index;
+	const char* a_start;
 
-	if(isspace(str[0]))
-		start_index = nextToken(str, 0);
+	if(isSpaceAt(a_str, a_end))
+		a_start = nextToken(a_str, a_end);
 	else
-		start_index = 0;
+		a_start = a_str;
 
-	length = str.length();
-	for(end_index = start_index; end_index < length && !isspace(str[end_index]); end_index++)
-		; // do nothing
-
-	if(end_index < length)
-		material = str.substr(start_index, end_index - start_index);
-	else
-		material = str.substr(start_index);
+	if(a_start == NULL || getTokenLength(a_start, a_end) == 0)
+		return false;  // no material name
+	material.assign(a_start, getTokenLength(a_start, a_end));
 
 	mesh_index = addMesh();
 	setMeshMaterial(mesh_index, material);
 	return true;
 }
 
-bool ObjModel :: readVertex (const string& str, ostream& r_logstream)
+bool ObjModel :: readVertex (const char* a_str, const char* a_end, ostream& r_logstream)
 {
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	double x;
 	double y;
 	double z;
 
-	size_t index;
+	const char* a_current;
+	const char* a_after;
 
-	if(isspace(str[0]))
-		index = nextToken(str, 0);
+	if(isSpaceAt(a_str, a_end))
+		a_current = nextToken(a_str, a_end);
 	else
-		index = 0;
+		a_current = a_str;
+	if(a_current == NULL)
+		return false;
 
-	x = atof(str.c_str() + index);
+	x = parseDouble(a_current, a_end, a_after);
 
-	index = nextToken(str, index);
-	if(index == string::npos)
+	a_current = nextToken(a_after, a_end);
+	if(a_current == NULL)
 		return false;
 
-	y = atof(str.c_str() + index);
+	y = parseDouble(a_current, a_end, a_after);
 
-	index = nextToken(str, index);
-	if(index == string::npos)
+	a_current = nextToken(a_after, a_end);
+	if(a_current == NULL)
 		return false;
 
-	z = atof(str.c_str() + index);
+	z = parseDouble(a_current, a_end);
 
 	addVertex(x, y, z);
 	return true;
 }
 
-bool ObjModel :: readTextureCoordinates (const string& str, ostream& r_logstream)
+bool ObjModel :: readTextureCoordinates (const char* a_str, const char* a_end, ostream& r_logstream)
 {
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	double u;
 	double v;
 
-	size_t index;
+	const char* a_current;
+	const char* a_after;
 
-	if(isspace(str[0]))
-		index = nextToken(str, 0);
+	if(isSpaceAt(a_str, a_end))
+		a_current = nextToken(a_str, a_end);
 	else
-		index = 0;
+		a_current = a_str;
+	if(a_current == NULL)
+		return false;
 
-	u = atof(str.c_str() + index);
+	u = parseDouble(a_current, a_end, a_after);
 
-	index = nextToken(str, index);
-	if(index == string::npos)
+	a_current = nextToken(a_after, a_end);
+	if(a_current == NULL)
 		return false;
 
-	v = atof(str.c_str() + index);
+	v = parseDouble(a_current, a_end);
 
 	addTextureCoordinate(u, v);
 	return true;
 }
 
-bool ObjModel :: readNormal (const string& str, ostream& r_logstream)
+bool ObjModel :: readNormal (const char* a_str, const char* a_end, ostream& r_logstream)
 {
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	double x;
 	double y;
 	double z;
 
-	size_t index;
+	const char* a_current;
+	const char* a_after;
 
-	if(isspace(str[0]))
-		index = nextToken(str, 0);
+	if(isSpaceAt(a_str, a_end))
+		a_current = nextToken(a_str, a_end);
 	else
-		index = 0;
+		a_current = a_str;
+	if(a_current == NULL)
+		return false;
 
-	x = atof(str.c_str() + index);
+	x = parseDouble(a_current, a_end, a_after);
 
-	index = nextToken(str, index);
-	if(index == string::npos)
+	a_current = nextToken(a_after, a_end);
+	if(a_current == NULL)
 		return false;
 
-	y = atof(str.c_str() + index);
+	y = parseDouble(a_current, a_end, a_after);
 
-	index = nextToken(str, index);
-	if(index == string::npos)
+	a_current = nextToken(a_after, a_end);
+	if(a_current == NULL)
 		return false;
 
-	z = atof(str.c_str() + index);
+	z = parseDouble(a_current, a_end);
 
 	if(x == 0.0 && y == 0.0 && z == 0.0)
 	{
@@ -4073,15 +4216,19 @@ bool ObjModel :: readNormal (const string& str, ostream& r_logstream)
 	return true;
 }
 
-bool ObjModel :: readPointSet (const string& str, ostream& r_logstream)
+bool ObjModel :: readPointSet (const char* a_str, const char* a_end, ostream& r_logstream)
 {
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	const unsigned int NO_POINT_SET = ~0u;
 
-	string::size_type start_index;
-	if(isspace(str[0]))
-		start_index = nextToken(str, 0);
+	const char* a_start;
+	if(isSpaceAt(a_str, a_end))
+		a_start = nextToken(a_str, a_end);
 	else
-		start_index = 0;
+		a_start = a_str;
 
 	unsigned int mesh_index;
 	if(mv_meshes.empty())
@@ -4093,11 +4240,12 @@ bool ObjModel :: readPointSet (const string& str, ostream& r_logstream)
 	}
 
 	unsigned int point_set_index = NO_POINT_SET;
-	for(string::size_type token_index = start_index; token_index != string::npos; token_index = nextToken(str, token_index))
+	const char* a_after = a_start;
+	for(const char* a_token = a_start; a_token != NULL; a_token = nextToken(a_after, a_end))
 	{
 		int vertex;
 
-		vertex = atoi(str.c_str() + token_index);
+		vertex = parseInt(a_token, a_end, a_after);
 		if(vertex < 0)
 			vertex += getVertexCount() + 1;
 		if(vertex <= 0)
@@ -4121,20 +4269,24 @@ bool ObjModel :: readPointSet (const string& str, ostream& r_logstream)
 	return true;
 }
 
-bool ObjModel :: readPolyline (const string& str, ostream& r_logstream)
+bool ObjModel :: readPolyline (const char* a_str, const char* a_end, ostream& r_logstream)
 {
 	//
 	//  This function reads a polyline of vertexes in the
 	//    model, not a line of the input file.
 	//
 
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	const unsigned int NO_LINE = ~0u;
 
-	string::size_type start_index;
-	if(isspace(str[0]))
-		start_index = nextToken(str, 0);
+	const char* a_start;
+	if(isSpaceAt(a_str, a_end))
+		a_start = nextToken(a_str, a_end);
 	else
-		start_index = 0;
+		a_start = a_str;
 
 	unsigned int mesh_index;
 	if(mv_meshes.empty())
@@ -4146,16 +4298,15 @@ bool ObjModel :: readPolyline (const string& str, ostream& r_logstream)
 	}
 
 	unsigned int polyline_index = NO_LINE;
-	for(string::size_type token_index = start_index; token_index != string::npos; token_index = nextToken(str, token_index))
+	const char* a_after = a_start;
+	for(const char* a_token = a_start; a_token != NULL; a_token = nextToken(a_after, a_end))
 	{
-		size_t number_index;
+		const char* a_number;
 
 		int vertex;
 		int texture_coordinates;
 
-		number_index = token_index;
-
-		vertex = atoi(str.c_str() + number_index);
+		vertex = parseInt(a_token, a_end, a_after);
 		if(vertex < 0)
 			vertex += getVertexCount() + 1;
 		if(vertex <= 0)
@@ -4165,20 +4316,23 @@ bool ObjModel :: readPolyline (const string& str, ostream& r_logstream)
 			return false;
 		}
 
-		number_index = nextSlashInToken(str, number_index);
-		if(number_index == string::npos)
+		a_number = nextSlashInToken(a_after, a_end);
+		if(a_number == NULL)
 		{
 			texture_coordinates = NO_TEXTURE_COORDINATES;
 		}
 		else
 		{
-			number_index++;
+			a_number++;
 
-			if(isspace(str[number_index]))
+			if(isSpaceAt(a_number, a_end))
+			{
 				texture_coordinates = NO_TEXTURE_COORDINATES;
+				a_after = a_number;
+			}
 			else
 			{
-				texture_coordinates = atoi(str.c_str() + number_index);
+				texture_coordinates = parseInt(a_number, a_end, a_after);
 				if(texture_coordinates < 0)
 					texture_coordinates += getTextureCoordinateCount() + 1;
 				if(texture_coordinates <= 0)
@@ -4206,15 +4360,19 @@ bool ObjModel :: readPolyline (const string& str, ostream& r_logstream)
 	return true;
 }
 
-bool ObjModel :: readFace (const string& str, ostream& r_logstream)
+bool ObjModel :: readFace (const char* a_str, const char* a_end, ostream& r_logstream)
 {
+	assert(a_str != NULL);
+	assert(a_end != NULL);
+	assert(a_str <= a_end);
+
 	const unsigned int NO_FACE = ~0u;
 
-	string::size_type start_index;
-	if(isspace(str[0]))
-		start_index = nextToken(str, 0);
+	const char* a_start;
+	if(isSpaceAt(a_str, a_end))
+		a_start = nextToken(a_str, a_end);
 	else
-		start_index = 0;
+		a_start = a_str;
 
 	unsigned int mesh_index;
 	if(mv_meshes.empty())
@@ -4225,18 +4383,19 @@ bool ObjModel :: readFace (const string& str, ostream& r_logstream)
 		mesh_index = (unsigned int)(mv_meshes.size()) - 1;
 	}
 
+	// each number is read from where the last one ended, so
+	//  the characters of a token are only looked at once
 	unsigned int face_index = NO_FACE;
-	for(string::size_type token_index = start_index; token_index != string::npos; token_index = nextToken(str, token_index))
+	const char* a_after = a_start;
+	for(const char* a_token = a_start; a_token != NULL; a_token = nextToken(a_after, a_end))
 	{
-		size_t number_index;
+		const char* a_number;
 
 		int vertex;
 		int texture_coordinates;
 		int normal;
 
-		number_index = token_index;
-
-		vertex = atoi(str.c_str() + number_index);
+		vertex = parseInt(a_token, a_end, a_after);
 		if(vertex < 0)
 			vertex += getVertexCount() + 1;
 		if(vertex <= 0)
@@ -4246,39 +4405,45 @@ bool ObjModel :: readFace (const string& str, ostream& r_logstream)
 			return false;
 		}
 
-		number_index = nextSlashInToken(str, number_index);
-		if(number_index == string::npos)
+		a_number = nextSlashInToken(a_after, a_end);
+		if(a_number == NULL)
 		{
 			texture_coordinates = NO_TEXTURE_COORDINATES;
 			normal = NO_NORMAL;
 		}
 		else
 		{
-			number_index++;
+			a_number++;
 
-			if(str[number_index] == '/')
+			if(a_number < a_end && *a_number == '/')
+			{
 				texture_coordinates = NO_TEXTURE_COORDINATES;
+				a_after = a_number;
+			}
 			else
 			{
-				texture_coordinates = atoi(str.c_str() + number_index);
+				texture_coordinates = parseInt(a_number, a_end, a_after);
 				if(texture_coordinates < 0)
 					texture_coordinates += getTextureCoordinateCount() + 1;
 				if(texture_coordinates <= 0)
 					return false;
 			}
 
-			number_index = nextSlashInToken(str, number_index);
-			if(number_index == string::npos)
+			a_number = nextSlashInToken(a_after, a_end);
+			if(a_number == NULL)
 				normal = NO_NORMAL;
 			else
 			{
-				number_index++;
+				a_number++;
 
-				if(isspace(str[number_index]))
+				if(isSpaceAt(a_number, a_end))
+				{
 					normal = NO_NORMAL;
+					a_after = a_number;
+				}
 				else
 				{
-					normal = atoi(str.c_str() + number_index);
+					normal = parseInt(a_number, a_end, a_after);
 					if(normal < 0)
 						normal += getNormalCount() + 1;
 					if(normal <= 0)
@@ -4318,7 +4483,7 @@ void ObjModel :: removeLastPointSet (unsigned int mesh)
 	assert(mesh < getMeshCount());
 	assert(getPointSetCount(mesh) >= 1);
 
-	mv_meshes[mesh].mv_point_sets.pop_back();
+	mv_meshes[mesh].m_point_sets.removeLast();
 	m_valid = false;
 }
 
@@ -4327,7 +4492,7 @@ void ObjModel :: removeLastPolyline (unsigned int mesh)
 	assert(mesh < getMeshCount());
 	assert(getPolylineCount(mesh) >= 1);
 
-	mv_meshes[mesh].mv_polylines.pop_back();
+	mv_meshes[mesh].m_polylines.removeLast();
 	m_valid = false;
 }
 
@@ -4336,7 +4501,7 @@ void ObjModel :: removeLastFace (unsigned int mesh)
 	assert(mesh < getMeshCount());
 	assert(getFaceCount(mesh) >= 1);
 
-	mv_meshes[mesh].mv_faces.pop_back();
+	mv_meshes[mesh].m_faces.removeLast();
 	m_valid = false;
 }
 
@@ -4492,21 +4657,263 @@ ObjModel :: FaceVertex& ObjModel :: FaceVertex :: operator= (const ObjModel :: F
 
 
 
-ObjModel :: Mesh :: Mesh () : mv_faces()
+template <typename T>
+ObjModel :: ElementLists<T> :: ElementLists (unsigned int uniform_size)
+		: mv_elements(),
+		  mv_starts(),
+		  m_count(0),
+		  m_uniform_size(uniform_size)
+{
+	assert(invariant());
+}
+
+template <typename T>
+unsigned int ObjModel :: ElementLists<T> :: getCount () const
+{
+	return m_count;
+}
+
+template <typename T>
+unsigned int ObjModel :: ElementLists<T> :: getSize (unsigned int list) const
+{
+	assert(list < getCount());
+
+	if(list + 1 < getCount())
+		return getStart(list + 1) - getStart(list);
+	else
+		return (unsigned int)(mv_elements.size()) - getStart(list);
+}
+
+template <typename T>
+unsigned int ObjModel :: ElementLists<T> :: getSizeTotal () const
+{
+	return (unsigned int)(mv_elements.size());
+}
+
+template <typename T>
+const T* ObjModel :: ElementLists<T> :: getList (unsigned int list) const
+{
+	assert(list < getCount());
+
+	return mv_elements.data() + getStart(list);
+}
+
+template <typename T>
+T* ObjModel :: ElementLists<T> :: getList (unsigned int list)
+{
+	assert(list < getCount());
+
+	return mv_elements.data() + getStart(list);
+}
+
+template <typename T>
+bool ObjModel :: ElementLists<T> :: isUniform () const
+{
+	return m_uniform_size != 0 && mv_starts.empty();
+}
+
+template <typename T>
+unsigned int ObjModel :: ElementLists<T> :: add ()
+{
+	// only the last list may have a different size
+	if(isUniform() && m_count > 0 && getSize(m_count - 1) != m_uniform_size)
+		makeStarts();
+
+	if(!isUniform())
+		mv_starts.push_back((unsigned int)(mv_elements.size()));
+	m_count++;
+
+	assert(invariant());
+	return m_count - 1;
+}
+
+template <typename T>
+unsigned int ObjModel :: ElementLists<T> :: addElement (unsigned int list,
+                                                        const T& element)
+{
+	assert(list < getCount());
+
+	unsigned int id = getSize(list);
+	if(list + 1 == getCount())
+		mv_elements.push_back(element);
+	else
+	{
+		if(isUniform())
+			makeStarts();
+
+		mv_elements.insert(mv_elements.begin() + (getStart(list) + id), element);
+		for(unsigned int i = list + 1; i < getCount(); i++)
+			mv_starts[i]++;
+	}
+
+	assert(invariant());
+	return id;
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: remove (unsigned int list)
+{
+	assert(list < getCount());
+
+	unsigned int start = getStart(list);
+	unsigned int size  = getSize(list);
+	mv_elements.erase(mv_elements.begin() + start,
+	                  mv_elements.begin() + (start + size));
+
+	if(!isUniform())
+	{
+		mv_starts.erase(mv_starts.begin() + list);
+		for(unsigned int i = list; i + 1 < getCount(); i++)
+			mv_starts[i] -= size;
+	}
+	m_count--;
+
+	assert(invariant());
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: removeLast ()
+{
+	assert(getCount() > 0);
+
+	remove(getCount() - 1);
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: removeElement (unsigned int list,
+                                                   unsigned int element)
+{
+	assert(list < getCount());
+	assert(element < getSize(list));
+
+	if(isUniform() && list + 1 < getCount())
+		makeStarts();
+
+	mv_elements.erase(mv_elements.begin() + (getStart(list) + element));
+	if(!isUniform())
+	{
+		for(unsigned int i = list + 1; i < getCount(); i++)
+			mv_starts[i]--;
+	}
+
+	assert(invariant());
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: removeElementAll (unsigned int list)
+{
+	assert(list < getCount());
+
+	if(isUniform() && list + 1 < getCount())
+		makeStarts();
+
+	unsigned int start = getStart(list);
+	unsigned int size  = getSize(list);
+	mv_elements.erase(mv_elements.begin() + start,
+	                  mv_elements.begin() + (start + size));
+	if(!isUniform())
+	{
+		for(unsigned int i = list + 1; i < getCount(); i++)
+			mv_starts[i] -= size;
+	}
+
+	assert(invariant());
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: clear ()
+{
+	mv_elements.clear();
+	vector<unsigned int>().swap(mv_starts);
+	m_count = 0;
+
+	assert(invariant());
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: makeUniform ()
+{
+	if(m_uniform_size == 0 || mv_starts.empty())
+		return;
+
+	for(unsigned int i = 0; i < getCount(); i++)
+		if(getSize(i) != m_uniform_size)
+			return;
+	vector<unsigned int>().swap(mv_starts);
+
+	assert(invariant());
+}
+
+template <typename T>
+bool ObjModel :: ElementLists<T> :: invariant () const
+{
+	if(isUniform())
+	{
+		if(m_count == 0 && !mv_elements.empty()) return false;
+		if(m_count > 0 && mv_elements.size() < (m_count - 1) * m_uniform_size) return false;
+	}
+	else
+	{
+		// only the ends are checked, because this is asserted
+		//  after every element is added, and checking every
+		//  list made loading a big model quadratic in debug
+		//  builds
+		if(mv_starts.size() != m_count) return false;
+		if(m_count == 0 && !mv_elements.empty()) return false;
+		if(m_count > 0 && mv_starts[0] != 0) return false;
+		if(m_count > 0 && mv_starts[m_count - 1] > mv_elements.size()) return false;
+	}
+	return true;
+}
+
+template <typename T>
+unsigned int ObjModel :: ElementLists<T> :: getStart (unsigned int list) const
+{
+	assert(list < getCount());
+
+	if(isUniform())
+		return list * m_uniform_size;
+	else
+		return mv_starts[list];
+}
+
+template <typename T>
+void ObjModel :: ElementLists<T> :: makeStarts ()
+{
+	assert(isUniform());
+
+	mv_starts.resize(m_count);
+	for(unsigned int i = 0; i < m_count; i++)
+		mv_starts[i] = i * m_uniform_size;
+}
+
+
+
+
+ObjModel :: Mesh :: Mesh ()
+		: m_point_sets(0),
+		  m_polylines(0),
+		  m_faces(3)
 {
 	m_material_name = "";
 	mp_material     = NULL;
 	m_all_triangles = true;
 }
 
-ObjModel :: Mesh :: Mesh (const string& material_name, Material* p_material) : mv_faces()
+ObjModel :: Mesh :: Mesh (const string& material_name, Material* p_material)
+		: m_point_sets(0),
+		  m_polylines(0),
+		  m_faces(3)
 {
 	m_material_name = material_name;
 	mp_material     = p_material;
 	m_all_triangles = true;
 }
 
-ObjModel :: Mesh :: Mesh (const ObjModel :: Mesh& original) : mv_faces(original.mv_faces)
+ObjModel :: Mesh :: Mesh (const ObjModel :: Mesh& original)
+		: m_point_sets(original.m_point_sets),
+		  m_polylines(original.m_polylines),
+		  m_faces(original.m_faces)
 {
 	m_material_name = original.m_material_name;
 	mp_material     = original.mp_material;
@@ -4519,7 +4926,9 @@ ObjModel :: Mesh& ObjModel :: Mesh :: operator= (const ObjModel :: Mesh& origina
 	{
 		m_material_name = original.m_material_name;
 		mp_material     = original.mp_material;
-		mv_faces        = original.mv_faces;
+		m_point_sets    = original.m_point_sets;
+		m_polylines     = original.m_polylines;
+		m_faces         = original.m_faces;
 		m_all_triangles = original.m_all_triangles;
 	}
 
@@ -29,6 +29,7 @@
 #include "ObjSettings.h"
 #include "MtlLibrary.h"
 #include "DisplayList.h"
+#include "CompiledMesh.h"
 #include "Vector3.h"
 #include "Vector2.h"
 
@@ -1208,6 +1209,28 @@ public:
 	void printBadMaterials (const std::string& logfile) const;
 	void printBadMaterials (std::ostream& r_logstream) const;
 
+//
+//  getCompiledMesh
+//
+//  Purpose: To generate a CompiledMesh for the faces of this
+//           ObjModel.  This does not require an OpenGL context.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isValid()
+//  Returns: A finished CompiledMesh with one range for each
+//           mesh of this ObjModel that has faces.  Each face is
+//           split into a fan of triangles, as draw() does.  A
+//           face vertex with no normal or texture coordinates
+//           uses the ones from the previous face vertex that
+//           had them, matching the way OpenGL keeps the current
+//           normal and texture coordinates, starting from
+//           (0, 0, 1) and (0, 0).  Texture coordinates are
+//           flipped vertically, as in draw().  Point sets and
+//           polylines are not included.
+//  Side Effect: N/A
+//
+	CompiledMesh getCompiledMesh () const;
+
 #ifndef OBJ_LIBRARY_SHADER_DISPLAY
 //
 //  draw
@@ -1966,6 +1989,20 @@ public:
 	void save (const std::string& filename,
 	           std::ostream& r_logstream) const;
 
+//
+//  save
+//
+//  Purpose: To write the contents of this ObjModel to the
+//           specified output stream.
+//  Parameter(s):
+//    <1> r_out: A reference to the output stream
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: This ObjModel is written to r_out in OBJ
+//               format.
+//
+	void save (std::ostream& r_out) const;
+
 //
 //  makeEmpty
 //
@@ -3493,54 +3530,71 @@ private:
 //  readMaterialLibrary
 //
 //  Purpose: To add the material libaries corresponding to the
-//           information in a string to this ObjModel.
+//           information in a range of characters to this
+//           ObjModel.
 //  Parameter(s):
-//    <1> str: The string containing the material libraries
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies one or more material
+//    <1> a_str: The start of the material libraries
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify one or more material
 //           libaries.
-//  Side Effect: If string str specifies one or more material
+//  Side Effect: If the characters specify one or more material
 //               libraries, those material libraries are added
 //               to the end of the list this ObjModel checks
 //               when searching for a material.  Otherwise,
 //               there is no effect.
 //
-	bool readMaterialLibrary (const std::string& str,
+	bool readMaterialLibrary (const char* a_str,
+	                          const char* a_end,
 	                          std::ostream& r_logstream);
 
 //
 //  readMaterial
 //
 //  Purpose: To set the current material for this ObjModel
-//           corresponding to the information in a string.
-//  Parameter(s):
-//    <1> str: The string containing the material name
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a material.
-//  Side Effect: If string str specifies a material, that
+//           corresponding to the information in a range of
+//           characters.
+//  Parameter(s):
+//    <1> a_str: The start of the material name
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a material.
+//  Side Effect: If the characters specify a material, that
 //               material is set to be the current material for
 //               this ObjModel.  Otherwise, there is no effect.
 //
-	bool readMaterial (const std::string& str,
+	bool readMaterial (const char* a_str,
+	                   const char* a_end,
 	                   std::ostream& r_logstream);
 
 //
 //  readVertex
 //
 //  Purpose: To add a vertex to this ObjModel corresponding to
-//           the information in a string.
+//           the information in a range of characters.
 //  Parameter(s):
-//    <1> str: The string containing the vertex information
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a vertex.
-//  Side Effect: If string str specifies a vertex, that vertex.
+//    <1> a_str: The start of the vertex information
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a vertex.
+//  Side Effect: If the characters specify a vertex, that vertex
 //               is added to this ObjModel.  Otherwise, there is
 //               no effect.
 //
-	bool readVertex (const std::string& str,
+	bool readVertex (const char* a_str,
+	                 const char* a_end,
 	                 std::ostream& r_logstream);
 
 //
@@ -3548,91 +3602,117 @@ private:
 //
 //  Purpose: To add a pair of texture coordinates to this
 //           ObjModel corresponding to the information in a
-//           string.
+//           range of characters.
 //  Parameter(s):
-//    <1> str: The string containing the texture coordinate
+//    <1> a_str: The start of the texture coordinate
 //               information
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a pair of texture
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a pair of texture
 //           coordinates.
-//  Side Effect: If string str specifies a pair of texture
+//  Side Effect: If the characters specify a pair of texture
 //               coordinates, that pair is added to this
 //               ObjModel.  Otherwise, there is no effect.
 //
-	bool readTextureCoordinates (const std::string& str,
+	bool readTextureCoordinates (const char* a_str,
+	                             const char* a_end,
 	                             std::ostream& r_logstream);
 
 //
 //  readNormal
 //
 //  Purpose: To add a normal vector to this ObjModel
-//           corresponding to the information in a string.
-//  Parameter(s):
-//    <1> str: The string containing the normal vector
-//               information
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a normal vector.
-//  Side Effect: If string str specifies a normal vector, that
+//           corresponding to the information in a range of
+//           characters.
+//  Parameter(s):
+//    <1> a_str: The start of the normal vector information
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a normal vector.
+//  Side Effect: If the characters specify a normal vector, that
 //               normal vector is added to this ObjModel.
 //               Otherwise, there is no effect.
 //
-	bool readNormal (const std::string& str,
+	bool readNormal (const char* a_str,
+	                 const char* a_end,
 	                 std::ostream& r_logstream);
 
 //
 //  readPointSet
 //
 //  Purpose: To add a point set to this ObjModel corresponding
-//           to the information in the specified string.
-//  Parameter(s):
-//    <1> str: The string containing the point set information
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a point set.
-//  Side Effect: If string str specifies a point set, that point
-//               set is added to this ObjModel and this ObjModel
-//               is marked as invalid.  Otherwise, there is no
-//               effect.
+//           to the information in the specified range of
+//           characters.
+//  Parameter(s):
+//    <1> a_str: The start of the point set information
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a point set.
+//  Side Effect: If the characters specify a point set, that
+//               point set is added to this ObjModel and this
+//               ObjModel is marked as invalid.  Otherwise,
+//               there is no effect.
 //
-	bool readPointSet (const std::string& str,
+	bool readPointSet (const char* a_str,
+	                   const char* a_end,
 	                   std::ostream& r_logstream);
 
 //
 //  readPolyline
 //
 //  Purpose: To add a polyline to this ObjModel corresponding to
-//           the information in a string.
+//           the information in a range of characters.
 //  Parameter(s):
-//    <1> str: The string containing the polyline information
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a polyline.
-//  Side Effect: If string str specifies a polyline, that
+//    <1> a_str: The start of the polyline information
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a polyline.
+//  Side Effect: If the characters specify a polyline, that
 //               polyline/face is added to this ObjModel and
 //               this ObjModel is marked as invalid.  Otherwise,
 //               there is no effect.
 //
-	bool readPolyline (const std::string& str,
+	bool readPolyline (const char* a_str,
+	                   const char* a_end,
 	                   std::ostream& r_logstream);
 
 //
 //  readFace
 //
 //  Purpose: To add a face to this ObjModel corresponding to the
-//           information in a string.
+//           information in a range of characters.
 //  Parameter(s):
-//    <1> str: The string containing the face information
-//    <2> r_logstream: The stream to write loading errors to
-//  Precondition(s): N/A
-//  Returns: Whether the string specifies a face.
-//  Side Effect: If string str specifies a face, that face is
+//    <1> a_str: The start of the face information
+//    <2> a_end: One past the end of the line
+//    <3> r_logstream: The stream to write loading errors to
+//  Precondition(s):
+//    <1> a_str != NULL
+//    <2> a_end != NULL
+//    <3> a_str <= a_end
+//  Returns: Whether the characters specify a face.
+//  Side Effect: If the characters specify a face, that face is
 //               added to this ObjModel and this ObjModel is
 //               marked as invalid.  Otherwise, there is no
 //               effect.
 //
-	bool readFace (const std::string& str,
+	bool readFace (const char* a_str,
+	               const char* a_end,
 	               std::ostream& r_logstream);
 
 //
@@ -3727,18 +3807,6 @@ private:
 		MtlLibrary* mp_mtl_library;
 	};
 
-	//
-	//  PointSet
-	//
-	//  A record to represent a set of points in an
-	//    ObjModel.  An PointSet contains the indices of
-	//    the vertexes to be treated as points.
-	//
-	struct PointSet
-	{
-		std::vector<unsigned int> mv_vertexes;
-	};
-
 	//
 	//  PolylineVertex
 	//
@@ -3766,18 +3834,6 @@ private:
 		unsigned int m_texture_coordinate;
 	};
 
-	//
-	//  Polyline
-	//
-	//  A record to represent a polyline in an ObjModel.  A
-	//    Polyline contains the indices of the vertexes that
-	//    form the polyline.
-	//
-	struct Polyline
-	{
-		std::vector<PolylineVertex> mv_vertexes;
-	};
-
 	//
 	//  FaceVertex
 	//
@@ -3810,15 +3866,61 @@ private:
 	};
 
 	//
-	//  Face
+	//  ElementLists
+	//
+	//  A record to represent a sequence of lists of elements,
+	//    such as the faces of a Mesh, each of which is a list
+	//    of FaceVertexes.  All the elements are stored in one
+	//    array, in list order, so adding a list does not
+	//    allocate memory of its own.  mv_starts holds the
+	//    position of the first element of each list.
+	//
+	//  If m_uniform_size is not 0, mv_starts can be left
+	//    empty while every list except the last has exactly
+	//    m_uniform_size elements.  This is used for faces, so
+	//    no offsets are stored for a model made of triangles.
+	//    Changing a list other than the last to a different
+	//    size fills in mv_starts, and makeUniform empties it
+	//    again if possible.
 	//
-	//  A record to represent a face in an ObjModel.  A Face
-	//    contains the indices of the vertexes that form
-	//    the outline of the face.
+	//  Functions are provided for the operations that ObjModel
+	//    performs on lists.  Lists and elements are numbered
+	//    from 0.
 	//
-	struct Face
+	template <typename T>
+	struct ElementLists
 	{
-		std::vector<FaceVertex> mv_vertexes;
+		ElementLists (unsigned int uniform_size);
+
+		unsigned int getCount () const;
+		unsigned int getSize (unsigned int list) const;
+		unsigned int getSizeTotal () const;
+		const T* getList (unsigned int list) const;
+		T* getList (unsigned int list);
+
+		bool isUniform () const;
+
+		unsigned int add ();
+		unsigned int addElement (unsigned int list,
+		                         const T& element);
+		void remove (unsigned int list);
+		void removeLast ();
+		void removeElement (unsigned int list,
+		                    unsigned int element);
+		void removeElementAll (unsigned int list);
+		void clear ();
+		void makeUniform ();
+
+		bool invariant () const;
+
+		std::vector<T> mv_elements;
+		std::vector<unsigned int> mv_starts;
+		unsigned int m_count;
+		unsigned int m_uniform_size;
+
+	private:
+		unsigned int getStart (unsigned int list) const;
+		void makeStarts ();
 	};
 
 	//
@@ -3830,7 +3932,9 @@ private:
 	//    pointer to the Material and to draw them with.  If
 	//    no material has been specified, the Material
 	//    pointer should be set to NULL and the material
-	//    name to the empty string.
+	//    name to the empty string.  The point sets,
+	//    polylines, and faces are each stored as an
+	//    ElementLists.
 	//
 	struct Mesh
 	{
@@ -3842,9 +3946,9 @@ private:
 
 		std::string m_material_name;
 		Material* mp_material;
-		std::vector<PointSet> mv_point_sets;
-		std::vector<Polyline> mv_polylines;
-		std::vector<Face> mv_faces;
+		ElementLists<unsigned int> m_point_sets;
+		ElementLists<PolylineVertex> m_polylines;
+		ElementLists<FaceVertex> m_faces;
 		bool m_all_triangles;
 	};
 
@@ -18,13 +18,111 @@
 //
 
 #include <cassert>
+#include <cctype>
+#include <cstddef>	// for NULL
+#include <cstdlib>	// for atof, atoi
 #include <string>
+#include <charconv>
+#include <system_error>
 
 #include "ObjStringParsing.h"
 
 using namespace std;
 using namespace ObjLibrary;
 using namespace ObjLibrary::ObjStringParsing;
+namespace
+{
+	//
+	//  POWERS_OF_TEN
+	//
+	//  The powers of ten that can be stored exactly in a
+	//    double.
+	//
+	const unsigned int POWER_OF_TEN_COUNT = 23;
+	const double POWERS_OF_TEN[POWER_OF_TEN_COUNT] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+		1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+		1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+
+	//
+	//  MAX_EXACT_MANTISSA
+	//
+	//  The largest integer below which every integer can be
+	//    stored exactly in a double.
+	//
+	const unsigned long long MAX_EXACT_MANTISSA = 1ull << 53;
+
+	//
+	//  parsePlainDecimal
+	//
+	//  Purpose: To quickly read a number written as digits with
+	//           an optional decimal point and no exponent.
+	//  Parameter(s):
+	//    <1> a_current: The start of the number, after any sign
+	//    <2> a_end: One past the last character that may be
+	//               part of the number
+	//    <3> r_value: The value read
+	//  Precondition(s):
+	//    <1> a_current <= a_end
+	//  Returns: One past the last character of the number, or
+	//           NULL if it could not be read this way.
+	//  Side Effect: If the number is at most 19 digits long,
+	//               with no exponent, and both its digits and
+	//               the power of ten it is divided by can be
+	//               stored exactly in a double, r_value is set
+	//               to it.  A single division of two exact
+	//               values is correctly rounded, so the result
+	//               is the same as from_chars or atof would give.
+	//               Otherwise, there is no effect.
+	//
+	const char* parsePlainDecimal (const char* a_current, const char* a_end,
+	                               double& r_value)
+	{
+		assert(a_current <= a_end);
+
+		// the digits are counted afterwards, so the loops only
+		//  have to look for the end of them; a mantissa that
+		//  wraps around is thrown away below
+		unsigned long long mantissa = 0;
+
+		const char* p = a_current;
+		while(p < a_end && *p >= '0' && *p <= '9')
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			p++;
+		}
+		size_t digit_count = p - a_current;
+
+		size_t fraction_count = 0;
+		if(p < a_end && *p == '.')
+		{
+			p++;
+			const char* a_fraction = p;
+			while(p < a_end && *p >= '0' && *p <= '9')
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				p++;
+			}
+			fraction_count = p - a_fraction;
+			digit_count += fraction_count;
+		}
+
+		if(digit_count == 0)
+			return NULL;
+		if(digit_count > 19)
+			return NULL;  // might have overflowed
+		if(p < a_end && (*p == 'e' || *p == 'E' || *p == 'x' || *p == 'X'))
+			return NULL;  // exponent or hexadecimal
+		if(mantissa > MAX_EXACT_MANTISSA || fraction_count >= POWER_OF_TEN_COUNT)
+			return NULL;
+
+		r_value = (double)(mantissa) / POWERS_OF_TEN[fraction_count];
+		return p;
+	}
+
+}  // end of anonymous namespace
 
 
 
@@ -85,6 +183,179 @@ size_t ObjStringParsing :: nextSlashInToken (const string& str, size_t current)
 }
 
 
+const char* ObjStringParsing :: nextToken (const char* a_current, const char* a_end)
+{
+	assert(a_current != NULL);
+	assert(a_end != NULL);
+	assert(a_current <= a_end);
+
+	bool seen_whitespace = false;
+
+	// return out of loop when next token is found
+	for(const char* p = a_current; p < a_end; p++)
+	{
+		if(seen_whitespace)
+		{
+			if(!isWhitespace(*p))
+				return p;
+		}
+		else
+		{
+			if(isWhitespace(*p))
+				seen_whitespace = true;
+		}
+	}
+
+	// you only get here if there is no next token
+	return NULL;
+}
+
+size_t ObjStringParsing :: getTokenLength (const char* a_current, const char* a_end)
+{
+	assert(a_current != NULL);
+	assert(a_end != NULL);
+	assert(a_current <= a_end);
+
+	const char* p = a_current;
+	while(p < a_end && !isWhitespace(*p))
+		p++;
+	return p - a_current;
+}
+
+const char* ObjStringParsing :: nextSlashInToken (const char* a_current, const char* a_end)
+{
+	assert(a_current != NULL);
+	assert(a_end != NULL);
+	assert(a_current <= a_end);
+
+	// return out of loop when next token is found
+	for(const char* p = a_current; p < a_end; p++)
+	{
+		if(*p == '/')
+			return p;
+		else if(isWhitespace(*p))
+			return NULL;
+	}
+
+	// you only get here if there is no next token
+	return NULL;
+}
+
+double ObjStringParsing :: parseDouble (const char* a_current, const char* a_end)
+{
+	const char* a_after;
+	return parseDouble(a_current, a_end, a_after);
+}
+
+double ObjStringParsing :: parseDouble (const char* a_current, const char* a_end,
+                                        const char*& ra_after)
+{
+	assert(a_current != NULL);
+	assert(a_end != NULL);
+	assert(a_current <= a_end);
+
+	ra_after = a_current;
+
+	// atof skips leading whitespace and accepts a '+' sign, but
+	//  from_chars does not
+	const char* p = a_current;
+	while(p < a_end && isWhitespace(*p))
+		p++;
+	bool is_after_whitespace = (p != a_current);
+	if(p < a_end && *p == '+')
+	{
+		p++;
+		if(p < a_end && *p == '-')
+			return 0.0;
+	}
+
+	bool is_negative = (p < a_end && *p == '-');
+	double value = 0.0;
+	const char* a_number_end = parsePlainDecimal(is_negative ? p + 1 : p, a_end, value);
+	if(a_number_end != NULL)
+	{
+		if(!is_after_whitespace)
+			ra_after = a_number_end;
+		return is_negative ? -value : value;
+	}
+
+	from_chars_result result = from_chars(p, a_end, value);
+	if(result.ec == errc::invalid_argument)
+		return 0.0;
+	if(result.ec == errc() && (result.ptr == a_end || (*result.ptr != 'x' && *result.ptr != 'X')))
+	{
+		if(!is_after_whitespace)
+			ra_after = result.ptr;
+		return value;
+	}
+
+	// out of range or hexadecimal, which atof handles differently
+	string copy(a_current, a_end);
+	return atof(copy.c_str());
+}
+
+int ObjStringParsing :: parseInt (const char* a_current, const char* a_end)
+{
+	const char* a_after;
+	return parseInt(a_current, a_end, a_after);
+}
+
+int ObjStringParsing :: parseInt (const char* a_current, const char* a_end,
+                                  const char*& ra_after)
+{
+	assert(a_current != NULL);
+	assert(a_end != NULL);
+	assert(a_current <= a_end);
+
+	ra_after = a_current;
+
+	// atoi skips leading whitespace and accepts a '+' sign, but
+	//  from_chars does not
+	const char* p = a_current;
+	while(p < a_end && isWhitespace(*p))
+		p++;
+	bool is_after_whitespace = (p != a_current);
+	if(p < a_end && *p == '+')
+	{
+		p++;
+		if(p < a_end && *p == '-')
+			return 0;
+	}
+
+	// most indexes are short, so read them directly
+	const char* a_digits = (p < a_end && *p == '-') ? p + 1 : p;
+	const char* a_digits_end = a_digits;
+	int value = 0;
+	while(a_digits_end < a_end && a_digits_end - a_digits < 9 &&
+	      *a_digits_end >= '0' && *a_digits_end <= '9')
+	{
+		value = value * 10 + (*a_digits_end - '0');
+		a_digits_end++;
+	}
+	if(a_digits_end > a_digits &&
+	   (a_digits_end == a_end || *a_digits_end < '0' || *a_digits_end > '9'))
+	{
+		if(!is_after_whitespace)
+			ra_after = a_digits_end;
+		return (a_digits == p) ? value : -value;
+	}
+
+	from_chars_result result = from_chars(p, a_end, value);
+	if(result.ec == errc::invalid_argument)
+		return 0;
+	if(result.ec == errc())
+	{
+		if(!is_after_whitespace)
+			ra_after = result.ptr;
+		return value;
+	}
+
+	// out of range, which atoi handles differently on each platform
+	string copy(a_current, a_end);
+	return atoi(copy.c_str());
+}
+
+
 
 string ObjStringParsing :: toLowercase (const string& str)
 {
@@ -93,6 +93,178 @@ size_t getTokenLength (const std::string& str, size_t current);
 size_t nextSlashInToken(const std::string& str, size_t current);
 
 
+//
+//  isWhitespace
+//
+//  Purpose: To determine if the specified character is
+//           whitespace.
+//  Parameter(s):
+//    <1> c: The character to test
+//  Precondition(s): N/A
+//  Returns: Whether c is whitespace.  This is the same result
+//           as isspace gives in the "C" locale, but this
+//           function does not look up the current locale, so
+//           it is much faster on long files.
+//  Side Effect: N/A
+//
+inline bool isWhitespace (char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+//
+//  nextToken
+//
+//  Purpose: To find the next token in the specified range of
+//           characters.  This function behaves the same as
+//           nextToken for a string, but does not require the
+//           characters to be copied into one.
+//  Parameter(s):
+//    <1> a_current: The character to begin searching at
+//    <2> a_end: One past the last character to search
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: A pointer to the beginning of the next token.  If
+//           there is no next token, NULL is returned.
+//  Side Effect: N/A
+//
+const char* nextToken (const char* a_current, const char* a_end);
+
+//
+//  getTokenLength
+//
+//  Purpose: To determine the length of the token starting with
+//           the specified character in the specified range of
+//           characters.  This function behaves the same as
+//           getTokenLength for a string.
+//  Parameter(s):
+//    <1> a_current: The beginning of the token
+//    <2> a_end: One past the last character to search
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: The length of the token beginning with a_current.
+//           If a_current is a whitespace character or is
+//           a_end, 0 is returned.
+//  Side Effect: N/A
+//
+size_t getTokenLength (const char* a_current, const char* a_end);
+
+//
+//  nextSlashInToken
+//
+//  Purpose: To find the next slash ('/') character in the
+//           current token of the specified range of characters.
+//           This function behaves the same as nextSlashInToken
+//           for a string.
+//  Parameter(s):
+//    <1> a_current: The character to begin searching at
+//    <2> a_end: One past the last character to search
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: A pointer to the next slash in this token.  If
+//           there is no next slash, NULL is returned.
+//  Side Effect: N/A
+//
+const char* nextSlashInToken (const char* a_current,
+                              const char* a_end);
+
+//
+//  parseDouble
+//
+//  Purpose: To read a floating-point number from the specified
+//           range of characters without copying them.
+//  Parameter(s):
+//    <1> a_current: The start of the number
+//    <2> a_end: One past the last character that may be part
+//               of the number
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: The same value as atof would for the characters
+//           from a_current to a_end, including 0.0 if they do
+//           not start with a number.
+//  Side Effect: N/A
+//
+double parseDouble (const char* a_current, const char* a_end);
+
+//
+//  parseDouble
+//
+//  Purpose: To read a floating-point number from the specified
+//           range of characters without copying them, and find
+//           where it ends.
+//  Parameter(s):
+//    <1> a_current: The start of the number
+//    <2> a_end: One past the last character that may be part
+//               of the number
+//    <3> ra_after: A reference to the pointer to set to the
+//                  end of the number
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: The same value as parseDouble with two parameters.
+//  Side Effect: ra_after is set to one past the last character
+//               of the number.  If a_current is whitespace or
+//               does not start a number that can be read
+//               exactly, ra_after is set to a_current.  Either
+//               way, nextToken and nextSlashInToken give the
+//               same result from ra_after as from a_current.
+//
+double parseDouble (const char* a_current, const char* a_end,
+                    const char*& ra_after);
+
+//
+//  parseInt
+//
+//  Purpose: To read an integer from the specified range of
+//           characters without copying them.
+//  Parameter(s):
+//    <1> a_current: The start of the number
+//    <2> a_end: One past the last character that may be part
+//               of the number
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: The same value as atoi would for the characters
+//           from a_current to a_end, including 0 if they do not
+//           start with a number.
+//  Side Effect: N/A
+//
+int parseInt (const char* a_current, const char* a_end);
+
+//
+//  parseInt
+//
+//  Purpose: To read an integer from the specified range of
+//           characters without copying them, and find where it
+//           ends.
+//  Parameter(s):
+//    <1> a_current: The start of the number
+//    <2> a_end: One past the last character that may be part
+//               of the number
+//    <3> ra_after: A reference to the pointer to set to the
+//                  end of the number
+//  Precondition(s):
+//    <1> a_current != NULL
+//    <2> a_end != NULL
+//    <3> a_current <= a_end
+//  Returns: The same value as parseInt with two parameters.
+//  Side Effect: ra_after is set as for parseDouble with three
+//               parameters.
+//
+int parseInt (const char* a_current, const char* a_end,
+              const char*& ra_after);
+
+
 
 //
 //  toLowercase
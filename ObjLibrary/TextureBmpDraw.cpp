@@ -0,0 +1,576 @@
+//
+//  TextureBmpDraw.cpp
+//
+//  The TextureBmp functions that call OpenGL.
+//
+//  This file is part of the ObjLibrary, by Richard Hamilton,
+//    which is copyright Hamilton 2009-2024.
+//
+//  You may use these files for any purpose as long as you do
+//    not explicitly claim them as your own work or object to
+//    other people using them.
+//
+//  If you are distributing the source files, you must not
+//    remove this notice.  If you are only distributing compiled
+//    code, no credit is required.
+//
+//  A (theoretically) up-to-date version of the ObjLibrary can
+//    be found at:
+//  http://infiniplix.ca/resources/obj_library/
+//
+
+#include <cassert>
+#include <string>
+
+#include "ObjSettings.h"
+
+#define GL_SILENCE_DEPRECATION
+// needs to be after #including ObjSettings.h so macro is defined
+#ifdef OBJ_LIBRARY_SHADER_DISPLAY
+	#include "../GetGlutWithShaders.h"
+#else
+	#include "../GetGlut.h"
+#endif
+
+#include "TextureBmp.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+
+
+bool TextureBmp :: isGlutInitialized ()
+{
+#ifdef GLUT_INIT_STATE
+	return glutGet(GLUT_INIT_STATE) == 1;
+#else
+	return true;
+#endif
+}
+
+
+
+unsigned int TextureBmp :: loadTexture (const char* a_filename)
+{
+	assert(isGlutInitialized());
+	assert(a_filename != NULL);
+
+	return loadTexture(string(a_filename));
+}
+
+unsigned int TextureBmp :: loadTexture (const string& filename)
+{
+	assert(isGlutInitialized());
+
+	TextureBmp image(filename);
+	if(image.isBad())
+		return 0;
+
+	return image.addToOpenGL();
+}
+
+unsigned int TextureBmp :: loadTexture (const char* a_filename,
+                                        unsigned char invisible_red,
+                                        unsigned char invisible_green,
+                                        unsigned char invisible_blue)
+{
+	assert(isGlutInitialized());
+	assert(a_filename != NULL);
+
+	return loadTexture(string(a_filename), invisible_red, invisible_green, invisible_blue);
+}
+
+unsigned int TextureBmp :: loadTexture (const string& filename,
+                                        unsigned char invisible_red,
+                                        unsigned char invisible_green,
+                                        unsigned char invisible_blue)
+{
+	assert(isGlutInitialized());
+
+	TextureBmp image_basic(filename);
+	if(image_basic.isBad())
+		return 0;
+
+	TextureBmp image_alpha(image_basic,
+	                       0, 0,
+	                       image_basic.getWidth(), image_basic.getHeight(),
+	                       invisible_red, invisible_green, invisible_blue);
+	assert(!image_alpha.isBad());
+	return image_alpha.addToOpenGL();
+}
+
+void TextureBmp :: loadTextureArray (const char* a_filename,
+                                     unsigned int textures_x,
+                                     unsigned int textures_y,
+                                     unsigned int texture_width,
+                                     unsigned int texture_height,
+                                     unsigned int texture_spacing_x,
+                                     unsigned int texture_spacing_y,
+                                     unsigned int a_names[])
+{
+	assert(isGlutInitialized());
+	assert(a_filename != NULL);
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	loadTextureArray(string(a_filename),
+	                 textures_x,        textures_y,
+	                 texture_width,     texture_height,
+	                 texture_spacing_x, texture_spacing_y,
+	                 a_names);
+}
+
+void TextureBmp :: loadTextureArray (const string& filename,
+                                     unsigned int textures_x,
+                                     unsigned int textures_y,
+                                     unsigned int texture_width,
+                                     unsigned int texture_height,
+                                     unsigned int texture_spacing_x,
+                                     unsigned int texture_spacing_y,
+                                     unsigned int a_names[])
+{
+	assert(isGlutInitialized());
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	unsigned int total_textures = textures_x * textures_y;
+	TextureBmp all(filename);
+
+	if(all.isBad())
+	{
+		for(unsigned int i = 0; i < total_textures; i++)
+			a_names[i] = 0;
+		return;
+	}
+
+	unsigned int seperation_x = texture_width  + texture_spacing_x;
+	unsigned int seperation_y = texture_height + texture_spacing_y;
+	unsigned int total_required_width  = textures_x * seperation_x - texture_spacing_x;
+	unsigned int total_required_height = textures_y * seperation_y - texture_spacing_y;
+
+	assert(total_required_width <= all.getWidth());
+	assert(total_required_height <= all.getHeight());
+
+	unsigned int next_name = 0;
+	for(unsigned int y = 0; y < textures_y; y++)
+		for(unsigned int x = 0; x < textures_x; x++)
+		{
+			TextureBmp bit(all,
+			               x * seperation_x, y * seperation_y,
+			               texture_width,    texture_height);
+			assert(!bit.isBad());
+			assert(next_name < total_textures);
+			a_names[next_name] = bit.addToOpenGL();
+			next_name++;
+		}
+}
+
+void TextureBmp :: loadTextureArray(const char* a_filename,
+                                     unsigned int textures_x,
+                                     unsigned int textures_y,
+                                     unsigned int texture_width,
+                                     unsigned int texture_height,
+                                     unsigned int texture_spacing_x,
+                                     unsigned int texture_spacing_y,
+                                     unsigned int a_names[],
+                                     unsigned char invisible_red,
+                                     unsigned char invisible_green,
+                                     unsigned char invisible_blue)
+{
+	assert(isGlutInitialized());
+	assert(a_filename != NULL);
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	loadTextureArray(string(a_filename),
+	                 textures_x,        textures_y,
+	                 texture_width,     texture_height,
+	                 texture_spacing_x, texture_spacing_y,
+	                 a_names,
+	                 invisible_red, invisible_green, invisible_blue);
+}
+
+void TextureBmp :: loadTextureArray (const string& filename,
+                                     unsigned int textures_x,
+                                     unsigned int textures_y,
+                                     unsigned int texture_width,
+                                     unsigned int texture_height,
+                                     unsigned int texture_spacing_x,
+                                     unsigned int texture_spacing_y,
+                                     unsigned int a_names[],
+                                     unsigned char invisible_red,
+                                     unsigned char invisible_green,
+                                     unsigned char invisible_blue)
+{
+	assert(isGlutInitialized());
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	unsigned int total_textures = textures_x * textures_y;
+	TextureBmp all(filename);
+
+	if(all.isBad())
+	{
+		for(unsigned int i = 0; i < total_textures; i++)
+			a_names[i] = 0;
+		return;
+	}
+
+	unsigned int seperation_x = texture_width  + texture_spacing_x;
+	unsigned int seperation_y = texture_height + texture_spacing_y;
+	unsigned int total_required_width  = textures_x * seperation_x - texture_spacing_x;
+	unsigned int total_required_height = textures_y * seperation_y - texture_spacing_y;
+
+	assert(total_required_width <= all.getWidth());
+	assert(total_required_height <= all.getHeight());
+
+	unsigned int next_name = 0;
+	for(unsigned int y = 0; y < textures_y; y++)
+		for(unsigned int x = 0; x < textures_x; x++)
+		{
+			TextureBmp bit(all,
+			               x * seperation_x, y * seperation_y,
+			               texture_width,    texture_height,
+			               invisible_red, invisible_green, invisible_blue);
+			assert(!bit.isBad());
+			assert(next_name < total_textures);
+			a_names[next_name] = bit.addToOpenGL();
+			next_name++;
+		}
+}
+
+
+
+#ifdef OBJ_LIBRARY_SHADER_DISPLAY
+
+unsigned int TextureBmp :: loadTexture2dArray (const char* a_filename,
+                                               unsigned int textures_x,
+                                               unsigned int textures_y,
+                                               unsigned int texture_width,
+                                               unsigned int texture_height,
+                                               unsigned int texture_spacing_x,
+                                               unsigned int texture_spacing_y)
+{
+	assert(isGlutInitialized());
+	assert(a_filename != NULL);
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	return loadTexture2dArray(string(a_filename),
+	                          textures_x,        textures_y,
+	                          texture_width,     texture_height,
+	                          texture_spacing_x, texture_spacing_y);
+}
+
+unsigned int TextureBmp :: loadTexture2dArray (const string& filename,
+                                               unsigned int textures_x,
+                                               unsigned int textures_y,
+                                               unsigned int texture_width,
+                                               unsigned int texture_height,
+                                               unsigned int texture_spacing_x,
+                                               unsigned int texture_spacing_y)
+{
+	assert(isGlutInitialized());
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	unsigned int total_textures = textures_x * textures_y;
+	TextureBmp all(filename);
+
+	if(all.isBad())
+		return 0;
+
+	unsigned int layer_count  = textures_x * textures_y;
+	unsigned int seperation_x = texture_width  + texture_spacing_x;
+	unsigned int seperation_y = texture_height + texture_spacing_y;
+	unsigned int total_required_width  = textures_x * seperation_x - texture_spacing_x;
+	unsigned int total_required_height = textures_y * seperation_y - texture_spacing_y;
+
+	assert(total_required_width <= all.getWidth());
+	assert(total_required_height <= all.getHeight());
+
+	//
+	//  A GL_TEXTURE_2D_ARRAY is essentially a 3D texture that
+	//    is accessed differently.  Each Z level stores a
+	//    seperate 2D image.  There is no Z interpolation.
+	// 
+
+	unsigned int texture_name = 0;
+    glGenTextures(1, &texture_name);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_name);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, data);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB,
+	             texture_width, texture_height, layer_count,
+	             0, GL_RGB, GL_UNSIGNED_BYTE,
+	             NULL);
+
+	unsigned int next_level = 0;
+	for(unsigned int y = 0; y < textures_y; y++)
+		for(unsigned int x = 0; x < textures_x; x++)
+		{
+			TextureBmp bit(all,
+			               x * seperation_x, y * seperation_y,
+			               texture_width,    texture_height);
+			assert(!bit.isBad());
+
+			// glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+			                0, 0, next_level,
+			                texture_width, texture_height, 1,
+			                GL_RGB, GL_UNSIGNED_BYTE,
+			                bit.getArray());
+
+			next_level++;
+		}
+
+	//glGenerateMipmap(GL_TEXTURE_2D_ARRAY);  // don't need, no mipmaps
+
+	return texture_name;
+}
+
+unsigned int TextureBmp :: loadTexture2dArray (const char* a_filename,
+                                               unsigned int textures_x,
+                                               unsigned int textures_y,
+                                               unsigned int texture_width,
+                                               unsigned int texture_height,
+                                               unsigned int texture_spacing_x,
+                                               unsigned int texture_spacing_y,
+                                               unsigned char invisible_red,
+                                               unsigned char invisible_green,
+                                               unsigned char invisible_blue)
+{
+	assert(isGlutInitialized());
+	assert(a_filename != NULL);
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	return loadTexture2dArray(string(a_filename),
+	                          textures_x,        textures_y,
+	                          texture_width,     texture_height,
+	                          texture_spacing_x, texture_spacing_y,
+	                          invisible_red, invisible_green, invisible_blue);
+}
+
+unsigned int TextureBmp :: loadTexture2dArray (const string& filename,
+                                               unsigned int textures_x,
+                                               unsigned int textures_y,
+                                               unsigned int texture_width,
+                                               unsigned int texture_height,
+                                               unsigned int texture_spacing_x,
+                                               unsigned int texture_spacing_y,
+                                               unsigned char invisible_red,
+                                               unsigned char invisible_green,
+                                               unsigned char invisible_blue)
+{
+	assert(isGlutInitialized());
+	assert(textures_x != 0);
+	assert(textures_y != 0);
+	assert(texture_width != 0);
+	assert(texture_height != 0);
+
+	unsigned int total_textures = textures_x * textures_y;
+	TextureBmp all(filename);
+
+	if(all.isBad())
+		return 0;
+
+	unsigned int layer_count  = textures_x * textures_y;
+	unsigned int seperation_x = texture_width  + texture_spacing_x;
+	unsigned int seperation_y = texture_height + texture_spacing_y;
+	unsigned int total_required_width  = textures_x * seperation_x - texture_spacing_x;
+	unsigned int total_required_height = textures_y * seperation_y - texture_spacing_y;
+
+	assert(total_required_width <= all.getWidth());
+	assert(total_required_height <= all.getHeight());
+
+	//
+	//  A GL_TEXTURE_2D_ARRAY is essentially a 3D texture that
+	//    is accessed differently.  Each Z level stores a
+	//    seperate 2D image.  There is no Z interpolation.
+	// 
+
+	unsigned int texture_name = 0;
+    glGenTextures(1, &texture_name);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_name);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, data);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA,
+	             texture_width, texture_height, layer_count,
+	             0, GL_RGBA, GL_UNSIGNED_BYTE,
+	             NULL);
+
+	unsigned int next_level = 0;
+	for(unsigned int y = 0; y < textures_y; y++)
+		for(unsigned int x = 0; x < textures_x; x++)
+		{
+			TextureBmp bit(all,
+			               x * seperation_x, y * seperation_y,
+			               texture_width,    texture_height,
+			               invisible_red, invisible_green, invisible_blue);
+			assert(!bit.isBad());
+
+			// glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+			                0, 0, next_level,
+			                texture_width, texture_height, 1,
+			                GL_RGBA, GL_UNSIGNED_BYTE,
+			                bit.getArray());
+
+			next_level++;
+		}
+
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+	return texture_name;
+}
+
+#endif
+
+
+
+unsigned int TextureBmp :: addToOpenGL () const
+{
+	assert(isGlutInitialized());
+
+	return addToOpenGL(GL_REPEAT, GL_REPEAT, GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST);
+}
+
+unsigned int TextureBmp :: addToOpenGL (unsigned int wrap) const
+{
+	assert(isGlutInitialized());
+#ifndef OBJ_LIBRARY_SHADER_DISPLAY
+	assert(wrap == GL_REPEAT || wrap == GL_CLAMP);
+#else
+	assert(wrap == GL_REPEAT ||
+	       wrap == GL_MIRRORED_REPEAT ||
+	       wrap == GL_CLAMP_TO_EDGE ||
+	       wrap == GL_CLAMP_TO_BORDER);
+#endif
+
+	return addToOpenGL(wrap, wrap, GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST);
+}
+
+unsigned int TextureBmp :: addToOpenGL (unsigned int wrap_s,
+                                        unsigned int wrap_t) const
+{
+	assert(isGlutInitialized());
+#ifndef OBJ_LIBRARY_SHADER_DISPLAY
+	assert(wrap_s == GL_REPEAT || wrap_s == GL_CLAMP);
+	assert(wrap_t == GL_REPEAT || wrap_t == GL_CLAMP);
+#else
+	assert(wrap_s == GL_REPEAT ||
+	       wrap_s == GL_MIRRORED_REPEAT ||
+	       wrap_s == GL_CLAMP_TO_EDGE ||
+	       wrap_s == GL_CLAMP_TO_BORDER);
+	assert(wrap_t == GL_REPEAT ||
+	       wrap_t == GL_MIRRORED_REPEAT ||
+	       wrap_t == GL_CLAMP_TO_EDGE ||
+	       wrap_t == GL_CLAMP_TO_BORDER);
+#endif
+
+	return addToOpenGL(wrap_s, wrap_t, GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST);
+}
+
+unsigned int TextureBmp :: addToOpenGL (unsigned int wrap_s,
+                                        unsigned int wrap_t,
+                                        unsigned int mag_filter,
+                                        unsigned int min_filter) const
+{
+	assert(isGlutInitialized());
+#ifndef OBJ_LIBRARY_SHADER_DISPLAY
+	assert(wrap_s == GL_REPEAT || wrap_s == GL_CLAMP);
+	assert(wrap_t == GL_REPEAT || wrap_t == GL_CLAMP);
+#else
+	assert(wrap_s == GL_REPEAT ||
+	       wrap_s == GL_MIRRORED_REPEAT ||
+	       wrap_s == GL_CLAMP_TO_EDGE ||
+	       wrap_s == GL_CLAMP_TO_BORDER);
+	assert(wrap_t == GL_REPEAT ||
+	       wrap_t == GL_MIRRORED_REPEAT ||
+	       wrap_t == GL_CLAMP_TO_EDGE ||
+	       wrap_t == GL_CLAMP_TO_BORDER);
+#endif
+	assert(mag_filter == GL_NEAREST ||
+	       mag_filter == GL_LINEAR);
+	assert(min_filter == GL_NEAREST ||
+	       min_filter == GL_LINEAR ||
+	       min_filter == GL_NEAREST_MIPMAP_NEAREST ||
+	       min_filter == GL_NEAREST_MIPMAP_LINEAR ||
+	       min_filter == GL_LINEAR_MIPMAP_NEAREST ||
+	       min_filter == GL_LINEAR_MIPMAP_LINEAR);
+
+	unsigned int name;
+
+	glGenTextures(1, &name);
+	glBindTexture(GL_TEXTURE_2D, name);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+
+	if(min_filter == GL_NEAREST || min_filter == GL_LINEAR)
+	{
+		// void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid *pixels);
+		if(m_is_alpha)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, md_texture);
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,  m_width, m_height, 0, GL_RGB,  GL_UNSIGNED_BYTE, md_texture);
+	}
+	else
+	{
+#ifndef OBJ_LIBRARY_SHADER_DISPLAY
+		// old way of doing mipmaps
+
+		//
+		//  Creating mipmaps seems to scale you to a power-of-2
+		//    texture automatically.
+		//   -> but after truncating to 4 bytes width
+		//
+
+		// GLint gluBuild2DMipmaps(GLenum  target,  GLint  internalFormat,  GLsizei  width,  GLsizei  height,  GLenum  format,  GLenum  type,  const void *  data);
+		if(m_is_alpha)
+			gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, md_texture);
+		else
+			gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB,  m_width, m_height, GL_RGB,  GL_UNSIGNED_BYTE, md_texture);
+
+#else
+		// new way of doing mipmaps
+
+		// first load the texture without mipmaps
+		if(m_is_alpha)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, md_texture);
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,  m_width, m_height, 0, GL_RGB,  GL_UNSIGNED_BYTE, md_texture);
+
+		// then generate the mipmaps
+		glGenerateMipmap(GL_TEXTURE_2D);
+#endif
+	}
+
+	return name;
+}
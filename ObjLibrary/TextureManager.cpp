@@ -20,6 +20,7 @@
 #include <cassert>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <iostream>
 #include <fstream>
 
@@ -51,14 +52,15 @@ namespace
 	struct TextureData
 	{
 		string  m_name;
+		string  m_name_lowercase;
 		Texture m_texture;
 	};
 
-	// some sort of hash table would be nice
-	//  -> convert to map<> when C++11 becomes more widely
-	//     supported?
 	vector<TextureData*> gvp_textures;
 
+	// the index of each texture, by lowercase name
+	unordered_map<string, unsigned int> g_texture_indexes;
+
 	//
 	//  This variable has to by dynamically alloated so that it
 	//    is not destroyed when the program terminates.
@@ -137,7 +139,7 @@ unsigned int TextureManager :: getCount ()
 	return (unsigned int)(gvp_textures.size());
 }
 
-const std::string& getName (unsigned int index)
+const std::string& TextureManager :: getName (unsigned int index)
 {
 	assert(index < getCount());
 
@@ -174,7 +176,7 @@ const Texture& TextureManager :: get (const string& name)
 	{
 		assert(index < (unsigned int)(gvp_textures.size()));
 		assert(gvp_textures[index] != NULL);
-		assert(toLowercase(gvp_textures[index]->m_name) == toLowercase(name));
+		assert(gvp_textures[index]->m_name_lowercase == toLowercase(name));
 		return gvp_textures[index]->m_texture;
 	}
 }
@@ -218,20 +220,18 @@ unsigned int TextureManager :: getIndex (const char* a_name)
 {
 	assert(a_name != NULL);
 
-	return isLoaded(string(a_name));
+	return getIndex(string(a_name));
 }
 
 unsigned int TextureManager :: getIndex (const std::string& name)
 {
-	string lower = toLowercase(name);
+	unordered_map<string, unsigned int>::const_iterator it = g_texture_indexes.find(toLowercase(name));
+	if(it == g_texture_indexes.end())
+		return TEXTURE_INDEX_INVALID;
 
-	for(unsigned int i = 0; i < (unsigned int)(gvp_textures.size()); i++)
-	{
-		assert(gvp_textures[i] != NULL);
-		if(toLowercase(gvp_textures[i]->m_name) == lower)
-			return i;
-	}
-	return TEXTURE_INDEX_INVALID;
+	assert(it->second < (unsigned int)(gvp_textures.size()));
+	assert(gvp_textures[it->second] != NULL);
+	return it->second;
 }
 
 bool TextureManager :: isDummyTexture (const Texture& texture)
@@ -285,12 +285,43 @@ unsigned int TextureManager :: add (const Texture& texture, const string& name)
 	gvp_textures.push_back(new TextureData);
 	assert(texture_count < (unsigned int)(gvp_textures.size()));
 	assert(gvp_textures[texture_count] != NULL);
-	gvp_textures[texture_count]->m_name    = name;
-	gvp_textures[texture_count]->m_texture = texture;
+	gvp_textures[texture_count]->m_name           = name;
+	gvp_textures[texture_count]->m_name_lowercase = toLowercase(name);
+	gvp_textures[texture_count]->m_texture        = texture;
+	g_texture_indexes[gvp_textures[texture_count]->m_name_lowercase] = texture_count;
 
 	return texture_count;
 }
 
+unsigned int TextureManager :: add (const TextureBmp& image,
+                                    const string& name)
+{
+	assert(Texture::isGlutInitialized());
+	assert(!image.isBad());
+	assert(!isLoaded(name));
+
+	// same defaults as load
+#ifdef OBJ_LIBRARY_LINEAR_TEXTURE_INTERPOLATION
+	return add(image, name, GL_REPEAT, GL_REPEAT, GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR);
+#else
+	return add(image, name, GL_REPEAT, GL_REPEAT, GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST);
+#endif
+}
+
+unsigned int TextureManager :: add (const TextureBmp& image,
+                                    const string& name,
+                                    unsigned int wrap_s,
+                                    unsigned int wrap_t,
+                                    unsigned int mag_filter,
+                                    unsigned int min_filter)
+{
+	assert(Texture::isGlutInitialized());
+	assert(!image.isBad());
+	assert(!isLoaded(name));
+
+	return add(image.addToOpenGL(wrap_s, wrap_t, mag_filter, min_filter), name);
+}
+
 
 
 unsigned int TextureManager :: load (const char* a_name)
@@ -598,7 +629,7 @@ unsigned int TextureManager :: load (const std::string& name,
 			//texture_bmp.mirrorY();
 			//
 
-			return add(texture_bmp.addToOpenGL(wrap_s, wrap_t, mag_filter, min_filter), name);
+			return add(texture_bmp, name, wrap_s, wrap_t, mag_filter, min_filter);
 		}
 	}
 	else if(endsWith(lower, ".png"))
@@ -981,7 +1012,7 @@ unsigned int TextureManager :: load (const std::string& name,
 			TextureBmp texture_alpha(texture_bmp,
 			                         0, 0, texture_bmp.getWidth(), texture_bmp.getHeight(),
 			                         g_transparent_red, g_transparent_green, g_transparent_blue);
-			return add(texture_alpha.addToOpenGL(wrap_s, wrap_t, mag_filter, min_filter), name);
+			return add(texture_alpha, name, wrap_s, wrap_t, mag_filter, min_filter);
 		}
 	}
 	else if(endsWith(lower, ".png"))
@@ -1030,6 +1061,7 @@ void TextureManager :: unloadAll ()
 		delete gvp_textures[i];	// destructor frees video memory
 	}
 	gvp_textures.clear();
+	g_texture_indexes.clear();
 }
 
 
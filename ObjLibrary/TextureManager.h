@@ -32,6 +32,7 @@ namespace ObjLibrary
 
 class Vector3;
 class Texture;
+class TextureBmp;
 
 
 
@@ -59,7 +60,12 @@ class Texture;
 //    -> wrapping and min/magnification options
 //    -> a transparent colour
 //
-//  Name comparisons are always case-insensitive.
+//  Name comparisons are always case-insensitive.  The textures
+//    are indexed by their lowercase names in a hash table, so
+//    finding a texture by name takes constant time on average.
+//    Code that uses a texture often should still keep its index
+//    or a reference to it instead of looking it up by name
+//    each time.
 //
 namespace TextureManager
 {
@@ -374,6 +380,62 @@ unsigned int add (const Texture& texture,
 unsigned int add (const Texture& texture,
                   const std::string& name);
 
+//
+//  add
+//
+//  Purpose: To add an image that has already been loaded to the
+//           texture manager with the specified name.
+//  Parameter(s):
+//    <1> image: The image
+//    <2> name: The name of the texture
+//  Precondition(s):
+//    <1> Texture::isGlutInitialized()
+//    <2> !image.isBad()
+//    <3> !isLoaded(name)
+//  Returns: The index that the texture was added at.
+//  Side Effect: Image image is added to OpenGL and the texture
+//               manager under the name name.  The texture has
+//               the same wrapping mode and filters as one
+//               loaded from a file without them being
+//               specified.  This allows the file to be read on
+//               another thread.
+//
+unsigned int add (const TextureBmp& image,
+                  const std::string& name);
+
+//
+//  add
+//
+//  Purpose: To add an image that has already been loaded to the
+//           texture manager with the specified name, wrapping
+//           mode, and magification and minification filters.
+//  Parameter(s):
+//    <1> image: The image
+//    <2> name: The name of the texture
+//    <3> wrap_s:
+//    <4> wrap_t: The behaviour of the texture outside of the
+//                range [0, 1) along the x-/y-axis
+//    <5> mag_filter: The magnification filter
+//    <6> min_filter: The minification filter
+//  Precondition(s):
+//    <1> Texture::isGlutInitialized()
+//    <2> !image.isBad()
+//    <3> !isLoaded(name)
+//    <4> The wrapping modes and filters are valid, as for load
+//  Returns: The index that the texture was added at.
+//  Side Effect: Image image is added to OpenGL and the texture
+//               manager under the name name, with wrapping
+//               modes wrap_s and wrap_t in the S and T
+//               directions, magnification filter mag_filter,
+//               and minification filter min_filter.
+//
+unsigned int add (const TextureBmp& image,
+                  const std::string& name,
+                  unsigned int wrap_s,
+                  unsigned int wrap_t,
+                  unsigned int mag_filter,
+                  unsigned int min_filter);
+
 //
 //  load
 //
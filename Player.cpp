@@ -3,8 +3,6 @@
 #include <cassert>
 #include <vector>
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector3.h"
 
 #include "Player.h"
@@ -47,7 +45,7 @@ bool Player::getAutoPilotValue() {
 }
 
 
-void Player::AI_Update(Fish& fish, float delta_time) {
+void Player::AI_Update(const Fish& fish, float delta_time, bool is_path_clear) {
 
     Vector3 fish_initial_pos = fish.getPosition();
     unsigned int fish_species = fish.getSpecies();
@@ -71,7 +69,8 @@ void Player::AI_Update(Fish& fish, float delta_time) {
 
     Vector3 newVelocity = this->getVelocity() + S;
 
-    if (horizontal_distance < 5.0) {
+    // nothing in the way: chase straight instead of going over the top
+    if (horizontal_distance < 5.0 || is_path_clear) {
       //  cout << "chasing fish"; 
       
 
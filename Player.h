@@ -41,12 +41,14 @@ public:
     void turnOffAutoPilot();
     bool getAutoPilotValue();
        
-    void AI_Update(Fish& fish,float delta_time);
+    // is_path_clear: whether the player can swim straight to the
+    //  fish without hitting the terrain
+    void AI_Update(const Fish& fish, float delta_time, bool is_path_clear);
     string getPlayerState();
     // Other player-specific methods...
 
      unsigned  int fishSchoolIndex;
-     unsigned int fishIndex;
+     unsigned int fishId;  // see FishSchool::getFishId
      double max_speed;
      double max_accleration;
      unsigned int current_autoPilot_state;
@@ -0,0 +1,387 @@
+//
+//  Profiler.cpp
+//
+
+#include "Profiler.h"
+
+#include <cassert>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+namespace
+{
+	//
+	//  Event
+	//
+	//  A record to represent one run of a zone.
+	//
+	struct Event
+	{
+		const char* ma_name;
+		long long m_start_ns;
+		long long m_duration_ns;
+		unsigned int m_thread;
+	};
+
+	//
+	//  ThreadBuffer
+	//
+	//  A record to hold the events recorded on one thread that
+	//    have not been collected yet.
+	//
+	struct ThreadBuffer
+	{
+		mutex m_mutex;
+		vector<Event> mv_events;
+		string m_name;
+		unsigned int m_index;
+	};
+
+	//
+	//  ZoneHistory
+	//
+	//  A record to hold the time and number of runs for one zone
+	//    in each of the last FRAME_HISTORY frames.
+	//
+	struct ZoneHistory
+	{
+		double ma_ms[Profiler::FRAME_HISTORY];
+		unsigned int ma_calls[Profiler::FRAME_HISTORY];
+	};
+
+	//
+	//  ZoneNameLess
+	//
+	//  A function object to order zone names so that each zone
+	//    comes right before the zones nested in it, even if
+	//    another name starts with the same characters.
+	//
+	struct ZoneNameLess
+	{
+		bool operator() (const string& a, const string& b) const
+		{
+			size_t length = min(a.size(), b.size());
+			for(size_t i = 0; i < length; i++)
+				if(a[i] != b[i])
+				{
+					if(a[i] == '/')
+						return true;
+					if(b[i] == '/')
+						return false;
+					return (unsigned char)(a[i]) < (unsigned char)(b[i]);
+				}
+			return a.size() < b.size();
+		}
+	};
+
+	// events kept per thread if markFrame is not called
+	const size_t MAX_PENDING_EVENTS = 1 << 20;
+
+	atomic<bool> g_is_enabled(false);
+	const chrono::steady_clock::time_point g_start_time = chrono::steady_clock::now();
+
+	//
+	//  These are dynamically allocated and never freed so that
+	//    a thread that records a zone while the program is
+	//    exiting does not use a destroyed buffer.
+	//
+	mutex* gp_threads_mutex = new mutex;
+	vector<ThreadBuffer*>* gpv_threads = new vector<ThreadBuffer*>;
+	thread_local ThreadBuffer* gp_thread_buffer = NULL;
+
+	// only used by the thread that collects the events
+	deque<Event> g_trace;
+	map<string, ZoneHistory, ZoneNameLess> g_histories;
+	unsigned int g_frame_count = 0;
+	vector<Event> gv_collected;
+
+	//
+	//  getThreadBuffer
+	//
+	//  Purpose: To retrieve the event buffer for the calling
+	//           thread.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: The buffer for the calling thread.
+	//  Side Effect: If the calling thread does not have a
+	//               buffer yet, one is created and numbered.
+	//
+	ThreadBuffer& getThreadBuffer ()
+	{
+		if(gp_thread_buffer == NULL)
+		{
+			ThreadBuffer* p_buffer = new ThreadBuffer;
+			lock_guard<mutex> lock(*gp_threads_mutex);
+			p_buffer->m_index = gpv_threads->size();
+			p_buffer->m_name  = "Thread " + to_string(p_buffer->m_index);
+			gpv_threads->push_back(p_buffer);
+			gp_thread_buffer = p_buffer;
+		}
+		assert(gp_thread_buffer != NULL);
+		return *gp_thread_buffer;
+	}
+
+	//
+	//  getNowNs
+	//
+	//  Purpose: To determine the current time.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: The time since the profiler started, in
+	//           nanoseconds.
+	//  Side Effect: N/A
+	//
+	long long getNowNs ()
+	{
+		chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - g_start_time;
+		return chrono::duration_cast<chrono::nanoseconds>(elapsed).count();
+	}
+
+	//
+	//  collectEvents
+	//
+	//  Purpose: To take the events recorded on every thread.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: gv_collected is set to the events waiting in
+	//               the thread buffers, which are then emptied.
+	//               The events are also added to the trace,
+	//               removing the oldest if there are more than
+	//               MAX_TRACE_EVENTS.
+	//
+	void collectEvents ()
+	{
+		gv_collected.clear();
+		{
+			lock_guard<mutex> lock(*gp_threads_mutex);
+			for(unsigned int t = 0; t < gpv_threads->size(); t++)
+			{
+				ThreadBuffer& r_buffer = *(*gpv_threads)[t];
+				lock_guard<mutex> buffer_lock(r_buffer.m_mutex);
+				gv_collected.insert(gv_collected.end(), r_buffer.mv_events.begin(), r_buffer.mv_events.end());
+				r_buffer.mv_events.clear();
+			}
+		}
+
+		g_trace.insert(g_trace.end(), gv_collected.begin(), gv_collected.end());
+		while(g_trace.size() > Profiler::MAX_TRACE_EVENTS)
+			g_trace.pop_front();
+	}
+
+	//
+	//  writeJsonString
+	//
+	//  Purpose: To write a string as a JSON string literal.
+	//  Parameter(s):
+	//    <1> r_out: The stream to write to
+	//    <2> text: The string to write
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: text is written to r_out in quotes, with
+	//               quotes, backslashes, and control characters
+	//               escaped.
+	//
+	void writeJsonString (ostream& r_out, const string& text)
+	{
+		r_out << '"';
+		for(size_t i = 0; i < text.size(); i++)
+		{
+			char c = text[i];
+			if(c == '"' || c == '\\')
+				r_out << '\\' << c;
+			else if((unsigned char)(c) < 0x20)
+				r_out << ' ';
+			else
+				r_out << c;
+		}
+		r_out << '"';
+	}
+
+}  // end of anonymous namespace
+
+
+
+bool Profiler :: isEnabled ()
+{
+	return g_is_enabled.load(memory_order_relaxed);
+}
+
+void Profiler :: setEnabled (bool is_enabled)
+{
+	g_is_enabled.store(is_enabled, memory_order_relaxed);
+}
+
+void Profiler :: setThreadName (const std::string& name)
+{
+	ThreadBuffer& r_buffer = getThreadBuffer();
+	lock_guard<mutex> lock(*gp_threads_mutex);
+	r_buffer.m_name = name;
+}
+
+long long Profiler :: beginZone (const char* a_name)
+{
+	assert(a_name != NULL);
+
+	if(!g_is_enabled.load(memory_order_relaxed))
+		return -1;
+	return getNowNs();
+}
+
+void Profiler :: endZone (const char* a_name, long long start_ns)
+{
+	assert(a_name != NULL);
+
+	if(start_ns < 0)
+		return;
+
+	Event event;
+	event.ma_name       = a_name;
+	event.m_start_ns    = start_ns;
+	event.m_duration_ns = getNowNs() - start_ns;
+
+	ThreadBuffer& r_buffer = getThreadBuffer();
+	event.m_thread = r_buffer.m_index;
+	lock_guard<mutex> lock(r_buffer.m_mutex);
+	if(r_buffer.mv_events.size() < MAX_PENDING_EVENTS)
+		r_buffer.mv_events.push_back(event);
+}
+
+void Profiler :: markFrame ()
+{
+	collectEvents();
+
+	// add up each zone by name pointer first, which is cheap
+	unordered_map<const char*, pair<double, unsigned int> > frame_totals;
+	for(unsigned int i = 0; i < gv_collected.size(); i++)
+	{
+		pair<double, unsigned int>& r_total = frame_totals[gv_collected[i].ma_name];
+		r_total.first  += gv_collected[i].m_duration_ns * 1.0e-6;
+		r_total.second += 1;
+	}
+
+	// then start a new slot for every zone, recorded or not
+	unsigned int slot = g_frame_count % FRAME_HISTORY;
+	for(map<string, ZoneHistory, ZoneNameLess>::iterator it = g_histories.begin(); it != g_histories.end(); ++it)
+	{
+		it->second.ma_ms   [slot] = 0.0;
+		it->second.ma_calls[slot] = 0;
+	}
+	for(unordered_map<const char*, pair<double, unsigned int> >::const_iterator it = frame_totals.begin();
+	    it != frame_totals.end(); ++it)
+	{
+		string name = it->first;
+		if(g_histories.count(name) == 0)
+		{
+			ZoneHistory& r_new = g_histories[name];
+			for(unsigned int f = 0; f < FRAME_HISTORY; f++)
+			{
+				r_new.ma_ms   [f] = 0.0;
+				r_new.ma_calls[f] = 0;
+			}
+		}
+
+		// the same name may be more than one string literal
+		ZoneHistory& r_history = g_histories[name];
+		r_history.ma_ms   [slot] += it->second.first;
+		r_history.ma_calls[slot] += it->second.second;
+	}
+	g_frame_count++;
+}
+
+std::vector<Profiler::ZoneStatistics> Profiler :: getStatistics ()
+{
+	vector<ZoneStatistics> v_statistics;
+
+	unsigned int frame_count = min(g_frame_count, FRAME_HISTORY);
+	if(frame_count == 0)
+		return v_statistics;
+
+	for(map<string, ZoneHistory, ZoneNameLess>::const_iterator it = g_histories.begin(); it != g_histories.end(); ++it)
+	{
+		const ZoneHistory& history = it->second;
+
+		ZoneStatistics statistics;
+		statistics.m_name = it->first;
+		statistics.m_average_ms    = 0.0;
+		statistics.m_max_ms        = 0.0;
+		statistics.m_average_calls = 0.0;
+		for(unsigned int f = 0; f < frame_count; f++)
+		{
+			statistics.m_average_ms    += history.ma_ms[f];
+			statistics.m_max_ms         = max(statistics.m_max_ms, history.ma_ms[f]);
+			statistics.m_average_calls += history.ma_calls[f];
+		}
+		if(statistics.m_average_calls == 0.0)
+			continue;  // not recorded recently
+		statistics.m_average_ms    /= frame_count;
+		statistics.m_average_calls /= frame_count;
+		v_statistics.push_back(statistics);
+	}
+
+	return v_statistics;
+}
+
+unsigned int Profiler :: getDepth (const std::string& name)
+{
+	unsigned int depth = 0;
+	for(size_t i = 0; i < name.size(); i++)
+		if(name[i] == '/')
+			depth++;
+	return depth;
+}
+
+unsigned int Profiler :: saveTrace (const std::string& filename)
+{
+	collectEvents();
+
+	ofstream fout(filename);
+	if(!fout)
+		return 0;
+
+	fout << "{\"traceEvents\":[" << endl;
+
+	// thread names first, so the tracks are labelled
+	{
+		lock_guard<mutex> lock(*gp_threads_mutex);
+		for(unsigned int t = 0; t < gpv_threads->size(); t++)
+		{
+			if(t > 0)
+				fout << "," << endl;
+			fout << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+			     << ",\"args\":{\"name\":";
+			writeJsonString(fout, (*gpv_threads)[t]->m_name);
+			fout << "}}";
+		}
+	}
+
+	fout << fixed << setprecision(3);
+	for(deque<Event>::const_iterator it = g_trace.begin(); it != g_trace.end(); ++it)
+	{
+		// Chrome trace times are in microseconds
+		fout << "," << endl;
+		fout << "{\"name\":";
+		writeJsonString(fout, it->ma_name);
+		fout << ",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":" << it->m_thread
+		     << ",\"ts\":"  << it->m_start_ns    * 1.0e-3
+		     << ",\"dur\":" << it->m_duration_ns * 1.0e-3 << "}";
+	}
+
+	fout << endl << "]," << endl;
+	fout << "\"displayTimeUnit\":\"ms\"}" << endl;
+
+	if(!fout)
+		return 0;
+	return g_trace.size();
+}
@@ -0,0 +1,257 @@
+//
+//  Profiler.h
+//
+//  A module to measure how long each part of a frame takes.
+//
+//  Zones are marked in the code with UWSIM_PROFILE_ZONE, which
+//    times the rest of the enclosing block.  To remove the zones
+//    at compile time, define the macro UWSIM_PROFILER_DISABLE.
+//    The macro then expands to nothing, so the zones cost
+//    nothing at all.  The Release configurations of the Visual
+//    Studio projects define it; Debug builds keep the zones.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+
+//
+//  Profiler
+//
+//  A global service to record timing zones from any thread.
+//    Each zone has a name, which is a string literal.  Names
+//    with '/' in them are shown nested under the zone with the
+//    name before the last '/', e.g. "Physics/AI" under
+//    "Physics".  Zones can also be nested in time on one
+//    thread, and a Chrome trace shows them that way.
+//
+//  Zones only record anything while the profiler is enabled.
+//    While it is disabled, each zone costs a check of one flag.
+//    Each thread records into its own buffer, and the buffers
+//    are collected by markFrame.  Recording only locks the
+//    buffer of the current thread, so threads do not wait for
+//    each other.
+//
+//  The statistics and trace functions must only be called from
+//    one thread, normally the main thread.
+//
+namespace Profiler
+{
+
+//
+//  ZoneStatistics
+//
+//  A record to represent how long one zone took over the last
+//    few frames.  Times are in milliseconds per frame and add
+//    up the time on every thread.  A zone that runs more than
+//    once in a frame counts all its runs.
+//
+struct ZoneStatistics
+{
+	std::string m_name;
+	double m_average_ms;
+	double m_max_ms;
+	double m_average_calls;
+};
+
+//
+//  FRAME_HISTORY
+//
+//  The number of frames the statistics are kept for.
+//
+const unsigned int FRAME_HISTORY = 60;
+
+//
+//  isEnabled
+//
+//  Purpose: To determine if the zones are being recorded.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the profiler is enabled.
+//  Side Effect: N/A
+//
+bool isEnabled ();
+
+//
+//  setEnabled
+//
+//  Purpose: To start or stop recording the zones.
+//  Parameter(s):
+//    <1> is_enabled: Whether to record the zones
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The profiler is enabled or disabled.  A zone
+//               that was started while the profiler was
+//               enabled is recorded when it ends.  Statistics
+//               and trace events already recorded are kept.
+//
+void setEnabled (bool is_enabled);
+
+//
+//  setThreadName
+//
+//  Purpose: To set the name the calling thread is shown with
+//           in a Chrome trace.
+//  Parameter(s):
+//    <1> name: The name for the thread
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The calling thread is named name.  A thread
+//               that is not named is shown by its number.
+//
+void setThreadName (const std::string& name);
+
+//
+//  beginZone
+//
+//  Purpose: To start timing a zone on the calling thread.  This
+//           is normally called by a Zone.
+//  Parameter(s):
+//    <1> a_name: The name of the zone
+//  Precondition(s):
+//    <1> a_name != NULL
+//    <2> a_name is a string literal, or otherwise lasts as
+//        long as the program
+//  Returns: The start time of the zone, in nanoseconds since
+//           the profiler started, or -1 if the profiler is not
+//           enabled.
+//  Side Effect: N/A
+//
+long long beginZone (const char* a_name);
+
+//
+//  endZone
+//
+//  Purpose: To finish timing a zone on the calling thread.
+//           This is normally called by a Zone.
+//  Parameter(s):
+//    <1> a_name: The name of the zone
+//    <2> start_ns: The value returned by beginZone
+//  Precondition(s):
+//    <1> a_name != NULL
+//    <2> a_name is the name beginZone was called with
+//  Returns: N/A
+//  Side Effect: If start_ns is not -1, the zone is recorded for
+//               the calling thread.
+//
+void endZone (const char* a_name, long long start_ns);
+
+//
+//  markFrame
+//
+//  Purpose: To mark the end of a frame.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The zones recorded on every thread since the
+//               last call are collected.  The statistics are
+//               updated with them as one frame, and they are
+//               kept for the trace.  Only the most recent
+//               MAX_TRACE_EVENTS zones are kept for the trace.
+//
+void markFrame ();
+
+//
+//  getStatistics
+//
+//  Purpose: To retrieve the statistics for every zone.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The statistics over the last FRAME_HISTORY frames
+//           for each zone that was recorded in that time,
+//           sorted by name so that nested zones follow the zone
+//           they are in.
+//  Side Effect: N/A
+//
+std::vector<ZoneStatistics> getStatistics ();
+
+//
+//  getDepth
+//
+//  Purpose: To determine how deeply a zone is nested by name.
+//  Parameter(s):
+//    <1> name: The name of the zone
+//  Precondition(s): N/A
+//  Returns: The number of '/' characters in name.
+//  Side Effect: N/A
+//
+unsigned int getDepth (const std::string& name);
+
+//
+//  saveTrace
+//
+//  Purpose: To write the recorded zones as a Chrome trace.
+//  Parameter(s):
+//    <1> filename: The name of the file to write
+//  Precondition(s): N/A
+//  Returns: The number of zones written, or 0 if the file could
+//           not be written.
+//  Side Effect: The zones that have not been collected yet are
+//               collected, as by markFrame but without ending a
+//               frame.  A JSON file in the Chrome trace_event
+//               format is written to file filename, which can
+//               be opened with chrome://tracing or Perfetto.
+//               Each zone is a complete ("X") event on the
+//               thread it ran on.
+//
+unsigned int saveTrace (const std::string& filename);
+
+//
+//  MAX_TRACE_EVENTS
+//
+//  The largest number of zones kept for saveTrace.
+//
+const unsigned int MAX_TRACE_EVENTS = 1 << 20;
+
+
+
+//
+//  Zone
+//
+//  A class to time a zone from its construction to its
+//    destruction.  Use UWSIM_PROFILE_ZONE instead of making one
+//    directly, so the zone can be compiled out.
+//
+class Zone
+{
+public:
+	explicit Zone (const char* a_name)
+			: ma_name(a_name),
+			  m_start_ns(beginZone(a_name))
+	{ }
+
+	~Zone ()
+	{
+		endZone(ma_name, m_start_ns);
+	}
+
+private:
+	Zone (const Zone& original);
+	Zone& operator= (const Zone& original);
+
+private:
+	const char* ma_name;
+	long long m_start_ns;
+};
+
+}  // end of namespace Profiler
+
+
+
+//
+//  UWSIM_PROFILE_ZONE
+//
+//  A macro to time the rest of the enclosing block as a zone
+//    with the specified name, which must be a string literal.
+//
+#ifndef UWSIM_PROFILER_DISABLE
+	#define UWSIM_PROFILE_ZONE_JOIN2(a, b) a##b
+	#define UWSIM_PROFILE_ZONE_JOIN(a, b) UWSIM_PROFILE_ZONE_JOIN2(a, b)
+	#define UWSIM_PROFILE_ZONE(name) \
+		Profiler::Zone UWSIM_PROFILE_ZONE_JOIN(profile_zone_, __LINE__)(name)
+#else
+	#define UWSIM_PROFILE_ZONE(name)
+#endif
@@ -0,0 +1,136 @@
+//
+//  RandomStream.cpp
+//
+
+#include "RandomStream.h"
+
+#include <cassert>
+
+#include "ObjLibrary/Vector3.h"
+
+using namespace ObjLibrary;
+namespace
+{
+	const unsigned long long GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+	//
+	//  splitMix64
+	//
+	//  Purpose: To generate the next value from a splitmix64
+	//           generator.  This is used to spread the seed bits
+	//           across the xoshiro state.
+	//  Parameter(s):
+	//    <1> r_state: The splitmix64 state
+	//  Precondition(s): N/A
+	//  Returns: A pseudorandom 64-bit value.
+	//  Side Effect: r_state is advanced.
+	//
+	unsigned long long splitMix64 (unsigned long long& r_state)
+	{
+		r_state += GOLDEN_GAMMA;
+		unsigned long long z = r_state;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	inline unsigned long long rotateLeft (unsigned long long x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+}  // end of anonymous namespace
+
+
+
+RandomStream :: RandomStream ()
+{
+	unsigned long long mix = 0;
+	for(unsigned int i = 0; i < 4; i++)
+		ma_state[i] = splitMix64(mix);
+
+	assert(isInvariantTrue());
+}
+
+RandomStream :: RandomStream (unsigned long long seed,
+                              unsigned long long stream)
+{
+	// hash the stream number first so nearby streams differ in every bit
+	unsigned long long stream_mix = stream;
+	unsigned long long mix = seed ^ splitMix64(stream_mix);
+	for(unsigned int i = 0; i < 4; i++)
+		ma_state[i] = splitMix64(mix);
+
+	// the all-zero state never changes, so avoid it
+	if(!isInvariantTrue())
+		ma_state[0] = GOLDEN_GAMMA;
+
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned long long RandomStream :: getNext ()
+{
+	assert(isInvariantTrue());
+
+	unsigned long long result = rotateLeft(ma_state[1] * 5, 7) * 9;
+	unsigned long long t = ma_state[1] << 17;
+
+	ma_state[2] ^= ma_state[0];
+	ma_state[3] ^= ma_state[1];
+	ma_state[1] ^= ma_state[2];
+	ma_state[0] ^= ma_state[3];
+	ma_state[2] ^= t;
+	ma_state[3] = rotateLeft(ma_state[3], 45);
+
+	assert(isInvariantTrue());
+	return result;
+}
+
+double RandomStream :: getDouble ()
+{
+	// top 53 bits give every double in [0, 1) with spacing 2^-53
+	return (getNext() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+unsigned int RandomStream :: getUnsigned (unsigned int max)
+{
+	assert(max > 0);
+
+	// multiply-shift: the bias is at most max / 2^32, far too small to matter here
+	unsigned long long high32 = getNext() >> 32;
+	return (unsigned int)((high32 * max) >> 32);
+}
+
+Vector3 RandomStream :: getUnitVector ()
+{
+	double seed1 = getDouble();
+	double seed2 = getDouble();
+	return Vector3::getPseudorandomUnitVector(seed1, seed2);
+}
+
+Vector3 RandomStream :: getUnitVectorYZ ()
+{
+	return Vector3::getPseudorandomUnitVectorYZ(getDouble());
+}
+
+Vector3 RandomStream :: getSphereVector ()
+{
+	double seed1 = getDouble();
+	double seed2 = getDouble();
+	double seed3 = getDouble();
+	return Vector3::getPseudorandomSphereVector(seed1, seed2, seed3);
+}
+
+
+
+bool RandomStream :: isInvariantTrue () const
+{
+	if(ma_state[0] == 0 && ma_state[1] == 0 &&
+	   ma_state[2] == 0 && ma_state[3] == 0)
+	{
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,133 @@
+//
+//  RandomStream.h
+//
+//  A module to generate reproducible streams of random numbers.
+//
+
+#pragma once
+
+#include "ObjLibrary/Vector3.h"
+
+
+
+//
+//  RandomStream
+//
+//  A class to generate pseudorandom numbers using the
+//    xoshiro256** algorithm.  Unlike rand(), each RandomStream
+//    has its own state, so different parts of the simulation
+//    can draw numbers at the same time on different threads,
+//    and the numbers do not depend on the order in which they
+//    run.
+//
+//  A RandomStream is identified by a seed and a stream number.
+//    Streams with the same seed and different stream numbers
+//    are independent, so a single world seed can be used to
+//    create one stream for each fish school and subsystem.
+//
+//  Class Invariant:
+//    <1> The four state words are not all 0
+//
+class RandomStream
+{
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To construct a RandomStream with seed 0 and stream
+//           number 0.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A RandomStream is constructed.
+//
+	RandomStream ();
+
+//
+//  Constructor
+//
+//  Purpose: To construct a RandomStream with the specified seed
+//           and stream number.
+//  Parameter(s):
+//    <1> seed: The seed, usually the world seed
+//    <2> stream: The stream number
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A RandomStream is constructed.  Its state is
+//               calculated from seed and stream using the
+//               splitmix64 algorithm, so similar seeds give
+//               unrelated sequences.
+//
+	RandomStream (unsigned long long seed,
+	              unsigned long long stream);
+
+//
+//  getNext
+//
+//  Purpose: To generate the next raw value in this
+//           RandomStream.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: A pseudorandom 64-bit value.
+//  Side Effect: The state of this RandomStream is advanced.
+//
+	unsigned long long getNext ();
+
+//
+//  getDouble
+//
+//  Purpose: To generate a pseudorandom number in [0, 1).
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: A value that is at least 0.0 and strictly less
+//           than 1.0.
+//  Side Effect: The state of this RandomStream is advanced.
+//
+	double getDouble ();
+
+//
+//  getUnsigned
+//
+//  Purpose: To generate a pseudorandom integer in [0, max).
+//  Parameter(s):
+//    <1> max: The upper bound
+//  Precondition(s):
+//    <1> max > 0
+//  Returns: A value that is strictly less than max.
+//  Side Effect: The state of this RandomStream is advanced.
+//
+	unsigned int getUnsigned (unsigned int max);
+
+//
+//  getUnitVector
+//  getUnitVectorYZ
+//  getSphereVector
+//
+//  Purpose: To generate a pseudorandom vector with the same
+//           distribution as the Vector3 function with the
+//           matching name (e.g. Vector3::getRandomUnitVector).
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: A unit vector, a unit vector in the YZ plane, or a
+//           vector with a norm of at most 1.0.
+//  Side Effect: The state of this RandomStream is advanced.
+//
+	ObjLibrary::Vector3 getUnitVector ();
+	ObjLibrary::Vector3 getUnitVectorYZ ();
+	ObjLibrary::Vector3 getSphereVector ();
+
+private:
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+private:
+	unsigned long long ma_state[4];
+};
@@ -0,0 +1,48 @@
+//
+//  SchoolAggregates.h
+//
+//  A module to store summary values for a school of fish.
+//
+
+#pragma once
+
+#include "ObjLibrary/Vector3.h"
+
+
+
+//
+//  SchoolAggregates
+//
+//  A record to store values calculated over all the fish in a
+//    school.  The values are calculated once per tick by
+//    FishSchool::updateAggregates and are then read by the AI,
+//    by Map::findNearestSchool, and by the collision
+//    broadphase instead of looping over the fish again.
+//
+//  The bounds are conservative: every fish is always inside
+//    both the bounding sphere and the bounding box, but after
+//    fish are removed they may be larger than necessary until
+//    the next full update.  The sums are stored so that the
+//    averages can be updated when fish are removed.
+//
+//  If m_count is 0, the other values are meaningless.
+//
+struct SchoolAggregates
+{
+	unsigned int m_count;
+
+	ObjLibrary::Vector3 m_position_sum;
+	ObjLibrary::Vector3 m_centroid;
+	double m_radius;  // of bounding sphere around m_centroid, including fish radius
+
+	ObjLibrary::Vector3 m_box_min;  // including fish radius
+	ObjLibrary::Vector3 m_box_max;
+
+	ObjLibrary::Vector3 m_heading_sum;
+	ObjLibrary::Vector3 m_mean_heading;  // unit vector, or zero if the fish cancel out
+
+	double m_speed_sum;
+	double m_speed_min;
+	double m_speed_max;
+	double m_speed_mean;
+};
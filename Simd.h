@@ -0,0 +1,269 @@
+//
+//  Simd.h
+//
+//  A module to wrap the SIMD instruction sets used by the
+//    batched simulation kernels.
+//
+//  Each lane type provides a Value type with the arithmetic
+//    operators and static functions to load, gather, store,
+//    and compare values.  Kernels are written once as templates
+//    over a lane type and instantiated for the widest
+//    available instruction set and for LaneScalar, which is
+//    used for the leftover elements and when SIMD is disabled.
+//
+//  The instruction set is chosen at compile time:
+//    <1> If __AVX__ is defined (e.g. /arch:AVX or -mavx), AVX
+//        is used, giving 8 floats or 4 doubles per lane.
+//    <2> Otherwise, if SSE2 is available (always true for
+//        x64), SSE2 is used, giving 4 floats or 2 doubles per
+//        lane.
+//    <3> Otherwise, only LaneScalar is available.
+//  To force the scalar path at compile time, define the macro
+//    UWSIM_SIMD_DISABLE.
+//
+
+#pragma once
+
+#include <cmath>
+
+#ifndef UWSIM_SIMD_DISABLE
+	#if defined(__AVX__)
+		#define UWSIM_SIMD_AVX
+		#include <immintrin.h>
+	#elif defined(__SSE2__) || defined(_M_X64) || \
+	      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define UWSIM_SIMD_SSE2
+		#include <emmintrin.h>
+	#endif
+#endif
+
+
+
+namespace Simd
+{
+
+//
+//  LaneScalar
+//
+//  A lane type that processes one element at a time using
+//    ordinary arithmetic.
+//
+template <typename T>
+struct LaneScalar
+{
+	typedef T Value;
+	typedef bool Mask;
+	static const unsigned int WIDTH = 1;
+
+	static Value load (const T* p)            { return *p; }
+	static Value gather (const T* p, const unsigned int* a)
+	                                          { return p[a[0]]; }
+	static void  store (T* p, Value a)        { *p = a; }
+	static Value set (T a)                    { return a; }
+	static Value sqrt (Value a)               { return std::sqrt(a); }
+	static Value min (Value a, Value b)       { return (a < b) ? a : b; }
+	static Value max (Value a, Value b)       { return (a > b) ? a : b; }
+	static Mask  greater (Value a, Value b)   { return a > b; }
+	static Value select (Mask m, Value if_true, Value if_false)
+	                                          { return m ? if_true : if_false; }
+};
+
+
+
+#ifdef UWSIM_SIMD_AVX
+
+	struct FloatAvx
+	{
+		__m256 v;
+		FloatAvx () {}
+		FloatAvx (__m256 a) : v(a) {}
+	};
+	inline FloatAvx operator+ (FloatAvx a, FloatAvx b) { return _mm256_add_ps(a.v, b.v); }
+	inline FloatAvx operator- (FloatAvx a, FloatAvx b) { return _mm256_sub_ps(a.v, b.v); }
+	inline FloatAvx operator* (FloatAvx a, FloatAvx b) { return _mm256_mul_ps(a.v, b.v); }
+	inline FloatAvx operator/ (FloatAvx a, FloatAvx b) { return _mm256_div_ps(a.v, b.v); }
+
+	struct DoubleAvx
+	{
+		__m256d v;
+		DoubleAvx () {}
+		DoubleAvx (__m256d a) : v(a) {}
+	};
+	inline DoubleAvx operator+ (DoubleAvx a, DoubleAvx b) { return _mm256_add_pd(a.v, b.v); }
+	inline DoubleAvx operator- (DoubleAvx a, DoubleAvx b) { return _mm256_sub_pd(a.v, b.v); }
+	inline DoubleAvx operator* (DoubleAvx a, DoubleAvx b) { return _mm256_mul_pd(a.v, b.v); }
+	inline DoubleAvx operator/ (DoubleAvx a, DoubleAvx b) { return _mm256_div_pd(a.v, b.v); }
+
+	template <typename T> struct LaneBest;
+
+	template <>
+	struct LaneBest<float>
+	{
+		typedef FloatAvx Value;
+		typedef FloatAvx Mask;
+		static const unsigned int WIDTH = 8;
+
+		static Value load (const float* p)       { return _mm256_loadu_ps(p); }
+		static Value gather (const float* p, const unsigned int* a)
+		{
+			return _mm256_set_ps(p[a[7]], p[a[6]], p[a[5]], p[a[4]],
+			                     p[a[3]], p[a[2]], p[a[1]], p[a[0]]);
+		}
+		static void  store (float* p, Value a)   { _mm256_storeu_ps(p, a.v); }
+		static Value set (float a)               { return _mm256_set1_ps(a); }
+		static Value sqrt (Value a)              { return _mm256_sqrt_ps(a.v); }
+		static Value min (Value a, Value b)      { return _mm256_min_ps(a.v, b.v); }
+		static Value max (Value a, Value b)      { return _mm256_max_ps(a.v, b.v); }
+		static Mask  greater (Value a, Value b)  { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+		static Value select (Mask m, Value if_true, Value if_false)
+		                                         { return _mm256_blendv_ps(if_false.v, if_true.v, m.v); }
+	};
+
+	template <>
+	struct LaneBest<double>
+	{
+		typedef DoubleAvx Value;
+		typedef DoubleAvx Mask;
+		static const unsigned int WIDTH = 4;
+
+		static Value load (const double* p)      { return _mm256_loadu_pd(p); }
+		static Value gather (const double* p, const unsigned int* a)
+		                                         { return _mm256_set_pd(p[a[3]], p[a[2]], p[a[1]], p[a[0]]); }
+		static void  store (double* p, Value a)  { _mm256_storeu_pd(p, a.v); }
+		static Value set (double a)              { return _mm256_set1_pd(a); }
+		static Value sqrt (Value a)              { return _mm256_sqrt_pd(a.v); }
+		static Value min (Value a, Value b)      { return _mm256_min_pd(a.v, b.v); }
+		static Value max (Value a, Value b)      { return _mm256_max_pd(a.v, b.v); }
+		static Mask  greater (Value a, Value b)  { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+		static Value select (Mask m, Value if_true, Value if_false)
+		                                         { return _mm256_blendv_pd(if_false.v, if_true.v, m.v); }
+	};
+
+#elif defined(UWSIM_SIMD_SSE2)
+
+	struct FloatSse
+	{
+		__m128 v;
+		FloatSse () {}
+		FloatSse (__m128 a) : v(a) {}
+	};
+	inline FloatSse operator+ (FloatSse a, FloatSse b) { return _mm_add_ps(a.v, b.v); }
+	inline FloatSse operator- (FloatSse a, FloatSse b) { return _mm_sub_ps(a.v, b.v); }
+	inline FloatSse operator* (FloatSse a, FloatSse b) { return _mm_mul_ps(a.v, b.v); }
+	inline FloatSse operator/ (FloatSse a, FloatSse b) { return _mm_div_ps(a.v, b.v); }
+
+	struct DoubleSse
+	{
+		__m128d v;
+		DoubleSse () {}
+		DoubleSse (__m128d a) : v(a) {}
+	};
+	inline DoubleSse operator+ (DoubleSse a, DoubleSse b) { return _mm_add_pd(a.v, b.v); }
+	inline DoubleSse operator- (DoubleSse a, DoubleSse b) { return _mm_sub_pd(a.v, b.v); }
+	inline DoubleSse operator* (DoubleSse a, DoubleSse b) { return _mm_mul_pd(a.v, b.v); }
+	inline DoubleSse operator/ (DoubleSse a, DoubleSse b) { return _mm_div_pd(a.v, b.v); }
+
+	template <typename T> struct LaneBest;
+
+	// SSE2 has no blend instruction, so select uses and/andnot/or
+
+	template <>
+	struct LaneBest<float>
+	{
+		typedef FloatSse Value;
+		typedef FloatSse Mask;
+		static const unsigned int WIDTH = 4;
+
+		static Value load (const float* p)       { return _mm_loadu_ps(p); }
+		static Value gather (const float* p, const unsigned int* a)
+		                                         { return _mm_set_ps(p[a[3]], p[a[2]], p[a[1]], p[a[0]]); }
+		static void  store (float* p, Value a)   { _mm_storeu_ps(p, a.v); }
+		static Value set (float a)               { return _mm_set1_ps(a); }
+		static Value sqrt (Value a)              { return _mm_sqrt_ps(a.v); }
+		static Value min (Value a, Value b)      { return _mm_min_ps(a.v, b.v); }
+		static Value max (Value a, Value b)      { return _mm_max_ps(a.v, b.v); }
+		static Mask  greater (Value a, Value b)  { return _mm_cmpgt_ps(a.v, b.v); }
+		static Value select (Mask m, Value if_true, Value if_false)
+		{
+			return _mm_or_ps(_mm_and_ps(m.v, if_true.v),
+			                 _mm_andnot_ps(m.v, if_false.v));
+		}
+	};
+
+	template <>
+	struct LaneBest<double>
+	{
+		typedef DoubleSse Value;
+		typedef DoubleSse Mask;
+		static const unsigned int WIDTH = 2;
+
+		static Value load (const double* p)      { return _mm_loadu_pd(p); }
+		static Value gather (const double* p, const unsigned int* a)
+		                                         { return _mm_set_pd(p[a[1]], p[a[0]]); }
+		static void  store (double* p, Value a)  { _mm_storeu_pd(p, a.v); }
+		static Value set (double a)              { return _mm_set1_pd(a); }
+		static Value sqrt (Value a)              { return _mm_sqrt_pd(a.v); }
+		static Value min (Value a, Value b)      { return _mm_min_pd(a.v, b.v); }
+		static Value max (Value a, Value b)      { return _mm_max_pd(a.v, b.v); }
+		static Mask  greater (Value a, Value b)  { return _mm_cmpgt_pd(a.v, b.v); }
+		static Value select (Mask m, Value if_true, Value if_false)
+		{
+			return _mm_or_pd(_mm_and_pd(m.v, if_true.v),
+			                 _mm_andnot_pd(m.v, if_false.v));
+		}
+	};
+
+#else
+
+	template <typename T>
+	struct LaneBest : public LaneScalar<T>
+	{};
+
+#endif
+
+
+
+//
+//  isAvailable
+//
+//  Purpose: To determine if a SIMD instruction set was
+//           compiled in.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether LaneBest uses SIMD instructions.  If not,
+//           LaneBest is the same as LaneScalar.
+//  Side Effect: N/A
+//
+inline bool isAvailable ()
+{
+#if defined(UWSIM_SIMD_AVX) || defined(UWSIM_SIMD_SSE2)
+	return true;
+#else
+	return false;
+#endif
+}
+
+//
+//  getInstructionSetName
+//
+//  Purpose: To determine the name of the SIMD instruction set
+//           that was compiled in.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: "AVX", "SSE2", or "scalar".
+//  Side Effect: N/A
+//
+inline const char* getInstructionSetName ()
+{
+#if defined(UWSIM_SIMD_AVX)
+	return "AVX";
+#elif defined(UWSIM_SIMD_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+
+
+}  // end of namespace Simd
@@ -10,12 +10,18 @@
 
 #ifdef _WIN32
 
-	#include <windows.h>  // needed for Sleep(millisec)
+	#include <windows.h>   // needed for Sleep(millisec)
+	#include <mmsystem.h>  // needed for timeBeginPeriod
+	#pragma comment(lib, "winmm.lib")
 
 	void sleep (double seconds)
 	{
 		assert(seconds >= 0.0);
 
+		// by default, Sleep only wakes every 15.6 ms
+		static const bool IS_TIMER_PRECISE = (timeBeginPeriod(1) == TIMERR_NOERROR);
+		(void)(IS_TIMER_PRECISE);
+
 		int milliseconds = (int)(seconds * 1000.0);
 
 		if(milliseconds > 0)
@@ -0,0 +1,336 @@
+//
+//  SpatialHashGrid.cpp
+//
+
+#include "SpatialHashGrid.h"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	const double POINTS_PER_CELL = 2.0;
+	const unsigned int BUCKETS_PER_POINT = 2;
+
+	const unsigned int HASH_PRIME_X = 73856093u;
+	const unsigned int HASH_PRIME_Y = 19349663u;
+	const unsigned int HASH_PRIME_Z = 83492791u;
+
+	//
+	//  calculateCellSize
+	//
+	//  Purpose: To choose a cell size that puts about
+	//           POINTS_PER_CELL points in each cell.
+	//  Parameter(s):
+	//    <1> extent: The size of the bounding box of the points
+	//    <2> point_count: The number of points
+	//  Precondition(s):
+	//    <1> point_count > 0
+	//  Returns: The cell size.  If the points are (nearly) all
+	//           in a plane or line, the cell size is chosen for
+	//           a 2D or 1D distribution instead.  If the points
+	//           are all in the same place, 1.0 is returned.
+	//  Side Effect: N/A
+	//
+	double calculateCellSize (const Vector3& extent,
+	                          unsigned int point_count)
+	{
+		assert(point_count > 0);
+
+		// sort extents so that e0 <= e1 <= e2
+		double e0 = extent.x;
+		double e1 = extent.y;
+		double e2 = extent.z;
+		if(e0 > e1) swap(e0, e1);
+		if(e1 > e2) swap(e1, e2);
+		if(e0 > e1) swap(e0, e1);
+
+		double cells_wanted = point_count / POINTS_PER_CELL;
+		double cell_size = cbrt(e0 * e1 * e2 / cells_wanted);
+		if(e0 <= cell_size)
+		{
+			// points are in (nearly) a plane
+			cell_size = sqrt(e1 * e2 / cells_wanted);
+			if(e1 <= cell_size)
+			{
+				// points are in (nearly) a line
+				cell_size = e2 / cells_wanted;
+			}
+		}
+
+		if(!(cell_size > 0.0))
+			return 1.0;
+		return cell_size;
+	}
+
+}  // end of anonymous namespace
+
+
+
+SpatialHashGrid :: SpatialHashGrid ()
+		: m_cell_size(1.0),
+		  m_min(0.0, 0.0, 0.0),
+		  m_cell_count_x(0),
+		  m_cell_count_y(0),
+		  m_cell_count_z(0),
+		  m_bucket_mask(0)
+		// mv_bucket_start will be initialized to empty by the default constructor
+		// mv_entries will be initialized to empty by the default constructor
+{
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned int SpatialHashGrid :: getPointCount () const
+{
+	assert(isInvariantTrue());
+
+	return mv_entries.size();
+}
+
+double SpatialHashGrid :: getCellSize () const
+{
+	assert(isInvariantTrue());
+
+	return m_cell_size;
+}
+
+unsigned int SpatialHashGrid :: findNearest (const ObjLibrary::Vector3& query,
+                                             unsigned int exclude,
+                                             unsigned int k,
+                                             unsigned int a_nearest[]) const
+{
+	assert(isInvariantTrue());
+	assert(k <= MAX_NEAREST);
+	assert(k == 0 || a_nearest != NULL);
+
+	if(mv_entries.empty() || k == 0)
+		return 0;
+
+	double a_distance_squared[MAX_NEAREST];
+	unsigned int found = 0;
+
+	int center_x;
+	int center_y;
+	int center_z;
+	calculateCell(query, center_x, center_y, center_z);
+
+	int max_ring = m_cell_count_x;
+	if(m_cell_count_y > max_ring)
+		max_ring = m_cell_count_y;
+	if(m_cell_count_z > max_ring)
+		max_ring = m_cell_count_z;
+
+	//
+	//  Search outwards in cubic shells of cells.  After shell
+	//    r has been searched, every point not yet seen is at
+	//    least r cells away along some axis, so it is at least
+	//    r * m_cell_size from query.  Once the k-th nearest
+	//    point found is closer than that, we can stop.
+	//
+
+	for(int ring = 0; ring < max_ring; ring++)
+	{
+		int x_min = center_x - ring;
+		int x_max = center_x + ring;
+		int y_min = center_y - ring;
+		int y_max = center_y + ring;
+		int z_min = center_z - ring;
+		int z_max = center_z + ring;
+
+		for(int x = (x_min < 0 ? 0 : x_min); x <= x_max && x < m_cell_count_x; x++)
+		{
+			bool is_x_edge = (x == x_min || x == x_max);
+			for(int y = (y_min < 0 ? 0 : y_min); y <= y_max && y < m_cell_count_y; y++)
+			{
+				bool is_xy_edge = is_x_edge || (y == y_min || y == y_max);
+				int z_step = is_xy_edge ? 1 : (z_max - z_min);
+				if(z_step <= 0)
+					z_step = 1;
+
+				for(int z = z_min; z <= z_max; z += z_step)
+				{
+					if(z < 0 || z >= m_cell_count_z)
+						continue;
+
+					unsigned long long key = getCellKey(x, y, z);
+					unsigned int bucket = getBucket(x, y, z);
+					unsigned int end = mv_bucket_start[bucket + 1];
+					for(unsigned int e = mv_bucket_start[bucket]; e < end; e++)
+					{
+						const Entry& entry = mv_entries[e];
+						if(entry.m_cell_key != key || entry.m_index == exclude)
+							continue;
+
+						double distance_squared = query.getDistanceSquared(entry.m_position);
+						if(found == k && distance_squared >= a_distance_squared[k - 1])
+							continue;
+
+						// insertion sort into the nearest list
+						unsigned int slot = (found < k) ? found : k - 1;
+						while(slot > 0 && a_distance_squared[slot - 1] > distance_squared)
+						{
+							a_distance_squared[slot] = a_distance_squared[slot - 1];
+							a_nearest[slot]          = a_nearest[slot - 1];
+							slot--;
+						}
+						a_distance_squared[slot] = distance_squared;
+						a_nearest[slot]          = entry.m_index;
+						if(found < k)
+							found++;
+					}
+				}
+			}
+		}
+
+		if(found == k)
+		{
+			double searched_distance = ring * m_cell_size;
+			if(a_distance_squared[k - 1] <= searched_distance * searched_distance)
+				break;
+		}
+	}
+
+	assert(found <= k);
+	return found;
+}
+
+
+
+void SpatialHashGrid :: rebuild (const std::vector<ObjLibrary::Vector3>& v_positions)
+{
+	assert(isInvariantTrue());
+
+	unsigned int point_count = v_positions.size();
+	mv_entries.resize(point_count);
+	if(point_count == 0)
+	{
+		m_cell_count_x = 0;
+		m_cell_count_y = 0;
+		m_cell_count_z = 0;
+		m_bucket_mask  = 0;
+		mv_bucket_start.clear();
+		assert(isInvariantTrue());
+		return;
+	}
+
+	// calculate bounding box and cell size
+
+	Vector3 max = v_positions[0];
+	m_min = v_positions[0];
+	for(unsigned int i = 1; i < point_count; i++)
+	{
+		const Vector3& position = v_positions[i];
+		if(position.x < m_min.x) m_min.x = position.x;
+		if(position.y < m_min.y) m_min.y = position.y;
+		if(position.z < m_min.z) m_min.z = position.z;
+		if(position.x > max.x) max.x = position.x;
+		if(position.y > max.y) max.y = position.y;
+		if(position.z > max.z) max.z = position.z;
+	}
+
+	Vector3 extent = max - m_min;
+	m_cell_size = calculateCellSize(extent, point_count);
+	m_cell_count_x = (int)(extent.x / m_cell_size) + 1;
+	m_cell_count_y = (int)(extent.y / m_cell_size) + 1;
+	m_cell_count_z = (int)(extent.z / m_cell_size) + 1;
+
+	unsigned int bucket_count = 1;
+	while(bucket_count < point_count * BUCKETS_PER_POINT)
+		bucket_count *= 2;
+	m_bucket_mask = bucket_count - 1;
+
+	//
+	//  Counting sort the points by bucket.  After counting,
+	//    mv_bucket_start[b + 1] is the end of bucket b.  While
+	//    placing, each mv_bucket_start[b] is advanced to the
+	//    end of bucket b, so we shift everything back by one
+	//    afterwards.
+	//
+
+	mv_bucket_start.assign(bucket_count + 1, 0);
+	for(unsigned int i = 0; i < point_count; i++)
+	{
+		int cell_x;
+		int cell_y;
+		int cell_z;
+		calculateCell(v_positions[i], cell_x, cell_y, cell_z);
+		mv_bucket_start[getBucket(cell_x, cell_y, cell_z) + 1]++;
+	}
+	for(unsigned int b = 1; b <= bucket_count; b++)
+		mv_bucket_start[b] += mv_bucket_start[b - 1];
+
+	for(unsigned int i = 0; i < point_count; i++)
+	{
+		int cell_x;
+		int cell_y;
+		int cell_z;
+		calculateCell(v_positions[i], cell_x, cell_y, cell_z);
+		unsigned int bucket = getBucket(cell_x, cell_y, cell_z);
+
+		Entry& entry = mv_entries[mv_bucket_start[bucket]];
+		entry.m_position = v_positions[i];
+		entry.m_cell_key = getCellKey(cell_x, cell_y, cell_z);
+		entry.m_index    = i;
+		mv_bucket_start[bucket]++;
+	}
+	for(unsigned int b = bucket_count; b > 0; b--)
+		mv_bucket_start[b] = mv_bucket_start[b - 1];
+	mv_bucket_start[0] = 0;
+
+	assert(mv_bucket_start[bucket_count] == point_count);
+	assert(isInvariantTrue());
+}
+
+
+
+unsigned long long SpatialHashGrid :: getCellKey (int cell_x,
+                                                  int cell_y,
+                                                  int cell_z) const
+{
+	return (unsigned long long)(cell_x) +
+	       (unsigned long long)(m_cell_count_x) *
+	       ((unsigned long long)(cell_y) +
+	        (unsigned long long)(m_cell_count_y) * (unsigned long long)(cell_z));
+}
+
+unsigned int SpatialHashGrid :: getBucket (int cell_x,
+                                           int cell_y,
+                                           int cell_z) const
+{
+	unsigned int hash = ((unsigned int)(cell_x) * HASH_PRIME_X) ^
+	                    ((unsigned int)(cell_y) * HASH_PRIME_Y) ^
+	                    ((unsigned int)(cell_z) * HASH_PRIME_Z);
+	return hash & m_bucket_mask;
+}
+
+void SpatialHashGrid :: calculateCell (const ObjLibrary::Vector3& position,
+                                       int& r_cell_x,
+                                       int& r_cell_y,
+                                       int& r_cell_z) const
+{
+	Vector3 local = (position - m_min) / m_cell_size;
+
+	r_cell_x = (local.x < 0.0) ? 0 : (int)(local.x);
+	r_cell_y = (local.y < 0.0) ? 0 : (int)(local.y);
+	r_cell_z = (local.z < 0.0) ? 0 : (int)(local.z);
+
+	if(r_cell_x >= m_cell_count_x) r_cell_x = m_cell_count_x - 1;
+	if(r_cell_y >= m_cell_count_y) r_cell_y = m_cell_count_y - 1;
+	if(r_cell_z >= m_cell_count_z) r_cell_z = m_cell_count_z - 1;
+}
+
+bool SpatialHashGrid :: isInvariantTrue () const
+{
+	if(!(m_cell_size > 0.0))
+		return false;
+	if(!mv_bucket_start.empty() && mv_bucket_start.size() != m_bucket_mask + 2)
+		return false;
+	return true;
+}
@@ -0,0 +1,220 @@
+//
+//  SpatialHashGrid.h
+//
+//  A module to find the nearest neighbours of points in 3D
+//    space using a uniform spatial hash grid.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "ObjLibrary/Vector3.h"
+
+
+
+//
+//  SpatialHashGrid
+//
+//  A class to find the nearest neighbours of a set of points.
+//    The points are bucketed into uniform cubic cells, and the
+//    cells are hashed into a table with about twice as many
+//    entries as there are points.  The grid is intended to be
+//    rebuilt every time the points move, which takes O(N) time.
+//    A k-nearest query then takes close to O(k) time for
+//    evenly-spaced points.
+//
+//  The cell size is chosen automatically when the grid is
+//    rebuilt so that each occupied cell contains a few points.
+//
+//  Class Invariant:
+//    <1> m_cell_size > 0.0
+//    <2> mv_bucket_start.size() == 0 ||
+//        mv_bucket_start.size() == m_bucket_mask + 2
+//
+class SpatialHashGrid
+{
+public:
+//
+//  MAX_NEAREST
+//
+//  The maximum number of neighbours that can be requested in a
+//    single query.
+//
+	static const unsigned int MAX_NEAREST = 16;
+
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To construct an empty SpatialHashGrid.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A SpatialHashGrid containing no points is
+//               constructed.
+//
+	SpatialHashGrid ();
+
+//
+//  getPointCount
+//
+//  Purpose: To determine the number of points in this
+//           SpatialHashGrid.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of points passed to the last call to
+//           rebuild.
+//  Side Effect: N/A
+//
+	unsigned int getPointCount () const;
+
+//
+//  getCellSize
+//
+//  Purpose: To determine the side length of the cells in this
+//           SpatialHashGrid.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The cell side length.  This value will always be
+//           positive.
+//  Side Effect: N/A
+//
+	double getCellSize () const;
+
+//
+//  findNearest
+//
+//  Purpose: To find the points nearest to the specified
+//           position.
+//  Parameter(s):
+//    <1> query: The position to search from
+//    <2> exclude: The index of a point to ignore, usually the
+//                 point at query
+//    <3> k: The maximum number of neighbours to find
+//    <4> a_nearest: An array to fill with point indexes
+//  Precondition(s):
+//    <1> k <= MAX_NEAREST
+//    <2> a_nearest has room for at least k elements
+//  Returns: The number of neighbours found.  This is k unless
+//           there are fewer than k points (not counting
+//           exclude) in this SpatialHashGrid.
+//  Side Effect: The first elements of a_nearest are set to the
+//               indexes of the points nearest to query, sorted
+//               from nearest to farthest.  Distances are full
+//               3D Euclidean distances.
+//
+	unsigned int findNearest (const ObjLibrary::Vector3& query,
+	                          unsigned int exclude,
+	                          unsigned int k,
+	                          unsigned int a_nearest[]) const;
+
+//
+//  rebuild
+//
+//  Purpose: To replace the points in this SpatialHashGrid.
+//  Parameter(s):
+//    <1> v_positions: The new points
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: This SpatialHashGrid is set to contain the
+//               points in v_positions.  Point indexes returned
+//               by queries are indexes into v_positions.  The
+//               cell size is recalculated from the bounding
+//               box of the points.  Memory from earlier builds
+//               is reused where possible.
+//
+	void rebuild (const std::vector<ObjLibrary::Vector3>& v_positions);
+
+private:
+//
+//  getCellKey
+//
+//  Purpose: To calculate the unique key for a cell.
+//  Parameter(s):
+//    <1> cell_x
+//    <2> cell_y
+//    <3> cell_z: The cell coordinates
+//  Precondition(s): N/A
+//  Returns: A key that is different for every cell inside the
+//           bounding box of the points.
+//  Side Effect: N/A
+//
+	unsigned long long getCellKey (int cell_x,
+	                               int cell_y,
+	                               int cell_z) const;
+
+//
+//  getBucket
+//
+//  Purpose: To calculate the hash table bucket for a cell.
+//  Parameter(s):
+//    <1> cell_x
+//    <2> cell_y
+//    <3> cell_z: The cell coordinates
+//  Precondition(s):
+//    <1> getPointCount() > 0
+//  Returns: The bucket for the cell.  This value will always be
+//           no greater than m_bucket_mask.
+//  Side Effect: N/A
+//
+	unsigned int getBucket (int cell_x,
+	                        int cell_y,
+	                        int cell_z) const;
+
+//
+//  calculateCell
+//
+//  Purpose: To calculate the cell containing a position.
+//  Parameter(s):
+//    <1> position: The position
+//    <2> r_cell_x
+//    <3> r_cell_y
+//    <4> r_cell_z: References to set to the cell coordinates
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: r_cell_x, r_cell_y, and r_cell_z are set to
+//               the coordinates of the cell containing
+//               position.  Positions outside the bounding box
+//               are clamped to the nearest cell inside it.
+//
+	void calculateCell (const ObjLibrary::Vector3& position,
+	                    int& r_cell_x,
+	                    int& r_cell_y,
+	                    int& r_cell_z) const;
+
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+private:
+	//
+	//  Entry
+	//
+	//  A record to represent a point stored in the grid.  The
+	//    cell key is stored so that points from different
+	//    cells that hash to the same bucket can be told apart.
+	//
+	struct Entry
+	{
+		ObjLibrary::Vector3 m_position;
+		unsigned long long m_cell_key;
+		unsigned int m_index;
+	};
+
+	double m_cell_size;
+	ObjLibrary::Vector3 m_min;
+	int m_cell_count_x;
+	int m_cell_count_y;
+	int m_cell_count_z;
+	unsigned int m_bucket_mask;
+	std::vector<unsigned int> mv_bucket_start;
+	std::vector<Entry> mv_entries;
+};
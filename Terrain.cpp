@@ -5,55 +5,46 @@
 #include "Terrain.h"
 
 #include <cassert>
+#include <algorithm>
 #include <string>
 
-#include "GetGlut.h"
-
 #include "ObjLibrary/Vector2.h"
 #include "ObjLibrary/Vector3.h"
-#include "ObjLibrary/ObjModel.h"
 #include "ObjLibrary/DisplayList.h"
 #include "ObjLibrary/TextureBmp.h"
-#include "ObjLibrary/TextureManager.h"
 
 #include "Heightmap.h"
+#include "HeightPyramid.h"
+#include "ImageCache.h"
+#include "ViewFrustum.h"
 
 using namespace std;
 using namespace ObjLibrary;
 namespace
 {
-	DisplayList plant_list;
+	// extent of algae.obj, which is drawn without scaling
+	const double PLANT_HALF_WIDTH = 1.0;
+	const double PLANT_HEIGHT     = 4.0;
 
-	const double NORMAL_LENGTH = 0.5;
+	// positions are converted to heightmap space in batches of
+	//  this size so the scratch arrays fit on the stack
+	const unsigned int BATCH_SIZE = 256;
 
 }  // end of anonymous namespace
 
 
 
-bool Terrain :: isPlantLoaded ()
-{
-	return plant_list.isReady();
-}
-
-void Terrain :: loadPlant (const std::string& resource_path)
-{
-	assert(!isPlantLoaded());
-
-	TextureManager::load(resource_path + "green_algae2.bmp",
-	                     GL_CLAMP, GL_CLAMP,
-	                     GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST,
-	                     Vector3(0.0, 0.0, 0.0));
-	plant_list = ObjModel(resource_path + "algae.obj").getDisplayList();
-
-	assert(isPlantLoaded());
-}
+const unsigned int Terrain :: PLANT_CHUNK_SIZE;
 
 
 
 Terrain :: Terrain ()
 		: m_offset(0.0, 0.0, 0.0),
-		  m_scale(1.0, 1.0, 1.0)
+		  m_scale(1.0, 1.0, 1.0),
+		  m_max_height(0.0)
 {
+	initTriangleNormals();
+
 	assert(!isReadyToDraw());
 	assert(isInvariantTrue());
 }
@@ -64,19 +55,18 @@ Terrain :: Terrain (const std::string& resource_path,
                     const std::string& above_water_texture,
                     const ObjLibrary::Vector3& offset,
                     const ObjLibrary::Vector3& size)
-		: m_heights_texture(resource_path + heights_texture)
+		: m_heights_texture(ImageCache::get(resource_path + heights_texture)),
+		  m_underwater_texture(resource_path + underwater_texture),
+		  m_above_water_texture(resource_path + above_water_texture)
 {
-	assert(isPlantLoaded());
 	assert(heights_texture != "");
 	assert(underwater_texture != "");
 	assert(above_water_texture != "");
 	assert(size.isAllComponentsPositive());
 
+	// the copy shares the height buffer and gets its own display list later
 	m_underwater = Heightmap(m_heights_texture);
-	m_underwater.initDisplayList(resource_path + underwater_texture, 0.0f, 0.0f, 15.0f, 15.0f);
-
 	m_above_water = m_underwater;
-	m_above_water.initDisplayList(resource_path + above_water_texture, 0.0f, 0.0f, 40.0f, 40.0f);
 
 	m_offset = offset;
 
@@ -84,10 +74,17 @@ Terrain :: Terrain (const std::string& resource_path,
 	m_scale.y = size.y;
 	m_scale.z = size.z / m_underwater.getSizeCellsZ();
 
-	initAllPlantsList();
-	initSurfaceNormalsList();
+	m_height_pyramid = HeightPyramid(m_underwater);
+
+	// getHeight returns 0.0 outside the heightmap
+	m_max_height = m_underwater.getMaxHeight() * m_scale.y + m_offset.y;
+	if(m_max_height < 0.0)
+		m_max_height = 0.0;
+
+	initTriangleNormals();
+	initPlantChunks();
 
-	assert(isReadyToDraw());
+	assert(!isReadyToDraw());
 	assert(isInvariantTrue());
 }
 
@@ -97,8 +94,8 @@ bool Terrain :: isReadyToDraw () const
 {
 	assert(isInvariantTrue());
 
-	assert(m_surface_normals_list.isReady() == m_all_plants_list.isReady());
-	return m_all_plants_list.isReady();
+	// a Terrain with no plants has no plant chunks
+	return m_surface_normals_list.isReady();
 }
 
 bool Terrain :: isInside (const ObjLibrary::Vector3& check_at) const
@@ -131,6 +128,83 @@ double Terrain :: getHeight (const ObjLibrary::Vector3& check_at) const
 		return 0.0;
 }
 
+double Terrain :: getMaxHeight () const
+{
+	assert(isInvariantTrue());
+
+	return m_max_height;
+}
+
+double Terrain :: getMaxHeight (const ObjLibrary::Vector3& corner1,
+                                const ObjLibrary::Vector3& corner2) const
+{
+	assert(isInvariantTrue());
+
+	Vector3 local1 = (corner1 - m_offset).getComponentRatio(m_scale);
+	Vector3 local2 = (corner2 - m_offset).getComponentRatio(m_scale);
+
+	float raw_max = m_height_pyramid.getMaxHeight((float)(local1.x), (float)(local1.z),
+	                                              (float)(local2.x), (float)(local2.z));
+	double max_height = raw_max * m_scale.y + m_offset.y;
+
+	// getHeight returns 0.0 outside the heightmap
+	double size_x = m_underwater.getSizeCellsX();
+	double size_z = m_underwater.getSizeCellsZ();
+	if(min(local1.x, local2.x) < 0.0 || max(local1.x, local2.x) > size_x ||
+	   min(local1.z, local2.z) < 0.0 || max(local1.z, local2.z) > size_z)
+	{
+		if(max_height < 0.0)
+			max_height = 0.0;
+	}
+	return max_height;
+}
+
+double Terrain :: getSegmentHit (const ObjLibrary::Vector3& start,
+                                 const ObjLibrary::Vector3& end,
+                                 double radius) const
+{
+	assert(isInvariantTrue());
+	assert(radius >= 0.0);
+
+	// isCollision compares the sphere center with the height
+	//  directly below it, so a sphere is the same as a lowered ray
+	Vector3 local_start = (start - m_offset).getComponentRatio(m_scale);
+	Vector3 local_end   = (end   - m_offset).getComponentRatio(m_scale);
+	double local_radius = radius / m_scale.y;
+	local_start.y -= local_radius;
+	local_end.y   -= local_radius;
+
+	float outside_height = (float)((0.0 - m_offset.y) / m_scale.y);
+	return m_height_pyramid.getSegmentHit(local_start, local_end, outside_height);
+}
+
+bool Terrain :: isSegmentClear (const ObjLibrary::Vector3& start,
+                                const ObjLibrary::Vector3& end,
+                                double radius) const
+{
+	assert(isInvariantTrue());
+	assert(radius >= 0.0);
+
+	return getSegmentHit(start, end, radius) == HeightPyramid::NO_HIT;
+}
+
+size_t Terrain :: getHeightBytes () const
+{
+	assert(isInvariantTrue());
+
+	size_t bytes = m_underwater.getHeightBytes();
+	if(!m_above_water.isSharingHeights(m_underwater))
+		bytes += m_above_water.getHeightBytes();
+	return bytes;
+}
+
+size_t Terrain :: getNormalCacheBytes () const
+{
+	assert(isInvariantTrue());
+
+	return mv_triangle_normals.capacity() * sizeof(PackedNormal);
+}
+
 ObjLibrary::Vector3 Terrain :: getSurfaceNormal (const ObjLibrary::Vector3& check_at) const
 {
 	assert(isInvariantTrue());
@@ -141,104 +215,251 @@ ObjLibrary::Vector3 Terrain :: getSurfaceNormal (const ObjLibrary::Vector3& chec
 	float float_x = (float)(local_pos.x);
 	float float_z = (float)(local_pos.z);
 	if(m_underwater.isInside(float_x, float_z))
-	{
-		Vector3 normal = m_underwater.getSurfaceNormal(float_x, float_z);
-		normal = normal.getComponentRatio(m_scale);
-		normal.normalize();
-		return normal;
-	}
+		return getTriangleNormal(m_underwater.getTriangleIndex(float_x, float_z));
 	else
 		return Vector3::UNIT_Y_PLUS;
 }
 
-void Terrain :: draw (bool is_underwater) const
+void Terrain :: getHeights (unsigned int count,
+                            const double* pa_x,
+                            const double* pa_z,
+                            double* pa_heights) const
+{
+	calculateHeights(count, pa_x, pa_z, pa_heights);
+}
+
+void Terrain :: getHeights (unsigned int count,
+                            const float* pa_x,
+                            const float* pa_z,
+                            float* pa_heights) const
+{
+	calculateHeights(count, pa_x, pa_z, pa_heights);
+}
+
+void Terrain :: getSurfaceNormals (unsigned int count,
+                                   const double* pa_x,
+                                   const double* pa_z,
+                                   double* pa_normal_x,
+                                   double* pa_normal_y,
+                                   double* pa_normal_z) const
+{
+	calculateSurfaceNormals(count, pa_x, pa_z, pa_normal_x, pa_normal_y, pa_normal_z);
+}
+
+void Terrain :: getSurfaceNormals (unsigned int count,
+                                   const float* pa_x,
+                                   const float* pa_z,
+                                   float* pa_normal_x,
+                                   float* pa_normal_y,
+                                   float* pa_normal_z) const
+{
+	calculateSurfaceNormals(count, pa_x, pa_z, pa_normal_x, pa_normal_y, pa_normal_z);
+}
+
+unsigned int Terrain :: getPlantChunkCount () const
 {
 	assert(isInvariantTrue());
-	assert(isReadyToDraw());
 
-	glPushMatrix();
-		glTranslated(m_offset.x, m_offset.y, m_offset.z);
-		glScaled(m_scale.x, m_scale.y, m_scale.z);
-		m_underwater.draw();
-	glPopMatrix();
+	return mv_plant_chunks.size();
+}
 
-	if(!is_underwater)
-	{
-		glDisable(GL_FOG);
-		glPushMatrix();
-			glTranslated(m_offset.x, m_offset.y * 1.1, m_offset.z);
-			glScaled(m_scale.x, m_scale.y * 1.1, m_scale.z);
-			m_above_water.draw();
-		glPopMatrix();
-		glEnable(GL_FOG);
-	}
+const Vector3& Terrain :: getPlantChunkBoxMin (unsigned int chunk) const
+{
+	assert(isInvariantTrue());
+	assert(chunk < getPlantChunkCount());
+
+	return mv_plant_chunks[chunk].m_box_min;
+}
+
+const Vector3& Terrain :: getPlantChunkBoxMax (unsigned int chunk) const
+{
+	assert(isInvariantTrue());
+	assert(chunk < getPlantChunkCount());
 
-	m_all_plants_list.draw();
+	return mv_plant_chunks[chunk].m_box_max;
 }
 
-void Terrain :: drawSurfaceNormals () const
+void Terrain :: findVisiblePlantChunks (const ViewFrustum& frustum,
+                                        std::vector<unsigned int>& r_chunks) const
 {
 	assert(isInvariantTrue());
-	assert(isReadyToDraw());
 
-	m_surface_normals_list.draw();
+	r_chunks.clear();
+	for(unsigned int i = 0; i < mv_plant_chunks.size(); i++)
+		if(frustum.isBoxVisible(mv_plant_chunks[i].m_box_min, mv_plant_chunks[i].m_box_max))
+			r_chunks.push_back(i);
+}
+
+void Terrain :: initPlantChunks ()
+{
+	unsigned int size_x = m_underwater.getSizeCellsX();
+	unsigned int size_z = m_underwater.getSizeCellsZ();
+
+	mv_plant_chunks.clear();
+	for(unsigned int chunk_x = 0; chunk_x < size_x; chunk_x += PLANT_CHUNK_SIZE)
+		for(unsigned int chunk_z = 0; chunk_z < size_z; chunk_z += PLANT_CHUNK_SIZE)
+		{
+			vector<Vector3> v_positions;
+			getPlantPositions(chunk_x, chunk_z, v_positions);
+			if(v_positions.empty())
+				continue;
+
+			PlantChunk chunk;
+			chunk.m_cell_x  = chunk_x;
+			chunk.m_cell_z  = chunk_z;
+			chunk.m_box_min = v_positions[0];
+			chunk.m_box_max = v_positions[0];
+			for(unsigned int i = 0; i < v_positions.size(); i++)
+			{
+				const Vector3& position = v_positions[i];
+				chunk.m_box_min = Vector3(min(chunk.m_box_min.x, position.x),
+				                          min(chunk.m_box_min.y, position.y),
+				                          min(chunk.m_box_min.z, position.z));
+				chunk.m_box_max = Vector3(max(chunk.m_box_max.x, position.x),
+				                          max(chunk.m_box_max.y, position.y),
+				                          max(chunk.m_box_max.z, position.z));
+			}
+
+			// the plant model stands on its origin
+			chunk.m_box_min -= Vector3(PLANT_HALF_WIDTH, 0.0,          PLANT_HALF_WIDTH);
+			chunk.m_box_max += Vector3(PLANT_HALF_WIDTH, PLANT_HEIGHT, PLANT_HALF_WIDTH);
+			mv_plant_chunks.push_back(chunk);
+		}
 }
 
+void Terrain :: getPlantPositions (unsigned int chunk_x,
+                                   unsigned int chunk_z,
+                                   std::vector<ObjLibrary::Vector3>& rv_positions) const
+{
+	unsigned int end_x = min(chunk_x + PLANT_CHUNK_SIZE, m_underwater.getSizeCellsX());
+	unsigned int end_z = min(chunk_z + PLANT_CHUNK_SIZE, m_underwater.getSizeCellsZ());
+
+	rv_positions.clear();
+	for(unsigned int x = chunk_x; x < end_x; x++)
+		for(unsigned int z = chunk_z; z < end_z; z++)
+			if(m_heights_texture.getGreen(x, z) >= 64)
+			{
+				double y = m_underwater.getHeight(x, z);
+				rv_positions.push_back(m_offset + Vector3(x, y, z).getComponentProduct(m_scale));
+			}
+}
 
+void Terrain :: initTriangleNormals ()
+{
+	unsigned int size_x = m_underwater.getSizeCellsX();
+	unsigned int size_z = m_underwater.getSizeCellsZ();
+
+	mv_triangle_normals.resize(m_underwater.getTriangleCount());
+	for(unsigned int x = 0; x < size_x; x++)
+		for(unsigned int z = 0; z < size_z; z++)
+			for(unsigned int t = 0; t < 2; t++)
+			{
+				Vector3 sample = getTriangleSamplePoint(x, z, t);
+				unsigned int index = m_underwater.getTriangleIndex((float)(sample.x), (float)(sample.z));
+				assert(index == (x * size_z + z) * 2 + t);
+
+				// same rescaling as getSurfaceNormal used to do per call
+				Vector3 normal = m_underwater.getSurfaceNormal((float)(sample.x), (float)(sample.z));
+				normal = normal.getComponentRatio(m_scale);
+				normal.normalize();
+
+				mv_triangle_normals[index].x = (float)(normal.x);
+				mv_triangle_normals[index].y = (float)(normal.y);
+				mv_triangle_normals[index].z = (float)(normal.z);
+			}
+}
 
-void Terrain :: initAllPlantsList ()
+Vector3 Terrain :: getTriangleSamplePoint (unsigned int x,
+                                           unsigned int z,
+                                           unsigned int triangle) const
 {
-	assert(isPlantLoaded());
+	assert(triangle < 2);
 
-	m_all_plants_list.begin();
-		for(unsigned int x = 0; x < m_underwater.getSizeCellsX(); x++)
-			for(unsigned int z = 0; z < m_underwater.getSizeCellsZ(); z++)
-				if(m_heights_texture.getGreen(x, z) >= 64)
-				{
-					double y = m_underwater.getHeight(x, z);
-					Vector3 position = m_offset + Vector3(x, y, z).getComponentProduct(m_scale);
-					glPushMatrix();
-						glTranslated(position.x, position.y, position.z);
-						plant_list.draw();
-					glPopMatrix();
-				}
-	m_all_plants_list.end();
+	if(triangle == 0)
+		return Vector3(x + 0.75, 0.0, z + 0.25);  // pink
+	else
+		return Vector3(x + 0.25, 0.0, z + 0.75);  // green
 }
 
-void Terrain :: initSurfaceNormalsList ()
+Vector3 Terrain :: getTriangleNormal (unsigned int index) const
 {
-	m_surface_normals_list.begin();
-		glColor3ub(255, 255, 0);  // yellow
-		glBegin(GL_LINES);
-			for(float x = 0.25f; x < m_underwater.getSizeCellsX(); x += 0.5f)
-				for(float z = 0.25f; z < m_underwater.getSizeCellsZ(); z += 0.5f)
-				{
-					float x_frac = fmod(x, 1.0f);
-					float z_frac = fmod(z, 1.0f);
-					if(fabs(x_frac - z_frac) < 0.0001f)
-						continue;
+	assert(index < mv_triangle_normals.size());
 
-					float y = m_underwater.getHeight(x, z);
+	const PackedNormal& normal = mv_triangle_normals[index];
+	return Vector3(normal.x, normal.y, normal.z);
+}
 
-					Vector3 pos(x, y, z);
-					pos = pos.getComponentProduct(m_scale);
-					pos += m_offset;
-					glVertex3d(pos.x, pos.y, pos.z);
+template <typename T>
+void Terrain :: calculateHeights (unsigned int count,
+                                  const T* pa_x,
+                                  const T* pa_z,
+                                  T* pa_heights) const
+{
+	assert(isInvariantTrue());
 
-					Vector3 dir = m_underwater.getSurfaceNormal(x, z);
-					dir = dir.getComponentRatioSafe(m_scale);
-					dir.normalize();
-					Vector3 end = pos + dir * 0.5;
-					glVertex3d(end.x, end.y, end.z);
-				}
-		glEnd();
-	m_surface_normals_list.end();
+	float a_local_x[BATCH_SIZE];
+	float a_local_z[BATCH_SIZE];
+	float a_raw_heights[BATCH_SIZE];
+
+	for(unsigned int begin = 0; begin < count; begin += BATCH_SIZE)
+	{
+		unsigned int batch_count = min(count - begin, BATCH_SIZE);
+
+		// same conversion as getHeight
+		for(unsigned int i = 0; i < batch_count; i++)
+		{
+			a_local_x[i] = (float)((pa_x[begin + i] - m_offset.x) / m_scale.x);
+			a_local_z[i] = (float)((pa_z[begin + i] - m_offset.z) / m_scale.z);
+		}
+
+		m_underwater.getHeights(batch_count, a_local_x, a_local_z, a_raw_heights);
+
+		for(unsigned int i = 0; i < batch_count; i++)
+		{
+			if(m_underwater.isInside(a_local_x[i], a_local_z[i]))
+				pa_heights[begin + i] = (T)(a_raw_heights[i] * m_scale.y + m_offset.y);
+			else
+				pa_heights[begin + i] = (T)(0.0);
+		}
+	}
+}
+
+template <typename T>
+void Terrain :: calculateSurfaceNormals (unsigned int count,
+                                         const T* pa_x,
+                                         const T* pa_z,
+                                         T* pa_normal_x,
+                                         T* pa_normal_y,
+                                         T* pa_normal_z) const
+{
+	assert(isInvariantTrue());
+
+	for(unsigned int i = 0; i < count; i++)
+	{
+		float local_x = (float)((pa_x[i] - m_offset.x) / m_scale.x);
+		float local_z = (float)((pa_z[i] - m_offset.z) / m_scale.z);
+		if(m_underwater.isInside(local_x, local_z))
+		{
+			const PackedNormal& normal = mv_triangle_normals[m_underwater.getTriangleIndex(local_x, local_z)];
+			pa_normal_x[i] = (T)(normal.x);
+			pa_normal_y[i] = (T)(normal.y);
+			pa_normal_z[i] = (T)(normal.z);
+		}
+		else
+		{
+			pa_normal_x[i] = (T)(0.0);
+			pa_normal_y[i] = (T)(1.0);
+			pa_normal_z[i] = (T)(0.0);
+		}
+	}
 }
 
 bool Terrain :: isInvariantTrue () const
 {
 	if(!m_scale.isAllComponentsPositive())
 		return false;
+	if(mv_triangle_normals.size() != m_underwater.getTriangleCount())
+		return false;
 	return true;
 }
 
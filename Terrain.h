@@ -6,14 +6,18 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 #include "ObjLibrary/Vector3.h"
 #include "ObjLibrary/TextureBmp.h"
 #include "ObjLibrary/DisplayList.h"
 
 #include "Heightmap.h"
+#include "HeightPyramid.h"
 
+class ViewFrustum;
 
 
 //
@@ -23,12 +27,34 @@
 //    includes both above water and underwater.  This class
 //    handles offsets and scaling.
 //
+//  The surface normal of every heightmap triangle, already
+//    adjusted for the scaling, is calculated when the Terrain is
+//    created, so getSurfaceNormal is a table lookup.
+//
+//  The plants are grouped into square chunks of heightmap
+//    cells, each with its own display list and bounding box, so
+//    that only the chunks inside the view need to be drawn.
+//    Chunks without any plants are not stored.
+//
+//  The functions that use display lists are in
+//    TerrainDraw.cpp, so a Terrain can be created and queried
+//    without OpenGL.
+//
 //  Class Invariant:
 //    <1> m_scale.isAllComponentsPositive()
+//    <2> mv_triangle_normals.size() ==
+//                               m_underwater.getTriangleCount()
 //
 class Terrain
 {
 public:
+//
+//  PLANT_CHUNK_SIZE
+//
+//  The width of a plant chunk, in heightmap cells.
+//
+	static const unsigned int PLANT_CHUNK_SIZE = 8;
+
 //
 //  isPlantLoaded
 //
@@ -41,6 +67,22 @@ public:
 //
 	static bool isPlantLoaded ();
 
+//
+//  addPlantAssets
+//
+//  Purpose: To add the files for the plant OBJ model to the
+//           AssetLoader, so they can be loaded in advance.
+//  Parameter(s):
+//    <1> resource_path: The file path to prepend to the
+//                       filenames
+//  Precondition(s):
+//    <1> !AssetLoader::isCpuLoaded()
+//  Returns: N/A
+//  Side Effect: The files loadPlant uses are added to the
+//               AssetLoader.
+//
+	static void addPlantAssets (const std::string& resource_path);
+
 //
 //  loadPlant
 //
@@ -90,14 +132,16 @@ public:
 //    <6> size: The XYZ dimensions of the heightmap when
 //              displayed
 //  Precondition(s):
-//    <1> isPlantLoaded()
-//    <2> heights_texture != ""
-//    <3> underwater_texture != ""
-//    <4> above_water_texture != ""
-//    <5> size.isAllComponentsPositive()
+//    <1> heights_texture != ""
+//    <2> underwater_texture != ""
+//    <3> above_water_texture != ""
+//    <4> size.isAllComponentsPositive()
 //  Returns: N/A
 //  Side Effect: A Terrain is created based on heights_texture.
-//               It can be displayed.
+//               Only its heights, surface normals, and plant
+//               chunk boxes are set up, and no OpenGL functions
+//               are called.  It cannot be displayed until
+//               initDisplayLists is called.
 //
 	Terrain (const std::string& resource_path,
 	         const std::string& heights_texture,
@@ -119,6 +163,23 @@ public:
 //
 	bool isReadyToDraw () const;
 
+//
+//  initDisplayLists
+//
+//  Purpose: To create the display lists needed to display this
+//           Terrain.
+//  Parameter(s): N/A
+//  Precondition(s):
+//    <1> isPlantLoaded()
+//    <2> !isReadyToDraw()
+//    <3> This Terrain was created from an image file
+//  Returns: N/A
+//  Side Effect: The display lists for the heightmaps, the plant
+//               chunks, and the surface normals are created.
+//               This Terrain can now be displayed.
+//
+	void initDisplayLists ();
+
 //
 //  isInside
 //
@@ -150,6 +211,104 @@ public:
 	double getHeight (
 	                 const ObjLibrary::Vector3& check_at) const;
 
+//
+//  getMaxHeight
+//
+//  Purpose: To determine the greatest height of this Terrain.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: A value that getHeight never exceeds for any
+//           position, including positions outside this
+//           Terrain.
+//  Side Effect: N/A
+//
+	double getMaxHeight () const;
+
+//
+//  getMaxHeight
+//
+//  Purpose: To determine the greatest height of this Terrain
+//           over a horizontal region.
+//  Parameter(s):
+//    <1> corner1
+//    <2> corner2: Opposite corners of the region; the Y
+//                 components are ignored
+//  Precondition(s): N/A
+//  Returns: A value that getHeight does not exceed anywhere in
+//           the region.  It is exact when the region lines up
+//           with the heightmap cells.
+//  Side Effect: N/A
+//
+	double getMaxHeight (const ObjLibrary::Vector3& corner1,
+	                     const ObjLibrary::Vector3& corner2) const;
+
+//
+//  getSegmentHit
+//
+//  Purpose: To determine where a sphere moving along a line
+//           segment first collides with this Terrain.
+//  Parameter(s):
+//    <1> start
+//    <2> end: The path of the sphere center
+//    <3> radius: The sphere radius, or 0.0 for a ray
+//  Precondition(s):
+//    <1> radius >= 0.0
+//  Returns: The fraction of the way from start to end at which
+//           the sphere first collides with this Terrain, in the
+//           same sense as isCollision, or HeightPyramid::NO_HIT
+//           if it never does.  This takes O(log n) time for a
+//           path that stays well above the terrain.
+//  Side Effect: N/A
+//
+	double getSegmentHit (const ObjLibrary::Vector3& start,
+	                      const ObjLibrary::Vector3& end,
+	                      double radius) const;
+
+//
+//  isSegmentClear
+//
+//  Purpose: To determine whether a sphere can move along a line
+//           segment without colliding with this Terrain.
+//  Parameter(s):
+//    <1> start
+//    <2> end: The path of the sphere center
+//    <3> radius: The sphere radius, or 0.0 for a ray
+//  Precondition(s):
+//    <1> radius >= 0.0
+//  Returns: Whether getSegmentHit(start, end, radius) is
+//           HeightPyramid::NO_HIT.
+//  Side Effect: N/A
+//
+	bool isSegmentClear (const ObjLibrary::Vector3& start,
+	                     const ObjLibrary::Vector3& end,
+	                     double radius) const;
+
+//
+//  getHeightBytes
+//
+//  Purpose: To determine how much memory is used to store the
+//           heights for this Terrain.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The size of the height buffers in bytes.  A buffer
+//           shared by the underwater and above-water heightmaps
+//           is only counted once.
+//  Side Effect: N/A
+//
+	size_t getHeightBytes () const;
+
+//
+//  getNormalCacheBytes
+//
+//  Purpose: To determine how much memory is used to store the
+//           precalculated surface normals for this Terrain.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The size of the surface normal table in bytes.
+//  Side Effect: N/A
+//
+	size_t getNormalCacheBytes () const;
+
 //
 //  getSurfaceNormal
 //
@@ -167,6 +326,114 @@ public:
 	ObjLibrary::Vector3 getSurfaceNormal (
 	                 const ObjLibrary::Vector3& check_at) const;
 
+//
+//  getHeights
+//
+//  Purpose: To determine the height of this Terrain at many
+//           horizontal positions at once.
+//  Parameter(s):
+//    <1> count: The number of positions
+//    <2> pa_x
+//    <3> pa_z: Arrays of the X and Z components of the
+//              positions to test
+//    <4> pa_heights: An array to fill with the heights
+//  Precondition(s):
+//    <1> pa_x, pa_z, and pa_heights each have at least count
+//        elements
+//  Returns: N/A
+//  Side Effect: Element i of pa_heights is set to
+//               getHeight(Vector3(pa_x[i], 0.0, pa_z[i])).  The
+//               heightmap lookups are done several positions at
+//               a time with SIMD instructions where available.
+//
+	void getHeights (unsigned int count,
+	                 const double* pa_x,
+	                 const double* pa_z,
+	                 double* pa_heights) const;
+	void getHeights (unsigned int count,
+	                 const float* pa_x,
+	                 const float* pa_z,
+	                 float* pa_heights) const;
+
+//
+//  getSurfaceNormals
+//
+//  Purpose: To determine the surface normal of this Terrain at
+//           many horizontal positions at once.
+//  Parameter(s):
+//    <1> count: The number of positions
+//    <2> pa_x
+//    <3> pa_z: Arrays of the X and Z components of the
+//              positions to test
+//    <4> pa_normal_x
+//    <5> pa_normal_y
+//    <6> pa_normal_z: Arrays to fill with the components of
+//                     the surface normals
+//  Precondition(s):
+//    <1> Each array has at least count elements
+//  Returns: N/A
+//  Side Effect: Element i of the normal arrays is set to the
+//               components of
+//               getSurfaceNormal(Vector3(pa_x[i], 0.0, pa_z[i])).
+//
+	void getSurfaceNormals (unsigned int count,
+	                        const double* pa_x,
+	                        const double* pa_z,
+	                        double* pa_normal_x,
+	                        double* pa_normal_y,
+	                        double* pa_normal_z) const;
+	void getSurfaceNormals (unsigned int count,
+	                        const float* pa_x,
+	                        const float* pa_z,
+	                        float* pa_normal_x,
+	                        float* pa_normal_y,
+	                        float* pa_normal_z) const;
+
+//
+//  getPlantChunkCount
+//
+//  Purpose: To determine how many plant chunks this Terrain
+//           has.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: The number of chunks containing at least one plant.
+//  Side Effect: N/A
+//
+	unsigned int getPlantChunkCount () const;
+
+//
+//  getPlantChunkBoxMin
+//  getPlantChunkBoxMax
+//
+//  Purpose: To determine the bounding box of a plant chunk.
+//  Parameter(s):
+//    <1> chunk: The index of the chunk
+//  Precondition(s):
+//    <1> chunk < getPlantChunkCount()
+//  Returns: The minimum or maximum corner of the box, in world
+//           coordinates.  The box contains every plant in the
+//           chunk.
+//  Side Effect: N/A
+//
+	const ObjLibrary::Vector3& getPlantChunkBoxMin (unsigned int chunk) const;
+	const ObjLibrary::Vector3& getPlantChunkBoxMax (unsigned int chunk) const;
+
+//
+//  findVisiblePlantChunks
+//
+//  Purpose: To find the plant chunks that may be visible.
+//  Parameter(s):
+//    <1> frustum: The volume that can be seen
+//    <2> r_chunks: A vector to fill with the chunk indexes
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: r_chunks is cleared and then filled with the
+//               index of every plant chunk whose bounding box
+//               is not outside frustum, in increasing order.
+//
+	void findVisiblePlantChunks (const ViewFrustum& frustum,
+	                             std::vector<unsigned int>& r_chunks) const;
+
 //
 //  draw
 //
@@ -183,6 +450,29 @@ public:
 //
 	void draw (bool is_underwater) const;
 
+//
+//  draw
+//
+//  Purpose: To display this Terrain with only some of the
+//           plants.
+//  Parameter(s):
+//    <1> is_underwater: Whether the camera is underwater
+//    <2> plant_chunks: The indexes of the plant chunks to
+//                      display
+//  Precondition(s):
+//    <1> isReadyToDraw()
+//    <2> Every element of plant_chunks is less than
+//        getPlantChunkCount()
+//  Returns: N/A
+//  Side Effect: The underwater portion of this Terrain is
+//               displayed.  The plants in the specified chunks
+//               are displayed.  If is_underwater == false, the
+//               above-water portion of this Terrain is also
+//               displayed.
+//
+	void draw (bool is_underwater,
+	           const std::vector<unsigned int>& plant_chunks) const;
+
 //
 //  draw
 //
@@ -199,17 +489,82 @@ public:
 
 private:
 //
-//  initAllPlantsList
+//  drawHeightmaps
 //
-//  Purpose: To initialize the combined display list for all the
-//           plants on this Terrain.
+//  Purpose: To display the heightmaps for this Terrain.
+//  Parameter(s):
+//    <1> is_underwater: Whether the camera is underwater
+//  Precondition(s):
+//    <1> isReadyToDraw()
+//  Returns: N/A
+//  Side Effect: The underwater portion of this Terrain is
+//               displayed.  If is_underwater == false, the
+//               above-water portion is also displayed.
+//
+	void drawHeightmaps (bool is_underwater) const;
+
+//
+//  initPlantChunks
+//
+//  Purpose: To initialize the bounding boxes for the plant
+//           chunks on this Terrain.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: mv_plant_chunks is filled with one element for
+//               each chunk that contains plants.  The display
+//               lists are left empty.
+//
+	void initPlantChunks ();
+
+//
+//  initPlantChunkLists
+//
+//  Purpose: To initialize the display lists for the plant
+//           chunks on this Terrain.
 //  Parameter(s): N/A
 //  Precondition(s):
 //    <1> isPlantLoaded()
+//    <2> initPlantChunks has been called
 //  Returns: N/A
-//  Side Effect: The plants display list is initialized.
+//  Side Effect: The display list for each element of
+//               mv_plant_chunks is initialized with one plant
+//               for each of its plant positions.
 //
-	void initAllPlantsList ();
+	void initPlantChunkLists ();
+
+//
+//  getPlantPositions
+//
+//  Purpose: To determine where the plants in one plant chunk
+//           are.
+//  Parameter(s):
+//    <1> chunk_x
+//    <2> chunk_z: The first heightmap cell in the chunk
+//    <3> rv_positions: A vector to fill with the positions
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: rv_positions is cleared and then filled with the
+//               position of each plant in the chunk, in world
+//               coordinates.
+//
+	void getPlantPositions (unsigned int chunk_x,
+	                        unsigned int chunk_z,
+	                        std::vector<ObjLibrary::Vector3>& rv_positions) const;
+
+//
+//  initTriangleNormals
+//
+//  Purpose: To calculate the surface normal for every
+//           heightmap triangle.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: mv_triangle_normals is filled with the
+//               normalized surface normal of each triangle in
+//               m_underwater after the scaling by m_scale.
+//
+	void initTriangleNormals ();
 
 //
 //  initSurfaceNormalsList
@@ -217,13 +572,73 @@ private:
 //  Purpose: To initialize the display list for the surface
 //           normals for this Terrain.
 //  Parameter(s): N/A
-//  Precondition(s): N/A
+//  Precondition(s):
+//    <1> initTriangleNormals has been called
 //  Returns: N/A
 //  Side Effect: The surface normals display list is
-//               initialized.
+//               initialized with one line per triangle, read
+//               from mv_triangle_normals.
 //
 	void initSurfaceNormalsList ();
 
+//
+//  getTriangleSamplePoint
+//
+//  Purpose: To determine a point inside one heightmap triangle.
+//  Parameter(s):
+//    <1> x
+//    <2> z: The heightmap cell
+//    <3> triangle: Which triangle in the cell, 0 for the pink
+//                  triangle or 1 for the green one
+//  Precondition(s):
+//    <1> triangle < 2
+//  Returns: A point in heightmap coordinates that is well
+//           inside the triangle.  The Y component is 0.0.
+//  Side Effect: N/A
+//
+	ObjLibrary::Vector3 getTriangleSamplePoint (unsigned int x,
+	                                            unsigned int z,
+	                                            unsigned int triangle) const;
+
+//
+//  getTriangleNormal
+//
+//  Purpose: To retrieve the precalculated surface normal for
+//           a heightmap triangle.
+//  Parameter(s):
+//    <1> index: The triangle index, as returned by
+//               Heightmap::getTriangleIndex
+//  Precondition(s):
+//    <1> index < mv_triangle_normals.size()
+//  Returns: The surface normal, in world space.
+//  Side Effect: N/A
+//
+	ObjLibrary::Vector3 getTriangleNormal (unsigned int index) const;
+
+//
+//  calculateHeights
+//  calculateSurfaceNormals
+//
+//  Purpose: To implement getHeights and getSurfaceNormals for
+//           positions of type T.
+//  Parameter(s): See getHeights and getSurfaceNormals
+//  Precondition(s): See getHeights and getSurfaceNormals
+//  Returns: N/A
+//  Side Effect: See getHeights and getSurfaceNormals.
+//
+	template <typename T>
+	void calculateHeights (unsigned int count,
+	                       const T* pa_x,
+	                       const T* pa_z,
+	                       T* pa_heights) const;
+	template <typename T>
+	void calculateSurfaceNormals (unsigned int count,
+	                              const T* pa_x,
+	                              const T* pa_z,
+	                              T* pa_normal_x,
+	                              T* pa_normal_y,
+	                              T* pa_normal_z) const;
+
 //
 //  isInvariantTrue
 //
@@ -235,13 +650,48 @@ private:
 //
 	bool isInvariantTrue () const;
 
+private:
+//
+//  PackedNormal
+//
+//  A record to store a unit vector in 12 bytes.
+//
+	struct PackedNormal
+	{
+		float x;
+		float y;
+		float z;
+	};
+
+//
+//  PlantChunk
+//
+//  A record to store the plants in one square of heightmap
+//    cells, with a box in world coordinates that contains them.
+//    The first cell is kept so the display list can be created
+//    later.
+//
+	struct PlantChunk
+	{
+		unsigned int m_cell_x;
+		unsigned int m_cell_z;
+		ObjLibrary::Vector3 m_box_min;
+		ObjLibrary::Vector3 m_box_max;
+		ObjLibrary::DisplayList m_list;
+	};
+
 private:
 	ObjLibrary::TextureBmp m_heights_texture;
+	std::string m_underwater_texture;
+	std::string m_above_water_texture;
 	Heightmap m_underwater;
 	Heightmap m_above_water;
 	ObjLibrary::Vector3 m_offset;
 	ObjLibrary::Vector3 m_scale;
-	ObjLibrary::DisplayList m_all_plants_list;
+	double m_max_height;
+	HeightPyramid m_height_pyramid;
+	std::vector<PackedNormal> mv_triangle_normals;
+	std::vector<PlantChunk> mv_plant_chunks;
 	ObjLibrary::DisplayList m_surface_normals_list;
 };
 
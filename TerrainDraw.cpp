@@ -0,0 +1,193 @@
+//
+//  TerrainDraw.cpp
+//
+//  The Terrain functions that use display lists.
+//
+
+#include "Terrain.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "GetGlut.h"
+
+#include "ObjLibrary/Vector3.h"
+#include "ObjLibrary/DisplayList.h"
+#include "ObjLibrary/TextureManager.h"
+
+#include "AssetLoader.h"
+#include "Heightmap.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	DisplayList plant_list;
+
+	const double NORMAL_LENGTH = 0.5;
+
+}  // end of anonymous namespace
+
+
+
+bool Terrain :: isPlantLoaded ()
+{
+	return plant_list.isReady();
+}
+
+void Terrain :: addPlantAssets (const std::string& resource_path)
+{
+	assert(!AssetLoader::isCpuLoaded());
+
+	AssetLoader::addTexture(resource_path + "green_algae2.bmp",
+	                        GL_CLAMP, GL_CLAMP,
+	                        GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST,
+	                        Vector3(0.0, 0.0, 0.0));
+	AssetLoader::addModel(resource_path + "algae.obj");
+}
+
+void Terrain :: loadPlant (const std::string& resource_path)
+{
+	assert(!isPlantLoaded());
+
+	// the AssetLoader may have uploaded the texture already
+	if(!TextureManager::isLoaded(resource_path + "green_algae2.bmp"))
+	{
+		TextureManager::load(resource_path + "green_algae2.bmp",
+		                     GL_CLAMP, GL_CLAMP,
+		                     GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST,
+		                     Vector3(0.0, 0.0, 0.0));
+	}
+	AssetLoader::getModel(resource_path + "algae.obj", plant_list);
+
+	assert(isPlantLoaded());
+}
+
+
+
+void Terrain :: initDisplayLists ()
+{
+	assert(isInvariantTrue());
+	assert(isPlantLoaded());
+	assert(!isReadyToDraw());
+	assert(m_underwater_texture != "");
+	assert(m_above_water_texture != "");
+
+	m_underwater.initDisplayList(m_underwater_texture, 0.0f, 0.0f, 15.0f, 15.0f);
+	m_above_water.initDisplayList(m_above_water_texture, 0.0f, 0.0f, 40.0f, 40.0f);
+	initPlantChunkLists();
+	initSurfaceNormalsList();
+
+	assert(isReadyToDraw());
+	assert(isInvariantTrue());
+}
+
+void Terrain :: draw (bool is_underwater) const
+{
+	assert(isInvariantTrue());
+	assert(isReadyToDraw());
+
+	drawHeightmaps(is_underwater);
+
+	for(unsigned int i = 0; i < mv_plant_chunks.size(); i++)
+		mv_plant_chunks[i].m_list.draw();
+}
+
+void Terrain :: draw (bool is_underwater,
+                      const std::vector<unsigned int>& plant_chunks) const
+{
+	assert(isInvariantTrue());
+	assert(isReadyToDraw());
+
+	drawHeightmaps(is_underwater);
+
+	for(unsigned int i = 0; i < plant_chunks.size(); i++)
+	{
+		assert(plant_chunks[i] < getPlantChunkCount());
+		mv_plant_chunks[plant_chunks[i]].m_list.draw();
+	}
+}
+
+void Terrain :: drawSurfaceNormals () const
+{
+	assert(isInvariantTrue());
+	assert(isReadyToDraw());
+
+	m_surface_normals_list.draw();
+}
+
+
+
+void Terrain :: drawHeightmaps (bool is_underwater) const
+{
+	assert(isReadyToDraw());
+
+	glPushMatrix();
+		glTranslated(m_offset.x, m_offset.y, m_offset.z);
+		glScaled(m_scale.x, m_scale.y, m_scale.z);
+		m_underwater.draw();
+	glPopMatrix();
+
+	if(!is_underwater)
+	{
+		glDisable(GL_FOG);
+		glPushMatrix();
+			glTranslated(m_offset.x, m_offset.y * 1.1, m_offset.z);
+			glScaled(m_scale.x, m_scale.y * 1.1, m_scale.z);
+			m_above_water.draw();
+		glPopMatrix();
+		glEnable(GL_FOG);
+	}
+}
+
+void Terrain :: initPlantChunkLists ()
+{
+	assert(isPlantLoaded());
+
+	vector<Vector3> v_positions;
+	for(unsigned int c = 0; c < mv_plant_chunks.size(); c++)
+	{
+		PlantChunk& r_chunk = mv_plant_chunks[c];
+		getPlantPositions(r_chunk.m_cell_x, r_chunk.m_cell_z, v_positions);
+		assert(!v_positions.empty());
+
+		r_chunk.m_list.begin();
+			for(unsigned int i = 0; i < v_positions.size(); i++)
+			{
+				const Vector3& position = v_positions[i];
+				glPushMatrix();
+					glTranslated(position.x, position.y, position.z);
+					plant_list.draw();
+				glPopMatrix();
+			}
+		r_chunk.m_list.end();
+	}
+}
+
+void Terrain :: initSurfaceNormalsList ()
+{
+	assert(mv_triangle_normals.size() == m_underwater.getTriangleCount());
+
+	m_surface_normals_list.begin();
+		glColor3ub(255, 255, 0);  // yellow
+		glBegin(GL_LINES);
+			for(unsigned int x = 0; x < m_underwater.getSizeCellsX(); x++)
+				for(unsigned int z = 0; z < m_underwater.getSizeCellsZ(); z++)
+					for(unsigned int t = 0; t < 2; t++)
+					{
+						Vector3 sample = getTriangleSamplePoint(x, z, t);
+						float y = m_underwater.getHeight((float)(sample.x), (float)(sample.z));
+
+						Vector3 pos(sample.x, y, sample.z);
+						pos = pos.getComponentProduct(m_scale);
+						pos += m_offset;
+						glVertex3d(pos.x, pos.y, pos.z);
+
+						unsigned int index = m_underwater.getTriangleIndex((float)(sample.x), (float)(sample.z));
+						Vector3 end = pos + getTriangleNormal(index) * NORMAL_LENGTH;
+						glVertex3d(end.x, end.y, end.z);
+					}
+		glEnd();
+	m_surface_normals_list.end();
+}
@@ -0,0 +1,178 @@
+//
+//  TestCompiledMesh.cpp
+//
+//  Tests for building a CompiledMesh from an ObjModel.  These
+//    do not draw anything, so no OpenGL context is needed.
+//
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "../ObjLibrary/Vector3.h"
+#include "../ObjLibrary/ObjModel.h"
+#include "../ObjLibrary/CompiledMesh.h"
+
+#include "TestHarness.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	//
+	//  getPosition
+	//
+	//  Purpose: To retrieve the position of the vertex used by
+	//           an index of a CompiledMesh.
+	//  Parameter(s):
+	//    <1> mesh: The CompiledMesh
+	//    <2> index: Which index
+	//  Precondition(s):
+	//    <1> index < mesh.getIndexCount()
+	//  Returns: The position.
+	//  Side Effect: N/A
+	//
+	Vector3 getPosition (const CompiledMesh& mesh,
+	                     unsigned int index)
+	{
+		assert(index < mesh.getIndexCount());
+
+		unsigned int vertex = mesh.getIndex(index);
+		assert(vertex < mesh.getVertexCount());
+		const float* a_vertex = mesh.getVertexData() + vertex * CompiledMesh::FLOATS_PER_VERTEX +
+		                        CompiledMesh::POSITION_OFFSET;
+		return Vector3(a_vertex[0], a_vertex[1], a_vertex[2]);
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(CompiledMesh_sharesVertexesAndSplitsMaterials)
+{
+	//
+	//  Two squares side by side in the XY plane:
+	//
+	//    3---4---5
+	//    | R | B |
+	//    0---1---2
+	//
+	//  The red one is a quad.  The blue one is two triangles,
+	//    the second with the normal flipped, so its corners are
+	//    not the same vertexes as the first one's.  A third mesh
+	//    has no faces.
+	//
+
+	ObjModel model;
+	for(unsigned int y = 0; y < 2; y++)
+		for(unsigned int x = 0; x < 3; x++)
+		{
+			model.addVertex(x, y, 0.0);
+			model.addTextureCoordinate(x * 0.5, y);
+		}
+	unsigned int front = model.addNormal(0.0, 0.0,  1.0);
+	unsigned int back  = model.addNormal(0.0, 0.0, -1.0);
+
+	unsigned int red = model.addMesh();
+	model.setMeshMaterial(red, "red");
+	unsigned int quad = model.addFace(red);
+	model.addFaceVertex(red, quad, 0, 0, front);
+	model.addFaceVertex(red, quad, 1, 1, front);
+	model.addFaceVertex(red, quad, 4, 4, front);
+	model.addFaceVertex(red, quad, 3, 3, front);
+
+	unsigned int blue = model.addMesh();
+	model.setMeshMaterial(blue, "blue");
+	unsigned int lower = model.addFace(blue);
+	model.addFaceVertex(blue, lower, 1, 1, front);  // shared with red
+	model.addFaceVertex(blue, lower, 2, 2, front);
+	model.addFaceVertex(blue, lower, 5, 5, front);
+	unsigned int upper = model.addFace(blue);
+	model.addFaceVertex(blue, upper, 1, 1, back);
+	model.addFaceVertex(blue, upper, 5, 5, back);
+	model.addFaceVertex(blue, upper, 4, 4, back);
+
+	unsigned int empty = model.addMesh();
+	model.setMeshMaterial(empty, "unused");
+	model.validate(false);
+
+	CompiledMesh mesh = model.getCompiledMesh();
+	UWSIM_CHECK(mesh.isFinished());
+
+	// red 4, blue 2 more from the first triangle and 3 from the second
+	UWSIM_CHECK(mesh.getVertexCount() == 9);
+	UWSIM_CHECK(mesh.getIndexCount() == 12);
+	UWSIM_CHECK(mesh.isIndex16Bit());
+
+	UWSIM_CHECK(mesh.getRangeCount() == 2);
+	if(mesh.getRangeCount() == 2)
+	{
+		UWSIM_CHECK(mesh.getRangeMaterialName(0) == "red");
+		UWSIM_CHECK(mesh.getRangeFirstIndex(0) == 0);
+		UWSIM_CHECK(mesh.getRangeIndexCount(0) == 6);
+		UWSIM_CHECK(mesh.getRangeMaterialName(1) == "blue");
+		UWSIM_CHECK(mesh.getRangeFirstIndex(1) == 6);
+		UWSIM_CHECK(mesh.getRangeIndexCount(1) == 6);
+	}
+
+	// the quad is a fan around its first corner
+	if(mesh.getIndexCount() == 12)
+	{
+		UWSIM_CHECK(getPosition(mesh, 0) == Vector3(0.0, 0.0, 0.0));
+		UWSIM_CHECK(getPosition(mesh, 1) == Vector3(1.0, 0.0, 0.0));
+		UWSIM_CHECK(getPosition(mesh, 2) == Vector3(1.0, 1.0, 0.0));
+		UWSIM_CHECK(getPosition(mesh, 3) == Vector3(0.0, 0.0, 0.0));
+		UWSIM_CHECK(getPosition(mesh, 4) == Vector3(1.0, 1.0, 0.0));
+		UWSIM_CHECK(getPosition(mesh, 5) == Vector3(0.0, 1.0, 0.0));
+
+		// the same corner with the same normal is the same vertex
+		UWSIM_CHECK(mesh.getIndex(6) == mesh.getIndex(1));
+		UWSIM_CHECK(mesh.getIndex(9) != mesh.getIndex(1));
+		UWSIM_CHECK(getPosition(mesh, 9) == getPosition(mesh, 1));
+		UWSIM_CHECK(mesh.getIndex(11) != mesh.getIndex(2));
+		UWSIM_CHECK(getPosition(mesh, 11) == getPosition(mesh, 2));
+	}
+
+	// texture coordinates are flipped vertically, as in draw()
+	const float* a_vertex = mesh.getVertexData() + mesh.getIndex(5) * CompiledMesh::FLOATS_PER_VERTEX;
+	UWSIM_CHECK(a_vertex[CompiledMesh::TEXTURE_COORDINATE_OFFSET + 0] == 0.0f);
+	UWSIM_CHECK(a_vertex[CompiledMesh::TEXTURE_COORDINATE_OFFSET + 1] == 0.0f);
+	UWSIM_CHECK(a_vertex[CompiledMesh::NORMAL_OFFSET + 2] == 1.0f);
+}
+
+UWSIM_TEST(CompiledMesh_coversShippedModel)
+{
+	ObjModel model("Resources/treasure_chest.obj");
+	UWSIM_CHECK(model.isLoadedSuccessfully());
+
+	unsigned int expected_index_count = 0;
+	for(unsigned int m = 0; m < model.getMeshCount(); m++)
+		for(unsigned int f = 0; f < model.getFaceCount(m); f++)
+			if(model.getFaceVertexCount(m, f) >= 3)
+				expected_index_count += (model.getFaceVertexCount(m, f) - 2) * 3;
+
+	CompiledMesh mesh = model.getCompiledMesh();
+	UWSIM_CHECK(mesh.getIndexCount() == expected_index_count);
+	UWSIM_CHECK(mesh.getVertexCount() > 0);
+	UWSIM_CHECK(mesh.getVertexCount() <= mesh.getIndexCount());
+	UWSIM_CHECK(mesh.getRangeCount() > 0);
+	UWSIM_CHECK(mesh.getRangeCount() <= model.getMeshCount());
+
+	// the ranges are in order and cover every index once
+	unsigned int next_index = 0;
+	for(unsigned int r = 0; r < mesh.getRangeCount(); r++)
+	{
+		UWSIM_CHECK(mesh.getRangeFirstIndex(r) == next_index);
+		UWSIM_CHECK(mesh.getRangeIndexCount(r) > 0);
+		UWSIM_CHECK(mesh.getRangeIndexCount(r) % 3 == 0);
+		next_index = mesh.getRangeFirstIndex(r) + mesh.getRangeIndexCount(r);
+	}
+	UWSIM_CHECK(next_index == mesh.getIndexCount());
+
+	unsigned int bad_index_count = 0;
+	for(unsigned int i = 0; i < mesh.getIndexCount(); i++)
+		if(mesh.getIndex(i) >= mesh.getVertexCount())
+			bad_index_count++;
+	UWSIM_CHECK(bad_index_count == 0);
+}
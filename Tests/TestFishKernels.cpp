@@ -0,0 +1,446 @@
+//
+//  TestFishKernels.cpp
+//
+//  Tests that the SIMD and one-fish-at-a-time versions of the
+//    FishKernels functions give the same results, and that they
+//    match the formulas FishSchool::AIUpdateForFish used for one
+//    Fish at a time before the kernels.  The instance matrices
+//    are checked against the transformations a Fish applies
+//    when it is drawn, calculated without OpenGL.
+//
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "../ObjLibrary/Vector3.h"
+
+#include "../RandomStream.h"
+#include "../CoordinateSystem.h"
+#include "../Fish.h"
+#include "../FishArrays.h"
+#include "../FishKernels.h"
+#include "TestHarness.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	// not a multiple of any SIMD width, so the leftover fish are tested too
+	const unsigned int FISH_COUNT = 1003;
+
+	const float DELTA_TIME = 1.0f / 60.0f;
+
+	// the instruction sets round differently, e.g. in a reciprocal
+	const double TOLERANCE = (sizeof(FishScalar) == sizeof(float)) ? 1.0e-4 : 1.0e-9;
+
+	//
+	//  createFish
+	//
+	//  Purpose: To create fish in a variety of states.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: FISH_COUNT fish spread through a box that crosses
+	//           the water surface.  Some are not moving, and
+	//           some have unused neighbour slots.
+	//  Side Effect: N/A
+	//
+	FishArrays createFish ()
+	{
+		RandomStream random(3, FISH_COUNT);
+		FishArrays fish;
+		fish.reserve(FISH_COUNT);
+		for(unsigned int i = 0; i < FISH_COUNT; i++)
+		{
+			Vector3 position(random.getDouble() * 8.0 - 4.0,
+			                 random.getDouble() * 8.0 - 6.0,
+			                 random.getDouble() * 8.0 - 4.0);
+			Vector3 velocity(random.getDouble() * 4.0 - 2.0,
+			                 random.getDouble() * 4.0 - 2.0,
+			                 random.getDouble() * 4.0 - 2.0);
+			if(i % 7 == 0)
+				velocity = Vector3::ZERO;
+			Vector3 forward = Vector3(random.getDouble() - 0.5,
+			                          random.getDouble() - 0.5,
+			                          random.getDouble() - 0.5).getNormalizedSafe();
+			if(forward.isZero())
+				forward = Vector3(1.0, 0.0, 0.0);
+			fish.add(position, velocity, forward);
+		}
+		fish.storePrevious();
+
+		for(unsigned int i = 0; i < FISH_COUNT; i++)
+			for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+			{
+				unsigned int neighbour = (unsigned int)(random.getDouble() * FISH_COUNT) % FISH_COUNT;
+				if(neighbour == i || (i % 5 == 0 && n >= 2))
+					neighbour = Fish::NO_NEIGHBOUR;
+				fish.mv_neighbours[i * Fish::NEIGHBOUR_COUNT + n] = neighbour;
+			}
+		return fish;
+	}
+
+	//
+	//  checkNear
+	//
+	//  Purpose: To check that two arrays hold the same values
+	//           except for rounding.
+	//  Parameter(s):
+	//    <1> v_actual: The values calculated with SIMD
+	//    <2> v_expected: The values calculated without SIMD
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: A failure is reported if the sizes differ or
+	//               any pair of values differs by more than
+	//               TOLERANCE.
+	//
+	template <typename Scalar>
+	void checkNear (const vector<Scalar>& v_actual,
+	                const vector<Scalar>& v_expected)
+	{
+		UWSIM_CHECK(v_actual.size() == v_expected.size());
+		double largest_difference = 0.0;
+		for(unsigned int i = 0; i < v_actual.size() && i < v_expected.size(); i++)
+		{
+			double difference = (double)(v_actual[i]) - (double)(v_expected[i]);
+			if(difference < 0.0)
+				difference = -difference;
+			if(!(difference <= largest_difference))
+				largest_difference = difference;
+		}
+		UWSIM_CHECK_NEAR(largest_difference, 0.0, TOLERANCE);
+	}
+
+	//
+	//  checkFishNear
+	//
+	//  Purpose: To check that two sets of fish are in the same
+	//           state except for rounding.
+	//  Parameter(s):
+	//    <1> actual: The fish updated with SIMD
+	//    <2> expected: The fish updated without SIMD
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: A failure is reported for each array that
+	//               does not match.
+	//
+	void checkFishNear (const FishArrays& actual,
+	                    const FishArrays& expected)
+	{
+		checkNear(actual.mv_position_x, expected.mv_position_x);
+		checkNear(actual.mv_position_y, expected.mv_position_y);
+		checkNear(actual.mv_position_z, expected.mv_position_z);
+		checkNear(actual.mv_velocity_x, expected.mv_velocity_x);
+		checkNear(actual.mv_velocity_y, expected.mv_velocity_y);
+		checkNear(actual.mv_velocity_z, expected.mv_velocity_z);
+		checkNear(actual.mv_forward_x,  expected.mv_forward_x);
+		checkNear(actual.mv_forward_y,  expected.mv_forward_y);
+		checkNear(actual.mv_forward_z,  expected.mv_forward_z);
+	}
+
+	//
+	//  runWithAndWithoutSimd
+	//
+	//  Purpose: To run a kernel on the same fish with SIMD
+	//           enabled and disabled.
+	//  Parameter(s):
+	//    <1> r_with_simd: The fish to update with SIMD
+	//    <2> r_without_simd: The fish to update without SIMD
+	//    <3> kernel: The kernel to run, which takes the fish to
+	//                update
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: r_with_simd and r_without_simd are updated.
+	//               SIMD is left enabled if it is compiled in.
+	//
+	template <typename Kernel>
+	void runWithAndWithoutSimd (FishArrays& r_with_simd,
+	                            FishArrays& r_without_simd,
+	                            Kernel kernel)
+	{
+		FishKernels::setSimdEnabled(true);
+		kernel(r_with_simd);
+		FishKernels::setSimdEnabled(false);
+		UWSIM_CHECK(!FishKernels::isSimdEnabled());
+		kernel(r_without_simd);
+		FishKernels::setSimdEnabled(true);
+	}
+
+	//
+	//  checkVectorNear
+	//
+	//  Purpose: To check that a vector has the expected value
+	//           except for rounding.
+	//  Parameter(s):
+	//    <1> actual: The calculated vector
+	//    <2> expected: The expected vector
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: A failure is reported for each component
+	//               that differs by more than TOLERANCE.
+	//
+	void checkVectorNear (const Vector3& actual,
+	                      const Vector3& expected)
+	{
+		UWSIM_CHECK_NEAR(actual.x, expected.x, TOLERANCE);
+		UWSIM_CHECK_NEAR(actual.y, expected.y, TOLERANCE);
+		UWSIM_CHECK_NEAR(actual.z, expected.z, TOLERANCE);
+	}
+
+	//
+	//  multiplyMatrices
+	//
+	//  Purpose: To multiply two 4x4 matrices the way OpenGL
+	//           does when one is applied after the other.
+	//  Parameter(s):
+	//    <1> a_left: The matrix already current
+	//    <2> a_right: The matrix being applied
+	//    <3> a_result: The array to write the product to
+	//  Precondition(s):
+	//    <1> a_result is not a_left or a_right
+	//  Returns: N/A
+	//  Side Effect: a_left * a_right is written to a_result.
+	//               All the matrices are column-major.
+	//
+	void multiplyMatrices (const double a_left[16],
+	                       const double a_right[16],
+	                       double a_result[16])
+	{
+		assert(a_result != a_left);
+		assert(a_result != a_right);
+
+		for(unsigned int c = 0; c < 4; c++)
+			for(unsigned int r = 0; r < 4; r++)
+			{
+				a_result[c * 4 + r] = 0.0;
+				for(unsigned int k = 0; k < 4; k++)
+					a_result[c * 4 + r] += a_left[k * 4 + r] * a_right[c * 4 + k];
+			}
+	}
+
+	//
+	//  calculateDrawMatrix
+	//
+	//  Purpose: To calculate the matrix a fish is drawn with.
+	//  Parameter(s):
+	//    <1> position: The position of the fish
+	//    <2> forward: The forward vector of the fish
+	//    <3> scale: The size to draw the fish at
+	//    <4> a_matrix: The array to write the matrix to
+	//  Precondition(s):
+	//    <1> !forward.isZero()
+	//  Returns: N/A
+	//  Side Effect: The column-major matrix that
+	//               CoordinateSystem::applyDrawTransformations
+	//               followed by glScaled(scale, scale, scale)
+	//               would multiply onto an identity matrix is
+	//               written to a_matrix.  The forward vector is
+	//               normalized first, as by FishSchool::getFish.
+	//
+	void calculateDrawMatrix (const Vector3& position,
+	                          const Vector3& forward,
+	                          double scale,
+	                          double a_matrix[16])
+	{
+		assert(!forward.isZero());
+
+		CoordinateSystem coords(position, forward.getNormalized());
+
+		// glTranslated
+		double a_translate[16] = { 1.0, 0.0, 0.0, 0.0,
+		                           0.0, 1.0, 0.0, 0.0,
+		                           0.0, 0.0, 1.0, 0.0,
+		                           position.x, position.y, position.z, 1.0 };
+		// glMultMatrixd
+		double a_orientation[16];
+		coords.calculateOrientationMatrix(a_orientation);
+		// glScaled
+		double a_scale[16] = { scale, 0.0,   0.0,   0.0,
+		                       0.0,   scale, 0.0,   0.0,
+		                       0.0,   0.0,   scale, 0.0,
+		                       0.0,   0.0,   0.0,   1.0 };
+
+		double a_rotated[16];
+		multiplyMatrices(a_translate, a_orientation, a_rotated);
+		multiplyMatrices(a_rotated, a_scale, a_matrix);
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(FishKernels_steerAllMatchesWithoutSimd)
+{
+	FishArrays with_simd    = createFish();
+	FishArrays without_simd = with_simd;
+	runWithAndWithoutSimd(with_simd, without_simd, [] (FishArrays& r_fish)
+	{
+		FishKernels::steerAll(r_fish, Vector3(1.0, -2.0, 0.5), 3.0, 1.5, 0.5, 1.0, DELTA_TIME);
+	});
+	checkFishNear(with_simd, without_simd);
+}
+
+UWSIM_TEST(FishKernels_applyGravityAllMatchesWithoutSimd)
+{
+	FishArrays with_simd    = createFish();
+	FishArrays without_simd = with_simd;
+	runWithAndWithoutSimd(with_simd, without_simd, [] (FishArrays& r_fish)
+	{
+		FishKernels::applyGravityAll(r_fish, DELTA_TIME);
+	});
+	checkFishNear(with_simd, without_simd);
+}
+
+UWSIM_TEST(FishKernels_moveAllByVelocityMatchesWithoutSimd)
+{
+	FishArrays with_simd    = createFish();
+	FishArrays without_simd = with_simd;
+	runWithAndWithoutSimd(with_simd, without_simd, [] (FishArrays& r_fish)
+	{
+		FishKernels::moveAllByVelocity(r_fish, DELTA_TIME);
+	});
+	checkFishNear(with_simd, without_simd);
+}
+
+UWSIM_TEST(FishKernels_updateForwardAllMatchesWithoutSimd)
+{
+	FishArrays with_simd    = createFish();
+	FishArrays without_simd = with_simd;
+	runWithAndWithoutSimd(with_simd, without_simd, [] (FishArrays& r_fish)
+	{
+		FishKernels::updateForwardAll(r_fish);
+	});
+	checkFishNear(with_simd, without_simd);
+}
+
+UWSIM_TEST(FishKernels_packInstanceMatricesAllMatchesWithoutSimd)
+{
+	const float ALPHAS[] = { 0.0f, 0.5f, 1.0f };
+
+	FishArrays fish = createFish();
+
+	// move the fish so the previous and current states differ
+	FishKernels::moveAllByVelocity(fish, DELTA_TIME);
+	FishKernels::updateForwardAll(fish);
+
+	for(float alpha : ALPHAS)
+	{
+		vector<float> v_with_simd   (FISH_COUNT * FishKernels::MATRIX_SIZE);
+		vector<float> v_without_simd(FISH_COUNT * FishKernels::MATRIX_SIZE);
+		FishKernels::setSimdEnabled(true);
+		FishKernels::packInstanceMatricesAll(fish, 0.25, alpha, v_with_simd.data());
+		FishKernels::setSimdEnabled(false);
+		FishKernels::packInstanceMatricesAll(fish, 0.25, alpha, v_without_simd.data());
+		FishKernels::setSimdEnabled(true);
+
+		// the matrices are floats even when the fish are doubles
+		double largest_difference = 0.0;
+		for(unsigned int i = 0; i < v_with_simd.size(); i++)
+		{
+			double difference = v_with_simd[i] - v_without_simd[i];
+			if(difference < 0.0)
+				difference = -difference;
+			if(!(difference <= largest_difference))
+				largest_difference = difference;
+		}
+		UWSIM_CHECK_NEAR(largest_difference, 0.0, 1.0e-5);
+	}
+}
+
+UWSIM_TEST(FishKernels_steerAllAndMoveAllByVelocityMatchOldFormulas)
+{
+	// enough fish at the target for a full block of the widest lanes
+	const unsigned int IDLE_COUNT = 16;
+	const float DELTA_TIME_HALF = 0.5f;
+	const unsigned int N = Fish::NEIGHBOUR_COUNT;
+
+	for(bool is_simd : { true, false })
+	{
+		FishArrays fish;
+		fish.add(Vector3(1.0, 0.0, 0.0), Vector3(0.0, 1.0, 0.0),  Vector3(1.0, 0.0, 0.0));
+		fish.add(Vector3(1.0, 0.0, 0.5), Vector3(-0.5, 0.0, 0.0), Vector3(1.0, 0.0, 0.0));
+		fish.add(Vector3(0.0, 6.0, 8.0), Vector3(0.0, 1.8, 2.4),  Vector3(1.0, 0.0, 0.0));
+		for(unsigned int i = 0; i < IDLE_COUNT; i++)
+			fish.add(Vector3::ZERO, Vector3::ZERO, Vector3(1.0, 0.0, 0.0));
+		for(unsigned int i = 0; i < fish.getCount() * N; i++)
+			fish.mv_neighbours[i] = Fish::NO_NEIGHBOUR;
+		fish.mv_neighbours[0 * N + 0] = 1;
+		fish.mv_neighbours[0 * N + 2] = 2;     // too far away
+		fish.mv_neighbours[1 * N + 0] = 0;
+		fish.mv_neighbours[1 * N + 1] = 1000;  // not a fish
+		fish.mv_neighbours[2 * N + 3] = 0;     // too far away
+
+		// target (0, 0, 0), max speed 2, max change 2 * 0.5,
+		//  separation falls to 0 at 1, neighbours past 0.8 ignored
+		FishKernels::setSimdEnabled(is_simd);
+		FishKernels::steerAll(fish, Vector3::ZERO, 2.0, 2.0, 1.0, 0.8, DELTA_TIME_HALF);
+		FishKernels::moveAllByVelocity(fish, DELTA_TIME_HALF);
+		FishKernels::setSimdEnabled(true);
+
+		// fish 0: seek (-1, 0, 0); neighbour 1 is 0.5 away at
+		//  offset (0, 0, -0.5), so closeness 0.5 and separation
+		//  (0, 0, -0.5) * 0.5^2 * 2 = (0, 0, -0.25); desired
+		//  (-1, 0, 0) + 3 * (0, 0, -0.25) = (-1, 0, -0.75);
+		//  change from (0, 1, 0) has norm 1.6 > 1, so truncated
+		double change_norm = sqrt(1.0 + 1.0 + 0.75 * 0.75);
+		Vector3 velocity_0 = Vector3(0.0, 1.0, 0.0) +
+		                     Vector3(-1.0, -1.0, -0.75) / change_norm;
+		checkVectorNear(fish.getVelocity(0), velocity_0);
+		checkVectorNear(fish.getPosition(0), Vector3(1.0, 0.0, 0.0) + velocity_0 * 0.5);
+
+		// fish 1: seek (-1, 0, -0.5); separation from fish 0 is
+		//  (0, 0, 0.25); desired (-1, 0, 0.25) is reached from
+		//  (-0.5, 0, 0)
+		checkVectorNear(fish.getVelocity(1), Vector3(-1.0, 0.0, 0.25));
+		checkVectorNear(fish.getPosition(1), Vector3(0.5, 0.0, 0.625));
+
+		// fish 2: seek (0, -6, -8) truncated to (0, -1.2, -1.6);
+		//  change (0, -3, -4) truncated to (0, -0.6, -0.8)
+		checkVectorNear(fish.getVelocity(2), Vector3(0.0, 1.2, 1.6));
+		checkVectorNear(fish.getPosition(2), Vector3(0.0, 6.6, 8.8));
+
+		// the idle fish are at the target already
+		for(unsigned int i = 3; i < fish.getCount(); i++)
+		{
+			checkVectorNear(fish.getVelocity(i), Vector3::ZERO);
+			checkVectorNear(fish.getPosition(i), Vector3::ZERO);
+		}
+	}
+}
+
+UWSIM_TEST(FishKernels_packInstanceMatricesAllMatchesDrawTransformations)
+{
+	const Vector3 A_POSITIONS[] = { Vector3( 1.0,  2.0,  3.0), Vector3(-4.0, 0.5, 2.0),
+	                                Vector3( 0.0, -1.0,  0.0), Vector3( 2.0, 2.0, 2.0),
+	                                Vector3(-1.0, -3.0, -5.0) };
+	const Vector3 A_FORWARDS[]  = { Vector3( 1.0,  0.0,  0.0), Vector3( 0.0, 0.0, -2.0),
+	                                Vector3( 1.0,  1.0,  1.0), Vector3( 0.0, 3.0, 0.0),
+	                                Vector3( 0.0, -1.0,  0.0) };
+	const unsigned int CASE_COUNT = sizeof(A_POSITIONS) / sizeof(A_POSITIONS[0]);
+	// enough copies for a full block of the widest lanes
+	const unsigned int COPY_COUNT = 4;
+	const double SCALE = 0.25;
+
+	FishArrays fish;
+	for(unsigned int c = 0; c < COPY_COUNT; c++)
+		for(unsigned int i = 0; i < CASE_COUNT; i++)
+			fish.add(A_POSITIONS[i], Vector3::ZERO, A_FORWARDS[i].getNormalized());
+	fish.storePrevious();
+
+	for(bool is_simd : { true, false })
+	{
+		vector<float> v_matrices(fish.getCount() * FishKernels::MATRIX_SIZE);
+		FishKernels::setSimdEnabled(is_simd);
+		FishKernels::packInstanceMatricesAll(fish, SCALE, 1.0f, v_matrices.data());
+		FishKernels::setSimdEnabled(true);
+
+		for(unsigned int f = 0; f < fish.getCount(); f++)
+		{
+			double a_expected[16];
+			calculateDrawMatrix(A_POSITIONS[f % CASE_COUNT], A_FORWARDS[f % CASE_COUNT], SCALE, a_expected);
+			for(unsigned int e = 0; e < 16; e++)
+				UWSIM_CHECK_NEAR(v_matrices[f * FishKernels::MATRIX_SIZE + e], a_expected[e], 1.0e-5);
+		}
+	}
+}
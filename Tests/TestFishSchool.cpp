@@ -0,0 +1,191 @@
+//
+//  TestFishSchool.cpp
+//
+//  Tests for the nearest neighbour search in FishSchool, and
+//    for finding fish by id after others are caught.
+//
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+#include "../ObjLibrary/Vector3.h"
+
+#include "../RandomStream.h"
+#include "../Entity.h"
+#include "../Fish.h"
+#include "../FishSchool.h"
+#include "TestHarness.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const float TICK_DELTA_TIME = 1.0f / 60.0f;
+
+	//
+	//  getNeighbourDistances
+	//
+	//  Purpose: To determine how far each fish in a school is
+	//           from its neighbours.
+	//  Parameter(s):
+	//    <1> school: The school
+	//  Precondition(s): N/A
+	//  Returns: The squared distances to the neighbours of each
+	//           fish, Fish::NEIGHBOUR_COUNT values per fish.  The
+	//           values for each fish are sorted, and an unused
+	//           slot is -1.0.  Two fish at the same distance can
+	//           be chosen in either order, so the distances are
+	//           compared instead of the indexes.
+	//  Side Effect: N/A
+	//
+	vector<double> getNeighbourDistances (const FishSchool& school)
+	{
+		vector<double> v_distances;
+		for(unsigned int i = 0; i < school.getCount(); i++)
+		{
+			Fish fish = school.getFish(i);
+			vector<double> v_fish_distances;
+			for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+			{
+				unsigned int neighbour = fish.fishNeighbour[n];
+				if(neighbour == Fish::NO_NEIGHBOUR)
+					v_fish_distances.push_back(-1.0);
+				else
+				{
+					assert(neighbour < school.getCount());
+					UWSIM_CHECK(neighbour != i);
+					Vector3 other = school.getFish(neighbour).getPosition();
+					v_fish_distances.push_back(fish.getPosition().getDistanceSquared(other));
+				}
+			}
+			sort(v_fish_distances.begin(), v_fish_distances.end());
+			v_distances.insert(v_distances.end(), v_fish_distances.begin(), v_fish_distances.end());
+		}
+		return v_distances;
+	}
+
+	//
+	//  checkGridMatchesBruteForce
+	//
+	//  Purpose: To check that the grid and brute force searches
+	//           find the same neighbours for a school.
+	//  Parameter(s):
+	//    <1> r_school: The school
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: The neighbours of r_school are recalculated.
+	//               A failure is reported for each fish with a
+	//               different set of neighbour distances.
+	//
+	void checkGridMatchesBruteForce (FishSchool& r_school)
+	{
+		r_school.calculateNearestNeighbourBruteForce();
+		vector<double> v_expected = getNeighbourDistances(r_school);
+		r_school.calculateNearestNeighbour();
+		vector<double> v_actual = getNeighbourDistances(r_school);
+
+		UWSIM_CHECK(v_actual.size() == v_expected.size());
+		unsigned int mismatch_count = 0;
+		for(unsigned int i = 0; i < v_actual.size() && i < v_expected.size(); i++)
+			if(v_actual[i] != v_expected[i])
+				mismatch_count++;
+		UWSIM_CHECK(mismatch_count == 0);
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(FishSchool_gridNeighboursMatchBruteForce)
+{
+	const unsigned int FISH_COUNTS[] = { 0, 1, 2, 4, 5, 17, 100, 1000 };
+	const double       RADII[]       = { 0.1, 0.8, 4.0, 20.0 };
+	const unsigned int SEED_COUNT    = 3;
+
+	unsigned int species = Fish::getSpeciesForFilename("anchovy.obj");
+	assert(species < Fish::SPECIES_COUNT);
+
+	for(unsigned int fish_count : FISH_COUNTS)
+		for(double radius : RADII)
+			for(unsigned int seed = 0; seed < SEED_COUNT; seed++)
+			{
+				FishSchool school(Vector3(-32.0, -2.0, 1.0), radius, fish_count, species,
+				                  5.0, RandomStream(seed + 1, fish_count));
+				school.updateAggregates();
+				checkGridMatchesBruteForce(school);
+			}
+}
+
+UWSIM_TEST(FishSchool_gridNeighboursMatchBruteForceAfterSwimming)
+{
+	// the fish bunch up after they swim, unlike the starting sphere
+	const unsigned int FISH_COUNT  = 500;
+	const unsigned int TICK_COUNT  = 120;
+	const unsigned int CHECK_EVERY = 30;
+
+	unsigned int species = Fish::getSpeciesForFilename("anchovy.obj");
+	assert(species < Fish::SPECIES_COUNT);
+
+	FishSchool school(Vector3(-32.0, -2.0, 1.0), 2.0, FISH_COUNT, species,
+	                  5.0, RandomStream(7, FISH_COUNT));
+	school.updateAggregates();
+	school.calculateNearestNeighbour();
+	for(unsigned int t = 1; t <= TICK_COUNT; t++)
+	{
+		school.AIUpdateFlockLeader(TICK_DELTA_TIME);
+		school.AIUpdateFishSchool(TICK_DELTA_TIME);
+		school.moveAllByVelocity(TICK_DELTA_TIME);
+		school.updateOrientationAll();
+		school.updateAggregates();
+		school.calculateNearestNeighbour();
+		if(t % CHECK_EVERY == 0)
+			checkGridMatchesBruteForce(school);
+	}
+}
+
+UWSIM_TEST(FishSchool_fishIdsSurviveCatching)
+{
+	const unsigned int FISH_COUNT = 200;
+
+	unsigned int species = Fish::getSpeciesForFilename("anchovy.obj");
+	assert(species < Fish::SPECIES_COUNT);
+
+	FishSchool school(Vector3(-32.0, -2.0, 1.0), 2.0, FISH_COUNT, species,
+	                  5.0, RandomStream(3, FISH_COUNT));
+	school.updateAggregates();
+
+	vector<Vector3> v_positions(FISH_COUNT);
+	for(unsigned int i = 0; i < FISH_COUNT; i++)
+	{
+		unsigned int fish_id = school.getFishId(i);
+		assert(fish_id < FISH_COUNT);
+		UWSIM_CHECK(school.findFish(fish_id) == i);
+		v_positions[fish_id] = school.getFish(i).getPosition();
+	}
+
+	// catch the first fish and any close to it, which moves others
+	unsigned int first_id = school.getFishId(0);
+	Entity player(school.getFish(0).getPosition(), 0.5);
+	unsigned int caught_count = school.checkPlayerCaughtFish(player);
+	UWSIM_CHECK(caught_count > 0);
+	UWSIM_CHECK(school.getCount() == FISH_COUNT - caught_count);
+	UWSIM_CHECK(school.findFish(first_id) == FishArrays::NO_FISH);
+
+	// every fish left is still found by its id, at its own position
+	unsigned int missing_count = 0;
+	for(unsigned int fish_id = 0; fish_id < FISH_COUNT; fish_id++)
+	{
+		unsigned int index = school.findFish(fish_id);
+		if(index == FishArrays::NO_FISH)
+			missing_count++;
+		else
+		{
+			UWSIM_CHECK(index < school.getCount());
+			UWSIM_CHECK(school.getFishId(index) == fish_id);
+			UWSIM_CHECK(school.getFish(index).getPosition() == v_positions[fish_id]);
+		}
+	}
+	UWSIM_CHECK(missing_count == caught_count);
+}
@@ -0,0 +1,130 @@
+//
+//  TestHarness.h
+//
+//  A minimal test registry for uwsim-tests.
+//
+//  Each test is a function declared with UWSIM_TEST in one of
+//    the Test*.cpp files, and it is registered before main
+//    runs.  A test passes if none of its checks fail.  A check
+//    that fails is reported with its file and line, and the
+//    test keeps running, so one run shows every failure.
+//
+//  The tests do not call any OpenGL functions, so they can run
+//    on a machine without a display or GPU.
+//
+
+#pragma once
+
+#include <string>
+
+
+
+namespace TestHarness
+{
+//
+//  TestFunction
+//
+//  The type of a test.
+//
+	typedef void (*TestFunction) ();
+
+//
+//  addTest
+//
+//  Purpose: To register a test to run.
+//  Parameter(s):
+//    <1> name: The name of the test
+//    <2> p_function: The test
+//  Precondition(s):
+//    <1> name != ""
+//    <2> p_function != nullptr
+//  Returns: true.  The value is used to register tests during
+//           static initialization.
+//  Side Effect: The test is added to the list of tests.
+//
+	bool addTest (const std::string& name,
+	              TestFunction p_function);
+
+//
+//  reportFailure
+//
+//  Purpose: To record that a check in the current test failed.
+//  Parameter(s):
+//    <1> filename: The source file of the check
+//    <2> line: The line of the check
+//    <3> message: A description of what failed
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: The failure is printed to the standard error
+//               stream and the current test is marked as
+//               failed.
+//
+	void reportFailure (const char* filename,
+	                    unsigned int line,
+	                    const std::string& message);
+
+//
+//  runAll
+//
+//  Purpose: To run the registered tests.
+//  Parameter(s):
+//    <1> filter: Only tests with this text in their name are
+//                run
+//  Precondition(s): N/A
+//  Returns: The number of tests that failed.
+//  Side Effect: The tests are run in the order they were
+//               registered and the results are printed to the
+//               standard output stream.
+//
+	unsigned int runAll (const std::string& filter);
+
+}  // end of namespace TestHarness
+
+
+
+//
+//  UWSIM_TEST
+//
+//  Declares and registers a test named name.  It is used in
+//    place of the function header, e.g.
+//
+//    UWSIM_TEST(SpatialHashGrid_matchesBruteForce)
+//    {
+//        UWSIM_CHECK(...);
+//    }
+//
+#define UWSIM_TEST(name)                                              \
+	static void name ();                                              \
+	static const bool name##_IS_REGISTERED =                          \
+	                      TestHarness::addTest(#name, name);          \
+	static void name ()
+
+//
+//  UWSIM_CHECK
+//
+//  Reports a failure if condition is false.
+//
+#define UWSIM_CHECK(condition)                                        \
+	do {                                                              \
+		if(!(condition))                                              \
+			TestHarness::reportFailure(__FILE__, __LINE__, #condition); \
+	} while(false)
+
+//
+//  UWSIM_CHECK_NEAR
+//
+//  Reports a failure if actual and expected differ by more
+//    than tolerance.
+//
+#define UWSIM_CHECK_NEAR(actual, expected, tolerance)                 \
+	do {                                                              \
+		double uwsim_actual   = (actual);                             \
+		double uwsim_expected = (expected);                           \
+		double uwsim_difference = uwsim_actual - uwsim_expected;      \
+		if(!(uwsim_difference <=  (tolerance) &&                      \
+		     uwsim_difference >= -(tolerance)))                       \
+			TestHarness::reportFailure(__FILE__, __LINE__,            \
+			        std::string(#actual " is ") +                     \
+			        std::to_string(uwsim_actual) + ", expected " +    \
+			        std::to_string(uwsim_expected));                  \
+	} while(false)
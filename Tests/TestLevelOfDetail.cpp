@@ -0,0 +1,174 @@
+//
+//  TestLevelOfDetail.cpp
+//
+//  Tests for choosing and naming the levels of detail of the
+//    fixed entities.  These do not load any models, so no
+//    OpenGL context is needed.
+//
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "../LevelOfDetail.h"
+#include "TestHarness.h"
+
+using namespace std;
+
+namespace
+{
+	//
+	//  getSimplifiedSwitchDistances
+	//
+	//  Purpose: To calculate the switch distances that addLods
+	//           gives an entity with simplified levels of
+	//           detail.
+	//  Parameter(s):
+	//    <1> bounding_radius: The bounding radius of the entity
+	//  Precondition(s): N/A
+	//  Returns: The switch distance for full detail and for each
+	//           simplified level.
+	//  Side Effect: N/A
+	//
+	vector<double> getSimplifiedSwitchDistances (double bounding_radius)
+	{
+		vector<double> v_switch_distances(1, 0.0);
+		for(unsigned int i = 0; i < LevelOfDetail::SIMPLIFIED_COUNT; i++)
+			v_switch_distances.push_back(bounding_radius * LevelOfDetail::SIMPLIFIED_SWITCH_DISTANCES_PER_RADIUS[i]);
+		return v_switch_distances;
+	}
+
+	//
+	//  getExpectedLod
+	//
+	//  Purpose: To determine which level of detail an entity
+	//           should have if it is not near any threshold.
+	//  Parameter(s):
+	//    <1> distance: The distance from the camera
+	//    <2> v_switch_distances: The switch distances
+	//  Precondition(s): N/A
+	//  Returns: The last level with a switch distance below
+	//           distance.
+	//  Side Effect: N/A
+	//
+	unsigned int getExpectedLod (double distance,
+	                             const vector<double>& v_switch_distances)
+	{
+		unsigned int lod = 0;
+		for(unsigned int i = 1; i < v_switch_distances.size(); i++)
+			if(v_switch_distances[i] < distance)
+				lod = i;
+		return lod;
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(LevelOfDetail_namesLowPolyModels)
+{
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("rock.obj") == "rock-lowpoly.obj");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("treasure_chest.obj") == "treasure_chest-lowpoly.obj");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("a.obj") == "a-lowpoly.obj");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("rock-lowpoly.obj") == "");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("rock.bmp") == "");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("rock.obj.bak") == "");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName(".obj") == "");
+	UWSIM_CHECK(LevelOfDetail::getLowPolyModelName("") == "");
+}
+
+UWSIM_TEST(LevelOfDetail_keepsOnlyUsefulSimplifiedLevels)
+{
+	vector<double> v_ratios = LevelOfDetail::getSimplifiedRatios();
+	UWSIM_CHECK(v_ratios.size() == LevelOfDetail::SIMPLIFIED_COUNT);
+	for(unsigned int i = 0; i < v_ratios.size(); i++)
+	{
+		UWSIM_CHECK(v_ratios[i] > 0.0);
+		UWSIM_CHECK(v_ratios[i] < 1.0);
+		if(i > 0)
+			UWSIM_CHECK(v_ratios[i] < v_ratios[i - 1]);
+	}
+
+	UWSIM_CHECK( LevelOfDetail::isSimplifiedWorthUsing(500, 1000));
+	UWSIM_CHECK( LevelOfDetail::isSimplifiedWorthUsing(900, 1000));
+	UWSIM_CHECK(!LevelOfDetail::isSimplifiedWorthUsing(901, 1000));
+	UWSIM_CHECK(!LevelOfDetail::isSimplifiedWorthUsing(1000, 1000));
+	UWSIM_CHECK(!LevelOfDetail::isSimplifiedWorthUsing(1, 1));
+}
+
+UWSIM_TEST(LevelOfDetail_choosesLevelAwayFromThresholds)
+{
+	const double RADIUS = 2.0;
+	const double DISTANCES[] = { 0.0, 1.0, 10.0, 20.0, 25.0, 50.0, 1000.0 };
+
+	vector<double> v_switch_distances = getSimplifiedSwitchDistances(RADIUS);
+
+	// from any starting level, including jumps of several levels
+	for(double distance : DISTANCES)
+	{
+		unsigned int expected = getExpectedLod(distance, v_switch_distances);
+		for(unsigned int current = 0; current < v_switch_distances.size(); current++)
+			UWSIM_CHECK(LevelOfDetail::chooseLod(distance, current, v_switch_distances) == expected);
+	}
+
+	// an entity with only full detail never changes
+	vector<double> v_only_full(1, 0.0);
+	UWSIM_CHECK(LevelOfDetail::chooseLod(0.0,    0, v_only_full) == 0);
+	UWSIM_CHECK(LevelOfDetail::chooseLod(1.0e6, 0, v_only_full) == 0);
+}
+
+UWSIM_TEST(LevelOfDetail_doesNotFlickerNearThreshold)
+{
+	const double RADIUS = 1.5;
+
+	vector<double> v_switch_distances = getSimplifiedSwitchDistances(RADIUS);
+	double threshold = v_switch_distances[1];
+	double inside    = threshold * (1.0 - LevelOfDetail::HYSTERESIS * 0.5);
+	double outside   = threshold * (1.0 + LevelOfDetail::HYSTERESIS * 0.5);
+
+	// wobbling around the threshold keeps whichever level was used
+	for(unsigned int i = 0; i < 10; i++)
+	{
+		UWSIM_CHECK(LevelOfDetail::chooseLod(inside,  0, v_switch_distances) == 0);
+		UWSIM_CHECK(LevelOfDetail::chooseLod(outside, 0, v_switch_distances) == 0);
+		UWSIM_CHECK(LevelOfDetail::chooseLod(inside,  1, v_switch_distances) == 1);
+		UWSIM_CHECK(LevelOfDetail::chooseLod(outside, 1, v_switch_distances) == 1);
+	}
+
+	// but moving past the band switches
+	UWSIM_CHECK(LevelOfDetail::chooseLod(threshold * (1.0 + LevelOfDetail::HYSTERESIS * 1.5), 0, v_switch_distances) == 1);
+	UWSIM_CHECK(LevelOfDetail::chooseLod(threshold * (1.0 - LevelOfDetail::HYSTERESIS * 1.5), 1, v_switch_distances) == 0);
+}
+
+UWSIM_TEST(LevelOfDetail_switchesOnceEachWayAlongPath)
+{
+	// a camera flying away from a low-poly entity and back, one step per frame
+	const double RADIUS     = 0.75;
+	const double FARTHEST   = RADIUS * LevelOfDetail::LOW_POLY_SWITCH_DISTANCE_PER_RADIUS * 2.0;
+	const unsigned int STEP_COUNT = 400;
+
+	vector<double> v_switch_distances(1, 0.0);
+	v_switch_distances.push_back(RADIUS * LevelOfDetail::LOW_POLY_SWITCH_DISTANCE_PER_RADIUS);
+
+	unsigned int lod = 0;
+	unsigned int switch_count = 0;
+	for(unsigned int s = 0; s <= STEP_COUNT * 2; s++)
+	{
+		unsigned int along = (s <= STEP_COUNT) ? s : STEP_COUNT * 2 - s;
+		double distance = FARTHEST * along / STEP_COUNT;
+
+		// a little jitter, smaller than the hysteresis band
+		if(s % 2 == 1)
+			distance += v_switch_distances[1] * LevelOfDetail::HYSTERESIS * 0.25;
+
+		unsigned int next = LevelOfDetail::chooseLod(distance, lod, v_switch_distances);
+		if(next != lod)
+			switch_count++;
+		lod = next;
+
+		if(s == STEP_COUNT)
+			UWSIM_CHECK(lod == 1);
+	}
+	UWSIM_CHECK(lod == 0);
+	UWSIM_CHECK(switch_count == 2);
+}
@@ -0,0 +1,565 @@
+//
+//  TestMeshSimplifier.cpp
+//
+//  Tests for the levels of detail made by MeshSimplifier from
+//    the models the game ships with.  Most models are
+//    simplified in memory.  The tests of the cache files work
+//    on copies in the temporary directory.
+//
+
+#include <cassert>
+#include <cfloat>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+#include "../ObjLibrary/Vector3.h"
+#include "../ObjLibrary/ObjModel.h"
+#include "../ObjLibrary/MeshSimplifier.h"
+
+#include "../LevelOfDetail.h"
+#include "TestHarness.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const string RESOURCE_PATH = "Resources/";
+
+	// the fixed entity models, the model the game simplifies, and fish with two-sided fins
+	const char* SHIPPED_MODELS[] =
+	{
+		"treasure_chest.obj", "anemone.obj", "rock.obj", "buoy.obj", "pipe-cap.obj",
+		"pipe8.obj", "tunnel.obj", "anchovy.obj", "yellow-tang.obj",
+	};
+
+	//
+	//  MAX_SURFACE_DISTANCE
+	//
+	//  How far a simplified triangle may be from the original
+	//    surface that it is compared to, as a fraction of the
+	//    model radius.  This matches the error the simplifier
+	//    allows, so a thin part, such as a lock on a chest, is
+	//    compared to all of its sides.
+	//
+	const double MAX_SURFACE_DISTANCE = 0.03;
+
+	// for rounding when a face is at right angles to the surface
+	const double NORMAL_TOLERANCE = 1.0e-6;
+
+	//
+	//  Triangle
+	//
+	//  A record to represent one triangle of a model.
+	//
+	struct Triangle
+	{
+		Vector3 ma_corners[3];
+	};
+
+	//
+	//  getTriangles
+	//
+	//  Purpose: To split the faces of a model into triangles.
+	//  Parameter(s):
+	//    <1> model: The model
+	//  Precondition(s): N/A
+	//  Returns: The triangles, fanned around the first vertex
+	//           of each face as the model is drawn.
+	//  Side Effect: N/A
+	//
+	vector<Triangle> getTriangles (const ObjModel& model)
+	{
+		vector<Triangle> v_triangles;
+		for(unsigned int m = 0; m < model.getMeshCount(); m++)
+			for(unsigned int f = 0; f < model.getFaceCount(m); f++)
+			{
+				unsigned int vertex_count = model.getFaceVertexCount(m, f);
+				for(unsigned int v = 1; v + 1 < vertex_count; v++)
+				{
+					Triangle triangle;
+					triangle.ma_corners[0] = model.getVertexPosition(model.getFaceVertexIndex(m, f, 0));
+					triangle.ma_corners[1] = model.getVertexPosition(model.getFaceVertexIndex(m, f, v));
+					triangle.ma_corners[2] = model.getVertexPosition(model.getFaceVertexIndex(m, f, v + 1));
+					v_triangles.push_back(triangle);
+				}
+			}
+		return v_triangles;
+	}
+
+	//
+	//  getNormal
+	//
+	//  Purpose: To calculate the normal of a triangle.
+	//  Parameter(s):
+	//    <1> triangle: The triangle
+	//  Precondition(s): N/A
+	//  Returns: The normal, scaled by twice the area.  This is
+	//           the zero vector for a degenerate triangle.
+	//  Side Effect: N/A
+	//
+	Vector3 getNormal (const Triangle& triangle)
+	{
+		return (triangle.ma_corners[1] - triangle.ma_corners[0]).crossProduct(
+		        triangle.ma_corners[2] - triangle.ma_corners[0]);
+	}
+
+	//
+	//  getClosestPoint
+	//
+	//  Purpose: To find the point on a triangle closest to
+	//           another point.
+	//  Parameter(s):
+	//    <1> point: The point
+	//    <2> triangle: The triangle
+	//  Precondition(s): N/A
+	//  Returns: The closest point on triangle to point.
+	//  Side Effect: N/A
+	//
+	Vector3 getClosestPoint (const Vector3& point,
+	                         const Triangle& triangle)
+	{
+		// from "Real-Time Collision Detection" by Christer Ericson, 2005
+		const Vector3& a = triangle.ma_corners[0];
+		const Vector3& b = triangle.ma_corners[1];
+		const Vector3& c = triangle.ma_corners[2];
+		Vector3 ab = b - a;
+		Vector3 ac = c - a;
+
+		double d1 = ab.dotProduct(point - a);
+		double d2 = ac.dotProduct(point - a);
+		if(d1 <= 0.0 && d2 <= 0.0)
+			return a;
+
+		double d3 = ab.dotProduct(point - b);
+		double d4 = ac.dotProduct(point - b);
+		if(d3 >= 0.0 && d4 <= d3)
+			return b;
+
+		double vc = d1 * d4 - d3 * d2;
+		if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+			return a + ab * (d1 / (d1 - d3));
+
+		double d5 = ab.dotProduct(point - c);
+		double d6 = ac.dotProduct(point - c);
+		if(d6 >= 0.0 && d5 <= d6)
+			return c;
+
+		double vb = d5 * d2 - d1 * d6;
+		if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+			return a + ac * (d2 / (d2 - d6));
+
+		double va = d3 * d6 - d5 * d4;
+		if(va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		double denominator = 1.0 / (va + vb + vc);
+		return a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+
+	//
+	//  isFacingSurface
+	//
+	//  Purpose: To determine if a simplified triangle faces the
+	//           same way as the original surface near it.
+	//  Parameter(s):
+	//    <1> triangle: The simplified triangle
+	//    <2> v_original: The triangles of the original model
+	//    <3> tolerance: How much farther than the closest
+	//                   original triangle another one may be
+	//                   and still be compared
+	//  Precondition(s):
+	//    <1> !getNormal(triangle).isZero()
+	//  Returns: Whether the normal of triangle points no more
+	//           than 90 degrees away from the normal of any
+	//           original triangle near its center.
+	//  Side Effect: N/A
+	//
+	bool isFacingSurface (const Triangle& triangle,
+	                      const vector<Triangle>& v_original,
+	                      double tolerance)
+	{
+		assert(!getNormal(triangle).isZero());
+
+		Vector3 center = (triangle.ma_corners[0] + triangle.ma_corners[1] + triangle.ma_corners[2]) / 3.0;
+		vector<double> v_distances(v_original.size());
+		double closest = DBL_MAX;
+		for(unsigned int i = 0; i < v_original.size(); i++)
+		{
+			v_distances[i] = getClosestPoint(center, v_original[i]).getDistance(center);
+			if(v_distances[i] < closest)
+				closest = v_distances[i];
+		}
+
+		// a face across a thin part can be at right angles to all of it
+		Vector3 normal = getNormal(triangle);
+		for(unsigned int i = 0; i < v_original.size(); i++)
+			if(v_distances[i] <= closest + tolerance &&
+			   !getNormal(v_original[i]).isZero() &&
+			   normal.getCosAngle(getNormal(v_original[i])) > -NORMAL_TOLERANCE)
+			{
+				return true;
+			}
+		return false;
+	}
+
+	//
+	//  getBounds
+	//
+	//  Purpose: To calculate the bounding box of some triangles.
+	//  Parameter(s):
+	//    <1> v_triangles: The triangles
+	//    <2> r_min: The minimum corner
+	//    <3> r_max: The maximum corner
+	//  Precondition(s):
+	//    <1> !v_triangles.empty()
+	//  Returns: N/A
+	//  Side Effect: r_min and r_max are set to the corners of
+	//               the smallest axis-aligned box that contains
+	//               v_triangles.
+	//
+	void getBounds (const vector<Triangle>& v_triangles,
+	                Vector3& r_min,
+	                Vector3& r_max)
+	{
+		assert(!v_triangles.empty());
+
+		r_min = v_triangles[0].ma_corners[0];
+		r_max = r_min;
+		for(unsigned int i = 0; i < v_triangles.size(); i++)
+			for(unsigned int c = 0; c < 3; c++)
+			{
+				const Vector3& corner = v_triangles[i].ma_corners[c];
+				if(corner.x < r_min.x) r_min.x = corner.x;
+				if(corner.y < r_min.y) r_min.y = corner.y;
+				if(corner.z < r_min.z) r_min.z = corner.z;
+				if(corner.x > r_max.x) r_max.x = corner.x;
+				if(corner.y > r_max.y) r_max.y = corner.y;
+				if(corner.z > r_max.z) r_max.z = corner.z;
+			}
+	}
+
+	//
+	//  getSimplifiedLods
+	//
+	//  Purpose: To load a shipped model and simplify it to the
+	//           ratios the game uses.
+	//  Parameter(s):
+	//    <1> model_name: The file name of the model
+	//    <2> r_original: The loaded model
+	//  Precondition(s): N/A
+	//  Returns: One simplified model for each ratio in
+	//           LevelOfDetail::getSimplifiedRatios(), or an empty
+	//           vector if the model could not be loaded.
+	//  Side Effect: r_original is set to the model.  A failure
+	//               is reported if it could not be loaded.
+	//
+	vector<ObjModel> getSimplifiedLods (const string& model_name,
+	                                    ObjModel& r_original)
+	{
+		r_original.load(RESOURCE_PATH + model_name);
+		if(!r_original.isLoadedSuccessfully())
+		{
+			TestHarness::reportFailure(__FILE__, __LINE__, "Could not load \"" + model_name + "\"");
+			return vector<ObjModel>();
+		}
+
+		MeshSimplifier simplifier(r_original);
+		return simplifier.getSimplified(LevelOfDetail::getSimplifiedRatios());
+	}
+
+	//
+	//  copyToTemporary
+	//
+	//  Purpose: To copy a shipped model to the temporary
+	//           directory, with out-of-date cache files for the
+	//           ratios the game uses.
+	//  Parameter(s):
+	//    <1> model_name: The file name of the model
+	//    <2> stale_stamp: The first line to give the cache files
+	//  Precondition(s): N/A
+	//  Returns: The name of the copy, with its path, or "" if it
+	//           could not be made.
+	//  Side Effect: The model and its material libraries are
+//               copied.  Each cache file is
+	//               written as stale_stamp followed by the
+	//               original model, as if an older simplifier
+	//               could not simplify it at all.  A failure is
+	//               reported if anything could not be written.
+	//
+	string copyToTemporary (const string& model_name,
+	                        const string& stale_stamp)
+	{
+		std::error_code error;
+		std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "uwsim-tests";
+		std::filesystem::create_directories(directory, error);
+
+		// the material libraries must be there before the copy is loaded
+		ObjModel original(RESOURCE_PATH + model_name);
+		for(unsigned int i = 0; i < original.getMaterialLibraryCount(); i++)
+		{
+			const string& library_name = original.getMaterialLibraryName(i);
+			std::filesystem::copy_file(RESOURCE_PATH + library_name, directory / library_name,
+			                           std::filesystem::copy_options::overwrite_existing, error);
+		}
+
+		string filename = (directory / model_name).string();
+		if(!std::filesystem::copy_file(RESOURCE_PATH + model_name, filename,
+		                               std::filesystem::copy_options::overwrite_existing, error))
+		{
+			TestHarness::reportFailure(__FILE__, __LINE__, "Could not copy \"" + model_name + "\" to \"" + filename + "\"");
+			return "";
+		}
+
+		vector<double> v_ratios = LevelOfDetail::getSimplifiedRatios();
+		for(unsigned int i = 0; i < v_ratios.size(); i++)
+		{
+			ofstream output_file(MeshSimplifier::getLodFileName(filename, v_ratios[i]));
+			output_file << stale_stamp << endl;
+			original.save(output_file);
+			if(!output_file)
+			{
+				TestHarness::reportFailure(__FILE__, __LINE__, "Could not write a cache file for \"" + filename + "\"");
+				return "";
+			}
+		}
+		return filename;
+	}
+
+	//
+	//  removeWithCacheFiles
+	//
+	//  Purpose: To remove a model made by copyToTemporary.
+	//  Parameter(s):
+	//    <1> filename: The name of the copy
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: The copy and any cache files for the ratios
+	//               the game uses are removed.  The material
+	//               libraries are left for the next test.
+	//
+	void removeWithCacheFiles (const string& filename)
+	{
+		std::error_code error;
+		vector<double> v_ratios = LevelOfDetail::getSimplifiedRatios();
+		for(unsigned int i = 0; i < v_ratios.size(); i++)
+			std::filesystem::remove(MeshSimplifier::getLodFileName(filename, v_ratios[i]), error);
+		std::filesystem::remove(filename, error);
+	}
+
+	//
+	//  readFirstLine
+	//
+	//  Purpose: To read the first line of a file.
+	//  Parameter(s):
+	//    <1> filename: The name of the file
+	//  Precondition(s): N/A
+	//  Returns: The first line, or "" if the file cannot be
+	//           read.
+	//  Side Effect: N/A
+	//
+	string readFirstLine (const string& filename)
+	{
+		ifstream input(filename);
+		string line;
+		getline(input, line);
+		return line;
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(MeshSimplifier_meetsTriangleBudget)
+{
+	// smooth closed models, which have nothing stopping the collapses
+	const char* FREE_MODELS[] = {	"rock.obj", "buoy.obj", "pipe-cap.obj"	};
+
+	vector<double> v_ratios = LevelOfDetail::getSimplifiedRatios();
+
+	for(const char* model_name : FREE_MODELS)
+	{
+		ObjModel original;
+		vector<ObjModel> v_lods = getSimplifiedLods(model_name, original);
+		UWSIM_CHECK(v_lods.size() == v_ratios.size());
+
+		unsigned int original_count = MeshSimplifier::getTriangleCount(original);
+		for(unsigned int i = 0; i < v_lods.size(); i++)
+		{
+			unsigned int count = MeshSimplifier::getTriangleCount(v_lods[i]);
+			if(count > original_count * v_ratios[i])
+				TestHarness::reportFailure(__FILE__, __LINE__, string(model_name) + " kept " +
+				                           to_string(count) + " of " + to_string(original_count) +
+				                           " triangles for ratio " + to_string(v_ratios[i]));
+		}
+	}
+
+	// the model the game simplifies must get at least one level worth switching to
+	ObjModel chest;
+	vector<ObjModel> v_chest_lods = getSimplifiedLods("treasure_chest.obj", chest);
+	UWSIM_CHECK(!v_chest_lods.empty());
+	if(!v_chest_lods.empty())
+		UWSIM_CHECK(LevelOfDetail::isSimplifiedWorthUsing(MeshSimplifier::getTriangleCount(v_chest_lods[0]),
+		                                                  MeshSimplifier::getTriangleCount(chest)));
+}
+
+UWSIM_TEST(MeshSimplifier_neverAddsTriangles)
+{
+	for(const char* model_name : SHIPPED_MODELS)
+	{
+		ObjModel original;
+		vector<ObjModel> v_lods = getSimplifiedLods(model_name, original);
+
+		unsigned int previous_count = MeshSimplifier::getTriangleCount(original);
+		for(unsigned int i = 0; i < v_lods.size(); i++)
+		{
+			unsigned int count = MeshSimplifier::getTriangleCount(v_lods[i]);
+			UWSIM_CHECK(count > 0);
+			UWSIM_CHECK(count <= previous_count);
+			UWSIM_CHECK(count == getTriangles(v_lods[i]).size());
+			previous_count = count;
+		}
+	}
+}
+
+UWSIM_TEST(MeshSimplifier_hasNoDegenerateOrFlippedFaces)
+{
+	for(const char* model_name : SHIPPED_MODELS)
+	{
+		ObjModel original;
+		vector<ObjModel> v_lods = getSimplifiedLods(model_name, original);
+		vector<Triangle> v_original = getTriangles(original);
+		if(v_original.empty())
+			continue;
+
+		Vector3 original_min;
+		Vector3 original_max;
+		getBounds(v_original, original_min, original_max);
+		double tolerance = original_min.getDistance(original_max) * 0.5 * MAX_SURFACE_DISTANCE;
+
+		for(unsigned int i = 0; i < v_lods.size(); i++)
+		{
+			vector<Triangle> v_triangles = getTriangles(v_lods[i]);
+			unsigned int degenerate_count = 0;
+			unsigned int flipped_count    = 0;
+			for(unsigned int t = 0; t < v_triangles.size(); t++)
+			{
+				if(getNormal(v_triangles[t]).isZero())
+					degenerate_count++;
+				else if(!isFacingSurface(v_triangles[t], v_original, tolerance))
+					flipped_count++;
+			}
+			if(degenerate_count > 0 || flipped_count > 0)
+				TestHarness::reportFailure(__FILE__, __LINE__, string(model_name) + " level " + to_string(i + 1) +
+				                           " has " + to_string(degenerate_count) + " degenerate and " +
+				                           to_string(flipped_count) + " flipped triangles");
+		}
+	}
+}
+
+UWSIM_TEST(MeshSimplifier_keepsBounds)
+{
+	for(const char* model_name : SHIPPED_MODELS)
+	{
+		ObjModel original;
+		vector<ObjModel> v_lods = getSimplifiedLods(model_name, original);
+		vector<Triangle> v_original = getTriangles(original);
+		if(v_original.empty())
+			continue;
+
+		Vector3 original_min;
+		Vector3 original_max;
+		getBounds(v_original, original_min, original_max);
+
+		for(unsigned int i = 0; i < v_lods.size(); i++)
+		{
+			vector<Triangle> v_triangles = getTriangles(v_lods[i]);
+			UWSIM_CHECK(!v_triangles.empty());
+			if(v_triangles.empty())
+				continue;
+
+			// vertexes are never moved, and the ones on the box are kept
+			Vector3 lod_min;
+			Vector3 lod_max;
+			getBounds(v_triangles, lod_min, lod_max);
+			if(lod_min != original_min || lod_max != original_max)
+				TestHarness::reportFailure(__FILE__, __LINE__, string(model_name) + " level " + to_string(i + 1) +
+				                           " does not have the bounds of the original");
+		}
+	}
+}
+
+UWSIM_TEST(MeshSimplifier_remakesCacheFilesFromOtherVersions)
+{
+	const string CURRENT_STAMP = "# MeshSimplifier version " + to_string(MeshSimplifier::VERSION) + " ";
+	const string STALE_STAMPS[] =
+	{
+		"",  // before the cache files had a stamp
+		"# MeshSimplifier version " + to_string(MeshSimplifier::VERSION - 1) + " for ratios 0.5 0.25",
+	};
+
+	vector<double> v_ratios = LevelOfDetail::getSimplifiedRatios();
+	for(const string& stale_stamp : STALE_STAMPS)
+	{
+		// the cache files are newer than the model, so only the stamp shows they are stale
+		string filename = copyToTemporary("rock.obj", stale_stamp);
+		if(filename == "")
+			continue;
+		unsigned int original_count = MeshSimplifier::getTriangleCount(ObjModel(filename));
+
+		UWSIM_CHECK(MeshSimplifier::updateLods(filename, v_ratios));
+		for(unsigned int i = 0; i < v_ratios.size(); i++)
+		{
+			string lod_filename = MeshSimplifier::getLodFileName(filename, v_ratios[i]);
+			UWSIM_CHECK(readFirstLine(lod_filename).compare(0, CURRENT_STAMP.size(), CURRENT_STAMP) == 0);
+			UWSIM_CHECK(MeshSimplifier::getTriangleCount(ObjModel(lod_filename)) < original_count);
+		}
+		removeWithCacheFiles(filename);
+	}
+}
+
+UWSIM_TEST(MeshSimplifier_skipsLevelsThatRemoveNothing)
+{
+	// the lock and hinges of the chest stop the collapses before the lowest ratio
+	string filename = copyToTemporary("treasure_chest.obj", "");
+	if(filename == "")
+		return;
+	unsigned int original_count = MeshSimplifier::getTriangleCount(ObjModel(filename));
+
+	vector<double> v_ratios = LevelOfDetail::getSimplifiedRatios();
+	UWSIM_CHECK(MeshSimplifier::updateLods(filename, v_ratios));
+	vector<ObjModel> v_lods = MeshSimplifier::loadLods(filename, v_ratios);
+	UWSIM_CHECK(v_lods.size() == v_ratios.size());
+
+	// every file written removes more triangles, and a level with no file is the same as the one before
+	unsigned int previous_count = original_count;
+	unsigned int written_count  = 0;
+	for(unsigned int i = 0; i < v_lods.size() && i < v_ratios.size(); i++)
+	{
+		unsigned int count = MeshSimplifier::getTriangleCount(v_lods[i]);
+		string lod_filename = MeshSimplifier::getLodFileName(filename, v_ratios[i]);
+		if(ifstream(lod_filename))
+		{
+			written_count++;
+			UWSIM_CHECK(count < previous_count);
+			UWSIM_CHECK(MeshSimplifier::getTriangleCount(ObjModel(lod_filename)) == count);
+		}
+		else
+		{
+			UWSIM_CHECK(i > 0);
+			UWSIM_CHECK(count == previous_count);
+		}
+		previous_count = count;
+	}
+	UWSIM_CHECK(written_count > 0);
+
+	// nothing is remade now that the files are up to date
+	std::error_code error;
+	std::filesystem::file_time_type before = std::filesystem::last_write_time(MeshSimplifier::getLodFileName(filename, v_ratios[0]), error);
+	UWSIM_CHECK(MeshSimplifier::updateLods(filename, v_ratios));
+	UWSIM_CHECK(std::filesystem::last_write_time(MeshSimplifier::getLodFileName(filename, v_ratios[0]), error) == before);
+
+	removeWithCacheFiles(filename);
+}
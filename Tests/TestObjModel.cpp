@@ -0,0 +1,290 @@
+//
+//  TestObjModel.cpp
+//
+//  Tests for loading OBJ files into an ObjModel.  The shipped
+//    models are checked against counts and values read from
+//    the files by hand.  The tests of line endings and index
+//    forms write small files to the temporary directory.
+//
+
+#include <cassert>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include "../ObjLibrary/Vector3.h"
+#include "../ObjLibrary/ObjModel.h"
+
+#include "TestHarness.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const string RESOURCE_PATH = "Resources/";
+
+	const unsigned int NO_TEXTURE_COORDINATES = ObjModel::NO_TEXTURE_COORDINATES;
+	const unsigned int NO_NORMAL              = ObjModel::NO_NORMAL;
+
+	//
+	//  ShippedModel
+	//
+	//  A record to represent what a shipped model must load as.
+	//    The values are copied from the file, and the indexes
+	//    are reduced by 1 to start at 0.  The normal is as it
+	//    is written, before it is scaled to length 1.
+	//
+	struct ShippedModel
+	{
+		const char* m_filename;
+		unsigned int m_vertex_count;
+		unsigned int m_texture_coordinate_count;
+		unsigned int m_normal_count;
+		unsigned int m_face_count;
+		double ma_first_vertex[3];
+		double ma_last_vertex[3];
+		double ma_first_texture_coordinates[2];
+		double ma_first_normal[3];
+		unsigned int m_first_face_vertex_count;
+		unsigned int ma_first_corner[3];  // vertex, texture coordinates, normal
+		unsigned int ma_last_corner[3];
+	};
+
+	const ShippedModel SHIPPED_MODELS[] =
+	{
+		{ "anchovy.obj",        44,  38,  46,  90,
+		  {  1.41733,  -0.0299858,  0.0 },      { -0.750145, -0.0357567, -0.0513371 },
+		  { 0.965625, 0.516146 },               { 0.921966, 0.38727, 0.0 },
+		  3, { 0, 0, 0 },     { 30, 30, 45 } },
+		{ "rock.obj",          312, 325, 312, 576,
+		  {  0.0,       1.0,        0.0 },      {  0.0,      -1.0,        0.0 },
+		  { 0.0, 1.0 },                         { 0.0, 1.0, 0.0 },
+		  3, { 0, 0, 0 },     { 311, 311, 311 } },
+		{ "treasure_chest.obj", 184, 230, 706, 178,
+		  { -0.774382,  0.0,       -0.480865 }, {  0.089038,  0.795239,  -0.494456 },
+		  { 1.069870, 0.001066 },               { 0.0, 0.694220, 0.719763 },
+		  4, { 112, 124, 0 }, { 183, 209, 705 } },
+	};
+
+	//
+	//  EDGE_CASE_OBJ
+	//
+	//  A small model with every form of face index, and a tab
+	//    between tokens.  Each face uses the same corners as
+	//    the matching row of EDGE_CASE_CORNERS.
+	//
+	const string EDGE_CASE_OBJ =
+		"# every index form\n"
+		"v 0 0 0\n"
+		"v\t1.5 0 0\n"
+		"v 0 2.25 0\n"
+		"v 1 1 -1e1\n"
+		"vt 0.5 0.75\n"
+		"vt 1 0\n"
+		"vn 0 0 1\n"
+		"f 1 2 3\n"
+		"f 1/1 2/2 3/1\n"
+		"f 1//1 2//1 4//1\n"
+		"f 1/2/1 3/1/1 4/2/1\n"
+		"f -4/-2/-1 -3/-1/-1 -1/-2/-1\n";
+
+	const unsigned int EDGE_CASE_FACE_COUNT = 5;
+	const unsigned int EDGE_CASE_CORNERS[EDGE_CASE_FACE_COUNT][3][3] =
+	{
+		{ { 0, NO_TEXTURE_COORDINATES, NO_NORMAL }, { 1, NO_TEXTURE_COORDINATES, NO_NORMAL },
+		  { 2, NO_TEXTURE_COORDINATES, NO_NORMAL } },
+		{ { 0, 0, NO_NORMAL }, { 1, 1, NO_NORMAL }, { 2, 0, NO_NORMAL } },
+		{ { 0, NO_TEXTURE_COORDINATES, 0 }, { 1, NO_TEXTURE_COORDINATES, 0 },
+		  { 3, NO_TEXTURE_COORDINATES, 0 } },
+		{ { 0, 1, 0 }, { 2, 0, 0 }, { 3, 1, 0 } },
+		{ { 0, 0, 0 }, { 1, 1, 0 }, { 3, 0, 0 } },
+	};
+
+	//
+	//  writeTemporaryFile
+	//
+	//  Purpose: To write a file to the temporary directory.
+	//  Parameter(s):
+	//    <1> name: The name of the file
+	//    <2> contents: The bytes to write
+	//  Precondition(s): N/A
+	//  Returns: The name of the file written, with its path, or
+	//           "" if it could not be written.
+	//  Side Effect: The file is written byte for byte, without
+	//               changing the line endings.
+	//
+	string writeTemporaryFile (const string& name,
+	                           const string& contents)
+	{
+		std::error_code error;
+		std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "uwsim-tests";
+		std::filesystem::create_directories(directory, error);
+		string filename = (directory / name).string();
+
+		ofstream fout(filename, ios::binary);
+		fout << contents;
+		fout.close();
+		if(!fout)
+			return "";
+		return filename;
+	}
+
+	//
+	//  replaceAll
+	//
+	//  Purpose: To replace every copy of a string in another.
+	//  Parameter(s):
+	//    <1> str: The string to replace in
+	//    <2> from: The string to replace
+	//    <3> to: The string to replace it with
+	//  Precondition(s):
+	//    <1> from != ""
+	//  Returns: str with each copy of from replaced by to.
+	//  Side Effect: N/A
+	//
+	string replaceAll (const string& str,
+	                   const string& from,
+	                   const string& to)
+	{
+		assert(from != "");
+
+		string result;
+		size_t start = 0;
+		for(size_t found = str.find(from); found != string::npos; found = str.find(from, start))
+		{
+			result += str.substr(start, found - start) + to;
+			start = found + from.length();
+		}
+		return result + str.substr(start);
+	}
+
+	//
+	//  checkEdgeCaseModel
+	//
+	//  Purpose: To check that a model loaded from a version of
+	//           EDGE_CASE_OBJ matches it.
+	//  Parameter(s):
+	//    <1> contents: The version of EDGE_CASE_OBJ to load
+	//    <2> name: The name to write it to
+	//  Precondition(s): N/A
+	//  Returns: N/A
+	//  Side Effect: contents is written to a temporary file,
+	//               loaded, and deleted.  A failure is reported
+	//               for each value that does not match.
+	//
+	void checkEdgeCaseModel (const string& contents,
+	                         const string& name)
+	{
+		string filename = writeTemporaryFile(name, contents);
+		UWSIM_CHECK(filename != "");
+		if(filename == "")
+			return;
+
+		ObjModel model(filename);
+		std::error_code error;
+		std::filesystem::remove(filename, error);
+
+		UWSIM_CHECK(model.isLoadedSuccessfully());
+		UWSIM_CHECK(model.getVertexCount() == 4);
+		UWSIM_CHECK(model.getTextureCoordinateCount() == 2);
+		UWSIM_CHECK(model.getNormalCount() == 1);
+		UWSIM_CHECK(model.getMeshCount() == 1);
+		UWSIM_CHECK(model.getFaceCountTotal() == EDGE_CASE_FACE_COUNT);
+		if(model.getVertexCount() != 4 || model.getTextureCoordinateCount() != 2 ||
+		   model.getNormalCount() != 1 || model.getMeshCount() != 1 ||
+		   model.getFaceCount(0) != EDGE_CASE_FACE_COUNT)
+			return;
+
+		UWSIM_CHECK(model.getVertexX(1) == 1.5);
+		UWSIM_CHECK(model.getVertexY(2) == 2.25);
+		UWSIM_CHECK(model.getVertexZ(3) == -10.0);
+		UWSIM_CHECK(model.getTextureCoordinateU(0) == 0.5);
+		UWSIM_CHECK(model.getTextureCoordinateV(0) == 0.75);
+		UWSIM_CHECK(model.getNormalZ(0) == 1.0);
+
+		for(unsigned int f = 0; f < EDGE_CASE_FACE_COUNT; f++)
+		{
+			UWSIM_CHECK(model.getFaceVertexCount(0, f) == 3);
+			if(model.getFaceVertexCount(0, f) != 3)
+				continue;
+			for(unsigned int c = 0; c < 3; c++)
+			{
+				UWSIM_CHECK(model.getFaceVertexIndex             (0, f, c) == EDGE_CASE_CORNERS[f][c][0]);
+				UWSIM_CHECK(model.getFaceVertexTextureCoordinates(0, f, c) == EDGE_CASE_CORNERS[f][c][1]);
+				UWSIM_CHECK(model.getFaceVertexNormal            (0, f, c) == EDGE_CASE_CORNERS[f][c][2]);
+			}
+		}
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(ObjModel_loadsShippedModels)
+{
+	for(const ShippedModel& expected : SHIPPED_MODELS)
+	{
+		ObjModel model(RESOURCE_PATH + expected.m_filename);
+		UWSIM_CHECK(model.isLoadedSuccessfully());
+		UWSIM_CHECK(model.isValid());
+		UWSIM_CHECK(model.getVertexCount()            == expected.m_vertex_count);
+		UWSIM_CHECK(model.getTextureCoordinateCount() == expected.m_texture_coordinate_count);
+		UWSIM_CHECK(model.getNormalCount()            == expected.m_normal_count);
+		UWSIM_CHECK(model.getMeshCount() == 1);
+		UWSIM_CHECK(model.getFaceCountTotal() == expected.m_face_count);
+		if(model.getVertexCount()            != expected.m_vertex_count ||
+		   model.getTextureCoordinateCount() != expected.m_texture_coordinate_count ||
+		   model.getNormalCount()            != expected.m_normal_count ||
+		   model.getMeshCount() != 1 ||
+		   model.getFaceCount(0) != expected.m_face_count)
+			continue;
+
+		// the same double as the text, not just close to it
+		unsigned int last_vertex = expected.m_vertex_count - 1;
+		UWSIM_CHECK(model.getVertexX(0) == expected.ma_first_vertex[0]);
+		UWSIM_CHECK(model.getVertexY(0) == expected.ma_first_vertex[1]);
+		UWSIM_CHECK(model.getVertexZ(0) == expected.ma_first_vertex[2]);
+		UWSIM_CHECK(model.getVertexX(last_vertex) == expected.ma_last_vertex[0]);
+		UWSIM_CHECK(model.getVertexY(last_vertex) == expected.ma_last_vertex[1]);
+		UWSIM_CHECK(model.getVertexZ(last_vertex) == expected.ma_last_vertex[2]);
+		UWSIM_CHECK(model.getTextureCoordinateU(0) == expected.ma_first_texture_coordinates[0]);
+		UWSIM_CHECK(model.getTextureCoordinateV(0) == expected.ma_first_texture_coordinates[1]);
+
+		// normals are scaled to length 1 as they are added
+		Vector3 first_normal = Vector3(expected.ma_first_normal[0],
+		                               expected.ma_first_normal[1],
+		                               expected.ma_first_normal[2]).getNormalized();
+		UWSIM_CHECK(model.getNormalX(0) == first_normal.x);
+		UWSIM_CHECK(model.getNormalY(0) == first_normal.y);
+		UWSIM_CHECK(model.getNormalZ(0) == first_normal.z);
+
+		unsigned int last_face = expected.m_face_count - 1;
+		unsigned int last_corner = model.getFaceVertexCount(0, last_face) - 1;
+		UWSIM_CHECK(model.getFaceVertexCount(0, 0) == expected.m_first_face_vertex_count);
+		UWSIM_CHECK(model.getFaceVertexIndex             (0, 0, 0) == expected.ma_first_corner[0]);
+		UWSIM_CHECK(model.getFaceVertexTextureCoordinates(0, 0, 0) == expected.ma_first_corner[1]);
+		UWSIM_CHECK(model.getFaceVertexNormal            (0, 0, 0) == expected.ma_first_corner[2]);
+		UWSIM_CHECK(model.getFaceVertexIndex             (0, last_face, last_corner) == expected.ma_last_corner[0]);
+		UWSIM_CHECK(model.getFaceVertexTextureCoordinates(0, last_face, last_corner) == expected.ma_last_corner[1]);
+		UWSIM_CHECK(model.getFaceVertexNormal            (0, last_face, last_corner) == expected.ma_last_corner[2]);
+	}
+}
+
+UWSIM_TEST(ObjModel_loadsEveryIndexForm)
+{
+	checkEdgeCaseModel(EDGE_CASE_OBJ, "edge-cases-lf.obj");
+}
+
+UWSIM_TEST(ObjModel_loadsCrlfLineEndings)
+{
+	checkEdgeCaseModel(replaceAll(EDGE_CASE_OBJ, "\n", "\r\n"), "edge-cases-crlf.obj");
+}
+
+UWSIM_TEST(ObjModel_loadsLastLineWithoutNewline)
+{
+	// the last face must not be lost with either line ending
+	string no_newline = EDGE_CASE_OBJ.substr(0, EDGE_CASE_OBJ.length() - 1);
+	checkEdgeCaseModel(no_newline, "edge-cases-no-newline.obj");
+	checkEdgeCaseModel(replaceAll(no_newline, "\n", "\r\n"), "edge-cases-crlf-no-newline.obj");
+}
@@ -0,0 +1,223 @@
+//
+//  TestViewFrustum.cpp
+//
+//  Tests for culling with ViewFrustum, including the plant
+//    chunks on the terrain and the fixed entity hierarchy.
+//
+
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../ObjLibrary/Vector3.h"
+
+#include "../CoordinateSystem.h"
+#include "../ViewFrustum.h"
+#include "../FixedEntity.h"
+#include "../FixedEntityBvh.h"
+#include "../Terrain.h"
+#include "TestHarness.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const double PI = 3.14159265358979323846;
+
+	// the camera is at the origin looking along +X
+	const double FIELD_OF_VIEW = 60.0;
+	const double ASPECT_RATIO  = 1.0;
+	const double NEAR_DISTANCE = 0.1;
+	const double FAR_DISTANCE  = 50.0;
+
+	//
+	//  createFrustum
+	//
+	//  Purpose: To create the frustum the tests use.
+	//  Parameter(s):
+	//    <1> position: The camera position
+	//  Precondition(s): N/A
+	//  Returns: A frustum for a camera at position looking along
+	//           +X, with a square 60 degree view.
+	//  Side Effect: N/A
+	//
+	ViewFrustum createFrustum (const Vector3& position)
+	{
+		CoordinateSystem camera(position, Vector3(1.0, 0.0, 0.0));
+		return ViewFrustum(camera, FIELD_OF_VIEW, ASPECT_RATIO, NEAR_DISTANCE, FAR_DISTANCE);
+	}
+
+	//
+	//  isPointInside
+	//
+	//  Purpose: To determine if a point is strictly inside the
+	//           test frustum, calculated from the angles instead
+	//           of the planes.
+	//  Parameter(s):
+	//    <1> camera: The camera position
+	//    <2> point: The point to check
+	//  Precondition(s): N/A
+	//  Returns: Whether point is inside.
+	//  Side Effect: N/A
+	//
+	bool isPointInside (const Vector3& camera,
+	                    const Vector3& point)
+	{
+		Vector3 offset = point - camera;
+		if(offset.x <= NEAR_DISTANCE || offset.x >= FAR_DISTANCE)
+			return false;
+		double limit = tan(FIELD_OF_VIEW * 0.5 * PI / 180.0) * offset.x;
+		return fabs(offset.y) < limit && fabs(offset.z) < limit * ASPECT_RATIO;
+	}
+
+}  // end of anonymous namespace
+
+
+
+UWSIM_TEST(ViewFrustum_acceptsAndRejectsSpheres)
+{
+	ViewFrustum frustum = createFrustum(Vector3::ZERO);
+
+	UWSIM_CHECK( frustum.isSphereVisible(Vector3( 10.0,  0.0,  0.0), 1.0));
+	UWSIM_CHECK( frustum.isSphereVisible(Vector3( 10.0,  0.0,  5.0), 1.0));
+	UWSIM_CHECK( frustum.isSphereVisible(Vector3( 10.0, -5.0,  0.0), 1.0));
+	UWSIM_CHECK( frustum.isSphereVisible(Vector3( 50.5,  0.0,  0.0), 1.0));  // across far plane
+	UWSIM_CHECK( frustum.isSphereVisible(Vector3(  0.0,  0.0,  0.0), 0.5));  // around camera
+	UWSIM_CHECK(!frustum.isSphereVisible(Vector3(-10.0,  0.0,  0.0), 1.0));  // behind
+	UWSIM_CHECK(!frustum.isSphereVisible(Vector3( 60.0,  0.0,  0.0), 1.0));  // too far
+	UWSIM_CHECK(!frustum.isSphereVisible(Vector3( 10.0,  0.0, 10.0), 1.0));  // 45 degrees right
+	UWSIM_CHECK(!frustum.isSphereVisible(Vector3( 10.0,  0.0,-10.0), 1.0));  // 45 degrees left
+	UWSIM_CHECK(!frustum.isSphereVisible(Vector3( 10.0,  8.0,  0.0), 1.0));  // 39 degrees up
+	UWSIM_CHECK(!frustum.isSphereVisible(Vector3( 10.0, -8.0,  0.0), 1.0));  // 39 degrees down
+}
+
+UWSIM_TEST(ViewFrustum_acceptsAndRejectsBoxes)
+{
+	ViewFrustum frustum = createFrustum(Vector3::ZERO);
+
+	UWSIM_CHECK( frustum.isBoxVisible(Vector3(  5.0, -1.0, -1.0), Vector3(  7.0, 1.0, 1.0)));
+	UWSIM_CHECK( frustum.isBoxVisible(Vector3(-10.0, -1.0, -1.0), Vector3( 10.0, 1.0, 1.0)));  // around camera
+	UWSIM_CHECK( frustum.isBoxVisible(Vector3( 10.0, -1.0,  4.0), Vector3( 12.0, 1.0, 9.0)));  // across side
+	UWSIM_CHECK(!frustum.isBoxVisible(Vector3(-7.0,  -1.0, -1.0), Vector3( -5.0, 1.0, 1.0)));  // behind
+	UWSIM_CHECK(!frustum.isBoxVisible(Vector3(55.0,  -1.0, -1.0), Vector3( 57.0, 1.0, 1.0)));  // too far
+	UWSIM_CHECK(!frustum.isBoxVisible(Vector3( 5.0,  -1.0,  8.0), Vector3(  7.0, 1.0, 9.0)));  // right
+	UWSIM_CHECK(!frustum.isBoxVisible(Vector3( 5.0,   6.0, -1.0), Vector3(  7.0, 7.0, 1.0)));  // above
+}
+
+UWSIM_TEST(ViewFrustum_defaultAcceptsEverything)
+{
+	ViewFrustum frustum;
+
+	UWSIM_CHECK(frustum.isSphereVisible(Vector3(-1000.0, 0.0, 0.0), 1.0));
+	UWSIM_CHECK(frustum.isBoxVisible(Vector3(1.0e6, 1.0e6, 1.0e6), Vector3(1.0e6 + 1.0, 1.0e6 + 1.0, 1.0e6 + 1.0)));
+}
+
+UWSIM_TEST(ViewFrustum_cullsPlantChunks)
+{
+	// the terrain from map.txt; initDisplayLists is not called, so no display lists
+	const Vector3 TERRAIN_OFFSET(-64.0, -30.0, -64.0);
+	const Vector3 TERRAIN_SIZE  (128.0,  45.0, 128.0);
+	const Vector3 CAMERA(-20.0, -10.0, 0.0);
+
+	Terrain terrain("Resources/", "heightmap.bmp", "dirt2.bmp", "grass1.bmp",
+	                TERRAIN_OFFSET, TERRAIN_SIZE);
+	UWSIM_CHECK(!terrain.isReadyToDraw());
+	UWSIM_CHECK(terrain.getPlantChunkCount() > 0);
+
+	vector<unsigned int> v_all;
+	terrain.findVisiblePlantChunks(ViewFrustum(), v_all);
+	UWSIM_CHECK(v_all.size() == terrain.getPlantChunkCount());
+
+	vector<unsigned int> v_visible;
+	terrain.findVisiblePlantChunks(createFrustum(CAMERA), v_visible);
+	vector<bool> v_is_visible(terrain.getPlantChunkCount(), false);
+	for(unsigned int i = 0; i < v_visible.size(); i++)
+	{
+		UWSIM_CHECK(v_visible[i] < terrain.getPlantChunkCount());
+		if(i > 0)
+			UWSIM_CHECK(v_visible[i] > v_visible[i - 1]);
+		if(v_visible[i] < v_is_visible.size())
+			v_is_visible[v_visible[i]] = true;
+	}
+
+	unsigned int must_accept_count = 0;
+	unsigned int must_reject_count = 0;
+	for(unsigned int c = 0; c < terrain.getPlantChunkCount(); c++)
+	{
+		const Vector3& box_min = terrain.getPlantChunkBoxMin(c);
+		const Vector3& box_max = terrain.getPlantChunkBoxMax(c);
+		UWSIM_CHECK(box_min.x <= box_max.x);
+		UWSIM_CHECK(box_min.y <  box_max.y);
+		UWSIM_CHECK(box_min.z <= box_max.z);
+
+		if(isPointInside(CAMERA, (box_min + box_max) * 0.5))
+		{
+			UWSIM_CHECK(v_is_visible[c]);
+			must_accept_count++;
+		}
+		else if(box_max.x < CAMERA.x || box_min.x > CAMERA.x + FAR_DISTANCE)
+		{
+			UWSIM_CHECK(!v_is_visible[c]);
+			must_reject_count++;
+		}
+	}
+
+	// both cases must actually come up
+	UWSIM_CHECK(must_accept_count > 0);
+	UWSIM_CHECK(must_reject_count > 0);
+}
+
+UWSIM_TEST(ViewFrustum_cullsFixedEntities)
+{
+	// enough entities that the hierarchy has several levels
+	const unsigned int FILLER_COUNT = 40;
+
+	vector<FixedEntity> v_entities;
+	vector<bool> v_is_expected;
+
+	v_entities.push_back(FixedEntity(Vector3( 10.0, 0.0,  0.0), 1.0));  // ahead
+	v_is_expected.push_back(true);
+	v_entities.push_back(FixedEntity(Vector3(-10.0, 0.0,  0.0), 1.0));  // behind
+	v_is_expected.push_back(false);
+	v_entities.push_back(FixedEntity(Vector3(100.0, 0.0,  0.0), 1.0));  // too far
+	v_is_expected.push_back(false);
+	v_entities.push_back(FixedEntity(Vector3( 10.0, 0.0, 20.0), 1.0));  // to the side
+	v_is_expected.push_back(false);
+	v_entities.push_back(FixedEntity(Vector3(-10.0, 0.0,  2.0), Vector3(10.0, 0.0, 2.0), 0.5));  // passes camera
+	v_is_expected.push_back(true);
+	v_entities.push_back(FixedEntity(Vector3(-20.0, 0.0,  0.0), Vector3(-10.0, 0.0, 0.0), 0.5));  // behind
+	v_is_expected.push_back(false);
+	v_entities.push_back(FixedEntity(Vector3( 20.0, 30.0, -5.0), Vector3(20.0, 30.0, 5.0), 0.5));  // above
+	v_is_expected.push_back(false);
+
+	for(unsigned int i = 0; i < FILLER_COUNT; i++)
+	{
+		double along = (double)(i) / FILLER_COUNT;
+		v_entities.push_back(FixedEntity(Vector3(5.0 + 40.0 * along, 0.0, 2.0 * along - 1.0), 0.5));
+		v_is_expected.push_back(true);
+		v_entities.push_back(FixedEntity(Vector3(-5.0 - 40.0 * along, 1.0, 3.0 * along), 0.5));
+		v_is_expected.push_back(false);
+	}
+
+	FixedEntityBvh bvh;
+	bvh.build(v_entities);
+	vector<unsigned int> v_indexes;
+	bvh.query(createFrustum(Vector3::ZERO), v_indexes);
+
+	vector<bool> v_is_found(v_entities.size(), false);
+	for(unsigned int i = 0; i < v_indexes.size(); i++)
+	{
+		UWSIM_CHECK(v_indexes[i] < v_entities.size());
+		if(v_indexes[i] < v_is_found.size())
+			v_is_found[v_indexes[i]] = true;
+	}
+	for(unsigned int e = 0; e < v_entities.size(); e++)
+		if(v_is_found[e] != v_is_expected[e])
+			TestHarness::reportFailure(__FILE__, __LINE__, "Fixed entity " + to_string(e) +
+			                           (v_is_expected[e] ? " was culled" : " was not culled"));
+
+	bvh.query(ViewFrustum(), v_indexes);
+	UWSIM_CHECK(v_indexes.size() == v_entities.size());
+}
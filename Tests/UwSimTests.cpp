@@ -0,0 +1,134 @@
+//
+//  UwSimTests.cpp
+//
+//  A command line tool to run the unit tests.
+//
+//  Usage: uwsim-tests [--filter text]
+//
+//  Only tests with text in their name are run if --filter is
+//    given.  The files are loaded from the Resources folder,
+//    so it must be run from the folder that contains it.  The
+//    exit status is 0 if every test passed and 1 otherwise.
+//
+
+#include <cassert>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+
+#include "TestHarness.h"
+
+using namespace std;
+
+namespace
+{
+	const string RESOURCE_PATH = "Resources/";
+
+	struct RegisteredTest
+	{
+		string m_name;
+		TestHarness::TestFunction mp_function;
+	};
+
+	//
+	//  getTests
+	//
+	//  Purpose: To retrieve the list of registered tests.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: The list.  It is created the first time this
+	//           function is called, so tests can be registered
+	//           during static initialization in any order.
+	//  Side Effect: N/A
+	//
+	vector<RegisteredTest>& getTests ()
+	{
+		// never freed, like the managers
+		static vector<RegisteredTest>* pv_tests = new vector<RegisteredTest>();
+		return *pv_tests;
+	}
+
+	unsigned int g_current_failure_count = 0;
+
+}  // end of anonymous namespace
+
+
+
+bool TestHarness :: addTest (const string& name,
+                             TestFunction p_function)
+{
+	assert(name != "");
+	assert(p_function != nullptr);
+
+	getTests().push_back({ name, p_function });
+	return true;
+}
+
+void TestHarness :: reportFailure (const char* filename,
+                                   unsigned int line,
+                                   const string& message)
+{
+	cerr << filename << ":" << line << ": Check failed: " << message << endl;
+	g_current_failure_count++;
+}
+
+unsigned int TestHarness :: runAll (const string& filter)
+{
+	unsigned int run_count    = 0;
+	unsigned int failed_count = 0;
+
+	const vector<RegisteredTest>& v_tests = getTests();
+	for(unsigned int i = 0; i < v_tests.size(); i++)
+	{
+		if(v_tests[i].m_name.find(filter) == string::npos)
+			continue;
+
+		cout << "[ RUN  ] " << v_tests[i].m_name << endl;
+		g_current_failure_count = 0;
+		v_tests[i].mp_function();
+		run_count++;
+
+		if(g_current_failure_count == 0)
+			cout << "[  OK  ] " << v_tests[i].m_name << endl;
+		else
+		{
+			cout << "[ FAIL ] " << v_tests[i].m_name << endl;
+			failed_count++;
+		}
+	}
+
+	cout << (run_count - failed_count) << " of " << run_count << " tests passed" << endl;
+	return failed_count;
+}
+
+
+
+int main (int argc, char* argv[])
+{
+	string filter;
+	for(int a = 1; a < argc; a++)
+	{
+		string argument = argv[a];
+		if(argument == "--filter" && a + 1 < argc)
+		{
+			a++;
+			filter = argv[a];
+		}
+		else
+		{
+			cerr << "Usage: " << argv[0] << " [--filter text]" << endl;
+			return 1;
+		}
+	}
+
+	if(!ifstream(RESOURCE_PATH + "map.txt"))
+	{
+		cerr << "Error: Could not find \"" << RESOURCE_PATH << "\" folder" << endl;
+		return 1;
+	}
+
+	if(TestHarness::runAll(filter) > 0)
+		return 1;
+	return 0;
+}
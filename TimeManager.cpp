@@ -5,7 +5,10 @@
 #include "TimeManager.h"
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include <chrono>
+#include <thread>
 
 #include "Sleep.h"
 
@@ -20,42 +23,32 @@ namespace
 
 	const float SMOOTH_FRACTION     = 0.05f;
 	const float SMOOTH_ANTIFRACTION = 1.0f - SMOOTH_FRACTION;
-}
 
+	// a frame may spend this many update periods catching up
+	const float CATCH_UP_BUDGET_UPDATES = 2.0f;
 
+	// the spin covers the average oversleep plus a few deviations
+	const duration<float> INITIAL_SLEEP_SLACK(0.001f);
+	const duration<float> MIN_SLEEP_SLACK(0.00005f);
+	const duration<float> MAX_SLEEP_SLACK(0.004f);
+	const float SLEEP_SLACK_DEVIATIONS = 3.0f;
+	const float SLEEP_SLACK_FRACTION   = 0.1f;
+}
 
-TimeManager :: TimeManager ()
-		: updates_per_second(UPDATES_PER_SECOND_DEFAULT),
-		  update_delta_time(1000000 / UPDATES_PER_SECOND_DEFAULT),
-		  max_updates_per_frame(MAX_UPDATES_PER_FRAME_DEFAULT),
-		//  start_time(),
 
-		  update_count(0),
-		//  last_update_time(),
-		//  last_update_duration(delta_time),
-		  smoothed_updates_per_second((float)(UPDATES_PER_SECOND_DEFAULT)),
-		//  next_update_time(),
 
-		  frame_count(0),
-		//  last_frame_time(),
-		//  last_frame_duration(delta_time),
-		  smoothed_frames_per_second((float)(UPDATES_PER_SECOND_DEFAULT))
+TimeManager :: TimeManager ()
+		: TimeManager(UPDATES_PER_SECOND_DEFAULT, MAX_UPDATES_PER_FRAME_DEFAULT)
 {
-	start_time = system_clock::now();
-	last_update_time = start_time;
-	last_update_duration = update_delta_time;
-	next_update_time = start_time;
-	last_frame_time = start_time;
-	last_frame_duration = update_delta_time;
-
 	assert(isInvariantTrue());
 }
 
 TimeManager :: TimeManager (int updates_per_second_in,
                             unsigned int max_updates_per_frame_in)
 		: updates_per_second(updates_per_second_in),
-		  update_delta_time(1000000 / updates_per_second_in),
+		  update_delta_time(1000000000 / updates_per_second_in),
 		  max_updates_per_frame(max_updates_per_frame_in),
+		  adaptive_max_updates_per_frame(max_updates_per_frame_in),
 		//  start_time(),
 
 		  update_count(0),
@@ -63,21 +56,39 @@ TimeManager :: TimeManager (int updates_per_second_in,
 		//  last_update_duration(delta_time),
 		  smoothed_updates_per_second((float)(updates_per_second_in)),
 		//  next_update_time(),
+		//  update_start_time(),
+		  smoothed_update_cost(0.0f),
+		  skipped_update_count(0),
 
+		  frames_per_second(0),
+		  frame_delta_time(0),
+		//  next_frame_time(),
 		  frame_count(0),
 		//  last_frame_time(),
 		//  last_frame_duration(delta_time),
-		  smoothed_frames_per_second((float)(updates_per_second_in))
+		  smoothed_frames_per_second((float)(updates_per_second_in)),
+		  frame_history_count(0),
+
+		  is_precise_pacing(true),
+		  sleep_slack_mean(INITIAL_SLEEP_SLACK),
+		  sleep_slack_deviation(0.0f)
 {
 	assert(updates_per_second_in > 0);
 	assert(max_updates_per_frame_in > 0);
 
-	start_time = system_clock::now();
+	start_time = steady_clock::now();
 	last_frame_time = start_time;
 	last_frame_duration = update_delta_time;
 	last_update_time = start_time;
 	last_update_duration = update_delta_time;
 	next_update_time = start_time;
+	update_start_time = start_time;
+	next_frame_time = start_time;
+	for(unsigned int i = 0; i < FRAME_HISTORY; i++)
+	{
+		frame_time_history[i]   = 0.0f;
+		frame_jitter_history[i] = 0.0f;
+	}
 
 	assert(isInvariantTrue());
 }
@@ -91,18 +102,18 @@ float TimeManager :: getUpdateDeltaTime () const
 
 unsigned int TimeManager :: getMaxUpdatesPerFrame () const
 {
-	return max_updates_per_frame;
+	return adaptive_max_updates_per_frame;
 }
 
 bool TimeManager :: isUpdateWaiting () const
 {
-	system_clock::time_point current_time = system_clock::now();
+	steady_clock::time_point current_time = steady_clock::now();
 	return next_update_time < current_time;
 }
 
 float TimeManager :: getGameDuration () const
 {
-	system_clock::time_point current_time = system_clock::now();
+	steady_clock::time_point current_time = steady_clock::now();
 	return duration<float>(current_time - start_time).count();
 }
 
@@ -152,22 +163,128 @@ float TimeManager :: getFrameRateSmoothed () const
 	return smoothed_frames_per_second;
 }
 
+int TimeManager :: getFrameRateTarget () const
+{
+	return frames_per_second;
+}
+
+bool TimeManager :: isFrameWaiting () const
+{
+	if(frames_per_second == 0)
+		return true;
+	return next_frame_time <= steady_clock::now();
+}
+
+float TimeManager :: getInterpolationAlpha () const
+{
+	// the latest update was for the start of the current period
+	steady_clock::time_point period_start = next_update_time - update_delta_time;
+	float alpha = duration<float>(steady_clock::now() - period_start) /
+	              duration<float>(update_delta_time);
+	if(alpha < 0.0f)
+		return 0.0f;
+	if(alpha > 1.0f)
+		return 1.0f;
+	return alpha;
+}
 
+float TimeManager :: getFrameTimePercentile (float fraction) const
+{
+	assert(fraction >= 0.0f && fraction <= 1.0f);
 
-void TimeManager :: sleepUntilNextUpdate () const
+	unsigned int count = frame_history_count;
+	if(count > FRAME_HISTORY)
+		count = FRAME_HISTORY;
+	return getPercentile(frame_time_history, count, fraction);
+}
+
+float TimeManager :: getFrameJitterPercentile (float fraction) const
 {
-	system_clock::time_point current_time = system_clock::now();
-	if(current_time < next_update_time)
+	assert(fraction >= 0.0f && fraction <= 1.0f);
+
+	// the first frame time recorded has no jitter
+	if(frame_history_count <= FRAME_HISTORY)
 	{
-		system_clock::duration sleep_time = next_update_time - current_time;
-		sleep(duration<double>(sleep_time).count());
+		if(frame_history_count <= 1)
+			return 0.0f;
+		return getPercentile(frame_jitter_history + 1, frame_history_count - 1, fraction);
 	}
+	return getPercentile(frame_jitter_history, FRAME_HISTORY, fraction);
+}
+
+float TimeManager :: getUpdateCostSmoothed () const
+{
+	return smoothed_update_cost.count() * 1000.0f;
+}
+
+float TimeManager :: getSleepSlack () const
+{
+	duration<float> slack = sleep_slack_mean + sleep_slack_deviation * SLEEP_SLACK_DEVIATIONS;
+	if(slack < MIN_SLEEP_SLACK)
+		slack = MIN_SLEEP_SLACK;
+	else if(slack > MAX_SLEEP_SLACK)
+		slack = MAX_SLEEP_SLACK;
+	return slack.count() * 1000.0f;
+}
+
+int TimeManager :: getSkippedUpdateCount () const
+{
+	return skipped_update_count;
+}
+
+bool TimeManager :: isPrecisePacing () const
+{
+	return is_precise_pacing;
+}
+
+
+
+void TimeManager :: setPrecisePacing (bool is_precise)
+{
+	is_precise_pacing = is_precise;
+}
+
+void TimeManager :: setFrameRate (int frames_per_second_in)
+{
+	assert(frames_per_second_in >= 0);
+
+	frames_per_second = frames_per_second_in;
+	if(frames_per_second_in > 0)
+		frame_delta_time = nanoseconds(1000000000 / frames_per_second_in);
+	else
+		frame_delta_time = nanoseconds(0);
+	next_frame_time = steady_clock::now();
+
+	assert(isInvariantTrue());
+}
+
+void TimeManager :: sleepUntilNextUpdate ()
+{
+	waitUntil(next_update_time);
+}
+
+void TimeManager :: sleepUntilNextFrame ()
+{
+	if(frames_per_second == 0 || next_update_time < next_frame_time)
+		waitUntil(next_update_time);
+	else
+		waitUntil(next_frame_time);
+}
+
+void TimeManager :: markUpdateStart ()
+{
+	// markNextUpdate times the update from here
+	update_start_time = steady_clock::now();
 }
 
 void TimeManager :: markNextUpdate ()
 {
 	update_count++;
-	system_clock::time_point current_time = system_clock::now();
+	steady_clock::time_point current_time = steady_clock::now();
+	duration<float> update_cost = current_time - update_start_time;
+	smoothed_update_cost = smoothed_update_cost * SMOOTH_ANTIFRACTION +
+	                       update_cost          * SMOOTH_FRACTION;
+
 	last_update_duration = current_time - last_update_time;
 	if(last_update_duration < MIN_SMOOTH_DURATION)
 		last_update_duration = MIN_SMOOTH_DURATION;
@@ -184,7 +301,19 @@ void TimeManager :: markNextUpdate ()
 void TimeManager :: markNextFrame ()
 {
 	frame_count++;
-	system_clock::time_point current_time = system_clock::now();
+	steady_clock::time_point current_time = steady_clock::now();
+
+	// pacing statistics use the frame time before it is clamped
+	float frame_ms = duration<float>(current_time - last_frame_time).count() * 1000.0f;
+	unsigned int slot = frame_history_count % FRAME_HISTORY;
+	frame_time_history[slot] = frame_ms;
+	if(frame_history_count > 0)
+	{
+		float previous_frame_ms = frame_time_history[(slot + FRAME_HISTORY - 1) % FRAME_HISTORY];
+		frame_jitter_history[slot] = fabs(frame_ms - previous_frame_ms);
+	}
+	frame_history_count++;
+
 	last_frame_duration = current_time - last_frame_time;
 	if(last_frame_duration < MIN_SMOOTH_DURATION)
 		last_frame_duration = MIN_SMOOTH_DURATION;
@@ -194,21 +323,116 @@ void TimeManager :: markNextFrame ()
 	smoothed_frames_per_second = SMOOTH_ANTIFRACTION * smoothed_frames_per_second +
 	                             SMOOTH_FRACTION     * instantaneous_frames_per_second;
 
+	// catch up with as many updates as fit in the budget, but at least 1
+	adaptive_max_updates_per_frame = max_updates_per_frame;
+	if(smoothed_update_cost.count() > 0.0f)
+	{
+		float fit = CATCH_UP_BUDGET_UPDATES * duration<float>(update_delta_time).count() /
+		            smoothed_update_cost.count();
+		if(fit < 1.0f)
+			adaptive_max_updates_per_frame = 1;
+		else if(fit < max_updates_per_frame)
+			adaptive_max_updates_per_frame = (unsigned int)(fit);
+	}
+
+	// keep the frame rate steady, but do not try to catch up missed frames
+	if(frames_per_second > 0)
+	{
+		next_frame_time += frame_delta_time;
+		if(next_frame_time < current_time)
+			next_frame_time = current_time;
+	}
+
+	// skip the updates that could not be caught up next frame
+	if(current_time > next_update_time)
+	{
+		long long behind = (current_time - next_update_time) / update_delta_time;
+		if(behind > adaptive_max_updates_per_frame)
+		{
+			long long skipped = behind - adaptive_max_updates_per_frame;
+			next_update_time += update_delta_time * skipped;
+			skipped_update_count += (int)(skipped);
+		}
+	}
+
 	assert(isInvariantTrue());
 }
 
 
 
+float TimeManager :: getPercentile (const float a_values[],
+                                    unsigned int count,
+                                    float fraction) const
+{
+	assert(a_values != NULL);
+	assert(fraction >= 0.0f && fraction <= 1.0f);
+
+	if(count == 0)
+		return 0.0f;
+
+	float a_sorted[FRAME_HISTORY];
+	assert(count <= FRAME_HISTORY);
+	copy(a_values, a_values + count, a_sorted);
+	unsigned int index = (unsigned int)(fraction * (count - 1) + 0.5f);
+	nth_element(a_sorted, a_sorted + index, a_sorted + count);
+	return a_sorted[index];
+}
+
+void TimeManager :: waitUntil (steady_clock::time_point wait_until_time)
+{
+	steady_clock::time_point current_time = steady_clock::now();
+	if(current_time >= wait_until_time)
+		return;
+
+	if(!is_precise_pacing)
+	{
+		steady_clock::duration sleep_time = wait_until_time - current_time;
+		sleep(duration<double>(sleep_time).count());
+		return;
+	}
+
+	// sleep for most of the wait, leaving time for the usual oversleep
+	duration<float> slack(getSleepSlack() / 1000.0f);
+	steady_clock::time_point wake_time = wait_until_time - duration_cast<steady_clock::duration>(slack);
+	if(current_time < wake_time)
+	{
+		sleep(duration<double>(wake_time - current_time).count());
+		updateSleepSlack(steady_clock::now() - wake_time);
+	}
+
+	// then spin for the rest, letting other threads run
+	while(steady_clock::now() < wait_until_time)
+		this_thread::yield();
+}
+
+void TimeManager :: updateSleepSlack (steady_clock::duration oversleep)
+{
+	duration<float> difference = duration<float>(oversleep) - sleep_slack_mean;
+	sleep_slack_mean += difference * SLEEP_SLACK_FRACTION;
+	sleep_slack_deviation = sleep_slack_deviation * (1.0f - SLEEP_SLACK_FRACTION) +
+	                        duration<float>(fabs(difference.count())) * SLEEP_SLACK_FRACTION;
+}
+
+
+
 bool TimeManager :: isInvariantTrue ()
 {
 	if(updates_per_second <= 0)
 		return false;
-	if(update_delta_time != microseconds(1000000 / updates_per_second))
+	if(update_delta_time != nanoseconds(1000000000 / updates_per_second))
 		return false;
 	if(duration<float>(update_delta_time).count() <= 0.0f)
 		return false;
 	if(max_updates_per_frame <= 0)
 		return false;
+	if(adaptive_max_updates_per_frame < 1)
+		return false;
+	if(adaptive_max_updates_per_frame > max_updates_per_frame)
+		return false;
+	if(frames_per_second < 0)
+		return false;
+	if(frames_per_second > 0 && frame_delta_time != nanoseconds(1000000000 / frames_per_second))
+		return false;
 
 	if(last_update_duration.count() <= 0)
 		return false;
@@ -219,6 +443,8 @@ bool TimeManager :: isInvariantTrue ()
 		return false;
 	if(frame_count < 0)
 		return false;
+	if(skipped_update_count < 0)
+		return false;
 	if(smoothed_updates_per_second <= 0)
 		return false;
 	if(smoothed_updates_per_second <= 0)
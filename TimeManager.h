@@ -1,6 +1,28 @@
 //
 //  TimeManager.h
 //
+//  All times are measured with steady_clock, which never jumps
+//    when the system clock is changed.
+//
+//  Pacing: sleepUntilNextUpdate sleeps for most of the wait and
+//    then spins for the rest, yielding the core between checks.
+//    The spin is kept as short as the measured oversleep of the
+//    operating system allows.  Precise pacing can be turned off
+//    to only sleep.
+//
+//  Catching up: getMaxUpdatesPerFrame is based on how long an
+//    update has taken recently, so slow updates do not make each
+//    frame even slower.  If the game falls further behind than
+//    one frame can catch up, the extra updates are skipped.
+//    An update is timed from markUpdateStart to markNextUpdate.
+//
+//  Frames: by default there is one frame after each round of
+//    updates.  setFrameRate sets a separate frame rate, so the
+//    game can be drawn more often than it is updated.  Between
+//    updates, getInterpolationAlpha says how far through the
+//    current update period the frame is, for drawing moving
+//    things between their previous and current states.
+//
 #pragma once
 
 #include <chrono>
@@ -26,29 +48,65 @@ public:
 	float getFrameRateInstantaneous () const;
 	float getUpdateRateSmoothed () const;
 	float getFrameRateSmoothed () const;
+	int getFrameRateTarget () const;  // 0 means one frame per update
+	bool isFrameWaiting () const;
+	float getInterpolationAlpha () const;
 
-	void sleepUntilNextUpdate () const;
+	// pacing statistics, in milliseconds over the last FRAME_HISTORY frames
+	float getFrameTimePercentile (float fraction) const;
+	float getFrameJitterPercentile (float fraction) const;
+	float getUpdateCostSmoothed () const;
+	float getSleepSlack () const;
+	int getSkippedUpdateCount () const;
+	bool isPrecisePacing () const;
+
+	void setPrecisePacing (bool is_precise);
+	void setFrameRate (int frames_per_second_in);
+	void sleepUntilNextUpdate ();
+	void sleepUntilNextFrame ();
+	void markUpdateStart ();
 	void markNextUpdate ();
 	void markNextFrame ();
 
+	static const unsigned int FRAME_HISTORY = 256;
+
 private:
+	float getPercentile (const float a_values[],
+	                     unsigned int count,
+	                     float fraction) const;
+	void waitUntil (std::chrono::steady_clock::time_point wait_until_time);
+	void updateSleepSlack (std::chrono::steady_clock::duration oversleep);
 	bool isInvariantTrue ();
 
 private:
 	int updates_per_second;
-	std::chrono::microseconds update_delta_time;
+	std::chrono::nanoseconds update_delta_time;
 	unsigned int max_updates_per_frame;
-	std::chrono::system_clock::time_point start_time;
+	unsigned int adaptive_max_updates_per_frame;
+	std::chrono::steady_clock::time_point start_time;
 
 	int update_count;
-	std::chrono::system_clock::time_point last_update_time;
+	std::chrono::steady_clock::time_point last_update_time;
 	std::chrono::duration<float> last_update_duration;
 	float smoothed_updates_per_second;
-	std::chrono::system_clock::time_point next_update_time;
+	std::chrono::steady_clock::time_point next_update_time;
+	std::chrono::steady_clock::time_point update_start_time;
+	std::chrono::duration<float> smoothed_update_cost;
+	int skipped_update_count;
 
+	int frames_per_second;
+	std::chrono::nanoseconds frame_delta_time;
+	std::chrono::steady_clock::time_point next_frame_time;
 	int frame_count;
-	std::chrono::system_clock::time_point last_frame_time;
+	std::chrono::steady_clock::time_point last_frame_time;
 	std::chrono::duration<float> last_frame_duration;
 	float smoothed_frames_per_second;
+	float frame_time_history[FRAME_HISTORY];    // milliseconds
+	float frame_jitter_history[FRAME_HISTORY];  // milliseconds
+	unsigned int frame_history_count;
+
+	bool is_precise_pacing;
+	std::chrono::duration<float> sleep_slack_mean;
+	std::chrono::duration<float> sleep_slack_deviation;
 };
 
@@ -0,0 +1,143 @@
+//
+//  SimplifyObj.cpp
+//
+//  A command line tool to write simplified versions of OBJ
+//    models for use as levels of detail.
+//
+//  Usage: SimplifyObj model.obj [ratio ...]
+//
+//  Each ratio is the fraction of triangles to keep, and
+//    defaults to 0.5 and 0.25.  The simplified models are saved
+//    next to the original with the names the game looks for
+//    (e.g. "rock-lod50.obj"), replacing any older versions.
+//
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+#include "../ObjLibrary/Vector3.h"
+#include "../ObjLibrary/ObjModel.h"
+#include "../ObjLibrary/MeshSimplifier.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const double DEFAULT_RATIOS[] = {	0.5, 0.25	};
+	const unsigned int DEFAULT_RATIO_COUNT = 2;
+
+	//
+	//  getFaceBox
+	//
+	//  Purpose: To determine the bounding box of the faces of a
+	//           model.
+	//  Parameter(s):
+	//    <1> model: The model
+	//    <2> r_min: The minimum corner of the box
+	//    <3> r_max: The maximum corner of the box
+	//  Precondition(s): N/A
+	//  Returns: Whether the model has any faces.
+	//  Side Effect: If the model has any faces, r_min and r_max
+	//               are set to the corners of the box around
+	//               their vertexes.
+	//
+	bool getFaceBox (const ObjModel& model,
+	                 Vector3& r_min,
+	                 Vector3& r_max)
+	{
+		bool is_any = false;
+		for(unsigned int m = 0; m < model.getMeshCount(); m++)
+			for(unsigned int f = 0; f < model.getFaceCount(m); f++)
+				for(unsigned int v = 0; v < model.getFaceVertexCount(m, f); v++)
+				{
+					const Vector3& position = model.getVertexPosition(model.getFaceVertexIndex(m, f, v));
+					if(!is_any)
+					{
+						r_min = position;
+						r_max = position;
+						is_any = true;
+					}
+					else
+					{
+						r_min.x = min(r_min.x, position.x);
+						r_min.y = min(r_min.y, position.y);
+						r_min.z = min(r_min.z, position.z);
+						r_max.x = max(r_max.x, position.x);
+						r_max.y = max(r_max.y, position.y);
+						r_max.z = max(r_max.z, position.z);
+					}
+				}
+		return is_any;
+	}
+
+}  // end of anonymous namespace
+
+
+
+int main (int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		cerr << "Usage: " << argv[0] << " model.obj [ratio ...]" << endl;
+		return 1;
+	}
+
+	string filename = argv[1];
+	vector<double> ratios;
+	for(int a = 2; a < argc; a++)
+	{
+		char* p_end;
+		double ratio = strtod(argv[a], &p_end);
+		if(*p_end != '\0' || !(ratio > 0.0 && ratio <= 1.0))
+		{
+			cerr << "Error: Invalid ratio \"" << argv[a] << "\" (must be in (0, 1])" << endl;
+			return 1;
+		}
+		ratios.push_back(ratio);
+	}
+	if(ratios.empty())
+		ratios.assign(DEFAULT_RATIOS, DEFAULT_RATIOS + DEFAULT_RATIO_COUNT);
+
+	ObjModel model(filename);
+	if(!model.isLoadedSuccessfully())
+	{
+		cerr << "Error: Could not load model \"" << filename << "\"" << endl;
+		return 1;
+	}
+
+	MeshSimplifier simplifier(model);
+	cout << filename << ": " << simplifier.getTriangleCount() << " triangles, "
+	     << simplifier.getPositionCount() << " positions ("
+	     << simplifier.getSeamPositionCount() << " on seams)" << endl;
+
+	Vector3 box_min;
+	Vector3 box_max;
+	getFaceBox(model, box_min, box_max);
+	double diagonal = box_min.getDistance(box_max);
+
+	vector<ObjModel> lods = simplifier.getSimplified(ratios);
+	assert(lods.size() == ratios.size());
+	for(unsigned int i = 0; i < lods.size(); i++)
+	{
+		lods[i].save();
+
+		// how far the bounding box moved, relative to its size
+		double drift = 0.0;
+		Vector3 lod_min;
+		Vector3 lod_max;
+		if(getFaceBox(lods[i], lod_min, lod_max) && diagonal > 0.0)
+			drift = max(lod_min.getDistance(box_min), lod_max.getDistance(box_max)) / diagonal;
+
+		cout << "  " << lods[i].getFileNameWithPath() << ": "
+		     << MeshSimplifier::getTriangleCount(lods[i]) << " triangles, "
+		     << "box drift " << fixed << setprecision(3) << drift << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1580 @@
+//
+//  UwSimBench.cpp
+//
+//  A command line tool to time the simulation and asset loading
+//    hot paths on their own, without a window.
+//
+//  Usage: uwsim-bench [--filter text] [--json results.json]
+//                     [--min-time seconds] [--repetitions count]
+//                     [--gl]
+//
+//  Each benchmark is run with each of its arguments, e.g.
+//    "FishSchool/AI/1000" updates the AI for a school of 1000
+//    fish.  Only benchmarks with text in their name are run if
+//    --filter is given.  Each one is run in batches that take at
+//    least the minimum time, and the median time per iteration
+//    over the batches is reported.  The results are written to
+//    the standard output stream as a table and, if --json is
+//    given, to a JSON file that Tools/compare_bench.py can
+//    compare against an earlier run.
+//
+//  The files are loaded from the Resources folder, and only
+//    files that are checked in are used.  The exception is a
+//    multi-megabyte OBJ file, which is bigger than any model
+//    the game ships, so it is generated in the temporary folder
+//    and deleted afterwards.  A benchmark that
+//    cannot set up, e.g. because a file will not load, fails
+//    instead of reporting a time, and the exit status is then 1.
+//    Unless --gl is given, no OpenGL functions are called, so
+//    this can run on a machine without a display or GPU, and
+//    the benchmarks that draw are skipped.  With --gl, a hidden
+//    window is created for its OpenGL context and they are run
+//    too.  Build it with NDEBUG defined, as for a release
+//    build, or the assertions are timed too.
+//
+
+#include <cassert>
+#include <cctype>
+#include <cstdio>	// for remove
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <filesystem>
+
+#include "../ObjLibrary/Vector3.h"
+#include "../ObjLibrary/ObjModel.h"
+#include "../ObjLibrary/ObjStringParsing.h"
+#include "../ObjLibrary/CompiledMesh.h"
+#include "../ObjLibrary/DisplayList.h"
+#include "../ObjLibrary/TextureBmp.h"
+#include "../ObjLibrary/Texture.h"
+#include "../ObjLibrary/TextureManager.h"
+
+#include "../RandomStream.h"
+#include "../Entity.h"
+#include "../FixedEntity.h"
+#include "../FixedEntityBvh.h"
+#include "../CoordinateSystem.h"
+#include "../ViewFrustum.h"
+#include "../Fish.h"
+#include "../FishSchool.h"
+#include "../FishArrays.h"
+#include "../FishKernels.h"
+#include "../Terrain.h"
+#include "../Collision.h"
+
+#include "../GetGlut.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const string RESOURCE_PATH = "Resources/";
+
+	const double       DEFAULT_MIN_SECONDS      = 0.05;
+	const unsigned int DEFAULT_REPETITION_COUNT = 5;
+
+	// the same terrain as in map.txt
+	const string  TERRAIN_HEIGHTS_TEXTURE = "heightmap.bmp";
+	const Vector3 TERRAIN_OFFSET(-64.0, -30.0, -64.0);
+	const Vector3 TERRAIN_SIZE  (128.0,  45.0, 128.0);
+
+	// the number of queries each iteration of the small benchmarks makes
+	const unsigned int QUERY_COUNT = 4096;
+
+	// the terrain queries are also timed over a set too big for the cache
+	const unsigned int LARGE_QUERY_COUNT = 100000;
+
+	// the number of copies of a model each draw benchmark draws
+	const unsigned int DRAW_COUNT = 100;
+
+	// the number of fish the kernel benchmarks update
+	const unsigned int KERNEL_FISH_COUNT = 10000;
+
+	// the game runs 60 updates per second
+	const float TICK_DELTA_TIME = 1.0f / 60.0f;
+
+	// results are added to this so the compiler cannot skip the work
+	volatile double g_sink = 0.0;
+
+	//
+	//  BenchmarkResult
+	//
+	//  A record to represent the timing of one benchmark with one
+	//    argument.
+	//
+	struct BenchmarkResult
+	{
+		string m_name;
+		unsigned long long m_iterations;  // per repetition
+		unsigned int m_repetitions;
+		double m_median_ns;  // per iteration
+		double m_min_ns;
+		double m_max_ns;
+		double m_items_per_second;
+	};
+
+	//
+	//  BenchmarkState
+	//
+	//  A class to pass the argument to a benchmark and time the
+	//    part of it that is measured.  The benchmark sets up
+	//    everything it needs and then calls run once with the
+	//    work for one iteration.
+	//
+	class BenchmarkState
+	{
+	public:
+		BenchmarkState (const string& argument,
+		                double min_seconds,
+		                unsigned int repetition_count)
+				: m_argument(argument),
+				  m_min_seconds(min_seconds),
+				  m_repetition_count(repetition_count),
+				  m_is_run(false),
+				  m_error("")
+		{
+			assert(min_seconds > 0.0);
+			assert(repetition_count >= 1);
+		}
+
+		const string& getArgument () const
+		{
+			return m_argument;
+		}
+
+		unsigned int getArgumentUnsigned () const
+		{
+			return (unsigned int)(strtoul(m_argument.c_str(), NULL, 10));
+		}
+
+		bool isRun () const
+		{
+			return m_is_run;
+		}
+
+		const BenchmarkResult& getResult () const
+		{
+			assert(isRun());
+			return m_result;
+		}
+
+		bool isFailed () const
+		{
+			return m_error != "";
+		}
+
+		const string& getError () const
+		{
+			assert(isFailed());
+			return m_error;
+		}
+
+		//
+		//  fail
+		//
+		//  Purpose: To mark the benchmark as failed, so that no
+		//           time is reported for it.
+		//  Parameter(s):
+		//    <1> error: A description of what went wrong
+		//  Precondition(s):
+		//    <1> !isRun()
+		//    <2> error != ""
+		//  Returns: N/A
+		//  Side Effect: This BenchmarkState is marked as failed.
+		//               The benchmark should return without
+		//               calling run.
+		//
+		void fail (const string& error)
+		{
+			assert(!isRun());
+			assert(error != "");
+
+			m_error = error;
+		}
+
+		//
+		//  run
+		//
+		//  Purpose: To time a piece of work.
+		//  Parameter(s):
+		//    <1> items_per_iteration: How many items one call to
+		//                             function handles, e.g. the
+		//                             number of fish
+		//    <2> function: The work for one iteration
+		//  Precondition(s):
+		//    <1> !isRun()
+		//  Returns: N/A
+		//  Side Effect: function is called repeatedly.  First,
+		//               the number of iterations is found that
+		//               takes at least the minimum time.  Then
+		//               that many iterations are timed the
+		//               specified number of times.  The result is
+		//               stored in this BenchmarkState.
+		//
+		template <typename Function>
+		void run (unsigned long long items_per_iteration,
+		          Function function)
+		{
+			assert(!isRun());
+
+			// the first batch also warms up the caches
+			unsigned long long iterations = 1;
+			double seconds = timeBatch(iterations, function);
+			while(seconds < m_min_seconds)
+			{
+				unsigned long long next = iterations * 10;
+				if(seconds > 0.0)
+				{
+					// aim a little past the minimum
+					double estimate = iterations * m_min_seconds * 1.2 / seconds;
+					if(estimate < next)
+						next = (unsigned long long)(estimate) + 1;
+				}
+				if(next <= iterations)
+					next = iterations + 1;
+				iterations = next;
+				seconds = timeBatch(iterations, function);
+			}
+
+			vector<double> v_ns;
+			for(unsigned int r = 0; r < m_repetition_count; r++)
+				v_ns.push_back(timeBatch(iterations, function) * 1.0e9 / iterations);
+			sort(v_ns.begin(), v_ns.end());
+
+			m_result.m_iterations  = iterations;
+			m_result.m_repetitions = m_repetition_count;
+			if(v_ns.size() % 2 == 1)
+				m_result.m_median_ns = v_ns[v_ns.size() / 2];
+			else
+				m_result.m_median_ns = (v_ns[v_ns.size() / 2 - 1] + v_ns[v_ns.size() / 2]) * 0.5;
+			m_result.m_min_ns = v_ns.front();
+			m_result.m_max_ns = v_ns.back();
+			m_result.m_items_per_second = 0.0;
+			if(m_result.m_median_ns > 0.0)
+				m_result.m_items_per_second = items_per_iteration * 1.0e9 / m_result.m_median_ns;
+			m_is_run = true;
+		}
+
+	private:
+		template <typename Function>
+		static double timeBatch (unsigned long long iterations,
+		                         Function& r_function)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for(unsigned long long i = 0; i < iterations; i++)
+				r_function();
+			chrono::duration<double> duration = chrono::steady_clock::now() - start;
+			return duration.count();
+		}
+
+	private:
+		string m_argument;
+		double m_min_seconds;
+		unsigned int m_repetition_count;
+		bool m_is_run;
+		string m_error;
+		BenchmarkResult m_result;
+	};
+
+	//
+	//  Benchmark
+	//
+	//  A record to represent a benchmark and the arguments to run
+	//    it with.  A benchmark with no arguments is run once, and
+	//    its name is not given a suffix.  A benchmark that uses
+	//    OpenGL is only run if there is a context.
+	//
+	struct Benchmark
+	{
+		string m_name;
+		vector<string> mv_arguments;
+		void (*mp_function) (BenchmarkState& r_state);
+		bool m_is_opengl = false;
+	};
+
+
+
+	//
+	//  Fixtures shared by more than one benchmark
+	//
+
+	//
+	//  getTerrain
+	//
+	//  Purpose: To retrieve the terrain from map.txt.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: The terrain.  It is loaded the first time this
+	//           function is called and then reused.
+	//  Side Effect: N/A
+	//
+	const Terrain& getTerrain ()
+	{
+		// never freed, like the managers
+		static const Terrain* p_terrain = new Terrain(RESOURCE_PATH, TERRAIN_HEIGHTS_TEXTURE,
+		                                              "dirt2.bmp", "grass1.bmp",
+		                                              TERRAIN_OFFSET, TERRAIN_SIZE);
+		return *p_terrain;
+	}
+
+	//
+	//  getRandomPoints
+	//
+	//  Purpose: To generate the same random positions every run.
+	//  Parameter(s):
+	//    <1> count: The number of positions
+	//    <2> minimum: The lowest corner of the box to generate
+	//                 positions in
+	//    <3> size: The size of the box to generate positions in
+	//    <4> stream: The random stream number
+	//  Precondition(s): N/A
+	//  Returns: count positions spread evenly through the box.
+	//  Side Effect: N/A
+	//
+	vector<Vector3> getRandomPoints (unsigned int count,
+	                                 const Vector3& minimum,
+	                                 const Vector3& size,
+	                                 unsigned long long stream)
+	{
+		RandomStream random(1, stream);
+		vector<Vector3> v_points(count);
+		for(unsigned int i = 0; i < count; i++)
+		{
+			v_points[i].x = minimum.x + random.getDouble() * size.x;
+			v_points[i].y = minimum.y + random.getDouble() * size.y;
+			v_points[i].z = minimum.z + random.getDouble() * size.z;
+		}
+		return v_points;
+	}
+
+	//
+	//  createFishSchool
+	//
+	//  Purpose: To create a school of the specified size.
+	//  Parameter(s):
+	//    <1> fish_count: The number of fish
+	//  Precondition(s): N/A
+	//  Returns: A school of anchovies with fish_count fish, as
+	//           tightly packed as the first school in map.txt.
+	//  Side Effect: N/A
+	//
+	FishSchool createFishSchool (unsigned int fish_count)
+	{
+		double radius = 0.8 * cbrt(fish_count / 100.0);
+		if(radius <= 0.0)
+			radius = 0.8;
+		unsigned int species = Fish::getSpeciesForFilename("anchovy.obj");
+		assert(species < Fish::SPECIES_COUNT);
+		FishSchool school(Vector3(-32.0, -2.0, 1.0), radius, fish_count, species,
+		                  5.0, RandomStream(1, fish_count));
+		school.updateAggregates();
+		school.calculateNearestNeighbour();
+		return school;
+	}
+
+	//
+	//  createFishArrays
+	//
+	//  Purpose: To create fish to run the kernels on directly.
+	//  Parameter(s):
+	//    <1> fish_count: The number of fish
+	//  Precondition(s): N/A
+	//  Returns: fish_count moving fish in an 8 m box.  The
+	//           neighbours of each fish are the fish after it,
+	//           which is not realistic, but the kernels do the
+	//           same work for any neighbours.
+	//  Side Effect: N/A
+	//
+	FishArrays createFishArrays (unsigned int fish_count)
+
+	{
+		const Vector3 BOX_MINIMUM(-4.0, -4.0, -4.0);
+		const Vector3 BOX_SIZE   ( 8.0,  8.0,  8.0);
+		const Vector3 VELOCITY_MINIMUM(-1.0, -1.0, -1.0);
+		const Vector3 VELOCITY_SIZE   ( 2.0,  2.0,  2.0);
+
+		vector<Vector3> v_positions  = getRandomPoints(fish_count, BOX_MINIMUM, BOX_SIZE, 5);
+		vector<Vector3> v_velocities = getRandomPoints(fish_count, VELOCITY_MINIMUM, VELOCITY_SIZE, 6);
+		FishArrays fish;
+		fish.reserve(fish_count);
+		for(unsigned int i = 0; i < fish_count; i++)
+			fish.add(v_positions[i], v_velocities[i], v_velocities[i].getNormalizedSafe());
+		fish.storePrevious();
+		for(unsigned int i = 0; i < fish_count; i++)
+			for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+				fish.mv_neighbours[i * Fish::NEIGHBOUR_COUNT + n] = (i + n + 1) % fish_count;
+		return fish;
+	}
+
+	//
+	//  createFishVector
+	//
+	//  Purpose: To create the same fish as createFishArrays, but
+	//           stored as Fish objects, as FishSchool stored them
+	//           before the kernels.
+	//  Parameter(s):
+	//    <1> fish_count: The number of fish
+	//  Precondition(s): N/A
+	//  Returns: fish_count anchovies with the same positions,
+	//           velocities, forward vectors, and neighbours as
+	//           createFishArrays(fish_count) gives.
+	//  Side Effect: N/A
+	//
+	vector<Fish> createFishVector (unsigned int fish_count)
+	{
+		FishArrays fish = createFishArrays(fish_count);
+		unsigned int species = Fish::getSpeciesForFilename("anchovy.obj");
+		assert(species < Fish::SPECIES_COUNT);
+
+		vector<Fish> v_fish;
+		v_fish.reserve(fish_count);
+		for(unsigned int i = 0; i < fish_count; i++)
+		{
+			v_fish.push_back(Fish(fish.getPosition(i), fish.getForward(i), species));
+			v_fish[i].setVelocity(fish.getVelocity(i));
+			for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+				v_fish[i].fishNeighbour[n] = fish.getNeighbour(i, n);
+		}
+		return v_fish;
+	}
+
+	//
+	//  steerFishBaseline
+	//
+	//  Purpose: To update the velocity of one fish the way
+	//           FishSchool::AIUpdateForFish did before the
+	//           kernels, to compare FishKernels::steerAll with.
+	//  Parameter(s):
+	//    <1> rv_fish: The fish
+	//    <2> i: The index of the fish to update
+	//    <3> target: The position to seek
+	//    <4> max_speed: The maximum fish speed
+	//    <5> max_acceleration: The maximum fish acceleration
+	//    <6> separation_distance: The distance at which the
+	//                             separation force falls to 0
+	//    <7> separation_cutoff: Neighbours farther away than this
+	//                           are ignored
+	//    <8> delta_time: The duration of the update
+	//  Precondition(s):
+	//    <1> i < rv_fish.size()
+	//  Returns: N/A
+	//  Side Effect: The velocity of fish i is changed as by
+	//               steerAll.  The old code also recalculated
+	//               the bounding sphere of the whole school after
+	//               every fish, which made an update take
+	//               quadratic time; that is left out, so only the
+	//               per-fish work is compared.
+	//
+	void steerFishBaseline (vector<Fish>& rv_fish,
+	                        unsigned int i,
+	                        const Vector3& target,
+	                        double max_speed,
+	                        double max_acceleration,
+	                        double separation_distance,
+	                        double separation_cutoff,
+	                        float delta_time)
+	{
+		assert(i < rv_fish.size());
+
+		Vector3 separation(0.0, 0.0, 0.0);
+		for(unsigned int n = 0; n < Fish::NEIGHBOUR_COUNT; n++)
+		{
+			unsigned int neighbour = rv_fish[i].fishNeighbour[n];
+			if(neighbour >= rv_fish.size())
+				continue;
+
+			Vector3 difference = rv_fish[i].getPosition() - rv_fish[neighbour].getPosition();
+			double distance = difference.getNorm();
+			if(distance > separation_cutoff)
+				continue;
+			double closeness = 1.0 - (distance / separation_distance);
+			separation += difference * (closeness * closeness * max_speed);
+		}
+
+		Vector3 desired = (target - rv_fish[i].getPosition()).getTruncated(max_speed) + (3.0 * separation);
+		desired.truncate(max_speed);
+		Vector3 change = desired - rv_fish[i].getVelocity();
+		change.truncate(max_acceleration * delta_time);
+		rv_fish[i].setVelocity(rv_fish[i].getVelocity() + change);
+	}
+
+	//
+	//  createFixedEntities
+	//
+	//  Purpose: To create fixed entities spread over the terrain.
+	//  Parameter(s):
+	//    <1> entity_count: The number of fixed entities
+	//  Precondition(s): N/A
+	//  Returns: entity_count fixed entities inside the terrain
+	//           box.  Half are spheres and half are cylinders,
+	//           with radii from 0.5 to 2.0, about the sizes of
+	//           the rocks and pipes in map.txt.
+	//  Side Effect: N/A
+	//
+	vector<FixedEntity> createFixedEntities (unsigned int entity_count)
+	{
+		vector<Vector3> v_centers = getRandomPoints(entity_count, TERRAIN_OFFSET, TERRAIN_SIZE, 7);
+		vector<Vector3> v_axes    = getRandomPoints(entity_count, Vector3(-2.0, -2.0, -2.0),
+		                                            Vector3(4.0, 4.0, 4.0), 8);
+		vector<FixedEntity> v_entities;
+		v_entities.reserve(entity_count);
+		for(unsigned int i = 0; i < entity_count; i++)
+		{
+			double radius = 0.5 + 1.5 * (i % 16) / 15.0;
+			if(i % 2 == 0)
+				v_entities.push_back(FixedEntity(v_centers[i], radius));
+			else
+				v_entities.push_back(FixedEntity(v_centers[i] - v_axes[i], v_centers[i] + v_axes[i], radius));
+		}
+		return v_entities;
+	}
+
+	//
+	//  createQueryEntities
+	//
+	//  Purpose: To create entities to test for collisions with
+	//           the fixed entities.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: QUERY_COUNT entities the size of the player
+	//           inside the terrain box.
+	//  Side Effect: N/A
+	//
+	vector<Entity> createQueryEntities ()
+	{
+		vector<Vector3> v_centers = getRandomPoints(QUERY_COUNT, TERRAIN_OFFSET, TERRAIN_SIZE, 9);
+		vector<Entity> v_queries;
+		v_queries.reserve(QUERY_COUNT);
+		for(unsigned int i = 0; i < QUERY_COUNT; i++)
+			v_queries.push_back(Entity(v_centers[i], 1.0));
+		return v_queries;
+	}
+
+	//
+	//  getBenchTextureName
+	//
+	//  Purpose: To determine the name a texture is registered
+	//           under by registerBenchTextures.
+	//  Parameter(s):
+	//    <1> index: Which texture
+	//  Precondition(s): N/A
+	//  Returns: The name, in the mixed case a material library
+	//           might use.
+	//  Side Effect: N/A
+	//
+	string getBenchTextureName (unsigned int index)
+	{
+		return "Bench/Textures/Coral_" + to_string(index) + ".bmp";
+	}
+
+	//
+	//  registerBenchTextures
+	//
+	//  Purpose: To make sure the TextureManager holds at least the
+	//           specified number of textures.
+	//  Parameter(s):
+	//    <1> texture_count: The number of textures
+	//  Precondition(s):
+	//    <1> Texture::isGlutInitialized()
+	//  Returns: N/A
+	//  Side Effect: Textures named by getBenchTextureName are
+	//               added to the TextureManager until there are
+	//               texture_count of them.  They are given
+	//               placeholder OpenGL names and are never bound,
+	//               so no context is needed.  They are kept until
+	//               the program ends, because materials loaded by
+	//               other benchmarks hold pointers into the
+	//               TextureManager and must not see it unloaded.
+	//
+	void registerBenchTextures (unsigned int texture_count)
+	{
+		assert(Texture::isGlutInitialized());
+
+		static unsigned int registered_count = 0;
+		for(; registered_count < texture_count; registered_count++)
+			TextureManager::add(registered_count + 1, getBenchTextureName(registered_count));
+	}
+
+	//
+	//  writeGridObj
+	//
+	//  Purpose: To write an OBJ file for a big height field, as
+	//           an exporter might.
+	//  Parameter(s):
+	//    <1> filename: The name of the file to write
+	//    <2> cell_count: The number of cells along each side
+	//  Precondition(s):
+	//    <1> cell_count >= 1
+	//  Returns: The size of the file in bytes, or 0 if it could
+	//           not be written.
+	//  Side Effect: File filename is written.  It has a vertex,
+	//               texture coordinate, and normal at each corner
+	//               and a quad for each cell, with every index
+	//               given.  The values have 6 decimal places.
+	//               With 300 cells, the file is about 14 MB.
+	//
+	unsigned long long writeGridObj (const string& filename,
+	                                 unsigned int cell_count)
+	{
+		assert(cell_count >= 1);
+
+		unsigned int side = cell_count + 1;
+		RandomStream random(1, cell_count);
+
+		ofstream fout(filename);
+		if(!fout)
+			return 0;
+		fout << fixed << setprecision(6);
+		fout << "# " << cell_count << " x " << cell_count << " height field" << endl;
+		for(unsigned int z = 0; z < side; z++)
+			for(unsigned int x = 0; x < side; x++)
+				fout << "v " << (x * 10.0 / cell_count - 5.0) << " " << (random.getDouble() * 0.5)
+				     << " " << (z * 10.0 / cell_count - 5.0) << "\n";
+		for(unsigned int z = 0; z < side; z++)
+			for(unsigned int x = 0; x < side; x++)
+				fout << "vt " << (double)(x) / cell_count << " " << (double)(z) / cell_count << "\n";
+		for(unsigned int i = 0; i < side * side; i++)
+		{
+			Vector3 normal = Vector3(random.getDouble() - 0.5, 4.0, random.getDouble() - 0.5).getNormalized();
+			fout << "vn " << normal.x << " " << normal.y << " " << normal.z << "\n";
+		}
+		for(unsigned int z = 0; z < cell_count; z++)
+			for(unsigned int x = 0; x < cell_count; x++)
+			{
+				unsigned int a_corners[4] = { z * side + x + 1,       (z + 1) * side + x + 1,
+				                              (z + 1) * side + x + 2, z * side + x + 2 };
+				fout << "f";
+				for(unsigned int c = 0; c < 4; c++)
+					fout << " " << a_corners[c] << "/" << a_corners[c] << "/" << a_corners[c];
+				fout << "\n";
+			}
+
+		unsigned long long size = (unsigned long long)(fout.tellp());
+		fout.close();
+		if(!fout)
+			return 0;
+		return size;
+	}
+
+	//
+	//  readReferenceNumbers
+	//
+	//  Purpose: To read numbers from a line the way ObjModel did
+	//           before it parsed files in place.
+	//  Parameter(s):
+	//    <1> str: The rest of the line, after the element type
+	//    <2> count: The number of numbers to read
+	//    <3> a_values: The array to write the numbers to
+	//  Precondition(s):
+	//    <1> a_values has room for count values
+	//  Returns: Whether there were count numbers.
+	//  Side Effect: The numbers are written to a_values.
+	//
+	bool readReferenceNumbers (const string& str,
+	                           unsigned int count,
+	                           double a_values[])
+	{
+		size_t index = 0;
+		if(str.empty() || isspace(str[0]))
+			index = ObjStringParsing::nextToken(str, 0);
+		for(unsigned int i = 0; i < count; i++)
+		{
+			if(index == string::npos)
+				return false;
+			a_values[i] = atof(str.c_str() + index);
+			index = ObjStringParsing::nextToken(str, index);
+		}
+		return true;
+	}
+
+	//
+	//  loadObjReference
+	//
+	//  Purpose: To load an OBJ file the way ObjModel::load did
+	//           before it parsed files in place, as a baseline
+	//           for the loadGenerated benchmarks.
+	//  Parameter(s):
+	//    <1> filename: The name of the file to load
+	//    <2> r_model: The ObjModel to load into
+	//  Precondition(s): N/A
+	//  Returns: Whether the file could be read.
+	//  Side Effect: r_model is replaced with the vertexes,
+	//               texture coordinates, normals, and faces in
+	//               file filename.  Each line is read with
+	//               getline, copied with whitespaceToSpaces, cut
+	//               with substr, and parsed with atof and atoi,
+	//               as the old loader did.  Only the elements
+	//               writeGridObj writes are understood, and the
+	//               indexes must be positive.
+	//
+	bool loadObjReference (const string& filename,
+	                       ObjModel& r_model)
+	{
+		ifstream fin(filename);
+		if(!fin)
+			return false;
+
+		r_model.makeEmpty();
+		unsigned int mesh = r_model.addMesh();
+		string line;
+		while(getline(fin, line))
+		{
+			if(line.empty() || line[0] == '#' || line[0] == '\r')
+				continue;
+			line = ObjStringParsing::whitespaceToSpaces(line);
+
+			double a_values[3];
+			if(ObjStringParsing::startsWith(line, "v "))
+			{
+				if(!readReferenceNumbers(line.substr(2), 3, a_values))
+					return false;
+				r_model.addVertex(a_values[0], a_values[1], a_values[2]);
+			}
+			else if(ObjStringParsing::startsWith(line, "vt "))
+			{
+				if(!readReferenceNumbers(line.substr(3), 2, a_values))
+					return false;
+				r_model.addTextureCoordinate(a_values[0], a_values[1]);
+			}
+			else if(ObjStringParsing::startsWith(line, "vn "))
+			{
+				if(!readReferenceNumbers(line.substr(3), 3, a_values))
+					return false;
+				r_model.addNormal(a_values[0], a_values[1], a_values[2]);
+			}
+			else if(ObjStringParsing::startsWith(line, "f "))
+			{
+				string str = line.substr(2);
+				unsigned int face = r_model.addFace(mesh);
+				for(size_t token = 0; token != string::npos; token = ObjStringParsing::nextToken(str, token))
+				{
+					unsigned int vertex              = atoi(str.c_str() + token) - 1;
+					unsigned int texture_coordinates = ObjModel::NO_TEXTURE_COORDINATES;
+					unsigned int normal              = ObjModel::NO_NORMAL;
+
+					size_t slash = ObjStringParsing::nextSlashInToken(str, token);
+					if(slash != string::npos)
+					{
+						slash++;
+						if(str[slash] != '/')
+							texture_coordinates = atoi(str.c_str() + slash) - 1;
+						slash = ObjStringParsing::nextSlashInToken(str, slash);
+						if(slash != string::npos)
+							normal = atoi(str.c_str() + slash + 1) - 1;
+					}
+					r_model.addFaceVertex(mesh, face, vertex, texture_coordinates, normal);
+				}
+			}
+			else
+				return false;
+		}
+		r_model.validate(false);
+		return true;
+	}
+
+
+
+	//
+	//  Benchmarks
+	//
+	//  Each takes the state to run with, sets up, and calls
+	//    r_state.run with the work to time.
+	//
+
+	void benchmarkFishSchoolAI (BenchmarkState& r_state)
+	{
+		unsigned int fish_count = r_state.getArgumentUnsigned();
+		FishSchool school = createFishSchool(fish_count);
+		r_state.run(fish_count, [&] ()
+		{
+			school.AIUpdateFlockLeader(TICK_DELTA_TIME);
+			school.AIUpdateFishSchool(TICK_DELTA_TIME);
+		});
+		g_sink = g_sink + school.getAggregates().m_count;
+	}
+
+	void benchmarkFishSchoolNearestNeighbour (BenchmarkState& r_state)
+	{
+		unsigned int fish_count = r_state.getArgumentUnsigned();
+		FishSchool school = createFishSchool(fish_count);
+		r_state.run(fish_count, [&] ()
+		{
+			school.calculateNearestNeighbour();
+		});
+		g_sink = g_sink + school.getAggregates().m_count;
+	}
+
+	void benchmarkFishSchoolNearestNeighbourBruteForce (BenchmarkState& r_state)
+	{
+		// the reference search, to compare with the grid
+		unsigned int fish_count = r_state.getArgumentUnsigned();
+		FishSchool school = createFishSchool(fish_count);
+		r_state.run(fish_count, [&] ()
+		{
+			school.calculateNearestNeighbourBruteForce();
+		});
+		g_sink = g_sink + school.getAggregates().m_count;
+	}
+
+	void benchmarkFishKernelsUpdate (BenchmarkState& r_state)
+	{
+		// "simd" or "scalar"
+		bool is_simd = (r_state.getArgument() == "simd");
+		bool was_simd = FishKernels::isSimdEnabled();
+		FishArrays fish = createFishArrays(KERNEL_FISH_COUNT);
+
+		FishKernels::setSimdEnabled(is_simd);
+		r_state.run(KERNEL_FISH_COUNT, [&] ()
+		{
+			FishKernels::steerAll(fish, Vector3::ZERO, 3.0, 1.5, 0.5, 1.0, TICK_DELTA_TIME);
+			FishKernels::applyGravityAll(fish, TICK_DELTA_TIME);
+			FishKernels::moveAllByVelocity(fish, TICK_DELTA_TIME);
+			FishKernels::updateForwardAll(fish);
+		});
+		FishKernels::setSimdEnabled(was_simd);
+		g_sink = g_sink + fish.mv_position_x[0];
+	}
+
+	void benchmarkFishKernelsUpdateBaseline (BenchmarkState& r_state)
+	{
+		// the same update on Fish objects, as before the kernels
+		vector<Fish> v_fish = createFishVector(KERNEL_FISH_COUNT);
+		r_state.run(KERNEL_FISH_COUNT, [&] ()
+		{
+			for(unsigned int i = 0; i < v_fish.size(); i++)
+				steerFishBaseline(v_fish, i, Vector3::ZERO, 3.0, 1.5, 0.5, 1.0, TICK_DELTA_TIME);
+			for(unsigned int i = 0; i < v_fish.size(); i++)
+				if(v_fish[i].getPosition().y > 0)
+					v_fish[i].applyGravity(TICK_DELTA_TIME);
+			for(unsigned int i = 0; i < v_fish.size(); i++)
+				v_fish[i].moveByVelocity(TICK_DELTA_TIME);
+			for(unsigned int i = 0; i < v_fish.size(); i++)
+				if(!v_fish[i].getVelocity().isZero())
+					v_fish[i].setOrientation(v_fish[i].getVelocity().getNormalized());
+		});
+		g_sink = g_sink + v_fish[0].getPosition().x;
+	}
+
+	void benchmarkFishKernelsPackInstanceMatrices (BenchmarkState& r_state)
+	{
+		// "simd" or "scalar"
+		bool is_simd = (r_state.getArgument() == "simd");
+		bool was_simd = FishKernels::isSimdEnabled();
+		FishArrays fish = createFishArrays(KERNEL_FISH_COUNT);
+		vector<float> v_matrices(KERNEL_FISH_COUNT * FishKernels::MATRIX_SIZE);
+
+		FishKernels::setSimdEnabled(is_simd);
+		r_state.run(KERNEL_FISH_COUNT, [&] ()
+		{
+			FishKernels::packInstanceMatricesAll(fish, 0.25, 0.5f, v_matrices.data());
+		});
+		FishKernels::setSimdEnabled(was_simd);
+		g_sink = g_sink + v_matrices[0];
+	}
+
+	void benchmarkFixedEntityBvhQuery (BenchmarkState& r_state)
+	{
+		// items are queries the size of the player
+		unsigned int entity_count = r_state.getArgumentUnsigned();
+		vector<FixedEntity> v_entities = createFixedEntities(entity_count);
+		FixedEntityBvh bvh;
+		bvh.build(v_entities);
+		vector<Entity> v_queries = createQueryEntities();
+		vector<unsigned int> v_indexes;
+		unsigned int hit_count = 0;
+
+		r_state.run(QUERY_COUNT, [&] ()
+		{
+			for(unsigned int i = 0; i < QUERY_COUNT; i++)
+			{
+				bvh.query(v_queries[i].getPosition(), v_queries[i].getRadius(), v_indexes);
+				for(unsigned int j = 0; j < v_indexes.size(); j++)
+					if(isCollision(v_queries[i], v_entities[v_indexes[j]]))
+						hit_count++;
+			}
+		});
+		g_sink = g_sink + hit_count;
+	}
+
+	void benchmarkFixedEntityLinearQuery (BenchmarkState& r_state)
+	{
+		// the same queries without the hierarchy, as before it
+		unsigned int entity_count = r_state.getArgumentUnsigned();
+		vector<FixedEntity> v_entities = createFixedEntities(entity_count);
+		vector<Entity> v_queries = createQueryEntities();
+		unsigned int hit_count = 0;
+
+		r_state.run(QUERY_COUNT, [&] ()
+		{
+			for(unsigned int i = 0; i < QUERY_COUNT; i++)
+				for(unsigned int j = 0; j < v_entities.size(); j++)
+					if(isCollision(v_queries[i], v_entities[j]))
+						hit_count++;
+		});
+		g_sink = g_sink + hit_count;
+	}
+
+	void benchmarkFixedEntityBvhFrustumQuery (BenchmarkState& r_state)
+	{
+		// items are frustums, looking across the terrain
+		unsigned int entity_count = r_state.getArgumentUnsigned();
+		vector<FixedEntity> v_entities = createFixedEntities(entity_count);
+		FixedEntityBvh bvh;
+		bvh.build(v_entities);
+		CoordinateSystem camera(Vector3(-40.0, -5.0, 0.0), Vector3(1.0, -0.1, 0.2).getNormalized());
+		ViewFrustum frustum(camera, 60.0, 4.0 / 3.0, 0.1, 60.0);
+		vector<unsigned int> v_indexes;
+
+		r_state.run(1, [&] ()
+		{
+			bvh.query(frustum, v_indexes);
+		});
+		g_sink = g_sink + v_indexes.size();
+	}
+
+	void benchmarkCollision (BenchmarkState& r_state)
+	{
+		// about half of the tests are hits
+		const Vector3 AREA_MINIMUM(-4.0, -4.0, -4.0);
+		const Vector3 AREA_SIZE   ( 8.0,  8.0,  8.0);
+		const string& shape = r_state.getArgument();
+
+		vector<Vector3> v_centers = getRandomPoints(QUERY_COUNT, AREA_MINIMUM, AREA_SIZE, 1);
+		vector<Entity> v_entities;
+		for(unsigned int i = 0; i < QUERY_COUNT; i++)
+			v_entities.push_back(Entity(v_centers[i], 0.5));
+
+		Entity other_entity(Vector3::ZERO, 3.0);
+		FixedEntity sphere(Vector3::ZERO, 3.0);
+		FixedEntity cylinder(Vector3(-4.0, -1.0, 0.0), Vector3(4.0, 1.0, 0.0), 2.5);
+		unsigned int hit_count = 0;
+
+		if(shape == "entity")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					if(isCollision(v_entities[i], other_entity))
+						hit_count++;
+			});
+		}
+		else if(shape == "sphere")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					if(isCollision(v_entities[i], sphere))
+						hit_count++;
+			});
+		}
+		else if(shape == "cylinder")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					if(isCollision(v_entities[i], cylinder))
+						hit_count++;
+			});
+		}
+		else if(shape == "terrain")
+		{
+			const Terrain& terrain = getTerrain();
+			vector<Vector3> v_positions = getRandomPoints(QUERY_COUNT, TERRAIN_OFFSET, TERRAIN_SIZE, 2);
+			for(unsigned int i = 0; i < QUERY_COUNT; i++)
+				v_entities[i] = Entity(v_positions[i], 0.5);
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					if(isCollision(v_entities[i], terrain))
+						hit_count++;
+			});
+		}
+		g_sink = g_sink + hit_count;
+	}
+
+	void benchmarkTerrainGetHeight (BenchmarkState& r_state)
+	{
+		unsigned int query_count = r_state.getArgumentUnsigned();
+		const Terrain& terrain = getTerrain();
+		vector<Vector3> v_positions = getRandomPoints(query_count, TERRAIN_OFFSET, TERRAIN_SIZE, 3);
+		r_state.run(query_count, [&] ()
+		{
+			double total = 0.0;
+			for(unsigned int i = 0; i < query_count; i++)
+				total += terrain.getHeight(v_positions[i]);
+			g_sink = g_sink + total;
+		});
+	}
+
+	void benchmarkTerrainGetHeights (BenchmarkState& r_state)
+	{
+		unsigned int query_count = r_state.getArgumentUnsigned();
+		const Terrain& terrain = getTerrain();
+		vector<Vector3> v_positions = getRandomPoints(query_count, TERRAIN_OFFSET, TERRAIN_SIZE, 3);
+		vector<double> v_x(query_count);
+		vector<double> v_z(query_count);
+		vector<double> v_heights(query_count);
+		for(unsigned int i = 0; i < query_count; i++)
+		{
+			v_x[i] = v_positions[i].x;
+			v_z[i] = v_positions[i].z;
+		}
+		r_state.run(query_count, [&] ()
+		{
+			terrain.getHeights(query_count, v_x.data(), v_z.data(), v_heights.data());
+			g_sink = g_sink + v_heights[0];
+		});
+	}
+
+	void benchmarkTerrainGetSurfaceNormal (BenchmarkState& r_state)
+	{
+		unsigned int query_count = r_state.getArgumentUnsigned();
+		const Terrain& terrain = getTerrain();
+		vector<Vector3> v_positions = getRandomPoints(query_count, TERRAIN_OFFSET, TERRAIN_SIZE, 4);
+		r_state.run(query_count, [&] ()
+		{
+			Vector3 total;
+			for(unsigned int i = 0; i < query_count; i++)
+				total += terrain.getSurfaceNormal(v_positions[i]);
+			g_sink = g_sink + total.y;
+		});
+	}
+
+	void benchmarkObjModelLoad (BenchmarkState& r_state)
+	{
+		string filename = RESOURCE_PATH + r_state.getArgument();
+
+		// a missing file would only time the error message
+		ObjModel model(filename);
+		if(!model.isLoadedSuccessfully())
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			return;
+		}
+
+		r_state.run(1, [&] ()
+		{
+			model.load(filename);
+		});
+		g_sink = g_sink + model.getVertexCount();
+	}
+
+	void runObjModelLoadGenerated (BenchmarkState& r_state,
+	                               bool is_reference)
+	{
+		// items are bytes of the file
+		unsigned int cell_count = r_state.getArgumentUnsigned();
+		string filename = (filesystem::temp_directory_path() /
+		                   ("uwsim-bench-grid-" + r_state.getArgument() + ".obj")).string();
+
+		unsigned long long byte_count = writeGridObj(filename, cell_count);
+		if(byte_count == 0)
+		{
+			r_state.fail("Could not write \"" + filename + "\"");
+			remove(filename.c_str());
+			return;
+		}
+
+		ObjModel model(filename);
+		if(!model.isLoadedSuccessfully() || !model.isValid() ||
+		   model.getFaceCountTotal() != cell_count * cell_count)
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			remove(filename.c_str());
+			return;
+		}
+
+		if(is_reference)
+		{
+			// must build the same model, or the times do not compare
+			ObjModel reference;
+			if(!loadObjReference(filename, reference) ||
+			   reference.getVertexCount()            != model.getVertexCount() ||
+			   reference.getTextureCoordinateCount() != model.getTextureCoordinateCount() ||
+			   reference.getNormalCount()            != model.getNormalCount() ||
+			   reference.getFaceCountTotal()         != model.getFaceCountTotal())
+			{
+				r_state.fail("Reference loader does not match for \"" + filename + "\"");
+				remove(filename.c_str());
+				return;
+			}
+
+			r_state.run(byte_count, [&] ()
+			{
+				loadObjReference(filename, model);
+			});
+		}
+		else
+		{
+			r_state.run(byte_count, [&] ()
+			{
+				model.load(filename);
+			});
+		}
+		g_sink = g_sink + model.getVertexCount();
+		remove(filename.c_str());
+	}
+
+	void benchmarkObjModelLoadGenerated (BenchmarkState& r_state)
+	{
+		runObjModelLoadGenerated(r_state, false);
+	}
+
+	void benchmarkObjModelLoadGeneratedReference (BenchmarkState& r_state)
+	{
+		// the old line-by-line loader, to compare with
+		runObjModelLoadGenerated(r_state, true);
+	}
+
+	void benchmarkObjModelGetCompiledMesh (BenchmarkState& r_state)
+	{
+		string filename = RESOURCE_PATH + r_state.getArgument();
+		ObjModel model(filename);
+		if(!model.isLoadedSuccessfully())
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			return;
+		}
+
+		r_state.run(1, [&] ()
+		{
+			CompiledMesh mesh = model.getCompiledMesh();
+			g_sink = g_sink + mesh.getIndexCount();
+		});
+	}
+
+	void benchmarkObjModelGetDisplayList (BenchmarkState& r_state)
+	{
+		string filename = RESOURCE_PATH + r_state.getArgument();
+		ObjModel model(filename);
+		if(!model.isLoadedSuccessfully())
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			return;
+		}
+
+		// the list is deleted at the end of each iteration
+		r_state.run(1, [&] ()
+		{
+			DisplayList list = model.getDisplayList();
+			glFinish();
+			g_sink = g_sink + list.isReady();
+		});
+	}
+
+	void benchmarkDisplayListDraw (BenchmarkState& r_state)
+	{
+		// items are copies of the model drawn
+		string filename = RESOURCE_PATH + r_state.getArgument();
+		ObjModel model(filename);
+		if(!model.isLoadedSuccessfully())
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			return;
+		}
+
+		DisplayList list = model.getDisplayList();
+		r_state.run(DRAW_COUNT, [&] ()
+		{
+			for(unsigned int i = 0; i < DRAW_COUNT; i++)
+				list.draw();
+			glFinish();
+		});
+	}
+
+	void benchmarkCompiledMeshDraw (BenchmarkState& r_state)
+	{
+		// items are copies of the model drawn
+		string filename = RESOURCE_PATH + r_state.getArgument();
+		ObjModel model(filename);
+		if(!model.isLoadedSuccessfully())
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			return;
+		}
+
+		CompiledMesh mesh = model.getCompiledMesh();
+		r_state.run(DRAW_COUNT, [&] ()
+		{
+			for(unsigned int i = 0; i < DRAW_COUNT; i++)
+				mesh.draw();
+			glFinish();
+		});
+	}
+
+	void benchmarkTextureBmpLoad (BenchmarkState& r_state)
+	{
+		string filename = RESOURCE_PATH + r_state.getArgument();
+
+		// items are pixels
+		TextureBmp image(filename);
+		if(image.isBad())
+		{
+			r_state.fail("Could not load \"" + filename + "\"");
+			return;
+		}
+		unsigned long long pixel_count = (unsigned long long)(image.getWidth()) * image.getHeight();
+		r_state.run(pixel_count, [&] ()
+		{
+			image.load(filename);
+		});
+		g_sink = g_sink + image.getWidth();
+	}
+
+	void benchmarkTextureManagerGetIndex (BenchmarkState& r_state)
+	{
+		// items are lookups, of names in a different case
+		unsigned int texture_count = r_state.getArgumentUnsigned();
+
+		#ifndef NDEBUG
+			// adding a texture asserts that GLUT is initialized
+			if(!Texture::isGlutInitialized())
+			{
+				r_state.fail("Needs --gl when built with assertions");
+				return;
+			}
+		#endif
+
+		registerBenchTextures(texture_count);
+
+		RandomStream random(1, texture_count);
+		vector<string> v_names(QUERY_COUNT);
+		vector<unsigned int> v_expected(QUERY_COUNT);
+		for(unsigned int i = 0; i < QUERY_COUNT; i++)
+		{
+			v_expected[i] = (unsigned int)(random.getDouble() * texture_count) % texture_count;
+			v_names[i] = getBenchTextureName(v_expected[i]);
+			for(unsigned int c = 0; c < v_names[i].size(); c++)
+				v_names[i][c] = (char)(toupper(v_names[i][c]));
+		}
+		for(unsigned int i = 0; i < QUERY_COUNT; i++)
+			if(TextureManager::getIndex(v_names[i]) == TextureManager::TEXTURE_INDEX_INVALID)
+			{
+				r_state.fail("Could not find \"" + v_names[i] + "\"");
+				return;
+			}
+
+		r_state.run(QUERY_COUNT, [&] ()
+		{
+			unsigned int total = 0;
+			for(unsigned int i = 0; i < QUERY_COUNT; i++)
+				total += TextureManager::getIndex(v_names[i]);
+			g_sink = g_sink + total;
+		});
+	}
+
+	void benchmarkVector3 (BenchmarkState& r_state)
+	{
+		const string& operation = r_state.getArgument();
+		vector<Vector3> v_a = getRandomPoints(QUERY_COUNT, Vector3(-1.0, -1.0, -1.0), Vector3(2.0, 2.0, 2.0), 5);
+		vector<Vector3> v_b = getRandomPoints(QUERY_COUNT, Vector3(-1.0, -1.0, -1.0), Vector3(2.0, 2.0, 2.0), 6);
+
+		if(operation == "add")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				Vector3 total;
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					total += v_a[i] + v_b[i] * 0.5;
+				g_sink = g_sink + total.x;
+			});
+		}
+		else if(operation == "dot")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				double total = 0.0;
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					total += v_a[i].dotProduct(v_b[i]);
+				g_sink = g_sink + total;
+			});
+		}
+		else if(operation == "cross")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				Vector3 total;
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					total += v_a[i].crossProduct(v_b[i]);
+				g_sink = g_sink + total.x;
+			});
+		}
+		else if(operation == "normalize")
+		{
+			r_state.run(QUERY_COUNT, [&] ()
+			{
+				Vector3 total;
+				for(unsigned int i = 0; i < QUERY_COUNT; i++)
+					total += v_a[i].getNormalizedSafe();
+				g_sink = g_sink + total.x;
+			});
+		}
+	}
+
+
+
+	//
+	//  getBenchmarks
+	//
+	//  Purpose: To retrieve every benchmark.
+	//  Parameter(s): N/A
+	//  Precondition(s): N/A
+	//  Returns: The benchmarks, in the order they are run.
+	//  Side Effect: N/A
+	//
+	vector<Benchmark> getBenchmarks ()
+	{
+		const vector<string> FISH_COUNTS = { "100", "1000", "10000", "100000" };
+		const vector<string> BRUTE_FORCE_FISH_COUNTS = { "100", "1000", "10000" };
+		const vector<string> ENTITY_COUNTS = { "100", "1000", "10000" };
+		const vector<string> LINEAR_ENTITY_COUNTS = { "100", "1000" };
+		const vector<string> QUERY_COUNTS = { to_string(QUERY_COUNT), to_string(LARGE_QUERY_COUNT) };
+		const vector<string> MODELS = { "anchovy.obj", "treasure_chest.obj", "rock.obj" };
+		const vector<string> IMAGES = { "heightmap.bmp", "anchovy.bmp", "laboratory.bmp", "grass1.bmp" };
+
+		vector<Benchmark> v_benchmarks;
+		v_benchmarks.push_back({ "FishSchool/AI",               FISH_COUNTS, benchmarkFishSchoolAI });
+		v_benchmarks.push_back({ "FishSchool/NearestNeighbour", FISH_COUNTS, benchmarkFishSchoolNearestNeighbour });
+		v_benchmarks.push_back({ "FishSchool/NearestNeighbourBruteForce", BRUTE_FORCE_FISH_COUNTS,
+		                         benchmarkFishSchoolNearestNeighbourBruteForce });
+		v_benchmarks.push_back({ "FishKernels/update",                  { "simd", "scalar" },
+		                         benchmarkFishKernelsUpdate });
+		v_benchmarks.push_back({ "FishKernels/update",                  { "baseline" },
+		                         benchmarkFishKernelsUpdateBaseline });
+		v_benchmarks.push_back({ "FishKernels/packInstanceMatrices",    { "simd", "scalar" },
+		                         benchmarkFishKernelsPackInstanceMatrices });
+		v_benchmarks.push_back({ "FixedEntityBvh/query",        ENTITY_COUNTS, benchmarkFixedEntityBvhQuery });
+		v_benchmarks.push_back({ "FixedEntityBvh/linearQuery",  LINEAR_ENTITY_COUNTS,
+		                         benchmarkFixedEntityLinearQuery });
+		v_benchmarks.push_back({ "FixedEntityBvh/frustumQuery", ENTITY_COUNTS, benchmarkFixedEntityBvhFrustumQuery });
+		v_benchmarks.push_back({ "Collision",        { "entity", "sphere", "cylinder", "terrain" }, benchmarkCollision });
+		v_benchmarks.push_back({ "Terrain/getHeight",        QUERY_COUNTS, benchmarkTerrainGetHeight });
+		v_benchmarks.push_back({ "Terrain/getHeights",       QUERY_COUNTS, benchmarkTerrainGetHeights });
+		v_benchmarks.push_back({ "Terrain/getSurfaceNormal", QUERY_COUNTS, benchmarkTerrainGetSurfaceNormal });
+		v_benchmarks.push_back({ "ObjModel/load",   MODELS, benchmarkObjModelLoad });
+		v_benchmarks.push_back({ "ObjModel/loadGenerated",   { "100", "300" }, benchmarkObjModelLoadGenerated });
+		v_benchmarks.push_back({ "ObjModel/loadGeneratedReference", { "100", "300" },
+		                         benchmarkObjModelLoadGeneratedReference });
+		v_benchmarks.push_back({ "ObjModel/getCompiledMesh", MODELS, benchmarkObjModelGetCompiledMesh });
+		v_benchmarks.push_back({ "ObjModel/getDisplayList",  MODELS, benchmarkObjModelGetDisplayList, true });
+		v_benchmarks.push_back({ "DisplayList/draw",         MODELS, benchmarkDisplayListDraw,        true });
+		v_benchmarks.push_back({ "CompiledMesh/draw",        MODELS, benchmarkCompiledMeshDraw,       true });
+		v_benchmarks.push_back({ "TextureBmp/load", IMAGES, benchmarkTextureBmpLoad });
+		v_benchmarks.push_back({ "TextureManager/getIndex", { "100", "10000" }, benchmarkTextureManagerGetIndex });
+		v_benchmarks.push_back({ "Vector3", { "add", "dot", "cross", "normalize" }, benchmarkVector3 });
+		return v_benchmarks;
+	}
+
+	//
+	//  writeJson
+	//
+	//  Purpose: To write the benchmark results to a JSON file.
+	//  Parameter(s):
+	//    <1> filename: The name of the file to write
+	//    <2> v_results: The results
+	//    <3> min_seconds: The minimum time per batch
+	//  Precondition(s): N/A
+	//  Returns: Whether the file was written.
+	//  Side Effect: The results are written to file filename.
+	//               The names are written as they are, so they
+	//               must not need escaping.
+	//
+	bool writeJson (const string& filename,
+	                const vector<BenchmarkResult>& v_results,
+	                double min_seconds)
+	{
+		ofstream fout(filename);
+		if(!fout)
+			return false;
+
+		time_t now = time(NULL);
+		char a_date[32] = "";
+		strftime(a_date, sizeof(a_date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+		#ifdef NDEBUG
+			const bool IS_ASSERTIONS = false;
+		#else
+			const bool IS_ASSERTIONS = true;
+		#endif
+
+		fout << "{" << endl;
+		fout << "  \"context\": {" << endl;
+		fout << "    \"date\": \"" << a_date << "\"," << endl;
+		fout << "    \"min_time\": " << min_seconds << "," << endl;
+		fout << "    \"assertions\": " << (IS_ASSERTIONS ? "true" : "false") << endl;
+		fout << "  }," << endl;
+		fout << "  \"benchmarks\": [";
+		fout << setprecision(10);
+		for(unsigned int i = 0; i < v_results.size(); i++)
+		{
+			const BenchmarkResult& result = v_results[i];
+			fout << (i == 0 ? "" : ",") << endl;
+			fout << "    {\"name\": \"" << result.m_name << "\""
+			     << ", \"iterations\": "         << result.m_iterations
+			     << ", \"repetitions\": "        << result.m_repetitions
+			     << ", \"ns_per_iteration\": "   << result.m_median_ns
+			     << ", \"min_ns_per_iteration\": " << result.m_min_ns
+			     << ", \"max_ns_per_iteration\": " << result.m_max_ns
+			     << ", \"items_per_second\": "   << result.m_items_per_second << "}";
+		}
+		fout << endl << "  ]" << endl;
+		fout << "}" << endl;
+		return (bool)(fout);
+	}
+
+}  // end of anonymous namespace
+
+
+
+int main (int argc, char* argv[])
+{
+	string filter;
+	string json_filename;
+	double min_seconds = DEFAULT_MIN_SECONDS;
+	unsigned int repetition_count = DEFAULT_REPETITION_COUNT;
+	bool is_opengl = false;
+	for(int a = 1; a < argc; a++)
+	{
+		string argument = argv[a];
+		if(argument == "--gl")
+		{
+			is_opengl = true;
+			continue;
+		}
+		if(a + 1 >= argc)
+		{
+			cerr << "Usage: " << argv[0] << " [--filter text] [--json results.json]"
+			     << " [--min-time seconds] [--repetitions count] [--gl]" << endl;
+			return 1;
+		}
+
+		a++;
+		if(argument == "--filter")
+			filter = argv[a];
+		else if(argument == "--json")
+			json_filename = argv[a];
+		else if(argument == "--min-time")
+		{
+			min_seconds = atof(argv[a]);
+			if(min_seconds <= 0.0)
+			{
+				cerr << "Error: Invalid minimum time \"" << argv[a] << "\"" << endl;
+				return 1;
+			}
+		}
+		else if(argument == "--repetitions")
+		{
+			int value = atoi(argv[a]);
+			if(value < 1)
+			{
+				cerr << "Error: Invalid repetition count \"" << argv[a] << "\"" << endl;
+				return 1;
+			}
+			repetition_count = value;
+		}
+		else
+		{
+			cerr << "Error: Unknown option \"" << argument << "\"" << endl;
+			return 1;
+		}
+	}
+
+	if(!ifstream(RESOURCE_PATH + TERRAIN_HEIGHTS_TEXTURE))
+	{
+		cerr << "Error: Could not find \"" << RESOURCE_PATH << "\" folder" << endl;
+		return 1;
+	}
+
+	if(is_opengl)
+	{
+		// the window is only needed for its OpenGL context
+		glutInit(&argc, argv);
+		glutInitDisplayMode(GLUT_DOUBLE | GLUT_DEPTH | GLUT_RGB);
+		glutInitWindowSize(64, 64);
+		glutCreateWindow("uwsim-bench");
+		glutHideWindow();
+	}
+
+	cout << left << setw(44) << "Benchmark" << right
+	     << setw(14) << "ns/iter" << setw(14) << "min" << setw(14) << "max"
+	     << setw(16) << "items/s" << endl;
+
+	vector<BenchmarkResult> v_results;
+	unsigned int failed_count = 0;
+	unsigned int skipped_count = 0;
+	vector<Benchmark> v_benchmarks = getBenchmarks();
+	for(unsigned int b = 0; b < v_benchmarks.size(); b++)
+	{
+		const Benchmark& benchmark = v_benchmarks[b];
+		vector<string> v_arguments = benchmark.mv_arguments;
+		if(v_arguments.empty())
+			v_arguments.push_back("");
+
+		for(unsigned int a = 0; a < v_arguments.size(); a++)
+		{
+			string name = benchmark.m_name;
+			if(v_arguments[a] != "")
+				name += "/" + v_arguments[a];
+			if(name.find(filter) == string::npos)
+				continue;
+			if(benchmark.m_is_opengl && !is_opengl)
+			{
+				skipped_count++;
+				continue;
+			}
+
+			BenchmarkState state(v_arguments[a], min_seconds, repetition_count);
+			benchmark.mp_function(state);
+			if(state.isFailed())
+			{
+				cout << left << setw(44) << name << right << "  FAILED: " << state.getError() << endl;
+				failed_count++;
+				continue;
+			}
+			if(!state.isRun())
+			{
+				cerr << "Error: Benchmark \"" << name << "\" did not run" << endl;
+				return 1;
+			}
+
+			BenchmarkResult result = state.getResult();
+			result.m_name = name;
+			v_results.push_back(result);
+
+			cout << left << setw(44) << name << right << fixed << setprecision(1)
+			     << setw(14) << result.m_median_ns
+			     << setw(14) << result.m_min_ns
+			     << setw(14) << result.m_max_ns
+			     << setw(16) << setprecision(0) << result.m_items_per_second << endl;
+		}
+	}
+
+	if(skipped_count > 0)
+		cout << "Skipped " << skipped_count << " benchmark(s) that need --gl" << endl;
+
+	if(json_filename != "")
+	{
+		if(!writeJson(json_filename, v_results, min_seconds))
+		{
+			cerr << "Error: Could not write \"" << json_filename << "\"" << endl;
+			return 1;
+		}
+		cout << "Wrote " << v_results.size() << " results to " << json_filename << endl;
+	}
+
+	if(failed_count > 0)
+	{
+		cerr << "Error: " << failed_count << " benchmark(s) failed" << endl;
+		return 1;
+	}
+	return 0;
+}
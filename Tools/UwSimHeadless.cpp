@@ -0,0 +1,146 @@
+//
+//  UwSimHeadless.cpp
+//
+//  A command line tool to run the game simulation without a
+//    window and measure how fast it runs.
+//
+//  Usage: uwsim-headless [map.txt [ticks [threads [seed]]]]
+//
+//  The map is loaded from the Resources folder without any
+//    models or textures, and then updated ticks times with the
+//    same fixed time step as the game, with the player on
+//    autopilot.  threads is the number of threads to update the
+//    fish schools on, or 0 for one per core.  The same seed
+//    gives the same world, and the results do not depend on
+//    the number of threads.  No OpenGL functions are called, so
+//    this can run on a machine without a display or GPU, and it
+//    is linked without the drawing code or the OpenGL libraries.
+//
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+
+#include "../ObjLibrary/Vector3.h"
+
+#include "../Map.h"
+
+using namespace std;
+using namespace ObjLibrary;
+
+namespace
+{
+	const string RESOURCE_PATH = "Resources/";
+
+	const string       DEFAULT_MAP_FILENAME = "map.txt";
+	const unsigned int DEFAULT_TICK_COUNT   = 3600;
+	const unsigned int DEFAULT_THREAD_COUNT = 0;
+	const unsigned int DEFAULT_WORLD_SEED   = 1;
+
+	// the game runs 60 updates per second
+	const float TICK_DELTA_TIME = 1.0f / 60.0f;
+
+	//
+	//  readUnsigned
+	//
+	//  Purpose: To read a non-negative integer command line
+	//           argument.
+	//  Parameter(s):
+	//    <1> a_text: The argument
+	//    <2> name: The name of the argument, for error messages
+	//    <3> r_value: The variable to set
+	//  Precondition(s):
+	//    <1> a_text != NULL
+	//  Returns: Whether a_text is a non-negative integer.
+	//  Side Effect: If a_text is a non-negative integer, r_value
+	//               is set to it.  Otherwise, an error message is
+	//               written to the standard error stream.
+	//
+	bool readUnsigned (const char* a_text,
+	                   const string& name,
+	                   unsigned long long& r_value)
+	{
+		assert(a_text != NULL);
+
+		char* p_end;
+		unsigned long long value = strtoull(a_text, &p_end, 10);
+		if(*a_text == '\0' || *a_text == '-' || *p_end != '\0')
+		{
+			cerr << "Error: Invalid " << name << " \"" << a_text << "\"" << endl;
+			return false;
+		}
+		r_value = value;
+		return true;
+	}
+
+}  // end of anonymous namespace
+
+
+
+int main (int argc, char* argv[])
+{
+	if(argc > 5)
+	{
+		cerr << "Usage: " << argv[0] << " [map.txt [ticks [threads [seed]]]]" << endl;
+		return 1;
+	}
+
+	string map_filename = DEFAULT_MAP_FILENAME;
+	unsigned long long tick_count   = DEFAULT_TICK_COUNT;
+	unsigned long long thread_count = DEFAULT_THREAD_COUNT;
+	unsigned long long world_seed   = DEFAULT_WORLD_SEED;
+	if(argc > 1)
+		map_filename = argv[1];
+	if(argc > 2 && !readUnsigned(argv[2], "tick count", tick_count))
+		return 1;
+	if(argc > 3 && !readUnsigned(argv[3], "thread count", thread_count))
+		return 1;
+	if(argc > 4 && !readUnsigned(argv[4], "world seed", world_seed))
+		return 1;
+
+	if(!ifstream(RESOURCE_PATH + map_filename))
+	{
+		cerr << "Error: Could not open map \"" << RESOURCE_PATH + map_filename << "\"" << endl;
+		return 1;
+	}
+
+	// Map::initDisplayLists is not called, so the map is only simulated
+	chrono::steady_clock::time_point load_start = chrono::steady_clock::now();
+	Map map(RESOURCE_PATH, map_filename, world_seed);
+	chrono::duration<double> load_duration = chrono::steady_clock::now() - load_start;
+	Map::setThreadCount((unsigned int)(thread_count));
+
+	cout << "Loaded " << map_filename << " in " << fixed << setprecision(3)
+	     << load_duration.count() << " s: "
+	     << map.getFixedEntityCount() << " fixed entities, "
+	     << map.getFishSchoolCount()  << " fish schools" << endl;
+
+	map.turnOnAutoPilot();
+	chrono::steady_clock::time_point run_start = chrono::steady_clock::now();
+	for(unsigned long long t = 0; t < tick_count; t++)
+	{
+		map.updatePhysicsAll(TICK_DELTA_TIME);
+		if(map.getAutoPilotValue())
+			map.runAutoPilot(TICK_DELTA_TIME);
+	}
+	chrono::duration<double> run_duration = chrono::steady_clock::now() - run_start;
+
+	double seconds = run_duration.count();
+	cout << "Ran " << tick_count << " ticks on " << Map::getThreadCount()
+	     << " threads in " << seconds << " s" << endl;
+	if(seconds > 0.0 && tick_count > 0)
+	{
+		cout << "Ticks per second: " << setprecision(1) << tick_count / seconds << endl;
+		cout << "Milliseconds per tick: " << setprecision(4) << seconds * 1000.0 / tick_count << endl;
+	}
+
+	const Vector3& position = map.getPlayerPosition();
+	cout << "Fish caught: " << map.getFishCaughtCount() << endl;
+	cout << "Player position: " << setprecision(6)
+	     << position.x << " " << position.y << " " << position.z << endl;
+	return 0;
+}
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+#
+#  compare_bench.py
+#
+#  A script to compare two JSON files written by uwsim-bench and
+#    flag the benchmarks that got slower.
+#
+#  Usage: compare_bench.py baseline.json current.json [--threshold 0.10]
+#
+#  A benchmark is a regression if its median time per iteration
+#    grew by more than the threshold, which is a fraction, and its
+#    fastest repetition is also slower than the slowest repetition
+#    of the baseline.  The second test keeps noisy benchmarks from
+#    being flagged.  The exit status is 1 if there are any
+#    regressions, so this can be used in a script.
+#
+
+import argparse
+import json
+import sys
+
+
+def load_results(filename):
+    """Return the context and a name -> result dict from a results file."""
+    with open(filename) as file:
+        data = json.load(file)
+    results = {}
+    for benchmark in data["benchmarks"]:
+        results[benchmark["name"]] = benchmark
+    return data.get("context", {}), results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two uwsim-bench JSON files.")
+    parser.add_argument("baseline", help="results from before the change")
+    parser.add_argument("current", help="results from after the change")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="fractional slowdown to flag (default 0.10)")
+    args = parser.parse_args()
+
+    baseline_context, baseline = load_results(args.baseline)
+    current_context, current = load_results(args.current)
+
+    if baseline_context.get("assertions") != current_context.get("assertions"):
+        print("Warning: only one run has assertions enabled, so the times are not comparable")
+
+    print("%-44s %14s %14s %9s" % ("Benchmark", "baseline ns", "current ns", "change"))
+    regressions = []
+    for name in current:
+        if name not in baseline:
+            print("%-44s %14s %14.1f %9s" % (name, "-", current[name]["ns_per_iteration"], "new"))
+            continue
+
+        old = baseline[name]
+        new = current[name]
+        ratio = new["ns_per_iteration"] / old["ns_per_iteration"] if old["ns_per_iteration"] > 0 else 1.0
+        mark = ""
+        if ratio > 1.0 + args.threshold and new["min_ns_per_iteration"] > old["max_ns_per_iteration"]:
+            mark = "  REGRESSION"
+            regressions.append(name)
+        elif ratio < 1.0 - args.threshold and new["max_ns_per_iteration"] < old["min_ns_per_iteration"]:
+            mark = "  faster"
+        print("%-44s %14.1f %14.1f %+8.1f%%%s" % (name, old["ns_per_iteration"], new["ns_per_iteration"],
+                                                  (ratio - 1.0) * 100.0, mark))
+
+    for name in baseline:
+        if name not in current:
+            print("%-44s %14.1f %14s %9s" % (name, baseline[name]["ns_per_iteration"], "-", "missing"))
+
+    if regressions:
+        print("%d regression(s) over %.0f%%: %s" % (len(regressions), args.threshold * 100.0,
+                                                     ", ".join(regressions)))
+        return 1
+    print("No regressions over %.0f%%" % (args.threshold * 100.0))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
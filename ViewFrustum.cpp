@@ -0,0 +1,153 @@
+//
+//  ViewFrustum.cpp
+//
+
+#include "ViewFrustum.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ObjLibrary/Vector3.h"
+
+#include "CoordinateSystem.h"
+
+using namespace std;
+using namespace ObjLibrary;
+namespace
+{
+	const double PI = 3.14159265358979323846;
+
+	// exponential fog is invisible once it is within half a step
+	//  of the fog colour in an 8-bit colour channel
+	const double FOG_VISIBLE_FRACTION = 1.0 / 255.0;
+
+	enum
+	{
+		PLANE_NEAR,
+		PLANE_FAR,
+		PLANE_LEFT,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+	};
+
+}  // end of anonymous namespace
+
+
+
+const unsigned int ViewFrustum :: PLANE_COUNT;
+
+
+
+double ViewFrustum :: getFogCutoffDistance (double fog_density)
+{
+	assert(fog_density > 0.0);
+
+	// GL_EXP fog factor is e^(-density * distance)
+	return -log(FOG_VISIBLE_FRACTION) / fog_density;
+}
+
+
+
+ViewFrustum :: ViewFrustum ()
+{
+	for(unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		ma_planes[i].m_normal   = Vector3::ZERO;
+		ma_planes[i].m_distance = 0.0;
+	}
+
+	assert(isInvariantTrue());
+}
+
+ViewFrustum :: ViewFrustum (const CoordinateSystem& camera,
+                            double field_of_view,
+                            double aspect_ratio,
+                            double near_distance,
+                            double far_distance)
+{
+	assert(field_of_view > 0.0);
+	assert(field_of_view < 180.0);
+	assert(aspect_ratio > 0.0);
+	assert(near_distance > 0.0);
+	assert(near_distance < far_distance);
+
+	// same basis as gluLookAt builds
+	Vector3 forward = camera.getForward().getNormalized();
+	Vector3 right   = forward.crossProduct(camera.getUp());
+	assert(!right.isZero());
+	right.normalize();
+	Vector3 up = right.crossProduct(forward);
+
+	double tan_half_y = tan(field_of_view * PI / 360.0);
+	double tan_half_x = tan_half_y * aspect_ratio;
+
+	const Vector3& position = camera.getPosition();
+	setPlane(PLANE_NEAR,   forward, position + forward * near_distance);
+	setPlane(PLANE_FAR,   -forward, position + forward * far_distance);
+	setPlane(PLANE_LEFT,   right + forward * tan_half_x, position);
+	setPlane(PLANE_RIGHT, -right + forward * tan_half_x, position);
+	setPlane(PLANE_BOTTOM,    up + forward * tan_half_y, position);
+	setPlane(PLANE_TOP,      -up + forward * tan_half_y, position);
+
+	assert(isInvariantTrue());
+}
+
+
+
+bool ViewFrustum :: isSphereVisible (const ObjLibrary::Vector3& center,
+                                     double radius) const
+{
+	assert(isInvariantTrue());
+	assert(radius >= 0.0);
+
+	for(unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		const Plane& plane = ma_planes[i];
+		if(plane.m_normal.dotProduct(center) + plane.m_distance < -radius)
+			return false;
+	}
+	return true;
+}
+
+bool ViewFrustum :: isBoxVisible (const ObjLibrary::Vector3& box_min,
+                                  const ObjLibrary::Vector3& box_max) const
+{
+	assert(isInvariantTrue());
+	assert(box_min.x <= box_max.x);
+	assert(box_min.y <= box_max.y);
+	assert(box_min.z <= box_max.z);
+
+	for(unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		// test the corner farthest along the normal
+		const Plane& plane = ma_planes[i];
+		Vector3 corner((plane.m_normal.x >= 0.0) ? box_max.x : box_min.x,
+		               (plane.m_normal.y >= 0.0) ? box_max.y : box_min.y,
+		               (plane.m_normal.z >= 0.0) ? box_max.z : box_min.z);
+		if(plane.m_normal.dotProduct(corner) + plane.m_distance < 0.0)
+			return false;
+	}
+	return true;
+}
+
+
+
+void ViewFrustum :: setPlane (unsigned int index,
+                              const ObjLibrary::Vector3& normal,
+                              const ObjLibrary::Vector3& point)
+{
+	assert(index < PLANE_COUNT);
+	assert(!normal.isZero());
+
+	ma_planes[index].m_normal   = normal.getNormalized();
+	ma_planes[index].m_distance = -ma_planes[index].m_normal.dotProduct(point);
+}
+
+bool ViewFrustum :: isInvariantTrue () const
+{
+	for(unsigned int i = 0; i < PLANE_COUNT; i++)
+		if(!ma_planes[i].m_normal.isZero() && !ma_planes[i].m_normal.isNormal())
+			return false;
+	return true;
+}
@@ -0,0 +1,186 @@
+//
+//  ViewFrustum.h
+//
+//  A module to determine what a camera can see.
+//
+
+#pragma once
+
+#include "ObjLibrary/Vector3.h"
+
+class CoordinateSystem;
+
+
+
+//
+//  ViewFrustum
+//
+//  A class to represent the volume of space visible from a
+//    camera, as 6 planes with normals pointing inwards.  The
+//    planes match the view set up by CoordinateSystem::
+//    setupCamera followed by gluPerspective with the same field
+//    of view, aspect ratio, and clipping distances.
+//
+//  A ViewFrustum does not make any OpenGL calls, so it can be
+//    used to decide what to draw before drawing anything, and
+//    can be created without an OpenGL context.
+//
+//  The tests are conservative: some objects that are reported
+//    as visible may be just outside the frustum near its
+//    corners, but no object that is inside it is ever reported
+//    as hidden.
+//
+//  Class Invariant:
+//    <1> Every plane normal is a unit vector or the zero vector
+//
+class ViewFrustum
+{
+public:
+//
+//  PLANE_COUNT
+//
+//  The number of planes bounding a ViewFrustum.
+//
+	static const unsigned int PLANE_COUNT = 6;
+
+//
+//  getFogCutoffDistance
+//
+//  Purpose: To determine the distance at which exponential fog
+//           hides everything.
+//  Parameter(s):
+//    <1> fog_density: The GL_FOG_DENSITY for GL_EXP fog
+//  Precondition(s):
+//    <1> fog_density > 0.0
+//  Returns: The distance at which the fog factor falls below
+//           the smallest step of an 8-bit colour channel.  An
+//           object farther away is drawn in the fog colour.
+//  Side Effect: N/A
+//
+	static double getFogCutoffDistance (double fog_density);
+
+public:
+//
+//  Default Constructor
+//
+//  Purpose: To create a ViewFrustum that contains everything.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: N/A
+//  Side Effect: A ViewFrustum is created for which every
+//               object is visible.
+//
+	ViewFrustum ();
+
+//
+//  Constructor
+//
+//  Purpose: To create a ViewFrustum for a perspective camera.
+//  Parameter(s):
+//    <1> camera: The camera position and orientation
+//    <2> field_of_view: The vertical field of view in degrees,
+//                       as passed to gluPerspective
+//    <3> aspect_ratio: The width of the view divided by its
+//                      height
+//    <4> near_distance: The distance to the near clipping plane
+//    <5> far_distance: The distance to the far clipping plane
+//  Precondition(s):
+//    <1> camera.getForward() is not parallel to
+//        camera.getUp()
+//    <2> field_of_view > 0.0
+//    <3> field_of_view < 180.0
+//    <4> aspect_ratio > 0.0
+//    <5> near_distance > 0.0
+//    <6> near_distance < far_distance
+//  Returns: N/A
+//  Side Effect: A ViewFrustum is created for the specified
+//               camera.
+//
+	ViewFrustum (const CoordinateSystem& camera,
+	             double field_of_view,
+	             double aspect_ratio,
+	             double near_distance,
+	             double far_distance);
+
+//
+//  isSphereVisible
+//
+//  Purpose: To determine whether any part of a sphere may be
+//           visible.
+//  Parameter(s):
+//    <1> center: The center of the sphere
+//    <2> radius: The radius of the sphere
+//  Precondition(s):
+//    <1> radius >= 0.0
+//  Returns: Whether the sphere is not entirely outside any one
+//           plane of this ViewFrustum.
+//  Side Effect: N/A
+//
+	bool isSphereVisible (const ObjLibrary::Vector3& center,
+	                      double radius) const;
+
+//
+//  isBoxVisible
+//
+//  Purpose: To determine whether any part of an axis-aligned
+//           box may be visible.
+//  Parameter(s):
+//    <1> box_min
+//    <2> box_max: The corners of the box
+//  Precondition(s):
+//    <1> box_min.x <= box_max.x
+//    <2> box_min.y <= box_max.y
+//    <3> box_min.z <= box_max.z
+//  Returns: Whether the box is not entirely outside any one
+//           plane of this ViewFrustum.
+//  Side Effect: N/A
+//
+	bool isBoxVisible (const ObjLibrary::Vector3& box_min,
+	                   const ObjLibrary::Vector3& box_max) const;
+
+private:
+//
+//  Plane
+//
+//  A record to represent a plane.  A point p is on the inside
+//    of the plane if m_normal.dotProduct(p) + m_distance >= 0.
+//
+	struct Plane
+	{
+		ObjLibrary::Vector3 m_normal;
+		double m_distance;
+	};
+
+//
+//  setPlane
+//
+//  Purpose: To set one plane of this ViewFrustum.
+//  Parameter(s):
+//    <1> index: Which plane to set
+//    <2> normal: A vector pointing into the frustum
+//    <3> point: A point on the plane
+//  Precondition(s):
+//    <1> index < PLANE_COUNT
+//    <2> !normal.isZero()
+//  Returns: N/A
+//  Side Effect: Plane index is set to the plane through point
+//               facing along normal.
+//
+	void setPlane (unsigned int index,
+	               const ObjLibrary::Vector3& normal,
+	               const ObjLibrary::Vector3& point);
+
+//
+//  isInvariantTrue
+//
+//  Purpose: To determine if the class invariant is true.
+//  Parameter(s): N/A
+//  Precondition(s): N/A
+//  Returns: Whether the class invariant is true.
+//  Side Effect: N/A
+//
+	bool isInvariantTrue () const;
+
+private:
+	Plane ma_planes[PLANE_COUNT];
+};
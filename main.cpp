@@ -8,25 +8,33 @@
 #include <cstdlib>
 #include <cmath>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <chrono>
 
 #include "GetGlut.h"
 #include "Sleep.h"
 
 #include "ObjLibrary/Vector3.h"
 #include "ObjLibrary/SpriteFont.h"
+#include "ObjLibrary/MeshCache.h"
 
+#include "JobSystem.h"
+#include "AssetLoader.h"
 #include "TimeManager.h"
 #include "CoordinateSystem.h"
+#include "ViewFrustum.h"
 #include "Map.h"
+#include "Profiler.h"
 
 using namespace std;
 using namespace ObjLibrary;
 
 void init ();
 void initDisplay ();
+void loadAssetsCpu ();
 
 void keyboard (unsigned char key, int x, int y);
 void keyboardUp (unsigned char key, int x, int y);
@@ -42,6 +50,7 @@ void reshape (int w, int h);
 void display ();
 void drawHUD ();
 void drawFrameRateDebugging ();
+void drawProfilerStatistics ();
 void drawKeyboardInput ();
 
 const unsigned int KEY_UP_ARROW    = 256;
@@ -55,13 +64,21 @@ bool key_pressed[KEY_COUNT];
 
 int window_width  = 1024;
 int window_height = 768;
+const double FIELD_OF_VIEW = 60.0;  // degrees
+const double NEAR_DISTANCE = 0.1;
+const double FAR_DISTANCE  = 1000.0;
+const float  FOG_DENSITY   = 0.15f;
 SpriteFont font;
 
 TimeManager time_manager;
+int updates_per_second = 60;  // --tick-rate
+int frames_per_second  = 0;   // --frame-rate; 0 means one frame per update
+bool is_interpolating  = true;
 const double PLAYER_ACCELERATION = 3.0;  // m/s^2
 const double PLAYER_TURN_RATE    = 3.0;  // radians/s
 
 const string RESOURCE_PATH = "Resources/";
+const string MAP_FILENAME  = "map.txt";
 Map map;
 bool is_paused = false;
 
@@ -71,11 +88,59 @@ bool display_nearby_surface_normals  = false;
 bool display_terrain_surface_normals = false;
 bool display_keyboard_input          = false;
 bool display_flock_to_player = false;
+bool display_profiler                = false;
+
+// profiling from startup also records the asset loading
+bool is_profiling_requested = false;
+const string TRACE_FILENAME = "trace.json";
 
 
 
 int main (int argc, char* argv[])
 {
+	Profiler::setThreadName("Main");
+
+	bool is_headless = false;
+	for(int a = 1; a < argc; a++)
+	{
+		string argument = argv[a];
+		if(argument == "--headless")
+			is_headless = true;
+		else if(argument == "--profile")
+			is_profiling_requested = true;
+		else if(argument == "--tick-rate" && a + 1 < argc)
+		{
+			a++;
+			updates_per_second = atoi(argv[a]);
+			if(updates_per_second <= 0)
+			{
+				cerr << "Invalid tick rate \"" << argv[a] << "\"" << endl;
+				return 1;
+			}
+		}
+		else if(argument == "--frame-rate" && a + 1 < argc)
+		{
+			a++;
+			frames_per_second = atoi(argv[a]);
+			if(frames_per_second < 0)
+			{
+				cerr << "Invalid frame rate \"" << argv[a] << "\"" << endl;
+				return 1;
+			}
+		}
+	}
+	Profiler::setEnabled(is_profiling_requested);
+
+	// load the files without a window, to time or check them
+	if(is_headless)
+	{
+		loadAssetsCpu();
+		AssetLoader::printTimings(cout);
+		if(is_profiling_requested)
+			cout << "Saved " << Profiler::saveTrace(TRACE_FILENAME) << " zones to " << TRACE_FILENAME << endl;
+		return 0;
+	}
+
 	glutInitWindowSize(window_width, window_height);
 	glutInitWindowPosition(0, 0);
 
@@ -98,17 +163,33 @@ int main (int argc, char* argv[])
 
 void init ()
 {
-	// seed random number generator
-	srand((unsigned int)time(NULL));
-
 	initDisplay();
 
 	font.load(RESOURCE_PATH + "Font.bmp");
-	Map::loadModels(RESOURCE_PATH);
 
-	map = Map(RESOURCE_PATH, "map.txt");
+	// a cold start compiles the models, a warm start uses their cache files
+	UWSIM_PROFILE_ZONE("Load");
+	chrono::steady_clock::time_point load_start = chrono::steady_clock::now();
+	MeshCache::resetCounts();
+	loadAssetsCpu();
+	AssetLoader::upload();
+	Map::loadModels(RESOURCE_PATH);
 
-	time_manager = TimeManager(60, 10);
+	// a different world every run; pass a constant to reproduce one
+	map = Map(RESOURCE_PATH, MAP_FILENAME, (unsigned long long)time(NULL));
+	map.initDisplayLists(RESOURCE_PATH);
+	Map::setThreadCount(0);  // one thread per core
+
+	chrono::duration<double> load_duration = chrono::steady_clock::now() - load_start;
+	cout << (MeshCache::getCacheMissCount() == 0 ? "Warm" : "Cold") << " start took "
+	     << load_duration.count() << " s: "
+	     << MeshCache::getCacheHitCount()  << " models from cache, "
+	     << MeshCache::getCacheMissCount() << " compiled" << endl;
+	AssetLoader::printTimings(cout);
+	AssetLoader::clear();
+
+	time_manager = TimeManager(updates_per_second, 10);
+	time_manager.setFrameRate(frames_per_second);
 }
 
 void initDisplay ()
@@ -121,11 +202,19 @@ void initDisplay ()
 
 	glEnable(GL_FOG);
 	glFogi (GL_FOG_MODE, GL_EXP);
-	glFogf (GL_FOG_DENSITY, 0.15f);
+	glFogf (GL_FOG_DENSITY, FOG_DENSITY);
 
 	glutPostRedisplay();
 }
 
+void loadAssetsCpu ()
+{
+	// everything the map needs is parsed and decoded up front
+	Map::addAssets(RESOURCE_PATH, MAP_FILENAME);
+	JobSystem job_system(0);  // one thread per core
+	AssetLoader::loadCpu(job_system);
+}
+
 
 
 void keyboard (unsigned char key, int x, int y)
@@ -169,6 +258,25 @@ void keyboard (unsigned char key, int x, int y)
 		if (!key_pressed['5'])
 			display_flock_to_player = true;
 		break;
+	case '6':
+		if(!key_pressed['6'])
+		{
+			display_profiler = !display_profiler;
+			Profiler::setEnabled(display_profiler || is_profiling_requested);
+		}
+		break;
+	case '7':
+		if(!key_pressed['7'])
+			cout << "Saved " << Profiler::saveTrace(TRACE_FILENAME) << " zones to " << TRACE_FILENAME << endl;
+		break;
+	case '8':
+		if(!key_pressed['8'])
+			time_manager.setPrecisePacing(!time_manager.isPrecisePacing());
+		break;
+	case '9':
+		if(!key_pressed['9'])
+			is_interpolating = !is_interpolating;
+		break;
 	}
 
 	key_pressed[key] = true;
@@ -235,18 +343,28 @@ void update ()
 	for(unsigned int i = 0; i < time_manager.getMaxUpdatesPerFrame() &&
 	                        time_manager.isUpdateWaiting(); i++)
 	{
+		time_manager.markUpdateStart();
 		doGameUpdates();
 		time_manager.markNextUpdate();
 	}
 
-	time_manager.sleepUntilNextUpdate();
-	glutPostRedisplay();
+	{
+		UWSIM_PROFILE_ZONE("Sleep");
+		time_manager.sleepUntilNextFrame();
+	}
+	if(time_manager.isFrameWaiting())
+		glutPostRedisplay();
 }
 
 bool temp1 = false;
 
 void doGameUpdates ()
 {
+	UWSIM_PROFILE_ZONE("Update");
+
+	// frames are drawn between this state and the new one
+	map.storePreviousState();
+
 	if(!is_paused)
 	{
 		updateForKeyboard();
@@ -397,7 +515,7 @@ void reshape (int w, int h)
 
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
-	gluPerspective(60.0, (GLdouble)w / (GLdouble)h, 0.1, 1000.0);
+	gluPerspective(FIELD_OF_VIEW, (GLdouble)w / (GLdouble)h, NEAR_DISTANCE, FAR_DISTANCE);
 	glMatrixMode(GL_MODELVIEW);
 
 	glutPostRedisplay();
@@ -405,6 +523,10 @@ void reshape (int w, int h)
 
 void display ()
 {
+	// a profiler frame runs from one display to the next
+	Profiler::markFrame();
+	UWSIM_PROFILE_ZONE("Display");
+
 	time_manager.markNextFrame();
 	if(key_pressed['Y'])
 		sleep(0.05);
@@ -413,7 +535,20 @@ void display ()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	// clear the screen - any drawing before here will not display at all
 
-	map.draw();
+	// everything past the fog cutoff is drawn in the fog colour,
+	//  which is also the clear colour, so it can be skipped
+	double cull_distance = ViewFrustum::getFogCutoffDistance(FOG_DENSITY);
+	if(cull_distance > FAR_DISTANCE)
+		cull_distance = FAR_DISTANCE;
+	double aspect_ratio = 1.0;
+	if(window_width > 0 && window_height > 0)  // minimized windows have size 0
+		aspect_ratio = (double)(window_width) / window_height;
+	float alpha = 1.0f;
+	if(is_interpolating)
+		alpha = time_manager.getInterpolationAlpha();
+	ViewFrustum frustum(map.getPlayerRenderCoords(alpha), FIELD_OF_VIEW, aspect_ratio,
+	                    NEAR_DISTANCE, cull_distance);
+	map.draw(frustum, alpha);
 	unsigned int school = map.findNearestSchool(map.getPlayerPosition());
 
 	
@@ -448,11 +583,13 @@ void display ()
 	drawHUD();
 
 	// send the current image to the screen - any drawing after here will not display
+	UWSIM_PROFILE_ZONE("Display/Swap buffers");
 	glutSwapBuffers();
 }
 
 void drawHUD ()
 {
+	UWSIM_PROFILE_ZONE("Display/HUD");
 	SpriteFont::setUp2dView(window_width, window_height);
 
 	stringstream caught_ss;
@@ -491,7 +628,9 @@ void drawHUD ()
 		font.draw(message, draw_x, window_height / 2);
 	}
 
-	if(display_frame_rate)
+	if(display_profiler)
+		drawProfilerStatistics();
+	else if(display_frame_rate)
 		drawFrameRateDebugging();
 
 	drawKeyboardInput();
@@ -540,6 +679,130 @@ void drawFrameRateDebugging ()
 	stringstream smoothed_update_rate_ss;
 	smoothed_update_rate_ss << "Smoothed update rate: " << time_manager.getUpdateRateSmoothed();
 	font.draw(smoothed_update_rate_ss.str(), 16, 224);
+
+	// memory
+
+	stringstream terrain_memory_ss;
+	terrain_memory_ss << "Terrain heights: " << map.getTerrainHeightBytes() / 1024 << " KiB";
+	font.draw(terrain_memory_ss.str(), 16, 256);
+
+	stringstream normal_memory_ss;
+	normal_memory_ss << "Terrain normals: " << map.getTerrainNormalCacheBytes() / 1024 << " KiB";
+	font.draw(normal_memory_ss.str(), 16, 280);
+
+	// culling
+
+	const CullStatistics& cull_statistics = map.getCullStatistics();
+
+	stringstream fixed_cull_ss;
+	fixed_cull_ss << "Fixed entities drawn: " << cull_statistics.m_fixed_entities_drawn
+	              << " (low detail: " << cull_statistics.m_fixed_entities_low_detail << ")"
+	              << " culled: " << cull_statistics.m_fixed_entities_culled;
+	font.draw(fixed_cull_ss.str(), 16, 312);
+
+	stringstream school_cull_ss;
+	school_cull_ss << "Fish schools drawn: " << cull_statistics.m_fish_schools_drawn
+	               << " culled: " << cull_statistics.m_fish_schools_culled;
+	font.draw(school_cull_ss.str(), 16, 336);
+
+	stringstream plant_cull_ss;
+	plant_cull_ss << "Plant chunks drawn: " << cull_statistics.m_plant_chunks_drawn
+	              << " culled: " << cull_statistics.m_plant_chunks_culled;
+	font.draw(plant_cull_ss.str(), 16, 360);
+
+	// pacing
+
+	stringstream frame_time_ss;
+	frame_time_ss << fixed << setprecision(2)
+	              << "Frame time p50/p99: " << time_manager.getFrameTimePercentile(0.50f)
+	              << " / " << time_manager.getFrameTimePercentile(0.99f) << " ms";
+	font.draw(frame_time_ss.str(), 16, 392);
+
+	stringstream frame_jitter_ss;
+	frame_jitter_ss << fixed << setprecision(3)
+	                << "Frame jitter p50/p99: " << time_manager.getFrameJitterPercentile(0.50f)
+	                << " / " << time_manager.getFrameJitterPercentile(0.99f) << " ms";
+	font.draw(frame_jitter_ss.str(), 16, 416);
+
+	stringstream catch_up_ss;
+	catch_up_ss << fixed << setprecision(2)
+	            << "Update cost: " << time_manager.getUpdateCostSmoothed() << " ms"
+	            << " max per frame: " << time_manager.getMaxUpdatesPerFrame()
+	            << " skipped: " << time_manager.getSkippedUpdateCount();
+	font.draw(catch_up_ss.str(), 16, 440);
+
+	stringstream pacing_ss;
+	if(time_manager.isPrecisePacing())
+		pacing_ss << fixed << setprecision(2) << "Pacing: precise, spin "
+		          << time_manager.getSleepSlack() << " ms";
+	else
+		pacing_ss << "Pacing: sleep only";
+	font.draw(pacing_ss.str(), 16, 464);
+
+	stringstream interpolation_ss;
+	interpolation_ss << "Ticks: " << updates_per_second << " Hz, frames: ";
+	if(time_manager.getFrameRateTarget() > 0)
+		interpolation_ss << time_manager.getFrameRateTarget() << " Hz";
+	else
+		interpolation_ss << "1 per tick";
+	if(is_interpolating)
+		interpolation_ss << fixed << setprecision(2)
+		                 << ", interpolating, alpha " << time_manager.getInterpolationAlpha();
+	else
+		interpolation_ss << ", not interpolating";
+	font.draw(interpolation_ss.str(), 16, 488);
+}
+
+void drawProfilerStatistics ()
+{
+	const int NAME_X    = 16;
+	const int AVERAGE_X = 320;
+	const int MAX_X     = 416;
+	const int CALLS_X   = 512;
+
+	stringstream title_ss;
+	title_ss << "Profiler (last " << Profiler::FRAME_HISTORY << " frames)";
+#ifdef UWSIM_PROFILER_DISABLE
+	title_ss << " - zones compiled out";
+#else
+	if(!Profiler::isEnabled())
+		title_ss << " - disabled";
+#endif
+	font.draw(title_ss.str(), NAME_X, 16);
+
+	font.draw("Zone",   NAME_X,    48);
+	font.draw("Avg ms", AVERAGE_X, 48);
+	font.draw("Max ms", MAX_X,     48);
+	font.draw("Calls",  CALLS_X,   48);
+
+	vector<Profiler::ZoneStatistics> v_statistics = Profiler::getStatistics();
+	int draw_y = 72;
+	for(unsigned int i = 0; i < v_statistics.size(); i++)
+	{
+		const Profiler::ZoneStatistics& statistics = v_statistics[i];
+
+		// nested zones are shown indented, by the last part of their name
+		size_t slash = statistics.m_name.rfind('/');
+		string leaf_name = statistics.m_name.substr(slash == string::npos ? 0 : slash + 1);
+		int name_x = NAME_X + Profiler::getDepth(statistics.m_name) * 16;
+		font.draw(leaf_name, name_x, draw_y);
+
+		stringstream average_ss;
+		average_ss << fixed << setprecision(3) << statistics.m_average_ms;
+		font.draw(average_ss.str(), AVERAGE_X, draw_y);
+
+		stringstream max_ss;
+		max_ss << fixed << setprecision(3) << statistics.m_max_ms;
+		font.draw(max_ss.str(), MAX_X, draw_y);
+
+		stringstream calls_ss;
+		calls_ss << fixed << setprecision(1) << statistics.m_average_calls;
+		font.draw(calls_ss.str(), CALLS_X, draw_y);
+
+		draw_y += 20;
+	}
+
+	font.draw("Press [7] to save " + TRACE_FILENAME, NAME_X, draw_y + 12);
 }
 
 void drawKeyboardInput ()
@@ -604,6 +867,18 @@ void drawKeyboardInput ()
 
 		font.draw("[4]", key_x, base_y + 72);
 		font.draw("Display heightmap normals", text_x, base_y + 72);
+
+		font.draw("[6]", key_x, base_y + 96);
+		font.draw("Display profiler", text_x, base_y + 96);
+
+		font.draw("[7]", key_x, base_y + 120);
+		font.draw("Save profiler trace", text_x, base_y + 120);
+
+		font.draw("[8]", key_x, base_y + 144);
+		font.draw("Toggle precise pacing", text_x, base_y + 144);
+
+		font.draw("[9]", key_x, base_y + 168);
+		font.draw("Toggle interpolation", text_x, base_y + 168);
 	}
 	else
 		font.draw("Press [F1] to show keyboard input", key_x, 16);